@@ -0,0 +1,277 @@
+/**
+******************************************************************************
+* @file    platform.c
+* @version V1.0.0
+* @brief   This file provides all MICO Peripherals mapping table for the
+*          WiFiMCU firmware running as a Linux process. Pin and partition
+*          aliases come from Board/WiFiMCU/platform.h so the host build
+*          sees the same board as the module.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include "mico_platform.h"
+#include "platform.h"
+#include "platform_config.h"
+#include "platform_peripheral.h"
+#include "PlatformLogging.h"
+
+/******************************************************
+*                      Macros
+******************************************************/
+
+/* Host GPIO ports, only used to name a pin in logs */
+#define GPIOA 0
+#define GPIOB 1
+#define GPIOC 2
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+const platform_gpio_t platform_gpio_pins[] =
+{
+  /* Common GPIOs for internal use */
+  [STDIO_UART_RX]                     = { GPIOA,  3 },
+  [STDIO_UART_TX]                     = { GPIOA,  2 },
+  [FLASH_PIN_SPI_CS  ]                = { GPIOA, 15 },
+  [FLASH_PIN_SPI_CLK ]                = { GPIOB,  3 },
+  [FLASH_PIN_SPI_MOSI]                = { GPIOA,  7 },
+  [FLASH_PIN_SPI_MISO]                = { GPIOB,  4 },
+
+  /* GPIOs for external use */
+  [MICO_GPIO_2]                       = { GPIOB,  2 },
+  [MICO_GPIO_8]                       = { GPIOA , 2 },
+  [MICO_GPIO_9]                       = { GPIOA,  1 },
+  [MICO_GPIO_12]                      = { GPIOA,  3 },
+  [MICO_GPIO_14]                      = { GPIOA,  0 },
+  [MICO_GPIO_16]                      = { GPIOC, 13 },
+  [MICO_GPIO_17]                      = { GPIOB, 10 },
+  [MICO_GPIO_18]                      = { GPIOB,  9 },
+  [MICO_GPIO_19]                      = { GPIOB, 12 },
+  [MICO_GPIO_27]                      = { GPIOA, 12 },
+  [MICO_GPIO_29]                      = { GPIOA, 10 },
+  [MICO_GPIO_30]                      = { GPIOB,  6 },
+  [MICO_GPIO_31]                      = { GPIOB,  8 },
+  [MICO_GPIO_33]                      = { GPIOB, 13 },
+  [MICO_GPIO_34]                      = { GPIOA,  5 },
+  [MICO_GPIO_35]                      = { GPIOA, 11 },
+  [MICO_GPIO_36]                      = { GPIOB,  1 },
+  [MICO_GPIO_37]                      = { GPIOB,  0 },
+  [MICO_GPIO_38]                      = { GPIOA,  4 },
+
+  [MICO_GPIO_25]                      = { GPIOA, 14 },
+  [MICO_GPIO_26]                      = { GPIOA, 13 },
+};
+
+const platform_pwm_t platform_pwm_peripherals[] =
+{
+  [MICO_PWM_1]  = { 2, &platform_gpio_pins[MICO_GPIO_9]  },
+  [MICO_PWM_2]  = { 3, &platform_gpio_pins[MICO_GPIO_17] },
+  [MICO_PWM_3]  = { 1, &platform_gpio_pins[MICO_GPIO_18] },
+  [MICO_PWM_4]  = { 3, &platform_gpio_pins[MICO_GPIO_29] },
+  [MICO_PWM_5]  = { 1, &platform_gpio_pins[MICO_GPIO_30] },
+  [MICO_PWM_6]  = { 1, &platform_gpio_pins[MICO_SYS_LED] },
+  [MICO_PWM_7]  = { 1, &platform_gpio_pins[MICO_GPIO_33] },
+  [MICO_PWM_8]  = { 1, &platform_gpio_pins[MICO_GPIO_34] },
+  [MICO_PWM_9]  = { 4, &platform_gpio_pins[MICO_GPIO_35] },
+  [MICO_PWM_10] = { 4, &platform_gpio_pins[MICO_GPIO_36] },
+  [MICO_PWM_11] = { 3, &platform_gpio_pins[MICO_GPIO_37] },
+};
+
+const platform_i2c_t platform_i2c_peripherals[] =
+{
+  [MICO_I2C_1] =
+  {
+    .port                         = 2,
+    .pin_scl                      = &platform_gpio_pins[MICO_GPIO_17],
+    .pin_sda                      = &platform_gpio_pins[MICO_GPIO_18],
+  },
+};
+
+platform_i2c_driver_t platform_i2c_drivers[MICO_I2C_MAX];
+
+const platform_uart_t platform_uart_peripherals[] =
+{
+  [MICO_UART_1] =
+  {
+    .host                         = UART_HOST_STDIO,
+    .pin_tx                       = &platform_gpio_pins[STDIO_UART_TX],
+    .pin_rx                       = &platform_gpio_pins[STDIO_UART_RX],
+  },
+  [MICO_UART_2] =
+  {
+    .host                         = UART_HOST_PTY,
+    .pin_tx                       = &platform_gpio_pins[MICO_GPIO_30],
+    .pin_rx                       = &platform_gpio_pins[MICO_GPIO_29],
+  },
+};
+platform_uart_driver_t platform_uart_drivers[MICO_UART_MAX];
+
+const platform_spi_t platform_spi_peripherals[] =
+{
+  [MICO_SPI_1]  =
+  {
+    .port                         = 1,
+    .pin_mosi                     = &platform_gpio_pins[FLASH_PIN_SPI_MOSI],
+    .pin_miso                     = &platform_gpio_pins[FLASH_PIN_SPI_MISO],
+    .pin_clock                    = &platform_gpio_pins[FLASH_PIN_SPI_CLK],
+  },
+  [MICO_SPI_5]  =
+  {
+    .port                         = 5,
+    .pin_mosi                     = &platform_gpio_pins[MICO_GPIO_29],
+    .pin_miso                     = &platform_gpio_pins[MICO_GPIO_27],
+    .pin_clock                    = &platform_gpio_pins[MICO_GPIO_37],
+  }
+};
+
+platform_spi_driver_t platform_spi_drivers[MICO_SPI_MAX];
+
+/* Flash memory devices, same geometry as the EMW3165 */
+const platform_flash_t platform_flash_peripherals[] =
+{
+  [MICO_FLASH_EMBEDDED] =
+  {
+    .flash_type                   = FLASH_TYPE_EMBEDDED,
+    .flash_start_addr             = 0x08000000,
+    .flash_length                 = 0x80000,
+  },
+  [MICO_FLASH_SPI] =
+  {
+    .flash_type                   = FLASH_TYPE_SPI,
+    .flash_start_addr             = 0x000000,
+    .flash_length                 = 0x200000,
+  },
+};
+
+platform_flash_driver_t platform_flash_drivers[MICO_FLASH_MAX];
+
+/* Logic partition on flash devices, keep in sync with Board/WiFiMCU/platform.c */
+const mico_logic_partition_t mico_partitions[] =
+{
+  [MICO_PARTITION_BOOTLOADER] =
+  {
+    .partition_owner           = MICO_FLASH_EMBEDDED,
+    .partition_description     = "Bootloader",
+    .partition_start_addr      = 0x08000000,
+    .partition_length          =     0x8000,       // 32k bytes
+    .partition_options         = PAR_OPT_READ_EN | PAR_OPT_WRITE_DIS,
+  },
+  [MICO_PARTITION_APPLICATION] =
+  {
+    .partition_owner           = MICO_FLASH_EMBEDDED,
+    .partition_description     = "Application",
+    .partition_start_addr      = 0x0800C000,
+    .partition_length          =    0x74000,       // 464k bytes
+    .partition_options         = PAR_OPT_READ_EN | PAR_OPT_WRITE_DIS,
+  },
+  [MICO_PARTITION_RF_FIRMWARE] =
+  {
+    .partition_owner           = MICO_FLASH_SPI,
+    .partition_description     = "RF Firmware",
+    .partition_start_addr      = 0x2000,
+    .partition_length          = 0x3E000,          // 248k bytes
+    .partition_options         = PAR_OPT_READ_EN | PAR_OPT_WRITE_DIS,
+  },
+  [MICO_PARTITION_LUA] =
+  {
+    .partition_owner           = MICO_FLASH_SPI,
+    .partition_description     = "LUA Storage",
+    .partition_start_addr      = 0x40000,
+    .partition_length          = 0x1C0000,         // 1792k bytes
+    .partition_options         = PAR_OPT_READ_EN | PAR_OPT_WRITE_EN,
+  },
+  [MICO_PARTITION_PARAMETER_1] =
+  {
+    .partition_owner           = MICO_FLASH_SPI,
+    .partition_description     = "PARAMETER1",
+    .partition_start_addr      = 0x0,
+    .partition_length          = 0x1000,           // 4k bytes
+    .partition_options         = PAR_OPT_READ_EN | PAR_OPT_WRITE_EN,
+  },
+  [MICO_PARTITION_PARAMETER_2] =
+  {
+    .partition_owner           = MICO_FLASH_SPI,
+    .partition_description     = "PARAMETER2",
+    .partition_start_addr      = 0x1000,
+    .partition_length          = 0x1000,           //4k bytes
+    .partition_options         = PAR_OPT_READ_EN | PAR_OPT_WRITE_EN,
+  }
+};
+
+const platform_adc_t platform_adc_peripherals[] =
+{
+  [MICO_ADC_1] = { 1,  &platform_gpio_pins[MICO_GPIO_9]  },
+  [MICO_ADC_2] = { 5,  &platform_gpio_pins[MICO_GPIO_34] },
+  [MICO_ADC_3] = { 9,  &platform_gpio_pins[MICO_GPIO_36] },
+  [MICO_ADC_4] = { 8,  &platform_gpio_pins[MICO_GPIO_37] },
+  [MICO_ADC_5] = { 4,  &platform_gpio_pins[MICO_GPIO_38] },
+  [MICO_ADC_6] = { 16, NULL },
+  [MICO_ADC_7] = { 17, NULL },
+};
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+void init_platform( void )
+{
+  MicoGpioInitialize((mico_gpio_t)BOOT_SEL, INPUT_PULL_UP);
+  MicoGpioInitialize((mico_gpio_t)MFG_SEL, INPUT_PULL_UP);
+}
+
+void MicoSysLed(bool onoff)
+{
+  if (onoff) {
+    MicoGpioOutputLow( (mico_gpio_t)MICO_SYS_LED );
+  } else {
+    MicoGpioOutputHigh( (mico_gpio_t)MICO_SYS_LED );
+  }
+}
+
+void MicoRfLed(bool onoff)
+{
+  if (onoff) {
+    MicoGpioOutputLow( (mico_gpio_t)MICO_RF_LED );
+  } else {
+    MicoGpioOutputHigh( (mico_gpio_t)MICO_RF_LED );
+  }
+}
+
+bool MicoShouldEnterMFGMode(void)
+{
+  return false;
+}
+
+bool MicoShouldEnterBootloader(void)
+{
+  return false;
+}
+
+unsigned char boot_reason=BOOT_REASON_NONE;
+
+void platform_check_bootreason( void )
+{
+  boot_reason = platform_host_boot_reason();
+}
@@ -542,6 +542,11 @@ MICO_RTOS_DEFINE_ISR( DMA2_Stream2_IRQHandler )
   platform_uart_rx_dma_irq( &platform_uart_drivers[MICO_UART_2] );
 }
 
+MICO_RTOS_DEFINE_ISR( DMA2_Stream4_IRQHandler )
+{
+  platform_adc_stream_dma_irq( );
+}
+
 
 /******************************************************
 *               Function Definitions
@@ -0,0 +1,37 @@
+/*
+ * curve25519_donna_base: public keys without the Montgomery ladder.
+ *
+ * Curve25519 is birationally equivalent to the Edwards curve of Ed25519,
+ * and the base point 9 maps to the Ed25519 base point B. So e * 9 is the
+ * u coordinate of e * B, and u = (1 + y) / (1 - y) = (Z + Y) / (Z - Y) in
+ * projective coordinates. e * B comes from the fixed-base comb of
+ * MICO/security/Sodium/ge25519.c, whose table size is ED25519_BASE_ROWS.
+ */
+
+#include <string.h>
+
+#include "curve25519-donna.h"
+#include "ge25519.h"
+
+void
+curve25519_donna_base(unsigned char *mypublic, const unsigned char *secret) {
+  ge25519_p3 A;
+  fe25519 zplusy, zminusy;
+  unsigned char e[32];
+  int i;
+
+  for (i = 0; i < 32; ++i) e[i] = secret[i];
+  e[0] &= 248;
+  e[31] &= 127;
+  e[31] |= 64;
+
+  ge25519_scalarmult_base(&A, e);
+
+  fe25519_add(zplusy, A.Z, A.Y);
+  fe25519_sub(zminusy, A.Z, A.Y);
+  fe25519_invert(zminusy, zminusy);
+  fe25519_mul(zplusy, zplusy, zminusy);
+  fe25519_tobytes(mypublic, zplusy);
+
+  memset(e, 0, sizeof(e));
+}
@@ -439,6 +439,12 @@ curve25519_donna(u8 *mypublic, const u8 *secret, const u8 *basepoint) {
   uint8_t e[32];
   int i;
 
+#if( CURVE25519_FIXED_BASE )
+  if (basepoint == NULL) {
+    curve25519_donna_base(mypublic, secret);
+    return;
+  }
+#endif
   if (basepoint == NULL) basepoint = kCurve25519BasePoint;
 
   for (i = 0;i < 32;++i) e[i] = secret[i];
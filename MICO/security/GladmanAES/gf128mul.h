@@ -135,18 +135,26 @@ Issue Date: 11/01/2011
 /*  Table sizes for GF(128) Multiply.  Normally larger tables give 
     higher speed but cache loading might change this. Normally only 
     one table size (or none at all) will be specified here
+
+    GHASH_TABLE_SIZE picks the table at build time. The table is part
+    of every gcm_ctx, so the 4 KB table is the default for 128 KB RAM
+    parts. 256 keeps a context small enough for a task stack at about
+    four times the GHASH cost, 8192 doubles the RAM for a few percent
+    and 0 uses the bitwise multiply. MICO/security/crypto_bench times
+    them. The 64K table is only available by defining TABLES_64K.
 */
-#if 0
-#  define TABLES_64K
+#if !defined( GHASH_TABLE_SIZE )
+#  define GHASH_TABLE_SIZE  4096
 #endif
-#if 0
+#if defined( TABLES_64K )
+#elif GHASH_TABLE_SIZE == 8192
 #  define TABLES_8K
-#endif
-#if 1
+#elif GHASH_TABLE_SIZE == 4096
 #  define TABLES_4K
-#endif
-#if 0
+#elif GHASH_TABLE_SIZE == 256
 #  define TABLES_256
+#elif GHASH_TABLE_SIZE != 0
+#  error GHASH_TABLE_SIZE must be 0, 256, 4096 or 8192
 #endif
 
 /* END OF USER DEFINABLE OPTIONS */
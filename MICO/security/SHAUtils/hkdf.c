@@ -152,11 +152,86 @@ int hkdfExtract(SHAversion whichSha,
 int hkdfExpand(SHAversion whichSha, const uint8_t prk[ ], int prk_len,
     const unsigned char *info, int info_len,
     uint8_t okm[ ], int okm_len)
+{
+  HMACKey key;
+  int hash_len, ret;
+
+  hash_len = USHAHashSize(whichSha);
+  if (prk_len < hash_len) return shaBadParam;
+
+  /* key HMAC once, every T(i) starts from the same midstates */
+  ret = hmacKeySetup(&key, whichSha, prk, prk_len) ||
+        hkdfExpandKeyed(&key, info, info_len, okm, okm_len);
+  memset(&key, 0, sizeof(key));
+  return ret;
+}
+
+/*
+ *  hkdfExtractKeyed
+ *
+ *  Description:
+ *      This function will perform HKDF extraction with a salt that
+ *      has been set up as an HMAC key by hmacKeySetup().
+ *
+ *  Parameters:
+ *      salt: [in]
+ *          The salt as an HMAC key.
+ *      ikm[ ]: [in]
+ *          Input keying material.
+ *      ikm_len: [in]
+ *          The length of the input keying material.
+ *      prk[ ]: [out]
+ *          Array where the HKDF extraction is to be stored.
+ *          Must be larger than USHAHashSize(whichSha);
+ *
+ *  Returns:
+ *      sha Error Code.
+ *
+ */
+int hkdfExtractKeyed(const HMACKey *salt,
+    const unsigned char *ikm, int ikm_len,
+    uint8_t prk[USHAMaxHashSize])
+{
+  return hmacKeyed(salt, ikm, ikm_len, prk);
+}
+
+/*
+ *  hkdfExpandKeyed
+ *
+ *  Description:
+ *      This function will perform HKDF expansion with the
+ *      pseudo-random key set up as an HMAC key by hmacKeySetup(),
+ *      so that deriving several keys from one PRK hashes its pads
+ *      only once.
+ *
+ *  Parameters:
+ *      prk: [in]
+ *          The pseudo-random key as an HMAC key.
+ *      info[ ]: [in]
+ *          The optional context and application specific information.
+ *          If info == NULL or a zero-length string, it is ignored.
+ *      info_len: [in]
+ *          The length of the optional context and application specific
+ *          information.  (Ignored if info == NULL.)
+ *      okm[ ]: [out]
+ *          Where the HKDF is to be stored.
+ *      okm_len: [in]
+ *          The length of the buffer to hold okm.
+ *          okm_len must be <= 255 * USHAHashSize(whichSha)
+ *
+ *  Returns:
+ *      sha Error Code.
+ *
+ */
+int hkdfExpandKeyed(const HMACKey *prk,
+    const unsigned char *info, int info_len,
+    uint8_t okm[ ], int okm_len)
 {
   int hash_len, N;
   unsigned char T[USHAMaxHashSize];
   int Tlen, where, i;
 
+  if (!prk) return shaNull;
   if (info == 0) {
     info = (const unsigned char *)"";
     info_len = 0;
@@ -166,8 +241,7 @@ int hkdfExpand(SHAversion whichSha, const uint8_t prk[ ], int prk_len,
   if (okm_len <= 0) return shaBadParam;
   if (!okm) return shaBadParam;
 
-  hash_len = USHAHashSize(whichSha);
-  if (prk_len < hash_len) return shaBadParam;
+  hash_len = prk->hashSize;
   N = okm_len / hash_len;
   if ((okm_len % hash_len) != 0) N++;
   if (N > 255) return shaBadParam;
@@ -177,7 +251,7 @@ int hkdfExpand(SHAversion whichSha, const uint8_t prk[ ], int prk_len,
   for (i = 1; i <= N; i++) {
     HMACContext context;
     unsigned char c = i;
-    int ret = hmacReset(&context, whichSha, prk, prk_len) ||
+    int ret = hmacKeyedReset(&context, prk) ||
               hmacInput(&context, T, Tlen) ||
               hmacInput(&context, info, info_len) ||
               hmacInput(&context, &c, 1) ||
@@ -12,6 +12,7 @@
  */
 
 #include "sha.h"
+#include <string.h>
 
 /*
  *  hmac
@@ -54,44 +55,28 @@ int hmac(SHAversion whichSha,
 }
 
 /*
- *  hmacReset
+ *  hmacPads
  *
  *  Description:
- *      This function will initialize the hmacContext in preparation
- *      for computing a new HMAC message digest.
- *
- *  Parameters:
- *      context: [in/out]
- *          The context to reset.
- *      whichSha: [in]
- *          One of SHA1, SHA224, SHA256, SHA384, SHA512
- *      key[ ]: [in]
- *          The secret shared key.
- *      key_len: [in]
- *          The length of the secret shared key.
+ *      This function will fill in the key XORd with ipad and with
+ *      opad, hashing the key first if it is longer than a block.
  *
  *  Returns:
  *      sha Error Code.
  *
  */
-int hmacReset(HMACContext *context, enum SHAversion whichSha,
-    const unsigned char *key, int key_len)
+static int hmacPads(enum SHAversion whichSha,
+    const unsigned char *key, int key_len,
+    unsigned char k_ipad[USHA_Max_Message_Block_Size],
+    unsigned char k_opad[USHA_Max_Message_Block_Size])
 {
-  int i, blocksize, hashsize, ret;
-
-  /* inner padding - key XORd with ipad */
-  unsigned char k_ipad[USHA_Max_Message_Block_Size];
+  int i, blocksize, hashsize;
 
   /* temporary buffer when keylen > blocksize */
   unsigned char tempkey[USHAMaxHashSize];
 
-  if (!context) return shaNull;
-  context->Computed = 0;
-  context->Corrupted = shaSuccess;
-
-  blocksize = context->blockSize = USHABlockSize(whichSha);
-  hashsize = context->hashSize = USHAHashSize(whichSha);
-  context->whichSha = whichSha;
+  blocksize = USHABlockSize(whichSha);
+  hashsize = USHAHashSize(whichSha);
 
   /*
    * If key is longer than the hash blocksize,
@@ -122,22 +107,179 @@ int hmacReset(HMACContext *context, enum SHAversion whichSha,
   /* store key into the pads, XOR'd with ipad and opad values */
   for (i = 0; i < key_len; i++) {
     k_ipad[i] = key[i] ^ 0x36;
-    context->k_opad[i] = key[i] ^ 0x5c;
+    k_opad[i] = key[i] ^ 0x5c;
   }
   /* remaining pad bytes are '\0' XOR'd with ipad and opad values */
   for ( ; i < blocksize; i++) {
     k_ipad[i] = 0x36;
-    context->k_opad[i] = 0x5c;
+    k_opad[i] = 0x5c;
   }
+  return shaSuccess;
+}
+
+/*
+ *  hmacReset
+ *
+ *  Description:
+ *      This function will initialize the hmacContext in preparation
+ *      for computing a new HMAC message digest.
+ *
+ *  Parameters:
+ *      context: [in/out]
+ *          The context to reset.
+ *      whichSha: [in]
+ *          One of SHA1, SHA224, SHA256, SHA384, SHA512
+ *      key[ ]: [in]
+ *          The secret shared key.
+ *      key_len: [in]
+ *          The length of the secret shared key.
+ *
+ *  Returns:
+ *      sha Error Code.
+ *
+ */
+int hmacReset(HMACContext *context, enum SHAversion whichSha,
+    const unsigned char *key, int key_len)
+{
+  int ret;
+
+  /* inner padding - key XORd with ipad */
+  unsigned char k_ipad[USHA_Max_Message_Block_Size];
+
+  if (!context) return shaNull;
+  context->Computed = 0;
+  context->Corrupted = shaSuccess;
+  context->key = 0;
+
+  context->blockSize = USHABlockSize(whichSha);
+  context->hashSize = USHAHashSize(whichSha);
+  context->whichSha = whichSha;
+
+  ret = hmacPads(whichSha, key, key_len, k_ipad, context->k_opad);
+  if (ret != shaSuccess) return ret;
 
   /* perform inner hash */
   /* init context for 1st pass */
   ret = USHAReset(&context->shaContext, whichSha) ||
         /* and start with inner pad */
-        USHAInput(&context->shaContext, k_ipad, blocksize);
+        USHAInput(&context->shaContext, k_ipad, context->blockSize);
   return context->Corrupted = ret;
 }
 
+/*
+ *  hmacKeySetup
+ *
+ *  Description:
+ *      This function will hash the key XORd with ipad and with opad
+ *      once and keep the resulting midstates in hkey, so that every
+ *      MAC computed with hmacKeyedReset() or hmacKeyed() saves the
+ *      two pad blocks.
+ *
+ *  Parameters:
+ *      hkey: [out]
+ *          The key to set up.
+ *      whichSha: [in]
+ *          One of SHA1, SHA224, SHA256, SHA384, SHA512
+ *      key[ ]: [in]
+ *          The secret shared key.
+ *      key_len: [in]
+ *          The length of the secret shared key.
+ *
+ *  Returns:
+ *      sha Error Code.
+ *
+ */
+int hmacKeySetup(HMACKey *hkey, enum SHAversion whichSha,
+    const unsigned char *key, int key_len)
+{
+  int ret;
+  USHAContext tcontext;
+  unsigned char k_ipad[USHA_Max_Message_Block_Size];
+  unsigned char k_opad[USHA_Max_Message_Block_Size];
+
+  if (!hkey) return shaNull;
+  hkey->whichSha = whichSha;
+  hkey->blockSize = USHABlockSize(whichSha);
+  hkey->hashSize = USHAHashSize(whichSha);
+
+  ret = hmacPads(whichSha, key, key_len, k_ipad, k_opad) ||
+        USHAReset(&tcontext, whichSha) ||
+        USHAInput(&tcontext, k_ipad, hkey->blockSize) ||
+        USHAGetMidstate(&tcontext, hkey->innerState) ||
+        USHAReset(&tcontext, whichSha) ||
+        USHAInput(&tcontext, k_opad, hkey->blockSize) ||
+        USHAGetMidstate(&tcontext, hkey->outerState);
+
+  /* the pads are as good as the key */
+  memset(k_ipad, 0, sizeof(k_ipad));
+  memset(k_opad, 0, sizeof(k_opad));
+  memset(&tcontext, 0, sizeof(tcontext));
+  return hkey->Corrupted = ret;
+}
+
+/*
+ *  hmacKeyedReset
+ *
+ *  Description:
+ *      This function will initialize the hmacContext from a key set
+ *      up by hmacKeySetup(). Continue with hmacInput(),
+ *      hmacFinalBits() and hmacResult() as after hmacReset().
+ *
+ *  Parameters:
+ *      context: [in/out]
+ *          The context to reset.
+ *      hkey: [in]
+ *          The key, it must stay valid until hmacResult().
+ *
+ *  Returns:
+ *      sha Error Code.
+ *
+ */
+int hmacKeyedReset(HMACContext *context, const HMACKey *hkey)
+{
+  if (!context || !hkey) return shaNull;
+  if (hkey->Corrupted) return hkey->Corrupted;
+  context->Computed = 0;
+  context->whichSha = hkey->whichSha;
+  context->blockSize = hkey->blockSize;
+  context->hashSize = hkey->hashSize;
+  context->key = hkey;
+  return context->Corrupted =
+    USHASetMidstate(&context->shaContext, hkey->whichSha,
+                    hkey->innerState, hkey->blockSize);
+}
+
+/*
+ *  hmacKeyed
+ *
+ *  Description:
+ *      This function will compute an HMAC message digest with a key
+ *      set up by hmacKeySetup().
+ *
+ *  Parameters:
+ *      hkey: [in]
+ *          The key.
+ *      text[ ]: [in]
+ *          An array of octets representing the message.
+ *      text_len: [in]
+ *          The length of the message in text.
+ *      digest[ ]: [out]
+ *          Where the digest is to be returned.
+ *
+ *  Returns:
+ *      sha Error Code.
+ *
+ */
+int hmacKeyed(const HMACKey *hkey,
+    const unsigned char *text, int text_len,
+    uint8_t digest[USHAMaxHashSize])
+{
+  HMACContext context;
+  return hmacKeyedReset(&context, hkey) ||
+         hmacInput(&context, text, text_len) ||
+         hmacResult(&context, digest);
+}
+
 /*
  *  hmacInput
  *
@@ -225,6 +367,19 @@ int hmacResult(HMACContext *context, uint8_t *digest)
   if (context->Corrupted) return context->Corrupted;
   if (context->Computed) return context->Corrupted = shaStateError;
 
+  if (context->key) {
+    /* as below, with the outer pad already hashed into the key */
+    ret = USHAResult(&context->shaContext, digest) ||
+          USHASetMidstate(&context->shaContext, context->whichSha,
+                          context->key->outerState,
+                          context->blockSize) ||
+          USHAInput(&context->shaContext, digest, context->hashSize) ||
+          USHAResult(&context->shaContext, digest);
+
+    context->Computed = 1;
+    return context->Corrupted = ret;
+  }
+
   /* finish up 1st pass */
   /* (Use digest here as a temporary buffer.) */
   ret =
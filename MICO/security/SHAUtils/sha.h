@@ -206,6 +206,23 @@ typedef struct USHAContext {
 
 } USHAContext;
 
+/*
+ *  This structure will hold an HMAC key as the SHA midstates
+ *  after the key XORd with ipad and with opad have been hashed.
+ *  A MAC keyed with it starts from these midstates instead of
+ *  hashing the two pad blocks again.
+ */
+typedef struct HMACKey {
+    SHAversion whichSha;        /* which SHA is being used */
+    int hashSize;               /* hash size of SHA being used */
+    int blockSize;              /* block size of SHA being used */
+    uint8_t innerState[USHAMaxHashSize];
+                        /* midstate after key XORd with ipad */
+    uint8_t outerState[USHAMaxHashSize];
+                        /* midstate after key XORd with opad */
+    int Corrupted;              /* Cumulative corruption code */
+} HMACKey;
+
 /*
  *  This structure will hold context information for the HMAC
  *  keyed-hashing operation.
@@ -217,6 +234,7 @@ typedef struct HMACContext {
     USHAContext shaContext;     /* SHA context */
     unsigned char k_opad[USHA_Max_Message_Block_Size];
                         /* outer padding - key XORd with opad */
+    const HMACKey *key;         /* midstates, when set by hmacKeyedReset */
     int Computed;               /* Is the MAC computed? */
     int Corrupted;              /* Cumulative corruption code */
 
@@ -302,6 +320,18 @@ extern int USHAHashSize(enum SHAversion whichSha);
 extern int USHAHashSizeBits(enum SHAversion whichSha);
 extern const char *USHAHashName(enum SHAversion whichSha);
 
+/*
+ * Midstates: the intermediate hash of a context that has been fed
+ * whole blocks only. A context set from a midstate continues as if
+ * the bytecount bytes it stands for had been input again.
+ */
+extern int USHAGetMidstate(USHAContext *context,
+                           uint8_t midstate[USHAMaxHashSize]);
+extern int USHASetMidstate(USHAContext *context,
+                           enum SHAversion whichSha,
+                           const uint8_t midstate[USHAMaxHashSize],
+                           unsigned int bytecount);
+
 /*
  * HMAC Keyed-Hashing for Message Authentication, RFC 2104,
  * for all SHAs.
@@ -328,6 +358,18 @@ extern int hmacFinalBits(HMACContext *context, uint8_t bits,
 extern int hmacResult(HMACContext *context,
                       uint8_t digest[USHAMaxHashSize]);
 
+/*
+ * HMAC with a key that is set up once and used for many MACs.
+ * The HMACKey must stay valid until hmacResult() has been called.
+ */
+extern int hmacKeySetup(HMACKey *hkey, enum SHAversion whichSha,
+                        const unsigned char *key, int key_len);
+extern int hmacKeyedReset(HMACContext *context, const HMACKey *hkey);
+extern int hmacKeyed(const HMACKey *hkey,
+    const unsigned char *text,     /* pointer to data stream */
+    int text_len,                  /* length of data stream */
+    uint8_t digest[USHAMaxHashSize]); /* caller digest to fill in */
+
 /*
  * HKDF HMAC-based Extract-and-Expand Key Derivation Function,
  * RFC 5869, for all SHAs.
@@ -343,6 +385,17 @@ extern int hkdfExpand(SHAversion whichSha, const uint8_t prk[ ],
                       int prk_len, const unsigned char *info,
                       int info_len, uint8_t okm[ ], int okm_len);
 
+/*
+ * HKDF with the salt or the pseudo-random key as an HMACKey, for
+ * callers that derive many keys from the same salt or PRK.
+ */
+extern int hkdfExtractKeyed(const HMACKey *salt,
+                            const unsigned char *ikm, int ikm_len,
+                            uint8_t prk[USHAMaxHashSize]);
+extern int hkdfExpandKeyed(const HMACKey *prk,
+                           const unsigned char *info, int info_len,
+                           uint8_t okm[ ], int okm_len);
+
 /*
  * HKDF HMAC-based Extract-and-Expand Key Derivation Function,
  * RFC 5869, for all SHAs.
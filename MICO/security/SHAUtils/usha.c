@@ -10,6 +10,7 @@
  */
 
 #include "sha.h"
+#include <string.h>
 
 /*
  *  USHAReset
@@ -279,3 +280,107 @@ const char *USHAHashName(enum SHAversion whichSha)
   }
 }
 
+
+/*
+ * USHAGetMidstate
+ *
+ * Description:
+ *   This function will copy out the intermediate hash of a context
+ *   that has been fed whole blocks only, so that the hash can later
+ *   be continued from this point with USHASetMidstate().
+ *
+ * Parameters:
+ *   context: [in]
+ *     The context to take the midstate of.
+ *   midstate: [out]
+ *     Where the midstate is returned.
+ *
+ * Returns:
+ *   sha Error Code, shaStateError if the context holds a partial
+ *   block or has been finished.
+ *
+ */
+#define USHA_MIDSTATE_GET(c, midstate)                           \
+  ((c)->Corrupted ? (c)->Corrupted :                             \
+   ((c)->Computed || (c)->Message_Block_Index) ? shaStateError : \
+   (memcpy((midstate), (c)->Intermediate_Hash,                   \
+           sizeof((c)->Intermediate_Hash)), shaSuccess))
+
+int USHAGetMidstate(USHAContext *context,
+                    uint8_t midstate[USHAMaxHashSize])
+{
+  if (!context || !midstate) return shaNull;
+  switch (context->whichSha) {
+    case SHA1:
+      return USHA_MIDSTATE_GET(&context->ctx.sha1Context, midstate);
+    case SHA224:
+    case SHA256:
+      return USHA_MIDSTATE_GET(&context->ctx.sha256Context, midstate);
+    case SHA384:
+    case SHA512:
+      return USHA_MIDSTATE_GET(&context->ctx.sha512Context, midstate);
+    default: return shaBadParam;
+  }
+}
+
+/*
+ * USHASetMidstate
+ *
+ * Description:
+ *   This function will initialize the SHA Context from a midstate
+ *   returned by USHAGetMidstate(), as if the bytecount bytes that
+ *   produced it had been input after USHAReset().
+ *
+ * Parameters:
+ *   context: [in/out]
+ *     The context to set.
+ *   whichSha: [in]
+ *     The SHA the midstate was taken with.
+ *   midstate: [in]
+ *     The midstate.
+ *   bytecount: [in]
+ *     The length of the message hashed into the midstate, a
+ *     multiple of USHABlockSize(whichSha).
+ *
+ * Returns:
+ *   sha Error Code.
+ *
+ */
+int USHASetMidstate(USHAContext *context, enum SHAversion whichSha,
+                    const uint8_t midstate[USHAMaxHashSize],
+                    unsigned int bytecount)
+{
+  int ret;
+
+  if (!context || !midstate) return shaNull;
+  if (bytecount % USHABlockSize(whichSha)) return shaBadParam;
+  ret = USHAReset(context, whichSha);
+  if (ret != shaSuccess) return ret;
+
+  switch (whichSha) {
+    case SHA1:
+      memcpy(context->ctx.sha1Context.Intermediate_Hash, midstate,
+             sizeof(context->ctx.sha1Context.Intermediate_Hash));
+      context->ctx.sha1Context.Length_High = bytecount >> 29;
+      context->ctx.sha1Context.Length_Low = bytecount << 3;
+      break;
+    case SHA224:
+    case SHA256:
+      memcpy(context->ctx.sha256Context.Intermediate_Hash, midstate,
+             sizeof(context->ctx.sha256Context.Intermediate_Hash));
+      context->ctx.sha256Context.Length_High = bytecount >> 29;
+      context->ctx.sha256Context.Length_Low = bytecount << 3;
+      break;
+    default:
+      memcpy(context->ctx.sha512Context.Intermediate_Hash, midstate,
+             sizeof(context->ctx.sha512Context.Intermediate_Hash));
+#ifdef USE_32BIT_ONLY
+      context->ctx.sha512Context.Length[2] = bytecount >> 29;
+      context->ctx.sha512Context.Length[3] = bytecount << 3;
+#else /* !USE_32BIT_ONLY */
+      context->ctx.sha512Context.Length_Low = (uint64_t)bytecount << 3;
+#endif /* USE_32BIT_ONLY */
+      break;
+  }
+  return shaSuccess;
+}
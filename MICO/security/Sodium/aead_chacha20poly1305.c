@@ -0,0 +1,128 @@
+/*
+ * ChaCha20-Poly1305 behind include/MICOCrypto/crypto_aead_chacha20poly1305.h,
+ * the construction of libsodium before the IETF variant, which is what
+ * MicoCrypto.a implemented: 64 bit nonce, the Poly1305 key from block 0,
+ * the message from block 1, and a MAC over
+ * ad || le64(adlen) || ciphertext || le64(clen), without padding.
+ */
+
+#include <string.h>
+
+#include "crypto_aead_chacha20poly1305.h"
+#include "crypto_onetimeauth_poly1305.h"
+#include "crypto_stream_chacha20.h"
+#include "crypto_verify_16.h"
+#include "utils.h"
+
+static void u64_le_from_ull(unsigned char out[8], unsigned long long x)
+{
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        out[i] = (unsigned char) (x & 0xff);
+        x >>= 8;
+    }
+}
+
+static void aead_mac(unsigned char mac[16], const unsigned char *c, unsigned long long clen,
+                     const unsigned char *ad, unsigned long long adlen,
+                     const unsigned char *npub, const unsigned char *k)
+{
+    crypto_onetimeauth_poly1305_state state;
+    unsigned char block0[64];
+    unsigned char slen[8];
+
+    crypto_stream_chacha20(block0, sizeof block0, npub, k);
+    crypto_onetimeauth_poly1305_init(&state, block0);
+    sodium_memzero(block0, sizeof block0);
+
+    crypto_onetimeauth_poly1305_update(&state, ad, adlen);
+    u64_le_from_ull(slen, adlen);
+    crypto_onetimeauth_poly1305_update(&state, slen, sizeof slen);
+    crypto_onetimeauth_poly1305_update(&state, c, clen);
+    u64_le_from_ull(slen, clen);
+    crypto_onetimeauth_poly1305_update(&state, slen, sizeof slen);
+    crypto_onetimeauth_poly1305_final(&state, mac);
+}
+
+int crypto_aead_chacha20poly1305_encrypt(unsigned char *c,
+                                         unsigned long long *clen,
+                                         const unsigned char *m,
+                                         unsigned long long mlen,
+                                         const unsigned char *ad,
+                                         unsigned long long adlen,
+                                         const unsigned char *nsec,
+                                         const unsigned char *npub,
+                                         const unsigned char *k)
+{
+    (void) nsec;
+
+    crypto_stream_chacha20_xor_ic(c, m, mlen, npub, 1U, k);
+    aead_mac(c + mlen, c, mlen, ad, adlen, npub, k);
+    if (clen != NULL) {
+        *clen = mlen + crypto_aead_chacha20poly1305_ABYTES;
+    }
+    return 0;
+}
+
+int crypto_aead_chacha20poly1305_decrypt(unsigned char *m,
+                                         unsigned long long *mlen,
+                                         unsigned char *nsec,
+                                         const unsigned char *c,
+                                         unsigned long long clen,
+                                         const unsigned char *ad,
+                                         unsigned long long adlen,
+                                         const unsigned char *npub,
+                                         const unsigned char *k)
+{
+    unsigned char mac[crypto_aead_chacha20poly1305_ABYTES];
+    unsigned long long len;
+    int ret;
+
+    (void) nsec;
+
+    if (mlen != NULL) {
+        *mlen = 0;
+    }
+    if (clen < crypto_aead_chacha20poly1305_ABYTES) {
+        return -1;
+    }
+    len = clen - crypto_aead_chacha20poly1305_ABYTES;
+
+    aead_mac(mac, c, len, ad, adlen, npub, k);
+    ret = crypto_verify_16(mac, c + len);
+    sodium_memzero(mac, sizeof mac);
+    if (m == NULL) {
+        return ret;
+    }
+    if (ret != 0) {
+        memset(m, 0, (size_t) len);
+        return -1;
+    }
+
+    crypto_stream_chacha20_xor_ic(m, c, len, npub, 1U, k);
+    if (mlen != NULL) {
+        *mlen = len;
+    }
+    return 0;
+}
+
+size_t crypto_aead_chacha20poly1305_keybytes(void)
+{
+    return crypto_aead_chacha20poly1305_KEYBYTES;
+}
+
+size_t crypto_aead_chacha20poly1305_npubbytes(void)
+{
+    return crypto_aead_chacha20poly1305_NPUBBYTES;
+}
+
+size_t crypto_aead_chacha20poly1305_nsecbytes(void)
+{
+    return crypto_aead_chacha20poly1305_NSECBYTES;
+}
+
+size_t crypto_aead_chacha20poly1305_abytes(void)
+{
+    return crypto_aead_chacha20poly1305_ABYTES;
+}
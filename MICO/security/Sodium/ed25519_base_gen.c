@@ -0,0 +1,102 @@
+/*
+ * Host tool that writes ed25519_base.h, the fixed-base table of
+ * ge25519.c. Build it with ED25519_BASE_TABLE=0 so that ge25519.c does
+ * not need the table it is making:
+ *
+ *   cc -DED25519_BASE_TABLE=0 -o ed25519_base_gen \
+ *      ed25519_base_gen.c ge25519.c fe25519.c
+ *   ./ed25519_base_gen > ed25519_base.h
+ *
+ * MICO/security/crypto_bench has this as "make base_table".
+ *
+ * All 32 rows are written, each behind a test of ED25519_BASE_SPACING, so
+ * that a build with fewer ED25519_BASE_ROWS keeps only every k-th row.
+ */
+
+#include <stdio.h>
+
+#include "ge25519.h"
+
+#if ED25519_BASE_TABLE
+#error "build the generator with ED25519_BASE_TABLE=0"
+#endif
+
+/* Canonical, centred limbs, as fe25519_frombytes() leaves them */
+static void normalize(fe25519 f)
+{
+    unsigned char s[32];
+
+    fe25519_tobytes(s, f);
+    fe25519_frombytes(f, s);
+}
+
+static void print_fe(const fe25519 f)
+{
+    int i;
+
+    printf("{ ");
+    for (i = 0; i < 10; i++) {
+        printf("%ld%s", (long) f[i], i < 9 ? ", " : " }");
+    }
+}
+
+static void print_precomp(const ge25519_p3 *p, const char *indent, int last)
+{
+    ge25519_precomp r;
+
+    ge25519_p3_to_precomp(&r, p);
+    normalize(r.yplusx);
+    normalize(r.yminusx);
+    normalize(r.xy2d);
+
+    printf("%s{\n%s    ", indent, indent);
+    print_fe(r.yplusx);
+    printf(",\n%s    ", indent);
+    print_fe(r.yminusx);
+    printf(",\n%s    ", indent);
+    print_fe(r.xy2d);
+    printf("\n%s}%s\n", indent, last ? "" : ",");
+}
+
+int main(void)
+{
+    ge25519_p3 B, row, p, B2;
+    int i, j;
+
+    ge25519_base(&B);
+
+    printf("/* Generated by ed25519_base_gen.c, do not edit */\n\n");
+    printf("static const ge25519_precomp ed25519_base[ED25519_BASE_ROWS][8] = {\n");
+    row = B;
+    for (i = 0; i < 32; i++) {
+        /* Row i of the full table is row i / k of the table with spacing k */
+        if (i > 0) {
+            printf("#if (%d %% ED25519_BASE_SPACING) == 0\n", i);
+        }
+        printf("    {\n");
+        p = row;
+        for (j = 0; j < 8; j++) {
+            print_precomp(&p, "        ", j == 7);
+            ge25519_add_p3(&p, &p, &row);
+        }
+        printf("    },\n");
+        if (i > 0) {
+            printf("#endif\n");
+        }
+        /* row = 256 * row */
+        for (j = 0; j < 8; j++) {
+            ge25519_dbl_p3(&row, &row);
+        }
+    }
+    printf("};\n\n");
+
+    printf("static const ge25519_precomp ed25519_base2[8] = {\n");
+    ge25519_dbl_p3(&B2, &B);
+    p = B;
+    for (i = 0; i < 8; i++) {
+        print_precomp(&p, "    ", i == 7);
+        ge25519_add_p3(&p, &p, &B2);
+    }
+    printf("};\n");
+    return 0;
+}
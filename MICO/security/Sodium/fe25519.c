@@ -0,0 +1,289 @@
+/*
+ * Arithmetic in GF(2^255 - 19) for Ed25519, after the ref10 code of
+ * SUPERCOP. An element is ten signed limbs in radix 2^25.5: the even
+ * limbs hold 26 bits and the odd limbs 25, products are 32x32->64 bit,
+ * which a Cortex-M4 does in one SMLAL.
+ */
+
+#include "fe25519.h"
+
+static void fe25519_carry(fe25519 out, int64_t h[10])
+{
+    int64_t carry;
+
+    /* Two interleaved chains keep the dependency short; ends with |h| < 2^25.5 */
+    carry = (h[0] + ((int64_t) 1 << 25)) >> 26; h[1] += carry; h[0] -= carry * ((int64_t) 1 << 26);
+    carry = (h[4] + ((int64_t) 1 << 25)) >> 26; h[5] += carry; h[4] -= carry * ((int64_t) 1 << 26);
+    carry = (h[1] + ((int64_t) 1 << 24)) >> 25; h[2] += carry; h[1] -= carry * ((int64_t) 1 << 25);
+    carry = (h[5] + ((int64_t) 1 << 24)) >> 25; h[6] += carry; h[5] -= carry * ((int64_t) 1 << 25);
+    carry = (h[2] + ((int64_t) 1 << 25)) >> 26; h[3] += carry; h[2] -= carry * ((int64_t) 1 << 26);
+    carry = (h[6] + ((int64_t) 1 << 25)) >> 26; h[7] += carry; h[6] -= carry * ((int64_t) 1 << 26);
+    carry = (h[3] + ((int64_t) 1 << 24)) >> 25; h[4] += carry; h[3] -= carry * ((int64_t) 1 << 25);
+    carry = (h[7] + ((int64_t) 1 << 24)) >> 25; h[8] += carry; h[7] -= carry * ((int64_t) 1 << 25);
+    carry = (h[4] + ((int64_t) 1 << 25)) >> 26; h[5] += carry; h[4] -= carry * ((int64_t) 1 << 26);
+    carry = (h[8] + ((int64_t) 1 << 25)) >> 26; h[9] += carry; h[8] -= carry * ((int64_t) 1 << 26);
+    carry = (h[9] + ((int64_t) 1 << 24)) >> 25; h[0] += carry * 19; h[9] -= carry * ((int64_t) 1 << 25);
+    carry = (h[0] + ((int64_t) 1 << 25)) >> 26; h[1] += carry; h[0] -= carry * ((int64_t) 1 << 26);
+
+    out[0] = (int32_t) h[0]; out[1] = (int32_t) h[1]; out[2] = (int32_t) h[2];
+    out[3] = (int32_t) h[3]; out[4] = (int32_t) h[4]; out[5] = (int32_t) h[5];
+    out[6] = (int32_t) h[6]; out[7] = (int32_t) h[7]; out[8] = (int32_t) h[8];
+    out[9] = (int32_t) h[9];
+}
+
+void fe25519_frombytes(fe25519 out, const unsigned char s[32])
+{
+    int64_t h[10];
+    uint64_t acc = 0;
+    int bits = 0, in = 0, i;
+
+    /* The top bit is ignored, the value may be up to 2^255 - 1 */
+    for (i = 0; i < 10; i++) {
+        int width = (i & 1) ? 25 : 26;
+        while (bits < width) {
+            acc |= (uint64_t) s[in++] << bits;
+            bits += 8;
+        }
+        h[i] = (int64_t) (acc & ((1U << width) - 1));
+        acc >>= width;
+        bits -= width;
+    }
+    /* Centre the limbs around zero, the bounds of mul and sq assume it */
+    fe25519_carry(out, h);
+}
+
+void fe25519_tobytes(unsigned char s[32], const fe25519 h)
+{
+    int32_t t[10];
+    int32_t q, carry;
+    uint64_t acc = 0;
+    int bits = 0, out = 0, i;
+
+    fe25519_copy(t, h);
+
+    /* q = floor(h / p), from the value rounded up by 19 */
+    q = (19 * t[9] + ((int32_t) 1 << 24)) >> 25;
+    for (i = 0; i < 10; i++) {
+        q = (t[i] + q) >> ((i & 1) ? 25 : 26);
+    }
+
+    /* h - q * p, then carry without rounding into 0 <= h < p */
+    t[0] += 19 * q;
+    for (i = 0; i < 9; i++) {
+        int width = (i & 1) ? 25 : 26;
+        carry = t[i] >> width;
+        t[i + 1] += carry;
+        t[i] -= carry * ((int32_t) 1 << width);
+    }
+    t[9] &= (1 << 25) - 1;
+
+    for (i = 0; i < 10; i++) {
+        acc |= (uint64_t) (uint32_t) t[i] << bits;
+        bits += (i & 1) ? 25 : 26;
+        while (bits >= 8) {
+            s[out++] = (unsigned char) acc;
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+    s[31] = (unsigned char) acc;
+}
+
+void fe25519_mul(fe25519 out, const fe25519 f, const fe25519 g)
+{
+    int32_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+    int32_t f5 = f[5], f6 = f[6], f7 = f[7], f8 = f[8], f9 = f[9];
+    int32_t g0 = g[0], g1 = g[1], g2 = g[2], g3 = g[3], g4 = g[4];
+    int32_t g5 = g[5], g6 = g[6], g7 = g[7], g8 = g[8], g9 = g[9];
+    int32_t g1_19 = 19 * g1, g2_19 = 19 * g2, g3_19 = 19 * g3, g4_19 = 19 * g4, g5_19 = 19 * g5;
+    int32_t g6_19 = 19 * g6, g7_19 = 19 * g7, g8_19 = 19 * g8, g9_19 = 19 * g9;
+    int32_t f1_2 = 2 * f1, f3_2 = 2 * f3, f5_2 = 2 * f5, f7_2 = 2 * f7, f9_2 = 2 * f9;
+    int64_t h0, h1, h2, h3, h4, h5, h6, h7, h8, h9;
+
+    h0 = f0 * (int64_t)g0 + f1_2 * (int64_t)g9_19 + f2 * (int64_t)g8_19 + f3_2 * (int64_t)g7_19
+         + f4 * (int64_t)g6_19 + f5_2 * (int64_t)g5_19 + f6 * (int64_t)g4_19
+         + f7_2 * (int64_t)g3_19 + f8 * (int64_t)g2_19 + f9_2 * (int64_t)g1_19;
+    h1 = f0 * (int64_t)g1 + f1 * (int64_t)g0 + f2 * (int64_t)g9_19 + f3 * (int64_t)g8_19
+         + f4 * (int64_t)g7_19 + f5 * (int64_t)g6_19 + f6 * (int64_t)g5_19 + f7 * (int64_t)g4_19
+         + f8 * (int64_t)g3_19 + f9 * (int64_t)g2_19;
+    h2 = f0 * (int64_t)g2 + f1_2 * (int64_t)g1 + f2 * (int64_t)g0 + f3_2 * (int64_t)g9_19
+         + f4 * (int64_t)g8_19 + f5_2 * (int64_t)g7_19 + f6 * (int64_t)g6_19
+         + f7_2 * (int64_t)g5_19 + f8 * (int64_t)g4_19 + f9_2 * (int64_t)g3_19;
+    h3 = f0 * (int64_t)g3 + f1 * (int64_t)g2 + f2 * (int64_t)g1 + f3 * (int64_t)g0
+         + f4 * (int64_t)g9_19 + f5 * (int64_t)g8_19 + f6 * (int64_t)g7_19 + f7 * (int64_t)g6_19
+         + f8 * (int64_t)g5_19 + f9 * (int64_t)g4_19;
+    h4 = f0 * (int64_t)g4 + f1_2 * (int64_t)g3 + f2 * (int64_t)g2 + f3_2 * (int64_t)g1
+         + f4 * (int64_t)g0 + f5_2 * (int64_t)g9_19 + f6 * (int64_t)g8_19
+         + f7_2 * (int64_t)g7_19 + f8 * (int64_t)g6_19 + f9_2 * (int64_t)g5_19;
+    h5 = f0 * (int64_t)g5 + f1 * (int64_t)g4 + f2 * (int64_t)g3 + f3 * (int64_t)g2
+         + f4 * (int64_t)g1 + f5 * (int64_t)g0 + f6 * (int64_t)g9_19 + f7 * (int64_t)g8_19
+         + f8 * (int64_t)g7_19 + f9 * (int64_t)g6_19;
+    h6 = f0 * (int64_t)g6 + f1_2 * (int64_t)g5 + f2 * (int64_t)g4 + f3_2 * (int64_t)g3
+         + f4 * (int64_t)g2 + f5_2 * (int64_t)g1 + f6 * (int64_t)g0 + f7_2 * (int64_t)g9_19
+         + f8 * (int64_t)g8_19 + f9_2 * (int64_t)g7_19;
+    h7 = f0 * (int64_t)g7 + f1 * (int64_t)g6 + f2 * (int64_t)g5 + f3 * (int64_t)g4
+         + f4 * (int64_t)g3 + f5 * (int64_t)g2 + f6 * (int64_t)g1 + f7 * (int64_t)g0
+         + f8 * (int64_t)g9_19 + f9 * (int64_t)g8_19;
+    h8 = f0 * (int64_t)g8 + f1_2 * (int64_t)g7 + f2 * (int64_t)g6 + f3_2 * (int64_t)g5
+         + f4 * (int64_t)g4 + f5_2 * (int64_t)g3 + f6 * (int64_t)g2 + f7_2 * (int64_t)g1
+         + f8 * (int64_t)g0 + f9_2 * (int64_t)g9_19;
+    h9 = f0 * (int64_t)g9 + f1 * (int64_t)g8 + f2 * (int64_t)g7 + f3 * (int64_t)g6
+         + f4 * (int64_t)g5 + f5 * (int64_t)g4 + f6 * (int64_t)g3 + f7 * (int64_t)g2
+         + f8 * (int64_t)g1 + f9 * (int64_t)g0;
+    int64_t h[10];
+
+    h[0] = h0; h[1] = h1; h[2] = h2; h[3] = h3; h[4] = h4;
+    h[5] = h5; h[6] = h6; h[7] = h7; h[8] = h8; h[9] = h9;
+    fe25519_carry(out, h);
+}
+
+void fe25519_sq(fe25519 out, const fe25519 f)
+{
+    int32_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+    int32_t f5 = f[5], f6 = f[6], f7 = f[7], f8 = f[8], f9 = f[9];
+    int32_t f0_2 = 2 * f0, f1_2 = 2 * f1, f2_2 = 2 * f2, f3_2 = 2 * f3, f4_2 = 2 * f4;
+    int32_t f5_2 = 2 * f5, f6_2 = 2 * f6, f7_2 = 2 * f7, f8_2 = 2 * f8;
+    int32_t f6_19 = 19 * f6, f7_19 = 19 * f7, f8_19 = 19 * f8, f9_19 = 19 * f9;
+    int32_t f5_38 = 38 * f5, f7_38 = 38 * f7, f9_38 = 38 * f9;
+    int64_t h0, h1, h2, h3, h4, h5, h6, h7, h8, h9;
+
+    h0 = f0 * (int64_t)f0 + f1_2 * (int64_t)f9_38 + f2_2 * (int64_t)f8_19
+         + f3_2 * (int64_t)f7_38 + f4_2 * (int64_t)f6_19 + f5 * (int64_t)f5_38;
+    h1 = f0_2 * (int64_t)f1 + f2_2 * (int64_t)f9_19 + f3_2 * (int64_t)f8_19
+         + f4_2 * (int64_t)f7_19 + f5_2 * (int64_t)f6_19;
+    h2 = f0_2 * (int64_t)f2 + f1_2 * (int64_t)f1 + f3_2 * (int64_t)f9_38 + f4_2 * (int64_t)f8_19
+         + f5_2 * (int64_t)f7_38 + f6 * (int64_t)f6_19;
+    h3 = f0_2 * (int64_t)f3 + f1_2 * (int64_t)f2 + f4_2 * (int64_t)f9_19 + f5_2 * (int64_t)f8_19
+         + f6_2 * (int64_t)f7_19;
+    h4 = f0_2 * (int64_t)f4 + f1_2 * (int64_t)f3_2 + f2 * (int64_t)f2 + f5_2 * (int64_t)f9_38
+         + f6_2 * (int64_t)f8_19 + f7 * (int64_t)f7_38;
+    h5 = f0_2 * (int64_t)f5 + f1_2 * (int64_t)f4 + f2_2 * (int64_t)f3 + f6_2 * (int64_t)f9_19
+         + f7_2 * (int64_t)f8_19;
+    h6 = f0_2 * (int64_t)f6 + f1_2 * (int64_t)f5_2 + f2_2 * (int64_t)f4 + f3_2 * (int64_t)f3
+         + f7_2 * (int64_t)f9_38 + f8 * (int64_t)f8_19;
+    h7 = f0_2 * (int64_t)f7 + f1_2 * (int64_t)f6 + f2_2 * (int64_t)f5 + f3_2 * (int64_t)f4
+         + f8_2 * (int64_t)f9_19;
+    h8 = f0_2 * (int64_t)f8 + f1_2 * (int64_t)f7_2 + f2_2 * (int64_t)f6 + f3_2 * (int64_t)f5_2
+         + f4 * (int64_t)f4 + f9 * (int64_t)f9_38;
+    h9 = f0_2 * (int64_t)f9 + f1_2 * (int64_t)f8 + f2_2 * (int64_t)f7 + f3_2 * (int64_t)f6
+         + f4_2 * (int64_t)f5;
+    int64_t h[10];
+
+    h[0] = h0; h[1] = h1; h[2] = h2; h[3] = h3; h[4] = h4;
+    h[5] = h5; h[6] = h6; h[7] = h7; h[8] = h8; h[9] = h9;
+    fe25519_carry(out, h);
+}
+
+/* 2 * f^2 */
+void fe25519_sq2(fe25519 out, const fe25519 f)
+{
+    int32_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+    int32_t f5 = f[5], f6 = f[6], f7 = f[7], f8 = f[8], f9 = f[9];
+    int32_t f0_2 = 2 * f0, f1_2 = 2 * f1, f2_2 = 2 * f2, f3_2 = 2 * f3, f4_2 = 2 * f4;
+    int32_t f5_2 = 2 * f5, f6_2 = 2 * f6, f7_2 = 2 * f7, f8_2 = 2 * f8;
+    int32_t f6_19 = 19 * f6, f7_19 = 19 * f7, f8_19 = 19 * f8, f9_19 = 19 * f9;
+    int32_t f5_38 = 38 * f5, f7_38 = 38 * f7, f9_38 = 38 * f9;
+    int64_t h0, h1, h2, h3, h4, h5, h6, h7, h8, h9;
+
+    h0 = f0 * (int64_t)f0 + f1_2 * (int64_t)f9_38 + f2_2 * (int64_t)f8_19
+         + f3_2 * (int64_t)f7_38 + f4_2 * (int64_t)f6_19 + f5 * (int64_t)f5_38;
+    h1 = f0_2 * (int64_t)f1 + f2_2 * (int64_t)f9_19 + f3_2 * (int64_t)f8_19
+         + f4_2 * (int64_t)f7_19 + f5_2 * (int64_t)f6_19;
+    h2 = f0_2 * (int64_t)f2 + f1_2 * (int64_t)f1 + f3_2 * (int64_t)f9_38 + f4_2 * (int64_t)f8_19
+         + f5_2 * (int64_t)f7_38 + f6 * (int64_t)f6_19;
+    h3 = f0_2 * (int64_t)f3 + f1_2 * (int64_t)f2 + f4_2 * (int64_t)f9_19 + f5_2 * (int64_t)f8_19
+         + f6_2 * (int64_t)f7_19;
+    h4 = f0_2 * (int64_t)f4 + f1_2 * (int64_t)f3_2 + f2 * (int64_t)f2 + f5_2 * (int64_t)f9_38
+         + f6_2 * (int64_t)f8_19 + f7 * (int64_t)f7_38;
+    h5 = f0_2 * (int64_t)f5 + f1_2 * (int64_t)f4 + f2_2 * (int64_t)f3 + f6_2 * (int64_t)f9_19
+         + f7_2 * (int64_t)f8_19;
+    h6 = f0_2 * (int64_t)f6 + f1_2 * (int64_t)f5_2 + f2_2 * (int64_t)f4 + f3_2 * (int64_t)f3
+         + f7_2 * (int64_t)f9_38 + f8 * (int64_t)f8_19;
+    h7 = f0_2 * (int64_t)f7 + f1_2 * (int64_t)f6 + f2_2 * (int64_t)f5 + f3_2 * (int64_t)f4
+         + f8_2 * (int64_t)f9_19;
+    h8 = f0_2 * (int64_t)f8 + f1_2 * (int64_t)f7_2 + f2_2 * (int64_t)f6 + f3_2 * (int64_t)f5_2
+         + f4 * (int64_t)f4 + f9 * (int64_t)f9_38;
+    h9 = f0_2 * (int64_t)f9 + f1_2 * (int64_t)f8 + f2_2 * (int64_t)f7 + f3_2 * (int64_t)f6
+         + f4_2 * (int64_t)f5;
+    int64_t h[10];
+
+    h[0] = 2 * h0; h[1] = 2 * h1; h[2] = 2 * h2; h[3] = 2 * h3; h[4] = 2 * h4;
+    h[5] = 2 * h5; h[6] = 2 * h6; h[7] = 2 * h7; h[8] = 2 * h8; h[9] = 2 * h9;
+    fe25519_carry(out, h);
+}
+
+static void fe25519_sqn(fe25519 h, const fe25519 f, int n)
+{
+    fe25519_sq(h, f);
+    while (--n > 0) {
+        fe25519_sq(h, h);
+    }
+}
+
+/* z^(2^250 - 1) into t1, z^11 into t0 */
+static void fe25519_pow2250(fe25519 t1, fe25519 t0, const fe25519 z)
+{
+    fe25519 t2, t3;
+
+    fe25519_sq(t0, z);                  /* 2 */
+    fe25519_sqn(t1, t0, 2);             /* 8 */
+    fe25519_mul(t1, z, t1);             /* 9 */
+    fe25519_mul(t0, t0, t1);            /* 11 */
+    fe25519_sq(t2, t0);                 /* 22 */
+    fe25519_mul(t1, t1, t2);            /* 2^5 - 1 */
+    fe25519_sqn(t2, t1, 5);
+    fe25519_mul(t1, t2, t1);            /* 2^10 - 1 */
+    fe25519_sqn(t2, t1, 10);
+    fe25519_mul(t2, t2, t1);            /* 2^20 - 1 */
+    fe25519_sqn(t3, t2, 20);
+    fe25519_mul(t2, t3, t2);            /* 2^40 - 1 */
+    fe25519_sqn(t2, t2, 10);
+    fe25519_mul(t1, t2, t1);            /* 2^50 - 1 */
+    fe25519_sqn(t2, t1, 50);
+    fe25519_mul(t2, t2, t1);            /* 2^100 - 1 */
+    fe25519_sqn(t3, t2, 100);
+    fe25519_mul(t2, t3, t2);            /* 2^200 - 1 */
+    fe25519_sqn(t2, t2, 50);
+    fe25519_mul(t1, t2, t1);            /* 2^250 - 1 */
+}
+
+/* z^(p - 2) = z^(2^255 - 21) */
+void fe25519_invert(fe25519 out, const fe25519 z)
+{
+    fe25519 t0, t1;
+
+    fe25519_pow2250(t1, t0, z);
+    fe25519_sqn(t1, t1, 5);             /* 2^255 - 32 */
+    fe25519_mul(out, t1, t0);           /* 2^255 - 21 */
+}
+
+/* z^((p - 5) / 8) = z^(2^252 - 3), for the square root in decoding */
+void fe25519_pow22523(fe25519 out, const fe25519 z)
+{
+    fe25519 t0, t1;
+
+    fe25519_pow2250(t1, t0, z);
+    fe25519_sqn(t1, t1, 2);             /* 2^252 - 4 */
+    fe25519_mul(out, t1, z);            /* 2^252 - 3 */
+}
+
+int fe25519_isnegative(const fe25519 f)
+{
+    unsigned char s[32];
+
+    fe25519_tobytes(s, f);
+    return s[0] & 1;
+}
+
+int fe25519_isnonzero(const fe25519 f)
+{
+    unsigned char s[32];
+    unsigned char d = 0;
+    int i;
+
+    fe25519_tobytes(s, f);
+    for (i = 0; i < 32; i++) {
+        d |= s[i];
+    }
+    return d != 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * Arithmetic in GF(2^255 - 19) for Ed25519, after the ref10 code of
+ * SUPERCOP. An element is ten signed limbs in radix 2^25.5: the even
+ * limbs hold 26 bits and the odd limbs 25, products are 32x32->64 bit,
+ * which a Cortex-M4 does in one SMLAL.
+ */
+
+#ifndef fe25519_H
+#define fe25519_H
+
+#include <stdint.h>
+
+typedef int32_t fe25519[10];
+
+void fe25519_frombytes(fe25519 h, const unsigned char s[32]);
+void fe25519_tobytes(unsigned char s[32], const fe25519 h);
+void fe25519_mul(fe25519 h, const fe25519 f, const fe25519 g);
+void fe25519_sq(fe25519 h, const fe25519 f);
+void fe25519_sq2(fe25519 h, const fe25519 f);
+void fe25519_invert(fe25519 out, const fe25519 z);
+void fe25519_pow22523(fe25519 out, const fe25519 z);
+int  fe25519_isnegative(const fe25519 f);
+int  fe25519_isnonzero(const fe25519 f);
+
+static inline void fe25519_0(fe25519 h)
+{
+    int i;
+    for (i = 0; i < 10; i++) {
+        h[i] = 0;
+    }
+}
+
+static inline void fe25519_1(fe25519 h)
+{
+    fe25519_0(h);
+    h[0] = 1;
+}
+
+static inline void fe25519_copy(fe25519 h, const fe25519 f)
+{
+    int i;
+    for (i = 0; i < 10; i++) {
+        h[i] = f[i];
+    }
+}
+
+/* No carries: the limbs may grow by one bit before the next multiply */
+static inline void fe25519_add(fe25519 h, const fe25519 f, const fe25519 g)
+{
+    int i;
+    for (i = 0; i < 10; i++) {
+        h[i] = f[i] + g[i];
+    }
+}
+
+static inline void fe25519_sub(fe25519 h, const fe25519 f, const fe25519 g)
+{
+    int i;
+    for (i = 0; i < 10; i++) {
+        h[i] = f[i] - g[i];
+    }
+}
+
+static inline void fe25519_neg(fe25519 h, const fe25519 f)
+{
+    int i;
+    for (i = 0; i < 10; i++) {
+        h[i] = -f[i];
+    }
+}
+
+/* f = g if b == 1, f unchanged if b == 0, in constant time */
+static inline void fe25519_cmov(fe25519 f, const fe25519 g, unsigned int b)
+{
+    int32_t mask = -(int32_t) b;
+    int i;
+    for (i = 0; i < 10; i++) {
+        f[i] ^= (f[i] ^ g[i]) & mask;
+    }
+}
+
+#endif
@@ -0,0 +1,553 @@
+/*
+ * Point arithmetic of Ed25519, after the ref10 code of SUPERCOP.
+ */
+
+#include "ge25519.h"
+
+static const fe25519 ge25519_d = {
+    -10913610, 13857413, -15372611, 6949391, 114729, -8787816, -6275908, -3247719, -18696448, -12055116
+};
+
+static const fe25519 ge25519_d2 = {
+    -21827239, -5839606, -30745221, 13898782, 229458, 15978800, -12551817, -6495438, 29715968, 9444199
+};
+
+static const fe25519 ge25519_sqrtm1 = {
+    -32595792, -7943725, 9377950, 3500415, 12389472, -272473, -25146209, -2005654, 326686, 11406482
+};
+
+/* The base point, y = 4/5 with x positive */
+static const unsigned char ge25519_base_y[32] = {
+    0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+    0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66
+};
+
+#if ED25519_BASE_TABLE
+/*
+ * ed25519_base[i][j] = (j + 1) * 256^(ki) * B with k = ED25519_BASE_SPACING,
+ * ed25519_base2[i] = (2i + 1) * B
+ */
+#include "ed25519_base.h"
+#endif
+
+static void ge25519_p2_0(ge25519_p2 *h)
+{
+    fe25519_0(h->X);
+    fe25519_1(h->Y);
+    fe25519_1(h->Z);
+}
+
+static void ge25519_p3_0(ge25519_p3 *h)
+{
+    fe25519_0(h->X);
+    fe25519_1(h->Y);
+    fe25519_1(h->Z);
+    fe25519_0(h->T);
+}
+
+static void ge25519_p1p1_to_p2(ge25519_p2 *r, const ge25519_p1p1 *p)
+{
+    fe25519_mul(r->X, p->X, p->T);
+    fe25519_mul(r->Y, p->Y, p->Z);
+    fe25519_mul(r->Z, p->Z, p->T);
+}
+
+static void ge25519_p1p1_to_p3(ge25519_p3 *r, const ge25519_p1p1 *p)
+{
+    fe25519_mul(r->X, p->X, p->T);
+    fe25519_mul(r->Y, p->Y, p->Z);
+    fe25519_mul(r->Z, p->Z, p->T);
+    fe25519_mul(r->T, p->X, p->Y);
+}
+
+static void ge25519_p3_to_p2(ge25519_p2 *r, const ge25519_p3 *p)
+{
+    fe25519_copy(r->X, p->X);
+    fe25519_copy(r->Y, p->Y);
+    fe25519_copy(r->Z, p->Z);
+}
+
+static void ge25519_p3_to_cached(ge25519_cached *r, const ge25519_p3 *p)
+{
+    fe25519_add(r->YplusX, p->Y, p->X);
+    fe25519_sub(r->YminusX, p->Y, p->X);
+    fe25519_copy(r->Z, p->Z);
+    fe25519_mul(r->T2d, p->T, ge25519_d2);
+}
+
+/* r = 2 * p */
+static void ge25519_p2_dbl(ge25519_p1p1 *r, const ge25519_p2 *p)
+{
+    fe25519 t0;
+
+    fe25519_sq(r->X, p->X);
+    fe25519_sq(r->Z, p->Y);
+    fe25519_sq2(r->T, p->Z);
+    fe25519_add(r->Y, p->X, p->Y);
+    fe25519_sq(t0, r->Y);
+    fe25519_add(r->Y, r->Z, r->X);
+    fe25519_sub(r->Z, r->Z, r->X);
+    fe25519_sub(r->X, t0, r->Y);
+    fe25519_sub(r->T, r->T, r->Z);
+}
+
+static void ge25519_p3_dbl(ge25519_p1p1 *r, const ge25519_p3 *p)
+{
+    ge25519_p2 q;
+
+    ge25519_p3_to_p2(&q, p);
+    ge25519_p2_dbl(r, &q);
+}
+
+/* r = p + q */
+static void ge25519_add(ge25519_p1p1 *r, const ge25519_p3 *p, const ge25519_cached *q)
+{
+    fe25519 t0;
+
+    fe25519_add(r->X, p->Y, p->X);
+    fe25519_sub(r->Y, p->Y, p->X);
+    fe25519_mul(r->Z, r->X, q->YplusX);
+    fe25519_mul(r->Y, r->Y, q->YminusX);
+    fe25519_mul(r->T, q->T2d, p->T);
+    fe25519_mul(r->X, p->Z, q->Z);
+    fe25519_add(t0, r->X, r->X);
+    fe25519_sub(r->X, r->Z, r->Y);
+    fe25519_add(r->Y, r->Z, r->Y);
+    fe25519_add(r->Z, t0, r->T);
+    fe25519_sub(r->T, t0, r->T);
+}
+
+/* r = p - q */
+static void ge25519_sub(ge25519_p1p1 *r, const ge25519_p3 *p, const ge25519_cached *q)
+{
+    fe25519 t0;
+
+    fe25519_add(r->X, p->Y, p->X);
+    fe25519_sub(r->Y, p->Y, p->X);
+    fe25519_mul(r->Z, r->X, q->YminusX);
+    fe25519_mul(r->Y, r->Y, q->YplusX);
+    fe25519_mul(r->T, q->T2d, p->T);
+    fe25519_mul(r->X, p->Z, q->Z);
+    fe25519_add(t0, r->X, r->X);
+    fe25519_sub(r->X, r->Z, r->Y);
+    fe25519_add(r->Y, r->Z, r->Y);
+    fe25519_sub(r->Z, t0, r->T);
+    fe25519_add(r->T, t0, r->T);
+}
+
+#if ED25519_BASE_TABLE
+/* r = p + q, q affine */
+static void ge25519_madd(ge25519_p1p1 *r, const ge25519_p3 *p, const ge25519_precomp *q)
+{
+    fe25519 t0;
+
+    fe25519_add(r->X, p->Y, p->X);
+    fe25519_sub(r->Y, p->Y, p->X);
+    fe25519_mul(r->Z, r->X, q->yplusx);
+    fe25519_mul(r->Y, r->Y, q->yminusx);
+    fe25519_mul(r->T, q->xy2d, p->T);
+    fe25519_add(t0, p->Z, p->Z);
+    fe25519_sub(r->X, r->Z, r->Y);
+    fe25519_add(r->Y, r->Z, r->Y);
+    fe25519_add(r->Z, t0, r->T);
+    fe25519_sub(r->T, t0, r->T);
+}
+
+/* r = p - q, q affine */
+static void ge25519_msub(ge25519_p1p1 *r, const ge25519_p3 *p, const ge25519_precomp *q)
+{
+    fe25519 t0;
+
+    fe25519_add(r->X, p->Y, p->X);
+    fe25519_sub(r->Y, p->Y, p->X);
+    fe25519_mul(r->Z, r->X, q->yminusx);
+    fe25519_mul(r->Y, r->Y, q->yplusx);
+    fe25519_mul(r->T, q->xy2d, p->T);
+    fe25519_add(t0, p->Z, p->Z);
+    fe25519_sub(r->X, r->Z, r->Y);
+    fe25519_add(r->Y, r->Z, r->Y);
+    fe25519_sub(r->Z, t0, r->T);
+    fe25519_add(r->T, t0, r->T);
+}
+#endif
+
+int ge25519_frombytes_negate_vartime(ge25519_p3 *h, const unsigned char s[32])
+{
+    fe25519 u, v, v3, vxx, check;
+
+    fe25519_frombytes(h->Y, s);
+    fe25519_1(h->Z);
+    fe25519_sq(u, h->Y);
+    fe25519_mul(v, u, ge25519_d);
+    fe25519_sub(u, u, h->Z);            /* u = y^2 - 1 */
+    fe25519_add(v, v, h->Z);            /* v = dy^2 + 1 */
+
+    fe25519_sq(v3, v);
+    fe25519_mul(v3, v3, v);             /* v3 = v^3 */
+    fe25519_sq(h->X, v3);
+    fe25519_mul(h->X, h->X, v);
+    fe25519_mul(h->X, h->X, u);         /* x = uv^7 */
+
+    fe25519_pow22523(h->X, h->X);       /* x = (uv^7)^((q - 5) / 8) */
+    fe25519_mul(h->X, h->X, v3);
+    fe25519_mul(h->X, h->X, u);         /* x = uv^3 (uv^7)^((q - 5) / 8) */
+
+    fe25519_sq(vxx, h->X);
+    fe25519_mul(vxx, vxx, v);
+    fe25519_sub(check, vxx, u);         /* vx^2 - u */
+    if (fe25519_isnonzero(check)) {
+        fe25519_add(check, vxx, u);     /* vx^2 + u */
+        if (fe25519_isnonzero(check)) {
+            return -1;
+        }
+        fe25519_mul(h->X, h->X, ge25519_sqrtm1);
+    }
+
+    if (fe25519_isnegative(h->X) == (s[31] >> 7)) {
+        fe25519_neg(h->X, h->X);
+    }
+    fe25519_mul(h->T, h->X, h->Y);
+    return 0;
+}
+
+void ge25519_tobytes(unsigned char s[32], const ge25519_p2 *h)
+{
+    fe25519 recip, x, y;
+
+    fe25519_invert(recip, h->Z);
+    fe25519_mul(x, h->X, recip);
+    fe25519_mul(y, h->Y, recip);
+    fe25519_tobytes(s, y);
+    s[31] ^= fe25519_isnegative(x) << 7;
+}
+
+void ge25519_p3_tobytes(unsigned char s[32], const ge25519_p3 *h)
+{
+    ge25519_p2 p;
+
+    ge25519_p3_to_p2(&p, h);
+    ge25519_tobytes(s, &p);
+}
+
+void ge25519_base(ge25519_p3 *h)
+{
+    ge25519_frombytes_negate_vartime(h, ge25519_base_y);
+    fe25519_neg(h->X, h->X);
+    fe25519_neg(h->T, h->T);
+}
+
+void ge25519_p3_to_precomp(ge25519_precomp *r, const ge25519_p3 *p)
+{
+    fe25519 recip, x, y;
+
+    fe25519_invert(recip, p->Z);
+    fe25519_mul(x, p->X, recip);
+    fe25519_mul(y, p->Y, recip);
+    fe25519_add(r->yplusx, y, x);
+    fe25519_sub(r->yminusx, y, x);
+    fe25519_mul(r->xy2d, x, y);
+    fe25519_mul(r->xy2d, r->xy2d, ge25519_d2);
+}
+
+void ge25519_add_p3(ge25519_p3 *r, const ge25519_p3 *p, const ge25519_p3 *q)
+{
+    ge25519_cached c;
+    ge25519_p1p1 t;
+
+    ge25519_p3_to_cached(&c, q);
+    ge25519_add(&t, p, &c);
+    ge25519_p1p1_to_p3(r, &t);
+}
+
+void ge25519_dbl_p3(ge25519_p3 *r, const ge25519_p3 *p)
+{
+    ge25519_p1p1 t;
+
+    ge25519_p3_dbl(&t, p);
+    ge25519_p1p1_to_p3(r, &t);
+}
+
+/* 1 if b == c, in constant time */
+static unsigned char ge25519_equal(signed char b, signed char c)
+{
+    unsigned char ub = b;
+    unsigned char uc = c;
+    unsigned char x = ub ^ uc;
+    uint32_t y = x;
+
+    y -= 1;
+    y >>= 31;
+    return (unsigned char) y;
+}
+
+static unsigned char ge25519_negative(signed char b)
+{
+    uint64_t x = b;
+
+    x >>= 63;
+    return (unsigned char) x;
+}
+
+/* a[0] + 16 a[1] + ... + 16^63 a[63] with -8 <= a[i] <= 8 */
+static void ge25519_radix16(signed char e[64], const unsigned char a[32])
+{
+    signed char carry;
+    int i;
+
+    for (i = 0; i < 32; i++) {
+        e[2 * i + 0] = (a[i] >> 0) & 15;
+        e[2 * i + 1] = (a[i] >> 4) & 15;
+    }
+    carry = 0;
+    for (i = 0; i < 63; i++) {
+        e[i] += carry;
+        carry = e[i] + 8;
+        carry >>= 4;
+        e[i] -= carry * ((signed char) 1 << 4);
+    }
+    e[63] += carry;
+}
+
+#if ED25519_BASE_TABLE
+
+static void ge25519_cmov_precomp(ge25519_precomp *t, const ge25519_precomp *u, unsigned char b)
+{
+    fe25519_cmov(t->yplusx, u->yplusx, b);
+    fe25519_cmov(t->yminusx, u->yminusx, b);
+    fe25519_cmov(t->xy2d, u->xy2d, b);
+}
+
+/* t = b times the row pos point, reading every entry of the row */
+static void ge25519_select_precomp(ge25519_precomp *t, int pos, signed char b)
+{
+    ge25519_precomp minust;
+    unsigned char bnegative = ge25519_negative(b);
+    unsigned char babs = b - (((-bnegative) & b) * ((signed char) 1 << 1));
+    int i;
+
+    fe25519_1(t->yplusx);
+    fe25519_1(t->yminusx);
+    fe25519_0(t->xy2d);
+    for (i = 0; i < 8; i++) {
+        ge25519_cmov_precomp(t, &ed25519_base[pos][i], ge25519_equal(babs, i + 1));
+    }
+    fe25519_copy(minust.yplusx, t->yminusx);
+    fe25519_copy(minust.yminusx, t->yplusx);
+    fe25519_neg(minust.xy2d, t->xy2d);
+    ge25519_cmov_precomp(t, &minust, bnegative);
+}
+
+/*
+ * Digit e[2ki + j] multiplies 16^j times row i, so the comb runs j from
+ * 2k - 1 down to 0, adding one digit from every row and multiplying by 16
+ * in between. With the full table (k = 1) that is the odd digits, four
+ * doublings, then the even digits.
+ */
+void ge25519_scalarmult_base(ge25519_p3 *h, const unsigned char a[32])
+{
+    signed char e[64];
+    ge25519_p1p1 r;
+    ge25519_p2 s;
+    ge25519_precomp t;
+    int i, j;
+
+    ge25519_radix16(e, a);
+
+    ge25519_p3_0(h);
+    for (j = 2 * ED25519_BASE_SPACING - 1; j >= 0; j--) {
+        if (j != 2 * ED25519_BASE_SPACING - 1) {
+            ge25519_p3_dbl(&r, h);
+            ge25519_p1p1_to_p2(&s, &r);
+            ge25519_p2_dbl(&r, &s);
+            ge25519_p1p1_to_p2(&s, &r);
+            ge25519_p2_dbl(&r, &s);
+            ge25519_p1p1_to_p2(&s, &r);
+            ge25519_p2_dbl(&r, &s);
+            ge25519_p1p1_to_p3(h, &r);
+        }
+        for (i = 0; i < ED25519_BASE_ROWS; i++) {
+            ge25519_select_precomp(&t, i, e[2 * ED25519_BASE_SPACING * i + j]);
+            ge25519_madd(&r, h, &t);
+            ge25519_p1p1_to_p3(h, &r);
+        }
+    }
+}
+
+#else
+
+static void ge25519_cmov_cached(ge25519_cached *t, const ge25519_cached *u, unsigned char b)
+{
+    fe25519_cmov(t->YplusX, u->YplusX, b);
+    fe25519_cmov(t->YminusX, u->YminusX, b);
+    fe25519_cmov(t->Z, u->Z, b);
+    fe25519_cmov(t->T2d, u->T2d, b);
+}
+
+static void ge25519_select_cached(ge25519_cached *t, const ge25519_cached multiples[8], signed char b)
+{
+    ge25519_cached minust;
+    unsigned char bnegative = ge25519_negative(b);
+    unsigned char babs = b - (((-bnegative) & b) * ((signed char) 1 << 1));
+    int i;
+
+    fe25519_1(t->YplusX);
+    fe25519_1(t->YminusX);
+    fe25519_1(t->Z);
+    fe25519_0(t->T2d);
+    for (i = 0; i < 8; i++) {
+        ge25519_cmov_cached(t, &multiples[i], ge25519_equal(babs, i + 1));
+    }
+    fe25519_copy(minust.YplusX, t->YminusX);
+    fe25519_copy(minust.YminusX, t->YplusX);
+    fe25519_copy(minust.Z, t->Z);
+    fe25519_neg(minust.T2d, t->T2d);
+    ge25519_cmov_cached(t, &minust, bnegative);
+}
+
+void ge25519_scalarmult_base(ge25519_p3 *h, const unsigned char a[32])
+{
+    signed char e[64];
+    ge25519_cached multiples[8], t;
+    ge25519_p3 B, p;
+    ge25519_p1p1 r;
+    ge25519_p2 s;
+    int i;
+
+    ge25519_radix16(e, a);
+
+    /* 1B .. 8B */
+    ge25519_base(&B);
+    p = B;
+    ge25519_p3_to_cached(&multiples[0], &B);
+    for (i = 1; i < 8; i++) {
+        ge25519_add(&r, &p, &multiples[0]);
+        ge25519_p1p1_to_p3(&p, &r);
+        ge25519_p3_to_cached(&multiples[i], &p);
+    }
+
+    ge25519_p3_0(h);
+    for (i = 63; i >= 0; i--) {
+        if (i != 63) {
+            ge25519_p3_dbl(&r, h);
+            ge25519_p1p1_to_p2(&s, &r);
+            ge25519_p2_dbl(&r, &s);
+            ge25519_p1p1_to_p2(&s, &r);
+            ge25519_p2_dbl(&r, &s);
+            ge25519_p1p1_to_p2(&s, &r);
+            ge25519_p2_dbl(&r, &s);
+            ge25519_p1p1_to_p3(h, &r);
+        }
+        ge25519_select_cached(&t, multiples, e[i]);
+        ge25519_add(&r, h, &t);
+        ge25519_p1p1_to_p3(h, &r);
+    }
+}
+
+#endif
+
+/* Signed sliding window of width 5: digits are odd, |r[i]| <= 15 */
+static void ge25519_slide(signed char r[256], const unsigned char a[32])
+{
+    int i, b, k;
+
+    for (i = 0; i < 256; i++) {
+        r[i] = 1 & (a[i >> 3] >> (i & 7));
+    }
+    for (i = 0; i < 256; i++) {
+        if (!r[i]) {
+            continue;
+        }
+        for (b = 1; b <= 6 && i + b < 256; b++) {
+            if (!r[i + b]) {
+                continue;
+            }
+            if (r[i] + (r[i + b] << b) <= 15) {
+                r[i] += r[i + b] << b;
+                r[i + b] = 0;
+            } else if (r[i] - (r[i + b] << b) >= -15) {
+                r[i] -= r[i + b] << b;
+                for (k = i + b; k < 256; k++) {
+                    if (!r[k]) {
+                        r[k] = 1;
+                        break;
+                    }
+                    r[k] = 0;
+                }
+            } else {
+                break;
+            }
+        }
+    }
+}
+
+void ge25519_double_scalarmult_vartime(ge25519_p2 *r, const unsigned char a[32],
+                                       const ge25519_p3 *A, const unsigned char b[32])
+{
+    signed char aslide[256], bslide[256];
+    ge25519_cached Ai[8];               /* A, 3A, 5A, ..., 15A */
+    ge25519_p1p1 t;
+    ge25519_p3 u, A2;
+    int i;
+#if !ED25519_BASE_TABLE
+    ge25519_cached Bi[8];               /* B, 3B, 5B, ..., 15B */
+    ge25519_p3 B;
+#endif
+
+    ge25519_slide(aslide, a);
+    ge25519_slide(bslide, b);
+
+    ge25519_p3_to_cached(&Ai[0], A);
+    ge25519_p3_dbl(&t, A);
+    ge25519_p1p1_to_p3(&A2, &t);
+    for (i = 0; i < 7; i++) {
+        ge25519_add(&t, &A2, &Ai[i]);
+        ge25519_p1p1_to_p3(&u, &t);
+        ge25519_p3_to_cached(&Ai[i + 1], &u);
+    }
+#if !ED25519_BASE_TABLE
+    ge25519_base(&B);
+    ge25519_p3_to_cached(&Bi[0], &B);
+    ge25519_p3_dbl(&t, &B);
+    ge25519_p1p1_to_p3(&A2, &t);
+    for (i = 0; i < 7; i++) {
+        ge25519_add(&t, &A2, &Bi[i]);
+        ge25519_p1p1_to_p3(&u, &t);
+        ge25519_p3_to_cached(&Bi[i + 1], &u);
+    }
+#endif
+
+    ge25519_p2_0(r);
+    for (i = 255; i >= 0; i--) {
+        if (aslide[i] || bslide[i]) {
+            break;
+        }
+    }
+    for (; i >= 0; i--) {
+        ge25519_p2_dbl(&t, r);
+        if (aslide[i] > 0) {
+            ge25519_p1p1_to_p3(&u, &t);
+            ge25519_add(&t, &u, &Ai[aslide[i] / 2]);
+        } else if (aslide[i] < 0) {
+            ge25519_p1p1_to_p3(&u, &t);
+            ge25519_sub(&t, &u, &Ai[(-aslide[i]) / 2]);
+        }
+#if ED25519_BASE_TABLE
+        if (bslide[i] > 0) {
+            ge25519_p1p1_to_p3(&u, &t);
+            ge25519_madd(&t, &u, &ed25519_base2[bslide[i] / 2]);
+        } else if (bslide[i] < 0) {
+            ge25519_p1p1_to_p3(&u, &t);
+            ge25519_msub(&t, &u, &ed25519_base2[(-bslide[i]) / 2]);
+        }
+#else
+        if (bslide[i] > 0) {
+            ge25519_p1p1_to_p3(&u, &t);
+            ge25519_add(&t, &u, &Bi[bslide[i] / 2]);
+        } else if (bslide[i] < 0) {
+            ge25519_p1p1_to_p3(&u, &t);
+            ge25519_sub(&t, &u, &Bi[(-bslide[i]) / 2]);
+        }
+#endif
+        ge25519_p1p1_to_p2(r, &t);
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ * The twisted Edwards curve of Ed25519, -x^2 + y^2 = 1 + d x^2 y^2, after
+ * the ref10 code of SUPERCOP.
+ *
+ * ED25519_BASE_TABLE selects how the fixed base point is multiplied:
+ *   1  radix-16 comb over a precomputed table of ED25519_BASE_ROWS x 8
+ *      points in flash (ed25519_base.h, 960 bytes a row).
+ *   0  signed 4 bit window over 8 multiples computed at run time: no
+ *      table, but 252 doublings per scalar.
+ *
+ * ED25519_BASE_ROWS (1, 2, 4, 8, 16 or 32) trades flash for doublings:
+ * row i holds 1..8 times 16^(2ki) B with k = 32 / ED25519_BASE_ROWS, and
+ * a scalar costs 64 additions and 4 (2k - 1) doublings.
+ *
+ *   rows   32     16     8      4      2      1
+ *   flash  30 KB  15 KB  7.5 KB 3.8 KB 1.9 KB 960 B
+ *   dbl    4      12     28     60     124    252
+ */
+
+#ifndef ge25519_H
+#define ge25519_H
+
+#include "fe25519.h"
+
+#ifndef ED25519_BASE_TABLE
+#define ED25519_BASE_TABLE  1
+#endif
+
+#ifndef ED25519_BASE_ROWS
+#define ED25519_BASE_ROWS   32
+#endif
+
+#if ED25519_BASE_ROWS != 1 && ED25519_BASE_ROWS != 2 && ED25519_BASE_ROWS != 4 && \
+    ED25519_BASE_ROWS != 8 && ED25519_BASE_ROWS != 16 && ED25519_BASE_ROWS != 32
+#error "ED25519_BASE_ROWS must be 1, 2, 4, 8, 16 or 32"
+#endif
+
+/* Distance between table rows in pairs of radix-16 digits */
+#define ED25519_BASE_SPACING    (32 / ED25519_BASE_ROWS)
+
+/* (X:Y:Z) with x = X/Z, y = Y/Z */
+typedef struct {
+    fe25519 X;
+    fe25519 Y;
+    fe25519 Z;
+} ge25519_p2;
+
+/* (X:Y:Z:T) with also XY = ZT */
+typedef struct {
+    fe25519 X;
+    fe25519 Y;
+    fe25519 Z;
+    fe25519 T;
+} ge25519_p3;
+
+/* ((X:Z),(Y:T)) with x = X/Z, y = Y/T, the result of an addition */
+typedef struct {
+    fe25519 X;
+    fe25519 Y;
+    fe25519 Z;
+    fe25519 T;
+} ge25519_p1p1;
+
+/* (y+x, y-x, 2dxy) of an affine point */
+typedef struct {
+    fe25519 yplusx;
+    fe25519 yminusx;
+    fe25519 xy2d;
+} ge25519_precomp;
+
+/* (Y+X, Y-X, Z, 2dT) */
+typedef struct {
+    fe25519 YplusX;
+    fe25519 YminusX;
+    fe25519 Z;
+    fe25519 T2d;
+} ge25519_cached;
+
+int  ge25519_frombytes_negate_vartime(ge25519_p3 *h, const unsigned char s[32]);
+void ge25519_tobytes(unsigned char s[32], const ge25519_p2 *h);
+void ge25519_p3_tobytes(unsigned char s[32], const ge25519_p3 *h);
+
+/* h = a * B, a = a[0] + 256 * a[1] + ... + 256^31 a[31] with a[31] <= 127 */
+void ge25519_scalarmult_base(ge25519_p3 *h, const unsigned char a[32]);
+
+/* r = a * A + b * B, variable time: only for public values */
+void ge25519_double_scalarmult_vartime(ge25519_p2 *r, const unsigned char a[32],
+                                       const ge25519_p3 *A, const unsigned char b[32]);
+
+/* For ed25519_base_gen.c */
+void ge25519_base(ge25519_p3 *h);
+void ge25519_p3_to_precomp(ge25519_precomp *r, const ge25519_p3 *p);
+void ge25519_add_p3(ge25519_p3 *r, const ge25519_p3 *p, const ge25519_p3 *q);
+void ge25519_dbl_p3(ge25519_p3 *r, const ge25519_p3 *p);
+
+#endif
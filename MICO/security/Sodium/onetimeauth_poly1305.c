@@ -0,0 +1,239 @@
+/*
+ * Poly1305 (RFC 8439 section 2.5) behind
+ * include/MICOCrypto/crypto_onetimeauth_poly1305.h, after poly1305-donna:
+ * the accumulator and r in five 26 bit limbs, 32x32->64 bit products, so
+ * a 16 byte block is 25 UMULL/UMLAL on a Cortex-M4.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "crypto_onetimeauth_poly1305.h"
+#include "crypto_verify_16.h"
+#include "utils.h"
+
+#define POLY1305_BLOCK_SIZE 16
+
+static uint32_t load32_le(const unsigned char *src)
+{
+    return (uint32_t) src[0] | ((uint32_t) src[1] << 8) |
+           ((uint32_t) src[2] << 16) | ((uint32_t) src[3] << 24);
+}
+
+static void store32_le(unsigned char *dst, uint32_t w)
+{
+    dst[0] = (unsigned char) w;
+    dst[1] = (unsigned char) (w >> 8);
+    dst[2] = (unsigned char) (w >> 16);
+    dst[3] = (unsigned char) (w >> 24);
+}
+
+static void poly1305_blocks(crypto_onetimeauth_poly1305_state *st,
+                            const unsigned char *m, size_t bytes)
+{
+    const uint32_t hibit = st->final ? 0 : (1UL << 24); /* 2^128 */
+    const uint32_t r0 = st->r[0], r1 = st->r[1], r2 = st->r[2], r3 = st->r[3], r4 = st->r[4];
+    const uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    uint32_t h0 = st->h[0], h1 = st->h[1], h2 = st->h[2], h3 = st->h[3], h4 = st->h[4];
+    uint64_t d0, d1, d2, d3, d4;
+    uint32_t c;
+
+    while (bytes >= POLY1305_BLOCK_SIZE) {
+        /* h += m[i] */
+        h0 += (load32_le(m + 0)) & 0x3ffffff;
+        h1 += (load32_le(m + 3) >> 2) & 0x3ffffff;
+        h2 += (load32_le(m + 6) >> 4) & 0x3ffffff;
+        h3 += (load32_le(m + 9) >> 6) & 0x3ffffff;
+        h4 += (load32_le(m + 12) >> 8) | hibit;
+
+        /* h *= r, the limbs above 2^130 fold back times 5 */
+        d0 = ((uint64_t) h0 * r0) + ((uint64_t) h1 * s4) + ((uint64_t) h2 * s3) +
+             ((uint64_t) h3 * s2) + ((uint64_t) h4 * s1);
+        d1 = ((uint64_t) h0 * r1) + ((uint64_t) h1 * r0) + ((uint64_t) h2 * s4) +
+             ((uint64_t) h3 * s3) + ((uint64_t) h4 * s2);
+        d2 = ((uint64_t) h0 * r2) + ((uint64_t) h1 * r1) + ((uint64_t) h2 * r0) +
+             ((uint64_t) h3 * s4) + ((uint64_t) h4 * s3);
+        d3 = ((uint64_t) h0 * r3) + ((uint64_t) h1 * r2) + ((uint64_t) h2 * r1) +
+             ((uint64_t) h3 * r0) + ((uint64_t) h4 * s4);
+        d4 = ((uint64_t) h0 * r4) + ((uint64_t) h1 * r3) + ((uint64_t) h2 * r2) +
+             ((uint64_t) h3 * r1) + ((uint64_t) h4 * r0);
+
+        /* (partial) h %= p */
+        c = (uint32_t) (d0 >> 26); h0 = (uint32_t) d0 & 0x3ffffff;
+        d1 += c; c = (uint32_t) (d1 >> 26); h1 = (uint32_t) d1 & 0x3ffffff;
+        d2 += c; c = (uint32_t) (d2 >> 26); h2 = (uint32_t) d2 & 0x3ffffff;
+        d3 += c; c = (uint32_t) (d3 >> 26); h3 = (uint32_t) d3 & 0x3ffffff;
+        d4 += c; c = (uint32_t) (d4 >> 26); h4 = (uint32_t) d4 & 0x3ffffff;
+        h0 += c * 5; c = (h0 >> 26); h0 = h0 & 0x3ffffff;
+        h1 += c;
+
+        m += POLY1305_BLOCK_SIZE;
+        bytes -= POLY1305_BLOCK_SIZE;
+    }
+
+    st->h[0] = h0; st->h[1] = h1; st->h[2] = h2; st->h[3] = h3; st->h[4] = h4;
+}
+
+size_t crypto_onetimeauth_poly1305_bytes(void)
+{
+    return crypto_onetimeauth_poly1305_BYTES;
+}
+
+size_t crypto_onetimeauth_poly1305_keybytes(void)
+{
+    return crypto_onetimeauth_poly1305_KEYBYTES;
+}
+
+int crypto_onetimeauth_poly1305_init(crypto_onetimeauth_poly1305_state *st,
+                                     const unsigned char *key)
+{
+    /* r &= 0xffffffc0ffffffc0ffffffc0fffffff */
+    st->r[0] = (load32_le(key + 0)) & 0x3ffffff;
+    st->r[1] = (load32_le(key + 3) >> 2) & 0x3ffff03;
+    st->r[2] = (load32_le(key + 6) >> 4) & 0x3ffc0ff;
+    st->r[3] = (load32_le(key + 9) >> 6) & 0x3f03fff;
+    st->r[4] = (load32_le(key + 12) >> 8) & 0x00fffff;
+
+    st->h[0] = st->h[1] = st->h[2] = st->h[3] = st->h[4] = 0;
+
+    st->pad[0] = load32_le(key + 16);
+    st->pad[1] = load32_le(key + 20);
+    st->pad[2] = load32_le(key + 24);
+    st->pad[3] = load32_le(key + 28);
+
+    st->leftover = 0;
+    st->final = 0;
+    return 0;
+}
+
+int crypto_onetimeauth_poly1305_update(crypto_onetimeauth_poly1305_state *st,
+                                       const unsigned char *m,
+                                       unsigned long long inlen)
+{
+    size_t bytes = (size_t) inlen;
+    size_t i, want;
+
+    /* Top up a partial block first */
+    if (st->leftover) {
+        want = POLY1305_BLOCK_SIZE - st->leftover;
+        if (want > bytes) {
+            want = bytes;
+        }
+        for (i = 0; i < want; i++) {
+            st->buffer[st->leftover + i] = m[i];
+        }
+        bytes -= want;
+        m += want;
+        st->leftover += want;
+        if (st->leftover < POLY1305_BLOCK_SIZE) {
+            return 0;
+        }
+        poly1305_blocks(st, st->buffer, POLY1305_BLOCK_SIZE);
+        st->leftover = 0;
+    }
+
+    /* Whole blocks straight from the input */
+    if (bytes >= POLY1305_BLOCK_SIZE) {
+        want = bytes & ~(size_t) (POLY1305_BLOCK_SIZE - 1);
+        poly1305_blocks(st, m, want);
+        m += want;
+        bytes -= want;
+    }
+
+    if (bytes) {
+        for (i = 0; i < bytes; i++) {
+            st->buffer[st->leftover + i] = m[i];
+        }
+        st->leftover += bytes;
+    }
+    return 0;
+}
+
+int crypto_onetimeauth_poly1305_final(crypto_onetimeauth_poly1305_state *st,
+                                      unsigned char *mac)
+{
+    uint32_t h0, h1, h2, h3, h4, c;
+    uint32_t g0, g1, g2, g3, g4;
+    uint64_t f;
+    uint32_t mask;
+
+    /* The last block is padded with a 1 and zeros, without the 2^128 bit */
+    if (st->leftover) {
+        size_t i = st->leftover;
+        st->buffer[i++] = 1;
+        for (; i < POLY1305_BLOCK_SIZE; i++) {
+            st->buffer[i] = 0;
+        }
+        st->final = 1;
+        poly1305_blocks(st, st->buffer, POLY1305_BLOCK_SIZE);
+    }
+
+    /* Fully carry h */
+    h0 = st->h[0]; h1 = st->h[1]; h2 = st->h[2]; h3 = st->h[3]; h4 = st->h[4];
+    c = h1 >> 26; h1 = h1 & 0x3ffffff;
+    h2 += c; c = h2 >> 26; h2 = h2 & 0x3ffffff;
+    h3 += c; c = h3 >> 26; h3 = h3 & 0x3ffffff;
+    h4 += c; c = h4 >> 26; h4 = h4 & 0x3ffffff;
+    h0 += c * 5; c = h0 >> 26; h0 = h0 & 0x3ffffff;
+    h1 += c;
+
+    /* g = h + -p */
+    g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+    g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+    g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+    g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+    g4 = h4 + c - (1UL << 26);
+
+    /* h = g if h >= p, without a branch */
+    mask = (g4 >> 31) - 1;
+    g0 &= mask; g1 &= mask; g2 &= mask; g3 &= mask; g4 &= mask;
+    mask = ~mask;
+    h0 = (h0 & mask) | g0;
+    h1 = (h1 & mask) | g1;
+    h2 = (h2 & mask) | g2;
+    h3 = (h3 & mask) | g3;
+    h4 = (h4 & mask) | g4;
+
+    /* h = h % 2^128 */
+    h0 = ((h0) | (h1 << 26)) & 0xffffffff;
+    h1 = ((h1 >> 6) | (h2 << 20)) & 0xffffffff;
+    h2 = ((h2 >> 12) | (h3 << 14)) & 0xffffffff;
+    h3 = ((h3 >> 18) | (h4 << 8)) & 0xffffffff;
+
+    /* mac = (h + pad) % 2^128 */
+    f = (uint64_t) h0 + st->pad[0]; h0 = (uint32_t) f;
+    f = (uint64_t) h1 + st->pad[1] + (f >> 32); h1 = (uint32_t) f;
+    f = (uint64_t) h2 + st->pad[2] + (f >> 32); h2 = (uint32_t) f;
+    f = (uint64_t) h3 + st->pad[3] + (f >> 32); h3 = (uint32_t) f;
+
+    store32_le(mac + 0, h0);
+    store32_le(mac + 4, h1);
+    store32_le(mac + 8, h2);
+    store32_le(mac + 12, h3);
+
+    sodium_memzero(st, sizeof *st);
+    return 0;
+}
+
+int crypto_onetimeauth_poly1305(unsigned char *out, const unsigned char *in,
+                                unsigned long long inlen, const unsigned char *k)
+{
+    crypto_onetimeauth_poly1305_state st;
+
+    crypto_onetimeauth_poly1305_init(&st, k);
+    crypto_onetimeauth_poly1305_update(&st, in, inlen);
+    crypto_onetimeauth_poly1305_final(&st, out);
+    return 0;
+}
+
+int crypto_onetimeauth_poly1305_verify(const unsigned char *h, const unsigned char *in,
+                                       unsigned long long inlen, const unsigned char *k)
+{
+    unsigned char correct[16];
+    int ret;
+
+    crypto_onetimeauth_poly1305(correct, in, inlen, k);
+    ret = crypto_verify_16(h, correct);
+    sodium_memzero(correct, sizeof correct);
+    return ret;
+}
@@ -0,0 +1,25 @@
+/*
+ * randombytes of include/MICOCrypto/randombytes.h on the random number
+ * generator of the platform.
+ */
+
+#include "MicoDriverRng.h"
+#include "randombytes.h"
+
+void randombytes_buf(void * const buf, const size_t size)
+{
+    MicoRandomNumberRead(buf, (int) size);
+}
+
+uint32_t randombytes_random(void)
+{
+    uint32_t r;
+
+    MicoRandomNumberRead(&r, sizeof r);
+    return r;
+}
+
+void randombytes(unsigned char * const buf, const unsigned long long buf_len)
+{
+    randombytes_buf(buf, (size_t) buf_len);
+}
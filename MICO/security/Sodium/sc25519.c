@@ -0,0 +1,79 @@
+/*
+ * Arithmetic modulo the group order of Ed25519, after TweetNaCl: bytes
+ * in 64 bit accumulators. Two reductions per signature cost little next
+ * to the scalar multiplication, the short code is worth more here.
+ */
+
+#include <stdint.h>
+
+#include "sc25519.h"
+
+static const int64_t sc25519_L[32] = {
+    0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
+};
+
+/* r = x mod L, x[i] are signed base 256 digits */
+static void sc25519_modL(unsigned char r[32], int64_t x[64])
+{
+    int64_t carry;
+    int i, j;
+
+    for (i = 63; i >= 32; i--) {
+        carry = 0;
+        for (j = i - 32; j < i - 12; j++) {
+            x[j] += carry - 16 * x[i] * sc25519_L[j - (i - 32)];
+            carry = (x[j] + 128) >> 8;
+            x[j] -= carry * 256;
+        }
+        x[j] += carry;
+        x[i] = 0;
+    }
+    carry = 0;
+    for (j = 0; j < 32; j++) {
+        x[j] += carry - (x[31] >> 4) * sc25519_L[j];
+        carry = x[j] >> 8;
+        x[j] &= 255;
+    }
+    for (j = 0; j < 32; j++) {
+        x[j] -= carry * sc25519_L[j];
+    }
+    for (i = 0; i < 32; i++) {
+        x[i + 1] += x[i] >> 8;
+        r[i] = (unsigned char) (x[i] & 255);
+    }
+}
+
+void sc25519_reduce(unsigned char s[64])
+{
+    int64_t x[64];
+    int i;
+
+    for (i = 0; i < 64; i++) {
+        x[i] = s[i];
+    }
+    for (i = 0; i < 64; i++) {
+        s[i] = 0;
+    }
+    sc25519_modL(s, x);
+}
+
+void sc25519_muladd(unsigned char s[32], const unsigned char a[32],
+                    const unsigned char b[32], const unsigned char c[32])
+{
+    int64_t x[64];
+    int i, j;
+
+    for (i = 0; i < 32; i++) {
+        x[i] = c[i];
+    }
+    for (i = 32; i < 64; i++) {
+        x[i] = 0;
+    }
+    for (i = 0; i < 32; i++) {
+        for (j = 0; j < 32; j++) {
+            x[i + j] += a[i] * (int64_t) b[j];
+        }
+    }
+    sc25519_modL(s, x);
+}
@@ -0,0 +1,16 @@
+/*
+ * Arithmetic modulo the group order of Ed25519,
+ * L = 2^252 + 27742317777372353535851937790883648493.
+ */
+
+#ifndef sc25519_H
+#define sc25519_H
+
+/* s[0..31] = s[0..63] mod L */
+void sc25519_reduce(unsigned char s[64]);
+
+/* s = (a * b + c) mod L */
+void sc25519_muladd(unsigned char s[32], const unsigned char a[32],
+                    const unsigned char b[32], const unsigned char c[32]);
+
+#endif
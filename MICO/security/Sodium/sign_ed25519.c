@@ -0,0 +1,214 @@
+/*
+ * Ed25519 signatures (RFC 8032) behind include/MICOCrypto/crypto_sign.h,
+ * after the ref10 code of SUPERCOP as packaged by libsodium: the secret
+ * key is the 32 byte seed followed by the public key, a signed message is
+ * the 64 byte signature followed by the message. SHA-512 is the one of
+ * libraries/utilities/SHAUtils.c, which the firmware links already.
+ */
+
+#include <string.h>
+
+#include "SHAUtils.h"
+#include "crypto_sign.h"
+#include "crypto_verify_32.h"
+#include "randombytes.h"
+#include "utils.h"
+
+#include "ge25519.h"
+#include "sc25519.h"
+
+size_t crypto_sign_ed25519_bytes(void)
+{
+    return crypto_sign_ed25519_BYTES;
+}
+
+size_t crypto_sign_ed25519_seedbytes(void)
+{
+    return crypto_sign_ed25519_SEEDBYTES;
+}
+
+size_t crypto_sign_ed25519_publickeybytes(void)
+{
+    return crypto_sign_ed25519_PUBLICKEYBYTES;
+}
+
+size_t crypto_sign_ed25519_secretkeybytes(void)
+{
+    return crypto_sign_ed25519_SECRETKEYBYTES;
+}
+
+int crypto_sign_ed25519_seed_keypair(unsigned char *pk, unsigned char *sk,
+                                     const unsigned char *seed)
+{
+    ge25519_p3 A;
+    unsigned char az[64];
+
+    SHA512_compat(seed, 32, az);
+    az[0] &= 248;
+    az[31] &= 63;
+    az[31] |= 64;
+
+    ge25519_scalarmult_base(&A, az);
+    ge25519_p3_tobytes(pk, &A);
+
+    memmove(sk, seed, 32);
+    memmove(sk + 32, pk, 32);
+    sodium_memzero(az, sizeof az);
+    return 0;
+}
+
+int crypto_sign_ed25519_keypair(unsigned char *pk, unsigned char *sk)
+{
+    unsigned char seed[32];
+    int ret;
+
+    randombytes_buf(seed, sizeof seed);
+    ret = crypto_sign_ed25519_seed_keypair(pk, sk, seed);
+    sodium_memzero(seed, sizeof seed);
+    return ret;
+}
+
+int crypto_sign_ed25519(unsigned char *sm, unsigned long long *smlen,
+                        const unsigned char *m, unsigned long long mlen,
+                        const unsigned char *sk)
+{
+    SHA512_CTX_compat hs;
+    unsigned char pk[32];
+    unsigned char az[64];
+    unsigned char nonce[64];
+    unsigned char hram[64];
+    ge25519_p3 R;
+
+    memmove(pk, sk + 32, 32);
+
+    SHA512_compat(sk, 32, az);
+    az[0] &= 248;
+    az[31] &= 63;
+    az[31] |= 64;
+
+    /* r = H(prefix || M), m may be sm + 64 already */
+    memmove(sm + 64, m, (size_t) mlen);
+    memmove(sm + 32, az + 32, 32);
+    SHA512_compat(sm + 32, (size_t) mlen + 32, nonce);
+    memmove(sm + 32, pk, 32);
+
+    sc25519_reduce(nonce);
+    ge25519_scalarmult_base(&R, nonce);
+    ge25519_p3_tobytes(sm, &R);
+
+    /* S = r + H(R || A || M) * a */
+    SHA512_Init_compat(&hs);
+    SHA512_Update_compat(&hs, sm, (size_t) mlen + 64);
+    SHA512_Final_compat(hram, &hs);
+    sc25519_reduce(hram);
+    sc25519_muladd(sm + 32, hram, az, nonce);
+
+    sodium_memzero(az, sizeof az);
+    sodium_memzero(nonce, sizeof nonce);
+
+    if (smlen != NULL) {
+        *smlen = mlen + 64U;
+    }
+    return 0;
+}
+
+int crypto_sign_ed25519_open(unsigned char *m, unsigned long long *mlen,
+                             const unsigned char *sm, unsigned long long smlen,
+                             const unsigned char *pk)
+{
+    SHA512_CTX_compat hs;
+    unsigned char h[64];
+    unsigned char rcheck[32];
+    ge25519_p3 A;
+    ge25519_p2 R;
+
+    if (smlen < 64 || (sm[63] & 224) != 0) {
+        goto badsig;
+    }
+    if (ge25519_frombytes_negate_vartime(&A, pk) != 0) {
+        goto badsig;
+    }
+
+    SHA512_Init_compat(&hs);
+    SHA512_Update_compat(&hs, sm, 32);
+    SHA512_Update_compat(&hs, pk, 32);
+    SHA512_Update_compat(&hs, sm + 64, (size_t) smlen - 64);
+    SHA512_Final_compat(h, &hs);
+    sc25519_reduce(h);
+
+    /* R' = S * B - H(R || A || M) * A */
+    ge25519_double_scalarmult_vartime(&R, h, &A, sm + 32);
+    ge25519_tobytes(rcheck, &R);
+    if (crypto_verify_32(rcheck, sm) != 0) {
+        goto badsig;
+    }
+
+    if (m != NULL) {
+        memmove(m, sm + 64, (size_t) smlen - 64);
+    }
+    if (mlen != NULL) {
+        *mlen = smlen - 64;
+    }
+    return 0;
+
+badsig:
+    if (mlen != NULL) {
+        *mlen = 0;
+    }
+    if (m != NULL && smlen >= 64) {
+        memset(m, 0, (size_t) smlen - 64);
+    }
+    return -1;
+}
+
+/* crypto_sign.h, Ed25519 is the only primitive */
+
+size_t crypto_sign_bytes(void)
+{
+    return crypto_sign_BYTES;
+}
+
+size_t crypto_sign_seedbytes(void)
+{
+    return crypto_sign_SEEDBYTES;
+}
+
+size_t crypto_sign_publickeybytes(void)
+{
+    return crypto_sign_PUBLICKEYBYTES;
+}
+
+size_t crypto_sign_secretkeybytes(void)
+{
+    return crypto_sign_SECRETKEYBYTES;
+}
+
+const char *crypto_sign_primitive(void)
+{
+    return crypto_sign_PRIMITIVE;
+}
+
+int crypto_sign_seed_keypair(unsigned char *pk, unsigned char *sk,
+                             const unsigned char *seed)
+{
+    return crypto_sign_ed25519_seed_keypair(pk, sk, seed);
+}
+
+int crypto_sign_keypair(unsigned char *pk, unsigned char *sk)
+{
+    return crypto_sign_ed25519_keypair(pk, sk);
+}
+
+int crypto_sign(unsigned char *sm, unsigned long long *smlen,
+                const unsigned char *m, unsigned long long mlen,
+                const unsigned char *sk)
+{
+    return crypto_sign_ed25519(sm, smlen, m, mlen, sk);
+}
+
+int crypto_sign_open(unsigned char *m, unsigned long long *mlen,
+                     const unsigned char *sm, unsigned long long smlen,
+                     const unsigned char *pk)
+{
+    return crypto_sign_ed25519_open(m, mlen, sm, smlen, pk);
+}
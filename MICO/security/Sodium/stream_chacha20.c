@@ -0,0 +1,192 @@
+/*
+ * ChaCha20 behind include/MICOCrypto/crypto_stream_chacha20.h, with the
+ * 64 bit nonce and 64 bit block counter of the original construction.
+ * RFC 8439 uses a 96 bit nonce and a 32 bit counter over the same state
+ * words, so its vectors map onto ic = counter | (nonce[0..3] << 32).
+ *
+ * CHACHA20_STREAM_BLOCKS keystream blocks are made per pass and then
+ * XORed a word at a time when both buffers allow it.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "crypto_stream_chacha20.h"
+#include "utils.h"
+
+#ifndef CHACHA20_STREAM_BLOCKS
+#define CHACHA20_STREAM_BLOCKS  4
+#endif
+
+#define CHACHA20_BLOCK_SIZE     64
+
+#define ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define QUARTERROUND(a, b, c, d)            \
+    a += b; d = ROTL32(d ^ a, 16);          \
+    c += d; b = ROTL32(b ^ c, 12);          \
+    a += b; d = ROTL32(d ^ a, 8);           \
+    c += d; b = ROTL32(b ^ c, 7)
+
+typedef union {
+    uint32_t      w[CHACHA20_STREAM_BLOCKS * CHACHA20_BLOCK_SIZE / 4];
+    unsigned char b[CHACHA20_STREAM_BLOCKS * CHACHA20_BLOCK_SIZE];
+} chacha20_keystream;
+
+static uint32_t load32_le(const unsigned char *src)
+{
+    return (uint32_t) src[0] | ((uint32_t) src[1] << 8) |
+           ((uint32_t) src[2] << 16) | ((uint32_t) src[3] << 24);
+}
+
+static void store32_le(unsigned char *dst, uint32_t w)
+{
+    dst[0] = (unsigned char) w;
+    dst[1] = (unsigned char) (w >> 8);
+    dst[2] = (unsigned char) (w >> 16);
+    dst[3] = (unsigned char) (w >> 24);
+}
+
+static void chacha20_keysetup(uint32_t input[16], const unsigned char *k,
+                              const unsigned char *n, uint64_t ic)
+{
+    int i;
+
+    input[0] = 0x61707865;              /* "expand 32-byte k" */
+    input[1] = 0x3320646e;
+    input[2] = 0x79622d32;
+    input[3] = 0x6b206574;
+    for (i = 0; i < 8; i++) {
+        input[4 + i] = load32_le(k + 4 * i);
+    }
+    input[12] = (uint32_t) ic;
+    input[13] = (uint32_t) (ic >> 32);
+    input[14] = load32_le(n);
+    input[15] = load32_le(n + 4);
+}
+
+/* blocks keystream blocks into out, advancing the counter */
+static void chacha20_blocks(uint32_t input[16], unsigned char *out, int blocks)
+{
+    uint32_t x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11, x12, x13, x14, x15;
+    int i;
+
+    while (blocks-- > 0) {
+        x0 = input[0];   x1 = input[1];   x2 = input[2];   x3 = input[3];
+        x4 = input[4];   x5 = input[5];   x6 = input[6];   x7 = input[7];
+        x8 = input[8];   x9 = input[9];   x10 = input[10]; x11 = input[11];
+        x12 = input[12]; x13 = input[13]; x14 = input[14]; x15 = input[15];
+
+        for (i = 0; i < 10; i++) {
+            QUARTERROUND(x0, x4, x8, x12);
+            QUARTERROUND(x1, x5, x9, x13);
+            QUARTERROUND(x2, x6, x10, x14);
+            QUARTERROUND(x3, x7, x11, x15);
+            QUARTERROUND(x0, x5, x10, x15);
+            QUARTERROUND(x1, x6, x11, x12);
+            QUARTERROUND(x2, x7, x8, x13);
+            QUARTERROUND(x3, x4, x9, x14);
+        }
+
+        store32_le(out + 0, x0 + input[0]);
+        store32_le(out + 4, x1 + input[1]);
+        store32_le(out + 8, x2 + input[2]);
+        store32_le(out + 12, x3 + input[3]);
+        store32_le(out + 16, x4 + input[4]);
+        store32_le(out + 20, x5 + input[5]);
+        store32_le(out + 24, x6 + input[6]);
+        store32_le(out + 28, x7 + input[7]);
+        store32_le(out + 32, x8 + input[8]);
+        store32_le(out + 36, x9 + input[9]);
+        store32_le(out + 40, x10 + input[10]);
+        store32_le(out + 44, x11 + input[11]);
+        store32_le(out + 48, x12 + input[12]);
+        store32_le(out + 52, x13 + input[13]);
+        store32_le(out + 56, x14 + input[14]);
+        store32_le(out + 60, x15 + input[15]);
+        out += CHACHA20_BLOCK_SIZE;
+
+        if (++input[12] == 0) {
+            input[13]++;
+        }
+    }
+}
+
+static void chacha20_xor(unsigned char *c, const unsigned char *m, size_t len,
+                         const chacha20_keystream *ks)
+{
+    size_t i = 0;
+
+    if (m == NULL) {
+        memcpy(c, ks->b, len);
+        return;
+    }
+    if ((((uintptr_t) c | (uintptr_t) m) & 3) == 0) {
+        for (; i + 4 <= len; i += 4) {
+            *(uint32_t *) (c + i) = *(const uint32_t *) (m + i) ^ ks->w[i / 4];
+        }
+    }
+    for (; i < len; i++) {
+        c[i] = m[i] ^ ks->b[i];
+    }
+}
+
+/* m == NULL writes the keystream itself */
+static void chacha20_stream_xor(unsigned char *c, const unsigned char *m,
+                                unsigned long long mlen, const unsigned char *n,
+                                uint64_t ic, const unsigned char *k)
+{
+    chacha20_keystream ks;
+    uint32_t input[16];
+    size_t todo;
+    int blocks;
+
+    chacha20_keysetup(input, k, n, ic);
+    while (mlen > 0) {
+        todo = (mlen < sizeof ks.b) ? (size_t) mlen : sizeof ks.b;
+        blocks = (int) ((todo + CHACHA20_BLOCK_SIZE - 1) / CHACHA20_BLOCK_SIZE);
+        chacha20_blocks(input, ks.b, blocks);
+        chacha20_xor(c, m, todo, &ks);
+        c += todo;
+        if (m != NULL) {
+            m += todo;
+        }
+        mlen -= todo;
+    }
+    sodium_memzero(&ks, sizeof ks);
+    sodium_memzero(input, sizeof input);
+}
+
+size_t crypto_stream_chacha20_keybytes(void)
+{
+    return crypto_stream_chacha20_KEYBYTES;
+}
+
+size_t crypto_stream_chacha20_noncebytes(void)
+{
+    return crypto_stream_chacha20_NONCEBYTES;
+}
+
+int crypto_stream_chacha20(unsigned char *c, unsigned long long clen,
+                           const unsigned char *n, const unsigned char *k)
+{
+    chacha20_stream_xor(c, NULL, clen, n, 0U, k);
+    return 0;
+}
+
+int crypto_stream_chacha20_xor_ic(unsigned char *c, const unsigned char *m,
+                                  unsigned long long mlen,
+                                  const unsigned char *n, uint64_t ic,
+                                  const unsigned char *k)
+{
+    chacha20_stream_xor(c, m, mlen, n, ic, k);
+    return 0;
+}
+
+int crypto_stream_chacha20_xor(unsigned char *c, const unsigned char *m,
+                               unsigned long long mlen, const unsigned char *n,
+                               const unsigned char *k)
+{
+    chacha20_stream_xor(c, m, mlen, n, 0U, k);
+    return 0;
+}
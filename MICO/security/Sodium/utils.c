@@ -0,0 +1,31 @@
+/*
+ * sodium_memzero() and sodium_memcmp() of include/MICOCrypto/utils.h.
+ */
+
+#include <stddef.h>
+
+#include "utils.h"
+
+void sodium_memzero(void * const pnt, const size_t len)
+{
+    /* The stores through a volatile pointer can not be dropped as dead */
+    volatile unsigned char *pnt_ = (volatile unsigned char *) pnt;
+    size_t i = (size_t) 0U;
+
+    while (i < len) {
+        pnt_[i++] = 0U;
+    }
+}
+
+int sodium_memcmp(const void * const b1_, const void * const b2_, size_t len)
+{
+    const unsigned char *b1 = (const unsigned char *) b1_;
+    const unsigned char *b2 = (const unsigned char *) b2_;
+    size_t i;
+    unsigned char d = (unsigned char) 0U;
+
+    for (i = 0U; i < len; i++) {
+        d |= b1[i] ^ b2[i];
+    }
+    return (int) ((1 & ((d - 1) >> 8)) - 1);
+}
@@ -0,0 +1,40 @@
+/*
+ * Constant time comparison of MACs and encoded points.
+ */
+
+#include <stdint.h>
+
+#include "crypto_verify_16.h"
+#include "crypto_verify_32.h"
+
+/* 0 if equal, -1 if not, without a branch on the data */
+static int crypto_verify_n(const unsigned char *x, const unsigned char *y, int n)
+{
+    uint_fast16_t d = 0U;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        d |= x[i] ^ y[i];
+    }
+    return (1 & ((d - 1) >> 8)) - 1;
+}
+
+size_t crypto_verify_16_bytes(void)
+{
+    return crypto_verify_16_BYTES;
+}
+
+int crypto_verify_16(const unsigned char *x, const unsigned char *y)
+{
+    return crypto_verify_n(x, y, crypto_verify_16_BYTES);
+}
+
+size_t crypto_verify_32_bytes(void)
+{
+    return crypto_verify_32_BYTES;
+}
+
+int crypto_verify_32(const unsigned char *x, const unsigned char *y)
+{
+    return crypto_verify_n(x, y, crypto_verify_32_BYTES);
+}
@@ -0,0 +1,273 @@
+/**
+******************************************************************************
+* @file    aes_bench.c
+* @version V1.0.0
+* @brief   Known answer tests and timing of the AESUtils CBC, CTR and GCM
+*          paths on top of Gladman AES.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include "crypto_bench.h"
+#include "AESUtils.h"
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+/* NIST SP 800-38A F.2.1 and F.5.1, AES-128 */
+static const uint8_t sp800_38a_key[16] =
+{
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+static const uint8_t sp800_38a_plain[64] =
+{
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+    0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+    0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+
+static const uint8_t sp800_38a_cbc_iv[16] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+static const uint8_t sp800_38a_cbc_cipher[64] =
+{
+    0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+    0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+    0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+    0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7
+};
+
+static const uint8_t sp800_38a_ctr_nonce[16] =
+{
+    0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+
+static const uint8_t sp800_38a_ctr_cipher[64] =
+{
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+    0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+    0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+    0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+};
+
+/* GCM specification (McGrew/Viega) test cases 3 and 4, as used by NIST */
+static const uint8_t gcm_key[16] =
+{
+    0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c, 0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08
+};
+
+static const uint8_t gcm_iv[12] =
+{
+    0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde, 0xca, 0xf8, 0x88
+};
+
+static const uint8_t gcm_plain[64] =
+{
+    0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5, 0xa5, 0x59, 0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a,
+    0x86, 0xa7, 0xa9, 0x53, 0x15, 0x34, 0xf7, 0xda, 0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31, 0x8a, 0x72,
+    0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53, 0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25,
+    0xb1, 0x6a, 0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57, 0xba, 0x63, 0x7b, 0x39, 0x1a, 0xaf, 0xd2, 0x55
+};
+
+static const uint8_t gcm_cipher[64] =
+{
+    0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24, 0x4b, 0x72, 0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c,
+    0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0, 0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e,
+    0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c, 0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05,
+    0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97, 0x3d, 0x58, 0xe0, 0x91, 0x47, 0x3f, 0x59, 0x85
+};
+
+static const uint8_t gcm_tag3[16] =
+{
+    0x4d, 0x5c, 0x2a, 0xf3, 0x27, 0xcd, 0x64, 0xa6, 0x2c, 0xf3, 0x5a, 0xbd, 0x2b, 0xa6, 0xfa, 0xb4
+};
+
+static const uint8_t gcm_aad4[20] =
+{
+    0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef, 0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+    0xab, 0xad, 0xda, 0xd2
+};
+
+static const uint8_t gcm_tag4[16] =
+{
+    0x5b, 0xc9, 0x4f, 0xbc, 0x32, 0x21, 0xa5, 0xdb, 0x94, 0xfa, 0xe9, 0x5a, 0xe7, 0x12, 0x1a, 0x47
+};
+
+static uint8_t              bench_buf[BENCH_MAX_SIZE];
+static AES_CBCFrame_Context cbc_ctx;
+static AES_CTR_Context      ctr_ctx;
+static AES_GCM_Context      gcm_ctx_aes;
+static gcm_ctx              gcm_ref;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static int kat_cbc( void )
+{
+    uint8_t out[64];
+    int fail = 0;
+
+    AES_CBCFrame_Init( &cbc_ctx, sp800_38a_key, sp800_38a_cbc_iv, true );
+    AES_CBCFrame_Update( &cbc_ctx, sp800_38a_plain, sizeof(sp800_38a_plain), out );
+    AES_CBCFrame_Final( &cbc_ctx );
+    fail += bench_check( "CBC encrypt (SP 800-38A F.2.1)", out, sp800_38a_cbc_cipher, sizeof(out) );
+
+    AES_CBCFrame_Init( &cbc_ctx, sp800_38a_key, sp800_38a_cbc_iv, false );
+    AES_CBCFrame_Update( &cbc_ctx, sp800_38a_cbc_cipher, sizeof(sp800_38a_cbc_cipher), out );
+    AES_CBCFrame_Final( &cbc_ctx );
+    fail += bench_check( "CBC decrypt (SP 800-38A F.2.2)", out, sp800_38a_plain, sizeof(out) );
+    return fail;
+}
+
+static int kat_ctr( void )
+{
+    static const size_t chunks[] = { 1, 15, 17, 3, 28 };
+    uint8_t in[65], out[65];
+    size_t i, off;
+    int fail = 0;
+
+    AES_CTR_Init( &ctr_ctx, sp800_38a_key, sp800_38a_ctr_nonce );
+    AES_CTR_Update( &ctr_ctx, sp800_38a_plain, sizeof(sp800_38a_plain), out );
+    AES_CTR_Final( &ctr_ctx );
+    fail += bench_check( "CTR encrypt (SP 800-38A F.5.1)", out, sp800_38a_ctr_cipher, 64 );
+
+    /* Odd sized pieces go through the buffered keystream, an odd address through the byte wise XOR */
+    memcpy( &in[1], sp800_38a_ctr_cipher, 64 );
+    AES_CTR_Init( &ctr_ctx, sp800_38a_key, sp800_38a_ctr_nonce );
+    for ( i = 0, off = 0; off < 64; off += chunks[i], i++ )
+        AES_CTR_Update( &ctr_ctx, &in[1 + off], chunks[i], &out[1 + off] );
+    AES_CTR_Final( &ctr_ctx );
+    fail += bench_check( "CTR decrypt, unaligned pieces (F.5.2)", &out[1], sp800_38a_plain, 64 );
+
+    /* In place */
+    memcpy( out, sp800_38a_plain, 64 );
+    AES_CTR_Init( &ctr_ctx, sp800_38a_key, sp800_38a_ctr_nonce );
+    AES_CTR_Update( &ctr_ctx, out, 64, out );
+    AES_CTR_Final( &ctr_ctx );
+    fail += bench_check( "CTR encrypt, in place", out, sp800_38a_ctr_cipher, 64 );
+    return fail;
+}
+
+static int kat_gcm( void )
+{
+    uint8_t out[64], ref[64], tag[16], reftag[16], nonce[16];
+    OSStatus good, forged;
+    int fail = 0;
+
+    /* The vectors use a 96 bit IV, AES_GCM_InitMessage always takes 16 bytes: check the GHASH tables directly */
+    memcpy( out, gcm_plain, sizeof(out) );
+    gcm_init_and_key( gcm_key, sizeof(gcm_key), &gcm_ref );
+    gcm_encrypt_message( gcm_iv, sizeof(gcm_iv), NULL, 0, out, 64, tag, sizeof(tag), &gcm_ref );
+    fail += bench_check( "GCM test case 3 ciphertext", out, gcm_cipher, 64 );
+    fail += bench_check( "GCM test case 3 tag", tag, gcm_tag3, 16 );
+
+    memcpy( out, gcm_plain, sizeof(out) );
+    gcm_encrypt_message( gcm_iv, sizeof(gcm_iv), gcm_aad4, sizeof(gcm_aad4), out, 60, tag, sizeof(tag), &gcm_ref );
+    fail += bench_check( "GCM test case 4 ciphertext", out, gcm_cipher, 60 );
+    fail += bench_check( "GCM test case 4 tag", tag, gcm_tag4, 16 );
+
+    /* AESUtils must agree with the reference for its 16 byte nonce, chunked */
+    memcpy( nonce, gcm_iv, sizeof(gcm_iv) );
+    memcpy( &nonce[12], gcm_iv, 4 );
+    memcpy( ref, gcm_plain, sizeof(ref) );
+    gcm_encrypt_message( nonce, sizeof(nonce), gcm_aad4, sizeof(gcm_aad4), ref, 64, reftag, sizeof(reftag), &gcm_ref );
+    gcm_end( &gcm_ref );
+
+    AES_GCM_Init( &gcm_ctx_aes, gcm_key, kAES_CGM_Nonce_None );
+    AES_GCM_InitMessage( &gcm_ctx_aes, nonce );
+    AES_GCM_AddAAD( &gcm_ctx_aes, gcm_aad4, 7 );
+    AES_GCM_AddAAD( &gcm_ctx_aes, &gcm_aad4[7], sizeof(gcm_aad4) - 7 );
+    AES_GCM_Encrypt( &gcm_ctx_aes, gcm_plain, 21, out );
+    AES_GCM_Encrypt( &gcm_ctx_aes, &gcm_plain[21], 43, &out[21] );
+    AES_GCM_FinalizeMessage( &gcm_ctx_aes, tag );
+    fail += bench_check( "AES_GCM_Encrypt", out, ref, 64 );
+    fail += bench_check( "AES_GCM_FinalizeMessage", tag, reftag, 16 );
+
+    AES_GCM_InitMessage( &gcm_ctx_aes, nonce );
+    AES_GCM_AddAAD( &gcm_ctx_aes, gcm_aad4, sizeof(gcm_aad4) );
+    AES_GCM_Decrypt( &gcm_ctx_aes, ref, 64, out );
+    fail += bench_check( "AES_GCM_Decrypt", out, gcm_plain, 64 );
+    good = AES_GCM_VerifyMessage( &gcm_ctx_aes, reftag );
+
+    reftag[0] ^= 1;
+    AES_GCM_InitMessage( &gcm_ctx_aes, nonce );
+    AES_GCM_AddAAD( &gcm_ctx_aes, gcm_aad4, sizeof(gcm_aad4) );
+    AES_GCM_Decrypt( &gcm_ctx_aes, ref, 64, out );
+    forged = AES_GCM_VerifyMessage( &gcm_ctx_aes, reftag );
+    printf( "  %-44s %s\n", "AES_GCM_VerifyMessage, good and forged tag",
+            ( good == kNoErr && forged == kAuthenticationErr ) ? "ok" : "FAILED" );
+    fail += ( good == kNoErr && forged == kAuthenticationErr ) ? 0 : 1;
+    AES_GCM_Final( &gcm_ctx_aes );
+    return fail;
+}
+
+int aes_kat( void )
+{
+    printf( "AES-128, GHASH table %d bytes (gcm_ctx %lu bytes), CTR %d blocks per pass\n",
+            GHASH_TABLE_SIZE, (unsigned long)sizeof(gcm_ctx), AES_UTILS_CTR_BULK_BLOCKS );
+    return kat_cbc( ) + kat_ctr( ) + kat_gcm( );
+}
+
+static void bench_cbc( size_t size )
+{
+    AES_CBCFrame_Update( &cbc_ctx, bench_buf, size, bench_buf );
+}
+
+static void bench_ctr( size_t size )
+{
+    AES_CTR_Update( &ctr_ctx, bench_buf, size, bench_buf );
+}
+
+static void bench_gcm( size_t size )
+{
+    uint8_t tag[16];
+
+    AES_GCM_InitMessage( &gcm_ctx_aes, kAES_CGM_Nonce_Auto );
+    AES_GCM_Encrypt( &gcm_ctx_aes, bench_buf, size, bench_buf );
+    AES_GCM_FinalizeMessage( &gcm_ctx_aes, tag );
+}
+
+void aes_bench( void )
+{
+    int i;
+
+    memset( bench_buf, 0x5a, sizeof(bench_buf) );
+    AES_CBCFrame_Init( &cbc_ctx, sp800_38a_key, sp800_38a_cbc_iv, true );
+    AES_CTR_Init( &ctr_ctx, sp800_38a_key, sp800_38a_ctr_nonce );
+    AES_GCM_Init( &gcm_ctx_aes, gcm_key, sp800_38a_ctr_nonce );
+    for ( i = 0; i < BENCH_SIZES; i++ )
+        bench_run( "AES-CBC", bench_sizes[i], bench_cbc );
+    for ( i = 0; i < BENCH_SIZES; i++ )
+        bench_run( "AES-CTR", bench_sizes[i], bench_ctr );
+    for ( i = 0; i < BENCH_SIZES; i++ )
+        bench_run( "AES-GCM", bench_sizes[i], bench_gcm );
+    AES_CBCFrame_Final( &cbc_ctx );
+    AES_CTR_Final( &ctr_ctx );
+    AES_GCM_Final( &gcm_ctx_aes );
+}
@@ -0,0 +1,167 @@
+/**
+******************************************************************************
+* @file    crypto_bench.c
+* @version V1.0.0
+* @brief   Host benchmark of the MICO crypto sources. The known answer
+*          tests of every algorithm run first, the timing only runs when
+*          they all pass.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <time.h>
+#include <unistd.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#define BENCH_HAS_TSC   1
+#endif
+
+#include "crypto_bench.h"
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+const size_t bench_sizes[BENCH_SIZES] = { 64, 1024, BENCH_MAX_SIZE };
+
+static double   cpu_mhz = 0;
+static unsigned bench_ms = 200;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+int bench_check( const char* name, const uint8_t* out, const uint8_t* expected, size_t len )
+{
+    int ok = ( memcmp( out, expected, len ) == 0 );
+    printf( "  %-44s %s\n", name, ok ? "ok" : "FAILED" );
+    return ok ? 0 : 1;
+}
+
+size_t bench_hex( const char* hex, uint8_t* out, size_t max )
+{
+    size_t len = 0;
+    unsigned int byte;
+
+    while ( len < max && hex[0] != 0 && hex[1] != 0 && sscanf( hex, "%2x", &byte ) == 1 )
+    {
+        out[len++] = (uint8_t)byte;
+        hex += 2;
+    }
+    return len;
+}
+
+static uint64_t now_ns( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint64_t now_cycles( void )
+{
+#if defined( BENCH_HAS_TSC )
+    return __rdtsc( );
+#else
+    return 0;
+#endif
+}
+
+void bench_run( const char* name, size_t size, void (*fn)( size_t size ) )
+{
+    uint64_t start_ns, start_cycles, ns, cycles, calls = 0;
+    double cpc;
+
+    start_ns = now_ns( );
+    start_cycles = now_cycles( );
+    do
+    {
+        fn( size );
+        calls++;
+        ns = now_ns( ) - start_ns;
+    } while ( ns < (uint64_t)bench_ms * 1000000ull );
+    cycles = now_cycles( ) - start_cycles;
+
+    if ( cpu_mhz > 0 )
+        cpc = (double)ns * cpu_mhz / 1000.0 / (double)calls;
+    else
+        cpc = (double)cycles / (double)calls;
+
+    printf( "  %-16s %6lu B %10.2f cycles/byte %10.0f cycles/call %8.1f MB/s\n", name, (unsigned long)size,
+            cpc / (double)size, cpc, (double)( calls * size ) * 1000.0 / (double)ns );
+}
+
+static void usage( const char* name )
+{
+    fprintf( stderr, "usage: %s [-k] [-m MHz] [-t ms]\n"
+                     "  -k       only run the known answer tests\n"
+                     "  -m MHz   derive cycles from the elapsed time at this clock\n"
+                     "           (default: time stamp counter, where there is one)\n"
+                     "  -t ms    time to spend on each measurement, default 200\n", name );
+}
+
+int main( int argc, char* argv[] )
+{
+    bool kat_only = false;
+    int opt, fail = 0;
+
+    while ( ( opt = getopt( argc, argv, "km:t:" ) ) != -1 )
+    {
+        switch ( opt )
+        {
+            case 'k': kat_only = true; break;
+            case 'm': cpu_mhz = atof( optarg ); break;
+            case 't': bench_ms = (unsigned)atoi( optarg ); break;
+            default:  usage( argv[0] ); return 2;
+        }
+    }
+
+#if !defined( BENCH_HAS_TSC )
+    if ( cpu_mhz <= 0 && !kat_only )
+    {
+        fprintf( stderr, "no cycle counter on this host, give the clock with -m\n" );
+        return 2;
+    }
+#endif
+
+    printf( "Known answer tests\n" );
+    fail += aes_kat( );
+    fail += hmac_kat( );
+    fail += sodium_kat( );
+    fail += curve25519_kat( );
+    if ( fail )
+    {
+        printf( "%d known answer tests FAILED\n", fail );
+        return 1;
+    }
+    if ( kat_only )
+        return 0;
+
+    printf( "Benchmark\n" );
+    aes_bench( );
+    hmac_bench( );
+    sodium_bench( );
+    curve25519_bench( );
+    return 0;
+}
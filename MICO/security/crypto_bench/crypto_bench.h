@@ -0,0 +1,82 @@
+/**
+******************************************************************************
+* @file    crypto_bench.h
+* @version V1.0.0
+* @brief   Helpers shared by the crypto_bench modules.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#ifndef __CRYPTO_BENCH_H__
+#define __CRYPTO_BENCH_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define BENCH_MAX_SIZE      16384
+#define BENCH_SIZES         3
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+/* 64 B, 1 KB and BENCH_MAX_SIZE */
+extern const size_t bench_sizes[BENCH_SIZES];
+
+/******************************************************
+*               Function Declarations
+******************************************************/
+
+/* Prints one known answer test line, returns 1 on a mismatch */
+int    bench_check( const char* name, const uint8_t* out, const uint8_t* expected, size_t len );
+
+/* Decodes up to max bytes of a hex string, returns the byte count */
+size_t bench_hex( const char* hex, uint8_t* out, size_t max );
+
+/* Calls fn( size ) for the measurement time and prints cycles/byte, cycles/call and MB/s */
+void   bench_run( const char* name, size_t size, void (*fn)( size_t size ) );
+
+/* aes_bench.c */
+int    aes_kat( void );
+void   aes_bench( void );
+
+/* hmac_bench.c */
+int    hmac_kat( void );
+void   hmac_bench( void );
+
+/* curve25519_bench.c */
+int    curve25519_kat( void );
+void   curve25519_bench( void );
+
+/* sodium_bench.c */
+int    sodium_kat( void );
+void   sodium_bench( void );
+
+#endif /* __CRYPTO_BENCH_H__ */
@@ -0,0 +1,172 @@
+/**
+******************************************************************************
+* @file    curve25519_bench.c
+* @version V1.0.0
+* @brief   Known answer tests and timing of Curve25519 key generation, the
+*          Montgomery ladder against the fixed-base comb.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include "crypto_bench.h"
+#include "crypto_stream_chacha20.h"
+#include "curve25519-donna.h"
+#include "ge25519.h"
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define COMB_CHECKS     256
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+/* The base point as an explicit argument, which always takes the ladder */
+static const uint8_t base_point[32] = { 9 };
+
+/* RFC 7748 6.1 */
+static const char alice_sk[] = "77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a";
+static const char alice_pk[] = "8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a";
+static const char bob_sk[]   = "5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb";
+static const char bob_pk[]   = "de9edb7d7b7dc1b4d35b61c2ece435373f8343c85b78674dadfc7e146f882b4f";
+static const char shared[]   = "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742";
+
+/* RFC 7748 5.2, k = u = 9 then k, u = X25519( k, u ), k */
+static const char iterated_1[]    = "422c8e7a6227d7bca1350b3e2bb7279f7897b87bb6854b783c60e80311ae3079";
+static const char iterated_1000[] = "684cf59ba83309552800ef566f2f4d3c1c3887c49360e3875f2eb94d99532c51";
+
+static uint8_t bench_secret[32];
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static int kat_keypair( const char* name, const char* sk_hex, const char* pk_hex )
+{
+    uint8_t sk[32], expected[32], pk[32];
+    char line[64];
+    int fail = 0;
+
+    bench_hex( sk_hex, sk, sizeof(sk) );
+    bench_hex( pk_hex, expected, sizeof(expected) );
+
+    curve25519_donna( pk, sk, base_point );
+    snprintf( line, sizeof(line), "%s public key, ladder", name );
+    fail += bench_check( line, pk, expected, 32 );
+
+    curve25519_donna_base( pk, sk );
+    snprintf( line, sizeof(line), "%s public key, comb", name );
+    fail += bench_check( line, pk, expected, 32 );
+    return fail;
+}
+
+static int kat_iterated( void )
+{
+    uint8_t k[32] = { 9 }, u[32] = { 9 }, r[32], expected[32];
+    int i, fail = 0;
+
+    for ( i = 1; i <= 1000; i++ )
+    {
+        curve25519_donna( r, k, u );
+        memcpy( u, k, 32 );
+        memcpy( k, r, 32 );
+        if ( i == 1 )
+        {
+            bench_hex( iterated_1, expected, sizeof(expected) );
+            fail += bench_check( "X25519 (RFC 7748 5.2), 1 iteration", k, expected, 32 );
+        }
+    }
+    bench_hex( iterated_1000, expected, sizeof(expected) );
+    fail += bench_check( "X25519 (RFC 7748 5.2), 1000 iterations", k, expected, 32 );
+    return fail;
+}
+
+/* Scalars from a ChaCha20 keystream, so that a failure can be replayed */
+static int kat_comb_vs_ladder( void )
+{
+    static const uint8_t key[32], nonce[8];
+    uint8_t sk[COMB_CHECKS][32], ladder[32], comb[32], null_base[32];
+    int i, bad = 0;
+
+    crypto_stream_chacha20( &sk[0][0], sizeof(sk), nonce, key );
+    for ( i = 0; i < COMB_CHECKS; i++ )
+    {
+        curve25519_donna( ladder, sk[i], base_point );
+        curve25519_donna_base( comb, sk[i] );
+        curve25519_donna( null_base, sk[i], NULL );
+        if ( memcmp( ladder, comb, 32 ) != 0 || memcmp( ladder, null_base, 32 ) != 0 )
+            bad++;
+    }
+    printf( "  %-44s %s\n", "X25519 comb = ladder, 256 random scalars", bad ? "FAILED" : "ok" );
+    return bad ? 1 : 0;
+}
+
+int curve25519_kat( void )
+{
+    uint8_t sk[32], pk[32], expected[32], out[32];
+    int fail = 0;
+
+    if ( ED25519_BASE_TABLE )
+        printf( "Curve25519, fixed base comb of %d rows\n", ED25519_BASE_ROWS );
+    else
+        printf( "Curve25519, fixed base window without a table\n" );
+    fail += kat_keypair( "X25519 (RFC 7748 6.1) Alice", alice_sk, alice_pk );
+    fail += kat_keypair( "X25519 (RFC 7748 6.1) Bob", bob_sk, bob_pk );
+
+    bench_hex( shared, expected, sizeof(expected) );
+    bench_hex( alice_sk, sk, sizeof(sk) );
+    bench_hex( bob_pk, pk, sizeof(pk) );
+    curve25519_donna( out, sk, pk );
+    fail += bench_check( "X25519 (RFC 7748 6.1) shared, Alice", out, expected, 32 );
+    bench_hex( bob_sk, sk, sizeof(sk) );
+    bench_hex( alice_pk, pk, sizeof(pk) );
+    curve25519_donna( out, sk, pk );
+    fail += bench_check( "X25519 (RFC 7748 6.1) shared, Bob", out, expected, 32 );
+
+    fail += kat_iterated( );
+    fail += kat_comb_vs_ladder( );
+    return fail;
+}
+
+static void bench_ladder( size_t size )
+{
+    uint8_t pk[32];
+    (void)size;
+    curve25519_donna( pk, bench_secret, base_point );
+}
+
+static void bench_comb( size_t size )
+{
+    uint8_t pk[32];
+    (void)size;
+    curve25519_donna_base( pk, bench_secret );
+}
+
+void curve25519_bench( void )
+{
+    memset( bench_secret, 0x42, sizeof(bench_secret) );
+    bench_run( "X25519 ladder", 32, bench_ladder );
+    bench_run( "X25519 comb", 32, bench_comb );
+}
@@ -0,0 +1,276 @@
+/**
+******************************************************************************
+* @file    hmac_bench.c
+* @version V1.0.0
+* @brief   Known answer tests and timing of the SHAUtils HMAC and HKDF,
+*          with the key hashed per call and with a prepared HMACKey.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include "crypto_bench.h"
+#include "sha.h"
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define HKDF_BENCH_OKM_SIZE     64
+
+/******************************************************
+*                    Structures
+******************************************************/
+
+typedef struct
+{
+    const char* name;
+    const char* key;        /* hex, or NULL with key_byte/key_len */
+    uint8_t     key_byte;
+    int         key_len;
+    const char* data;       /* text */
+    uint8_t     data_byte;  /* when data is NULL */
+    int         data_len;
+    const char* sha256;
+    const char* sha512;
+} hmac_vector_t;
+
+typedef struct
+{
+    const char* name;
+    const char* ikm;
+    const char* salt;
+    const char* info;
+    int         okm_len;
+    const char* prk;
+    const char* okm;
+} hkdf_vector_t;
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+/* RFC 4231 test cases 1 to 4, 6 and 7; case 5 is a truncated MAC */
+static const hmac_vector_t rfc4231[] =
+{
+    { "RFC 4231 test case 1", NULL, 0x0b, 20, "Hi There", 0, 8,
+      "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7",
+      "87aa7cdea5ef619d4ff0b4241a1d6cb02379f4e2ce4ec2787ad0b30545e17cde"
+      "daa833b7d6b8a702038b274eaea3f4e4be9d914eeb61f1702e696c203a126854" },
+    { "RFC 4231 test case 2", "4a656665", 0, 4, "what do ya want for nothing?", 0, 28,
+      "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+      "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+      "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737" },
+    { "RFC 4231 test case 3", NULL, 0xaa, 20, NULL, 0xdd, 50,
+      "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe",
+      "fa73b0089d56a284efb0f0756c890be9b1b5dbdd8ee81a3655f83e33b2279d39"
+      "bf3e848279a722c806b485a47e67c807b946a337bee8942674278859e13292fb" },
+    { "RFC 4231 test case 4", "0102030405060708090a0b0c0d0e0f10111213141516171819", 0, 25, NULL, 0xcd, 50,
+      "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b",
+      "b0ba465637458c6990e5a8c5f61d4af7e576d97ff94b872de76f8050361ee3db"
+      "a91ca5c11aa25eb4d679275cc5788063a5f19741120c4f2de2adebeb10a298dd" },
+    { "RFC 4231 test case 6", NULL, 0xaa, 131, "Test Using Larger Than Block-Size Key - Hash Key First", 0, 54,
+      "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54",
+      "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f352"
+      "6b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598" },
+    { "RFC 4231 test case 7", NULL, 0xaa, 131,
+      "This is a test using a larger than block-size key and a larger than block-size data. "
+      "The key needs to be hashed before being used by the HMAC algorithm.", 0, 152,
+      "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2",
+      "e37b6a775dc87dbaa4dfa9f96e5e3ffddebd71f8867289865df5a32d20cdc944"
+      "b6022cac3c4982b10d5eeb55c3e4de15134676fb6de0446065c97440fa8c6a58" },
+};
+
+/* RFC 5869 test cases 1 to 3, SHA-256 */
+static const hkdf_vector_t rfc5869[] =
+{
+    { "RFC 5869 test case 1",
+      "0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b",
+      "000102030405060708090a0b0c",
+      "f0f1f2f3f4f5f6f7f8f9", 42,
+      "077709362c2e32df0ddc3f0dc47bba6390b6c73bb50f9c3122ec844ad7c2b3e5",
+      "3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf34007208d5b887185865" },
+    { "RFC 5869 test case 2",
+      "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+      "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+      "404142434445464748494a4b4c4d4e4f",
+      "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+      "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+      "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf",
+      "b0b1b2b3b4b5b6b7b8b9babbbcbdbebfc0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+      "d0d1d2d3d4d5d6d7d8d9dadbdcdddedfe0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+      "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff", 82,
+      "06a6b88c5853361a06104c9ceb35b45cef760014904671014a193f40c15fc244",
+      "b11e398dc80327a1c8e7f78c596a49344f012eda2d4efad8a050cc4c19afa97c"
+      "59045a99cac7827271cb41c65e590e09da3275600c2f09b8367793a9aca3db71"
+      "cc30c58179ec3e87c14c01d5c1f3434f1d87" },
+    { "RFC 5869 test case 3",
+      "0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b", "", "", 42,
+      "19ef24a32c717b167f33a91d6f648bdf96596776afdb6377ac434c1c293ccb04",
+      "8da4e775a563c18f715f802a063c5a31b8a11f5c5ee1879ec3454e5f3c738d2d9d201395faa4b61a96c8" },
+};
+
+static uint8_t bench_buf[BENCH_MAX_SIZE];
+static uint8_t bench_key[32];
+static HMACKey bench_hkey;
+static HMACKey bench_prk;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static int kat_hmac_one( const hmac_vector_t* v, SHAversion sha, const char* expected_hex )
+{
+    uint8_t key[131], data[152], expected[USHAMaxHashSize], digest[USHAMaxHashSize];
+    char name[64];
+    const char* sha_name = ( sha == SHA256 ) ? "SHA-256" : "SHA-512";
+    HMACContext ctx;
+    HMACKey hkey;
+    int hash_len = USHAHashSize( sha ), fail = 0, off, piece;
+
+    if ( v->key != NULL )
+        bench_hex( v->key, key, sizeof(key) );
+    else
+        memset( key, v->key_byte, v->key_len );
+    if ( v->data != NULL )
+        memcpy( data, v->data, v->data_len );
+    else
+        memset( data, v->data_byte, v->data_len );
+    bench_hex( expected_hex, expected, sizeof(expected) );
+
+    memset( digest, 0, sizeof(digest) );
+    hmac( sha, data, v->data_len, key, v->key_len, digest );
+    snprintf( name, sizeof(name), "%s %s hmac", v->name, sha_name );
+    fail += bench_check( name, digest, expected, hash_len );
+
+    memset( digest, 0, sizeof(digest) );
+    hmacKeySetup( &hkey, sha, key, v->key_len );
+    hmacKeyed( &hkey, data, v->data_len, digest );
+    snprintf( name, sizeof(name), "%s %s hmacKeyed", v->name, sha_name );
+    fail += bench_check( name, digest, expected, hash_len );
+
+    /* Odd pieces through the keyed context, twice from the same key */
+    for ( piece = 0; piece < 2; piece++ )
+    {
+        memset( digest, 0, sizeof(digest) );
+        hmacKeyedReset( &ctx, &hkey );
+        for ( off = 0; off < v->data_len; off += 7 )
+            hmacInput( &ctx, &data[off], ( v->data_len - off < 7 ) ? v->data_len - off : 7 );
+        hmacResult( &ctx, digest );
+    }
+    snprintf( name, sizeof(name), "%s %s hmacKeyedReset", v->name, sha_name );
+    fail += bench_check( name, digest, expected, hash_len );
+    return fail;
+}
+
+static int kat_hkdf_one( const hkdf_vector_t* v )
+{
+    uint8_t ikm[80], salt[80], info[80], prk[USHAMaxHashSize], okm[82];
+    uint8_t expected_prk[USHAMaxHashSize], expected_okm[82];
+    int ikm_len, salt_len, info_len, fail = 0;
+    char name[64];
+    HMACKey hsalt, hprk;
+
+    ikm_len = (int)bench_hex( v->ikm, ikm, sizeof(ikm) );
+    salt_len = (int)bench_hex( v->salt, salt, sizeof(salt) );
+    info_len = (int)bench_hex( v->info, info, sizeof(info) );
+    bench_hex( v->prk, expected_prk, sizeof(expected_prk) );
+    bench_hex( v->okm, expected_okm, sizeof(expected_okm) );
+
+    memset( okm, 0, sizeof(okm) );
+    hkdf( SHA256, salt, salt_len, ikm, ikm_len, info, info_len, okm, v->okm_len );
+    snprintf( name, sizeof(name), "%s hkdf", v->name );
+    fail += bench_check( name, okm, expected_okm, v->okm_len );
+
+    memset( prk, 0, sizeof(prk) );
+    memset( okm, 0, sizeof(okm) );
+    hmacKeySetup( &hsalt, SHA256, salt, salt_len );
+    hkdfExtractKeyed( &hsalt, ikm, ikm_len, prk );
+    hmacKeySetup( &hprk, SHA256, prk, SHA256HashSize );
+    hkdfExpandKeyed( &hprk, info, info_len, okm, v->okm_len );
+    snprintf( name, sizeof(name), "%s hkdfExtractKeyed", v->name );
+    fail += bench_check( name, prk, expected_prk, SHA256HashSize );
+    snprintf( name, sizeof(name), "%s hkdfExpandKeyed", v->name );
+    fail += bench_check( name, okm, expected_okm, v->okm_len );
+    return fail;
+}
+
+int hmac_kat( void )
+{
+    int i, fail = 0;
+
+    printf( "HMAC and HKDF (SHAUtils)\n" );
+    for ( i = 0; i < (int)( sizeof(rfc4231) / sizeof(rfc4231[0]) ); i++ )
+    {
+        fail += kat_hmac_one( &rfc4231[i], SHA256, rfc4231[i].sha256 );
+        fail += kat_hmac_one( &rfc4231[i], SHA512, rfc4231[i].sha512 );
+    }
+    for ( i = 0; i < (int)( sizeof(rfc5869) / sizeof(rfc5869[0]) ); i++ )
+        fail += kat_hkdf_one( &rfc5869[i] );
+    return fail;
+}
+
+static void bench_hmac( size_t size )
+{
+    uint8_t digest[USHAMaxHashSize];
+    hmac( SHA256, bench_buf, (int)size, bench_key, sizeof(bench_key), digest );
+}
+
+static void bench_hmac_keyed( size_t size )
+{
+    uint8_t digest[USHAMaxHashSize];
+    hmacKeyed( &bench_hkey, bench_buf, (int)size, digest );
+}
+
+/* size is the info length, the output is always HKDF_BENCH_OKM_SIZE */
+static void bench_hkdf_expand( size_t size )
+{
+    uint8_t okm[HKDF_BENCH_OKM_SIZE];
+    hkdfExpand( SHA256, bench_key, sizeof(bench_key), bench_buf, (int)size, okm, sizeof(okm) );
+}
+
+static void bench_hkdf_expand_keyed( size_t size )
+{
+    uint8_t okm[HKDF_BENCH_OKM_SIZE];
+    hkdfExpandKeyed( &bench_prk, bench_buf, (int)size, okm, sizeof(okm) );
+}
+
+void hmac_bench( void )
+{
+    static const size_t info_sizes[] = { 16, 64 };
+    int i;
+
+    memset( bench_buf, 0x5a, sizeof(bench_buf) );
+    memset( bench_key, 0x0b, sizeof(bench_key) );
+    hmacKeySetup( &bench_hkey, SHA256, bench_key, sizeof(bench_key) );
+    hmacKeySetup( &bench_prk, SHA256, bench_key, sizeof(bench_key) );
+
+    for ( i = 0; i < BENCH_SIZES; i++ )
+        bench_run( "HMAC-SHA256", bench_sizes[i], bench_hmac );
+    for ( i = 0; i < BENCH_SIZES; i++ )
+        bench_run( "HMAC-SHA256 key", bench_sizes[i], bench_hmac_keyed );
+    /* The short info of a key derivation, 64 bytes of output */
+    for ( i = 0; i < (int)( sizeof(info_sizes) / sizeof(info_sizes[0]) ); i++ )
+        bench_run( "HKDF expand", info_sizes[i], bench_hkdf_expand );
+    for ( i = 0; i < (int)( sizeof(info_sizes) / sizeof(info_sizes[0]) ); i++ )
+        bench_run( "HKDF expand key", info_sizes[i], bench_hkdf_expand_keyed );
+}
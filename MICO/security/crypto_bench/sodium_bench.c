@@ -0,0 +1,351 @@
+/**
+******************************************************************************
+* @file    sodium_bench.c
+* @version V1.0.0
+* @brief   Known answer tests and timing of the ChaCha20, Poly1305,
+*          ChaCha20-Poly1305 and Ed25519 sources in MICO/security/Sodium.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "crypto_bench.h"
+#include "Common.h"
+#include "crypto_aead_chacha20poly1305.h"
+#include "crypto_onetimeauth_poly1305.h"
+#include "crypto_sign.h"
+#include "crypto_stream_chacha20.h"
+#include "ge25519.h"
+
+#ifndef CHACHA20_STREAM_BLOCKS
+#define CHACHA20_STREAM_BLOCKS  4
+#endif
+
+/******************************************************
+*                    Structures
+******************************************************/
+
+typedef struct
+{
+    const char* name;
+    const char* seed;
+    const char* pk;
+    const char* msg;
+    const char* sig;
+} ed25519_vector_t;
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+static const char sunscreen[] =
+    "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it.";
+
+/* RFC 8439 2.4.2: counter 1, nonce 000000000000004a00000000 */
+static const char chacha20_242_cipher[] =
+    "6e2e359a2568f98041ba0728dd0d6981e97e7aec1d4360c20a27afccfd9fae0b"
+    "f91b65c5524733ab8f593dabcd62b3571639d624e65152ab8f530c359f0861d8"
+    "07ca0dbf500d6a6156a38e088a22b65e52bc514d16ccf806818ce91ab7793736"
+    "5af90bbf74a35be6b40b8eedf2785e42874d";
+
+/* RFC 8439 2.5.2 */
+static const char poly1305_252_key[] = "85d6be7857556d337f4452fe42d506a80103808afb0db2fd4abff6af4149f51b";
+static const char poly1305_252_tag[] = "a8061dc1305136c6c22b8baf0c0127a9";
+
+/* RFC 8439 2.8.2, the IETF construction built from the primitives */
+static const char aead_282_aad[]    = "50515253c0c1c2c3c4c5c6c7";
+static const char aead_282_nonce[]  = "070000004041424344454647";
+static const char aead_282_cipher[] =
+    "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6"
+    "3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36"
+    "92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+    "3ff4def08e4b7a9de576d26586cec64b6116";
+static const char aead_282_tag[]    = "1ae10b594f09e26a7e902ecbd0600691";
+
+/* The crypto_aead_chacha20poly1305 vector of the libsodium tests */
+static const char aead_key[]    = "4290bcb154173531f314af57f3be3b5006da371ece272afa1b5dbdd1100a1007";
+static const char aead_nonce[]  = "cd7cf67be39c794a";
+static const char aead_msg[]    = "86d09974840bded2a5ca";
+static const char aead_ad[]     = "87e229d4500845a079c0";
+static const char aead_cipher[] = "e3e446f7ede9a19b62a4677dabf4e3d24b876bb284753896e1d6";
+
+/* RFC 8032 7.1 tests 1 to 3 */
+static const ed25519_vector_t rfc8032[] =
+{
+    { "RFC 8032 test 1",
+      "9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60",
+      "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a",
+      "",
+      "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e065224901555fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b" },
+    { "RFC 8032 test 2",
+      "4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a6fb",
+      "3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c",
+      "72",
+      "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00" },
+    { "RFC 8032 test 3",
+      "c5aa8df43f9f837bedb7442f31dcb7b166d38535076f094b85ce3a2e0b4458f7",
+      "fc51cd8e6218a1a38da47ed00230f0580816ed13ba3303ac5deb911548908025",
+      "af82",
+      "6291d657deec24024827e69c3abe01a30ce548a284743a445e3680d7db5ac3ac18ff9b538d16f290ae67f760984dc6594a7c15e9716ed28dc027beceea1ec40a" },
+};
+
+static uint8_t bench_buf[BENCH_MAX_SIZE + crypto_aead_chacha20poly1305_ABYTES];
+static uint8_t bench_key[32];
+static uint8_t bench_nonce[8];
+static uint8_t bench_pk[32], bench_sk[64], bench_sm[64 + 64];
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+/* randombytes.c reads the platform RNG, here /dev/urandom */
+OSStatus MicoRandomNumberRead( void *inBuffer, int inByteCount )
+{
+    int fd = open( "/dev/urandom", O_RDONLY );
+    ssize_t got = -1;
+
+    if ( fd >= 0 )
+    {
+        got = read( fd, inBuffer, inByteCount );
+        close( fd );
+    }
+    return ( got == inByteCount ) ? kNoErr : kGeneralErr;
+}
+
+static int bench_verdict( const char* name, bool ok )
+{
+    printf( "  %-44s %s\n", name, ok ? "ok" : "FAILED" );
+    return ok ? 0 : 1;
+}
+
+static int kat_chacha20( void )
+{
+    uint8_t key[32], nonce[12], expected[114], out[115];
+    size_t len = sizeof(sunscreen) - 1;
+    uint64_t ic;
+    int i, fail = 0;
+
+    for ( i = 0; i < 32; i++ )
+        key[i] = (uint8_t)i;
+    bench_hex( "000000000000004a00000000", nonce, sizeof(nonce) );
+    bench_hex( chacha20_242_cipher, expected, sizeof(expected) );
+
+    /* The first 4 bytes of the 96 bit nonce are the top of the 64 bit counter */
+    ic = 1 | ( (uint64_t)( nonce[0] | nonce[1] << 8 | nonce[2] << 16 | (uint32_t)nonce[3] << 24 ) << 32 );
+    crypto_stream_chacha20_xor_ic( out, (const uint8_t*)sunscreen, len, &nonce[4], ic, key );
+    fail += bench_check( "ChaCha20 (RFC 8439 2.4.2)", out, expected, len );
+
+    /* A block at a time from an odd address, through the counter */
+    memcpy( &out[1], sunscreen, len );
+    crypto_stream_chacha20_xor_ic( &out[1], &out[1], 64, &nonce[4], ic, key );
+    crypto_stream_chacha20_xor_ic( &out[65], &out[65], len - 64, &nonce[4], ic + 1, key );
+    fail += bench_check( "ChaCha20, in place by block, unaligned", &out[1], expected, len );
+    return fail;
+}
+
+static int kat_poly1305( void )
+{
+    static const size_t chunks[] = { 1, 15, 3, 13, 2 };
+    const char msg[] = "Cryptographic Forum Research Group";
+    crypto_onetimeauth_poly1305_state st;
+    uint8_t key[32], expected[16], tag[16];
+    size_t i, off;
+    int fail = 0;
+
+    bench_hex( poly1305_252_key, key, sizeof(key) );
+    bench_hex( poly1305_252_tag, expected, sizeof(expected) );
+
+    crypto_onetimeauth_poly1305( tag, (const uint8_t*)msg, sizeof(msg) - 1, key );
+    fail += bench_check( "Poly1305 (RFC 8439 2.5.2)", tag, expected, 16 );
+
+    crypto_onetimeauth_poly1305_init( &st, key );
+    for ( i = 0, off = 0; off < sizeof(msg) - 1; off += chunks[i], i++ )
+        crypto_onetimeauth_poly1305_update( &st, (const uint8_t*)&msg[off], chunks[i] );
+    crypto_onetimeauth_poly1305_final( &st, tag );
+    fail += bench_check( "Poly1305, in pieces", tag, expected, 16 );
+    return fail;
+}
+
+static void u64_le( uint8_t out[8], uint64_t x )
+{
+    int i;
+    for ( i = 0; i < 8; i++, x >>= 8 )
+        out[i] = (uint8_t)x;
+}
+
+static int kat_aead( void )
+{
+    static const uint8_t zeros[16];
+    crypto_onetimeauth_poly1305_state st;
+    uint8_t key[32], nonce[12], aad[12], block0[64], lens[16];
+    uint8_t expected[114], expected_tag[16], out[114 + 16], tag[16], msg[16];
+    unsigned long long outlen;
+    size_t len = sizeof(sunscreen) - 1;
+    uint64_t ic0;
+    int i, fail = 0, good, forged;
+
+    /* RFC 8439 2.8.2: the IETF layout on top of the same ChaCha20 and Poly1305 */
+    for ( i = 0; i < 32; i++ )
+        key[i] = (uint8_t)( 0x80 + i );
+    bench_hex( aead_282_nonce, nonce, sizeof(nonce) );
+    bench_hex( aead_282_aad, aad, sizeof(aad) );
+    bench_hex( aead_282_cipher, expected, sizeof(expected) );
+    bench_hex( aead_282_tag, expected_tag, sizeof(expected_tag) );
+
+    ic0 = (uint64_t)( nonce[0] | nonce[1] << 8 | nonce[2] << 16 | (uint32_t)nonce[3] << 24 ) << 32;
+    crypto_stream_chacha20_xor_ic( block0, zeros, 32, &nonce[4], ic0, key );
+    crypto_stream_chacha20_xor_ic( out, (const uint8_t*)sunscreen, len, &nonce[4], ic0 + 1, key );
+    crypto_onetimeauth_poly1305_init( &st, block0 );
+    crypto_onetimeauth_poly1305_update( &st, aad, sizeof(aad) );
+    crypto_onetimeauth_poly1305_update( &st, zeros, ( 16 - sizeof(aad) % 16 ) % 16 );
+    crypto_onetimeauth_poly1305_update( &st, out, len );
+    crypto_onetimeauth_poly1305_update( &st, zeros, ( 16 - len % 16 ) % 16 );
+    u64_le( lens, sizeof(aad) );
+    u64_le( &lens[8], len );
+    crypto_onetimeauth_poly1305_update( &st, lens, sizeof(lens) );
+    crypto_onetimeauth_poly1305_final( &st, tag );
+    fail += bench_check( "ChaCha20-Poly1305 (RFC 8439 2.8.2) cipher", out, expected, len );
+    fail += bench_check( "ChaCha20-Poly1305 (RFC 8439 2.8.2) tag", tag, expected_tag, 16 );
+
+    /* crypto_aead_chacha20poly1305 itself */
+    bench_hex( aead_key, key, sizeof(key) );
+    bench_hex( aead_nonce, nonce, 8 );
+    bench_hex( aead_ad, aad, 10 );
+    bench_hex( aead_msg, msg, 10 );
+    bench_hex( aead_cipher, expected, sizeof(expected) );
+    crypto_aead_chacha20poly1305_encrypt( out, &outlen, msg, 10, aad, 10, NULL, nonce, key );
+    fail += bench_check( "crypto_aead_chacha20poly1305_encrypt", out, expected, 26 );
+    fail += bench_verdict( "crypto_aead_chacha20poly1305_encrypt length", outlen == 26 );
+
+    memset( tag, 0, sizeof(tag) );
+    good = crypto_aead_chacha20poly1305_decrypt( tag, &outlen, NULL, out, 26, aad, 10, nonce, key );
+    fail += bench_check( "crypto_aead_chacha20poly1305_decrypt", tag, msg, 10 );
+    out[25] ^= 1;
+    forged = crypto_aead_chacha20poly1305_decrypt( tag, &outlen, NULL, out, 26, aad, 10, nonce, key );
+    fail += bench_verdict( "crypto_aead_chacha20poly1305_decrypt, forged", good == 0 && forged == -1 && outlen == 0 );
+    return fail;
+}
+
+static int kat_ed25519( const ed25519_vector_t* v )
+{
+    uint8_t seed[32], pk[32], sk[64], msg[2], expected_pk[32], expected_sig[64], sm[64 + 2], m[2];
+    unsigned long long smlen, mlen;
+    size_t len;
+    char name[64];
+    int fail = 0, good, forged;
+
+    bench_hex( v->seed, seed, sizeof(seed) );
+    bench_hex( v->pk, expected_pk, sizeof(expected_pk) );
+    bench_hex( v->sig, expected_sig, sizeof(expected_sig) );
+    len = bench_hex( v->msg, msg, sizeof(msg) );
+
+    crypto_sign_seed_keypair( pk, sk, seed );
+    snprintf( name, sizeof(name), "%s public key", v->name );
+    fail += bench_check( name, pk, expected_pk, 32 );
+
+    crypto_sign( sm, &smlen, msg, len, sk );
+    snprintf( name, sizeof(name), "%s signature", v->name );
+    fail += bench_check( name, sm, expected_sig, 64 );
+
+    good = crypto_sign_open( m, &mlen, sm, smlen, pk );
+    sm[0] ^= 0x10;
+    forged = crypto_sign_open( m, &mlen, sm, smlen, pk );
+    snprintf( name, sizeof(name), "%s open, good and forged", v->name );
+    fail += bench_verdict( name, good == 0 && forged == -1 );
+    return fail;
+}
+
+static int kat_keypair( void )
+{
+    uint8_t pk[32], sk[64], sm[64 + 5], m[5];
+    unsigned long long smlen, mlen;
+
+    crypto_sign_keypair( pk, sk );
+    crypto_sign( sm, &smlen, (const uint8_t*)"hello", 5, sk );
+    return bench_verdict( "crypto_sign_keypair, sign and open",
+                          crypto_sign_open( m, &mlen, sm, smlen, pk ) == 0 && mlen == 5 && memcmp( m, "hello", 5 ) == 0 );
+}
+
+int sodium_kat( void )
+{
+    int i, fail = 0;
+
+    printf( "ChaCha20-Poly1305 and Ed25519 (Sodium), ChaCha20 %d blocks per pass, Ed25519 base table %s\n",
+            CHACHA20_STREAM_BLOCKS, ED25519_BASE_TABLE ? "in flash" : "off" );
+    fail += kat_chacha20( );
+    fail += kat_poly1305( );
+    fail += kat_aead( );
+    for ( i = 0; i < (int)( sizeof(rfc8032) / sizeof(rfc8032[0]) ); i++ )
+        fail += kat_ed25519( &rfc8032[i] );
+    fail += kat_keypair( );
+    return fail;
+}
+
+static void bench_chacha20( size_t size )
+{
+    crypto_stream_chacha20_xor( bench_buf, bench_buf, size, bench_nonce, bench_key );
+}
+
+static void bench_poly1305( size_t size )
+{
+    uint8_t tag[16];
+    crypto_onetimeauth_poly1305( tag, bench_buf, size, bench_key );
+}
+
+static void bench_aead( size_t size )
+{
+    crypto_aead_chacha20poly1305_encrypt( bench_buf, NULL, bench_buf, size, NULL, 0, NULL, bench_nonce, bench_key );
+}
+
+/* size is the message length */
+static void bench_sign( size_t size )
+{
+    crypto_sign( bench_sm, NULL, bench_buf, size, bench_sk );
+}
+
+static void bench_open( size_t size )
+{
+    crypto_sign_open( NULL, NULL, bench_sm, size + 64, bench_pk );
+}
+
+void sodium_bench( void )
+{
+    int i;
+
+    memset( bench_buf, 0x5a, sizeof(bench_buf) );
+    memset( bench_key, 0x42, sizeof(bench_key) );
+    memset( bench_nonce, 0x07, sizeof(bench_nonce) );
+    crypto_sign_seed_keypair( bench_pk, bench_sk, bench_key );
+
+    for ( i = 0; i < BENCH_SIZES; i++ )
+        bench_run( "ChaCha20", bench_sizes[i], bench_chacha20 );
+    for ( i = 0; i < BENCH_SIZES; i++ )
+        bench_run( "Poly1305", bench_sizes[i], bench_poly1305 );
+    for ( i = 0; i < BENCH_SIZES; i++ )
+        bench_run( "ChaCha20-Poly1305", bench_sizes[i], bench_aead );
+    bench_run( "Ed25519 sign", 64, bench_sign );
+    crypto_sign( bench_sm, NULL, bench_buf, 64, bench_sk );
+    bench_run( "Ed25519 verify", 64, bench_open );
+}
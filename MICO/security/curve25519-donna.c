@@ -80,6 +80,13 @@
 	#endif
 #endif
 
+// CURVE25519_FIXED_BASE: 1 = public keys (NULL base point) use curve25519_donna_base, 0 = always the ladder.
+// 1 also needs curve25519-donna-base.c, fe25519.c and ge25519.c of MICO/security/Sodium and its base table.
+
+#if( !defined( CURVE25519_FIXED_BASE ) )
+	#define	CURVE25519_FIXED_BASE		0
+#endif
+
 // Conditionally include the 64-bit version if we're building for a 64-bit platform.
 
 #if( CURVE25519_64_BIT )
@@ -812,6 +819,12 @@ curve25519_donna(u8 *mypublic, const u8 *secret, const u8 *basepoint) {
   uint8_t e[32];
   int i;
 
+#if( CURVE25519_FIXED_BASE )
+  if (basepoint == NULL) {
+    curve25519_donna_base(mypublic, secret);
+    return;
+  }
+#endif
   if (basepoint == NULL) basepoint = kCurve25519BasePoint;
 
   for (i = 0; i < 32; ++i) e[i] = secret[i];
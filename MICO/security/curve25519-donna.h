@@ -57,8 +57,14 @@
 	extern "C" {
 #endif
 
+// A NULL inBasePoint means the base point 9, which goes through curve25519_donna_base when curve25519-donna.c is built with CURVE25519_FIXED_BASE=1.
+
 void curve25519_donna( unsigned char *outKey, const unsigned char *inSecret, const unsigned char *inBasePoint );
 
+// Public key of inSecret: the fixed-base comb of MICO/security/Sodium on the Edwards curve, mapped to the Montgomery u.
+
+void curve25519_donna_base( unsigned char *outKey, const unsigned char *inSecret );
+
 #ifdef	__cplusplus
 	}
 #endif
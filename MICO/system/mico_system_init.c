@@ -84,6 +84,11 @@ OSStatus mico_system_init( mico_Context_t* in_context )
 
   require_action( in_context, exit, err = kNotPreparedErr );
 
+#if MICO_DEFERRED_LOG
+  /* Deferred custom_log output thread */
+  mico_log_init( );
+#endif
+
   /* Initialize power management daemen */
   err = mico_system_power_daemon_start( in_context );
   require_noerr( err, exit ); 
@@ -0,0 +1,556 @@
+/**
+******************************************************************************
+* @file    mico_system_log.c
+* @version V1.0.0
+* @brief   Deferred logging backend for custom_log(), enabled by MICO_DEFERRED_LOG.
+*          The caller only stores the format pointer, a timestamp and the raw
+*          arguments into a lock-free ring; formatting and UART output are done
+*          by a low priority thread.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include "MICO.h"
+#include "platform_peripheral.h"
+#include <stdarg.h>
+
+#if MICO_DEFERRED_LOG
+
+/* Number of records in the ring, must be a power of two */
+#ifndef MICO_LOG_RING_SIZE
+#define MICO_LOG_RING_SIZE          (16)
+#endif
+
+/* 32-bit argument words per record, 64-bit and double arguments use two */
+#ifndef MICO_LOG_ARG_WORDS
+#define MICO_LOG_ARG_WORDS          (8)
+#endif
+
+/* Bytes per record used to copy %s arguments, longer strings are truncated */
+#ifndef MICO_LOG_STR_BYTES
+#define MICO_LOG_STR_BYTES          (32)
+#endif
+
+#ifndef MICO_LOG_MODULE_MAX
+#define MICO_LOG_MODULE_MAX         (8)
+#endif
+
+#ifndef MICO_LOG_THREAD_PRIORITY
+#define MICO_LOG_THREAD_PRIORITY    (8)
+#endif
+
+#ifndef STACK_SIZE_MICO_LOG_THREAD
+#define STACK_SIZE_MICO_LOG_THREAD  (0x500)
+#endif
+
+/* The output thread also wakes up periodically to catch records whose
+   producer was preempted between claiming and committing the slot */
+#define MICO_LOG_FLUSH_INTERVAL     (100)
+
+#define LOG_LINE_LEN                (160)
+#define LOG_SPEC_LEN                (16)
+#define LOG_STR_NULL                (0xFFFF)
+
+#define LOG_BINARY_SYNC0            (0xA5)
+#define LOG_BINARY_SYNC1            (0x5A)
+
+#if ( MICO_LOG_RING_SIZE & ( MICO_LOG_RING_SIZE - 1 ) )
+#error "MICO_LOG_RING_SIZE must be a power of two"
+#endif
+
+typedef struct
+{
+  volatile uint32_t seq;      /* Claimed index + 1 once the record is complete */
+  uint32_t          time;
+  const char*       module;
+  const char*       file;
+  const char*       format;
+  uint16_t          line;
+  uint8_t           level;
+  uint8_t           words;
+  uint8_t           str_used;
+  uint8_t           reserved[3];
+  uint32_t          arg[MICO_LOG_ARG_WORDS];
+  char              str[MICO_LOG_STR_BYTES];
+} log_record_t;
+
+typedef struct
+{
+  const char*       module;
+  uint8_t           level;
+} log_module_t;
+
+static log_record_t       log_ring[MICO_LOG_RING_SIZE];
+static volatile uint32_t  log_head = 0;   /* Next index to claim, advanced by producers */
+static volatile uint32_t  log_tail = 0;   /* Next index to print, advanced by the output thread */
+
+static log_module_t       log_modules[MICO_LOG_MODULE_MAX];
+static mico_log_level_t   log_default_level = MICO_LOG_INFO;
+
+static volatile uint32_t  log_logged = 0;
+static volatile uint32_t  log_dropped = 0;
+static volatile uint32_t  log_filtered = 0;
+static uint32_t           log_high_water = 0;
+
+static bool               log_binary = false;
+static mico_semaphore_t   log_sem = NULL;
+
+extern mico_mutex_t stdio_tx_mutex;
+
+/* Counters are shared by every producer, including ISRs */
+static void log_atomic_inc( volatile uint32_t* counter )
+{
+  uint32_t value;
+  do {
+    value = __LDREXW( counter );
+  } while ( __STREXW( value + 1, counter ) );
+}
+
+static mico_log_level_t log_module_level( const char* module )
+{
+  int i;
+
+  for ( i = 0; i < MICO_LOG_MODULE_MAX && log_modules[i].module != NULL; i++ ) {
+    if ( log_modules[i].module == module || strcmp( log_modules[i].module, module ) == 0 )
+      return (mico_log_level_t)log_modules[i].level;
+  }
+  return log_default_level;
+}
+
+/* Walk one conversion specification starting after '%'. Returns a pointer to
+   the conversion character and reports the number of 'l' modifiers and of
+   '*' fields consumed from the argument list. */
+static const char* log_parse_spec( const char* p, int* longs, int* stars )
+{
+  *longs = 0;
+  *stars = 0;
+
+  while ( *p && strchr( "-+ #0", *p ) ) p++;
+  if ( *p == '*' ) { (*stars)++; p++; }
+  else while ( *p >= '0' && *p <= '9' ) p++;
+  if ( *p == '.' ) {
+    p++;
+    if ( *p == '*' ) { (*stars)++; p++; }
+    else while ( *p >= '0' && *p <= '9' ) p++;
+  }
+  while ( *p && strchr( "hlLqjzt", *p ) ) {
+    if ( *p == 'l' || *p == 'q' ) (*longs)++;
+    if ( *p == 'q' ) (*longs)++;
+    p++;
+  }
+  return p;
+}
+
+static bool log_push( log_record_t* rec, uint32_t value )
+{
+  if ( rec->words >= MICO_LOG_ARG_WORDS ) return false;
+  rec->arg[rec->words++] = value;
+  return true;
+}
+
+static bool log_push64( log_record_t* rec, uint64_t value )
+{
+  if ( rec->words + 2 > MICO_LOG_ARG_WORDS ) return false;
+  rec->arg[rec->words++] = (uint32_t)value;
+  rec->arg[rec->words++] = (uint32_t)( value >> 32 );
+  return true;
+}
+
+static bool log_push_string( log_record_t* rec, const char* s )
+{
+  int len, avail;
+
+  if ( s == NULL ) return log_push( rec, LOG_STR_NULL );
+
+  /* The last byte of str[] is always kept as an empty string for overflows */
+  avail = MICO_LOG_STR_BYTES - 2 - rec->str_used;
+  if ( avail < 0 ) avail = 0;
+  len = strlen( s );
+  if ( len > avail ) len = avail;
+  if ( !log_push( rec, len ? rec->str_used : MICO_LOG_STR_BYTES - 1 ) ) return false;
+  if ( len ) {
+    memcpy( &rec->str[rec->str_used], s, len );
+    rec->str_used += len;
+    rec->str[rec->str_used++] = 0;
+  }
+  return true;
+}
+
+/* Copy the raw arguments described by format, without formatting anything */
+static void log_capture( log_record_t* rec, const char* format, va_list ap )
+{
+  const char* p = format;
+  int longs, stars;
+  bool ok = true;
+  double d;
+
+  rec->words = 0;
+  rec->str_used = 0;
+  rec->str[MICO_LOG_STR_BYTES - 1] = 0;
+
+  while ( ok && ( p = strchr( p, '%' ) ) != NULL ) {
+    p++;
+    if ( *p == '%' ) { p++; continue; }
+    p = log_parse_spec( p, &longs, &stars );
+    while ( ok && stars-- ) ok = log_push( rec, (uint32_t)va_arg( ap, int ) );
+    if ( !ok ) break;
+
+    switch ( *p ) {
+      case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+        if ( longs >= 2 )      ok = log_push64( rec, (uint64_t)va_arg( ap, long long ) );
+        else if ( longs == 1 ) ok = log_push( rec, (uint32_t)va_arg( ap, long ) );
+        else                   ok = log_push( rec, (uint32_t)va_arg( ap, int ) );
+        break;
+      case 'p':
+        ok = log_push( rec, (uint32_t)(uintptr_t)va_arg( ap, void* ) );
+        break;
+      case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        {
+          uint64_t bits;
+          d = va_arg( ap, double );
+          memcpy( &bits, &d, sizeof( bits ) );
+          ok = log_push64( rec, bits );
+        }
+        break;
+      case 's':
+        ok = log_push_string( rec, va_arg( ap, const char* ) );
+        break;
+      case 'n':
+        (void)va_arg( ap, int* );
+        ok = log_push( rec, 0 );
+        break;
+      default:
+        return;
+    }
+    p++;
+  }
+}
+
+void mico_log_deferred( const char* module, mico_log_level_t level, const char* file, int line, const char* format, ... )
+{
+  log_record_t* rec;
+  uint32_t index, used;
+  va_list ap;
+
+  if ( level > log_module_level( module ) ) {
+    log_atomic_inc( &log_filtered );
+    return;
+  }
+
+  /* Claim a slot, never blocks so it is safe from any thread or ISR */
+  do {
+    index = __LDREXW( &log_head );
+    if ( index - log_tail >= MICO_LOG_RING_SIZE ) {
+      __CLREX();
+      log_atomic_inc( &log_dropped );
+      return;
+    }
+  } while ( __STREXW( index + 1, &log_head ) );
+
+  rec = &log_ring[index & ( MICO_LOG_RING_SIZE - 1 )];
+  rec->time   = mico_get_time();
+  rec->module = module;
+  rec->file   = file;
+  rec->format = format;
+  rec->line   = (uint16_t)line;
+  rec->level  = (uint8_t)level;
+
+  va_start( ap, format );
+  log_capture( rec, format, ap );
+  va_end( ap );
+
+  __DMB();
+  rec->seq = index + 1;
+  log_atomic_inc( &log_logged );
+
+  used = index + 1 - log_tail;
+  if ( used > log_high_water ) log_high_water = used;
+
+  /* Only the empty to non-empty transition has to wake the output thread */
+  if ( used == 1 && log_sem != NULL )
+    mico_rtos_set_semaphore( &log_sem );
+}
+
+/* Rebuild one specification into spec[], with '*' fields replaced by their
+   captured values and length modifiers normalized to "", "l" or "ll" */
+static const log_record_t* log_build_spec( const log_record_t* rec, const char* start, const char* conv,
+                                           int longs, uint8_t* word, char* spec )
+{
+  char* s = spec;
+  char* end = spec + LOG_SPEC_LEN - 4;
+  const char* p;
+
+  *s++ = '%';
+  for ( p = start; p < conv && s < end; p++ ) {
+    if ( strchr( "hlLqjzt", *p ) ) continue;
+    if ( *p == '*' ) {
+      if ( *word >= rec->words ) return NULL;
+      s += snprintf( s, end - s, "%d", (int)rec->arg[(*word)++] );
+      if ( s > end ) s = end;
+      continue;
+    }
+    *s++ = *p;
+  }
+  if ( longs >= 1 ) *s++ = 'l';
+  if ( longs >= 2 ) *s++ = 'l';
+  *s++ = *conv;
+  *s = 0;
+  return rec;
+}
+
+static int log_format( const log_record_t* rec, char* out, int size )
+{
+  const char* p = rec->format;
+  const char* start;
+  const char* file;
+  char spec[LOG_SPEC_LEN];
+  uint8_t word = 0;
+  int len, longs, stars, n;
+  uint64_t v64;
+  double d;
+
+  file = strrchr( rec->file, '\\' );
+  if ( file == NULL ) file = strrchr( rec->file, '/' );
+  file = ( file != NULL ) ? file + 1 : rec->file;
+
+  len = snprintf( out, size, "[%d][%s: %s:%4d] ", (int)rec->time, rec->module, file, rec->line );
+  if ( len >= size ) return size - 1;
+
+  while ( *p && len < size - 1 ) {
+    if ( *p != '%' ) {
+      out[len++] = *p++;
+      continue;
+    }
+    p++;
+    if ( *p == '%' ) {
+      out[len++] = *p++;
+      continue;
+    }
+
+    start = p;
+    p = log_parse_spec( p, &longs, &stars );
+    if ( log_build_spec( rec, start, p, longs, &word, spec ) == NULL ) break;
+
+    n = 0;
+    switch ( *p ) {
+      case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+        if ( longs >= 2 ) {
+          if ( word + 2 > rec->words ) goto truncated;
+          v64 = (uint64_t)rec->arg[word] | ( (uint64_t)rec->arg[word + 1] << 32 );
+          word += 2;
+          n = snprintf( &out[len], size - len, spec, (long long)v64 );
+        } else {
+          if ( word >= rec->words ) goto truncated;
+          if ( longs == 1 ) n = snprintf( &out[len], size - len, spec, (long)(int32_t)rec->arg[word++] );
+          else              n = snprintf( &out[len], size - len, spec, (int)rec->arg[word++] );
+        }
+        break;
+      case 'p':
+        if ( word >= rec->words ) goto truncated;
+        n = snprintf( &out[len], size - len, spec, (void*)(uintptr_t)rec->arg[word++] );
+        break;
+      case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        if ( word + 2 > rec->words ) goto truncated;
+        v64 = (uint64_t)rec->arg[word] | ( (uint64_t)rec->arg[word + 1] << 32 );
+        word += 2;
+        memcpy( &d, &v64, sizeof( d ) );
+        n = snprintf( &out[len], size - len, spec, d );
+        break;
+      case 's':
+        if ( word >= rec->words ) goto truncated;
+        if ( rec->arg[word] == LOG_STR_NULL ) n = snprintf( &out[len], size - len, spec, "(null)" );
+        else n = snprintf( &out[len], size - len, spec, &rec->str[rec->arg[word]] );
+        word++;
+        break;
+      case 'n':
+        word++;
+        break;
+      default:
+        goto truncated;
+    }
+    if ( n > 0 ) len += n;
+    if ( len > size - 1 ) len = size - 1;
+    p++;
+  }
+  out[len] = 0;
+  return len;
+
+truncated:
+  /* Arguments did not fit into the record */
+  n = snprintf( &out[len], size - len, "<...>" );
+  if ( n > 0 ) len += n;
+  if ( len > size - 1 ) len = size - 1;
+  out[len] = 0;
+  return len;
+}
+
+/* Binary record, little endian, decoded offline against the firmware map:
+   sync0 sync1 length | time format module file | line level words | arg[] | str[] */
+static void log_emit_binary( const log_record_t* rec )
+{
+  uint8_t buf[ 3 + 4 * 4 + 4 + MICO_LOG_ARG_WORDS * 4 + MICO_LOG_STR_BYTES ];
+  uint32_t header[4];
+  uint32_t len = 3;
+
+  header[0] = rec->time;
+  header[1] = (uint32_t)(uintptr_t)rec->format;
+  header[2] = (uint32_t)(uintptr_t)rec->module;
+  header[3] = (uint32_t)(uintptr_t)rec->file;
+  memcpy( &buf[len], header, sizeof( header ) );
+  len += sizeof( header );
+  buf[len++] = (uint8_t)rec->line;
+  buf[len++] = (uint8_t)( rec->line >> 8 );
+  buf[len++] = rec->level;
+  buf[len++] = rec->words;
+  memcpy( &buf[len], rec->arg, rec->words * 4 );
+  len += rec->words * 4;
+  memcpy( &buf[len], rec->str, rec->str_used );
+  len += rec->str_used;
+
+  buf[0] = LOG_BINARY_SYNC0;
+  buf[1] = LOG_BINARY_SYNC1;
+  buf[2] = (uint8_t)len;
+
+  mico_rtos_lock_mutex( &stdio_tx_mutex );
+  MicoUartSend( STDIO_UART, buf, len );
+  mico_rtos_unlock_mutex( &stdio_tx_mutex );
+}
+
+static void log_emit( const log_record_t* rec )
+{
+  char line[LOG_LINE_LEN];
+
+  if ( log_binary ) {
+    log_emit_binary( rec );
+    return;
+  }
+
+  log_format( rec, line, sizeof( line ) - 2 );
+  mico_rtos_lock_mutex( &stdio_tx_mutex );
+  printf( "%s\r\n", line );
+  mico_rtos_unlock_mutex( &stdio_tx_mutex );
+}
+
+static void log_flush( void )
+{
+  log_record_t rec;
+  log_record_t* slot;
+  static uint32_t reported = 0;
+  uint32_t dropped;
+
+  while ( log_tail != log_head ) {
+    slot = &log_ring[log_tail & ( MICO_LOG_RING_SIZE - 1 )];
+    /* Claimed but the producer is still filling it in */
+    if ( slot->seq != log_tail + 1 ) break;
+
+    /* Release the slot before the slow UART output */
+    memcpy( &rec, slot, sizeof( rec ) );
+    __DMB();
+    log_tail++;
+
+    log_emit( &rec );
+  }
+
+  dropped = log_dropped;
+  if ( dropped != reported ) {
+    /* In binary mode a record with a NULL format carries the drop counter */
+    memset( &rec, 0, sizeof( rec ) );
+    rec.time   = mico_get_time();
+    rec.module = "LOG";
+    rec.file   = __FILE__;
+    rec.line   = __LINE__;
+    rec.level  = MICO_LOG_WARN;
+    rec.format = log_binary ? NULL : "%u records dropped";
+    rec.arg[0] = dropped - reported;
+    rec.words  = 1;
+    log_emit( &rec );
+    reported = dropped;
+  }
+}
+
+static void log_thread( void* arg )
+{
+  UNUSED_PARAMETER( arg );
+
+  while ( 1 ) {
+    mico_rtos_get_semaphore( &log_sem, MICO_LOG_FLUSH_INTERVAL );
+    log_flush();
+  }
+}
+
+OSStatus mico_log_init( void )
+{
+  OSStatus err = kNoErr;
+
+  require_action_quiet( log_sem == NULL, exit, err = kAlreadyInitializedErr );
+
+  err = mico_rtos_init_semaphore( &log_sem, 1 );
+  require_noerr( err, exit );
+
+  err = mico_rtos_create_thread( NULL, MICO_LOG_THREAD_PRIORITY, "log", log_thread, STACK_SIZE_MICO_LOG_THREAD, NULL );
+  require_noerr( err, exit );
+
+exit:
+  return err;
+}
+
+OSStatus mico_log_set_level( const char* module, mico_log_level_t level )
+{
+  int i;
+
+  if ( module == NULL ) {
+    log_default_level = level;
+    return kNoErr;
+  }
+
+  for ( i = 0; i < MICO_LOG_MODULE_MAX; i++ ) {
+    if ( log_modules[i].module == NULL ) {
+      /* Publish the level before the name so producers never see a stale entry */
+      log_modules[i].level = (uint8_t)level;
+      __DMB();
+      log_modules[i].module = module;
+      return kNoErr;
+    }
+    if ( strcmp( log_modules[i].module, module ) == 0 ) {
+      log_modules[i].level = (uint8_t)level;
+      return kNoErr;
+    }
+  }
+  return kNoSpaceErr;
+}
+
+void mico_log_set_binary( bool enable )
+{
+  log_binary = enable;
+}
+
+void mico_log_get_stats( mico_log_stats_t* stats )
+{
+  stats->logged     = log_logged;
+  stats->dropped    = log_dropped;
+  stats->filtered   = log_filtered;
+  stats->high_water = log_high_water;
+}
+
+#endif /* MICO_DEFERRED_LOG */
+
@@ -41,6 +41,9 @@ typedef struct _pair_list_in_flash_t {
 /* Malloc a memory and */
 //OSStatus HKReadPairList(pair_list_in_flash_t **pPairList);
 
+/* Load the pairing store, call after mico_system_init */
+OSStatus HKPairInfoInit(void);
+
 uint32_t HKPairInfoCount(void);
 
 OSStatus HKPairInfoClear(void);
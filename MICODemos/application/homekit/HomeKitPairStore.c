@@ -0,0 +1,512 @@
+/**
+  ******************************************************************************
+  * @file    HomeKitPairStore.c
+  * @version V1.0.0
+  * @brief   Pairing store, see HomeKitPairStore.h. Lookups hash the name,
+  *          probe the index and read the one matching record from flash. An
+  *          add or remove programs one record, no erase, so flash wear and
+  *          pair-verify time no longer grow with the number of controllers.
+  ******************************************************************************
+  * @attention
+  *
+  * THE PRESENT FIRMWARE WHICH IS FOR GUIDANCE ONLY AIMS AT PROVIDING CUSTOMERS
+  * WITH CODING INFORMATION REGARDING THEIR PRODUCTS IN ORDER FOR THEM TO SAVE
+  * TIME. AS A RESULT, MXCHIP Inc. SHALL NOT BE HELD LIABLE FOR ANY
+  * DIRECT, INDIRECT OR CONSEQUENTIAL DAMAGES WITH RESPECT TO ANY CLAIMS ARISING
+  * FROM THE CONTENT OF SUCH FIRMWARE AND/OR THE USE MADE BY CUSTOMERS OF THE
+  * CODING INFORMATION CONTAINED HEREIN IN CONNECTION WITH THEIR PRODUCTS.
+  *
+  * <h2><center>&copy; COPYRIGHT 2014 MXCHIP Inc.</center></h2>
+  ******************************************************************************
+  */
+
+#include "Debug.h"
+#include "HomeKitPairStore.h"
+#include "CheckSumUtils.h"
+
+#define HK_PAIR_BANK_MAGIC      0x3150484B  /* "KHP1" */
+
+#define HK_PAIR_RECORD_ADD      0xA5
+#define HK_PAIR_RECORD_REMOVE   0x5A
+#define HK_PAIR_RECORD_ERASED   0xFF
+
+/* Starts every bank, written last when a bank is filled by a compaction */
+typedef struct
+{
+  uint32_t          magic;
+  uint32_t          sequence;
+  uint16_t          crc;            /* CRC16 of magic and sequence */
+  uint16_t          reserved;
+} hk_pair_bank_t;
+
+/* Followed by the name and, in an add record, the LTPK, padded to 4 bytes */
+typedef struct
+{
+  uint8_t           type;
+  uint8_t           nameLen;
+  uint8_t           permission;
+  uint8_t           reserved;
+  uint16_t          crc;            /* CRC16 of the whole record with crc 0 */
+  uint16_t          size;
+} hk_pair_record_t;
+
+#define HK_PAIR_RECORD_MAX      ( sizeof(hk_pair_record_t) + HK_PAIR_STORE_NAME_LEN + HK_PAIR_STORE_LTPK_LEN )
+
+typedef union
+{
+  hk_pair_record_t  record;
+  uint32_t          words[HK_PAIR_RECORD_MAX / 4];
+} hk_pair_buffer_t;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static uint32_t bank_base( hk_pair_store_t *store, uint8_t bank )
+{
+  return store->base + bank * store->bankSize;
+}
+
+static OSStatus flash_read( hk_pair_store_t *store, uint32_t offset, void *buffer, uint32_t length )
+{
+  volatile uint32_t address = offset;
+  return MicoFlashRead( store->partition, &address, (uint8_t *)buffer, length );
+}
+
+static OSStatus flash_write( hk_pair_store_t *store, uint32_t offset, const void *buffer, uint32_t length )
+{
+  volatile uint32_t address = offset;
+  return MicoFlashWrite( store->partition, &address, (uint8_t *)buffer, length );
+}
+
+static uint16_t crc16( const void *data, uint32_t length )
+{
+  CRC16_Context ctx;
+  uint16_t crc;
+
+  CRC16_Init( &ctx );
+  CRC16_Update( &ctx, data, length );
+  CRC16_Final( &ctx, &crc );
+  return crc;
+}
+
+/* FNV-1a */
+static uint32_t name_hash( const char *name, uint32_t nameLen )
+{
+  uint32_t hash = 2166136261u;
+
+  while( nameLen-- ){
+    hash ^= (uint8_t)*name++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static uint32_t record_size( uint8_t type, uint32_t nameLen )
+{
+  uint32_t size = sizeof(hk_pair_record_t) + nameLen;
+  if( type == HK_PAIR_RECORD_ADD )
+    size += HK_PAIR_STORE_LTPK_LEN;
+  return ( size + 3 ) & ~3u;
+}
+
+static uint32_t record_build( hk_pair_buffer_t *buf, uint8_t type, const char *name, uint32_t nameLen,
+                              const uint8_t *ltpk, uint8_t permission )
+{
+  uint8_t *body = (uint8_t *)&buf->record + sizeof(hk_pair_record_t);
+  uint32_t size = record_size( type, nameLen );
+
+  memset( buf, 0x0, size );
+  buf->record.type = type;
+  buf->record.nameLen = (uint8_t)nameLen;
+  buf->record.permission = permission;
+  buf->record.size = (uint16_t)size;
+  memcpy( body, name, nameLen );
+  if( type == HK_PAIR_RECORD_ADD )
+    memcpy( body + nameLen, ltpk, HK_PAIR_STORE_LTPK_LEN );
+  buf->record.crc = crc16( buf, size );
+  return size;
+}
+
+static bool record_valid( hk_pair_buffer_t *buf )
+{
+  uint16_t crc = buf->record.crc;
+  bool valid;
+
+  buf->record.crc = 0;
+  valid = crc16( buf, buf->record.size ) == crc;
+  buf->record.crc = crc;
+  return valid;
+}
+
+static void table_insert( hk_pair_store_t *store, uint32_t index )
+{
+  uint32_t slot = store->entry[index].hash & ( HK_PAIR_STORE_TABLE_SIZE - 1 );
+
+  while( store->table[slot] != 0 )
+    slot = ( slot + 1 ) & ( HK_PAIR_STORE_TABLE_SIZE - 1 );
+  store->table[slot] = (uint8_t)( index + 1 );
+}
+
+static void table_rebuild( hk_pair_store_t *store )
+{
+  uint32_t i;
+
+  memset( store->table, 0x0, sizeof(store->table) );
+  for( i = 0; i < store->count; i++ )
+    table_insert( store, i );
+}
+
+/* Index of the entry of name or -1, leaves the name and LTPK of its record in payload */
+static int32_t pair_lookup( hk_pair_store_t *store, const char *name, uint32_t nameLen, uint32_t hash, uint8_t *payload )
+{
+  uint32_t slot = hash & ( HK_PAIR_STORE_TABLE_SIZE - 1 );
+  hk_pair_entry_t *entry;
+  uint32_t offset;
+
+  while( store->table[slot] != 0 ){
+    entry = &store->entry[store->table[slot] - 1];
+    if( entry->hash == hash && entry->nameLen == nameLen ){
+      offset = bank_base( store, store->bank ) + entry->offset + sizeof(hk_pair_record_t);
+      if( flash_read( store, offset, payload, nameLen + HK_PAIR_STORE_LTPK_LEN ) == kNoErr &&
+          memcmp( payload, name, nameLen ) == 0 )
+        return store->table[slot] - 1;
+    }
+    slot = ( slot + 1 ) & ( HK_PAIR_STORE_TABLE_SIZE - 1 );
+  }
+  return -1;
+}
+
+static void pair_delete( hk_pair_store_t *store, uint32_t index )
+{
+  memmove( &store->entry[index], &store->entry[index + 1], ( store->count - index - 1 ) * sizeof(hk_pair_entry_t) );
+  store->count--;
+  table_rebuild( store );
+}
+
+static OSStatus bank_start( hk_pair_store_t *store, uint8_t bank, uint32_t sequence )
+{
+  hk_pair_bank_t header;
+
+  header.magic = HK_PAIR_BANK_MAGIC;
+  header.sequence = sequence;
+  header.crc = crc16( &header, 8 );
+  header.reserved = 0;
+  return flash_write( store, bank_base( store, bank ), &header, sizeof(header) );
+}
+
+static bool bank_valid( hk_pair_store_t *store, uint8_t bank, uint32_t *sequence )
+{
+  hk_pair_bank_t header;
+
+  if( flash_read( store, bank_base( store, bank ), &header, sizeof(header) ) != kNoErr )
+    return false;
+  if( header.magic != HK_PAIR_BANK_MAGIC || header.crc != crc16( &header, 8 ) )
+    return false;
+  *sequence = header.sequence;
+  return true;
+}
+
+/* Copies the live records to the other bank, which becomes the active one */
+static OSStatus pair_compact( hk_pair_store_t *store )
+{
+  OSStatus err = kNoErr;
+  uint8_t other = store->bank ^ 1;
+  uint16_t offsets[HK_PAIR_STORE_MAX];
+  hk_pair_buffer_t buf;
+  uint32_t i, size, offset = sizeof(hk_pair_bank_t);
+
+  err = MicoFlashErase( store->partition, bank_base( store, other ), store->bankSize );
+  require_noerr( err, exit );
+
+  for( i = 0; i < store->count; i++ ){
+    size = record_size( HK_PAIR_RECORD_ADD, store->entry[i].nameLen );
+    require_action( offset + size <= store->bankSize, exit, err = kNoSpaceErr );
+    err = flash_read( store, bank_base( store, store->bank ) + store->entry[i].offset, &buf, size );
+    require_noerr( err, exit );
+    err = flash_write( store, bank_base( store, other ) + offset, &buf, size );
+    require_noerr( err, exit );
+    offsets[i] = (uint16_t)offset;
+    offset += size;
+  }
+
+  /* The new bank takes over once its header is written */
+  err = bank_start( store, other, store->sequence + 1 );
+  require_noerr( err, exit );
+
+  for( i = 0; i < store->count; i++ )
+    store->entry[i].offset = offsets[i];
+  store->bank = other;
+  store->sequence++;
+  store->end = offset;
+  store->dirty = false;
+
+exit:
+  return err;
+}
+
+/* Appends a record, compacts first if the active bank has no room for it */
+static OSStatus pair_append( hk_pair_store_t *store, hk_pair_buffer_t *buf, uint32_t size, uint16_t *offset )
+{
+  OSStatus err = kNoErr;
+
+  if( store->dirty || store->end + size > store->bankSize ){
+    err = pair_compact( store );
+    require_noerr( err, exit );
+  }
+  require_action( store->end + size <= store->bankSize, exit, err = kNoSpaceErr );
+
+  err = flash_write( store, bank_base( store, store->bank ) + store->end, buf, size );
+  if( err != kNoErr ){
+    /* Part of the record may be programmed, do not write over it */
+    store->dirty = true;
+    goto exit;
+  }
+  *offset = (uint16_t)store->end;
+  store->end += size;
+
+exit:
+  return err;
+}
+
+/* Replays the records of the active bank into the index */
+static void pair_load( hk_pair_store_t *store )
+{
+  uint32_t base = bank_base( store, store->bank );
+  uint32_t offset = sizeof(hk_pair_bank_t);
+  uint8_t payload[HK_PAIR_STORE_NAME_LEN + HK_PAIR_STORE_LTPK_LEN];
+  uint8_t *body;
+  hk_pair_buffer_t buf;
+  uint32_t hash, i;
+  int32_t index;
+
+  while( offset + sizeof(hk_pair_record_t) <= store->bankSize ){
+    if( flash_read( store, base + offset, &buf, sizeof(hk_pair_record_t) ) != kNoErr )
+      break;
+    if( buf.record.type == HK_PAIR_RECORD_ERASED && buf.record.size == 0xFFFF )
+      break;
+
+    /* A record cut short by a reset ends the log, the next append compacts */
+    if( ( buf.record.type != HK_PAIR_RECORD_ADD && buf.record.type != HK_PAIR_RECORD_REMOVE ) ||
+        buf.record.nameLen == 0 || buf.record.nameLen > HK_PAIR_STORE_NAME_LEN ||
+        buf.record.size != record_size( buf.record.type, buf.record.nameLen ) ||
+        offset + buf.record.size > store->bankSize ||
+        flash_read( store, base + offset, &buf, buf.record.size ) != kNoErr ||
+        !record_valid( &buf ) ){
+      store->dirty = true;
+      break;
+    }
+
+    body = (uint8_t *)&buf.record + sizeof(hk_pair_record_t);
+    hash = name_hash( (char *)body, buf.record.nameLen );
+    index = pair_lookup( store, (char *)body, buf.record.nameLen, hash, payload );
+    if( buf.record.type == HK_PAIR_RECORD_ADD ){
+      if( index >= 0 ){
+        store->entry[index].offset = (uint16_t)offset;
+        store->entry[index].permission = buf.record.permission;
+      }else if( store->count < HK_PAIR_STORE_MAX ){
+        store->entry[store->count].hash = hash;
+        store->entry[store->count].offset = (uint16_t)offset;
+        store->entry[store->count].nameLen = buf.record.nameLen;
+        store->entry[store->count].permission = buf.record.permission;
+        table_insert( store, store->count++ );
+      }
+    }else if( index >= 0 ){
+      pair_delete( store, index );
+    }
+    offset += record_size( buf.record.type, buf.record.nameLen );
+  }
+  store->end = offset;
+
+  /* Appends go to erased flash only */
+  while( !store->dirty && offset < store->bankSize ){
+    uint32_t length = store->bankSize - offset < sizeof(buf) ? store->bankSize - offset : sizeof(buf);
+    if( flash_read( store, base + offset, &buf, length ) != kNoErr ){
+      store->dirty = true;
+      break;
+    }
+    for( i = 0; i < length; i++ ){
+      if( ( (uint8_t *)&buf )[i] != 0xFF ){
+        store->dirty = true;
+        break;
+      }
+    }
+    offset += length;
+  }
+}
+
+OSStatus HKPairStoreInit( hk_pair_store_t *store, mico_partition_t partition, uint32_t base, uint32_t bankSize )
+{
+  OSStatus err = kNoErr;
+  uint32_t sequence[2];
+  bool valid[2];
+
+  require_action( store && bankSize % 4 == 0 && bankSize <= 0x10000 &&
+                  bankSize >= sizeof(hk_pair_bank_t) + HK_PAIR_RECORD_MAX, exit, err = kParamErr );
+
+  memset( store, 0x0, sizeof(hk_pair_store_t) );
+  store->partition = partition;
+  store->base = base;
+  store->bankSize = bankSize;
+
+  valid[0] = bank_valid( store, 0, &sequence[0] );
+  valid[1] = bank_valid( store, 1, &sequence[1] );
+
+  if( !valid[0] && !valid[1] ){
+    /* Blank or foreign flash, start with an empty bank 0 */
+    err = MicoFlashErase( store->partition, bank_base( store, 0 ), store->bankSize );
+    require_noerr( err, exit );
+    err = bank_start( store, 0, 1 );
+    require_noerr( err, exit );
+    store->sequence = 1;
+    store->end = sizeof(hk_pair_bank_t);
+    goto exit;
+  }
+
+  if( valid[0] && valid[1] )
+    store->bank = (int32_t)( sequence[1] - sequence[0] ) > 0 ? 1 : 0;
+  else
+    store->bank = valid[1] ? 1 : 0;
+  store->sequence = sequence[store->bank];
+  pair_load( store );
+
+exit:
+  return err;
+}
+
+uint32_t HKPairStoreCount( hk_pair_store_t *store )
+{
+  return store->count;
+}
+
+OSStatus HKPairStoreAdd( hk_pair_store_t *store, const char *name, const uint8_t ltpk[32], uint8_t permission )
+{
+  OSStatus err = kNoErr;
+  uint8_t payload[HK_PAIR_STORE_NAME_LEN + HK_PAIR_STORE_LTPK_LEN];
+  hk_pair_buffer_t buf;
+  uint32_t nameLen, hash, size;
+  uint16_t offset;
+  int32_t index;
+
+  require_action( name && ltpk, exit, err = kParamErr );
+  nameLen = strnlen( name, HK_PAIR_STORE_NAME_LEN );
+  require_action( nameLen > 0, exit, err = kParamErr );
+
+  hash = name_hash( name, nameLen );
+  index = pair_lookup( store, name, nameLen, hash, payload );
+  if( index >= 0 ){
+    /* Nothing to program if the pairing is unchanged */
+    if( store->entry[index].permission == permission &&
+        memcmp( payload + nameLen, ltpk, HK_PAIR_STORE_LTPK_LEN ) == 0 )
+      goto exit;
+  }else{
+    require_action( store->count < HK_PAIR_STORE_MAX, exit, err = kNoSpaceErr );
+  }
+
+  size = record_build( &buf, HK_PAIR_RECORD_ADD, name, nameLen, ltpk, permission );
+  err = pair_append( store, &buf, size, &offset );
+  require_noerr( err, exit );
+
+  if( index < 0 ){
+    index = store->count;
+    store->entry[index].hash = hash;
+    store->entry[index].nameLen = (uint8_t)nameLen;
+    table_insert( store, store->count++ );
+  }
+  store->entry[index].offset = offset;
+  store->entry[index].permission = permission;
+
+exit:
+  return err;
+}
+
+OSStatus HKPairStoreRemove( hk_pair_store_t *store, const char *name )
+{
+  OSStatus err = kNoErr;
+  uint8_t payload[HK_PAIR_STORE_NAME_LEN + HK_PAIR_STORE_LTPK_LEN];
+  hk_pair_buffer_t buf;
+  uint32_t nameLen, size;
+  uint16_t offset;
+  int32_t index;
+
+  require_action( name, exit, err = kParamErr );
+  nameLen = strnlen( name, HK_PAIR_STORE_NAME_LEN );
+  index = pair_lookup( store, name, nameLen, name_hash( name, nameLen ), payload );
+  require_action( index >= 0, exit, err = kNotFoundErr );
+
+  size = record_build( &buf, HK_PAIR_RECORD_REMOVE, name, nameLen, NULL, 0 );
+  err = pair_append( store, &buf, size, &offset );
+  require_noerr( err, exit );
+  pair_delete( store, index );
+
+exit:
+  return err;
+}
+
+OSStatus HKPairStoreFind( hk_pair_store_t *store, const char *name, uint8_t ltpk[32], uint8_t *permission )
+{
+  OSStatus err = kNoErr;
+  uint8_t payload[HK_PAIR_STORE_NAME_LEN + HK_PAIR_STORE_LTPK_LEN];
+  uint32_t nameLen;
+  int32_t index;
+
+  require_action( name, exit, err = kParamErr );
+  nameLen = strnlen( name, HK_PAIR_STORE_NAME_LEN );
+  index = pair_lookup( store, name, nameLen, name_hash( name, nameLen ), payload );
+  require_action( index >= 0, exit, err = kNotFoundErr );
+
+  if( ltpk != NULL )
+    memcpy( ltpk, payload + nameLen, HK_PAIR_STORE_LTPK_LEN );
+  if( permission != NULL )
+    *permission = store->entry[index].permission;
+
+exit:
+  return err;
+}
+
+OSStatus HKPairStoreGet( hk_pair_store_t *store, uint32_t index, char name[64], uint8_t ltpk[32], uint8_t *permission )
+{
+  OSStatus err = kNoErr;
+  uint8_t payload[HK_PAIR_STORE_NAME_LEN + HK_PAIR_STORE_LTPK_LEN];
+  hk_pair_entry_t *entry;
+
+  require_action( index < store->count, exit, err = kNotFoundErr );
+  entry = &store->entry[index];
+
+  err = flash_read( store, bank_base( store, store->bank ) + entry->offset + sizeof(hk_pair_record_t),
+                    payload, entry->nameLen + HK_PAIR_STORE_LTPK_LEN );
+  require_noerr( err, exit );
+
+  if( name != NULL ){
+    memset( name, 0x0, HK_PAIR_STORE_NAME_LEN );
+    memcpy( name, payload, entry->nameLen );
+  }
+  if( ltpk != NULL )
+    memcpy( ltpk, payload + entry->nameLen, HK_PAIR_STORE_LTPK_LEN );
+  if( permission != NULL )
+    *permission = entry->permission;
+
+exit:
+  return err;
+}
+
+OSStatus HKPairStoreClear( hk_pair_store_t *store )
+{
+  OSStatus err = kNoErr;
+  uint8_t other = store->bank ^ 1;
+
+  err = MicoFlashErase( store->partition, bank_base( store, other ), store->bankSize );
+  require_noerr( err, exit );
+  err = bank_start( store, other, store->sequence + 1 );
+  require_noerr( err, exit );
+
+  store->bank = other;
+  store->sequence++;
+  store->end = sizeof(hk_pair_bank_t);
+  store->dirty = false;
+  store->count = 0;
+  memset( store->table, 0x0, sizeof(store->table) );
+
+exit:
+  return err;
+}
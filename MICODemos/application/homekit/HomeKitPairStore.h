@@ -0,0 +1,90 @@
+/**
+  ******************************************************************************
+  * @file    HomeKitPairStore.h
+  * @version V1.0.0
+  * @brief   Pairing store: controller records appended to a flash log with a
+  *          CRC each, found through a hash index in RAM.
+  ******************************************************************************
+  * @attention
+  *
+  * THE PRESENT FIRMWARE WHICH IS FOR GUIDANCE ONLY AIMS AT PROVIDING CUSTOMERS
+  * WITH CODING INFORMATION REGARDING THEIR PRODUCTS IN ORDER FOR THEM TO SAVE
+  * TIME. AS A RESULT, MXCHIP Inc. SHALL NOT BE HELD LIABLE FOR ANY
+  * DIRECT, INDIRECT OR CONSEQUENTIAL DAMAGES WITH RESPECT TO ANY CLAIMS ARISING
+  * FROM THE CONTENT OF SUCH FIRMWARE AND/OR THE USE MADE BY CUSTOMERS OF THE
+  * CODING INFORMATION CONTAINED HEREIN IN CONNECTION WITH THEIR PRODUCTS.
+  *
+  * <h2><center>&copy; COPYRIGHT 2014 MXCHIP Inc.</center></h2>
+  ******************************************************************************
+  */
+#pragma once
+
+#include "Common.h"
+#include "MicoDrivers/MicoDriverFlash.h"
+
+/* The store uses two banks of bankSize bytes, bank 1 right after bank 0. A
+ * bank is a header with a sequence number followed by add and remove records,
+ * the bank with the highest valid sequence number is the active one. Records
+ * are only appended, a bank is erased only when the active bank is full and
+ * the live records are copied over to the other one. bankSize must be a
+ * multiple of the erase sector of the partition and at most 64k. */
+
+/* Pairings the store holds, MaxPairRecord of HomeKitPairList.h */
+#ifndef HK_PAIR_STORE_MAX
+#define HK_PAIR_STORE_MAX           16
+#endif
+
+/* Slots of the hash index, a power of two above HK_PAIR_STORE_MAX */
+#ifndef HK_PAIR_STORE_TABLE_SIZE
+#define HK_PAIR_STORE_TABLE_SIZE    ( HK_PAIR_STORE_MAX * 2 )
+#endif
+
+#if ( HK_PAIR_STORE_TABLE_SIZE & ( HK_PAIR_STORE_TABLE_SIZE - 1 ) ) || HK_PAIR_STORE_TABLE_SIZE <= HK_PAIR_STORE_MAX || HK_PAIR_STORE_MAX > 255
+#error "HK_PAIR_STORE_TABLE_SIZE must be a power of two above HK_PAIR_STORE_MAX, HK_PAIR_STORE_MAX at most 255"
+#endif
+
+#define HK_PAIR_STORE_NAME_LEN      64
+#define HK_PAIR_STORE_LTPK_LEN      32
+
+/* A live pairing: the hash of its name and where its add record is */
+typedef struct
+{
+  uint32_t          hash;
+  uint16_t          offset;
+  uint8_t           nameLen;
+  uint8_t           permission;
+} hk_pair_entry_t;
+
+typedef struct
+{
+  mico_partition_t  partition;
+  uint32_t          base;           /* Offset of bank 0 in the partition */
+  uint32_t          bankSize;
+  uint32_t          sequence;       /* Of the active bank */
+  uint8_t           bank;           /* Active bank, 0 or 1 */
+  bool              dirty;          /* A torn record, compact before the next append */
+  uint32_t          end;            /* Where the next record goes */
+  uint32_t          count;
+  hk_pair_entry_t   entry[HK_PAIR_STORE_MAX];
+  uint8_t           table[HK_PAIR_STORE_TABLE_SIZE]; /* Index + 1 into entry[], 0 is empty */
+} hk_pair_store_t;
+
+/* Loads the active bank, formats bank 0 if neither bank is valid */
+OSStatus HKPairStoreInit( hk_pair_store_t *store, mico_partition_t partition, uint32_t base, uint32_t bankSize );
+
+uint32_t HKPairStoreCount( hk_pair_store_t *store );
+
+/* Adds a pairing or updates the key and permission of an existing one,
+ * kNoSpaceErr if HK_PAIR_STORE_MAX pairings exist or the bank is too small. */
+OSStatus HKPairStoreAdd( hk_pair_store_t *store, const char *name, const uint8_t ltpk[32], uint8_t permission );
+
+OSStatus HKPairStoreRemove( hk_pair_store_t *store, const char *name );
+
+/* kNotFoundErr if name is not paired, ltpk and permission may be NULL */
+OSStatus HKPairStoreFind( hk_pair_store_t *store, const char *name, uint8_t ltpk[32], uint8_t *permission );
+
+/* The index-th pairing, name is zero padded to HK_PAIR_STORE_NAME_LEN bytes */
+OSStatus HKPairStoreGet( hk_pair_store_t *store, uint32_t index, char name[64], uint8_t ltpk[32], uint8_t *permission );
+
+/* Removes all pairings with one bank erase */
+OSStatus HKPairStoreClear( hk_pair_store_t *store );
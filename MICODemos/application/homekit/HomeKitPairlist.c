@@ -23,9 +23,154 @@
 #include "mico_app_define.h"
 #include "HomeKit.h"
 #include "HomeKitPairlist.h"
+#include "HomeKitPairStore.h"
 
 extern app_context_t* app_context;
 
+#ifdef HK_PAIR_STORE_PARTITION
+
+/* Pairings live in their own flash partition, an add or remove no longer
+   rewrites the parameter sectors through mico_system_context_update */
+static hk_pair_store_t pair_store;
+static mico_mutex_t pair_store_mutex = NULL;
+
+OSStatus HKPairInfoInit(void)
+{
+  OSStatus err = kNoErr;
+  pair_list_in_flash_t *pairList = &app_context->appConfig->pairList;
+  bool migrated = false;
+  uint32_t i;
+
+  err = mico_rtos_init_mutex(&pair_store_mutex);
+  require_noerr(err, exit);
+
+  err = HKPairStoreInit(&pair_store, HK_PAIR_STORE_PARTITION, HK_PAIR_STORE_OFFSET, HK_PAIR_STORE_BANK_SIZE);
+  require_noerr(err, exit);
+
+  /* Move records of the old pair list in the parameter sectors to the store, once */
+  for(i=0; i < MaxPairRecord; i++){
+    if(pairList->pairInfo[i].controllerName[0] != 0x0){
+      err = HKPairStoreAdd(&pair_store, pairList->pairInfo[i].controllerName, pairList->pairInfo[i].controllerLTPK,
+                           (uint8_t)(pairList->pairInfo[i].permission&0x1));
+      require_noerr(err, exit);
+      migrated = true;
+    }
+  }
+  if(migrated == true){
+    memset(pairList->pairInfo, 0x0, sizeof(pair_list_in_flash_t));
+    err = mico_system_context_update( mico_system_context_get() );
+    require_noerr(err, exit);
+  }
+
+  /* Default settings restored: no LTSK, so no stored pairing can verify any more */
+  if(app_context->appConfig->paired == false && HKPairStoreCount(&pair_store) != 0)
+    err = HKPairStoreClear(&pair_store);
+
+exit: 
+  return err;
+}
+
+uint32_t HKPairInfoCount(void)
+{
+  uint32_t count;
+
+  mico_rtos_lock_mutex(&pair_store_mutex);
+  count = HKPairStoreCount(&pair_store);
+  mico_rtos_unlock_mutex(&pair_store_mutex);
+  return count;
+}
+
+OSStatus HKPairInfoClear(void)
+{
+  OSStatus err = kNoErr;
+
+  mico_rtos_lock_mutex(&pair_store_mutex);
+  err = HKPairStoreClear(&pair_store);
+  mico_rtos_unlock_mutex(&pair_store_mutex);
+  return err;
+}
+
+OSStatus HKPairInfoInsert(char controllerIdentifier[64], uint8_t controllerLTPK[32], bool admin)
+{
+  OSStatus err = kNoErr;
+  uint8_t permission = 0;
+
+  mico_rtos_lock_mutex(&pair_store_mutex);
+
+  /* Keep the other permission bits of an existing record */
+  HKPairStoreFind(&pair_store, controllerIdentifier, NULL, &permission);
+  if(admin)
+    permission = permission|0x01;
+  else
+    permission = permission&0xFE;
+
+  err = HKPairStoreAdd(&pair_store, controllerIdentifier, controllerLTPK, permission);
+
+  mico_rtos_unlock_mutex(&pair_store_mutex);
+  return err;
+}
+
+OSStatus HKPairInfoFindByName(char controllerIdentifier[64], uint8_t foundControllerLTPK[32], bool *isAdmin )
+{
+  OSStatus err = kNotFoundErr;
+  uint8_t permission;
+
+  mico_rtos_lock_mutex(&pair_store_mutex);
+  err = HKPairStoreFind(&pair_store, controllerIdentifier, foundControllerLTPK, &permission);
+  mico_rtos_unlock_mutex(&pair_store_mutex);
+  require_noerr_quiet(err, exit);
+
+  if( isAdmin != NULL )
+    *isAdmin = permission&0x1;
+
+exit:
+  return err;
+}
+
+OSStatus HKPairInfoFindByIndex(uint32_t index, char controllerIdentifier[64], uint8_t foundControllerLTPK[32], bool *isAdmin )
+{
+  OSStatus err = kNoErr;
+  uint8_t permission;
+
+  mico_rtos_lock_mutex(&pair_store_mutex);
+  err = HKPairStoreGet(&pair_store, index, controllerIdentifier, foundControllerLTPK, &permission);
+  mico_rtos_unlock_mutex(&pair_store_mutex);
+  require_noerr_quiet(err, exit);
+
+  if( isAdmin != NULL )
+    *isAdmin = permission&0x1;
+
+exit:
+  return err;
+}
+
+OSStatus HKPairInfoRemove(char * name)
+{
+  OSStatus err = kNotFoundErr;
+
+  mico_rtos_lock_mutex(&pair_store_mutex);
+  err = HKPairStoreRemove(&pair_store, name);
+  mico_rtos_unlock_mutex(&pair_store_mutex);
+
+  return err;
+}
+
+#else
+
+/* No pairing store on this board: the pairings stay in the application config */
+OSStatus HKPairInfoInit(void)
+{
+  return kNoErr;
+}
+
+OSStatus HKPairInfoClear(void)
+{
+  pair_list_in_flash_t *pairList = &app_context->appConfig->pairList;
+
+  memset(pairList->pairInfo, 0x0, sizeof(pair_list_in_flash_t));
+  return mico_system_context_update( mico_system_context_get() );
+}
+
 uint32_t HKPairInfoCount(void)
 {
   pair_list_in_flash_t        *pairList = &app_context->appConfig->pairList;
@@ -145,3 +290,4 @@ OSStatus HKPairInfoRemove(char * name)
   return err;
 }
 
+#endif
@@ -82,3 +82,12 @@
 #define MICO_CONFIG_SERVER_ENABLE 
 #define MICO_CONFIG_SERVER_PORT    8000
 
+/************************************************************************
+ * HomeKit pairing store, two banks of HK_PAIR_STORE_BANK_SIZE bytes from
+ * HK_PAIR_STORE_OFFSET. Enable it on a board that declares the partition in
+ * its mico_user_partition_t and mico_partitions[], 8k bytes that erase in
+ * 4k sectors. Without it the pairings stay in the application config. */
+//#define HK_PAIR_STORE_PARTITION     MICO_PARTITION_HOMEKIT
+#define HK_PAIR_STORE_OFFSET        0x0
+#define HK_PAIR_STORE_BANK_SIZE     0x1000
+
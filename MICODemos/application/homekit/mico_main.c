@@ -124,6 +124,10 @@ OSStatus application_start( void *arg )
   /* mico system initialize */
   err = mico_system_init( mico_context );
   require_noerr( err, exit );
+
+  /* Load controller pairings */
+  err = HKPairInfoInit( );
+  require_noerr( err, exit );
   
   /* Start HomeKit daemon */
   memset(&hk_init, 0x0, sizeof(hk_init_t));
@@ -0,0 +1,114 @@
+/**
+******************************************************************************
+* @file    flash_sim.c
+* @version V1.0.0
+* @brief   RAM backed NOR flash for the host, see flash_sim.h.
+******************************************************************************
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "Common.h"
+#include "MicoDrivers/MicoDriverFlash.h"
+#include "flash_sim.h"
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+flash_sim_stats_t flash_sim_stats;
+
+static uint8_t*  flash;
+static uint32_t* sector_erases;
+static uint32_t  flash_size;
+static int       cut_active;
+static uint32_t  cut_left;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+int flash_sim_init( uint32_t size )
+{
+  free( flash );
+  free( sector_erases );
+  flash_size = size;
+  flash = malloc( size );
+  sector_erases = calloc( size / FLASH_SIM_SECTOR_SIZE, sizeof(uint32_t) );
+  if ( flash == NULL || sector_erases == NULL ) return -1;
+
+  /* Not erased: a store must not trust what it finds */
+  memset( flash, 0x5A, size );
+  memset( &flash_sim_stats, 0, sizeof(flash_sim_stats) );
+  cut_active = 0;
+  return 0;
+}
+
+void flash_sim_cut_after( uint32_t bytes )
+{
+  cut_active = 1;
+  cut_left = bytes;
+}
+
+void flash_sim_cut_reset( void )
+{
+  cut_active = 0;
+}
+
+uint32_t flash_sim_max_erases( void )
+{
+  uint32_t i, max = 0;
+
+  for ( i = 0; i < flash_size / FLASH_SIM_SECTOR_SIZE; i++ )
+    if ( sector_erases[i] > max ) max = sector_erases[i];
+  return max;
+}
+
+OSStatus MicoFlashErase( mico_partition_t inPartition, uint32_t off_set, uint32_t size )
+{
+  uint32_t sector, last;
+
+  (void)inPartition;
+  if ( size == 0 || off_set + size > flash_size ) return kGeneralErr;
+  if ( cut_active && cut_left == 0 ) return kGeneralErr;
+
+  last = ( off_set + size - 1 ) / FLASH_SIM_SECTOR_SIZE;
+  for ( sector = off_set / FLASH_SIM_SECTOR_SIZE; sector <= last; sector++ )
+  {
+    memset( flash + sector * FLASH_SIM_SECTOR_SIZE, 0xFF, FLASH_SIM_SECTOR_SIZE );
+    sector_erases[sector]++;
+    flash_sim_stats.erases++;
+  }
+  return kNoErr;
+}
+
+OSStatus MicoFlashWrite( mico_partition_t inPartition, volatile uint32_t* off_set, uint8_t* inBuffer, uint32_t inBufferLength )
+{
+  uint32_t i, length = inBufferLength;
+
+  (void)inPartition;
+  if ( *off_set + inBufferLength > flash_size ) return kGeneralErr;
+
+  if ( cut_active && cut_left < length ) length = cut_left;
+  for ( i = 0; i < length; i++ )
+    flash[*off_set + i] &= inBuffer[i];
+  if ( cut_active ) cut_left -= length;
+
+  flash_sim_stats.writes++;
+  flash_sim_stats.write_bytes += length;
+  *off_set += length;
+  return length == inBufferLength ? kNoErr : kWriteErr;
+}
+
+OSStatus MicoFlashRead( mico_partition_t inPartition, volatile uint32_t* off_set, uint8_t* outBuffer, uint32_t inBufferLength )
+{
+  (void)inPartition;
+  if ( *off_set + inBufferLength > flash_size ) return kGeneralErr;
+
+  memcpy( outBuffer, flash + *off_set, inBufferLength );
+  flash_sim_stats.reads++;
+  flash_sim_stats.read_bytes += inBufferLength;
+  *off_set += inBufferLength;
+  return kNoErr;
+}
@@ -0,0 +1,39 @@
+/**
+******************************************************************************
+* @file    flash_sim.h
+* @version V1.0.0
+* @brief   RAM backed NOR flash for the host: MicoFlashErase, MicoFlashWrite
+*          and MicoFlashRead on one buffer shared by all partitions. Erase
+*          sets whole sectors to 0xFF, a write can only clear bits, and a
+*          write can be cut short to model a reset in the middle of it.
+******************************************************************************
+*/
+
+#ifndef __FLASH_SIM_H__
+#define __FLASH_SIM_H__
+
+#include <stdint.h>
+
+#define FLASH_SIM_SECTOR_SIZE   0x1000
+
+typedef struct
+{
+  uint32_t erases;              /* Sectors erased */
+  uint32_t writes;
+  uint32_t write_bytes;
+  uint32_t reads;
+  uint32_t read_bytes;
+} flash_sim_stats_t;
+
+extern flash_sim_stats_t flash_sim_stats;
+
+int  flash_sim_init( uint32_t size );
+
+/* Programs only the next bytes bytes, then fails every write until reset */
+void flash_sim_cut_after( uint32_t bytes );
+void flash_sim_cut_reset( void );
+
+/* Erase count of the sector with the most erases */
+uint32_t flash_sim_max_erases( void );
+
+#endif /* __FLASH_SIM_H__ */
@@ -0,0 +1,365 @@
+/**
+******************************************************************************
+* @file    pair_store_test.c
+* @version V1.0.0
+* @brief   Host test of ../HomeKitPairStore.c on the RAM flash of flash_sim.c:
+*          a random add, update and remove sequence checked against a model,
+*          with reloads from flash and writes cut short by a reset, then the
+*          lookup time and the sector erases of the store at 16 and 64
+*          pairings next to the linear pair list it replaces.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "HomeKitPairStore.h"
+#include "flash_sim.h"
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define NAMES               ( HK_PAIR_STORE_MAX * 2 )   /* Controllers the random sequence picks from */
+#define RANDOM_OPS          20000
+#define LOOKUPS             1000000
+#define CHURN_OPS           1000
+
+/* The parameter sectors an add or remove of HomeKitPairlist.c used to
+ * rewrite, PARAMETER_1 and its backup PARAMETER_2 */
+#define CONTEXT_UPDATE_ERASES   2
+
+/******************************************************
+*                 Type Definitions
+******************************************************/
+
+typedef struct
+{
+  int               used;
+  uint8_t           ltpk[32];
+  uint8_t           permission;
+} model_t;
+
+/* The pair list of HomeKitPairList.h */
+typedef struct
+{
+  char              controllerName[64];
+  uint8_t           controllerLTPK[32];
+  int               permission;
+} list_pair_t;
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+static hk_pair_store_t store;
+static uint32_t        bank_size = 0x2000;
+static char            names[NAMES][64];
+static model_t         model[NAMES];
+static uint32_t        seed = 1;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static uint32_t rnd( void )
+{
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 8;
+}
+
+static uint64_t clock_ns( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int check( const char* name, int ok )
+{
+  printf( "  %-52s %s\n", name, ok ? "ok" : "FAILED" );
+  return ok ? 0 : 1;
+}
+
+/* Controller identifiers are UUID strings, as iOS sends them */
+static void make_names( void )
+{
+  uint32_t i;
+
+  for ( i = 0; i < NAMES; i++ )
+    sprintf( names[i], "%08X-%04X-4%03X-A%03X-%08X%04X", (unsigned)rnd( ), (unsigned)( rnd( ) & 0xFFFF ),
+             (unsigned)( rnd( ) & 0xFFF ), (unsigned)( rnd( ) & 0xFFF ), (unsigned)rnd( ), (unsigned)( i & 0xFFFF ) );
+}
+
+static void make_ltpk( uint8_t ltpk[32] )
+{
+  int i;
+  for ( i = 0; i < 32; i++ ) ltpk[i] = (uint8_t)rnd( );
+}
+
+static int model_count( const model_t* m )
+{
+  int i, n = 0;
+  for ( i = 0; i < NAMES; i++ ) n += m[i].used;
+  return n;
+}
+
+/* The store holds exactly the pairings of m */
+static int store_matches( const model_t* m )
+{
+  uint8_t ltpk[32], permission;
+  char name[64];
+  int i, j, seen[NAMES];
+
+  if ( (int)HKPairStoreCount( &store ) != model_count( m ) ) return 0;
+  for ( i = 0; i < NAMES; i++ )
+  {
+    OSStatus err = HKPairStoreFind( &store, names[i], ltpk, &permission );
+    if ( m[i].used != ( err == kNoErr ) ) return 0;
+    if ( m[i].used && ( memcmp( ltpk, m[i].ltpk, 32 ) || permission != m[i].permission ) ) return 0;
+  }
+
+  memset( seen, 0, sizeof seen );
+  for ( i = 0; i < (int)HKPairStoreCount( &store ); i++ )
+  {
+    if ( HKPairStoreGet( &store, i, name, ltpk, &permission ) != kNoErr ) return 0;
+    for ( j = 0; j < NAMES && strncmp( names[j], name, 64 ); j++ );
+    if ( j == NAMES || !m[j].used || seen[j]++ ) return 0;
+  }
+  return HKPairStoreGet( &store, i, name, ltpk, &permission ) == kNotFoundErr;
+}
+
+/* One random add, update or remove on the store and on m */
+static OSStatus random_op( model_t* m )
+{
+  uint32_t i = rnd( ) % NAMES;
+  uint8_t ltpk[32], permission = (uint8_t)( rnd( ) & 1 );
+  OSStatus err;
+
+  if ( m[i].used && rnd( ) % 3 == 0 )
+  {
+    err = HKPairStoreRemove( &store, names[i] );
+    if ( err == kNoErr ) m[i].used = 0;
+    return err;
+  }
+
+  if ( m[i].used && rnd( ) % 2 == 0 )
+    memcpy( ltpk, m[i].ltpk, 32 );   /* Same key, maybe a permission change */
+  else
+    make_ltpk( ltpk );
+  err = HKPairStoreAdd( &store, names[i], ltpk, permission );
+  if ( err == kNoErr || ( err == kNoSpaceErr && !m[i].used && model_count( m ) == HK_PAIR_STORE_MAX ) )
+  {
+    if ( err == kNoErr )
+    {
+      m[i].used = 1;
+      memcpy( m[i].ltpk, ltpk, 32 );
+      m[i].permission = permission;
+    }
+    return kNoErr;
+  }
+  return err;
+}
+
+static int self_check( void )
+{
+  static model_t after[NAMES];
+  uint8_t ltpk[32], ltpk2[32], permission;
+  uint32_t writes, erases;
+  int fails = 0, ok, i, cuts = 0, mismatches = 0;
+
+  flash_sim_init( 4 * bank_size );
+  memset( model, 0, sizeof model );
+
+  fails += check( "format blank flash", HKPairStoreInit( &store, MICO_PARTITION_NONE, 0, bank_size ) == kNoErr &&
+                  HKPairStoreCount( &store ) == 0 && flash_sim_stats.erases == bank_size / FLASH_SIM_SECTOR_SIZE );
+  erases = flash_sim_stats.erases;
+  fails += check( "reload an empty store", HKPairStoreInit( &store, MICO_PARTITION_NONE, 0, bank_size ) == kNoErr &&
+                  HKPairStoreCount( &store ) == 0 && flash_sim_stats.erases == erases );
+
+  make_ltpk( ltpk );
+  ok = HKPairStoreAdd( &store, names[0], ltpk, 1 ) == kNoErr &&
+       HKPairStoreFind( &store, names[0], ltpk2, &permission ) == kNoErr &&
+       memcmp( ltpk, ltpk2, 32 ) == 0 && permission == 1 &&
+       HKPairStoreFind( &store, names[1], NULL, NULL ) == kNotFoundErr &&
+       HKPairStoreAdd( &store, "", ltpk, 0 ) == kParamErr;
+  fails += check( "add and find", ok );
+
+  writes = flash_sim_stats.writes;
+  fails += check( "unchanged add programs nothing", HKPairStoreAdd( &store, names[0], ltpk, 1 ) == kNoErr &&
+                  flash_sim_stats.writes == writes );
+
+  ok = HKPairStoreAdd( &store, names[0], ltpk, 0 ) == kNoErr &&
+       HKPairStoreFind( &store, names[0], NULL, &permission ) == kNoErr && permission == 0 &&
+       HKPairStoreRemove( &store, names[0] ) == kNoErr &&
+       HKPairStoreRemove( &store, names[0] ) == kNotFoundErr &&
+       HKPairStoreCount( &store ) == 0;
+  fails += check( "update and remove", ok );
+
+  /* Random sequence, reloads from flash, and now and then a reset that cuts
+   * a write short: afterwards the store holds the state before or after the
+   * interrupted operation and takes the next one. */
+  for ( i = 0; i < RANDOM_OPS; i++ )
+  {
+    if ( i % 97 == 0 && HKPairStoreInit( &store, MICO_PARTITION_NONE, 0, bank_size ) != kNoErr ) break;
+    if ( i % 50 == 25 )
+    {
+      memcpy( after, model, sizeof model );
+      flash_sim_cut_after( rnd( ) % 120 );
+      random_op( after );
+      flash_sim_cut_reset( );
+      if ( HKPairStoreInit( &store, MICO_PARTITION_NONE, 0, bank_size ) != kNoErr ) break;
+      if ( store_matches( after ) )
+        memcpy( model, after, sizeof model );
+      else if ( !store_matches( model ) )
+        mismatches++;
+      cuts++;
+      continue;
+    }
+    if ( random_op( model ) != kNoErr || ( i % 10 == 0 && !store_matches( model ) ) ) mismatches++;
+  }
+  fails += check( "random sequence with reloads and cut writes", i == RANDOM_OPS && cuts > 0 && mismatches == 0 &&
+                  store_matches( model ) );
+  printf( "    %d operations, %d cut short, %u sectors erased, bank %u\n", RANDOM_OPS, cuts,
+          (unsigned)flash_sim_stats.erases, (unsigned)store.bank );
+
+  /* Fill it up */
+  HKPairStoreClear( &store );
+  memset( model, 0, sizeof model );
+  for ( i = 0; i < HK_PAIR_STORE_MAX; i++ )
+  {
+    make_ltpk( model[i].ltpk );
+    model[i].used = HKPairStoreAdd( &store, names[i], model[i].ltpk, 0 ) == kNoErr;
+  }
+  ok = model_count( model ) == HK_PAIR_STORE_MAX &&
+       HKPairStoreAdd( &store, names[HK_PAIR_STORE_MAX], ltpk, 0 ) == kNoSpaceErr &&
+       HKPairStoreAdd( &store, names[0], model[0].ltpk, 1 ) == kNoErr;
+  model[0].permission = 1;
+  fails += check( "full store refuses a new controller", ok && store_matches( model ) );
+
+  ok = HKPairStoreClear( &store ) == kNoErr && HKPairStoreCount( &store ) == 0 &&
+       HKPairStoreInit( &store, MICO_PARTITION_NONE, 0, bank_size ) == kNoErr && HKPairStoreCount( &store ) == 0;
+  fails += check( "clear", ok );
+  return fails;
+}
+
+static void bench( uint32_t n )
+{
+  static list_pair_t list[HK_PAIR_STORE_MAX];
+  volatile uint32_t sink = 0;
+  uint8_t ltpk[32];
+  uint32_t i, k, reads, erases, next = n;
+  uint64_t t;
+  double store_ns, list_ns;
+
+  flash_sim_init( 4 * bank_size );
+  HKPairStoreInit( &store, MICO_PARTITION_NONE, 0, bank_size );
+  memset( list, 0, sizeof list );
+  for ( i = 0; i < n; i++ )
+  {
+    make_ltpk( ltpk );
+    HKPairStoreAdd( &store, names[i], ltpk, 0 );
+    strcpy( list[i].controllerName, names[i] );
+    memcpy( list[i].controllerLTPK, ltpk, 32 );
+  }
+
+  /* HKPairInfoFindByName before: strncmp over every slot of the list */
+  t = clock_ns( );
+  for ( k = 0; k < LOOKUPS; k++ )
+  {
+    const char* name = names[k % n];
+    for ( i = 0; i < n; i++ )
+      if ( strncmp( list[i].controllerName, name, 64 ) == 0 )
+      {
+        memcpy( ltpk, list[i].controllerLTPK, 32 );
+        break;
+      }
+    sink += ltpk[0];
+  }
+  list_ns = (double)( clock_ns( ) - t ) / LOOKUPS;
+
+  reads = flash_sim_stats.reads;
+  t = clock_ns( );
+  for ( k = 0; k < LOOKUPS; k++ )
+  {
+    HKPairStoreFind( &store, names[k % n], ltpk, NULL );
+    sink += ltpk[0];
+  }
+  store_ns = (double)( clock_ns( ) - t ) / LOOKUPS;
+  reads = flash_sim_stats.reads - reads;
+
+  /* Pair and unpair controllers, the count stays at n */
+  erases = flash_sim_stats.erases;
+  for ( k = 0; k < CHURN_OPS; k += 2 )
+  {
+    HKPairStoreRemove( &store, names[( next - n ) % NAMES] );
+    make_ltpk( ltpk );
+    HKPairStoreAdd( &store, names[next % NAMES], ltpk, 0 );
+    next++;
+  }
+  erases = flash_sim_stats.erases - erases;
+
+  printf( "  %5u   %8.1f  %8.1f   %4.2f   %8u  %8u      %3u\n", (unsigned)n, list_ns, store_ns,
+          (double)reads / LOOKUPS, (unsigned)( CHURN_OPS * CONTEXT_UPDATE_ERASES ), (unsigned)erases,
+          (unsigned)flash_sim_max_erases( ) );
+  (void)sink;
+}
+
+static void usage( void )
+{
+  printf( "pair_store_test [-b bytes] [-k]\n"
+          "  -b bytes  bank size, a multiple of %u, default 0x2000\n"
+          "  -k        self check only\n", FLASH_SIM_SECTOR_SIZE );
+}
+
+int main( int argc, char** argv )
+{
+  int opt, check_only = 0;
+
+  while ( ( opt = getopt( argc, argv, "b:kh" ) ) != -1 )
+  {
+    switch ( opt )
+    {
+      case 'b': bank_size = (uint32_t)strtoul( optarg, NULL, 0 ); break;
+      case 'k': check_only = 1; break;
+      default: usage( ); return 2;
+    }
+  }
+
+  make_names( );
+  printf( "HomeKitPairStore, HK_PAIR_STORE_MAX %d, bank %u bytes\n", HK_PAIR_STORE_MAX, (unsigned)bank_size );
+  if ( self_check( ) != 0 ) return 1;
+  if ( check_only ) return 0;
+
+  printf( "\n  lookup ns: linear list in RAM / store, flash reads per store lookup\n"
+          "  sector erases per %d adds and removes: context update / store, worst sector\n\n", CHURN_OPS );
+  printf( "  pairs       list     store  reads    context     store   worst\n" );
+  bench( 16 );
+  if ( HK_PAIR_STORE_MAX >= 64 ) bench( 64 );
+  return 0;
+}
@@ -44,15 +44,23 @@ static bool is_handlers_registered;
 static int g_app_handlers_no;
 struct httpd_wsgi_call g_app_handlers[];
 
+static int web_send_asset(httpd_request_t *req, const char *path)
+{
+  const httpd_static_asset_t *asset;
+
+  asset = httpd_find_static_asset(web_assets, web_assets_num, path);
+  if (asset == NULL)
+    return kNotFoundErr;
+
+  return httpd_send_static_asset(req, asset);
+}
+
 static int web_send_wifisetting_page(httpd_request_t *req)
 {
   OSStatus err = kNoErr;
   
-  err = httpd_send_all_header(req, HTTP_RES_200, sizeof(wifisetting), HTTP_CONTENT_HTML_STR);
-  require_noerr_action( err, exit, app_httpd_log("ERROR: Unable to send http wifisetting headers.") );
-  
-  err = httpd_send_body(req->sock, wifisetting, sizeof(wifisetting));
-  require_noerr_action( err, exit, app_httpd_log("ERROR: Unable to send http wifisetting body.") );
+  err = web_send_asset(req, "/wifisetting.html");
+  require_noerr_action( err, exit, app_httpd_log("ERROR: Unable to send http wifisetting page.") );
   
 exit:
   return err; 
@@ -102,11 +110,8 @@ Save_Out:
   
   if(para_succ == true)
   {
-    err = httpd_send_all_header(req, HTTP_RES_200, sizeof(wifisuccess), HTTP_CONTENT_HTML_STR);
-    require_noerr_action( err, exit, app_httpd_log("ERROR: Unable to send http wifisuccess headers.") );
-    
-    err = httpd_send_body(req->sock, wifisuccess, sizeof(wifisuccess));
-    require_noerr_action( err, exit, app_httpd_log("ERROR: Unable to send http wifisuccess body.") );
+    err = web_send_asset(req, "/wifisuccess.html");
+    require_noerr_action( err, exit, app_httpd_log("ERROR: Unable to send http wifisuccess page.") );
     
     context->flashContentInRam.micoSystemConfig.configured = allConfigured;
     
@@ -116,11 +121,8 @@ Save_Out:
   }
   else
   {
-    err = httpd_send_all_header(req, HTTP_RES_200, sizeof(wififail), HTTP_CONTENT_HTML_STR);
-    require_noerr_action( err, exit, app_httpd_log("ERROR: Unable to send http wififail headers.") );
-    
-    err = httpd_send_body(req->sock, wififail, sizeof(wififail));
-    require_noerr_action( err, exit, app_httpd_log("ERROR: Unable to send http wififail body.") );    
+    err = web_send_asset(req, "/wififail.html");
+    require_noerr_action( err, exit, app_httpd_log("ERROR: Unable to send http wififail page.") );
   }
   
 exit:  
@@ -30,11 +30,10 @@
 ******************************************************************************
 */
 
-extern const unsigned char wififail[0xAC9];
+/* Generated by web_asset_gen.py from web_data, see web_data.c */
+extern const httpd_static_asset_t web_assets[];
 
-extern const unsigned char wifisetting[0xD5E];
-
-extern const unsigned char wifisuccess[0x9BC];
+extern const int web_assets_num;
 
 int app_httpd_start( void );
 
@@ -1,10 +1,9 @@
 /**
 ******************************************************************************
-* @file    web_data.c 
-* @author  QQ DING
+* @file    web_data.c
 * @version V1.0.0
-* @date    1-September-2015
-* @brief   This header file contains some data page
+* @brief   Static web assets, generated by web_asset_gen.py from web_data.
+*          Do not edit, regenerate instead.
 ******************************************************************************
 *
 *  The MIT License
@@ -29,557 +28,249 @@
 ******************************************************************************
 */
 
+#include <httpd.h>
 
-const unsigned char wififail[0xAC9] = {
-  0x3C, 0x21, 0x44, 0x4F, 0x43, 0x54, 0x59, 0x50, 0x45, 0x20, 0x68, 0x74, 0x6D, 0x6C, 0x20, 0x50,
-  0x55, 0x42, 0x4C, 0x49, 0x43, 0x20, 0x22, 0x2D, 0x2F, 0x2F, 0x57, 0x33, 0x43, 0x2F, 0x2F, 0x44,
-  0x54, 0x44, 0x20, 0x58, 0x48, 0x54, 0x4D, 0x4C, 0x20, 0x31, 0x2E, 0x30, 0x20, 0x54, 0x72, 0x61,
-  0x6E, 0x73, 0x69, 0x74, 0x69, 0x6F, 0x6E, 0x61, 0x6C, 0x2F, 0x2F, 0x45, 0x4E, 0x22, 0x20, 0x22,
-  0x68, 0x74, 0x74, 0x70, 0x3A, 0x2F, 0x2F, 0x77, 0x77, 0x77, 0x2E, 0x77, 0x33, 0x2E, 0x6F, 0x72,
-  0x67, 0x2F, 0x54, 0x52, 0x2F, 0x78, 0x68, 0x74, 0x6D, 0x6C, 0x31, 0x2F, 0x44, 0x54, 0x44, 0x2F,
-  0x78, 0x68, 0x74, 0x6D, 0x6C, 0x31, 0x2D, 0x74, 0x72, 0x61, 0x6E, 0x73, 0x69, 0x74, 0x69, 0x6F,
-  0x6E, 0x61, 0x6C, 0x2E, 0x64, 0x74, 0x64, 0x22, 0x3E, 0x0D, 0x0A, 0x3C, 0x68, 0x74, 0x6D, 0x6C,
-  0x20, 0x78, 0x6D, 0x6C, 0x6E, 0x73, 0x3D, 0x22, 0x68, 0x74, 0x74, 0x70, 0x3A, 0x2F, 0x2F, 0x77,
-  0x77, 0x77, 0x2E, 0x77, 0x33, 0x2E, 0x6F, 0x72, 0x67, 0x2F, 0x31, 0x39, 0x39, 0x39, 0x2F, 0x78,
-  0x68, 0x74, 0x6D, 0x6C, 0x22, 0x3E, 0x0D, 0x0A, 0x3C, 0x68, 0x65, 0x61, 0x64, 0x3E, 0x0D, 0x0A,
-  0x3C, 0x6D, 0x65, 0x74, 0x61, 0x20, 0x68, 0x74, 0x74, 0x70, 0x2D, 0x65, 0x71, 0x75, 0x69, 0x76,
-  0x3D, 0x22, 0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x74, 0x79, 0x70, 0x65, 0x22, 0x20,
-  0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x3D, 0x22, 0x74, 0x65, 0x78, 0x74, 0x2F, 0x68, 0x74,
-  0x6D, 0x6C, 0x22, 0x20, 0x63, 0x68, 0x61, 0x72, 0x73, 0x65, 0x74, 0x3D, 0x22, 0x75, 0x74, 0x66,
-  0x2D, 0x38, 0x22, 0x3E, 0x0D, 0x0A, 0x3C, 0x6D, 0x65, 0x74, 0x61, 0x20, 0x63, 0x6F, 0x6E, 0x74,
-  0x65, 0x6E, 0x74, 0x3D, 0x22, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3D, 0x64, 0x65, 0x76, 0x69, 0x63,
-  0x65, 0x2D, 0x77, 0x69, 0x64, 0x74, 0x68, 0x2C, 0x20, 0x69, 0x6E, 0x69, 0x74, 0x69, 0x61, 0x6C,
-  0x2D, 0x73, 0x63, 0x61, 0x6C, 0x65, 0x3D, 0x31, 0x2E, 0x30, 0x2C, 0x20, 0x6D, 0x61, 0x78, 0x69,
-  0x6D, 0x75, 0x6D, 0x2D, 0x73, 0x63, 0x61, 0x6C, 0x65, 0x3D, 0x31, 0x2E, 0x30, 0x2C, 0x20, 0x75,
-  0x73, 0x65, 0x72, 0x2D, 0x73, 0x63, 0x61, 0x6C, 0x61, 0x62, 0x6C, 0x65, 0x3D, 0x30, 0x22, 0x20,
-  0x6E, 0x61, 0x6D, 0x65, 0x3D, 0x22, 0x76, 0x69, 0x65, 0x77, 0x70, 0x6F, 0x72, 0x74, 0x22, 0x3E,
-  0x0D, 0x0A, 0x3C, 0x74, 0x69, 0x74, 0x6C, 0x65, 0x3E, 0xE7, 0xBD, 0x91, 0xE5, 0x85, 0xB3, 0xE4,
-  0xB8, 0x8A, 0xE7, 0xBD, 0x91, 0xE8, 0xAE, 0xBE, 0xE7, 0xBD, 0xAE, 0x3C, 0x2F, 0x74, 0x69, 0x74,
-  0x6C, 0x65, 0x3E, 0x0D, 0x0A, 0x3C, 0x73, 0x74, 0x79, 0x6C, 0x65, 0x3E, 0x0D, 0x0A, 0x20, 0x62,
-  0x6F, 0x64, 0x79, 0x2C, 0x20, 0x70, 0x2C, 0x20, 0x68, 0x31, 0x2C, 0x20, 0x68, 0x32, 0x2C, 0x20,
-  0x68, 0x33, 0x2C, 0x20, 0x68, 0x34, 0x2C, 0x20, 0x68, 0x35, 0x2C, 0x20, 0x68, 0x36, 0x2C, 0x20,
-  0x75, 0x6C, 0x2C, 0x20, 0x6F, 0x6C, 0x2C, 0x20, 0x6C, 0x69, 0x2C, 0x20, 0x64, 0x6C, 0x2C, 0x20,
-  0x64, 0x74, 0x2C, 0x20, 0x64, 0x64, 0x2C, 0x20, 0x74, 0x61, 0x62, 0x6C, 0x65, 0x2C, 0x20, 0x74,
-  0x68, 0x2C, 0x20, 0x74, 0x64, 0x2C, 0x20, 0x66, 0x6F, 0x72, 0x6D, 0x2C, 0x20, 0x66, 0x69, 0x65,
-  0x6C, 0x64, 0x73, 0x65, 0x74, 0x2C, 0x20, 0x6C, 0x65, 0x67, 0x65, 0x6E, 0x64, 0x2C, 0x20, 0x69,
-  0x6E, 0x70, 0x75, 0x74, 0x2C, 0x20, 0x74, 0x65, 0x78, 0x74, 0x61, 0x72, 0x65, 0x61, 0x2C, 0x20,
-  0x62, 0x75, 0x74, 0x74, 0x6F, 0x6E, 0x2C, 0x20, 0x73, 0x65, 0x6C, 0x65, 0x63, 0x74, 0x2C, 0x20,
-  0x69, 0x6D, 0x67, 0x2C, 0x20, 0x62, 0x6C, 0x6F, 0x63, 0x6B, 0x71, 0x75, 0x6F, 0x74, 0x65, 0x20,
-  0x7B, 0x0D, 0x0A, 0x09, 0x6D, 0x61, 0x72, 0x67, 0x69, 0x6E, 0x3A, 0x20, 0x30, 0x3B, 0x0D, 0x0A,
-  0x09, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x30, 0x3B, 0x0D, 0x0A, 0x09, 0x62,
-  0x6F, 0x72, 0x64, 0x65, 0x72, 0x3A, 0x20, 0x30, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74,
-  0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x20, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A, 0x09, 0x76,
-  0x65, 0x72, 0x74, 0x69, 0x63, 0x61, 0x6C, 0x2D, 0x61, 0x6C, 0x69, 0x67, 0x6E, 0x3A, 0x20, 0x62,
-  0x61, 0x73, 0x65, 0x6C, 0x69, 0x6E, 0x65, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74, 0x2D,
-  0x66, 0x61, 0x6D, 0x69, 0x6C, 0x79, 0x3A, 0x20, 0x22, 0x4D, 0x69, 0x63, 0x72, 0x6F, 0x73, 0x6F,
-  0x66, 0x74, 0x20, 0x59, 0x61, 0x48, 0x65, 0x69, 0x22, 0x2C, 0x22, 0x69, 0x63, 0x6F, 0x6E, 0x66,
-  0x6F, 0x6E, 0x74, 0x22, 0x2C, 0x22, 0x46, 0x6F, 0x6E, 0x74, 0x41, 0x77, 0x65, 0x73, 0x6F, 0x6D,
-  0x65, 0x22, 0x20, 0x20, 0x21, 0x69, 0x6D, 0x70, 0x6F, 0x72, 0x74, 0x61, 0x6E, 0x74, 0x3B, 0x0D,
-  0x0A, 0x7D, 0x0D, 0x0A, 0x68, 0x31, 0x2C, 0x20, 0x68, 0x32, 0x2C, 0x20, 0x68, 0x33, 0x2C, 0x20,
-  0x68, 0x34, 0x2C, 0x20, 0x68, 0x35, 0x2C, 0x20, 0x68, 0x36, 0x20, 0x7B, 0x0D, 0x0A, 0x09, 0x66,
-  0x6F, 0x6E, 0x74, 0x2D, 0x77, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x20, 0x6E, 0x6F, 0x72, 0x6D,
-  0x61, 0x6C, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x62, 0x6F, 0x64, 0x79, 0x7B, 0x0D, 0x0A, 0x09,
-  0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x3A, 0x20, 0x23, 0x66, 0x35, 0x66,
-  0x35, 0x66, 0x35, 0x0D, 0x0A, 0x09, 0x7D, 0x0D, 0x0A, 0x62, 0x6F, 0x64, 0x79, 0x2C, 0x20, 0x68,
-  0x74, 0x6D, 0x6C, 0x20, 0x7B, 0x0D, 0x0A, 0x09, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x20,
-  0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A, 0x09, 0x6D, 0x61, 0x78, 0x2D, 0x68, 0x65, 0x69, 0x67,
-  0x68, 0x74, 0x3A, 0x20, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x68, 0x74,
-  0x6D, 0x6C, 0x7B, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x36, 0x32, 0x2E,
-  0x35, 0x25, 0x3B, 0x7D, 0x0D, 0x0A, 0x0D, 0x0A, 0x2E, 0x6D, 0x61, 0x69, 0x6E, 0x7B, 0x0D, 0x0A,
-  0x09, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A, 0x09, 0x6D,
-  0x69, 0x6E, 0x2D, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D,
-  0x0A, 0x09, 0x70, 0x6F, 0x73, 0x69, 0x74, 0x69, 0x6F, 0x6E, 0x3A, 0x72, 0x65, 0x6C, 0x61, 0x74,
-  0x69, 0x76, 0x65, 0x3B, 0x0D, 0x0A, 0x09, 0x62, 0x6F, 0x78, 0x2D, 0x73, 0x69, 0x7A, 0x69, 0x6E,
-  0x67, 0x3A, 0x20, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x62, 0x6F, 0x78, 0x3B, 0x0D, 0x0A,
-  0x09, 0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69, 0x74, 0x2D, 0x62, 0x6F, 0x78, 0x2D, 0x73, 0x69, 0x7A,
-  0x69, 0x6E, 0x67, 0x3A, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x62, 0x6F, 0x78, 0x3B, 0x0D,
-  0x0A, 0x09, 0x64, 0x69, 0x73, 0x70, 0x6C, 0x61, 0x79, 0x3A, 0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69,
-  0x74, 0x2D, 0x62, 0x6F, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69, 0x74,
-  0x2D, 0x62, 0x6F, 0x78, 0x2D, 0x6F, 0x72, 0x69, 0x65, 0x6E, 0x74, 0x3A, 0x76, 0x65, 0x72, 0x74,
-  0x69, 0x63, 0x61, 0x6C, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x68, 0x65, 0x61, 0x64, 0x65,
-  0x72, 0x20, 0x7B, 0x0D, 0x0A, 0x09, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64,
-  0x3A, 0x20, 0x23, 0x66, 0x35, 0x36, 0x63, 0x36, 0x63, 0x3B, 0x0D, 0x0A, 0x09, 0x68, 0x65, 0x69,
-  0x67, 0x68, 0x74, 0x3A, 0x34, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65,
-  0x2D, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x34, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09,
-  0x6F, 0x76, 0x65, 0x72, 0x66, 0x6C, 0x6F, 0x77, 0x3A, 0x20, 0x68, 0x69, 0x64, 0x64, 0x65, 0x6E,
-  0x3B, 0x0D, 0x0A, 0x09, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x20, 0x31, 0x30, 0x30, 0x25, 0x3B,
-  0x0D, 0x0A, 0x09, 0x62, 0x6F, 0x78, 0x2D, 0x73, 0x69, 0x7A, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x62,
-  0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x62, 0x6F, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x70, 0x6F, 0x73,
-  0x69, 0x74, 0x69, 0x6F, 0x6E, 0x3A, 0x20, 0x72, 0x65, 0x6C, 0x61, 0x74, 0x69, 0x76, 0x65, 0x3B,
-  0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x20, 0x68, 0x33, 0x20,
-  0x7B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x20, 0x31,
-  0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x68, 0x65, 0x69, 0x67,
-  0x68, 0x74, 0x3A, 0x20, 0x34, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x74, 0x65, 0x78, 0x74,
-  0x2D, 0x61, 0x6C, 0x69, 0x67, 0x6E, 0x3A, 0x20, 0x63, 0x65, 0x6E, 0x74, 0x65, 0x72, 0x3B, 0x0D,
-  0x0A, 0x09, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x20, 0x23, 0x66, 0x66, 0x66, 0x3B, 0x0D, 0x0A,
-  0x7D, 0x0D, 0x0A, 0x2E, 0x62, 0x74, 0x6E, 0x2D, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6E, 0x20, 0x7B,
-  0x0D, 0x0A, 0x09, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x3A, 0x20, 0x63,
-  0x65, 0x6E, 0x74, 0x65, 0x72, 0x20, 0x6E, 0x6F, 0x2D, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x3B,
-  0x0D, 0x0A, 0x09, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x2D, 0x73, 0x69,
-  0x7A, 0x65, 0x3A, 0x20, 0x31, 0x32, 0x70, 0x78, 0x20, 0x32, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A,
-  0x09, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x20, 0x34, 0x34, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09,
-  0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x20, 0x34, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09,
-  0x64, 0x69, 0x73, 0x70, 0x6C, 0x61, 0x79, 0x3A, 0x20, 0x69, 0x6E, 0x6C, 0x69, 0x6E, 0x65, 0x2D,
-  0x62, 0x6C, 0x6F, 0x63, 0x6B, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x73, 0x69,
-  0x7A, 0x65, 0x3A, 0x20, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D,
-  0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x20, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6F,
-  0x76, 0x65, 0x72, 0x66, 0x6C, 0x6F, 0x77, 0x3A, 0x20, 0x68, 0x69, 0x64, 0x64, 0x65, 0x6E, 0x3B,
-  0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x20, 0x2E, 0x62, 0x74,
-  0x6E, 0x2D, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6E, 0x20, 0x7B, 0x0D, 0x0A, 0x09, 0x70, 0x6F, 0x73,
-  0x69, 0x74, 0x69, 0x6F, 0x6E, 0x3A, 0x20, 0x61, 0x62, 0x73, 0x6F, 0x6C, 0x75, 0x74, 0x65, 0x3B,
-  0x0D, 0x0A, 0x09, 0x6C, 0x65, 0x66, 0x74, 0x3A, 0x20, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09,
-  0x74, 0x6F, 0x70, 0x3A, 0x20, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x77,
-  0x69, 0x66, 0x69, 0x2D, 0x66, 0x61, 0x69, 0x6C, 0x20, 0x2E, 0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E,
-  0x74, 0x7B, 0x0D, 0x0A, 0x09, 0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69, 0x74, 0x2D, 0x62, 0x6F, 0x78,
-  0x2D, 0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20, 0x31, 0x3B, 0x20, 0x20, 0x20, 0x20, 0x0D, 0x0A, 0x09,
-  0x2D, 0x6D, 0x6F, 0x7A, 0x2D, 0x62, 0x6F, 0x78, 0x2D, 0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20, 0x31,
-  0x3B, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x0D, 0x0A, 0x09, 0x2D, 0x77, 0x65, 0x62,
-  0x6B, 0x69, 0x74, 0x2D, 0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20, 0x31, 0x3B, 0x20, 0x20, 0x20, 0x20,
-  0x20, 0x20, 0x20, 0x0D, 0x0A, 0x09, 0x2D, 0x6D, 0x73, 0x2D, 0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20,
-  0x31, 0x3B, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x0D, 0x0A,
-  0x09, 0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20, 0x31, 0x3B, 0x20, 0x0D, 0x0A, 0x09, 0x70, 0x61, 0x64,
-  0x64, 0x69, 0x6E, 0x67, 0x3A, 0x31, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x62, 0x61, 0x63,
-  0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x2D, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x23, 0x46,
-  0x46, 0x46, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x77, 0x69, 0x66, 0x69, 0x2D, 0x66, 0x61,
-  0x69, 0x6C, 0x20, 0x68, 0x32, 0x7B, 0x0D, 0x0A, 0x09, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x20,
-  0x23, 0x66, 0x35, 0x36, 0x63, 0x36, 0x63, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74, 0x2D,
-  0x73, 0x69, 0x7A, 0x65, 0x3A, 0x33, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x74, 0x65, 0x78,
-  0x74, 0x2D, 0x61, 0x6C, 0x69, 0x67, 0x6E, 0x3A, 0x63, 0x65, 0x6E, 0x74, 0x65, 0x72, 0x3B, 0x0D,
-  0x0A, 0x09, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6E, 0x67, 0x3A, 0x33, 0x30, 0x70, 0x78, 0x20, 0x30,
-  0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A,
-  0x33, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x77, 0x69, 0x66, 0x69, 0x2D,
-  0x66, 0x61, 0x69, 0x6C, 0x20, 0x7B, 0x0D, 0x0A, 0x09, 0x74, 0x65, 0x78, 0x74, 0x2D, 0x69, 0x6E,
-  0x64, 0x65, 0x6E, 0x74, 0x3A, 0x32, 0x72, 0x65, 0x6D, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E,
-  0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x31, 0x36, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6C,
-  0x69, 0x6E, 0x65, 0x2D, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x32, 0x38, 0x70, 0x78, 0x3B,
-  0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x62, 0x74, 0x6E, 0x7B, 0x0D, 0x0A, 0x09, 0x74, 0x65, 0x78,
-  0x74, 0x2D, 0x64, 0x65, 0x63, 0x6F, 0x72, 0x61, 0x74, 0x69, 0x6F, 0x6E, 0x3A, 0x20, 0x6E, 0x6F,
-  0x6E, 0x65, 0x3B, 0x0D, 0x0A, 0x09, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x34, 0x30, 0x70,
-  0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74,
-  0x3A, 0x34, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x73, 0x69,
-  0x7A, 0x65, 0x3A, 0x31, 0x34, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x64, 0x69, 0x73, 0x70, 0x6C,
-  0x61, 0x79, 0x3A, 0x62, 0x6C, 0x6F, 0x63, 0x6B, 0x3B, 0x0D, 0x0A, 0x09, 0x62, 0x6F, 0x72, 0x64,
-  0x65, 0x72, 0x3A, 0x20, 0x30, 0x20, 0x6E, 0x6F, 0x6E, 0x65, 0x3B, 0x0D, 0x0A, 0x09, 0x63, 0x6F,
-  0x6C, 0x6F, 0x72, 0x3A, 0x20, 0x23, 0x46, 0x46, 0x46, 0x3B, 0x0D, 0x0A, 0x09, 0x62, 0x6F, 0x72,
-  0x64, 0x65, 0x72, 0x2D, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3A, 0x20, 0x35, 0x70, 0x78, 0x3B,
-  0x0D, 0x0A, 0x09, 0x2D, 0x6D, 0x6F, 0x7A, 0x2D, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x72,
-  0x61, 0x64, 0x69, 0x75, 0x73, 0x3A, 0x20, 0x35, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x2D, 0x77,
-  0x65, 0x62, 0x6B, 0x69, 0x74, 0x2D, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x72, 0x61, 0x64,
-  0x69, 0x75, 0x73, 0x3A, 0x20, 0x35, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6F, 0x75, 0x74, 0x6C,
-  0x69, 0x6E, 0x65, 0x3A, 0x20, 0x6E, 0x6F, 0x6E, 0x65, 0x3B, 0x0D, 0x0A, 0x09, 0x63, 0x75, 0x72,
-  0x73, 0x6F, 0x72, 0x3A, 0x20, 0x70, 0x6F, 0x69, 0x6E, 0x74, 0x65, 0x72, 0x3B, 0x0D, 0x0A, 0x09,
-  0x74, 0x65, 0x78, 0x74, 0x2D, 0x61, 0x6C, 0x69, 0x67, 0x6E, 0x3A, 0x63, 0x65, 0x6E, 0x74, 0x65,
-  0x72, 0x3B, 0x0D, 0x0A, 0x09, 0x6D, 0x69, 0x6E, 0x2D, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x37,
-  0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6E, 0x67, 0x3A, 0x30,
-  0x20, 0x31, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x62, 0x74, 0x6E, 0x2D,
-  0x72, 0x65, 0x64, 0x7B, 0x0D, 0x0A, 0x09, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E,
-  0x64, 0x2D, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x23, 0x66, 0x35, 0x36, 0x63, 0x36, 0x63, 0x3B,
-  0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x67, 0x65, 0x74, 0x65, 0x77, 0x61, 0x79, 0x2D, 0x62, 0x74,
-  0x6E, 0x20, 0x62, 0x75, 0x74, 0x74, 0x6F, 0x6E, 0x20, 0x7B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20,
-  0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x20, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A, 0x09, 0x6D,
-  0x61, 0x72, 0x67, 0x69, 0x6E, 0x3A, 0x33, 0x35, 0x70, 0x78, 0x20, 0x30, 0x3B, 0x0D, 0x0A, 0x7D,
-  0x0D, 0x0A, 0x3C, 0x2F, 0x73, 0x74, 0x79, 0x6C, 0x65, 0x3E, 0x0D, 0x0A, 0x3C, 0x2F, 0x68, 0x65,
-  0x61, 0x64, 0x3E, 0x0D, 0x0A, 0x0D, 0x0A, 0x3C, 0x62, 0x6F, 0x64, 0x79, 0x3E, 0x0D, 0x0A, 0x3C,
-  0x64, 0x69, 0x76, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22, 0x6D, 0x61, 0x69, 0x6E, 0x20,
-  0x77, 0x69, 0x66, 0x69, 0x2D, 0x66, 0x61, 0x69, 0x6C, 0x22, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x3C,
-  0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22, 0x68, 0x65,
-  0x61, 0x64, 0x65, 0x72, 0x22, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
-  0x3C, 0x61, 0x20, 0x68, 0x72, 0x65, 0x66, 0x3D, 0x22, 0x23, 0x22, 0x20, 0x63, 0x6C, 0x61, 0x73,
-  0x73, 0x3D, 0x22, 0x62, 0x74, 0x6E, 0x2D, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6E, 0x22, 0x3E, 0xE4,
-  0xB8, 0x8A, 0xE4, 0xB8, 0x80, 0xE9, 0xA1, 0xB5, 0x3C, 0x2F, 0x61, 0x3E, 0x0D, 0x0A, 0x20, 0x20,
-  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x68, 0x33, 0x3E, 0xE7, 0xBD, 0x91, 0xE5, 0x85, 0xB3,
-  0xE4, 0xB8, 0x8A, 0xE7, 0xBD, 0x91, 0xE8, 0xAE, 0xBE, 0xE7, 0xBD, 0xAE, 0x3C, 0x2F, 0x68, 0x33,
-  0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x2F, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x3E,
-  0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73,
-  0x3D, 0x22, 0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x22, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20,
-  0x20, 0x20, 0x20, 0x20, 0x3C, 0x68, 0x32, 0x3E, 0xE8, 0xAE, 0xBE, 0xE7, 0xBD, 0xAE, 0xE5, 0xA4,
-  0xB1, 0xE8, 0xB4, 0xA5, 0xEF, 0xBC, 0x81, 0x3C, 0x2F, 0x68, 0x32, 0x3E, 0x0D, 0x0A, 0x20, 0x20,
-  0x20, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x73, 0x65, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x20, 0x63, 0x6C,
-  0x61, 0x73, 0x73, 0x3D, 0x22, 0x67, 0x65, 0x74, 0x65, 0x77, 0x61, 0x79, 0x2D, 0x62, 0x74, 0x6E,
-  0x22, 0x3E, 0x3C, 0x61, 0x20, 0x68, 0x72, 0x65, 0x66, 0x3D, 0x22, 0x2F, 0x73, 0x65, 0x74, 0x74,
-  0x69, 0x6E, 0x67, 0x2E, 0x68, 0x74, 0x6D, 0x22, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22,
-  0x62, 0x74, 0x6E, 0x20, 0x62, 0x74, 0x6E, 0x2D, 0x72, 0x65, 0x64, 0x20, 0x62, 0x74, 0x6E, 0x2D,
-  0x74, 0x72, 0x79, 0x22, 0x3E, 0xE5, 0x86, 0x8D, 0xE6, 0xAC, 0xA1, 0xE9, 0x87, 0x8D, 0xE8, 0xAF,
-  0x95, 0x3C, 0x2F, 0x61, 0x3E, 0x3C, 0x2F, 0x73, 0x65, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x3E, 0x0D,
-  0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x2F, 0x64, 0x69, 0x76, 0x3E, 0x0D, 0x0A, 0x3C, 0x2F, 0x64,
-  0x69, 0x76, 0x3E, 0x0D, 0x0A, 0x0D, 0x0A, 0x3C, 0x2F, 0x62, 0x6F, 0x64, 0x79, 0x3E, 0x0D, 0x0A,
-  0x3C, 0x2F, 0x68, 0x74, 0x6D, 0x6C, 0x3E, 0x0D, 0x0A
+/* /wififail.html: 2633 -> 1199 bytes */
+static const unsigned char web_asset_wififail_html[0x4AF] = {
+  0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xFF, 0x75, 0x56, 0x49, 0x6F, 0xDC, 0x36,
+  0x14, 0x3E, 0x5B, 0xBF, 0x82, 0x91, 0x91, 0xDB, 0x68, 0x34, 0x8B, 0xED, 0xDA, 0x9A, 0x05, 0x68,
+  0x9D, 0x18, 0x09, 0x90, 0xB4, 0x41, 0xE1, 0xA2, 0xCD, 0x91, 0x23, 0x52, 0x23, 0xC2, 0x94, 0xA8,
+  0x50, 0xD4, 0x2C, 0x19, 0x18, 0x68, 0x0F, 0x6D, 0x81, 0x02, 0x39, 0xF4, 0xD0, 0x1F, 0x10, 0xA0,
+  0xBD, 0x15, 0x29, 0x8A, 0xB6, 0x40, 0x0E, 0x4D, 0x7F, 0x4D, 0xDC, 0x38, 0xA7, 0xFE, 0x85, 0x3E,
+  0x52, 0x94, 0x46, 0xB3, 0x64, 0x0C, 0x9A, 0xE2, 0xDB, 0xDF, 0xF7, 0x1E, 0x97, 0xE1, 0x9D, 0x7B,
+  0x9F, 0x9D, 0x5F, 0x3E, 0x7D, 0x72, 0x1F, 0xC5, 0x2A, 0xE1, 0xE8, 0xC9, 0x17, 0x9F, 0x3C, 0x7A,
+  0x78, 0x8E, 0x5C, 0xCF, 0xF7, 0xBF, 0xEC, 0x9F, 0xFB, 0xFE, 0xBD, 0xCB, 0x7B, 0xE8, 0xAB, 0x07,
+  0x97, 0x8F, 0x1F, 0xA1, 0x6E, 0xBB, 0x83, 0x2E, 0x25, 0x4E, 0x73, 0xA6, 0x98, 0x48, 0x31, 0xF7,
+  0xFD, 0xFB, 0x9F, 0xBA, 0xC8, 0x8D, 0x95, 0xCA, 0x02, 0xDF, 0x9F, 0xCF, 0xE7, 0xED, 0x79, 0xBF,
+  0x2D, 0xE4, 0xD4, 0xBF, 0xFC, 0xDC, 0x5F, 0x68, 0x5B, 0x5D, 0xAD, 0x6C, 0x3F, 0x3D, 0xD5, 0xD0,
+  0x6C, 0x13, 0x45, 0xDC, 0xB1, 0x33, 0x34, 0x0E, 0x17, 0x09, 0x4F, 0xF3, 0xD1, 0x1E, 0x33, 0xDD,
+  0xB3, 0xB3, 0xB3, 0x52, 0xDB, 0xC8, 0x52, 0x4C, 0x60, 0x4A, 0xA8, 0xC2, 0x48, 0xCB, 0x7A, 0xF4,
+  0x59, 0xC1, 0x66, 0x23, 0x37, 0x14, 0xA9, 0xA2, 0xA9, 0xF2, 0xD4, 0x32, 0xA3, 0x2E, 0xB2, 0xAB,
+  0x91, 0xAB, 0xE8, 0x42, 0xF9, 0x46, 0x17, 0x85, 0x31, 0x96, 0x39, 0x05, 0x5A, 0xA1, 0x22, 0xEF,
+  0xD4, 0xAD, 0x8C, 0xD4, 0xA2, 0x73, 0x46, 0x54, 0x3C, 0x22, 0x74, 0xC6, 0x42, 0xEA, 0x99, 0x45,
+  0x0B, 0xB1, 0x14, 0x42, 0xC5, 0xDC, 0xCB, 0x43, 0xCC, 0xE9, 0x08, 0x32, 0x6F, 0xA1, 0x04, 0x2F,
+  0x58, 0x52, 0x24, 0x4D, 0x52, 0x91, 0x53, 0x69, 0xD6, 0x78, 0x02, 0xA4, 0x8E, 0x8B, 0x52, 0x9C,
+  0xD0, 0x91, 0x3B, 0x63, 0x74, 0x9E, 0x09, 0xA9, 0xB4, 0x2B, 0xC5, 0x14, 0xA7, 0xE3, 0x77, 0x6F,
+  0x7E, 0xBC, 0xF9, 0xF6, 0x8F, 0xB7, 0xAF, 0x7F, 0x80, 0x8F, 0xDB, 0x57, 0xFF, 0xBC, 0x7B, 0xF3,
+  0x6A, 0xE8, 0x97, 0x1C, 0x67, 0x98, 0xAB, 0xA5, 0x9E, 0xD1, 0x44, 0x90, 0x65, 0x0B, 0x65, 0x2D,
+  0x14, 0x77, 0x61, 0xF4, 0x60, 0xF4, 0x61, 0x1C, 0xC1, 0x38, 0x86, 0x71, 0x02, 0xDE, 0x78, 0x0B,
+  0x09, 0x18, 0x9C, 0xB5, 0x10, 0x81, 0x99, 0x28, 0x18, 0xA4, 0x85, 0x94, 0xF6, 0x0E, 0x13, 0x84,
+  0xAD, 0x60, 0x19, 0x09, 0x99, 0xC0, 0x7F, 0x46, 0x39, 0x81, 0xAC, 0x41, 0x9C, 0x4E, 0x69, 0x4A,
+  0x74, 0x4A, 0x59, 0x01, 0x4B, 0x0D, 0x0C, 0x96, 0x14, 0xB7, 0xD0, 0xA4, 0x50, 0x4A, 0xA4, 0x2D,
+  0x94, 0x53, 0x4E, 0x43, 0xE0, 0xB0, 0x64, 0x0A, 0x44, 0x2E, 0xC2, 0xAB, 0x67, 0x85, 0x50, 0x14,
+  0xAD, 0x9C, 0x83, 0x04, 0xCB, 0x29, 0x4B, 0x03, 0xD4, 0x19, 0x38, 0x07, 0x19, 0x26, 0x84, 0xA5,
+  0xD3, 0x72, 0x31, 0x11, 0x92, 0x50, 0x59, 0x7E, 0x47, 0x00, 0xA4, 0x97, 0xB3, 0xE7, 0x34, 0x40,
+  0xDD, 0x4E, 0xE7, 0x2E, 0x50, 0x66, 0x54, 0x2A, 0x06, 0xB0, 0x78, 0x98, 0xB3, 0x29, 0xA8, 0x4F,
+  0x30, 0xF8, 0x60, 0x29, 0xAD, 0x84, 0x23, 0x9C, 0x30, 0xBE, 0x0C, 0x90, 0xFB, 0x98, 0x85, 0x52,
+  0xE4, 0x22, 0x52, 0xE8, 0x29, 0x7E, 0x40, 0x99, 0xDB, 0x72, 0x19, 0x94, 0x45, 0xCB, 0xC0, 0xE7,
+  0x05, 0x4C, 0x1F, 0xCF, 0x69, 0x2E, 0x12, 0x28, 0x2C, 0xBA, 0xC3, 0x12, 0x8D, 0x29, 0x4E, 0xD5,
+  0xC0, 0xB9, 0x76, 0xF6, 0x63, 0xA4, 0x43, 0x36, 0x0E, 0xE6, 0x94, 0x4D, 0x63, 0x15, 0xA0, 0x14,
+  0xB0, 0xC0, 0x5C, 0x2B, 0x68, 0x74, 0x81, 0x3B, 0xC1, 0xE1, 0xD5, 0x54, 0x8A, 0x22, 0x25, 0x01,
+  0x3A, 0x8C, 0x8E, 0xF5, 0x9F, 0x73, 0x50, 0x72, 0x5B, 0x65, 0xFF, 0x83, 0x50, 0x6C, 0xB5, 0x6D,
+  0x36, 0x50, 0x78, 0x6F, 0x93, 0x04, 0xFE, 0x41, 0x74, 0xB5, 0x4E, 0xFC, 0xA4, 0xD7, 0x3E, 0xBE,
+  0x3B, 0xB8, 0x76, 0x9C, 0x76, 0x82, 0x59, 0x0A, 0x26, 0x4C, 0x1B, 0x05, 0x95, 0x01, 0x96, 0x56,
+  0x06, 0x2C, 0x25, 0x13, 0xE5, 0x56, 0x08, 0x24, 0xE5, 0x58, 0xB1, 0x19, 0x35, 0x90, 0x2E, 0xB4,
+  0x31, 0x03, 0x71, 0x09, 0xAF, 0x07, 0x24, 0x60, 0x40, 0x36, 0x93, 0x2B, 0xA6, 0xBC, 0x86, 0xC0,
+  0x06, 0x9F, 0xB0, 0x3C, 0xE3, 0x78, 0x19, 0x34, 0xE4, 0xB6, 0xB4, 0x84, 0x64, 0xD0, 0xE9, 0x41,
+  0x55, 0x16, 0x9D, 0x40, 0x5B, 0xEF, 0x27, 0x2A, 0xD1, 0x2E, 0x26, 0x27, 0xE1, 0x49, 0x38, 0xA8,
+  0x41, 0x38, 0x3A, 0xCD, 0xB4, 0x35, 0x5D, 0x3D, 0x6F, 0x93, 0x24, 0xC0, 0x5C, 0xC4, 0xC5, 0x3C,
+  0x40, 0x31, 0x23, 0x84, 0xA6, 0x83, 0x2A, 0xEB, 0x0A, 0xB7, 0x0F, 0x26, 0x54, 0x67, 0x8F, 0xD6,
+  0xE9, 0xAF, 0x23, 0x8A, 0xFB, 0x75, 0x19, 0x6D, 0x53, 0xED, 0x86, 0x80, 0x6C, 0x0C, 0xBA, 0x99,
+  0xAB, 0x26, 0x0B, 0x21, 0x45, 0x2A, 0x81, 0x18, 0x0A, 0x2E, 0xA4, 0x4E, 0x25, 0x8A, 0x8C, 0xDD,
+  0x89, 0x4A, 0x3D, 0x49, 0x55, 0x21, 0xD3, 0xED, 0x6C, 0x4B, 0x15, 0xE8, 0x12, 0xE0, 0x67, 0x14,
+  0xAB, 0x41, 0x93, 0x5D, 0x79, 0xEF, 0x65, 0x0B, 0xD4, 0xEB, 0x18, 0x77, 0x36, 0xBF, 0xA3, 0x23,
+  0xB3, 0xDA, 0x8A, 0xA5, 0x2A, 0x03, 0x6C, 0x34, 0x13, 0xAA, 0xD9, 0x49, 0x9B, 0xDB, 0xA3, 0xB3,
+  0x9B, 0x48, 0xE7, 0x03, 0x58, 0xAE, 0xF1, 0xD8, 0x8A, 0x7F, 0x0D, 0x1E, 0x9E, 0xE4, 0x82, 0x17,
+  0x4A, 0xF7, 0x0E, 0xA7, 0x51, 0x6D, 0x4B, 0x89, 0xCC, 0x7E, 0x82, 0x8D, 0x39, 0x8B, 0x18, 0x6C,
+  0x37, 0xC6, 0x51, 0xDB, 0x9E, 0x77, 0xAB, 0xCD, 0xD6, 0x88, 0x38, 0x5D, 0x40, 0x92, 0x03, 0x04,
+  0x3F, 0xE0, 0x24, 0xE2, 0xF9, 0x0E, 0xD9, 0xB2, 0xAC, 0xD2, 0x16, 0x47, 0xEB, 0xE4, 0x3B, 0xE2,
+  0x25, 0xA7, 0xA6, 0xAE, 0x0F, 0x8F, 0x6E, 0x19, 0x63, 0x03, 0xE5, 0xB2, 0x5A, 0x87, 0x17, 0x17,
+  0x17, 0x5B, 0x01, 0xC7, 0xBD, 0x55, 0xA3, 0x96, 0x55, 0x5B, 0xAE, 0xD1, 0xEC, 0x77, 0xB6, 0x5B,
+  0xA0, 0xEE, 0x80, 0xCA, 0x9B, 0x16, 0x31, 0x47, 0x54, 0x13, 0xF2, 0xFE, 0x2E, 0x36, 0x2B, 0x6B,
+  0x86, 0xA5, 0x44, 0xEF, 0x93, 0x9E, 0xA4, 0xC9, 0x86, 0xAB, 0xEE, 0xC9, 0x4E, 0xE1, 0x7A, 0xA7,
+  0xD6, 0x0A, 0x54, 0xA7, 0x52, 0x27, 0x34, 0x14, 0x12, 0x97, 0xC5, 0x49, 0x85, 0x39, 0xEE, 0xAA,
+  0x2D, 0xB3, 0x5B, 0x79, 0x4B, 0x6A, 0x38, 0x39, 0xDA, 0x68, 0xA3, 0xAA, 0x7D, 0xEA, 0x93, 0xB6,
+  0x32, 0x59, 0x41, 0x62, 0x10, 0xB3, 0x6C, 0x4F, 0x62, 0xC2, 0x8A, 0x3C, 0x40, 0xC7, 0xC6, 0x86,
+  0x2D, 0xE3, 0x3E, 0x4E, 0x5D, 0xFA, 0x3D, 0x4C, 0x51, 0x28, 0x1D, 0x61, 0x1D, 0x7C, 0x58, 0xC8,
+  0x5C, 0xBB, 0xCA, 0x04, 0xB3, 0xC0, 0xEE, 0x03, 0x5B, 0x9F, 0x6E, 0xE5, 0xC6, 0xF8, 0xA8, 0x4C,
+  0xA9, 0x42, 0xBF, 0x83, 0xBA, 0x9D, 0x35, 0x48, 0xD0, 0xC2, 0x64, 0xB5, 0xAF, 0xF2, 0x55, 0x69,
+  0x41, 0x6C, 0x4A, 0x15, 0x9D, 0xE3, 0xA5, 0x07, 0xE2, 0xF6, 0x76, 0x82, 0xD2, 0xE8, 0x5E, 0xDA,
+  0x3C, 0x58, 0xEC, 0xAD, 0xD4, 0x3F, 0x2E, 0xAB, 0x7B, 0xED, 0x0C, 0x7D, 0x7B, 0x89, 0x0E, 0xFD,
+  0xF2, 0x99, 0xE0, 0x0C, 0xF5, 0x89, 0x0E, 0x6B, 0xC2, 0x66, 0x28, 0xE4, 0x38, 0x87, 0x07, 0x86,
+  0x3E, 0x99, 0x51, 0x5D, 0x73, 0xB8, 0x9B, 0x11, 0x1A, 0xDA, 0x2D, 0x66, 0x25, 0xCA, 0x95, 0xE1,
+  0x94, 0xBF, 0x21, 0x3C, 0x35, 0x24, 0x8D, 0x46, 0xEE, 0xA1, 0x5B, 0xC9, 0xAC, 0x37, 0xA3, 0x3B,
+  0x86, 0xFB, 0xFC, 0xED, 0xEB, 0xAF, 0xDF, 0xBF, 0xFC, 0x6B, 0xE8, 0xE3, 0x86, 0x52, 0xDC, 0xDF,
+  0x7B, 0xDF, 0x03, 0xD9, 0xC8, 0x94, 0x31, 0x52, 0x69, 0x57, 0x8D, 0x08, 0xED, 0x0E, 0x5D, 0x07,
+  0x30, 0x8C, 0x7B, 0xE3, 0x52, 0xFD, 0xE6, 0xE7, 0xDF, 0x6F, 0xFF, 0xFC, 0xE5, 0xBF, 0xBF, 0xBF,
+  0x01, 0xED, 0xDE, 0x9A, 0x9F, 0xC3, 0xC5, 0x0D, 0xED, 0x56, 0x19, 0x68, 0xE0, 0xE7, 0x8E, 0xEB,
+  0xE0, 0x7D, 0x78, 0x06, 0x28, 0x28, 0x48, 0x1B, 0x2E, 0xAD, 0x66, 0x1E, 0xC8, 0x56, 0xC5, 0xCC,
+  0x4A, 0x2E, 0xDD, 0xF1, 0xCD, 0x77, 0x2F, 0xFE, 0xFD, 0xF5, 0xE5, 0xFB, 0xEF, 0x5F, 0xDC, 0xFE,
+  0xF6, 0x93, 0xCE, 0x09, 0x70, 0x2D, 0x1D, 0x54, 0x91, 0x43, 0xB0, 0x1A, 0x64, 0x33, 0xC1, 0x6C,
+  0x41, 0x36, 0xEF, 0xAC, 0xB1, 0xF3, 0x3F, 0x48, 0x31, 0x2F, 0xD2, 0x49, 0x0A, 0x00, 0x00
 };
 
+/* /wifisetting.html: 3272 -> 1354 bytes */
+static const unsigned char web_asset_wifisetting_html[0x54A] = {
+  0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xFF, 0x9D, 0x57, 0xCD, 0x8E, 0xDB, 0x36,
+  0x10, 0x3E, 0xDB, 0x4F, 0xC1, 0x28, 0x08, 0xD0, 0x02, 0x96, 0x2D, 0xEF, 0x7A, 0x37, 0x5B, 0x59,
+  0x36, 0x10, 0xA0, 0x58, 0x74, 0x0F, 0x05, 0x0A, 0xEC, 0xA1, 0xE8, 0x91, 0x16, 0x29, 0x9B, 0x58,
+  0x4A, 0x54, 0x28, 0xCA, 0x5E, 0x67, 0x11, 0xA0, 0x3D, 0xA4, 0x87, 0x16, 0x05, 0x5A, 0xF4, 0x05,
+  0xDA, 0x43, 0xD0, 0x53, 0xD3, 0x02, 0x45, 0x81, 0x5C, 0x92, 0xA7, 0xC9, 0x76, 0xD3, 0xB7, 0xE8,
+  0xF0, 0x47, 0x7F, 0x5E, 0x3B, 0x87, 0xC2, 0xD0, 0x52, 0x1C, 0x0E, 0x39, 0x33, 0xDF, 0x7C, 0x33,
+  0xE2, 0x46, 0x0F, 0x88, 0x88, 0xD5, 0x36, 0xA7, 0x68, 0xA5, 0x52, 0x3E, 0xEF, 0x47, 0xD5, 0x40,
+  0x31, 0x81, 0x21, 0xA5, 0x0A, 0xC3, 0x8A, 0xCA, 0x7D, 0xFA, 0xB4, 0x64, 0xEB, 0x99, 0x17, 0x8B,
+  0x4C, 0xD1, 0x4C, 0xF9, 0x7A, 0x8B, 0x87, 0xDC, 0x6C, 0xE6, 0x29, 0x7A, 0xAD, 0x46, 0x7A, 0x2B,
+  0xC8, 0x56, 0x58, 0x16, 0x14, 0x64, 0xA5, 0x4A, 0xFC, 0x33, 0xAF, 0x3A, 0xA4, 0x56, 0xDD, 0x30,
+  0xA2, 0x56, 0x33, 0x42, 0xD7, 0x2C, 0xA6, 0xBE, 0x99, 0x0C, 0x10, 0xCB, 0x98, 0x62, 0x98, 0xFB,
+  0x45, 0x8C, 0x39, 0x9D, 0x8D, 0x87, 0xC1, 0x00, 0xA5, 0xF8, 0x9A, 0xA5, 0x65, 0xDA, 0x16, 0x95,
+  0x05, 0x95, 0x66, 0x8E, 0x17, 0x20, 0x0A, 0x3C, 0x94, 0xE1, 0x94, 0xCE, 0xBC, 0x35, 0xA3, 0x9B,
+  0x5C, 0x48, 0xA5, 0x4D, 0x29, 0xA6, 0x38, 0x9D, 0xDF, 0xBD, 0xF9, 0xE9, 0xF6, 0xC5, 0x5F, 0xEF,
+  0x5E, 0x7F, 0x07, 0x2F, 0xEF, 0x5F, 0xBD, 0xBD, 0x7B, 0xF3, 0x2A, 0x1A, 0xD9, 0x95, 0x7E, 0x54,
+  0xA8, 0xAD, 0x1E, 0x11, 0x5A, 0x08, 0xB2, 0x1D, 0xA0, 0x7C, 0x80, 0x56, 0x63, 0x78, 0x8E, 0xE0,
+  0x39, 0x86, 0x67, 0x02, 0xCF, 0x09, 0x3C, 0xA7, 0x60, 0x8E, 0x0F, 0x90, 0x80, 0x87, 0xB3, 0x01,
+  0x22, 0x30, 0x12, 0x05, 0x0F, 0x19, 0x20, 0xA5, 0xCD, 0xC3, 0x00, 0x7E, 0x2B, 0x98, 0x26, 0x42,
+  0xA6, 0xF0, 0x97, 0x51, 0x4E, 0x20, 0x6C, 0x50, 0xA7, 0x4B, 0x9A, 0x11, 0x1D, 0x53, 0x5E, 0xC2,
+  0x54, 0x23, 0x83, 0x25, 0xC5, 0x03, 0xB4, 0x28, 0x95, 0x12, 0xD9, 0x00, 0x15, 0x94, 0xD3, 0x18,
+  0x56, 0x58, 0xBA, 0x04, 0x21, 0x17, 0xF1, 0xD5, 0xD3, 0x52, 0x28, 0x8A, 0x6E, 0xFA, 0xBD, 0x14,
+  0xCB, 0x25, 0xCB, 0x42, 0x14, 0x4C, 0xFB, 0xBD, 0x1C, 0x13, 0xC2, 0xB2, 0xA5, 0x9D, 0x2C, 0x84,
+  0x24, 0x54, 0xDA, 0xF7, 0x04, 0x90, 0xF4, 0x0B, 0xF6, 0x8C, 0x86, 0x68, 0x1C, 0x04, 0x8F, 0x40,
+  0xB2, 0xA6, 0x52, 0x31, 0xC0, 0xC5, 0xC7, 0x9C, 0x2D, 0x61, 0xFB, 0x02, 0x83, 0x0D, 0x96, 0xD1,
+  0x4A, 0x39, 0xC1, 0x29, 0xE3, 0xDB, 0x10, 0x79, 0x9F, 0xB3, 0x58, 0x8A, 0x42, 0x24, 0x0A, 0x7D,
+  0x85, 0x3F, 0xA3, 0xCC, 0x1B, 0x78, 0x0C, 0xF2, 0xA2, 0x75, 0xE0, 0xF5, 0x1C, 0x86, 0x27, 0x1B,
+  0x5A, 0x88, 0x14, 0x32, 0x8B, 0x1E, 0xB0, 0x54, 0x83, 0x8A, 0x33, 0x35, 0xED, 0x3F, 0xEF, 0xEF,
+  0xC7, 0x48, 0xBB, 0x6C, 0x0C, 0x6C, 0x28, 0x5B, 0xAE, 0x54, 0x88, 0x32, 0xC0, 0x02, 0x73, 0xBD,
+  0x41, 0xA3, 0x0B, 0xAB, 0x0B, 0x1C, 0x5F, 0x2D, 0xA5, 0x28, 0x33, 0x12, 0xA2, 0x87, 0xC9, 0x89,
+  0xFE, 0xF5, 0x7B, 0x76, 0x75, 0x60, 0x18, 0xA7, 0x8F, 0x58, 0xB9, 0xDD, 0x2E, 0x1A, 0xC8, 0xBC,
+  0xDF, 0x15, 0x81, 0x7D, 0x50, 0xBD, 0x69, 0x02, 0x3F, 0x3D, 0x1A, 0x9E, 0x3C, 0x9A, 0x3E, 0xEF,
+  0x0F, 0x53, 0xCC, 0x32, 0x38, 0xC1, 0xD0, 0x28, 0xAC, 0xF6, 0xB3, 0xAC, 0xDA, 0xEF, 0x24, 0xB9,
+  0x28, 0x80, 0x5F, 0x22, 0x0B, 0x25, 0xE5, 0x58, 0xB1, 0x35, 0x35, 0x88, 0x5E, 0xEB, 0xB3, 0x0C,
+  0xC2, 0x16, 0x5D, 0x1F, 0x44, 0xB0, 0x00, 0xC1, 0x2C, 0xAE, 0x98, 0xF2, 0x5B, 0x0A, 0x9D, 0x75,
+  0xC2, 0x8A, 0x9C, 0xE3, 0x6D, 0xD8, 0xD2, 0xDB, 0xD9, 0x25, 0x24, 0x03, 0xA6, 0x87, 0x55, 0x56,
+  0xB4, 0xFF, 0x43, 0x5D, 0x4F, 0x54, 0xA2, 0xFB, 0x90, 0x9C, 0xC6, 0xA7, 0xF1, 0xB4, 0xC6, 0x60,
+  0x72, 0x96, 0xEB, 0xD3, 0x74, 0xF2, 0xFC, 0xAE, 0x48, 0xC0, 0x71, 0x09, 0x17, 0x9B, 0x10, 0xAD,
+  0x18, 0x21, 0x34, 0x9B, 0x56, 0x51, 0x57, 0xB0, 0x1D, 0x0C, 0xA8, 0x8E, 0x1E, 0x35, 0xE1, 0x37,
+  0x1E, 0xAD, 0x8E, 0xEB, 0x2C, 0x3A, 0x4E, 0xDD, 0x77, 0x01, 0x39, 0x1F, 0x34, 0x97, 0x2B, 0x8E,
+  0xC5, 0x10, 0x22, 0x95, 0x20, 0x8C, 0x05, 0x17, 0x52, 0x87, 0x92, 0x24, 0xE6, 0xDC, 0x85, 0xCA,
+  0x7C, 0x49, 0x55, 0x29, 0xB3, 0xDD, 0x68, 0x4B, 0xC9, 0x3F, 0x1A, 0x0E, 0x47, 0x2C, 0xC5, 0x4B,
+  0x5A, 0x8C, 0x34, 0xF3, 0x82, 0xC9, 0x30, 0xCF, 0x96, 0x1F, 0xBB, 0xC3, 0x80, 0x3E, 0xB0, 0x33,
+  0xA7, 0x58, 0x4D, 0xDB, 0x1B, 0x2B, 0xBF, 0x8E, 0xF2, 0x6B, 0x74, 0x14, 0x18, 0x47, 0x5C, 0xE4,
+  0x93, 0x89, 0x99, 0xED, 0x78, 0x59, 0x25, 0x08, 0x2A, 0xD0, 0x04, 0x61, 0x4A, 0xAC, 0x5B, 0x37,
+  0xC1, 0xFD, 0x10, 0x83, 0x03, 0x28, 0x37, 0x48, 0xED, 0x44, 0xD6, 0xC0, 0x8A, 0x17, 0x85, 0xE0,
+  0xA5, 0xD2, 0xAC, 0xE2, 0x34, 0xA9, 0xCF, 0x52, 0x22, 0x77, 0xAF, 0x70, 0xC6, 0x86, 0x25, 0xCC,
+  0x87, 0xFE, 0x80, 0x86, 0xAE, 0x11, 0x36, 0xD5, 0x3E, 0xB6, 0xEA, 0x6D, 0x06, 0x25, 0x9C, 0x5E,
+  0x43, 0xC4, 0x53, 0x68, 0x53, 0x08, 0xF9, 0xA9, 0x78, 0xB6, 0x47, 0xEA, 0xD4, 0x77, 0x54, 0x8B,
+  0xAE, 0xA0, 0x9E, 0x80, 0x0B, 0x4B, 0xAA, 0xE8, 0x06, 0x6F, 0x7D, 0x06, 0x05, 0xAF, 0xCF, 0x43,
+  0x43, 0xD3, 0xA2, 0x7C, 0xD3, 0xBA, 0x6E, 0xBA, 0x70, 0x38, 0x9C, 0x77, 0x1A, 0x4B, 0x0A, 0x98,
+  0x70, 0xDA, 0x6A, 0x47, 0x63, 0x48, 0x09, 0xC4, 0xCE, 0x08, 0x7A, 0x48, 0x1E, 0xEB, 0x9F, 0xB5,
+  0x5A, 0x61, 0x7A, 0x62, 0x12, 0xA2, 0x25, 0x5D, 0xD2, 0x6B, 0xA6, 0x18, 0xE9, 0x01, 0xCA, 0xEA,
+  0xB5, 0x7D, 0xAC, 0xD5, 0x72, 0x0B, 0x1A, 0xE8, 0x41, 0x33, 0x4D, 0x43, 0xE4, 0x8F, 0x2B, 0x13,
+  0x75, 0xBF, 0x1C, 0x7F, 0x02, 0x5E, 0x8D, 0x4F, 0xF4, 0x1F, 0xF3, 0x76, 0xE6, 0x52, 0xD0, 0x8A,
+  0xD6, 0x36, 0x67, 0xC8, 0x62, 0xDB, 0x5B, 0x1B, 0xB3, 0x96, 0x74, 0x88, 0xD1, 0x88, 0xDB, 0x45,
+  0x32, 0xA9, 0x84, 0x9D, 0x22, 0xB4, 0x41, 0xB9, 0x56, 0x0D, 0x74, 0xCE, 0xE8, 0xFD, 0xF0, 0x95,
+  0xC4, 0x59, 0x91, 0xC3, 0x27, 0x41, 0x77, 0xD6, 0x9E, 0x28, 0x95, 0xB6, 0x16, 0xA2, 0x94, 0x12,
+  0x56, 0xA6, 0xBB, 0x8E, 0x86, 0x09, 0x93, 0x85, 0xF2, 0x45, 0x62, 0x3E, 0xB8, 0xCE, 0x61, 0x07,
+  0x15, 0xF0, 0xCB, 0xD7, 0x7C, 0xF3, 0x25, 0x86, 0xAD, 0x05, 0xC0, 0x5D, 0xA3, 0xDD, 0x28, 0x48,
+  0x1D, 0x44, 0x57, 0x63, 0xC7, 0x02, 0xC7, 0x87, 0x0C, 0x58, 0x8C, 0x3F, 0x6C, 0xC3, 0xE9, 0xEC,
+  0x37, 0x03, 0x05, 0xD3, 0xB4, 0xF7, 0xC9, 0xFD, 0xA2, 0x73, 0xA2, 0x06, 0x57, 0x0B, 0x6B, 0x5D,
+  0xC1, 0x55, 0xE5, 0xEE, 0x42, 0x5A, 0xF7, 0x9C, 0xF3, 0xF3, 0xF3, 0x7A, 0xB9, 0x6B, 0xBD, 0xE7,
+  0xAA, 0x66, 0xDF, 0x4A, 0x5D, 0x68, 0x7B, 0x16, 0xEB, 0x7C, 0x54, 0x96, 0x4A, 0x59, 0x68, 0x53,
+  0xB9, 0x60, 0xAE, 0xDF, 0xB5, 0x9A, 0x60, 0xDD, 0x03, 0xF5, 0x27, 0xC7, 0x12, 0xE1, 0xB1, 0x0D,
+  0xA9, 0x22, 0x63, 0x80, 0xC6, 0x41, 0x03, 0x06, 0x74, 0x0F, 0xD2, 0xE9, 0x89, 0xBE, 0x0D, 0xA4,
+  0xFE, 0x0C, 0xB4, 0xAA, 0x14, 0xD4, 0xDD, 0x8D, 0xC1, 0x25, 0xA5, 0xDB, 0xED, 0x5D, 0xEF, 0x38,
+  0xD6, 0x34, 0x0F, 0xF4, 0xC6, 0x68, 0xE4, 0x6E, 0x36, 0xF0, 0x66, 0x2F, 0x6F, 0xFD, 0x48, 0x7F,
+  0x66, 0xE1, 0xCA, 0x43, 0xD8, 0x1A, 0xC5, 0x90, 0xE6, 0x62, 0xE6, 0xE9, 0xEF, 0x25, 0xAA, 0x7A,
+  0x91, 0x37, 0x37, 0x07, 0x47, 0xAE, 0xBF, 0x55, 0x3A, 0x76, 0xEA, 0x16, 0x8D, 0x02, 0x5C, 0x01,
+  0x25, 0x4D, 0x66, 0xDE, 0x43, 0xAF, 0xD2, 0x69, 0x5A, 0xA1, 0x37, 0x87, 0x7B, 0xD6, 0xBB, 0xD7,
+  0x5F, 0xFF, 0xFB, 0xEB, 0xDF, 0xD1, 0x08, 0xB7, 0x36, 0xAD, 0x8E, 0xF7, 0xDE, 0xC3, 0x40, 0x6C,
+  0xAD, 0x8E, 0xAC, 0x1D, 0x37, 0x6B, 0xF9, 0xE8, 0x1A, 0x24, 0x38, 0xD0, 0x8B, 0xF4, 0xE5, 0x0A,
+  0xE1, 0x58, 0x37, 0x82, 0x99, 0x27, 0x69, 0x51, 0x72, 0x35, 0x84, 0xBB, 0x80, 0x07, 0xE5, 0xA2,
+  0x56, 0x82, 0xCC, 0x3C, 0x68, 0x13, 0xAA, 0x71, 0x35, 0x2A, 0xA8, 0xD1, 0xAD, 0x8E, 0xDA, 0x6D,
+  0x79, 0xAD, 0xA0, 0xBA, 0x36, 0x5B, 0x05, 0xD1, 0xD1, 0xD1, 0x6A, 0xB6, 0x57, 0x30, 0x30, 0x56,
+  0x14, 0x8C, 0x78, 0x48, 0x17, 0x8A, 0xBD, 0xF1, 0x56, 0x37, 0xD0, 0xCB, 0xCB, 0x8B, 0x4F, 0x3D,
+  0xB4, 0xC6, 0xBC, 0x84, 0x89, 0x87, 0x80, 0xBB, 0x31, 0x5D, 0x09, 0x0E, 0xD1, 0xCD, 0xBC, 0x2F,
+  0x2F, 0xCE, 0x2F, 0x6E, 0x7F, 0xFC, 0xE1, 0xEE, 0xB7, 0x3F, 0xBB, 0xC6, 0x47, 0x60, 0xFD, 0xFF,
+  0x7B, 0x63, 0x7D, 0xC8, 0x41, 0x7B, 0x03, 0x2C, 0xAE, 0xFC, 0xF8, 0xE2, 0xC9, 0xE5, 0xE5, 0x21,
+  0x3F, 0xDE, 0xBF, 0xFD, 0xF9, 0xF6, 0xC5, 0xCB, 0xDB, 0x3F, 0xBE, 0xBD, 0xFB, 0xE5, 0x9B, 0x0F,
+  0x79, 0x02, 0x3C, 0xB2, 0x18, 0xB6, 0x44, 0x07, 0x50, 0x05, 0x12, 0x78, 0xF3, 0xC8, 0x91, 0xD4,
+  0x7A, 0x54, 0x94, 0x8B, 0x94, 0xD5, 0xB8, 0x64, 0x06, 0xA3, 0x86, 0x32, 0xC8, 0xD5, 0x80, 0x19,
+  0xCD, 0x22, 0x90, 0xE7, 0x7B, 0x20, 0xCF, 0x3F, 0xBF, 0xBF, 0x8C, 0x46, 0xF6, 0xA0, 0x79, 0xCB,
+  0x81, 0x5E, 0x34, 0xD2, 0x04, 0xA8, 0x08, 0x63, 0xFC, 0xAC, 0x07, 0x47, 0xEE, 0x91, 0xFD, 0x87,
+  0xE5, 0x3F, 0x93, 0xFA, 0x19, 0x04, 0xC8, 0x0C, 0x00, 0x00
+};
 
-const unsigned char wifisetting[0xD5E] = {
-  0x3C, 0x21, 0x64, 0x6F, 0x63, 0x74, 0x79, 0x70, 0x65, 0x20, 0x68, 0x74, 0x6D, 0x6C, 0x3E, 0x0D,
-  0x0A, 0x3C, 0x68, 0x74, 0x6D, 0x6C, 0x3E, 0x0D, 0x0A, 0x3C, 0x68, 0x65, 0x61, 0x64, 0x3E, 0x0D,
-  0x0A, 0x3C, 0x6D, 0x65, 0x74, 0x61, 0x20, 0x68, 0x74, 0x74, 0x70, 0x2D, 0x65, 0x71, 0x75, 0x69,
-  0x76, 0x3D, 0x22, 0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x74, 0x79, 0x70, 0x65, 0x22,
-  0x20, 0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x3D, 0x22, 0x74, 0x65, 0x78, 0x74, 0x2F, 0x68,
-  0x74, 0x6D, 0x6C, 0x22, 0x20, 0x63, 0x68, 0x61, 0x72, 0x73, 0x65, 0x74, 0x3D, 0x22, 0x75, 0x74,
-  0x66, 0x2D, 0x38, 0x22, 0x3E, 0x0D, 0x0A, 0x3C, 0x6D, 0x65, 0x74, 0x61, 0x20, 0x63, 0x6F, 0x6E,
-  0x74, 0x65, 0x6E, 0x74, 0x3D, 0x22, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3D, 0x64, 0x65, 0x76, 0x69,
-  0x63, 0x65, 0x2D, 0x77, 0x69, 0x64, 0x74, 0x68, 0x2C, 0x20, 0x69, 0x6E, 0x69, 0x74, 0x69, 0x61,
-  0x6C, 0x2D, 0x73, 0x63, 0x61, 0x6C, 0x65, 0x3D, 0x31, 0x2E, 0x30, 0x2C, 0x20, 0x6D, 0x61, 0x78,
-  0x69, 0x6D, 0x75, 0x6D, 0x2D, 0x73, 0x63, 0x61, 0x6C, 0x65, 0x3D, 0x31, 0x2E, 0x30, 0x2C, 0x20,
-  0x75, 0x73, 0x65, 0x72, 0x2D, 0x73, 0x63, 0x61, 0x6C, 0x61, 0x62, 0x6C, 0x65, 0x3D, 0x30, 0x22,
-  0x20, 0x6E, 0x61, 0x6D, 0x65, 0x3D, 0x22, 0x76, 0x69, 0x65, 0x77, 0x70, 0x6F, 0x72, 0x74, 0x22,
-  0x3E, 0x0D, 0x0A, 0x3C, 0x74, 0x69, 0x74, 0x6C, 0x65, 0x3E, 0xE7, 0xBD, 0x91, 0xE5, 0x85, 0xB3,
-  0xE4, 0xB8, 0x8A, 0xE7, 0xBD, 0x91, 0xE8, 0xAE, 0xBE, 0xE7, 0xBD, 0xAE, 0x3C, 0x2F, 0x74, 0x69,
-  0x74, 0x6C, 0x65, 0x3E, 0x0D, 0x0A, 0x3C, 0x73, 0x74, 0x79, 0x6C, 0x65, 0x3E, 0x0D, 0x0A, 0x20,
-  0x20, 0x62, 0x6F, 0x64, 0x79, 0x2C, 0x20, 0x70, 0x2C, 0x20, 0x68, 0x31, 0x2C, 0x20, 0x68, 0x32,
-  0x2C, 0x20, 0x68, 0x33, 0x2C, 0x20, 0x68, 0x34, 0x2C, 0x20, 0x68, 0x35, 0x2C, 0x20, 0x68, 0x36,
-  0x2C, 0x20, 0x75, 0x6C, 0x2C, 0x20, 0x6F, 0x6C, 0x2C, 0x20, 0x6C, 0x69, 0x2C, 0x20, 0x64, 0x6C,
-  0x2C, 0x20, 0x64, 0x74, 0x2C, 0x20, 0x64, 0x64, 0x2C, 0x20, 0x74, 0x61, 0x62, 0x6C, 0x65, 0x2C,
-  0x20, 0x74, 0x68, 0x2C, 0x20, 0x74, 0x64, 0x2C, 0x20, 0x66, 0x6F, 0x72, 0x6D, 0x2C, 0x20, 0x66,
-  0x69, 0x65, 0x6C, 0x64, 0x73, 0x65, 0x74, 0x2C, 0x20, 0x6C, 0x65, 0x67, 0x65, 0x6E, 0x64, 0x2C,
-  0x20, 0x69, 0x6E, 0x70, 0x75, 0x74, 0x2C, 0x20, 0x74, 0x65, 0x78, 0x74, 0x61, 0x72, 0x65, 0x61,
-  0x2C, 0x20, 0x62, 0x75, 0x74, 0x74, 0x6F, 0x6E, 0x2C, 0x20, 0x73, 0x65, 0x6C, 0x65, 0x63, 0x74,
-  0x2C, 0x20, 0x69, 0x6D, 0x67, 0x2C, 0x20, 0x62, 0x6C, 0x6F, 0x63, 0x6B, 0x71, 0x75, 0x6F, 0x74,
-  0x65, 0x20, 0x7B, 0x0D, 0x0A, 0x09, 0x6D, 0x61, 0x72, 0x67, 0x69, 0x6E, 0x3A, 0x20, 0x30, 0x3B,
-  0x0D, 0x0A, 0x09, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x30, 0x3B, 0x0D, 0x0A,
-  0x09, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x3A, 0x20, 0x30, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F,
-  0x6E, 0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x20, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A,
-  0x09, 0x76, 0x65, 0x72, 0x74, 0x69, 0x63, 0x61, 0x6C, 0x2D, 0x61, 0x6C, 0x69, 0x67, 0x6E, 0x3A,
-  0x20, 0x62, 0x61, 0x73, 0x65, 0x6C, 0x69, 0x6E, 0x65, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E,
-  0x74, 0x2D, 0x66, 0x61, 0x6D, 0x69, 0x6C, 0x79, 0x3A, 0x20, 0x22, 0x4D, 0x69, 0x63, 0x72, 0x6F,
-  0x73, 0x6F, 0x66, 0x74, 0x20, 0x59, 0x61, 0x48, 0x65, 0x69, 0x22, 0x2C, 0x22, 0x69, 0x63, 0x6F,
-  0x6E, 0x66, 0x6F, 0x6E, 0x74, 0x22, 0x2C, 0x22, 0x46, 0x6F, 0x6E, 0x74, 0x41, 0x77, 0x65, 0x73,
-  0x6F, 0x6D, 0x65, 0x22, 0x20, 0x20, 0x21, 0x69, 0x6D, 0x70, 0x6F, 0x72, 0x74, 0x61, 0x6E, 0x74,
-  0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x68, 0x31, 0x2C, 0x20, 0x68, 0x32, 0x2C, 0x20, 0x68, 0x33,
-  0x2C, 0x20, 0x68, 0x34, 0x2C, 0x20, 0x68, 0x35, 0x2C, 0x20, 0x68, 0x36, 0x20, 0x7B, 0x0D, 0x0A,
-  0x09, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x77, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x20, 0x6E, 0x6F,
-  0x72, 0x6D, 0x61, 0x6C, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x62, 0x6F, 0x64, 0x79, 0x7B, 0x0D,
-  0x0A, 0x09, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x3A, 0x20, 0x23, 0x66,
-  0x35, 0x66, 0x35, 0x66, 0x35, 0x0D, 0x0A, 0x09, 0x7D, 0x0D, 0x0A, 0x62, 0x6F, 0x64, 0x79, 0x2C,
-  0x20, 0x68, 0x74, 0x6D, 0x6C, 0x20, 0x7B, 0x0D, 0x0A, 0x09, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74,
-  0x3A, 0x20, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A, 0x09, 0x6D, 0x61, 0x78, 0x2D, 0x68, 0x65,
-  0x69, 0x67, 0x68, 0x74, 0x3A, 0x20, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A,
-  0x68, 0x74, 0x6D, 0x6C, 0x7B, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x36,
-  0x32, 0x2E, 0x35, 0x25, 0x3B, 0x7D, 0x0D, 0x0A, 0x2E, 0x6D, 0x61, 0x69, 0x6E, 0x7B, 0x0D, 0x0A,
-  0x09, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A, 0x09, 0x6D,
-  0x69, 0x6E, 0x2D, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D,
-  0x0A, 0x09, 0x70, 0x6F, 0x73, 0x69, 0x74, 0x69, 0x6F, 0x6E, 0x3A, 0x72, 0x65, 0x6C, 0x61, 0x74,
-  0x69, 0x76, 0x65, 0x3B, 0x0D, 0x0A, 0x09, 0x62, 0x6F, 0x78, 0x2D, 0x73, 0x69, 0x7A, 0x69, 0x6E,
-  0x67, 0x3A, 0x20, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x62, 0x6F, 0x78, 0x3B, 0x0D, 0x0A,
-  0x09, 0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69, 0x74, 0x2D, 0x62, 0x6F, 0x78, 0x2D, 0x73, 0x69, 0x7A,
-  0x69, 0x6E, 0x67, 0x3A, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x62, 0x6F, 0x78, 0x3B, 0x0D,
-  0x0A, 0x09, 0x64, 0x69, 0x73, 0x70, 0x6C, 0x61, 0x79, 0x3A, 0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69,
-  0x74, 0x2D, 0x62, 0x6F, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69, 0x74,
-  0x2D, 0x62, 0x6F, 0x78, 0x2D, 0x6F, 0x72, 0x69, 0x65, 0x6E, 0x74, 0x3A, 0x76, 0x65, 0x72, 0x74,
-  0x69, 0x63, 0x61, 0x6C, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x68, 0x65, 0x61, 0x64, 0x65,
-  0x72, 0x20, 0x7B, 0x0D, 0x0A, 0x09, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64,
-  0x3A, 0x20, 0x23, 0x66, 0x35, 0x36, 0x63, 0x36, 0x63, 0x3B, 0x0D, 0x0A, 0x09, 0x68, 0x65, 0x69,
-  0x67, 0x68, 0x74, 0x3A, 0x34, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65,
-  0x2D, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x34, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09,
-  0x6F, 0x76, 0x65, 0x72, 0x66, 0x6C, 0x6F, 0x77, 0x3A, 0x20, 0x68, 0x69, 0x64, 0x64, 0x65, 0x6E,
-  0x3B, 0x0D, 0x0A, 0x09, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x20, 0x31, 0x30, 0x30, 0x25, 0x3B,
-  0x0D, 0x0A, 0x09, 0x62, 0x6F, 0x78, 0x2D, 0x73, 0x69, 0x7A, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x62,
-  0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x62, 0x6F, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x70, 0x6F, 0x73,
-  0x69, 0x74, 0x69, 0x6F, 0x6E, 0x3A, 0x20, 0x72, 0x65, 0x6C, 0x61, 0x74, 0x69, 0x76, 0x65, 0x3B,
-  0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x20, 0x68, 0x33, 0x20,
-  0x7B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x20, 0x31,
-  0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x68, 0x65, 0x69, 0x67,
-  0x68, 0x74, 0x3A, 0x20, 0x34, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x74, 0x65, 0x78, 0x74,
-  0x2D, 0x61, 0x6C, 0x69, 0x67, 0x6E, 0x3A, 0x20, 0x63, 0x65, 0x6E, 0x74, 0x65, 0x72, 0x3B, 0x0D,
-  0x0A, 0x09, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x20, 0x23, 0x66, 0x66, 0x66, 0x3B, 0x0D, 0x0A,
-  0x7D, 0x0D, 0x0A, 0x2E, 0x62, 0x74, 0x6E, 0x2D, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6E, 0x20, 0x7B,
-  0x0D, 0x0A, 0x09, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x3A, 0x20, 0x75,
-  0x72, 0x6C, 0x28, 0x2E, 0x2E, 0x2F, 0x69, 0x6D, 0x61, 0x67, 0x65, 0x73, 0x2F, 0x69, 0x63, 0x6F,
-  0x6E, 0x30, 0x34, 0x2E, 0x70, 0x6E, 0x67, 0x29, 0x20, 0x63, 0x65, 0x6E, 0x74, 0x65, 0x72, 0x20,
-  0x6E, 0x6F, 0x2D, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x3B, 0x0D, 0x0A, 0x09, 0x62, 0x61, 0x63,
-  0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x20, 0x31, 0x32,
-  0x70, 0x78, 0x20, 0x32, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x77, 0x69, 0x64, 0x74, 0x68,
-  0x3A, 0x20, 0x34, 0x34, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74,
-  0x3A, 0x20, 0x34, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x64, 0x69, 0x73, 0x70, 0x6C, 0x61,
-  0x79, 0x3A, 0x20, 0x69, 0x6E, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x62, 0x6C, 0x6F, 0x63, 0x6B, 0x3B,
-  0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x20, 0x30, 0x70,
-  0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74,
-  0x3A, 0x20, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6F, 0x76, 0x65, 0x72, 0x66, 0x6C, 0x6F,
-  0x77, 0x3A, 0x20, 0x68, 0x69, 0x64, 0x64, 0x65, 0x6E, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E,
-  0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x20, 0x2E, 0x62, 0x74, 0x6E, 0x2D, 0x72, 0x65, 0x74, 0x75,
-  0x72, 0x6E, 0x20, 0x7B, 0x0D, 0x0A, 0x09, 0x70, 0x6F, 0x73, 0x69, 0x74, 0x69, 0x6F, 0x6E, 0x3A,
-  0x20, 0x61, 0x62, 0x73, 0x6F, 0x6C, 0x75, 0x74, 0x65, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x65, 0x66,
-  0x74, 0x3A, 0x20, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x74, 0x6F, 0x70, 0x3A, 0x20, 0x30,
-  0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x77, 0x69, 0x66, 0x69, 0x2D, 0x73, 0x65,
-  0x74, 0x20, 0x2E, 0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x7B, 0x0D, 0x0A, 0x09, 0x6D, 0x61,
-  0x72, 0x67, 0x69, 0x6E, 0x3A, 0x31, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x2D, 0x77, 0x65,
-  0x62, 0x6B, 0x69, 0x74, 0x2D, 0x62, 0x6F, 0x78, 0x2D, 0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20, 0x31,
-  0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x2D, 0x6D, 0x6F, 0x7A, 0x2D, 0x62, 0x6F, 0x78, 0x2D,
-  0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20, 0x31, 0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x2D, 0x77,
-  0x65, 0x62, 0x6B, 0x69, 0x74, 0x2D, 0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20, 0x31, 0x3B, 0x0D, 0x0A,
-  0x20, 0x20, 0x20, 0x20, 0x2D, 0x6D, 0x73, 0x2D, 0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20, 0x31, 0x3B,
-  0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20, 0x31, 0x3B, 0x0D, 0x0A,
-  0x7D, 0x0D, 0x0A, 0x2E, 0x67, 0x65, 0x74, 0x65, 0x77, 0x61, 0x79, 0x2D, 0x69, 0x6E, 0x66, 0x6F,
-  0x2D, 0x62, 0x6F, 0x78, 0x20, 0x2E, 0x69, 0x6E, 0x70, 0x75, 0x74, 0x2D, 0x66, 0x69, 0x65, 0x6C,
-  0x64, 0x7B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74,
-  0x3A, 0x32, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x76, 0x65, 0x72, 0x74, 0x69, 0x63, 0x61,
-  0x6C, 0x2D, 0x61, 0x6C, 0x69, 0x67, 0x6E, 0x3A, 0x6D, 0x69, 0x64, 0x64, 0x6C, 0x65, 0x3B, 0x0D,
-  0x0A, 0x09, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x3A, 0x20, 0x31, 0x70, 0x78, 0x20, 0x73, 0x6F,
-  0x6C, 0x69, 0x64, 0x20, 0x23, 0x64, 0x37, 0x64, 0x37, 0x64, 0x37, 0x3B, 0x0D, 0x0A, 0x20, 0x20,
-  0x20, 0x20, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x20, 0x35, 0x38, 0x70, 0x78, 0x3B, 0x0D,
-  0x0A, 0x20, 0x20, 0x20, 0x20, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x3A,
-  0x20, 0x23, 0x66, 0x66, 0x66, 0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x62, 0x6F, 0x78, 0x2D,
-  0x73, 0x69, 0x7A, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x62,
-  0x6F, 0x78, 0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x70, 0x6F, 0x73, 0x69, 0x74, 0x69, 0x6F,
-  0x6E, 0x3A, 0x20, 0x72, 0x65, 0x6C, 0x61, 0x74, 0x69, 0x76, 0x65, 0x3B, 0x0D, 0x0A, 0x20, 0x20,
-  0x20, 0x20, 0x6D, 0x61, 0x72, 0x67, 0x69, 0x6E, 0x2D, 0x62, 0x6F, 0x74, 0x74, 0x6F, 0x6D, 0x3A,
-  0x20, 0x2D, 0x31, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x70, 0x61, 0x64, 0x64,
-  0x69, 0x6E, 0x67, 0x3A, 0x20, 0x31, 0x39, 0x70, 0x78, 0x20, 0x31, 0x35, 0x70, 0x78, 0x20, 0x31,
-  0x39, 0x70, 0x78, 0x20, 0x31, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x69,
-  0x6E, 0x70, 0x75, 0x74, 0x2D, 0x66, 0x69, 0x65, 0x6C, 0x64, 0x20, 0x69, 0x6E, 0x70, 0x75, 0x74,
-  0x20, 0x7B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x20,
-  0x32, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x6C, 0x69, 0x6E, 0x65, 0x2D,
-  0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x20, 0x32, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x20,
-  0x20, 0x20, 0x20, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x20, 0x31, 0x34,
-  0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x20,
-  0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x62, 0x6F, 0x72, 0x64, 0x65,
-  0x72, 0x3A, 0x20, 0x30, 0x20, 0x6E, 0x6F, 0x6E, 0x65, 0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20,
-  0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x3A, 0x20, 0x74, 0x72, 0x61, 0x6E,
-  0x73, 0x70, 0x61, 0x72, 0x65, 0x6E, 0x74, 0x3B, 0x0D, 0x0A, 0x09, 0x6F, 0x75, 0x74, 0x6C, 0x69,
-  0x6E, 0x65, 0x3A, 0x20, 0x6D, 0x65, 0x64, 0x69, 0x75, 0x6D, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A,
-  0x2E, 0x69, 0x6E, 0x70, 0x75, 0x74, 0x2D, 0x66, 0x69, 0x65, 0x6C, 0x64, 0x3A, 0x66, 0x69, 0x72,
-  0x73, 0x74, 0x2D, 0x6F, 0x66, 0x2D, 0x74, 0x79, 0x70, 0x65, 0x20, 0x7B, 0x0D, 0x0A, 0x20, 0x20,
-  0x20, 0x20, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x74, 0x6F, 0x70, 0x2D, 0x6C, 0x65, 0x66,
-  0x74, 0x2D, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3A, 0x20, 0x35, 0x70, 0x78, 0x3B, 0x0D, 0x0A,
-  0x20, 0x20, 0x20, 0x20, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x74, 0x6F, 0x70, 0x2D, 0x72,
-  0x69, 0x67, 0x68, 0x74, 0x2D, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3A, 0x20, 0x35, 0x70, 0x78,
-  0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x69, 0x6E, 0x70, 0x75, 0x74, 0x2D, 0x66, 0x69, 0x65,
-  0x6C, 0x64, 0x3A, 0x6C, 0x61, 0x73, 0x74, 0x2D, 0x6F, 0x66, 0x2D, 0x74, 0x79, 0x70, 0x65, 0x20,
-  0x7B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x62, 0x6F,
-  0x74, 0x74, 0x6F, 0x6D, 0x2D, 0x6C, 0x65, 0x66, 0x74, 0x2D, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73,
-  0x3A, 0x20, 0x35, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x62, 0x6F, 0x72, 0x64,
-  0x65, 0x72, 0x2D, 0x62, 0x6F, 0x74, 0x74, 0x6F, 0x6D, 0x2D, 0x72, 0x69, 0x67, 0x68, 0x74, 0x2D,
-  0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3A, 0x20, 0x35, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D,
-  0x0A, 0x2E, 0x62, 0x74, 0x6E, 0x7B, 0x0D, 0x0A, 0x09, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A,
-  0x34, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x68, 0x65, 0x69,
-  0x67, 0x68, 0x74, 0x3A, 0x34, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74,
-  0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x31, 0x34, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x64, 0x69,
-  0x73, 0x70, 0x6C, 0x61, 0x79, 0x3A, 0x62, 0x6C, 0x6F, 0x63, 0x6B, 0x3B, 0x0D, 0x0A, 0x09, 0x62,
-  0x6F, 0x72, 0x64, 0x65, 0x72, 0x3A, 0x20, 0x30, 0x20, 0x6E, 0x6F, 0x6E, 0x65, 0x3B, 0x0D, 0x0A,
-  0x09, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x20, 0x23, 0x46, 0x46, 0x46, 0x3B, 0x0D, 0x0A, 0x09,
-  0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3A, 0x20, 0x35,
-  0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x2D, 0x6D, 0x6F, 0x7A, 0x2D, 0x62, 0x6F, 0x72, 0x64, 0x65,
-  0x72, 0x2D, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3A, 0x20, 0x35, 0x70, 0x78, 0x3B, 0x0D, 0x0A,
-  0x09, 0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69, 0x74, 0x2D, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D,
-  0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3A, 0x20, 0x35, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6F,
-  0x75, 0x74, 0x6C, 0x69, 0x6E, 0x65, 0x3A, 0x20, 0x6E, 0x6F, 0x6E, 0x65, 0x3B, 0x0D, 0x0A, 0x09,
-  0x63, 0x75, 0x72, 0x73, 0x6F, 0x72, 0x3A, 0x20, 0x70, 0x6F, 0x69, 0x6E, 0x74, 0x65, 0x72, 0x3B,
-  0x0D, 0x0A, 0x09, 0x74, 0x65, 0x78, 0x74, 0x2D, 0x61, 0x6C, 0x69, 0x67, 0x6E, 0x3A, 0x63, 0x65,
-  0x6E, 0x74, 0x65, 0x72, 0x3B, 0x0D, 0x0A, 0x09, 0x6D, 0x69, 0x6E, 0x2D, 0x77, 0x69, 0x64, 0x74,
-  0x68, 0x3A, 0x37, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6E,
-  0x67, 0x3A, 0x30, 0x20, 0x31, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x62,
-  0x74, 0x6E, 0x2D, 0x72, 0x65, 0x64, 0x7B, 0x0D, 0x0A, 0x09, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72,
-  0x6F, 0x75, 0x6E, 0x64, 0x2D, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x23, 0x66, 0x35, 0x36, 0x63,
-  0x36, 0x63, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x67, 0x65, 0x74, 0x65, 0x77, 0x61, 0x79,
-  0x2D, 0x62, 0x74, 0x6E, 0x20, 0x62, 0x75, 0x74, 0x74, 0x6F, 0x6E, 0x20, 0x7B, 0x0D, 0x0A, 0x20,
-  0x20, 0x20, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x20, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D,
-  0x0A, 0x09, 0x6D, 0x61, 0x72, 0x67, 0x69, 0x6E, 0x3A, 0x33, 0x35, 0x70, 0x78, 0x20, 0x30, 0x3B,
-  0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x3C, 0x2F, 0x73, 0x74, 0x79, 0x6C, 0x65, 0x3E, 0x0D, 0x0A, 0x0D,
-  0x0A, 0x3C, 0x2F, 0x68, 0x65, 0x61, 0x64, 0x3E, 0x0D, 0x0A, 0x0D, 0x0A, 0x3C, 0x62, 0x6F, 0x64,
-  0x79, 0x3E, 0x0D, 0x0A, 0x3C, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22,
-  0x6D, 0x61, 0x69, 0x6E, 0x20, 0x77, 0x69, 0x66, 0x69, 0x2D, 0x73, 0x65, 0x74, 0x22, 0x3E, 0x0D,
-  0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x20, 0x20, 0x63, 0x6C,
-  0x61, 0x73, 0x73, 0x3D, 0x22, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x22, 0x3E, 0x0D, 0x0A, 0x20,
-  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x61, 0x20, 0x68, 0x72, 0x65, 0x66, 0x3D, 0x22,
-  0x23, 0x22, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22, 0x62, 0x74, 0x6E, 0x2D, 0x72, 0x65,
-  0x74, 0x75, 0x72, 0x6E, 0x22, 0x3E, 0xE4, 0xB8, 0x8A, 0xE4, 0xB8, 0x80, 0xE9, 0xA1, 0xB5, 0x3C,
-  0x2F, 0x61, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x68, 0x33,
-  0x3E, 0xE7, 0xBD, 0x91, 0xE5, 0x85, 0xB3, 0xE4, 0xB8, 0x8A, 0xE7, 0xBD, 0x91, 0xE8, 0xAE, 0xBE,
-  0xE7, 0xBD, 0xAE, 0x3C, 0x2F, 0x68, 0x33, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x2F,
-  0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x64, 0x69,
-  0x76, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22, 0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74,
-  0x22, 0x3E, 0x0D, 0x0A, 0x09, 0x3C, 0x66, 0x6F, 0x72, 0x6D, 0x20, 0x61, 0x63, 0x74, 0x69, 0x6F,
-  0x6E, 0x3D, 0x22, 0x72, 0x65, 0x73, 0x75, 0x6C, 0x74, 0x2E, 0x68, 0x74, 0x6D, 0x22, 0x20, 0x6D,
-  0x65, 0x74, 0x68, 0x6F, 0x64, 0x3D, 0x22, 0x70, 0x6F, 0x73, 0x74, 0x22, 0x3E, 0x0D, 0x0A, 0x20,
-  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x73, 0x65, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x20, 0x63,
-  0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22, 0x67, 0x65, 0x74, 0x65, 0x77, 0x61, 0x79, 0x2D, 0x69, 0x6E,
-  0x66, 0x6F, 0x2D, 0x62, 0x6F, 0x78, 0x22, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
-  0x20, 0x20, 0x20, 0x20, 0x3C, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22,
-  0x69, 0x6E, 0x70, 0x75, 0x74, 0x2D, 0x66, 0x69, 0x65, 0x6C, 0x64, 0x22, 0x3E, 0x0D, 0x0A, 0x20,
-  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x69, 0x6E, 0x70,
-  0x75, 0x74, 0x20, 0x69, 0x64, 0x3D, 0x22, 0x73, 0x73, 0x69, 0x64, 0x22, 0x20, 0x74, 0x79, 0x70,
-  0x65, 0x3D, 0x22, 0x74, 0x65, 0x78, 0x74, 0x22, 0x20, 0x6E, 0x61, 0x6D, 0x65, 0x3D, 0x22, 0x53,
-  0x53, 0x49, 0x44, 0x22, 0x20, 0x76, 0x61, 0x6C, 0x75, 0x65, 0x3D, 0x22, 0x22, 0x20, 0x70, 0x6C,
-  0x61, 0x63, 0x65, 0x68, 0x6F, 0x6C, 0x64, 0x65, 0x72, 0x3D, 0x22, 0x57, 0x49, 0x46, 0x49, 0xE5,
-  0x90, 0x8D, 0xE7, 0xA7, 0xB0, 0x22, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
-  0x20, 0x20, 0x20, 0x3C, 0x2F, 0x64, 0x69, 0x76, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x20,
-  0x20, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73, 0x3D,
-  0x22, 0x69, 0x6E, 0x70, 0x75, 0x74, 0x2D, 0x66, 0x69, 0x65, 0x6C, 0x64, 0x22, 0x3E, 0x0D, 0x0A,
-  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x69, 0x6E,
-  0x70, 0x75, 0x74, 0x20, 0x74, 0x79, 0x70, 0x65, 0x3D, 0x22, 0x70, 0x61, 0x73, 0x73, 0x77, 0x6F,
-  0x72, 0x64, 0x22, 0x20, 0x6E, 0x61, 0x6D, 0x65, 0x3D, 0x22, 0x50, 0x41, 0x53, 0x53, 0x22, 0x20,
-  0x76, 0x61, 0x6C, 0x75, 0x65, 0x3D, 0x22, 0x22, 0x20, 0x70, 0x6C, 0x61, 0x63, 0x65, 0x68, 0x6F,
-  0x6C, 0x64, 0x65, 0x72, 0x3D, 0x22, 0xE8, 0xBE, 0x93, 0xE5, 0x85, 0xA5, 0xE5, 0xAF, 0x86, 0xE7,
-  0xA0, 0x81, 0x22, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
-  0x3C, 0x2F, 0x64, 0x69, 0x76, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
-  0x3C, 0x2F, 0x73, 0x65, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20,
-  0x20, 0x20, 0x20, 0x20, 0x3C, 0x73, 0x65, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x20, 0x63, 0x6C, 0x61,
-  0x73, 0x73, 0x3D, 0x22, 0x67, 0x65, 0x74, 0x65, 0x77, 0x61, 0x79, 0x2D, 0x62, 0x74, 0x6E, 0x22,
-  0x3E, 0x3C, 0x62, 0x75, 0x74, 0x74, 0x6F, 0x6E, 0x20, 0x74, 0x79, 0x70, 0x65, 0x3D, 0x22, 0x73,
-  0x75, 0x62, 0x6D, 0x69, 0x74, 0x22, 0x20, 0x6E, 0x61, 0x6D, 0x65, 0x3D, 0x22, 0x6E, 0x65, 0x78,
-  0x74, 0x22, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22, 0x62, 0x74, 0x6E, 0x20, 0x62, 0x74,
-  0x6E, 0x2D, 0x72, 0x65, 0x64, 0x20, 0x62, 0x74, 0x6E, 0x2D, 0x6E, 0x65, 0x78, 0x74, 0x22, 0x3E,
-  0xE4, 0xB8, 0x8B, 0xE4, 0xB8, 0x80, 0xE6, 0xAD, 0xA5, 0x3C, 0x2F, 0x62, 0x75, 0x74, 0x74, 0x6F,
-  0x6E, 0x3E, 0x3C, 0x2F, 0x73, 0x65, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x3E, 0x0D, 0x0A, 0x09, 0x3C,
-  0x2F, 0x66, 0x6F, 0x72, 0x6D, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x2F, 0x64, 0x69,
-  0x76, 0x3E, 0x0D, 0x0A, 0x3C, 0x2F, 0x64, 0x69, 0x76, 0x3E, 0x0D, 0x0A, 0x3C, 0x2F, 0x62, 0x6F,
-  0x64, 0x79, 0x3E, 0x0D, 0x0A, 0x3C, 0x2F, 0x68, 0x74, 0x6D, 0x6C, 0x3E, 0x0D, 0x0A
+/* /wifisuccess.html: 2367 -> 1039 bytes */
+static const unsigned char web_asset_wifisuccess_html[0x40F] = {
+  0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xFF, 0x75, 0x56, 0xCD, 0x6E, 0xE3, 0x36,
+  0x10, 0x3E, 0x47, 0x4F, 0xC1, 0x55, 0xB0, 0x37, 0xC9, 0x96, 0xED, 0xC4, 0x0D, 0x64, 0x39, 0x40,
+  0x2F, 0x41, 0x2F, 0x7D, 0x80, 0x1E, 0x69, 0x71, 0x64, 0x11, 0xA1, 0x44, 0x2D, 0x45, 0xD9, 0xF1,
+  0x1A, 0x01, 0xDA, 0x43, 0x81, 0x62, 0x4F, 0xED, 0x13, 0x14, 0x7D, 0x81, 0xBD, 0x14, 0x05, 0xF6,
+  0xD0, 0xDD, 0xA7, 0xD9, 0x9F, 0xF6, 0xD4, 0x57, 0xE8, 0x50, 0x22, 0x65, 0xF9, 0x67, 0x1D, 0x30,
+  0xD4, 0xFC, 0xCF, 0x7C, 0x33, 0xA4, 0x94, 0xBC, 0x60, 0x32, 0xD5, 0xBB, 0x0A, 0x48, 0xAE, 0x0B,
+  0x71, 0xEF, 0x25, 0x6E, 0x03, 0xCA, 0x70, 0x2B, 0x40, 0x53, 0x94, 0xE8, 0x2A, 0x84, 0x57, 0x0D,
+  0xDF, 0x2C, 0xFD, 0x54, 0x96, 0x1A, 0x4A, 0x1D, 0x1A, 0x13, 0x9F, 0x58, 0x6A, 0xE9, 0x6B, 0x78,
+  0xD2, 0x63, 0x63, 0x8A, 0xBC, 0x9C, 0xAA, 0x1A, 0x90, 0xD7, 0xE8, 0x2C, 0xBC, 0xF3, 0x9D, 0x93,
+  0x5E, 0x75, 0xCB, 0x99, 0xCE, 0x97, 0x0C, 0x36, 0x3C, 0x85, 0xB0, 0x25, 0x02, 0xC2, 0x4B, 0xAE,
+  0x39, 0x15, 0x61, 0x9D, 0x52, 0x01, 0xCB, 0xC9, 0x28, 0x0A, 0x48, 0x41, 0x9F, 0x78, 0xD1, 0x14,
+  0x43, 0x56, 0x53, 0x83, 0x6A, 0x69, 0xBA, 0x42, 0x56, 0xE4, 0x93, 0x92, 0x16, 0xB0, 0xF4, 0x37,
+  0x1C, 0xB6, 0x95, 0x54, 0xDA, 0x84, 0xD2, 0x5C, 0x0B, 0xB8, 0xFF, 0xF2, 0xFE, 0xB7, 0x4F, 0x3F,
+  0xFF, 0xF9, 0xF1, 0xDD, 0x1B, 0x7C, 0xF8, 0xE7, 0xED, 0x87, 0x2F, 0xEF, 0xDF, 0x26, 0xE3, 0x4E,
+  0xE2, 0x25, 0xB5, 0xDE, 0x99, 0x9D, 0xAC, 0x24, 0xDB, 0x05, 0xA4, 0x0A, 0x48, 0x3E, 0xC1, 0x35,
+  0xC5, 0x35, 0xC3, 0x75, 0x83, 0xEB, 0x16, 0xD7, 0x1C, 0xA3, 0x89, 0x80, 0x48, 0x5C, 0x82, 0x07,
+  0x84, 0xE1, 0xCE, 0x34, 0x2E, 0x16, 0x10, 0x6D, 0xA2, 0xE3, 0x86, 0x69, 0x6B, 0x24, 0x33, 0xA9,
+  0x0A, 0xFC, 0xCF, 0x41, 0x30, 0xAC, 0x1A, 0xD5, 0x61, 0x0D, 0x25, 0x33, 0x25, 0x55, 0x0D, 0x92,
+  0x06, 0x18, 0xAA, 0x80, 0x06, 0x64, 0xD5, 0x68, 0x2D, 0xCB, 0x80, 0xD4, 0x20, 0x20, 0x45, 0x09,
+  0x2F, 0xD6, 0xC8, 0x14, 0x32, 0x7D, 0x7C, 0xD5, 0x48, 0x0D, 0x64, 0xEF, 0x5D, 0x15, 0x54, 0xAD,
+  0x79, 0x19, 0x93, 0x68, 0xE1, 0x5D, 0x55, 0x94, 0x31, 0x5E, 0xAE, 0x3B, 0x62, 0x25, 0x15, 0x03,
+  0xD5, 0x3D, 0x67, 0x08, 0x64, 0x58, 0xF3, 0xD7, 0x10, 0x93, 0x49, 0x14, 0xBD, 0x44, 0xCE, 0x06,
+  0x94, 0xE6, 0x08, 0x4B, 0x48, 0x05, 0x5F, 0xA3, 0xF9, 0x8A, 0x62, 0x0C, 0x5E, 0x82, 0x53, 0xCE,
+  0x68, 0xC1, 0xC5, 0x2E, 0x26, 0xFE, 0xF7, 0x3C, 0x55, 0xB2, 0x96, 0x99, 0x26, 0x3F, 0xD0, 0xEF,
+  0x80, 0xFB, 0x81, 0xCF, 0xB1, 0x2D, 0x46, 0x07, 0x1F, 0x1F, 0x70, 0xFB, 0x76, 0x0B, 0xB5, 0x2C,
+  0xB0, 0xB1, 0xE4, 0x05, 0x2F, 0x0C, 0xA6, 0xB4, 0xD4, 0x0B, 0xEF, 0xD9, 0xBB, 0x8C, 0x91, 0x49,
+  0xB9, 0x0D, 0xB0, 0x05, 0xBE, 0xCE, 0x75, 0x4C, 0x4A, 0xC4, 0x82, 0x0A, 0x63, 0x60, 0xD0, 0x45,
+  0xE9, 0x8A, 0xA6, 0x8F, 0x6B, 0x25, 0x9B, 0x92, 0xC5, 0xE4, 0x3A, 0xBB, 0x35, 0x7F, 0xDE, 0x55,
+  0x27, 0x0D, 0xDA, 0x81, 0x33, 0x2E, 0x72, 0x6B, 0x6D, 0xAB, 0xC1, 0xC6, 0x87, 0xC7, 0x2C, 0x8C,
+  0x8F, 0xAA, 0xFB, 0x43, 0xE1, 0xF3, 0xE9, 0xE8, 0xF6, 0xE5, 0xE2, 0xD9, 0x1B, 0x15, 0x94, 0x97,
+  0xE8, 0xA1, 0x9D, 0xA2, 0xD8, 0xD9, 0xF3, 0xD2, 0xD9, 0x5B, 0x4E, 0x25, 0x6B, 0x1C, 0x2F, 0x59,
+  0xC6, 0x0A, 0x04, 0xD5, 0x7C, 0x03, 0x2D, 0xA2, 0x4F, 0xC6, 0x57, 0x8B, 0x70, 0x87, 0x6E, 0x88,
+  0x2C, 0x14, 0x60, 0x31, 0xAB, 0x47, 0xAE, 0xC3, 0x81, 0xC2, 0x91, 0x9C, 0xF1, 0xBA, 0x12, 0x74,
+  0x17, 0x0F, 0xF4, 0x4E, 0xAC, 0xA4, 0xE2, 0x38, 0xE8, 0xB1, 0xEB, 0x8A, 0xC9, 0x7F, 0x64, 0x8E,
+  0x13, 0x28, 0x72, 0x0E, 0xC9, 0x3C, 0x9D, 0xA7, 0x8B, 0x1E, 0x83, 0x9B, 0xBB, 0xCA, 0x78, 0x33,
+  0xCD, 0x0B, 0x8F, 0x59, 0x12, 0xDD, 0x65, 0x42, 0x6E, 0x63, 0x92, 0x73, 0xC6, 0xA0, 0x5C, 0xB8,
+  0xAA, 0x1D, 0x6C, 0x5F, 0x2D, 0xA8, 0xAF, 0x9E, 0x1C, 0xCA, 0x3F, 0x64, 0x94, 0xCF, 0xFA, 0x2E,
+  0xDA, 0x99, 0x3A, 0x4F, 0x81, 0xD8, 0x1C, 0xCC, 0x2C, 0xBB, 0x19, 0x4B, 0xB1, 0x44, 0x50, 0xC8,
+  0x4C, 0xA5, 0x90, 0xCA, 0x94, 0x92, 0x65, 0xAD, 0xDF, 0x95, 0x2E, 0x43, 0x05, 0xBA, 0x51, 0xE5,
+  0x69, 0xB5, 0x9D, 0x09, 0x0E, 0x09, 0xCA, 0x2B, 0xA0, 0x7A, 0x31, 0x14, 0xBB, 0xE8, 0xD3, 0xEA,
+  0x89, 0x4C, 0xA3, 0x36, 0x9C, 0xAD, 0xEF, 0xE6, 0xA6, 0xA5, 0x4E, 0x72, 0x71, 0x6D, 0xC0, 0x73,
+  0xD6, 0xA6, 0xDA, 0x1E, 0xA4, 0xE3, 0xD3, 0x11, 0x9D, 0x17, 0x12, 0x7D, 0x05, 0xCB, 0x03, 0x1E,
+  0x27, 0xF9, 0x1F, 0xC0, 0xA3, 0xAB, 0x5A, 0x8A, 0x46, 0x9B, 0xD9, 0x11, 0x90, 0xF5, 0xBE, 0xB4,
+  0xAC, 0xEC, 0x23, 0xFA, 0xD8, 0xF2, 0x8C, 0x87, 0x75, 0x93, 0xA6, 0x50, 0xD7, 0x64, 0x64, 0x6F,
+  0xBC, 0xFD, 0xF1, 0x74, 0x64, 0x02, 0x9E, 0xB0, 0xCE, 0x85, 0x47, 0xF0, 0x17, 0x16, 0xF2, 0xF5,
+  0x05, 0xAE, 0x55, 0x3F, 0x51, 0xAD, 0x8F, 0x19, 0x3D, 0xD1, 0x5F, 0x15, 0x93, 0x2E, 0xA5, 0x01,
+  0xA8, 0x5D, 0x73, 0xAE, 0x1F, 0x1E, 0x1E, 0xCE, 0xF3, 0xCB, 0xA7, 0xFB, 0x41, 0xF7, 0xDC, 0x20,
+  0x1E, 0xF0, 0x9B, 0x45, 0xA7, 0x4D, 0xEF, 0x7B, 0xEE, 0x02, 0x1A, 0x95, 0xF6, 0x4E, 0x1A, 0x82,
+  0x3C, 0xBB, 0x88, 0x46, 0xB5, 0xB7, 0xAE, 0x78, 0xC9, 0xCC, 0xE9, 0x98, 0x2A, 0x28, 0x8E, 0xC2,
+  0x4D, 0xE6, 0x67, 0xED, 0x9A, 0xDE, 0x59, 0x4F, 0xD8, 0x13, 0x67, 0xCE, 0x20, 0x95, 0x8A, 0x76,
+  0x2D, 0x29, 0x65, 0x7B, 0xC7, 0xB9, 0x83, 0x72, 0xDE, 0x6F, 0xCB, 0x1A, 0x04, 0xB9, 0x39, 0x1A,
+  0x1E, 0x37, 0x34, 0xFD, 0xF5, 0xEA, 0x5C, 0x3A, 0x58, 0x5A, 0xE0, 0xAC, 0x38, 0x54, 0x94, 0xF1,
+  0xA6, 0x8E, 0xC9, 0x6D, 0xEB, 0xC3, 0xB6, 0xEE, 0x92, 0xA4, 0xEF, 0xF6, 0x05, 0xA1, 0x6C, 0xB4,
+  0xC9, 0xB0, 0x4F, 0x3E, 0x6D, 0x54, 0x6D, 0x42, 0x55, 0x92, 0x5B, 0x70, 0x2F, 0x01, 0x6E, 0xEE,
+  0xB4, 0xEE, 0x38, 0x7C, 0xD3, 0x95, 0xE4, 0x3A, 0x10, 0x91, 0x49, 0x74, 0x00, 0x09, 0x07, 0x97,
+  0xED, 0x2F, 0x0D, 0x80, 0x6B, 0x2F, 0xAA, 0xAD, 0x41, 0xC3, 0x96, 0xEE, 0x42, 0x54, 0xB7, 0xAF,
+  0x24, 0x9C, 0x73, 0x33, 0x4F, 0xC7, 0xD7, 0x89, 0x7D, 0x15, 0xCD, 0x6E, 0xBB, 0x0E, 0x3F, 0x7B,
+  0xC9, 0xD8, 0xBE, 0x39, 0x93, 0x71, 0xF7, 0x6D, 0xE0, 0x25, 0xE6, 0x1A, 0x47, 0x9A, 0xF1, 0x0D,
+  0x49, 0x05, 0xAD, 0xEB, 0xA5, 0x6F, 0xEE, 0x63, 0x32, 0xEC, 0x3B, 0xBE, 0x93, 0x09, 0x49, 0xEC,
+  0xD9, 0xB2, 0x4A, 0x1D, 0xD5, 0x4A, 0xBA, 0x5F, 0x82, 0x9F, 0x18, 0x0A, 0xB2, 0xA5, 0x7F, 0xED,
+  0x3B, 0x9D, 0xC3, 0x29, 0xF4, 0xEF, 0xF1, 0x3D, 0xFE, 0xF1, 0xDD, 0x8F, 0xFF, 0xFE, 0xF1, 0x57,
+  0x32, 0xA6, 0x03, 0xA3, 0x7C, 0x76, 0xF1, 0x3D, 0x8F, 0xEC, 0x56, 0xA7, 0x4B, 0x13, 0x94, 0xA5,
+  0x06, 0x49, 0xDA, 0x73, 0x79, 0x48, 0x20, 0xC9, 0xA7, 0xF7, 0x9D, 0xF9, 0xE7, 0x5F, 0x7E, 0xFD,
+  0xF4, 0xE6, 0xF7, 0xFF, 0xFE, 0xFE, 0x09, 0xAD, 0xA7, 0xCE, 0x0F, 0x9A, 0x9A, 0xAA, 0xED, 0x66,
+  0x8B, 0x1E, 0x77, 0xDF, 0x49, 0xFF, 0x03, 0xF2, 0x5D, 0x50, 0x2F, 0x3F, 0x09, 0x00, 0x00
 };
 
-const unsigned char wifisuccess[0x9BC] = {
-  0x3C, 0x21, 0x64, 0x6F, 0x63, 0x74, 0x79, 0x70, 0x65, 0x20, 0x68, 0x74, 0x6D, 0x6C, 0x3E, 0x0D,
-  0x0A, 0x3C, 0x68, 0x74, 0x6D, 0x6C, 0x3E, 0x0D, 0x0A, 0x3C, 0x68, 0x65, 0x61, 0x64, 0x3E, 0x0D,
-  0x0A, 0x3C, 0x6D, 0x65, 0x74, 0x61, 0x20, 0x68, 0x74, 0x74, 0x70, 0x2D, 0x65, 0x71, 0x75, 0x69,
-  0x76, 0x3D, 0x22, 0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x74, 0x79, 0x70, 0x65, 0x22,
-  0x20, 0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x3D, 0x22, 0x74, 0x65, 0x78, 0x74, 0x2F, 0x68,
-  0x74, 0x6D, 0x6C, 0x22, 0x20, 0x63, 0x68, 0x61, 0x72, 0x73, 0x65, 0x74, 0x3D, 0x22, 0x75, 0x74,
-  0x66, 0x2D, 0x38, 0x22, 0x3E, 0x0D, 0x0A, 0x3C, 0x6D, 0x65, 0x74, 0x61, 0x20, 0x63, 0x6F, 0x6E,
-  0x74, 0x65, 0x6E, 0x74, 0x3D, 0x22, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3D, 0x64, 0x65, 0x76, 0x69,
-  0x63, 0x65, 0x2D, 0x77, 0x69, 0x64, 0x74, 0x68, 0x2C, 0x20, 0x69, 0x6E, 0x69, 0x74, 0x69, 0x61,
-  0x6C, 0x2D, 0x73, 0x63, 0x61, 0x6C, 0x65, 0x3D, 0x31, 0x2E, 0x30, 0x2C, 0x20, 0x6D, 0x61, 0x78,
-  0x69, 0x6D, 0x75, 0x6D, 0x2D, 0x73, 0x63, 0x61, 0x6C, 0x65, 0x3D, 0x31, 0x2E, 0x30, 0x2C, 0x20,
-  0x75, 0x73, 0x65, 0x72, 0x2D, 0x73, 0x63, 0x61, 0x6C, 0x61, 0x62, 0x6C, 0x65, 0x3D, 0x30, 0x22,
-  0x20, 0x6E, 0x61, 0x6D, 0x65, 0x3D, 0x22, 0x76, 0x69, 0x65, 0x77, 0x70, 0x6F, 0x72, 0x74, 0x22,
-  0x3E, 0x0D, 0x0A, 0x3C, 0x74, 0x69, 0x74, 0x6C, 0x65, 0x3E, 0xE7, 0xBD, 0x91, 0xE5, 0x85, 0xB3,
-  0xE4, 0xB8, 0x8A, 0xE7, 0xBD, 0x91, 0xE8, 0xAE, 0xBE, 0xE7, 0xBD, 0xAE, 0x3C, 0x2F, 0x74, 0x69,
-  0x74, 0x6C, 0x65, 0x3E, 0x0D, 0x0A, 0x3C, 0x73, 0x74, 0x79, 0x6C, 0x65, 0x3E, 0x0D, 0x0A, 0x20,
-  0x62, 0x6F, 0x64, 0x79, 0x2C, 0x20, 0x70, 0x2C, 0x20, 0x68, 0x31, 0x2C, 0x20, 0x68, 0x32, 0x2C,
-  0x20, 0x68, 0x33, 0x2C, 0x20, 0x68, 0x34, 0x2C, 0x20, 0x68, 0x35, 0x2C, 0x20, 0x68, 0x36, 0x2C,
-  0x20, 0x75, 0x6C, 0x2C, 0x20, 0x6F, 0x6C, 0x2C, 0x20, 0x6C, 0x69, 0x2C, 0x20, 0x64, 0x6C, 0x2C,
-  0x20, 0x64, 0x74, 0x2C, 0x20, 0x64, 0x64, 0x2C, 0x20, 0x74, 0x61, 0x62, 0x6C, 0x65, 0x2C, 0x20,
-  0x74, 0x68, 0x2C, 0x20, 0x74, 0x64, 0x2C, 0x20, 0x66, 0x6F, 0x72, 0x6D, 0x2C, 0x20, 0x66, 0x69,
-  0x65, 0x6C, 0x64, 0x73, 0x65, 0x74, 0x2C, 0x20, 0x6C, 0x65, 0x67, 0x65, 0x6E, 0x64, 0x2C, 0x20,
-  0x69, 0x6E, 0x70, 0x75, 0x74, 0x2C, 0x20, 0x74, 0x65, 0x78, 0x74, 0x61, 0x72, 0x65, 0x61, 0x2C,
-  0x20, 0x62, 0x75, 0x74, 0x74, 0x6F, 0x6E, 0x2C, 0x20, 0x73, 0x65, 0x6C, 0x65, 0x63, 0x74, 0x2C,
-  0x20, 0x69, 0x6D, 0x67, 0x2C, 0x20, 0x62, 0x6C, 0x6F, 0x63, 0x6B, 0x71, 0x75, 0x6F, 0x74, 0x65,
-  0x20, 0x7B, 0x0D, 0x0A, 0x09, 0x6D, 0x61, 0x72, 0x67, 0x69, 0x6E, 0x3A, 0x20, 0x30, 0x3B, 0x0D,
-  0x0A, 0x09, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x30, 0x3B, 0x0D, 0x0A, 0x09,
-  0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x3A, 0x20, 0x30, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E,
-  0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x20, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A, 0x09,
-  0x76, 0x65, 0x72, 0x74, 0x69, 0x63, 0x61, 0x6C, 0x2D, 0x61, 0x6C, 0x69, 0x67, 0x6E, 0x3A, 0x20,
-  0x62, 0x61, 0x73, 0x65, 0x6C, 0x69, 0x6E, 0x65, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74,
-  0x2D, 0x66, 0x61, 0x6D, 0x69, 0x6C, 0x79, 0x3A, 0x20, 0x22, 0x4D, 0x69, 0x63, 0x72, 0x6F, 0x73,
-  0x6F, 0x66, 0x74, 0x20, 0x59, 0x61, 0x48, 0x65, 0x69, 0x22, 0x2C, 0x22, 0x69, 0x63, 0x6F, 0x6E,
-  0x66, 0x6F, 0x6E, 0x74, 0x22, 0x2C, 0x22, 0x46, 0x6F, 0x6E, 0x74, 0x41, 0x77, 0x65, 0x73, 0x6F,
-  0x6D, 0x65, 0x22, 0x20, 0x20, 0x21, 0x69, 0x6D, 0x70, 0x6F, 0x72, 0x74, 0x61, 0x6E, 0x74, 0x3B,
-  0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x68, 0x31, 0x2C, 0x20, 0x68, 0x32, 0x2C, 0x20, 0x68, 0x33, 0x2C,
-  0x20, 0x68, 0x34, 0x2C, 0x20, 0x68, 0x35, 0x2C, 0x20, 0x68, 0x36, 0x20, 0x7B, 0x0D, 0x0A, 0x09,
-  0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x77, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x20, 0x6E, 0x6F, 0x72,
-  0x6D, 0x61, 0x6C, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x62, 0x6F, 0x64, 0x79, 0x7B, 0x0D, 0x0A,
-  0x09, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x3A, 0x20, 0x23, 0x66, 0x35,
-  0x66, 0x35, 0x66, 0x35, 0x0D, 0x0A, 0x09, 0x7D, 0x0D, 0x0A, 0x62, 0x6F, 0x64, 0x79, 0x2C, 0x20,
-  0x68, 0x74, 0x6D, 0x6C, 0x20, 0x7B, 0x0D, 0x0A, 0x09, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A,
-  0x20, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A, 0x09, 0x6D, 0x61, 0x78, 0x2D, 0x68, 0x65, 0x69,
-  0x67, 0x68, 0x74, 0x3A, 0x20, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x68,
-  0x74, 0x6D, 0x6C, 0x7B, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x36, 0x32,
-  0x2E, 0x35, 0x25, 0x3B, 0x7D, 0x0D, 0x0A, 0x2E, 0x6D, 0x61, 0x69, 0x6E, 0x7B, 0x0D, 0x0A, 0x09,
-  0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A, 0x09, 0x6D, 0x69,
-  0x6E, 0x2D, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D, 0x0A,
-  0x09, 0x70, 0x6F, 0x73, 0x69, 0x74, 0x69, 0x6F, 0x6E, 0x3A, 0x72, 0x65, 0x6C, 0x61, 0x74, 0x69,
-  0x76, 0x65, 0x3B, 0x0D, 0x0A, 0x09, 0x62, 0x6F, 0x78, 0x2D, 0x73, 0x69, 0x7A, 0x69, 0x6E, 0x67,
-  0x3A, 0x20, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x62, 0x6F, 0x78, 0x3B, 0x0D, 0x0A, 0x09,
-  0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69, 0x74, 0x2D, 0x62, 0x6F, 0x78, 0x2D, 0x73, 0x69, 0x7A, 0x69,
-  0x6E, 0x67, 0x3A, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x62, 0x6F, 0x78, 0x3B, 0x0D, 0x0A,
-  0x09, 0x64, 0x69, 0x73, 0x70, 0x6C, 0x61, 0x79, 0x3A, 0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69, 0x74,
-  0x2D, 0x62, 0x6F, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69, 0x74, 0x2D,
-  0x62, 0x6F, 0x78, 0x2D, 0x6F, 0x72, 0x69, 0x65, 0x6E, 0x74, 0x3A, 0x76, 0x65, 0x72, 0x74, 0x69,
-  0x63, 0x61, 0x6C, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72,
-  0x20, 0x7B, 0x0D, 0x0A, 0x09, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x3A,
-  0x20, 0x23, 0x66, 0x35, 0x36, 0x63, 0x36, 0x63, 0x3B, 0x0D, 0x0A, 0x09, 0x68, 0x65, 0x69, 0x67,
-  0x68, 0x74, 0x3A, 0x34, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D,
-  0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x34, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6F,
-  0x76, 0x65, 0x72, 0x66, 0x6C, 0x6F, 0x77, 0x3A, 0x20, 0x68, 0x69, 0x64, 0x64, 0x65, 0x6E, 0x3B,
-  0x0D, 0x0A, 0x09, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x20, 0x31, 0x30, 0x30, 0x25, 0x3B, 0x0D,
-  0x0A, 0x09, 0x62, 0x6F, 0x78, 0x2D, 0x73, 0x69, 0x7A, 0x69, 0x6E, 0x67, 0x3A, 0x20, 0x62, 0x6F,
-  0x72, 0x64, 0x65, 0x72, 0x2D, 0x62, 0x6F, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x70, 0x6F, 0x73, 0x69,
-  0x74, 0x69, 0x6F, 0x6E, 0x3A, 0x20, 0x72, 0x65, 0x6C, 0x61, 0x74, 0x69, 0x76, 0x65, 0x3B, 0x0D,
-  0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x20, 0x68, 0x33, 0x20, 0x7B,
-  0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x20, 0x31, 0x38,
-  0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x68, 0x65, 0x69, 0x67, 0x68,
-  0x74, 0x3A, 0x20, 0x34, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x74, 0x65, 0x78, 0x74, 0x2D,
-  0x61, 0x6C, 0x69, 0x67, 0x6E, 0x3A, 0x20, 0x63, 0x65, 0x6E, 0x74, 0x65, 0x72, 0x3B, 0x0D, 0x0A,
-  0x09, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x20, 0x23, 0x66, 0x66, 0x66, 0x3B, 0x0D, 0x0A, 0x7D,
-  0x0D, 0x0A, 0x2E, 0x62, 0x74, 0x6E, 0x2D, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6E, 0x20, 0x7B, 0x0D,
-  0x0A, 0x09, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x3A, 0x20, 0x63, 0x65,
-  0x6E, 0x74, 0x65, 0x72, 0x20, 0x6E, 0x6F, 0x2D, 0x72, 0x65, 0x70, 0x65, 0x61, 0x74, 0x3B, 0x0D,
-  0x0A, 0x09, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x2D, 0x73, 0x69, 0x7A,
-  0x65, 0x3A, 0x20, 0x31, 0x32, 0x70, 0x78, 0x20, 0x32, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09,
-  0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x20, 0x34, 0x34, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x68,
-  0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x20, 0x34, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x64,
-  0x69, 0x73, 0x70, 0x6C, 0x61, 0x79, 0x3A, 0x20, 0x69, 0x6E, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x62,
-  0x6C, 0x6F, 0x63, 0x6B, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x73, 0x69, 0x7A,
-  0x65, 0x3A, 0x20, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x68,
-  0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x20, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6F, 0x76,
-  0x65, 0x72, 0x66, 0x6C, 0x6F, 0x77, 0x3A, 0x20, 0x68, 0x69, 0x64, 0x64, 0x65, 0x6E, 0x3B, 0x0D,
-  0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x20, 0x2E, 0x62, 0x74, 0x6E,
-  0x2D, 0x72, 0x65, 0x74, 0x75, 0x72, 0x6E, 0x20, 0x7B, 0x0D, 0x0A, 0x09, 0x70, 0x6F, 0x73, 0x69,
-  0x74, 0x69, 0x6F, 0x6E, 0x3A, 0x20, 0x61, 0x62, 0x73, 0x6F, 0x6C, 0x75, 0x74, 0x65, 0x3B, 0x0D,
-  0x0A, 0x09, 0x6C, 0x65, 0x66, 0x74, 0x3A, 0x20, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x74,
-  0x6F, 0x70, 0x3A, 0x20, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x77, 0x69,
-  0x66, 0x69, 0x2D, 0x73, 0x75, 0x63, 0x63, 0x65, 0x73, 0x73, 0x20, 0x2E, 0x63, 0x6F, 0x6E, 0x74,
-  0x65, 0x6E, 0x74, 0x7B, 0x0D, 0x0A, 0x09, 0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69, 0x74, 0x2D, 0x62,
-  0x6F, 0x78, 0x2D, 0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20, 0x31, 0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20,
-  0x20, 0x2D, 0x6D, 0x6F, 0x7A, 0x2D, 0x62, 0x6F, 0x78, 0x2D, 0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20,
-  0x31, 0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69, 0x74, 0x2D,
-  0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20, 0x31, 0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x2D, 0x6D,
-  0x73, 0x2D, 0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20, 0x31, 0x3B, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20,
-  0x66, 0x6C, 0x65, 0x78, 0x3A, 0x20, 0x31, 0x3B, 0x0D, 0x0A, 0x09, 0x70, 0x61, 0x64, 0x64, 0x69,
-  0x6E, 0x67, 0x3A, 0x31, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x62, 0x61, 0x63, 0x6B, 0x67,
-  0x72, 0x6F, 0x75, 0x6E, 0x64, 0x2D, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x23, 0x46, 0x46, 0x46,
-  0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x77, 0x69, 0x66, 0x69, 0x2D, 0x73, 0x75, 0x63, 0x63,
-  0x65, 0x73, 0x73, 0x20, 0x68, 0x32, 0x7B, 0x0D, 0x0A, 0x09, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A,
-  0x20, 0x23, 0x66, 0x35, 0x36, 0x63, 0x36, 0x63, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74,
-  0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x33, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x74, 0x65,
-  0x78, 0x74, 0x2D, 0x61, 0x6C, 0x69, 0x67, 0x6E, 0x3A, 0x63, 0x65, 0x6E, 0x74, 0x65, 0x72, 0x3B,
-  0x0D, 0x0A, 0x09, 0x70, 0x61, 0x64, 0x64, 0x69, 0x6E, 0x67, 0x3A, 0x33, 0x30, 0x70, 0x78, 0x20,
-  0x30, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74,
-  0x3A, 0x33, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x77, 0x69, 0x66, 0x69,
-  0x2D, 0x73, 0x75, 0x63, 0x63, 0x65, 0x73, 0x73, 0x20, 0x70, 0x7B, 0x0D, 0x0A, 0x09, 0x74, 0x65,
-  0x78, 0x74, 0x2D, 0x69, 0x6E, 0x64, 0x65, 0x6E, 0x74, 0x3A, 0x32, 0x72, 0x65, 0x6D, 0x3B, 0x0D,
-  0x0A, 0x09, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x31, 0x36, 0x70, 0x78,
-  0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x68, 0x65, 0x69, 0x67, 0x68, 0x74, 0x3A,
-  0x32, 0x38, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x62, 0x74, 0x6E, 0x7B, 0x0D,
-  0x0A, 0x09, 0x74, 0x65, 0x78, 0x74, 0x2D, 0x64, 0x65, 0x63, 0x6F, 0x72, 0x61, 0x74, 0x69, 0x6F,
-  0x6E, 0x3A, 0x20, 0x6E, 0x6F, 0x6E, 0x65, 0x3B, 0x0D, 0x0A, 0x09, 0x68, 0x65, 0x69, 0x67, 0x68,
-  0x74, 0x3A, 0x34, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x6C, 0x69, 0x6E, 0x65, 0x2D, 0x68,
-  0x65, 0x69, 0x67, 0x68, 0x74, 0x3A, 0x34, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x66, 0x6F,
-  0x6E, 0x74, 0x2D, 0x73, 0x69, 0x7A, 0x65, 0x3A, 0x31, 0x34, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09,
-  0x64, 0x69, 0x73, 0x70, 0x6C, 0x61, 0x79, 0x3A, 0x62, 0x6C, 0x6F, 0x63, 0x6B, 0x3B, 0x0D, 0x0A,
-  0x09, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x3A, 0x20, 0x30, 0x20, 0x6E, 0x6F, 0x6E, 0x65, 0x3B,
-  0x0D, 0x0A, 0x09, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x20, 0x23, 0x46, 0x46, 0x46, 0x3B, 0x0D,
-  0x0A, 0x09, 0x62, 0x6F, 0x72, 0x64, 0x65, 0x72, 0x2D, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3A,
-  0x20, 0x35, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x2D, 0x6D, 0x6F, 0x7A, 0x2D, 0x62, 0x6F, 0x72,
-  0x64, 0x65, 0x72, 0x2D, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3A, 0x20, 0x35, 0x70, 0x78, 0x3B,
-  0x0D, 0x0A, 0x09, 0x2D, 0x77, 0x65, 0x62, 0x6B, 0x69, 0x74, 0x2D, 0x62, 0x6F, 0x72, 0x64, 0x65,
-  0x72, 0x2D, 0x72, 0x61, 0x64, 0x69, 0x75, 0x73, 0x3A, 0x20, 0x35, 0x70, 0x78, 0x3B, 0x0D, 0x0A,
-  0x09, 0x6F, 0x75, 0x74, 0x6C, 0x69, 0x6E, 0x65, 0x3A, 0x20, 0x6E, 0x6F, 0x6E, 0x65, 0x3B, 0x0D,
-  0x0A, 0x09, 0x63, 0x75, 0x72, 0x73, 0x6F, 0x72, 0x3A, 0x20, 0x70, 0x6F, 0x69, 0x6E, 0x74, 0x65,
-  0x72, 0x3B, 0x0D, 0x0A, 0x09, 0x74, 0x65, 0x78, 0x74, 0x2D, 0x61, 0x6C, 0x69, 0x67, 0x6E, 0x3A,
-  0x63, 0x65, 0x6E, 0x74, 0x65, 0x72, 0x3B, 0x0D, 0x0A, 0x09, 0x6D, 0x69, 0x6E, 0x2D, 0x77, 0x69,
-  0x64, 0x74, 0x68, 0x3A, 0x37, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x09, 0x70, 0x61, 0x64, 0x64,
-  0x69, 0x6E, 0x67, 0x3A, 0x30, 0x20, 0x31, 0x30, 0x70, 0x78, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A,
-  0x2E, 0x62, 0x74, 0x6E, 0x2D, 0x72, 0x65, 0x64, 0x7B, 0x0D, 0x0A, 0x09, 0x62, 0x61, 0x63, 0x6B,
-  0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64, 0x2D, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x23, 0x66, 0x35,
-  0x36, 0x63, 0x36, 0x63, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x2E, 0x67, 0x65, 0x74, 0x65, 0x77,
-  0x61, 0x79, 0x2D, 0x62, 0x74, 0x6E, 0x20, 0x62, 0x75, 0x74, 0x74, 0x6F, 0x6E, 0x20, 0x7B, 0x0D,
-  0x0A, 0x20, 0x20, 0x20, 0x20, 0x77, 0x69, 0x64, 0x74, 0x68, 0x3A, 0x20, 0x31, 0x30, 0x30, 0x25,
-  0x3B, 0x0D, 0x0A, 0x09, 0x6D, 0x61, 0x72, 0x67, 0x69, 0x6E, 0x3A, 0x33, 0x35, 0x70, 0x78, 0x20,
-  0x30, 0x3B, 0x0D, 0x0A, 0x7D, 0x0D, 0x0A, 0x3C, 0x2F, 0x73, 0x74, 0x79, 0x6C, 0x65, 0x3E, 0x0D,
-  0x0A, 0x3C, 0x2F, 0x68, 0x65, 0x61, 0x64, 0x3E, 0x0D, 0x0A, 0x0D, 0x0A, 0x3C, 0x62, 0x6F, 0x64,
-  0x79, 0x3E, 0x0D, 0x0A, 0x3C, 0x64, 0x69, 0x76, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22,
-  0x6D, 0x61, 0x69, 0x6E, 0x20, 0x77, 0x69, 0x66, 0x69, 0x2D, 0x73, 0x75, 0x63, 0x63, 0x65, 0x73,
-  0x73, 0x22, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x3C, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x20, 0x63,
-  0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x22, 0x3E, 0x0D, 0x0A,
-  0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x61, 0x20, 0x68, 0x72, 0x65, 0x66, 0x3D,
-  0x22, 0x23, 0x22, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22, 0x62, 0x74, 0x6E, 0x2D, 0x72,
-  0x65, 0x74, 0x75, 0x72, 0x6E, 0x22, 0x3E, 0xE4, 0xB8, 0x8A, 0xE4, 0xB8, 0x80, 0xE9, 0xA1, 0xB5,
-  0x3C, 0x2F, 0x61, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x68,
-  0x33, 0x3E, 0xE7, 0xBD, 0x91, 0xE5, 0x85, 0xB3, 0xE4, 0xB8, 0x8A, 0xE7, 0xBD, 0x91, 0xE8, 0xAE,
-  0xBE, 0xE7, 0xBD, 0xAE, 0x3C, 0x2F, 0x68, 0x33, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C,
-  0x2F, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x64,
-  0x69, 0x76, 0x20, 0x63, 0x6C, 0x61, 0x73, 0x73, 0x3D, 0x22, 0x63, 0x6F, 0x6E, 0x74, 0x65, 0x6E,
-  0x74, 0x22, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x68, 0x32, 0x3E,
-  0xE8, 0xAE, 0xBE, 0xE7, 0xBD, 0xAE, 0xE6, 0x88, 0x90, 0xE5, 0x8A, 0x9F, 0xEF, 0xBC, 0x81, 0x3C,
-  0x2F, 0x68, 0x32, 0x3E, 0x0D, 0x0A, 0x20, 0x20, 0x20, 0x20, 0x3C, 0x2F, 0x64, 0x69, 0x76, 0x3E,
-  0x0D, 0x0A, 0x3C, 0x2F, 0x64, 0x69, 0x76, 0x3E, 0x0D, 0x0A, 0x3C, 0x2F, 0x62, 0x6F, 0x64, 0x79,
-  0x3E, 0x0D, 0x0A, 0x3C, 0x2F, 0x68, 0x74, 0x6D, 0x6C, 0x3E, 0x0D, 0x0A
+const httpd_static_asset_t web_assets[] = {
+  { "/wififail.html", HTTP_CONTENT_HTML_STR, web_asset_wififail_html, sizeof(web_asset_wififail_html), 0x4E950D45, true },
+  { "/wifisetting.html", HTTP_CONTENT_HTML_STR, web_asset_wifisetting_html, sizeof(web_asset_wifisetting_html), 0x0F099A7F, true },
+  { "/wifisuccess.html", HTTP_CONTENT_HTML_STR, web_asset_wifisuccess_html, sizeof(web_asset_wifisuccess_html), 0x764A52DF, true },
 };
 
+const int web_assets_num = sizeof(web_assets) / sizeof(web_assets[0]);
@@ -0,0 +1,655 @@
+/**
+******************************************************************************
+* @file    host_socket.c
+* @version V1.0.0
+* @brief   The MICO socket API of mico_socket.h on top of the POSIX sockets
+*          of the Linux host. MICO file descriptors are small indexes into a
+*          table of host sockets so that they fit in the 24 bit MICO fd_set,
+*          addresses and ports are kept in host byte order like lwIP's MICO
+*          wrapper does.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* mico_socket.h can not be included here, its types and function names
+ * collide with the libc ones. The few MICO definitions needed are repeated
+ * below with a MICO_ prefix and must be kept in sync with that header. */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define MICO_FD_SETSIZE           (24)
+#define MICO_NFDBITS              (sizeof(unsigned long) * 8)
+
+#define MICO_SOCK_STREAM          (1)
+#define MICO_SOCK_DGRM            (2)
+/* The pipe of an event fd of mico_rtos_host.c */
+#define HOST_SOCK_EVENT           (0)
+
+#define MICO_SOL_SOCKET           (1)
+#define MICO_IPPROTO_IP           (0)
+#define MICO_IPPROTO_TCP          (6)
+
+#define MICO_SO_REUSEADDR         (0x0002)
+#define MICO_SO_BROADCAST         (0x0006)
+#define MICO_SO_KEEPALIVE         (0x0008)
+#define MICO_SO_BLOCKMODE         (0x1000)
+#define MICO_SO_SNDTIMEO          (0x1005)
+#define MICO_SO_RCVTIMEO          (0x1006)
+#define MICO_SO_ERROR             (0x1007)
+#define MICO_SO_TYPE              (0x1008)
+#define MICO_SO_NO_CHECK          (0x100a)
+
+#define MICO_IP_ADD_MEMBERSHIP    (0x0003)
+#define MICO_IP_DROP_MEMBERSHIP   (0x0004)
+
+#define MICO_TCP_KEEPIDLE         (0x0003)
+#define MICO_TCP_KEEPINTVL        (0x0004)
+#define MICO_TCP_KEEPCNT          (0x0005)
+
+/* Connecting sockets are waited for like lwIP does in the MICO library */
+#define CONNECT_TIMEOUT_MS        (10000)
+/* lwIP blocks a receive for 1 second when no SO_RCVTIMEO is given */
+#define DEFAULT_RCVTIMEO_MS       (1000)
+
+/******************************************************
+*                    Structures
+******************************************************/
+
+struct mico_sockaddr_t {
+  uint16_t s_type;
+  uint16_t s_port;
+  uint32_t s_ip;
+  uint16_t s_spares[6];
+};
+
+struct mico_timeval_t {
+  unsigned long tv_sec;
+  unsigned long tv_usec;
+};
+
+typedef struct {
+  unsigned long fds_bits[( MICO_FD_SETSIZE + MICO_NFDBITS - 1 ) / MICO_NFDBITS];
+} mico_fd_set_t;
+
+typedef struct {
+  int  fd;            /* host socket, -1 when the slot is free */
+  int  type;          /* MICO_SOCK_STREAM or MICO_SOCK_DGRM */
+  bool non_block;     /* SO_BLOCKMODE */
+  bool active;        /* TCP: connected or listening */
+} host_socket_t;
+
+/******************************************************
+*               Function Declarations
+******************************************************/
+
+/* mico_system_notification.c */
+extern void socket_connected( int fd );
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+static host_socket_t    host_sockets[MICO_FD_SETSIZE];
+static pthread_mutex_t  host_socket_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t   host_socket_once = PTHREAD_ONCE_INIT;
+
+static int tcp_keepalive_max_err = 5;
+static int tcp_keepalive_seconds = 10;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static void host_socket_table_init( void )
+{
+  int i;
+  for ( i = 0; i < MICO_FD_SETSIZE; i++ )
+    host_sockets[i].fd = -1;
+}
+
+static host_socket_t* host_socket_get( int sockfd )
+{
+  pthread_once( &host_socket_once, host_socket_table_init );
+  if ( sockfd < 0 || sockfd >= MICO_FD_SETSIZE || host_sockets[sockfd].fd < 0 )
+  {
+    errno = EBADF;
+    return NULL;
+  }
+  return &host_sockets[sockfd];
+}
+
+static int host_socket_alloc( int fd, int type )
+{
+  int i;
+
+  pthread_once( &host_socket_once, host_socket_table_init );
+  pthread_mutex_lock( &host_socket_mutex );
+  for ( i = 0; i < MICO_FD_SETSIZE; i++ )
+  {
+    if ( host_sockets[i].fd < 0 )
+    {
+      host_sockets[i].fd = fd;
+      host_sockets[i].type = type;
+      host_sockets[i].non_block = false;
+      host_sockets[i].active = ( type != MICO_SOCK_STREAM );
+      break;
+    }
+  }
+  pthread_mutex_unlock( &host_socket_mutex );
+
+  if ( i == MICO_FD_SETSIZE )
+  {
+    close( fd );
+    errno = ENFILE;
+    return -1;
+  }
+  return i;
+}
+
+static void mico_to_sockaddr( const struct mico_sockaddr_t* addr, struct sockaddr_in* sin )
+{
+  memset( sin, 0, sizeof(struct sockaddr_in) );
+  sin->sin_family = AF_INET;
+  sin->sin_port = htons( addr->s_port );
+  sin->sin_addr.s_addr = htonl( addr->s_ip );
+}
+
+static void sockaddr_to_mico( const struct sockaddr_in* sin, struct mico_sockaddr_t* addr )
+{
+  memset( addr, 0, sizeof(struct mico_sockaddr_t) );
+  addr->s_type = AF_INET;
+  addr->s_port = ntohs( sin->sin_port );
+  addr->s_ip = ntohl( sin->sin_addr.s_addr );
+}
+
+static int timeval_to_ms( const struct mico_timeval_t* tv )
+{
+  if ( tv == NULL )
+    return -1;
+  return (int)( tv->tv_sec * 1000 + ( tv->tv_usec + 999 ) / 1000 );
+}
+
+static void ms_to_timeval( int ms, struct timeval* tv )
+{
+  tv->tv_sec = ms / 1000;
+  tv->tv_usec = ( ms % 1000 ) * 1000;
+}
+
+int host_socket( int domain, int type, int protocol )
+{
+  int fd;
+  struct timeval tv;
+
+  (void)domain;
+  (void)protocol;
+
+  if ( type == MICO_SOCK_STREAM )
+    fd = socket( AF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP );
+  else if ( type == MICO_SOCK_DGRM )
+    fd = socket( AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_UDP );
+  else
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  if ( fd < 0 )
+    return -1;
+
+  ms_to_timeval( DEFAULT_RCVTIMEO_MS, &tv );
+  setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv) );
+  return host_socket_alloc( fd, type );
+}
+
+/* mico_rtos_host.c: the read end of the pipe of an event fd */
+int host_socket_event( int fd )
+{
+  return host_socket_alloc( fd, HOST_SOCK_EVENT );
+}
+
+int host_setsockopt( int sockfd, int level, int optname, const void *optval, int optlen )
+{
+  host_socket_t* s = host_socket_get( sockfd );
+  int value;
+  struct timeval tv;
+
+  if ( s == NULL )
+    return -1;
+  if ( optval == NULL || optlen < (int)sizeof(int) )
+  {
+    errno = EINVAL;
+    return -1;
+  }
+  value = *(const int *)optval;
+
+  /* The SO_* options are also given with level 0 by the WiFiMCU modules */
+  if ( level == MICO_SOL_SOCKET || ( level == MICO_IPPROTO_IP && optname >= MICO_SO_BLOCKMODE ) )
+  {
+    switch ( optname )
+    {
+      case MICO_SO_BLOCKMODE:
+      {
+        int flags = fcntl( s->fd, F_GETFL );
+        s->non_block = ( value != 0 );
+        flags = s->non_block ? ( flags | O_NONBLOCK ) : ( flags & ~O_NONBLOCK );
+        return fcntl( s->fd, F_SETFL, flags );
+      }
+      case MICO_SO_SNDTIMEO:
+        ms_to_timeval( value, &tv );
+        return setsockopt( s->fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv) );
+      case MICO_SO_RCVTIMEO:
+        ms_to_timeval( value, &tv );
+        return setsockopt( s->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv) );
+      case MICO_SO_REUSEADDR:
+        return setsockopt( s->fd, SOL_SOCKET, SO_REUSEADDR, &value, sizeof(value) );
+      case MICO_SO_BROADCAST:
+        return setsockopt( s->fd, SOL_SOCKET, SO_BROADCAST, &value, sizeof(value) );
+      case MICO_SO_KEEPALIVE:
+        return setsockopt( s->fd, SOL_SOCKET, SO_KEEPALIVE, &value, sizeof(value) );
+      case MICO_SO_NO_CHECK:
+        return 0;
+    }
+  }
+  else if ( level == MICO_IPPROTO_IP )
+  {
+    if ( optname == MICO_IP_ADD_MEMBERSHIP || optname == MICO_IP_DROP_MEMBERSHIP )
+    {
+      /* lwIP's ip_mreq holds the addresses in network order, like the host one */
+      if ( optlen < (int)sizeof(struct ip_mreq) )
+      {
+        errno = EINVAL;
+        return -1;
+      }
+      return setsockopt( s->fd, IPPROTO_IP,
+                         optname == MICO_IP_ADD_MEMBERSHIP ? IP_ADD_MEMBERSHIP : IP_DROP_MEMBERSHIP,
+                         optval, sizeof(struct ip_mreq) );
+    }
+  }
+  else if ( level == MICO_IPPROTO_TCP )
+  {
+    switch ( optname )
+    {
+      case MICO_TCP_KEEPIDLE:
+        return setsockopt( s->fd, IPPROTO_TCP, TCP_KEEPIDLE, &value, sizeof(value) );
+      case MICO_TCP_KEEPINTVL:
+        return setsockopt( s->fd, IPPROTO_TCP, TCP_KEEPINTVL, &value, sizeof(value) );
+      case MICO_TCP_KEEPCNT:
+        return setsockopt( s->fd, IPPROTO_TCP, TCP_KEEPCNT, &value, sizeof(value) );
+    }
+  }
+
+  errno = ENOPROTOOPT;
+  return -1;
+}
+
+int host_getsockopt( int sockfd, int level, int optname, const void *optval, int *optlen )
+{
+  host_socket_t* s = host_socket_get( sockfd );
+  int *value = (int *)optval;
+  socklen_t len = sizeof(int);
+
+  (void)level;
+
+  if ( s == NULL )
+    return -1;
+  if ( value == NULL || optlen == NULL || *optlen < (int)sizeof(int) )
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  switch ( optname )
+  {
+    case MICO_SO_ERROR:
+      if ( getsockopt( s->fd, SOL_SOCKET, SO_ERROR, value, &len ) < 0 )
+        return -1;
+      break;
+    case MICO_SO_TYPE:
+      *value = s->type;
+      break;
+    case MICO_SO_BLOCKMODE:
+      *value = s->non_block;
+      break;
+    default:
+      errno = ENOPROTOOPT;
+      return -1;
+  }
+  *optlen = sizeof(int);
+  return 0;
+}
+
+int host_bind( int sockfd, const struct mico_sockaddr_t *addr, int addrlen )
+{
+  host_socket_t* s = host_socket_get( sockfd );
+  struct sockaddr_in sin;
+  int on = 1;
+
+  (void)addrlen;
+
+  if ( s == NULL )
+    return -1;
+
+  /* The target rebinds a port as soon as it is closed, so does the host */
+  setsockopt( s->fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on) );
+  mico_to_sockaddr( addr, &sin );
+  return bind( s->fd, (struct sockaddr *)&sin, sizeof(sin) );
+}
+
+int host_connect( int sockfd, const struct mico_sockaddr_t *addr, int addrlen )
+{
+  host_socket_t* s = host_socket_get( sockfd );
+  struct sockaddr_in sin;
+  struct pollfd pfd;
+  int err = 0;
+  socklen_t len = sizeof(err);
+
+  (void)addrlen;
+
+  if ( s == NULL )
+    return -1;
+
+  mico_to_sockaddr( addr, &sin );
+  if ( connect( s->fd, (struct sockaddr *)&sin, sizeof(sin) ) < 0 )
+  {
+    if ( errno != EINPROGRESS )
+      return -1;
+
+    /* Finish the handshake here, the caller learns about it through the
+     * TCP_CLIENT_CONNECTED notification just like on the target */
+    pfd.fd = s->fd;
+    pfd.events = POLLOUT;
+    if ( poll( &pfd, 1, CONNECT_TIMEOUT_MS ) <= 0 )
+    {
+      errno = ETIMEDOUT;
+      return -1;
+    }
+    if ( getsockopt( s->fd, SOL_SOCKET, SO_ERROR, &err, &len ) < 0 || err != 0 )
+    {
+      errno = err;
+      return -1;
+    }
+  }
+
+  if ( s->type == MICO_SOCK_STREAM )
+  {
+    s->active = true;
+    socket_connected( sockfd );
+  }
+  return 0;
+}
+
+int host_listen( int sockfd, int backlog )
+{
+  host_socket_t* s = host_socket_get( sockfd );
+
+  if ( s == NULL )
+    return -1;
+  if ( listen( s->fd, backlog > 0 ? backlog : SOMAXCONN ) < 0 )
+    return -1;
+  s->active = true;
+  return 0;
+}
+
+int host_accept( int sockfd, struct mico_sockaddr_t *addr, int *addrlen )
+{
+  host_socket_t* s = host_socket_get( sockfd );
+  struct sockaddr_in sin;
+  socklen_t len = sizeof(sin);
+  struct timeval tv;
+  int fd;
+
+  if ( s == NULL )
+    return -1;
+
+  fd = accept4( s->fd, (struct sockaddr *)&sin, &len, SOCK_CLOEXEC );
+  if ( fd < 0 )
+    return -1;
+
+  ms_to_timeval( DEFAULT_RCVTIMEO_MS, &tv );
+  setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv) );
+
+  if ( addr != NULL )
+    sockaddr_to_mico( &sin, addr );
+  if ( addrlen != NULL )
+    *addrlen = sizeof(struct mico_sockaddr_t);
+  fd = host_socket_alloc( fd, MICO_SOCK_STREAM );
+  if ( fd >= 0 )
+    host_sockets[fd].active = true;
+  return fd;
+}
+
+int host_select( int nfds, mico_fd_set_t *readfds, mico_fd_set_t *writefds, mico_fd_set_t *exceptfds, struct mico_timeval_t *timeout )
+{
+  struct pollfd pfds[MICO_FD_SETSIZE];
+  int mico_fd[MICO_FD_SETSIZE];
+  int count = 0, ready = 0;
+  int i, n;
+
+#define MICO_FD_ISSET( fd, set )  ( (set) != NULL && ( (set)->fds_bits[(fd) / MICO_NFDBITS] & ( 1ul << ( (fd) % MICO_NFDBITS ) ) ) )
+
+  /* The MICO select looks at every descriptor in the sets whatever nfds
+   * says, httpd.c passes 1 */
+  (void)nfds;
+
+  for ( i = 0; i < MICO_FD_SETSIZE; i++ )
+  {
+    short events = 0;
+    if ( MICO_FD_ISSET( i, readfds ) )   events |= POLLIN;
+    if ( MICO_FD_ISSET( i, writefds ) )  events |= POLLOUT;
+    if ( MICO_FD_ISSET( i, exceptfds ) ) events |= POLLPRI;
+    if ( events == 0 )
+      continue;
+    if ( host_socket_get( i ) == NULL )
+      return -1;
+    /* Linux reports a TCP socket that is not connected yet as hung up,
+     * lwIP does not report it at all */
+    if ( !host_sockets[i].active )
+      continue;
+    pfds[count].fd = host_sockets[i].fd;
+    pfds[count].events = events;
+    pfds[count].revents = 0;
+    mico_fd[count++] = i;
+  }
+
+  n = poll( pfds, count, timeval_to_ms( timeout ) );
+  if ( n < 0 )
+    return -1;
+
+  if ( readfds != NULL )   memset( readfds, 0, sizeof(mico_fd_set_t) );
+  if ( writefds != NULL )  memset( writefds, 0, sizeof(mico_fd_set_t) );
+  if ( exceptfds != NULL ) memset( exceptfds, 0, sizeof(mico_fd_set_t) );
+
+  for ( i = 0; i < count && n > 0; i++ )
+  {
+    unsigned long bit = 1ul << ( mico_fd[i] % MICO_NFDBITS );
+    int word = mico_fd[i] / MICO_NFDBITS;
+
+    /* A closed or failed peer reads as end of file, like lwIP reports it */
+    if ( readfds != NULL && ( pfds[i].revents & ( POLLIN | POLLHUP | POLLERR ) ) && ( pfds[i].events & POLLIN ) )
+    {
+      readfds->fds_bits[word] |= bit;
+      ready++;
+    }
+    if ( writefds != NULL && ( pfds[i].revents & ( POLLOUT | POLLERR ) ) && ( pfds[i].events & POLLOUT ) )
+    {
+      writefds->fds_bits[word] |= bit;
+      ready++;
+    }
+    if ( exceptfds != NULL && ( pfds[i].revents & POLLPRI ) )
+    {
+      exceptfds->fds_bits[word] |= bit;
+      ready++;
+    }
+  }
+
+#undef MICO_FD_ISSET
+
+  return ready;
+}
+
+ssize_t host_send( int sockfd, const void *buf, size_t len, int flags )
+{
+  host_socket_t* s = host_socket_get( sockfd );
+
+  (void)flags;
+
+  if ( s == NULL )
+    return -1;
+  return send( s->fd, buf, len, MSG_NOSIGNAL );
+}
+
+int host_write( int sockfd, void *buf, size_t len )
+{
+  return (int)host_send( sockfd, buf, len, 0 );
+}
+
+ssize_t host_sendto( int sockfd, const void *buf, size_t len, int flags, const struct mico_sockaddr_t *dest_addr, int addrlen )
+{
+  host_socket_t* s = host_socket_get( sockfd );
+  struct sockaddr_in sin;
+
+  (void)flags;
+  (void)addrlen;
+
+  if ( s == NULL )
+    return -1;
+  if ( dest_addr == NULL )
+    return send( s->fd, buf, len, MSG_NOSIGNAL );
+
+  mico_to_sockaddr( dest_addr, &sin );
+  return sendto( s->fd, buf, len, MSG_NOSIGNAL, (struct sockaddr *)&sin, sizeof(sin) );
+}
+
+ssize_t host_recv( int sockfd, void *buf, size_t len, int flags )
+{
+  host_socket_t* s = host_socket_get( sockfd );
+
+  (void)flags;
+
+  if ( s == NULL )
+    return -1;
+  return recv( s->fd, buf, len, 0 );
+}
+
+int host_read( int sockfd, void *buf, size_t len )
+{
+  return (int)host_recv( sockfd, buf, len, 0 );
+}
+
+ssize_t host_recvfrom( int sockfd, void *buf, size_t len, int flags, struct mico_sockaddr_t *src_addr, int *addrlen )
+{
+  host_socket_t* s = host_socket_get( sockfd );
+  struct sockaddr_in sin;
+  socklen_t sin_len = sizeof(sin);
+  ssize_t n;
+
+  (void)flags;
+
+  if ( s == NULL )
+    return -1;
+
+  memset( &sin, 0, sizeof(sin) );
+  n = recvfrom( s->fd, buf, len, 0, (struct sockaddr *)&sin, &sin_len );
+  if ( n >= 0 && src_addr != NULL )
+    sockaddr_to_mico( &sin, src_addr );
+  if ( n >= 0 && addrlen != NULL )
+    *addrlen = sizeof(struct mico_sockaddr_t);
+  return n;
+}
+
+int host_close( int fd )
+{
+  host_socket_t* s = host_socket_get( fd );
+  int host_fd;
+
+  if ( s == NULL )
+    return -1;
+
+  pthread_mutex_lock( &host_socket_mutex );
+  host_fd = s->fd;
+  s->fd = -1;
+  pthread_mutex_unlock( &host_socket_mutex );
+  return close( host_fd );
+}
+
+uint32_t host_inet_addr( char *s )
+{
+  struct in_addr addr;
+
+  if ( s == NULL || inet_pton( AF_INET, s, &addr ) != 1 )
+    return 0;
+  return ntohl( addr.s_addr );
+}
+
+char *host_inet_ntoa( char *s, uint32_t x )
+{
+  sprintf( s, "%u.%u.%u.%u", (unsigned)( x >> 24 ) & 0xff, (unsigned)( x >> 16 ) & 0xff,
+           (unsigned)( x >> 8 ) & 0xff, (unsigned)x & 0xff );
+  return s;
+}
+
+int host_gethostbyname( const char *name, uint8_t *addr, uint8_t addrLen )
+{
+  struct addrinfo hints, *res = NULL;
+  char ip[INET_ADDRSTRLEN];
+
+  memset( &hints, 0, sizeof(hints) );
+  hints.ai_family = AF_INET;
+  if ( name == NULL || addr == NULL || getaddrinfo( name, NULL, &hints, &res ) != 0 )
+    return -1;
+
+  inet_ntop( AF_INET, &( (struct sockaddr_in *)res->ai_addr )->sin_addr, ip, sizeof(ip) );
+  freeaddrinfo( res );
+  if ( strlen( ip ) >= addrLen )
+    return -1;
+  strcpy( (char *)addr, ip );
+  return 0;
+}
+
+void set_tcp_keepalive( int inMaxErrNum, int inSeconds )
+{
+  tcp_keepalive_max_err = inMaxErrNum;
+  tcp_keepalive_seconds = inSeconds;
+}
+
+void get_tcp_keepalive( int *outMaxErrNum, int *outSeconds )
+{
+  *outMaxErrNum = tcp_keepalive_max_err;
+  *outSeconds = tcp_keepalive_seconds;
+}
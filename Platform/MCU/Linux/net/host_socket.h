@@ -0,0 +1,35 @@
+/**
+******************************************************************************
+* @file    host_socket.h
+* @version V1.0.0
+* @brief   Link names of the MICO socket API on the Linux host platform.
+*          mico_socket.h declares socket(), select(), read(), close() ...
+*          with MICO types, this header is force included in front of the
+*          firmware sources so those calls reach host_socket.c instead of
+*          libc.
+******************************************************************************
+*/
+
+#ifndef __HOST_SOCKET_H__
+#define __HOST_SOCKET_H__
+
+#define socket          host_socket
+#define setsockopt      host_setsockopt
+#define getsockopt      host_getsockopt
+#define bind            host_bind
+#define connect         host_connect
+#define listen          host_listen
+#define accept          host_accept
+#define select          host_select
+#define send            host_send
+#define write           host_write
+#define sendto          host_sendto
+#define recv            host_recv
+#define read            host_read
+#define recvfrom        host_recvfrom
+#define close           host_close
+#define inet_addr       host_inet_addr
+#define inet_ntoa       host_inet_ntoa
+#define gethostbyname   host_gethostbyname
+
+#endif
@@ -0,0 +1,124 @@
+/**
+******************************************************************************
+* @file    host_wlan.c
+* @version V1.0.0
+* @brief   The wlan API of mico_wlan.h on the Linux host platform. The host
+*          network is always up: the station link reports connected and the
+*          IP status is read from the first IPv4 interface of the host.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+
+#include "Common.h"
+#include "mico_wlan.h"
+#include "system.h"
+
+/******************************************************
+*               Function Declarations
+******************************************************/
+
+/* mico_system_notification.c */
+extern void WifiStatusHandler( notify_wlan_t status );
+extern void NetCallback( IPStatusTypedef *pnet );
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static void host_ip_status( IPStatusTypedef *outNetpara )
+{
+  struct ifaddrs *ifaddr, *ifa;
+
+  memset( outNetpara, 0, sizeof(IPStatusTypedef) );
+  outNetpara->dhcp = DHCP_Client;
+  strcpy( outNetpara->ip, "127.0.0.1" );
+  strcpy( outNetpara->mask, "255.0.0.0" );
+  strcpy( outNetpara->gate, "127.0.0.1" );
+  strcpy( outNetpara->dns, "127.0.0.1" );
+  strcpy( outNetpara->broadcastip, "127.255.255.255" );
+  strcpy( outNetpara->mac, "C89346000000" );
+
+  if ( getifaddrs( &ifaddr ) != 0 )
+    return;
+
+  for ( ifa = ifaddr; ifa != NULL; ifa = ifa->ifa_next )
+  {
+    if ( ifa->ifa_addr == NULL || ifa->ifa_addr->sa_family != AF_INET )
+      continue;
+    if ( ifa->ifa_flags & IFF_LOOPBACK )
+      continue;
+
+    inet_ntop( AF_INET, &( (struct sockaddr_in *)ifa->ifa_addr )->sin_addr, outNetpara->ip, 16 );
+    strcpy( outNetpara->gate, outNetpara->ip );
+    strcpy( outNetpara->dns, outNetpara->ip );
+    if ( ifa->ifa_netmask != NULL )
+      inet_ntop( AF_INET, &( (struct sockaddr_in *)ifa->ifa_netmask )->sin_addr, outNetpara->mask, 16 );
+    if ( ( ifa->ifa_flags & IFF_BROADCAST ) && ifa->ifa_broadaddr != NULL )
+      inet_ntop( AF_INET, &( (struct sockaddr_in *)ifa->ifa_broadaddr )->sin_addr, outNetpara->broadcastip, 16 );
+    break;
+  }
+  freeifaddrs( ifaddr );
+}
+
+OSStatus micoWlanStart( network_InitTypeDef_st* inNetworkInitPara )
+{
+  IPStatusTypedef netpara;
+
+  if ( inNetworkInitPara == NULL )
+    return kParamErr;
+
+  /* Report the link the way the wlan driver does once it is up */
+  WifiStatusHandler( inNetworkInitPara->wifi_mode == Soft_AP ? NOTIFY_AP_UP : NOTIFY_STATION_UP );
+  host_ip_status( &netpara );
+  NetCallback( &netpara );
+  return kNoErr;
+}
+
+OSStatus micoWlanGetLinkStatus( LinkStatusTypeDef *outStatus )
+{
+  if ( outStatus == NULL )
+    return kParamErr;
+
+  memset( outStatus, 0, sizeof(LinkStatusTypeDef) );
+  outStatus->is_connected = 1;
+  outStatus->wifi_strength = 100;
+  strcpy( (char *)outStatus->ssid, "host" );
+  outStatus->channel = 1;
+  return kNoErr;
+}
+
+OSStatus micoWlanGetIPStatus( IPStatusTypedef *outNetpara, WiFi_Interface inInterface )
+{
+  UNUSED_PARAMETER( inInterface );
+
+  if ( outNetpara == NULL )
+    return kParamErr;
+
+  host_ip_status( outNetpara );
+  return kNoErr;
+}
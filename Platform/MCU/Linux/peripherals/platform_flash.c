@@ -0,0 +1,333 @@
+/**
+******************************************************************************
+* @file    platform_flash.c
+* @version V1.0.0
+* @brief   This file provides flash operation functions for the Linux host
+*          platform. Each flash device is a RAM image with NOR semantics:
+*          erase sets a whole sector to 0xFF and writes can only clear bits.
+*          An image file keeps the contents over resets, a ".wear" file next
+*          to it keeps the erase count of every sector.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "PlatformLogging.h"
+#include "platform_peripheral.h"
+#include "platform.h"
+#include "platform_config.h"
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define HOST_FLASH_DEVICES    (FLASH_TYPE_SPI + 1)
+
+/******************************************************
+*                    Structures
+******************************************************/
+
+typedef struct
+{
+  uint8_t*  data;
+  uint32_t* erase_count;
+  uint32_t  length;
+  uint32_t  erases;
+  uint32_t  bad_writes;
+  int       image_fd;
+  int       wear_fd;
+  char*     image_path;
+} host_flash_t;
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+static host_flash_t host_flash[HOST_FLASH_DEVICES] =
+{
+  [FLASH_TYPE_EMBEDDED] = { .image_fd = -1, .wear_fd = -1 },
+  [FLASH_TYPE_SPI]      = { .image_fd = -1, .wear_fd = -1 },
+};
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static int open_backing_file( const char* path, const char* suffix, void* contents, size_t size, uint8_t blank )
+{
+  char name[256];
+  int fd;
+
+  snprintf( name, sizeof(name), "%s%s", path, suffix );
+  fd = open( name, O_RDWR | O_CREAT | O_CLOEXEC, 0644 );
+  if ( fd < 0 )
+    return -1;
+
+  /* A new or truncated file starts out blank */
+  if ( pread( fd, contents, size, 0 ) != (ssize_t)size )
+  {
+    memset( contents, blank, size );
+    if ( pwrite( fd, contents, size, 0 ) != (ssize_t)size )
+    {
+      close( fd );
+      return -1;
+    }
+  }
+  return fd;
+}
+
+static OSStatus host_flash_init( const platform_flash_t* peripheral )
+{
+  host_flash_t* flash = &host_flash[peripheral->flash_type];
+  uint32_t sectors = ( peripheral->flash_length + HOST_FLASH_SECTOR_SIZE - 1 ) / HOST_FLASH_SECTOR_SIZE;
+  OSStatus err = kNoErr;
+
+  if ( flash->data != NULL )
+    goto exit;
+
+  flash->data = malloc( peripheral->flash_length );
+  flash->erase_count = calloc( sectors, sizeof(uint32_t) );
+  require_action( flash->data && flash->erase_count, exit, err = kNoMemoryErr );
+  flash->length = peripheral->flash_length;
+  memset( flash->data, 0xFF, flash->length );
+
+  if ( flash->image_path != NULL )
+  {
+    flash->image_fd = open_backing_file( flash->image_path, "", flash->data, flash->length, 0xFF );
+    require_action( flash->image_fd >= 0, exit, err = kOpenErr );
+    flash->wear_fd = open_backing_file( flash->image_path, ".wear", flash->erase_count, sectors * sizeof(uint32_t), 0 );
+    require_action( flash->wear_fd >= 0, exit, err = kOpenErr );
+  }
+
+exit:
+  if ( err != kNoErr )
+    platform_log( "flash %d: no simulated device, err %d", peripheral->flash_type, err );
+  return err;
+}
+
+static void host_flash_sync( host_flash_t* flash, uint32_t offset, uint32_t length )
+{
+  if ( flash->image_fd >= 0 && pwrite( flash->image_fd, flash->data + offset, length, offset ) != (ssize_t)length )
+    platform_log( "flash image write failed" );
+}
+
+static void host_flash_sync_wear( host_flash_t* flash, uint32_t sector )
+{
+  off_t offset = (off_t)sector * sizeof(uint32_t);
+  if ( flash->wear_fd >= 0 && pwrite( flash->wear_fd, &flash->erase_count[sector], sizeof(uint32_t), offset ) != sizeof(uint32_t) )
+    platform_log( "flash wear write failed" );
+}
+
+static void host_flash_erase( host_flash_t* flash, uint32_t start, uint32_t end )
+{
+  uint32_t sector;
+
+  /* Erase works on whole sectors, like the STM32 and SPI flash drivers */
+  for ( sector = start / HOST_FLASH_SECTOR_SIZE; sector <= end / HOST_FLASH_SECTOR_SIZE; sector++ )
+  {
+    uint32_t offset = sector * HOST_FLASH_SECTOR_SIZE;
+    uint32_t length = MIN( HOST_FLASH_SECTOR_SIZE, flash->length - offset );
+
+    memset( flash->data + offset, 0xFF, length );
+    host_flash_sync( flash, offset, length );
+    flash->erase_count[sector]++;
+    flash->erases++;
+    host_flash_sync_wear( flash, sector );
+  }
+}
+
+static void host_flash_write( host_flash_t* flash, uint32_t offset, const uint8_t* data, uint32_t length )
+{
+  uint32_t i;
+  bool bad_write = false;
+
+  for ( i = 0; i < length; i++ )
+  {
+    /* NOR flash can only clear bits, 0 -> 1 needs an erase */
+    if ( ( flash->data[offset + i] & data[i] ) != data[i] )
+      bad_write = true;
+    flash->data[offset + i] &= data[i];
+  }
+  if ( bad_write )
+  {
+    flash->bad_writes++;
+    platform_log( "flash write over unerased data at 0x%08x", (unsigned int)offset );
+  }
+  host_flash_sync( flash, offset, length );
+}
+
+OSStatus platform_flash_host_set_image( platform_flash_type_t type, const char* path )
+{
+  OSStatus err = kNoErr;
+
+  require_action_quiet( type < HOST_FLASH_DEVICES, exit, err = kParamErr );
+  require_action_quiet( host_flash[type].data == NULL, exit, err = kStateErr );
+
+  free( host_flash[type].image_path );
+  host_flash[type].image_path = ( path != NULL ) ? strdup( path ) : NULL;
+
+exit:
+  return err;
+}
+
+OSStatus platform_flash_host_load( const platform_flash_t* peripheral, uint32_t start_address, const char* path )
+{
+  OSStatus err = kNoErr;
+  host_flash_t* flash;
+  uint8_t* contents = NULL;
+  uint32_t offset;
+  FILE* file = NULL;
+  long size;
+
+  require_action_quiet( peripheral != NULL && path != NULL, exit, err = kParamErr );
+  err = host_flash_init( peripheral );
+  require_noerr( err, exit );
+  flash = &host_flash[peripheral->flash_type];
+
+  file = fopen( path, "rb" );
+  require_action( file, exit, err = kOpenErr );
+  fseek( file, 0, SEEK_END );
+  size = ftell( file );
+  fseek( file, 0, SEEK_SET );
+
+  offset = start_address - peripheral->flash_start_addr;
+  require_action( size > 0 && start_address >= peripheral->flash_start_addr
+               && offset + (uint32_t)size <= flash->length, exit, err = kSizeErr );
+
+  contents = malloc( size );
+  require_action( contents, exit, err = kNoMemoryErr );
+  require_action( fread( contents, size, 1, file ) == 1, exit, err = kReadErr );
+
+  /* Programmed like the bootloader does it: erase, then write */
+  host_flash_erase( flash, offset, offset + size - 1 );
+  host_flash_write( flash, offset, contents, size );
+
+exit:
+  if ( file != NULL )
+    fclose( file );
+  free( contents );
+  return err;
+}
+
+OSStatus platform_flash_host_get_wear( const platform_flash_t* peripheral, platform_flash_wear_t* wear )
+{
+  OSStatus err = kNoErr;
+  host_flash_t* flash;
+  uint32_t sector;
+
+  require_action_quiet( peripheral != NULL && wear != NULL, exit, err = kParamErr );
+  flash = &host_flash[peripheral->flash_type];
+  require_action_quiet( flash->data != NULL, exit, err = kNotInitializedErr );
+
+  memset( wear, 0, sizeof(platform_flash_wear_t) );
+  wear->sectors = ( flash->length + HOST_FLASH_SECTOR_SIZE - 1 ) / HOST_FLASH_SECTOR_SIZE;
+  wear->erases = flash->erases;
+  wear->bad_writes = flash->bad_writes;
+  for ( sector = 0; sector < wear->sectors; sector++ )
+  {
+    wear->max_erase_count = Max( wear->max_erase_count, flash->erase_count[sector] );
+    if ( flash->erase_count[sector] > HOST_FLASH_ERASE_CYCLES )
+      wear->worn_sectors++;
+  }
+
+exit:
+  return err;
+}
+
+OSStatus platform_flash_init( const platform_flash_t *peripheral )
+{
+  OSStatus err = kNoErr;
+
+  require_action_quiet( peripheral != NULL, exit, err = kParamErr );
+  require_action_quiet( peripheral->flash_type < HOST_FLASH_DEVICES, exit, err = kTypeErr );
+
+  err = host_flash_init( peripheral );
+
+exit:
+  return err;
+}
+
+OSStatus platform_flash_erase( const platform_flash_t *peripheral, uint32_t start_address, uint32_t end_address )
+{
+  OSStatus err = kNoErr;
+
+  require_action_quiet( peripheral != NULL, exit, err = kParamErr );
+  require_action( start_address >= peripheral->flash_start_addr
+               && end_address   <= peripheral->flash_start_addr + peripheral->flash_length - 1, exit, err = kParamErr );
+  require_action_quiet( host_flash[peripheral->flash_type].data != NULL, exit, err = kNotInitializedErr );
+
+  host_flash_erase( &host_flash[peripheral->flash_type], start_address - peripheral->flash_start_addr, end_address - peripheral->flash_start_addr );
+
+exit:
+  return err;
+}
+
+OSStatus platform_flash_write( const platform_flash_t *peripheral, volatile uint32_t* start_address, uint8_t* data ,uint32_t length  )
+{
+  OSStatus err = kNoErr;
+
+  require_action_quiet( peripheral != NULL, exit, err = kParamErr );
+  require_action( *start_address >= peripheral->flash_start_addr
+               && *start_address + length <= peripheral->flash_start_addr + peripheral->flash_length, exit, err = kParamErr );
+  require_action_quiet( host_flash[peripheral->flash_type].data != NULL, exit, err = kNotInitializedErr );
+
+  host_flash_write( &host_flash[peripheral->flash_type], *start_address - peripheral->flash_start_addr, data, length );
+  *start_address += length;
+
+exit:
+  return err;
+}
+
+OSStatus platform_flash_read( const platform_flash_t *peripheral, volatile uint32_t* start_address, uint8_t* data ,uint32_t length  )
+{
+  OSStatus err = kNoErr;
+
+  require_action_quiet( peripheral != NULL, exit, err = kParamErr );
+  require_action( ( *start_address >= peripheral->flash_start_addr )
+               && ( *start_address + length ) <= ( peripheral->flash_start_addr + peripheral->flash_length ), exit, err = kParamErr );
+  require_action_quiet( host_flash[peripheral->flash_type].data != NULL, exit, err = kNotInitializedErr );
+
+  memcpy( data, host_flash[peripheral->flash_type].data + ( *start_address - peripheral->flash_start_addr ), length );
+  *start_address += length;
+
+exit:
+  return err;
+}
+
+OSStatus platform_flash_enable_protect( const platform_flash_t *peripheral, uint32_t start_address, uint32_t end_address )
+{
+  UNUSED_PARAMETER( peripheral );
+  UNUSED_PARAMETER( start_address );
+  UNUSED_PARAMETER( end_address );
+  return kNoErr;
+}
+
+OSStatus platform_flash_disable_protect( const platform_flash_t *peripheral, uint32_t start_address, uint32_t end_address )
+{
+  UNUSED_PARAMETER( peripheral );
+  UNUSED_PARAMETER( start_address );
+  UNUSED_PARAMETER( end_address );
+  return kNoErr;
+}
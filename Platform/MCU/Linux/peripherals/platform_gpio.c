@@ -0,0 +1,156 @@
+/**
+******************************************************************************
+* @file    platform_gpio.c
+* @version V1.0.0
+* @brief   This file provides GPIO functions for the Linux host platform.
+*          Pins only keep their configuration and level: inputs read their
+*          pull resistor, outputs read back what was written, and enabled
+*          interrupts are remembered but never fire.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include "platform.h"
+#include "platform_peripheral.h"
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define PINS_PER_PORT         (16)
+
+/******************************************************
+*                    Structures
+******************************************************/
+
+typedef struct
+{
+  platform_pin_config_t         config;
+  bool                          initialized;
+  bool                          level;
+  platform_gpio_irq_trigger_t   trigger;
+  platform_gpio_irq_callback_t  handler;
+  void*                         arg;
+} host_gpio_t;
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+static host_gpio_t host_gpio[NUMBER_OF_GPIO_PORTS * PINS_PER_PORT];
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static host_gpio_t* host_gpio_get( const platform_gpio_t* gpio )
+{
+  if ( gpio == NULL || gpio->port >= NUMBER_OF_GPIO_PORTS || gpio->pin_number >= PINS_PER_PORT )
+    return NULL;
+  return &host_gpio[gpio->port * PINS_PER_PORT + gpio->pin_number];
+}
+
+OSStatus platform_gpio_init( const platform_gpio_t* gpio, platform_pin_config_t config )
+{
+  host_gpio_t* pin = host_gpio_get( gpio );
+  if ( pin == NULL )
+    return kParamErr;
+
+  pin->config = config;
+  pin->initialized = true;
+  /* An open drain or pulled up line idles high */
+  pin->level = ( config == INPUT_PULL_UP || config == OUTPUT_OPEN_DRAIN_PULL_UP || config == OUTPUT_OPEN_DRAIN_NO_PULL );
+  return kNoErr;
+}
+
+OSStatus platform_gpio_deinit( const platform_gpio_t* gpio )
+{
+  host_gpio_t* pin = host_gpio_get( gpio );
+  if ( pin == NULL )
+    return kParamErr;
+
+  memset( pin, 0, sizeof(host_gpio_t) );
+  return kNoErr;
+}
+
+OSStatus platform_gpio_output_high( const platform_gpio_t* gpio )
+{
+  host_gpio_t* pin = host_gpio_get( gpio );
+  if ( pin == NULL )
+    return kParamErr;
+
+  pin->level = true;
+  return kNoErr;
+}
+
+OSStatus platform_gpio_output_low( const platform_gpio_t* gpio )
+{
+  host_gpio_t* pin = host_gpio_get( gpio );
+  if ( pin == NULL )
+    return kParamErr;
+
+  pin->level = false;
+  return kNoErr;
+}
+
+OSStatus platform_gpio_output_trigger( const platform_gpio_t* gpio )
+{
+  host_gpio_t* pin = host_gpio_get( gpio );
+  if ( pin == NULL )
+    return kParamErr;
+
+  pin->level = !pin->level;
+  return kNoErr;
+}
+
+bool platform_gpio_input_get( const platform_gpio_t* gpio )
+{
+  host_gpio_t* pin = host_gpio_get( gpio );
+  if ( pin == NULL )
+    return false;
+
+  return pin->level;
+}
+
+OSStatus platform_gpio_irq_enable( const platform_gpio_t* gpio, platform_gpio_irq_trigger_t trigger, platform_gpio_irq_callback_t handler, void* arg )
+{
+  host_gpio_t* pin = host_gpio_get( gpio );
+  if ( pin == NULL || handler == NULL )
+    return kParamErr;
+
+  pin->trigger = trigger;
+  pin->handler = handler;
+  pin->arg = arg;
+  return kNoErr;
+}
+
+OSStatus platform_gpio_irq_disable( const platform_gpio_t* gpio )
+{
+  host_gpio_t* pin = host_gpio_get( gpio );
+  if ( pin == NULL )
+    return kParamErr;
+
+  pin->handler = NULL;
+  pin->arg = NULL;
+  return kNoErr;
+}
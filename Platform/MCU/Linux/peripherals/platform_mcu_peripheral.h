@@ -0,0 +1,232 @@
+/**
+******************************************************************************
+* @file    platform_mcu_peripheral.h
+* @version V1.0.0
+* @brief   This file provide all the headers of functions for the Linux host
+*          platform, peripherals are simulated with host resources.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#pragma once
+
+#include "mico_rtos.h"
+#include "RingBufferUtils.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************************************
+ *                      Macros
+ ******************************************************/
+
+/* The Cortex-M exclusive access intrinsics on GCC atomics: a store succeeds
+   if the word still holds what the load of the same thread read, which is
+   what the lock-free code of the firmware relies on */
+static __thread uint32_t host_exclusive_value;
+
+static inline uint32_t __LDREXW( volatile uint32_t* addr )
+{
+    host_exclusive_value = __atomic_load_n( addr, __ATOMIC_SEQ_CST );
+    return host_exclusive_value;
+}
+
+static inline uint32_t __STREXW( uint32_t value, volatile uint32_t* addr )
+{
+    uint32_t expected = host_exclusive_value;
+    return __atomic_compare_exchange_n( addr, &expected, value, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) ? 0 : 1;
+}
+
+#define __CLREX( )    do { } while ( 0 )
+#define __DMB( )      __atomic_thread_fence( __ATOMIC_SEQ_CST )
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+#define NUMBER_OF_GPIO_PORTS      (8)
+#define NUMBER_OF_UART_PORTS      (2)
+#define INVALID_UART_PORT_NUMBER  (0xff)
+#define NUMBER_OF_SPI_PORTS       (3)
+
+/* Erase unit of the simulated flash devices */
+#define HOST_FLASH_SECTOR_SIZE    (4096)
+
+/* Datasheet endurance of the SPI flash, sectors above it are reported worn */
+#define HOST_FLASH_ERASE_CYCLES   (100000)
+
+/******************************************************
+ *                   Enumerations
+ ******************************************************/
+
+typedef enum
+{
+    FLASH_TYPE_EMBEDDED,
+    FLASH_TYPE_SPI,
+} platform_flash_type_t;
+
+/* Where a simulated UART gets its bytes from */
+typedef enum
+{
+    UART_HOST_STDIO,    /* stdin/stdout of the process          */
+    UART_HOST_PTY,      /* a pseudo terminal opened on init     */
+} platform_uart_host_t;
+
+/******************************************************
+ *                 Type Definitions
+ ******************************************************/
+
+typedef uint8_t platform_gpio_port_t;
+
+/******************************************************
+ *                    Structures
+ ******************************************************/
+
+typedef struct
+{
+    platform_gpio_port_t  port;
+    uint8_t               pin_number;
+} platform_gpio_t;
+
+typedef struct
+{
+    uint8_t                channel;
+    const platform_gpio_t* pin;
+} platform_adc_t;
+
+typedef struct
+{
+    uint8_t                channel;
+    const platform_gpio_t* pin;
+} platform_pwm_t;
+
+typedef struct
+{
+    uint8_t                port;
+    const platform_gpio_t* pin_mosi;
+    const platform_gpio_t* pin_miso;
+    const platform_gpio_t* pin_clock;
+} platform_spi_t;
+
+typedef struct
+{
+    platform_spi_t*           peripheral;
+    mico_mutex_t              spi_mutex;
+} platform_spi_driver_t;
+
+typedef struct
+{
+    uint8_t unimplemented;
+} platform_spi_slave_driver_t;
+
+typedef struct
+{
+    uint8_t                port;
+    const platform_gpio_t* pin_scl;
+    const platform_gpio_t* pin_sda;
+} platform_i2c_t;
+
+typedef struct
+{
+    mico_mutex_t              i2c_mutex;
+} platform_i2c_driver_t;
+
+typedef void (* wakeup_irq_handler_t)(void *arg);
+
+typedef struct
+{
+    platform_uart_host_t   host;
+    const platform_gpio_t* pin_tx;
+    const platform_gpio_t* pin_rx;
+} platform_uart_t;
+
+typedef struct
+{
+    platform_uart_t*           peripheral;
+    ring_buffer_t*             rx_buffer;
+    mico_mutex_t               rx_mutex;
+    mico_semaphore_t           rx_complete;
+    mico_mutex_t               tx_mutex;
+    mico_thread_t              rx_thread;
+    int                        fd_in;
+    int                        fd_out;
+    volatile bool              initialized;
+    volatile uint32_t          rx_size;
+    uint8_t*                   rx_pending;      /* read from the host but not yet in rx_buffer */
+    uint32_t                   rx_pending_size;
+    volatile OSStatus          last_receive_result;
+    volatile OSStatus          last_transmit_result;
+} platform_uart_driver_t;
+
+typedef struct
+{
+    platform_flash_type_t      flash_type;
+    uint32_t                   flash_start_addr;
+    uint32_t                   flash_length;
+    uint32_t                   flash_protect_opt;
+} platform_flash_t;
+
+typedef struct
+{
+    const platform_flash_t*    peripheral;
+    mico_mutex_t               flash_mutex;
+    volatile bool              initialized;
+} platform_flash_driver_t;
+
+/* Wear statistics of one simulated flash device */
+typedef struct
+{
+    uint32_t                   sectors;
+    uint32_t                   erases;          /* sector erases since start    */
+    uint32_t                   max_erase_count; /* most erased sector, lifetime */
+    uint32_t                   worn_sectors;    /* above HOST_FLASH_ERASE_CYCLES */
+    uint32_t                   bad_writes;      /* writes that tried 0 -> 1     */
+} platform_flash_wear_t;
+
+/******************************************************
+ *                 Global Variables
+ ******************************************************/
+
+/******************************************************
+ *               Function Declarations
+ ******************************************************/
+
+OSStatus platform_flash_host_set_image( platform_flash_type_t type, const char* path );
+OSStatus platform_flash_host_load( const platform_flash_t* peripheral, uint32_t start_address, const char* path );
+OSStatus platform_flash_host_get_wear( const platform_flash_t* peripheral, platform_flash_wear_t* wear );
+
+OSStatus platform_rtc_init                   ( void );
+
+uint8_t  platform_uart_get_port_number       ( platform_uart_driver_t* driver );
+bool     platform_uart_host_eof              ( void );
+
+uint8_t  platform_host_boot_reason           ( void );
+void     platform_host_reset                 ( uint8_t boot_reason );
+void     platform_host_chip_id               ( uint32_t id[3] );
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
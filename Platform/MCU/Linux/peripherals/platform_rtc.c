@@ -0,0 +1,91 @@
+/**
+******************************************************************************
+* @file    platform_rtc.c
+* @version V1.0.0
+* @brief   This file provide RTC driver functions for the Linux host
+*          platform. The RTC runs on the host clock, setting it only stores
+*          the difference to the local time.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <time.h>
+
+#include "platform.h"
+#include "platform_peripheral.h"
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+/* Seconds between the simulated RTC and the host local time */
+static time_t rtc_offset = 0;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+OSStatus platform_rtc_init( void )
+{
+  rtc_offset = 0;
+  return kNoErr;
+}
+
+OSStatus platform_rtc_get_time( platform_rtc_time_t* rtc_time )
+{
+  time_t now;
+  struct tm tm;
+
+  if ( rtc_time == NULL )
+    return kParamErr;
+
+  now = time( NULL ) + rtc_offset;
+  localtime_r( &now, &tm );
+  rtc_time->sec     = tm.tm_sec;
+  rtc_time->min     = tm.tm_min;
+  rtc_time->hr      = tm.tm_hour;
+  rtc_time->weekday = ( tm.tm_wday == 0 ) ? 7 : tm.tm_wday;   /* Monday is 1 like on the STM32 */
+  rtc_time->date    = tm.tm_mday;
+  rtc_time->month   = tm.tm_mon + 1;
+  rtc_time->year    = tm.tm_year - 100;   /* the RTC counts from 2000 */
+  return kNoErr;
+}
+
+OSStatus platform_rtc_set_time( const platform_rtc_time_t* rtc_time )
+{
+  struct tm tm;
+
+  if ( rtc_time == NULL )
+    return kParamErr;
+
+  memset( &tm, 0, sizeof(tm) );
+  tm.tm_sec   = rtc_time->sec;
+  tm.tm_min   = rtc_time->min;
+  tm.tm_hour  = rtc_time->hr;
+  tm.tm_mday  = rtc_time->date;
+  tm.tm_mon   = rtc_time->month - 1;
+  tm.tm_year  = rtc_time->year + 100;
+  tm.tm_isdst = -1;
+  rtc_offset = mktime( &tm ) - time( NULL );
+  return kNoErr;
+}
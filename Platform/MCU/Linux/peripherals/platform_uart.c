@@ -0,0 +1,402 @@
+/**
+******************************************************************************
+* @file    platform_uart.c
+* @version V1.0.0
+* @brief   This file provides UART driver functions for the Linux host
+*          platform. A UART is either the stdin/stdout of the process or a
+*          pseudo terminal, a reader thread plays the part of the RX DMA and
+*          fills the ring buffer.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "platform_peripheral.h"
+#include "platform.h"
+#include "PlatformLogging.h"
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define UART_READ_CHUNK       (64)
+#define UART_PENDING_LIMIT    (4096)
+
+/* Ctrl-D, ends the Lua REPL when stdin is closed */
+#define UART_EOF_CHAR         (0x04)
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+extern platform_uart_t        platform_uart_peripherals[];
+extern platform_uart_driver_t platform_uart_drivers[];
+
+/* The pty master outlives deinit so the slave name stays the same */
+static int             pty_master = -1;
+
+static bool            stdin_is_tty = false;
+static struct termios  stdin_termios;
+static volatile bool   stdin_eof = false;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static void stdio_restore_terminal( void )
+{
+  if ( stdin_is_tty )
+    tcsetattr( STDIN_FILENO, TCSAFLUSH, &stdin_termios );
+}
+
+/* Raw input like a serial line, but keep ISIG so Ctrl-C still quits */
+static void stdio_raw_terminal( void )
+{
+  struct termios raw;
+
+  if ( stdin_is_tty || !isatty( STDIN_FILENO ) )
+    return;
+
+  tcgetattr( STDIN_FILENO, &stdin_termios );
+  stdin_is_tty = true;
+  atexit( stdio_restore_terminal );
+
+  raw = stdin_termios;
+  raw.c_iflag &= ~( ICRNL | IXON | INLCR | IGNCR );
+  raw.c_lflag &= ~( ICANON | ECHO | IEXTEN );
+  raw.c_cc[VMIN]  = 1;
+  raw.c_cc[VTIME] = 0;
+  tcsetattr( STDIN_FILENO, TCSAFLUSH, &raw );
+}
+
+static int pty_open( void )
+{
+  struct termios raw;
+
+  if ( pty_master >= 0 )
+    return pty_master;
+
+  pty_master = posix_openpt( O_RDWR | O_NOCTTY | O_CLOEXEC );
+  if ( pty_master < 0 )
+    return -1;
+
+  grantpt( pty_master );
+  unlockpt( pty_master );
+  tcgetattr( pty_master, &raw );
+  cfmakeraw( &raw );
+  tcsetattr( pty_master, TCSANOW, &raw );
+  fprintf( stderr, "UART%d: %s\r\n", MICO_UART_2 + 1, ptsname( pty_master ) );
+  return pty_master;
+}
+
+uint8_t platform_uart_get_port_number( platform_uart_driver_t* driver )
+{
+  if ( driver >= platform_uart_drivers && driver < platform_uart_drivers + NUMBER_OF_UART_PORTS )
+    return (uint8_t)( driver - platform_uart_drivers );
+  return INVALID_UART_PORT_NUMBER;
+}
+
+bool platform_uart_host_eof( void )
+{
+  return stdin_eof;
+}
+
+/* Queue host input in front of (or behind) what is already pending */
+static void uart_rx_pending_add( platform_uart_driver_t* driver, const uint8_t* data, uint32_t size, bool in_front )
+{
+  uint8_t* pending = realloc( driver->rx_pending, driver->rx_pending_size + size );
+
+  if ( pending == NULL )
+    return;
+  if ( in_front )
+  {
+    memmove( pending + size, pending, driver->rx_pending_size );
+    memcpy( pending, data, size );
+  }
+  else
+    memcpy( pending + driver->rx_pending_size, data, size );
+  driver->rx_pending = pending;
+  driver->rx_pending_size += size;
+}
+
+/* Move pending input into the ring buffer, rx_mutex must be held */
+static void uart_rx_refill( platform_uart_driver_t* driver )
+{
+  uint32_t written;
+
+  if ( !driver->initialized || driver->rx_pending_size == 0 )
+    return;
+
+  /* ring_buffer_write() fills the last slot too, which reads back as empty */
+  written = driver->rx_buffer->size - 1 - ring_buffer_used_space( driver->rx_buffer );
+  written = ring_buffer_write( driver->rx_buffer, driver->rx_pending, MIN( written, driver->rx_pending_size ) );
+  driver->rx_pending_size -= written;
+  memmove( driver->rx_pending, driver->rx_pending + written, driver->rx_pending_size );
+
+  if ( driver->rx_size > 0 && ring_buffer_used_space( driver->rx_buffer ) >= driver->rx_size )
+  {
+    driver->rx_size = 0;
+    mico_rtos_set_semaphore( &driver->rx_complete );
+  }
+}
+
+/* Input is never dropped: the reader waits like RTS would while too much
+ * is pending, and a closed port keeps what arrives for the next init */
+static void uart_rx_store( platform_uart_driver_t* driver, const uint8_t* data, uint32_t size )
+{
+  while ( driver->rx_pending_size >= UART_PENDING_LIMIT )
+    mico_thread_msleep( 1 );
+
+  mico_rtos_lock_mutex( &driver->rx_mutex );
+  uart_rx_pending_add( driver, data, size, false );
+  uart_rx_refill( driver );
+  mico_rtos_unlock_mutex( &driver->rx_mutex );
+}
+
+/* One reader per port for the life of the process, it is not stopped by
+ * deinit so nothing read from the host is lost on a re-init */
+static void uart_rx_thread( void* arg )
+{
+  platform_uart_driver_t* driver = (platform_uart_driver_t*)arg;
+  uint8_t buffer[UART_READ_CHUNK];
+
+  while ( 1 )
+  {
+    ssize_t n = read( driver->fd_in, buffer, sizeof(buffer) );
+
+    if ( n > 0 )
+    {
+      uart_rx_store( driver, buffer, (uint32_t)n );
+    }
+    else if ( n < 0 && errno == EINTR )
+    {
+      continue;
+    }
+    else if ( driver->peripheral->host == UART_HOST_STDIO )
+    {
+      /* stdin closed: hand the REPL an end of input and stop reading */
+      const uint8_t eof = UART_EOF_CHAR;
+      stdin_eof = true;
+      uart_rx_store( driver, &eof, 1 );
+      break;
+    }
+    else
+    {
+      /* nothing has the pty slave open */
+      mico_thread_msleep( 100 );
+    }
+  }
+  mico_rtos_delete_thread( NULL );
+}
+
+OSStatus platform_uart_init( platform_uart_driver_t* driver, const platform_uart_t* peripheral, const platform_uart_config_t* config, ring_buffer_t* optional_ring_buffer )
+{
+  OSStatus err = kNoErr;
+
+  require_action_quiet( ( driver != NULL ) && ( peripheral != NULL ) && ( config != NULL ), exit, err = kParamErr );
+  require_action_quiet( ( optional_ring_buffer != NULL ) && ( optional_ring_buffer->buffer != NULL ) && ( optional_ring_buffer->size != 0 ), exit, err = kUnsupportedErr );
+  require_action_quiet( driver->initialized == false, exit, err = kStateErr );
+
+  driver->rx_size              = 0;
+  driver->last_transmit_result = kNoErr;
+  driver->last_receive_result  = kNoErr;
+  driver->peripheral           = (platform_uart_t*)peripheral;
+  driver->rx_buffer            = optional_ring_buffer;
+
+  if ( peripheral->host == UART_HOST_STDIO )
+  {
+    stdio_raw_terminal( );
+    driver->fd_in  = STDIN_FILENO;
+    driver->fd_out = STDOUT_FILENO;
+  }
+  else
+  {
+    driver->fd_in = driver->fd_out = pty_open( );
+    require_action( driver->fd_in >= 0, exit, err = kOpenErr );
+  }
+
+  /* Kept over deinit together with the reader */
+  if ( driver->rx_mutex == NULL )
+  {
+    mico_rtos_init_semaphore( &driver->rx_complete, 1 );
+    mico_rtos_init_mutex( &driver->rx_mutex );
+    mico_rtos_init_mutex( &driver->tx_mutex );
+  }
+
+  mico_rtos_lock_mutex( &driver->rx_mutex );
+  driver->initialized = true;
+  uart_rx_refill( driver );
+  mico_rtos_unlock_mutex( &driver->rx_mutex );
+
+  /* stdin ends only once, a new reader would only see EOF again */
+  if ( driver->rx_thread == NULL && !( peripheral->host == UART_HOST_STDIO && stdin_eof ) )
+  {
+    err = mico_rtos_create_thread( &driver->rx_thread, MICO_DEFAULT_WORKER_PRIORITY, "UART RX", uart_rx_thread, 0x400, driver );
+    require_noerr( err, exit );
+  }
+
+exit:
+  return err;
+}
+
+OSStatus platform_uart_deinit( platform_uart_driver_t* driver )
+{
+  OSStatus err = kNoErr;
+  uint8_t* unread;
+  uint32_t used;
+
+  require_action_quiet( driver != NULL, exit, err = kParamErr );
+  require_quiet( driver->initialized, exit );
+
+  /* What the application did not read yet goes back in front of the
+   * pending input, the ring buffer belongs to the caller again */
+  mico_rtos_lock_mutex( &driver->rx_mutex );
+  driver->initialized = false;
+  used = ring_buffer_used_space( driver->rx_buffer );
+  unread = ( used > 0 ) ? malloc( used ) : NULL;
+  if ( unread != NULL )
+  {
+    uint32_t copied = 0;
+    while ( copied < used )
+    {
+      uint8_t* data;
+      uint32_t size;
+      ring_buffer_get_data( driver->rx_buffer, &data, &size );
+      memcpy( unread + copied, data, size );
+      ring_buffer_consume( driver->rx_buffer, size );
+      copied += size;
+    }
+    uart_rx_pending_add( driver, unread, used, true );
+    free( unread );
+  }
+  mico_rtos_unlock_mutex( &driver->rx_mutex );
+
+exit:
+  return err;
+}
+
+OSStatus platform_uart_transmit_bytes( platform_uart_driver_t* driver, const uint8_t* data_out, uint32_t size )
+{
+  OSStatus err = kNoErr;
+
+  require_action_quiet( ( driver != NULL ) && ( data_out != NULL ) && ( size != 0 ), exit, err = kParamErr );
+  require_action_quiet( driver->initialized, exit, err = kNotInitializedErr );
+
+  mico_rtos_lock_mutex( &driver->tx_mutex );
+  while ( size > 0 )
+  {
+    ssize_t n = write( driver->fd_out, data_out, size );
+    if ( n < 0 )
+    {
+      if ( errno == EINTR )
+        continue;
+      /* a pty without reader drops the bytes like an unconnected TX pin */
+      err = ( driver->peripheral->host == UART_HOST_PTY ) ? kNoErr : kWriteErr;
+      break;
+    }
+    data_out += n;
+    size -= (uint32_t)n;
+  }
+  driver->last_transmit_result = err;
+  mico_rtos_unlock_mutex( &driver->tx_mutex );
+
+exit:
+  return err;
+}
+
+OSStatus platform_uart_receive_bytes( platform_uart_driver_t* driver, uint8_t* data_in, uint32_t expected_data_size, uint32_t timeout_ms )
+{
+  OSStatus err = kNoErr;
+
+  require_action_quiet( ( driver != NULL ) && ( data_in != NULL ) && ( expected_data_size != 0 ), exit, err = kParamErr );
+  require_action_quiet( driver->initialized, exit, err = kNotInitializedErr );
+
+  while ( expected_data_size != 0 )
+  {
+    uint32_t transfer_size = MIN( driver->rx_buffer->size / 2, expected_data_size );
+    uint32_t start = mico_get_time( );
+
+    /* Wait until the reader thread has stored transfer_size bytes or timeout occurs */
+    mico_rtos_lock_mutex( &driver->rx_mutex );
+    while ( transfer_size > ring_buffer_used_space( driver->rx_buffer ) )
+    {
+      uint32_t waited = mico_get_time( ) - start;
+
+      if ( timeout_ms != MICO_NEVER_TIMEOUT && waited >= timeout_ms )
+      {
+        err = kTimeoutErr;
+        break;
+      }
+      driver->rx_size = transfer_size;
+      mico_rtos_unlock_mutex( &driver->rx_mutex );
+      mico_rtos_get_semaphore( &driver->rx_complete, ( timeout_ms == MICO_NEVER_TIMEOUT ) ? MICO_NEVER_TIMEOUT : timeout_ms - waited );
+      mico_rtos_lock_mutex( &driver->rx_mutex );
+    }
+    driver->rx_size = 0;
+
+    if ( err != kNoErr )
+    {
+      mico_rtos_unlock_mutex( &driver->rx_mutex );
+      driver->last_receive_result = err;
+      goto exit;
+    }
+
+    expected_data_size -= transfer_size;
+
+    // Grab data from the buffer
+    do
+    {
+      uint8_t* available_data;
+      uint32_t bytes_available;
+
+      ring_buffer_get_data( driver->rx_buffer, &available_data, &bytes_available );
+      bytes_available = MIN( bytes_available, transfer_size );
+      memcpy( data_in, available_data, bytes_available );
+      transfer_size -= bytes_available;
+      data_in = ( (uint8_t*) data_in + bytes_available );
+      ring_buffer_consume( driver->rx_buffer, bytes_available );
+    } while ( transfer_size != 0 );
+    uart_rx_refill( driver );
+    mico_rtos_unlock_mutex( &driver->rx_mutex );
+  }
+
+exit:
+  return err;
+}
+
+OSStatus platform_uart_get_length_in_buffer( platform_uart_driver_t* driver )
+{
+  OSStatus length;
+
+  if ( driver == NULL || !driver->initialized )
+    return 0;
+
+  mico_rtos_lock_mutex( &driver->rx_mutex );
+  length = ring_buffer_used_space( driver->rx_buffer );
+  mico_rtos_unlock_mutex( &driver->rx_mutex );
+  return length;
+}
@@ -0,0 +1,118 @@
+/**
+******************************************************************************
+* @file    platform_watchdog.c
+* @version V1.0.0
+* @brief   This file provides the independent watchdog of the Linux host
+*          platform. A monitor thread resets the process like the IWDG
+*          resets the MCU when it is not kicked in time.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include "platform.h"
+#include "platform_config.h"
+#include "platform_peripheral.h"
+#include "PlatformLogging.h"
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define WATCHDOG_POLL_MS      (100)
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+#ifndef MICO_DISABLE_WATCHDOG
+static volatile uint32_t watchdog_timeout_ms = 0;
+static volatile uint32_t watchdog_last_kick = 0;
+static mico_thread_t     watchdog_thread = NULL;
+#endif
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+#ifndef MICO_DISABLE_WATCHDOG
+static void watchdog_monitor( void* arg )
+{
+  UNUSED_PARAMETER( arg );
+
+  while ( 1 )
+  {
+    mico_thread_msleep( WATCHDOG_POLL_MS );
+    if ( watchdog_timeout_ms != 0 && mico_get_time( ) - watchdog_last_kick > watchdog_timeout_ms )
+    {
+      platform_log( "Watchdog timeout, reset" );
+      platform_host_reset( BOOT_REASON_WDG_RST );
+    }
+  }
+}
+#endif
+
+OSStatus platform_watchdog_init( uint32_t timeout_ms )
+{
+#ifndef MICO_DISABLE_WATCHDOG
+  OSStatus err = kNoErr;
+
+  /* Same margin as the STM32 IWDG setup */
+  watchdog_timeout_ms = timeout_ms + 1000;
+  watchdog_last_kick = mico_get_time( );
+
+  if ( watchdog_thread == NULL )
+  {
+    err = mico_rtos_create_thread( &watchdog_thread, MICO_APPLICATION_PRIORITY, "WDG", watchdog_monitor, 0x200, NULL );
+    require_noerr( err, exit );
+  }
+
+exit:
+  return err;
+#else
+  UNUSED_PARAMETER( timeout_ms );
+  return kUnsupportedErr;
+#endif
+}
+
+OSStatus platform_watchdog_deinit( void )
+{
+#ifndef MICO_DISABLE_WATCHDOG
+  watchdog_timeout_ms = 0;
+#endif
+  return kNoErr;
+}
+
+OSStatus platform_watchdog_kick( void )
+{
+#ifndef MICO_DISABLE_WATCHDOG
+  watchdog_last_kick = mico_get_time( );
+  return kNoErr;
+#else
+  return kUnsupportedErr;
+#endif
+}
+
+bool platform_watchdog_check_last_reset( void )
+{
+  return platform_host_boot_reason( ) == BOOT_REASON_WDG_RST;
+}
@@ -0,0 +1,17 @@
+/**
+******************************************************************************
+* @file    platform_assert.h
+* @version V1.0.0
+* @brief   Assertion action of the Linux host platform, replaces
+*          Platform/Cortex-M4/platform_assert.h.
+******************************************************************************
+*/
+
+#pragma once
+
+/******************************************************
+ *                    Constants
+ ******************************************************/
+
+/* stops a debugger like bkpt does on the module, aborts otherwise */
+#define MICO_ASSERTION_FAIL_ACTION() __builtin_trap()
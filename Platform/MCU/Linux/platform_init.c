@@ -0,0 +1,279 @@
+/**
+******************************************************************************
+* @file    platform_init.c
+* @version V1.0.0
+* @brief   Start up of the Linux host platform. main() takes the place of
+*          the reset handler and the RTOS start: it opens the flash images,
+*          brings up stdio like init_architecture() does on the MCU and
+*          runs application_start(). A reset re-executes the process with
+*          the boot reason passed on in the environment.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "platform_peripheral.h"
+#include "platform.h"
+#include "platform_config.h"
+#include "PlatformLogging.h"
+#include "MicoDrivers/MicoDriverFlash.h"
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#ifndef STDIO_BUFFER_SIZE
+#define STDIO_BUFFER_SIZE   64
+#endif
+
+/* Carries the boot reason over a simulated reset */
+#define HOST_BOOT_REASON_ENV   "MICO_HOST_BOOT_REASON"
+
+#define HOST_LIB_VERSION       "31621002.049.HOST"
+#define HOST_RF_VERSION        "host-posix"
+
+/******************************************************
+*                    Structures
+******************************************************/
+
+/* MICO.h can not be included by the host sources */
+typedef struct  {
+  int num_of_chunks;
+  int total_memory;
+  int allocted_memory;
+  int free_memory;
+} host_mem_info_t;
+
+/******************************************************
+*               Function Declarations
+******************************************************/
+
+extern void application_start( void );
+extern void init_platform( void );
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+extern platform_uart_t platform_uart_peripherals[];
+extern platform_uart_driver_t platform_uart_drivers[];
+extern const platform_flash_t platform_flash_peripherals[];
+extern const mico_logic_partition_t mico_partitions[];
+
+static const platform_uart_config_t stdio_uart_config =
+{
+  .baud_rate    = STDIO_UART_BAUDRATE,
+  .data_width   = DATA_WIDTH_8BIT,
+  .parity       = NO_PARITY,
+  .stop_bits    = STOP_BITS_1,
+  .flow_control = FLOW_CONTROL_DISABLED,
+  .flags        = 0,
+};
+
+static ring_buffer_t      stdio_rx_buffer;
+static uint8_t            stdio_rx_data[STDIO_BUFFER_SIZE];
+mico_mutex_t              stdio_rx_mutex;
+mico_mutex_t              stdio_tx_mutex;
+
+int mico_debug_enabled = 1;
+
+static char**             host_argv;
+static char*              host_exe;
+static uint8_t            host_boot_reason = BOOT_REASON_PWRON_RST;
+static bool               host_print_wear = false;
+static host_mem_info_t    host_mem_info;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static void usage( const char* name )
+{
+  fprintf( stderr, "usage: %s [-f flash.img] [-l spiffs.img] [-w]\n"
+                   "  -f file   keep the SPI flash in file, else it is lost at exit\n"
+                   "  -l file   program file into the LUA partition at power on\n"
+                   "  -w        print the flash wear counters at exit\n", name );
+}
+
+static void print_wear( void )
+{
+  platform_flash_wear_t wear;
+  int i;
+
+  if ( !host_print_wear )
+    return;
+
+  for ( i = 0; i < MICO_FLASH_MAX; i++ )
+  {
+    if ( platform_flash_host_get_wear( &platform_flash_peripherals[i], &wear ) != kNoErr )
+      continue;
+    fprintf( stderr, "flash %d: %lu sectors, %lu erases, max %lu per sector, %lu worn, %lu bad writes\n", i,
+             (unsigned long)wear.sectors, (unsigned long)wear.erases, (unsigned long)wear.max_erase_count,
+             (unsigned long)wear.worn_sectors, (unsigned long)wear.bad_writes );
+  }
+}
+
+static void init_architecture( void )
+{
+  mico_rtos_init_mutex( &stdio_tx_mutex );
+  mico_rtos_init_mutex( &stdio_rx_mutex );
+
+  ring_buffer_init  ( &stdio_rx_buffer, stdio_rx_data, STDIO_BUFFER_SIZE );
+  platform_uart_init( &platform_uart_drivers[STDIO_UART], &platform_uart_peripherals[STDIO_UART], &stdio_uart_config, &stdio_rx_buffer );
+
+  platform_rtc_init( );
+}
+
+int main( int argc, char* argv[] )
+{
+  const char* spiffs_image = NULL;
+  const char* reason;
+  int opt;
+
+  /* Looked up now, the working directory or PATH may change later */
+  host_argv = argv;
+  host_exe = realpath( "/proc/self/exe", NULL );
+  if ( host_exe == NULL && strchr( argv[0], '/' ) != NULL )
+    host_exe = realpath( argv[0], NULL );
+  if ( host_exe == NULL )
+    host_exe = argv[0];
+  while ( ( opt = getopt( argc, argv, "f:l:w" ) ) != -1 )
+  {
+    switch ( opt )
+    {
+      case 'f': platform_flash_host_set_image( FLASH_TYPE_SPI, optarg ); break;
+      case 'l': spiffs_image = optarg; break;
+      case 'w': host_print_wear = true; break;
+      default:  usage( argv[0] ); return 1;
+    }
+  }
+
+  reason = getenv( HOST_BOOT_REASON_ENV );
+  if ( reason != NULL )
+  {
+    host_boot_reason = (uint8_t)atoi( reason );
+    unsetenv( HOST_BOOT_REASON_ENV );
+  }
+
+  /* The console is the UART, nothing may wait in a buffer */
+  setvbuf( stdout, NULL, _IONBF, 0 );
+  atexit( print_wear );
+
+  if ( spiffs_image != NULL && host_boot_reason == BOOT_REASON_PWRON_RST )
+  {
+    const mico_logic_partition_t* lua = &mico_partitions[MICO_PARTITION_LUA];
+    if ( platform_flash_host_load( &platform_flash_peripherals[lua->partition_owner], lua->partition_start_addr, spiffs_image ) != kNoErr )
+    {
+      fprintf( stderr, "can not load %s\n", spiffs_image );
+      return 1;
+    }
+  }
+
+  init_architecture( );
+  init_platform( );
+  application_start( );
+
+  /* application_start() deleted its thread, the others carry on */
+  pthread_exit( NULL );
+  return 0;
+}
+
+void platform_host_reset( uint8_t boot_reason )
+{
+  char value[4];
+
+  /* Nobody can type into a closed stdin, a reset would only loop */
+  if ( platform_uart_host_eof( ) )
+    exit( 0 );
+
+  print_wear( );
+  sprintf( value, "%u", boot_reason );
+  setenv( HOST_BOOT_REASON_ENV, value, 1 );
+  fflush( NULL );
+  execvp( host_exe, host_argv );
+  platform_log( "Reset failed: %s", strerror( errno ) );
+  _exit( 1 );
+}
+
+uint8_t platform_host_boot_reason( void )
+{
+  return host_boot_reason;
+}
+
+void platform_host_chip_id( uint32_t id[3] )
+{
+  uint8_t machine_id[32];
+  int fd, i;
+
+  /* Stable per host like the unique device ID of the STM32 */
+  memset( id, 0, 3 * sizeof(uint32_t) );
+  memset( machine_id, 0, sizeof(machine_id) );
+  fd = open( "/etc/machine-id", O_RDONLY | O_CLOEXEC );
+  if ( fd >= 0 )
+  {
+    if ( read( fd, machine_id, sizeof(machine_id) ) < 0 )
+      memset( machine_id, 0, sizeof(machine_id) );
+    close( fd );
+  }
+  for ( i = 0; i < (int)sizeof(machine_id); i++ )
+    id[i % 3] = id[i % 3] * 31 + machine_id[i];
+}
+
+void platform_mcu_reset( void )
+{
+  platform_host_reset( BOOT_REASON_SOFT_RST );
+}
+
+void mxchipInit( void )
+{
+}
+
+host_mem_info_t* mico_memory_info( void )
+{
+  struct mallinfo2 mi = mallinfo2( );
+
+  host_mem_info.num_of_chunks = (int)mi.ordblks;
+  host_mem_info.total_memory = (int)mi.arena;
+  host_mem_info.allocted_memory = (int)mi.uordblks;
+  host_mem_info.free_memory = (int)mi.fordblks;
+  return &host_mem_info;
+}
+
+char* system_lib_version( void )
+{
+  return HOST_LIB_VERSION;
+}
+
+int wlan_driver_version( char* outVersion, uint8_t inLength )
+{
+  if ( outVersion == NULL || inLength == 0 )
+    return -1;
+  strncpy( outVersion, HOST_RF_VERSION, inLength - 1 );
+  outVersion[inLength - 1] = 0;
+  return 0;
+}
@@ -0,0 +1,749 @@
+/**
+******************************************************************************
+* @file    mico_rtos_host.c
+* @version V1.0.0
+* @brief   MICO RTOS API on POSIX threads for the Linux host platform.
+*          Threads are detached pthreads, stack sizes and priorities are
+*          ignored. Timers are periodic like the FreeRTOS ones and run
+*          their handlers on one timer service thread. An event fd is a
+*          pipe that is readable while its semaphore or queue is not empty.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <pthread.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Common.h"
+#include "Debug.h"
+#include "mico_rtos.h"
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define THREAD_NAME_LEN     (16)
+/* The MICO fd_set of host_socket.c */
+#define EVENT_FD_MAX        (24)
+
+/******************************************************
+*                    Structures
+******************************************************/
+
+typedef struct
+{
+  pthread_t               tid;
+  mico_thread_function_t  function;
+  void*                   arg;
+  char                    name[THREAD_NAME_LEN];
+} host_thread_t;
+
+/* The pipe of an event fd, written while the object is not empty */
+typedef struct
+{
+  int                     pipe[2];
+  int                     fd;       /* MICO fd of pipe[0], -1 without one */
+  bool                    ready;
+} host_event_t;
+
+/* Semaphores and queues start the same way, mico_create_event_fd() takes
+ * either */
+typedef struct
+{
+  host_event_t            event;
+  pthread_mutex_t         mutex;
+} host_event_object_t;
+
+typedef struct
+{
+  host_event_t            event;
+  pthread_mutex_t         mutex;
+  pthread_cond_t          cond;
+  int                     count;
+  int                     max_count;
+} host_semaphore_t;
+
+typedef struct
+{
+  host_event_t            event;
+  pthread_mutex_t         mutex;
+  pthread_cond_t          not_empty;
+  pthread_cond_t          not_full;
+  uint32_t                message_size;
+  uint32_t                number_of_messages;
+  uint32_t                head;
+  uint32_t                count;
+  uint8_t*                buffer;
+} host_queue_t;
+
+typedef struct host_timer
+{
+  struct host_timer*      next;
+  mico_timer_t*           owner;
+  uint32_t                period_ms;
+  uint64_t                deadline_ms;
+  bool                    running;
+} host_timer_t;
+
+/******************************************************
+*               Function Declarations
+******************************************************/
+
+/* host_socket.c, weak for the benches that link no sockets */
+extern int host_socket_event( int fd ) __attribute__((weak));
+extern int host_close( int fd ) __attribute__((weak));
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+static pthread_mutex_t    timer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t     timer_cond;
+static pthread_once_t     timer_once = PTHREAD_ONCE_INIT;
+static host_timer_t*      timer_list = NULL;
+
+/* Stands in for the scheduler lock, see vTaskSuspendAll() */
+static pthread_mutex_t    scheduler_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+static host_event_object_t* event_objects[EVENT_FD_MAX];
+static pthread_mutex_t    event_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static struct timespec    rtos_start_time;
+static pthread_once_t     rtos_start_once = PTHREAD_ONCE_INIT;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static uint64_t monotonic_ms( void )
+{
+  struct timespec now;
+  clock_gettime( CLOCK_MONOTONIC, &now );
+  return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/* Absolute CLOCK_MONOTONIC deadline timeout_ms from now */
+static void deadline_after( struct timespec* ts, uint32_t timeout_ms )
+{
+  clock_gettime( CLOCK_MONOTONIC, ts );
+  ts->tv_sec  += timeout_ms / 1000;
+  ts->tv_nsec += (long)( timeout_ms % 1000 ) * 1000000;
+  if ( ts->tv_nsec >= 1000000000 )
+  {
+    ts->tv_sec++;
+    ts->tv_nsec -= 1000000000;
+  }
+}
+
+static void init_monotonic_cond( pthread_cond_t* cond )
+{
+  pthread_condattr_t attr;
+  pthread_condattr_init( &attr );
+  pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+  pthread_cond_init( cond, &attr );
+  pthread_condattr_destroy( &attr );
+}
+
+/* One wait on cond, false once the deadline has passed */
+static bool cond_wait_ms( pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* deadline, uint32_t timeout_ms )
+{
+  if ( timeout_ms == MICO_WAIT_FOREVER )
+  {
+    pthread_cond_wait( cond, mutex );
+    return true;
+  }
+  return pthread_cond_timedwait( cond, mutex, deadline ) != ETIMEDOUT;
+}
+
+/* Under the mutex of the object: a byte in the pipe while it is ready */
+static void event_update( host_event_t* event, bool ready )
+{
+  char c = 0;
+
+  if ( event->fd >= 0 && ready != event->ready )
+  {
+    if ( ready )
+      (void)!write( event->pipe[1], &c, 1 );
+    else
+      (void)!read( event->pipe[0], &c, 1 );
+  }
+  event->ready = ready;
+}
+
+/*** Threads ***/
+
+static void* thread_entry( void* arg )
+{
+  host_thread_t* thread = (host_thread_t*)arg;
+  pthread_setname_np( pthread_self( ), thread->name );
+  thread->function( thread->arg );
+  return NULL;
+}
+
+OSStatus mico_rtos_create_thread( mico_thread_t* thread, uint8_t priority, const char* name, mico_thread_function_t function, uint32_t stack_size, void* arg )
+{
+  OSStatus err = kNoErr;
+  pthread_attr_t attr;
+  host_thread_t* host_thread;
+  UNUSED_PARAMETER( priority );
+  UNUSED_PARAMETER( stack_size );
+
+  host_thread = calloc( 1, sizeof(host_thread_t) );
+  require_action( host_thread, exit, err = kNoMemoryErr );
+
+  host_thread->function = function;
+  host_thread->arg = arg;
+  strncpy( host_thread->name, ( name != NULL ) ? name : "mico", THREAD_NAME_LEN - 1 );
+
+  pthread_attr_init( &attr );
+  pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+  if ( pthread_create( &host_thread->tid, &attr, thread_entry, host_thread ) != 0 )
+  {
+    free( host_thread );
+    err = kNoResourcesErr;
+  }
+  pthread_attr_destroy( &attr );
+  require_noerr( err, exit );
+
+  if ( thread != NULL )
+    *thread = host_thread;
+
+exit:
+  return err;
+}
+
+OSStatus mico_rtos_delete_thread( mico_thread_t* thread )
+{
+  if ( thread == NULL || *thread == NULL || pthread_equal( ( (host_thread_t*)*thread )->tid, pthread_self( ) ) )
+    pthread_exit( NULL );
+
+  pthread_cancel( ( (host_thread_t*)*thread )->tid );
+  return kNoErr;
+}
+
+void mico_rtos_suspend_thread( mico_thread_t* thread )
+{
+  UNUSED_PARAMETER( thread );
+}
+
+void vTaskSuspendAll( void )
+{
+  pthread_mutex_lock( &scheduler_mutex );
+}
+
+long xTaskResumeAll( void )
+{
+  pthread_mutex_unlock( &scheduler_mutex );
+  return 0;
+}
+
+OSStatus mico_rtos_thread_join( mico_thread_t* thread )
+{
+  UNUSED_PARAMETER( thread );
+  return kUnsupportedErr;
+}
+
+OSStatus mico_rtos_thread_force_awake( mico_thread_t* thread )
+{
+  UNUSED_PARAMETER( thread );
+  return kUnsupportedErr;
+}
+
+bool mico_rtos_is_current_thread( mico_thread_t* thread )
+{
+  return thread != NULL && *thread != NULL && pthread_equal( ( (host_thread_t*)*thread )->tid, pthread_self( ) );
+}
+
+void msleep( uint32_t milliseconds )
+{
+  struct timespec ts = { milliseconds / 1000, (long)( milliseconds % 1000 ) * 1000000 };
+  while ( nanosleep( &ts, &ts ) != 0 && errno == EINTR );
+}
+
+void mico_thread_sleep( uint32_t seconds )
+{
+  msleep( seconds * 1000 );
+}
+
+/*** Semaphores ***/
+
+OSStatus mico_rtos_init_semaphore( mico_semaphore_t* semaphore, int count )
+{
+  host_semaphore_t* sem = calloc( 1, sizeof(host_semaphore_t) );
+  if ( sem == NULL )
+    return kNoMemoryErr;
+
+  sem->event.fd = -1;
+  pthread_mutex_init( &sem->mutex, NULL );
+  init_monotonic_cond( &sem->cond );
+  sem->max_count = count;
+  *semaphore = sem;
+  return kNoErr;
+}
+
+OSStatus mico_rtos_set_semaphore( mico_semaphore_t* semaphore )
+{
+  host_semaphore_t* sem = (host_semaphore_t*)*semaphore;
+  OSStatus err = kNoErr;
+
+  pthread_mutex_lock( &sem->mutex );
+  if ( sem->count < sem->max_count )
+  {
+    sem->count++;
+    event_update( &sem->event, true );
+    pthread_cond_signal( &sem->cond );
+  }
+  else
+    err = kGeneralErr;
+  pthread_mutex_unlock( &sem->mutex );
+  return err;
+}
+
+OSStatus mico_rtos_get_semaphore( mico_semaphore_t* semaphore, uint32_t timeout_ms )
+{
+  host_semaphore_t* sem = (host_semaphore_t*)*semaphore;
+  struct timespec deadline;
+  OSStatus err = kNoErr;
+
+  deadline_after( &deadline, timeout_ms );
+  pthread_mutex_lock( &sem->mutex );
+  while ( sem->count == 0 )
+  {
+    if ( timeout_ms == 0 || !cond_wait_ms( &sem->cond, &sem->mutex, &deadline, timeout_ms ) )
+      break;
+  }
+  if ( sem->count > 0 )
+  {
+    sem->count--;
+    event_update( &sem->event, sem->count > 0 );
+  }
+  else
+    err = kTimeoutErr;
+  pthread_mutex_unlock( &sem->mutex );
+  return err;
+}
+
+OSStatus mico_rtos_deinit_semaphore( mico_semaphore_t* semaphore )
+{
+  host_semaphore_t* sem = (host_semaphore_t*)*semaphore;
+
+  if ( sem != NULL )
+  {
+    pthread_cond_destroy( &sem->cond );
+    pthread_mutex_destroy( &sem->mutex );
+    free( sem );
+    *semaphore = NULL;
+  }
+  return kNoErr;
+}
+
+/*** Mutexes ***/
+
+/* FreeRTOS mutexes are unlocked by whoever holds the handle, the Lua queue
+   thread relies on that, so the host mutexes are recursive and lenient */
+OSStatus mico_rtos_init_mutex( mico_mutex_t* mutex )
+{
+  pthread_mutexattr_t attr;
+  pthread_mutex_t* m = malloc( sizeof(pthread_mutex_t) );
+  if ( m == NULL )
+    return kNoMemoryErr;
+
+  pthread_mutexattr_init( &attr );
+  pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_RECURSIVE );
+  pthread_mutex_init( m, &attr );
+  pthread_mutexattr_destroy( &attr );
+  *mutex = m;
+  return kNoErr;
+}
+
+OSStatus mico_rtos_lock_mutex( mico_mutex_t* mutex )
+{
+  if ( pthread_mutex_lock( (pthread_mutex_t*)*mutex ) != 0 )
+    return kGeneralErr;
+  return kNoErr;
+}
+
+OSStatus mico_rtos_unlock_mutex( mico_mutex_t* mutex )
+{
+  if ( pthread_mutex_unlock( (pthread_mutex_t*)*mutex ) != 0 )
+    return kGeneralErr;
+  return kNoErr;
+}
+
+OSStatus mico_rtos_deinit_mutex( mico_mutex_t* mutex )
+{
+  if ( *mutex != NULL )
+  {
+    pthread_mutex_destroy( (pthread_mutex_t*)*mutex );
+    free( *mutex );
+    *mutex = NULL;
+  }
+  return kNoErr;
+}
+
+/*** Queues ***/
+
+OSStatus mico_rtos_init_queue( mico_queue_t* queue, const char* name, uint32_t message_size, uint32_t number_of_messages )
+{
+  OSStatus err = kNoErr;
+  host_queue_t* q;
+  UNUSED_PARAMETER( name );
+
+  q = calloc( 1, sizeof(host_queue_t) );
+  require_action( q, exit, err = kNoMemoryErr );
+  q->buffer = malloc( message_size * number_of_messages );
+  require_action( q->buffer, exit, free( q ); err = kNoMemoryErr );
+
+  q->message_size = message_size;
+  q->number_of_messages = number_of_messages;
+  q->event.fd = -1;
+  pthread_mutex_init( &q->mutex, NULL );
+  init_monotonic_cond( &q->not_empty );
+  init_monotonic_cond( &q->not_full );
+  *queue = q;
+
+exit:
+  return err;
+}
+
+OSStatus mico_rtos_push_to_queue( mico_queue_t* queue, void* message, uint32_t timeout_ms )
+{
+  host_queue_t* q = (host_queue_t*)*queue;
+  struct timespec deadline;
+  OSStatus err = kNoErr;
+
+  deadline_after( &deadline, timeout_ms );
+  pthread_mutex_lock( &q->mutex );
+  while ( q->count == q->number_of_messages )
+  {
+    if ( timeout_ms == 0 || !cond_wait_ms( &q->not_full, &q->mutex, &deadline, timeout_ms ) )
+      break;
+  }
+  if ( q->count < q->number_of_messages )
+  {
+    uint32_t tail = ( q->head + q->count ) % q->number_of_messages;
+    memcpy( q->buffer + tail * q->message_size, message, q->message_size );
+    q->count++;
+    event_update( &q->event, true );
+    pthread_cond_signal( &q->not_empty );
+  }
+  else
+    err = kGeneralErr;
+  pthread_mutex_unlock( &q->mutex );
+  return err;
+}
+
+OSStatus mico_rtos_pop_from_queue( mico_queue_t* queue, void* message, uint32_t timeout_ms )
+{
+  host_queue_t* q = (host_queue_t*)*queue;
+  struct timespec deadline;
+  OSStatus err = kNoErr;
+
+  deadline_after( &deadline, timeout_ms );
+  pthread_mutex_lock( &q->mutex );
+  while ( q->count == 0 )
+  {
+    if ( timeout_ms == 0 || !cond_wait_ms( &q->not_empty, &q->mutex, &deadline, timeout_ms ) )
+      break;
+  }
+  if ( q->count > 0 )
+  {
+    memcpy( message, q->buffer + q->head * q->message_size, q->message_size );
+    q->head = ( q->head + 1 ) % q->number_of_messages;
+    q->count--;
+    event_update( &q->event, q->count > 0 );
+    pthread_cond_signal( &q->not_full );
+  }
+  else
+    err = kGeneralErr;
+  pthread_mutex_unlock( &q->mutex );
+  return err;
+}
+
+OSStatus mico_rtos_deinit_queue( mico_queue_t* queue )
+{
+  host_queue_t* q = (host_queue_t*)*queue;
+
+  if ( q != NULL )
+  {
+    pthread_cond_destroy( &q->not_empty );
+    pthread_cond_destroy( &q->not_full );
+    pthread_mutex_destroy( &q->mutex );
+    free( q->buffer );
+    free( q );
+    *queue = NULL;
+  }
+  return kNoErr;
+}
+
+bool mico_rtos_is_queue_empty( mico_queue_t* queue )
+{
+  host_queue_t* q = (host_queue_t*)*queue;
+  bool empty;
+
+  pthread_mutex_lock( &q->mutex );
+  empty = ( q->count == 0 );
+  pthread_mutex_unlock( &q->mutex );
+  return empty;
+}
+
+OSStatus mico_rtos_is_queue_full( mico_queue_t* queue )
+{
+  host_queue_t* q = (host_queue_t*)*queue;
+  bool full;
+
+  pthread_mutex_lock( &q->mutex );
+  full = ( q->count == q->number_of_messages );
+  pthread_mutex_unlock( &q->mutex );
+  return full;
+}
+
+/*** Time ***/
+
+static void rtos_start( void )
+{
+  clock_gettime( CLOCK_MONOTONIC, &rtos_start_time );
+}
+
+uint32_t mico_get_time( void )
+{
+  struct timespec now;
+  pthread_once( &rtos_start_once, rtos_start );
+  clock_gettime( CLOCK_MONOTONIC, &now );
+  return (uint32_t)( ( now.tv_sec - rtos_start_time.tv_sec ) * 1000 + ( now.tv_nsec - rtos_start_time.tv_nsec ) / 1000000 );
+}
+
+uint32_t mico_get_time_no_os( void )
+{
+  return mico_get_time( );
+}
+
+/*** Timers ***/
+
+/* Runs the handlers of expired timers, the list lock is dropped around each
+   call so a handler may stop or restart any timer, itself included */
+static void* timer_service_thread( void* arg )
+{
+  UNUSED_PARAMETER( arg );
+  pthread_setname_np( pthread_self( ), "timer" );
+
+  pthread_mutex_lock( &timer_mutex );
+  while ( 1 )
+  {
+    host_timer_t* t;
+    host_timer_t* next = NULL;
+    uint64_t now = monotonic_ms( );
+
+    for ( t = timer_list; t != NULL; t = t->next )
+    {
+      if ( t->running && ( next == NULL || t->deadline_ms < next->deadline_ms ) )
+        next = t;
+    }
+
+    if ( next == NULL )
+    {
+      pthread_cond_wait( &timer_cond, &timer_mutex );
+    }
+    else if ( next->deadline_ms > now )
+    {
+      struct timespec deadline;
+      deadline_after( &deadline, (uint32_t)( next->deadline_ms - now ) );
+      pthread_cond_timedwait( &timer_cond, &timer_mutex, &deadline );
+    }
+    else
+    {
+      mico_timer_t* owner = next->owner;
+      timer_handler_t function = owner->function;
+      void* arg = owner->arg;
+
+      next->deadline_ms += next->period_ms;
+      if ( next->deadline_ms < now )
+        next->deadline_ms = now + next->period_ms;
+
+      pthread_mutex_unlock( &timer_mutex );
+      function( arg );
+      pthread_mutex_lock( &timer_mutex );
+    }
+  }
+  return NULL;
+}
+
+static void timer_service_start( void )
+{
+  pthread_t tid;
+  init_monotonic_cond( &timer_cond );
+  pthread_create( &tid, NULL, timer_service_thread, NULL );
+  pthread_detach( tid );
+}
+
+OSStatus mico_init_timer( mico_timer_t* timer, uint32_t time_ms, timer_handler_t function, void* arg )
+{
+  host_timer_t* t;
+
+  pthread_once( &timer_once, timer_service_start );
+  t = calloc( 1, sizeof(host_timer_t) );
+  if ( t == NULL )
+    return kNoMemoryErr;
+
+  t->owner = timer;
+  t->period_ms = ( time_ms > 0 ) ? time_ms : 1;
+  timer->handle = t;
+  timer->function = function;
+  timer->arg = arg;
+
+  pthread_mutex_lock( &timer_mutex );
+  t->next = timer_list;
+  timer_list = t;
+  pthread_mutex_unlock( &timer_mutex );
+  return kNoErr;
+}
+
+OSStatus mico_start_timer( mico_timer_t* timer )
+{
+  host_timer_t* t = (host_timer_t*)timer->handle;
+  if ( t == NULL )
+    return kNotInitializedErr;
+
+  pthread_mutex_lock( &timer_mutex );
+  t->deadline_ms = monotonic_ms( ) + t->period_ms;
+  t->running = true;
+  pthread_cond_signal( &timer_cond );
+  pthread_mutex_unlock( &timer_mutex );
+  return kNoErr;
+}
+
+OSStatus mico_stop_timer( mico_timer_t* timer )
+{
+  host_timer_t* t = (host_timer_t*)timer->handle;
+  if ( t == NULL )
+    return kNotInitializedErr;
+
+  pthread_mutex_lock( &timer_mutex );
+  t->running = false;
+  pthread_mutex_unlock( &timer_mutex );
+  return kNoErr;
+}
+
+OSStatus mico_reload_timer( mico_timer_t* timer )
+{
+  return mico_start_timer( timer );
+}
+
+OSStatus mico_deinit_timer( mico_timer_t* timer )
+{
+  host_timer_t* t = (host_timer_t*)timer->handle;
+  host_timer_t** p;
+
+  if ( t == NULL )
+    return kNoErr;
+
+  pthread_mutex_lock( &timer_mutex );
+  for ( p = &timer_list; *p != NULL; p = &( *p )->next )
+  {
+    if ( *p == t )
+    {
+      *p = t->next;
+      break;
+    }
+  }
+  pthread_mutex_unlock( &timer_mutex );
+  free( t );
+  timer->handle = NULL;
+  return kNoErr;
+}
+
+bool mico_is_timer_running( mico_timer_t* timer )
+{
+  host_timer_t* t = (host_timer_t*)timer->handle;
+  bool running;
+
+  if ( t == NULL )
+    return false;
+  pthread_mutex_lock( &timer_mutex );
+  running = t->running;
+  pthread_mutex_unlock( &timer_mutex );
+  return running;
+}
+
+/*** Event fds ***/
+
+/* A pipe the MICO select() of host_socket.c can wait for together with
+ * the sockets, readable while the semaphore or queue is not empty. Reading
+ * it takes nothing, the owner still gets the semaphore or pops the queue. */
+int mico_create_event_fd( mico_event handle )
+{
+  host_event_object_t* obj = (host_event_object_t*)handle;
+  int fd = -1;
+
+  if ( obj == NULL || host_socket_event == NULL )
+    return -1;
+
+  pthread_mutex_lock( &obj->mutex );
+  if ( obj->event.fd >= 0 )
+    goto exit;
+  if ( pipe2( obj->event.pipe, O_CLOEXEC | O_NONBLOCK ) != 0 )
+    goto exit;
+  fd = host_socket_event( obj->event.pipe[0] );
+  if ( fd < 0 || fd >= EVENT_FD_MAX )
+  {
+    close( obj->event.pipe[1] );
+    fd = -1;
+    goto exit;
+  }
+  pthread_mutex_lock( &event_mutex );
+  event_objects[fd] = obj;
+  pthread_mutex_unlock( &event_mutex );
+  obj->event.fd = fd;
+  if ( obj->event.ready )
+  {
+    obj->event.ready = false;
+    event_update( &obj->event, true );
+  }
+
+exit:
+  pthread_mutex_unlock( &obj->mutex );
+  return fd;
+}
+
+int mico_delete_event_fd( int fd )
+{
+  host_event_object_t* obj;
+
+  if ( fd < 0 || fd >= EVENT_FD_MAX )
+    return -1;
+  pthread_mutex_lock( &event_mutex );
+  obj = event_objects[fd];
+  event_objects[fd] = NULL;
+  pthread_mutex_unlock( &event_mutex );
+  if ( obj == NULL || host_socket_event == NULL )
+    return -1;
+
+  pthread_mutex_lock( &obj->mutex );
+  obj->event.fd = -1;
+  close( obj->event.pipe[1] );
+  pthread_mutex_unlock( &obj->mutex );
+  return host_close( fd );
+}
@@ -37,6 +37,22 @@
  *                    Constants
  ******************************************************/
 
+/* Resources used by the continuous (timer triggered, DMA fed) conversion mode.
+ * TIM2 is only shared with PWM on D3/D12, DMA2 Stream4 channel 0 is ADC1. */
+#ifndef ADC_STREAM_TIMER
+#define ADC_STREAM_TIMER              TIM2
+#define ADC_STREAM_TIMER_CLOCK        RCC_APB1Periph_TIM2
+#define ADC_STREAM_TRIGGER            ADC_ExternalTrigConv_T2_TRGO
+#define ADC_STREAM_DMA_STREAM         DMA2_Stream4
+#define ADC_STREAM_DMA_CHANNEL        DMA_Channel_0
+#define ADC_STREAM_DMA_IRQ            DMA2_Stream4_IRQn
+#define ADC_STREAM_DMA_IT_HT          DMA_IT_HTIF4
+#define ADC_STREAM_DMA_IT_TC          DMA_IT_TCIF4
+#define ADC_STREAM_DMA_IT_TE          DMA_IT_TEIF4
+#endif
+
+#define ADC_STREAM_SAMPLE_CYCLE       (56)
+
 /******************************************************
  *                   Enumerations
  ******************************************************/
@@ -64,6 +80,12 @@ static const uint16_t adc_sampling_cycle[] =
     [ADC_SampleTime_480Cycles] = 480,
 };
 
+static platform_adc_stream_callback_t adc_stream_callback = NULL;
+static void*                          adc_stream_arg      = NULL;
+static uint16_t*                      adc_stream_buffer   = NULL;
+static uint16_t                       adc_stream_half     = 0;
+static const platform_adc_t*          adc_stream_adc      = NULL;
+
 /******************************************************
  *               Function Declarations
  ******************************************************/
@@ -205,4 +227,147 @@ OSStatus platform_adc_deinit( const platform_adc_t* adc )
     return kNotPreparedErr;
 }
 
+OSStatus platform_adc_stream_start( const platform_adc_t* adc, uint32_t sample_rate, uint16_t* buffer, uint16_t buffer_length, platform_adc_stream_callback_t callback, void* arg )
+{
+    ADC_InitTypeDef         adc_init_structure;
+    DMA_InitTypeDef         dma_init_structure;
+    TIM_TimeBaseInitTypeDef tim_time_base_structure;
+    RCC_ClocksTypeDef       rcc_clock_frequencies;
+    uint32_t                timer_clock;
+    uint32_t                ticks;
+    uint32_t                prescaler;
+    OSStatus                err = kNoErr;
+
+    require_action_quiet( adc != NULL && buffer != NULL && callback != NULL, exit, err = kParamErr);
+    require_action_quiet( buffer_length >= 2 && ( buffer_length & 1 ) == 0, exit, err = kParamErr);
+    require_action_quiet( sample_rate > 0, exit, err = kParamErr);
+    require_action_quiet( adc_stream_callback == NULL, exit, err = kAlreadyInitializedErr);
+
+    err = platform_adc_init( adc, ADC_STREAM_SAMPLE_CYCLE );
+    require_noerr(err, exit);
+
+    /* The timer and DMA must keep running, stay out of STOP mode until stopped */
+    platform_mcu_powersave_disable();
+
+    adc_stream_callback = callback;
+    adc_stream_arg      = arg;
+    adc_stream_buffer   = buffer;
+    adc_stream_half     = buffer_length / 2;
+    adc_stream_adc      = adc;
+
+    /* Re-initialise the ADC for external trigger, channel setup is kept */
+    ADC_Cmd( adc->port, DISABLE );
+    ADC_StructInit( &adc_init_structure );
+    adc_init_structure.ADC_Resolution           = ADC_Resolution_12b;
+    adc_init_structure.ADC_ScanConvMode         = DISABLE;
+    adc_init_structure.ADC_ContinuousConvMode   = DISABLE;
+    adc_init_structure.ADC_ExternalTrigConvEdge = ADC_ExternalTrigConvEdge_Rising;
+    adc_init_structure.ADC_ExternalTrigConv     = ADC_STREAM_TRIGGER;
+    adc_init_structure.ADC_DataAlign            = ADC_DataAlign_Right;
+    adc_init_structure.ADC_NbrOfConversion      = 1;
+    ADC_Init( adc->port, &adc_init_structure );
+
+    /* Circular DMA, half and full transfer interrupts hand out one half each */
+    RCC_AHB1PeriphClockCmd( RCC_AHB1Periph_DMA2, ENABLE );
+    DMA_DeInit( ADC_STREAM_DMA_STREAM );
+    DMA_StructInit( &dma_init_structure );
+    dma_init_structure.DMA_Channel            = ADC_STREAM_DMA_CHANNEL;
+    dma_init_structure.DMA_PeripheralBaseAddr = (uint32_t) &adc->port->DR;
+    dma_init_structure.DMA_Memory0BaseAddr    = (uint32_t) buffer;
+    dma_init_structure.DMA_DIR                = DMA_DIR_PeripheralToMemory;
+    dma_init_structure.DMA_BufferSize         = buffer_length;
+    dma_init_structure.DMA_PeripheralInc      = DMA_PeripheralInc_Disable;
+    dma_init_structure.DMA_MemoryInc          = DMA_MemoryInc_Enable;
+    dma_init_structure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    dma_init_structure.DMA_MemoryDataSize     = DMA_MemoryDataSize_HalfWord;
+    dma_init_structure.DMA_Mode               = DMA_Mode_Circular;
+    dma_init_structure.DMA_Priority           = DMA_Priority_High;
+    dma_init_structure.DMA_FIFOMode           = DMA_FIFOMode_Disable;
+    dma_init_structure.DMA_FIFOThreshold      = DMA_FIFOThreshold_HalfFull;
+    dma_init_structure.DMA_MemoryBurst        = DMA_MemoryBurst_Single;
+    dma_init_structure.DMA_PeripheralBurst    = DMA_PeripheralBurst_Single;
+    DMA_Init( ADC_STREAM_DMA_STREAM, &dma_init_structure );
+
+    DMA_ClearITPendingBit( ADC_STREAM_DMA_STREAM, ADC_STREAM_DMA_IT_HT | ADC_STREAM_DMA_IT_TC | ADC_STREAM_DMA_IT_TE );
+    DMA_ITConfig( ADC_STREAM_DMA_STREAM, DMA_IT_HT | DMA_IT_TC | DMA_IT_TE, ENABLE );
+    NVIC_EnableIRQ( ADC_STREAM_DMA_IRQ );
+    DMA_Cmd( ADC_STREAM_DMA_STREAM, ENABLE );
+
+    ADC_DMARequestAfterLastTransferCmd( adc->port, ENABLE );
+    ADC_DMACmd( adc->port, ENABLE );
+    ADC_Cmd( adc->port, ENABLE );
+
+    /* Trigger timer, update event on TRGO at sample_rate */
+    RCC_GetClocksFreq( &rcc_clock_frequencies );
+    RCC_APB1PeriphClockCmd( ADC_STREAM_TIMER_CLOCK, ENABLE );
+    if( rcc_clock_frequencies.PCLK1_Frequency == rcc_clock_frequencies.HCLK_Frequency )
+      timer_clock = rcc_clock_frequencies.PCLK1_Frequency;
+    else
+      timer_clock = rcc_clock_frequencies.PCLK1_Frequency * 2;
+
+    ticks = timer_clock / sample_rate;
+    if ( ticks < 2 ) ticks = 2;
+    prescaler = ticks >> 16;   /* keep the reload value within 16 bits */
+
+    TIM_TimeBaseStructInit( &tim_time_base_structure );
+    tim_time_base_structure.TIM_Prescaler     = (uint16_t) prescaler;
+    tim_time_base_structure.TIM_Period        = ticks / ( prescaler + 1 ) - 1;
+    tim_time_base_structure.TIM_ClockDivision = 0;
+    tim_time_base_structure.TIM_CounterMode   = TIM_CounterMode_Up;
+    TIM_TimeBaseInit( ADC_STREAM_TIMER, &tim_time_base_structure );
+    TIM_SelectOutputTrigger( ADC_STREAM_TIMER, TIM_TRGOSource_Update );
+    TIM_Cmd( ADC_STREAM_TIMER, ENABLE );
+
+exit:
+    return err;
+}
+
+OSStatus platform_adc_stream_stop( const platform_adc_t* adc )
+{
+    OSStatus err = kNoErr;
+
+    require_action_quiet( adc != NULL, exit, err = kParamErr);
+    require_action_quiet( adc_stream_callback != NULL && adc_stream_adc == adc, exit, err = kNotPreparedErr);
+
+    TIM_Cmd( ADC_STREAM_TIMER, DISABLE );
+    TIM_SelectOutputTrigger( ADC_STREAM_TIMER, TIM_TRGOSource_Reset );
+
+    DMA_ITConfig( ADC_STREAM_DMA_STREAM, DMA_IT_HT | DMA_IT_TC | DMA_IT_TE, DISABLE );
+    NVIC_DisableIRQ( ADC_STREAM_DMA_IRQ );
+    DMA_Cmd( ADC_STREAM_DMA_STREAM, DISABLE );
+    DMA_ClearITPendingBit( ADC_STREAM_DMA_STREAM, ADC_STREAM_DMA_IT_HT | ADC_STREAM_DMA_IT_TC | ADC_STREAM_DMA_IT_TE );
+
+    ADC_DMACmd( adc->port, DISABLE );
+    ADC_Cmd( adc->port, DISABLE );
+
+    adc_stream_callback = NULL;
+    adc_stream_adc      = NULL;
+
+    platform_mcu_powersave_enable();
+
+exit:
+    return err;
+}
+
+void platform_adc_stream_dma_irq( void )
+{
+    if ( DMA_GetITStatus( ADC_STREAM_DMA_STREAM, ADC_STREAM_DMA_IT_HT ) != RESET )
+    {
+        DMA_ClearITPendingBit( ADC_STREAM_DMA_STREAM, ADC_STREAM_DMA_IT_HT );
+        if ( adc_stream_callback != NULL )
+            adc_stream_callback( adc_stream_buffer, adc_stream_half, adc_stream_arg );
+    }
+
+    if ( DMA_GetITStatus( ADC_STREAM_DMA_STREAM, ADC_STREAM_DMA_IT_TC ) != RESET )
+    {
+        DMA_ClearITPendingBit( ADC_STREAM_DMA_STREAM, ADC_STREAM_DMA_IT_TC );
+        if ( adc_stream_callback != NULL )
+            adc_stream_callback( adc_stream_buffer + adc_stream_half, adc_stream_half, adc_stream_arg );
+    }
+
+    if ( DMA_GetITStatus( ADC_STREAM_DMA_STREAM, ADC_STREAM_DMA_IT_TE ) != RESET )
+    {
+        DMA_ClearITPendingBit( ADC_STREAM_DMA_STREAM, ADC_STREAM_DMA_IT_TE );
+    }
+}
 
@@ -269,6 +269,8 @@ void     platform_uart_rx_dma_irq            ( platform_uart_driver_t* driver );
 
 uint8_t  platform_spi_get_port_number        ( platform_spi_port_t* spi );
 
+void     platform_adc_stream_dma_irq         ( void );
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
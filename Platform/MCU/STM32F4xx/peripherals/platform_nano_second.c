@@ -57,9 +57,8 @@ const uint32_t NR_NS_PER_SECOND     = 1*1000*1000*1000;
     { \
         /* enable DWT hardware and cycle counting */ \
         CoreDebug->DEMCR = CoreDebug->DEMCR | CoreDebug_DEMCR_TRCENA_Msk; \
-        /* reset a counter */ \
-        DWT->CYCCNT = 0;  \
-        /* enable the counter */ \
+        /* enable the counter, it is never reset: the clock works on \
+           deltas and others take time stamps from it */ \
         DWT->CTRL = (DWT->CTRL | DWT_CTRL_CYCCNTENA_Msk) ; \
     } \
     while(0)
@@ -137,6 +136,7 @@ void platform_reset_nanosecond_clock(void)
 void platform_init_nanosecond_clock(void)
 {
     CYCLE_COUNTING_INIT();
+    prev_cycles = DWT->CYCCNT;
     nsclock_nsec = 0;
     nsclock_sec = 0;
     ns_divisor = 0;
@@ -158,6 +158,20 @@ OSStatus MicoAdcTakeSampleStream( mico_adc_t adc, void* buffer, uint16_t buffer_
   return (OSStatus) platform_adc_take_sample_stream( &platform_adc_peripherals[adc], buffer, buffer_length );
 }
 
+OSStatus MicoAdcStreamStart( mico_adc_t adc, uint32_t sample_rate, uint16_t* buffer, uint16_t buffer_length, mico_adc_stream_handler_t handler, void* arg )
+{
+  if ( adc >= MICO_ADC_NONE )
+    return kUnsupportedErr;
+  return (OSStatus) platform_adc_stream_start( &platform_adc_peripherals[adc], sample_rate, buffer, buffer_length, handler, arg );
+}
+
+OSStatus MicoAdcStreamStop( mico_adc_t adc )
+{
+  if ( adc >= MICO_ADC_NONE )
+    return kUnsupportedErr;
+  return (OSStatus) platform_adc_stream_stop( &platform_adc_peripherals[adc] );
+}
+
 OSStatus MicoGpioInitialize( mico_gpio_t gpio, mico_gpio_config_t configuration )
 {
   if ( gpio >= MICO_GPIO_NONE )
@@ -218,6 +218,12 @@ typedef enum
  */
 typedef void (*platform_gpio_irq_callback_t)( void* arg );
 
+/**
+ * ADC stream callback handler, called from interrupt context with each
+ * completed half of the circular sample buffer
+ */
+typedef void (*platform_adc_stream_callback_t)( uint16_t* samples, uint16_t count, void* arg );
+
 /******************************************************
  *                    Structures
  ******************************************************/
@@ -647,6 +653,31 @@ OSStatus platform_adc_take_sample( const platform_adc_t* adc, uint16_t* output )
 OSStatus platform_adc_take_sample_stream( const platform_adc_t* adc, uint16_t* buffer, uint16_t buffer_length );
 
 
+/**
+ * Start continuous ADC sampling
+ *
+ * @param[in] adc_interface : ADC interface
+ * @param[in] sample_rate   : conversions per second, paced by a hardware timer
+ * @param[in] buffer        : circular buffer filled by DMA
+ * @param[in] buffer_length : buffer length in samples, must be even
+ * @param[in] callback      : called with each half of the buffer once it is filled
+ * @param[in] arg           : argument passed to the callback
+ *
+ * @return @ref OSStatus
+ */
+OSStatus platform_adc_stream_start( const platform_adc_t* adc, uint32_t sample_rate, uint16_t* buffer, uint16_t buffer_length, platform_adc_stream_callback_t callback, void* arg );
+
+
+/**
+ * Stop continuous ADC sampling
+ *
+ * @param[in] adc_interface : ADC interface
+ *
+ * @return @ref OSStatus
+ */
+OSStatus platform_adc_stream_stop( const platform_adc_t* adc );
+
+
 /**
  * Initialise I2C interface
  *
@@ -0,0 +1,378 @@
+/*
+** adc_stream_sim.c
+** The sampling path of adc.stream(): halves of the circular DMA buffer of
+** platform_adc.c through ../lua/exlibs/adc_stream.c, checked against a
+** plain per sample decimation, then the CPU a sample costs, measured on
+** the host and on a cycle count model of the DMA interrupt, and the blocks
+** lost to a lua thread that is slower than the stream. See readme.txt.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "adc_stream.h"
+
+#define PROGNAME	"adc_stream_sim"
+#define HALF		(ADC_STREAM_DMA_LEN/2)
+
+/* Model parameters, cycles unless noted */
+static uint32_t mhz=96;			/* core clock */
+static uint32_t entry=12;		/* exception entry, and the same to leave */
+static uint32_t dispatch=40;		/* platform_adc_stream_dma_irq: flags, callback */
+static uint32_t sample=12;		/* a raw sample: load, min, max, sums, count */
+static uint32_t state=30;		/* adc_stream_feed: load and store the block state */
+static uint32_t output=25;		/* a decimated sample: divide, store, block full */
+static uint32_t post=250;		/* mico_rtos_push_to_queue from an ISR */
+static uint32_t call_us=500;		/* do_queue_task: lua_call and the full gc */
+static uint32_t elem_us=2;		/* per decimated sample into the table */
+
+/* The statistics of a block, the plain way: one sample at a time */
+typedef struct
+{
+ uint16_t data[ADC_STREAM_MAX_BLOCK];
+ uint16_t n, min, max;
+ uint32_t count, sum, drops;
+ uint64_t sum2;
+} Ref;
+
+/* What the stream posted, and how the reader answers */
+typedef struct
+{
+ Ref* blocks;
+ uint32_t nblocks, max;
+ int refuse;				/* post fails: a full os_queue */
+ int keep;				/* the reader does not release */
+} Sink;
+
+static bool sink_post(adc_block_t* b, void* arg)
+{
+ Sink* k=arg;
+ Ref* r;
+ if (k->refuse) return false;
+ if (k->nblocks<k->max)
+ {
+  r=&k->blocks[k->nblocks];
+  memcpy(r->data,b->data,b->n*sizeof(uint16_t));
+  r->n=b->n;
+  r->min=b->min;
+  r->max=b->max;
+  r->count=b->count;
+  r->sum=b->sum;
+  r->sum2=b->sum2;
+  r->drops=b->drops;
+ }
+ k->nblocks++;
+ if (!k->keep) adc_stream_release(b);
+ return true;
+}
+
+static int failures=0;
+
+#define check(cond) do { if (!(cond)) { \
+    printf("FAIL %s:%d: %s\n",__FILE__,__LINE__,#cond); failures++; } } while (0)
+
+static uint32_t next_random(uint32_t* state)
+{
+ uint32_t x=*state;
+ x^=x<<13;
+ x^=x>>17;
+ x^=x<<5;
+ return *state=x;
+}
+
+/* 12 bit samples: a sine with noise, a constant, or full scale noise */
+static void signal(uint16_t* s, uint32_t n, uint32_t kind, uint32_t* seed, uint32_t* phase)
+{
+ static const int16_t sine[16]={ 0,392,724,946,1024,946,724,392,0,-392,-724,-946,-1024,-946,-724,-392 };
+ uint32_t i;
+ for (i=0; i<n; i++, (*phase)++)
+  switch (kind)
+  {
+   case 0: s[i]=(uint16_t)(2048+sine[(*phase/3)&15]+(int)(next_random(seed)%64)-32); break;
+   case 1: s[i]=4095; break;
+   default: s[i]=(uint16_t)(next_random(seed)&0xFFF); break;
+  }
+}
+
+static int same(const Ref* a, const Ref* b)
+{
+ return a->n==b->n && a->min==b->min && a->max==b->max && a->count==b->count &&
+  a->sum==b->sum && a->sum2==b->sum2 && a->drops==b->drops &&
+  memcmp(a->data,b->data,a->n*sizeof(uint16_t))==0;
+}
+
+/* Random streams in halves of the DMA buffer and in odd pieces, every
+   block as the plain per sample loop computes it */
+static void check_blocks(void)
+{
+ static uint16_t raw[1<<16];
+ static Ref got[64], want[64];
+ static uint8_t mem0[ADC_BLOCK_SIZE(ADC_STREAM_MAX_BLOCK)], mem1[ADC_BLOCK_SIZE(ADC_STREAM_MAX_BLOCK)];
+ adc_block_t *b0=(adc_block_t*)mem0, *b1=(adc_block_t*)mem1;
+ uint32_t seed=11, t;
+ for (t=0; t<3000 && failures<10; t++)
+ {
+  adc_stream_t s;
+  Sink k={ got, 0, 64, 0, 0 };
+  uint32_t blocksize, decim, total, i, pos, phase=0, nwant=0, dec_n=0, dec_acc=0;
+  Ref* w=&want[0];
+  blocksize=1+next_random(&seed)%((t&1) ? 8 : ADC_STREAM_MAX_BLOCK);
+  decim=(t%9==0) ? ADC_STREAM_MAX_DECIM : 1+next_random(&seed)%((t&2) ? 7 : 300);
+  total=next_random(&seed)%(sizeof(raw)/sizeof(raw[0]));
+  if (t%9==0) { blocksize=(t%18==0) ? ADC_STREAM_MAX_BLOCK : 3; total=(uint32_t)blocksize*decim; }
+  if (total>sizeof(raw)/sizeof(raw[0])) total=sizeof(raw)/sizeof(raw[0]);
+  signal(raw,total,(t%9==0) ? 1 : t%3,&seed,&phase);
+
+  /* the plain loop */
+  memset(w,0,sizeof(*w));
+  w->min=0xFFFF;
+  for (i=0; i<total && nwant<64; i++)
+  {
+   uint16_t v=raw[i];
+   if (v<w->min) w->min=v;
+   if (v>w->max) w->max=v;
+   w->sum+=v;
+   w->sum2+=(uint32_t)v*v;
+   w->count++;
+   dec_acc+=v;
+   if (++dec_n<decim) continue;
+   w->data[w->n++]=(uint16_t)((dec_acc+(decim>>1))/decim);
+   dec_acc=0;
+   dec_n=0;
+   if (w->n<blocksize) continue;
+   w=&want[++nwant];
+   if (nwant<64) { memset(w,0,sizeof(*w)); w->min=0xFFFF; }
+  }
+
+  adc_stream_init(&s,b0,b1,blocksize,decim,sink_post,&k);
+  for (pos=0; pos<total; )
+  {
+   uint32_t n=(t&4) ? 1+next_random(&seed)%700 : HALF;
+   if (n>total-pos) n=total-pos;
+   adc_stream_feed(&s,raw+pos,(uint16_t)n);
+   pos+=n;
+  }
+  check(k.nblocks==nwant || (nwant==64 && k.nblocks>=64));
+  for (i=0; i<k.nblocks && i<64; i++)
+   if (!same(&got[i],&want[i])) { check(same(&got[i],&want[i])); break; }
+  check(s.drops==0);
+ }
+}
+
+/* A reader that keeps its block: the next one is dropped and counted, a
+   post that fails drops its block, a block carries the drops before it */
+static void check_drops(void)
+{
+ static uint16_t raw[4096];
+ static Ref got[16];
+ static uint8_t mem0[ADC_BLOCK_SIZE(8)], mem1[ADC_BLOCK_SIZE(8)];
+ adc_block_t *b0=(adc_block_t*)mem0, *b1=(adc_block_t*)mem1;
+ adc_stream_t s;
+ Sink k={ got, 0, 16, 0, 1 };
+ uint32_t seed=3, phase=0;
+
+ signal(raw,4096,0,&seed,&phase);
+ adc_stream_init(&s,b0,b1,8,4,sink_post,&k);
+ adc_stream_feed(&s,raw,32*5);		/* 5 blocks of 32 samples */
+ check(k.nblocks==1 && s.drops==4 && b0->busy && !b1->busy);
+ adc_stream_release(b0);
+ adc_stream_feed(&s,raw,32);
+ check(k.nblocks==2 && got[1].drops==4 && b1->busy);
+ check(got[1].count==32 && got[1].n==8);
+
+ k.refuse=1;
+ adc_stream_release(b1);
+ adc_stream_feed(&s,raw,64);
+ check(k.nblocks==2 && s.drops==6 && !b0->busy && !b1->busy);
+ k.refuse=0;
+ adc_stream_feed(&s,raw,32);
+ check(k.nblocks==3 && got[2].drops==6 && got[2].count==32);
+}
+
+static double now_ns(void)
+{
+ struct timespec ts;
+ clock_gettime(CLOCK_MONOTONIC,&ts);
+ return ts.tv_sec*1e9+ts.tv_nsec;
+}
+
+/* The loop of adc.c before adc_stream.c: the statistics through the block */
+typedef struct
+{
+ uint16_t n, min, max;
+ uint32_t count, sum;
+ uint64_t sum2;
+ uint16_t data[ADC_STREAM_MAX_BLOCK];
+} Old;
+
+static uint32_t old_dec_n, old_dec_acc;
+
+static void old_feed(Old* b, const uint16_t* samples, uint16_t count, uint16_t decim, uint16_t blocksize)
+{
+ uint16_t i;
+ for (i=0; i<count; i++)
+ {
+  uint16_t v=samples[i];
+  if (v<b->min) b->min=v;
+  if (v>b->max) b->max=v;
+  b->sum+=v;
+  b->sum2+=(uint32_t)v*v;
+  b->count++;
+  old_dec_acc+=v;
+  if (++old_dec_n<decim) continue;
+  b->data[b->n++]=(uint16_t)((old_dec_acc+(decim>>1))/decim);
+  old_dec_acc=0;
+  old_dec_n=0;
+  if (b->n<blocksize) continue;
+  b->n=0; b->count=0; b->sum=0; b->sum2=0; b->min=0xFFFF; b->max=0;
+ }
+}
+
+/* ns per sample on the host, halves of the DMA buffer */
+static void host_cost(uint16_t blocksize, uint16_t decim, uint32_t samples, double* now, double* old)
+{
+ static uint16_t raw[ADC_STREAM_DMA_LEN];
+ static uint8_t mem0[ADC_BLOCK_SIZE(ADC_STREAM_MAX_BLOCK)], mem1[ADC_BLOCK_SIZE(ADC_STREAM_MAX_BLOCK)];
+ static Ref sinkbuf[1];
+ static Old o;
+ adc_stream_t s;
+ Sink k={ sinkbuf, 0, 0, 0, 0 };
+ uint32_t seed=5, phase=0, i, halves=samples/HALF;
+ double t;
+
+ signal(raw,ADC_STREAM_DMA_LEN,0,&seed,&phase);
+ adc_stream_init(&s,(adc_block_t*)mem0,(adc_block_t*)mem1,blocksize,decim,sink_post,&k);
+ t=now_ns();
+ for (i=0; i<halves; i++) adc_stream_feed(&s,raw+(i&1)*HALF,HALF);
+ *now=(now_ns()-t)/((double)halves*HALF);
+
+ memset(&o,0,sizeof(o));
+ o.min=0xFFFF;
+ old_dec_n=old_dec_acc=0;
+ t=now_ns();
+ for (i=0; i<halves; i++) old_feed(&o,raw+(i&1)*HALF,HALF,decim,blocksize);
+ *old=(now_ns()-t)/((double)halves*HALF);
+ if (o.n==0xFFFF) printf("\n");		/* keep the result alive */
+}
+
+/* The DMA interrupt on the cycle model, per second at rate */
+static double isr_cycles(uint32_t rate, uint16_t blocksize, uint16_t decim)
+{
+ double halves=(double)rate/HALF, outputs=(double)rate/decim, blocks=outputs/blocksize;
+ return halves*(2*entry+dispatch+state)+(double)rate*sample+outputs*output+blocks*(post+state);
+}
+
+/* The stream against a lua thread that takes call_us plus elem_us per
+   decimated sample for a block; blocks lost per second of the stream */
+static double lua_drops(uint32_t rate, uint16_t blocksize, uint16_t decim, double seconds)
+{
+ static uint16_t raw[HALF];
+ static uint8_t mem0[ADC_BLOCK_SIZE(ADC_STREAM_MAX_BLOCK)], mem1[ADC_BLOCK_SIZE(ADC_STREAM_MAX_BLOCK)];
+ static Ref sinkbuf[1];
+ adc_stream_t s;
+ Sink k={ sinkbuf, 0, 0, 0, 1 };
+ uint32_t seed=9, phase=0, posted=0;
+ uint64_t i, halves=(uint64_t)(seconds*rate/HALF);
+ double t, busy_until=0, cost=(call_us+elem_us*(double)blocksize)*1e-6;
+ adc_block_t* held=NULL;
+ adc_block_t *b0=(adc_block_t*)mem0, *b1=(adc_block_t*)mem1;
+
+ signal(raw,HALF,0,&seed,&phase);
+ adc_stream_init(&s,b0,b1,blocksize,decim,sink_post,&k);
+ for (i=1; i<=halves; i++)
+ {
+  t=(double)i*HALF/rate;
+  if (held!=NULL && t>=busy_until) { adc_stream_release(held); held=NULL; }
+  adc_stream_feed(&s,raw,HALF);
+  if (k.nblocks!=posted)
+  {
+   posted=k.nblocks;
+   held=b0->busy ? b0 : b1;
+   busy_until=(busy_until>t ? busy_until : t)+cost;
+  }
+ }
+ return s.drops/seconds;
+}
+
+static void bench(uint32_t samples)
+{
+ static const struct { uint32_t rate; uint16_t blocksize, decim; } cases[]=
+ {
+  { 1000, 100, 1 },
+  { 10000, 100, 10 },
+  { 10000, 512, 1 },
+  { 100000, 100, 100 },
+  { 100000, 512, 16 },
+  { 100000, 512, 1 },
+  { 100000, 64, 1 },
+  { 100000, 32, 1 },
+  { 100000, 100, 1024 },
+ };
+ unsigned i;
+
+ printf("per raw sample: host ns (adc_stream.c, the loop of adc.c before it); the DMA interrupt\n"
+        "on the model at %u MHz, its share of the CPU; blocks per second, and lost per second\n"
+        "to a lua thread of %u us + %u us per value\n",mhz,call_us,elem_us);
+ printf("  %7s %6s %6s  %8s %8s  %8s %7s  %9s %9s\n","rate","block","decim","host ns","before",
+  "cycles","cpu %","blocks/s","lost/s");
+ for (i=0; i<sizeof(cases)/sizeof(cases[0]); i++)
+ {
+  uint32_t r=cases[i].rate;
+  uint16_t bs=cases[i].blocksize, d=cases[i].decim;
+  double now, old, c=isr_cycles(r,bs,d);
+  host_cost(bs,d,samples,&now,&old);
+  printf("  %7u %6u %6u  %8.2f %8.2f  %8.1f %7.2f  %9.1f %9.1f\n",r,bs,d,now,old,c/r,
+   c/(mhz*1e4),(double)r/d/bs,lua_drops(r,bs,d,10.0));
+ }
+}
+
+static void usage(const char* message)
+{
+ if (message!=NULL) fprintf(stderr,"%s: %s\n",PROGNAME,message);
+ fprintf(stderr,
+ "usage: %s [options]\n"
+ "  -k       self check only\n"
+ "  -n n     samples timed on the host per case (default 20000000)\n"
+ "  -f MHz   core clock (default 96)\n"
+ "  -s n     cycles of a raw sample in the interrupt (default 12)\n"
+ "  -o n     cycles of a decimated sample (default 25)\n"
+ "  -p n     cycles of a queue post from an ISR (default 250)\n"
+ "  -c us    lua call and full gc per block (default 500)\n"
+ "  -e us    per decimated sample into the lua table (default 2)\n",
+ PROGNAME);
+ exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+ int i, check_only=0;
+ uint32_t samples=20000000;
+ for (i=1; i<argc; i++)
+ {
+  if (strcmp(argv[i],"-k")==0) check_only=1;
+  else if (i+1==argc) usage("bad option");
+  else if (strcmp(argv[i],"-n")==0) samples=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-f")==0) mhz=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-s")==0) sample=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-o")==0) output=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-p")==0) post=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-c")==0) call_us=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-e")==0) elem_us=atoi(argv[++i]);
+  else usage("bad option");
+ }
+ if (mhz==0) usage("bad clock");
+ if (samples<HALF) usage("bad sample count");
+
+ printf("self check\n");
+ check_blocks();
+ check_drops();
+ printf("%s\n",failures==0 ? "  ok" : "  FAILED");
+ if (check_only || failures!=0) return failures!=0;
+ bench(samples);
+ return 0;
+}
@@ -0,0 +1,28 @@
+/*
+** bitbang_host.h
+** What ../lua/exlibs/bitbang.h takes from the MCU, for bitbang_sim: the
+** cycle counter, the GPIO registers and the interrupt mask are the mock
+** of bitbang_sim.c. See readme.txt.
+*/
+
+#ifndef BITBANG_HOST_H
+#define BITBANG_HOST_H
+
+#include <stdint.h>
+
+typedef struct sim_port bb_port_t;
+
+uint32_t sim_cycles(void);
+void sim_write(bb_port_t* port, uint32_t bsrr);
+int sim_read(bb_port_t* port, uint32_t mask);
+uint32_t sim_irq_save(void);
+void sim_irq_restore(uint32_t state);
+
+#define BB_CYCLES_ENABLE()	do { } while (0)
+#define BB_CYCLES()		sim_cycles()
+#define BB_WRITE(port, bsrr)	sim_write((port),(bsrr))
+#define BB_READ(port, mask)	sim_read((port),(mask))
+#define BB_IRQ_SAVE(s)		((s)=sim_irq_save())
+#define BB_IRQ_RESTORE(s)	sim_irq_restore(s)
+
+#endif
@@ -0,0 +1,616 @@
+/*
+** bitbang_sim.c
+** The bit banged I2C and 1-Wire of ../lua/exlibs/bitbang.c against a mock
+** GPIO port on a cycle count model of the MCU: every edge is stamped, an
+** I2C slave and a 1-Wire slave answer on the mock bus and check the timing
+** of the master against the bus specifications, under random interrupts
+** and clock stretching. See readme.txt.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitbang.h"
+
+#define PROGNAME	"bitbang_sim"
+#define SDA		0		/* pins of the mock port */
+#define SCL		1
+#define OW		2
+#define PINS		((1u<<SDA)|(1u<<SCL)|(1u<<OW))
+#define EVENTS		8
+#define I2C_ADDR	0x3C
+
+/* Model parameters, cycles unless noted */
+static uint32_t mhz=96;			/* core clock */
+static uint32_t op=4;			/* a register access with its loop */
+static uint32_t irq_gap_us=200;		/* mean time between interrupts, 0: none */
+static uint32_t irq_max_us=40;		/* longest handler */
+static uint32_t stretch_us=20;		/* longest I2C clock stretch */
+static int irq_mask=1;			/* 0: BB_IRQ_SAVE() masks nothing */
+static int report=1;			/* print the first violations */
+
+/* The mock: outputs of the master, lines of the bus, slave events */
+struct sim_port { uint32_t out; };	/* a set bit is released */
+static struct sim_port port={ PINS };
+
+typedef struct { uint32_t t; uint32_t pin; int low; } Event;
+
+static uint32_t now=0xFFF00000u;	/* wraps early in a run */
+static uint32_t lines=PINS;		/* what the bus reads */
+static uint32_t slave_low;		/* pins the slaves pull low */
+static Event events[EVENTS];
+static int nevents;
+static int masked, pending;
+static int64_t irq_in;
+static uint64_t irqs, clock_cycles;
+static uint32_t seed=7;
+
+static int failures=0;
+
+#define check(cond) do { if (!(cond)) { \
+    printf("FAIL %s:%d: %s\n",__FILE__,__LINE__,#cond); failures++; } } while (0)
+
+static uint32_t next_random(void)
+{
+ uint32_t x=seed;
+ x^=x<<13;
+ x^=x>>17;
+ x^=x<<5;
+ return seed=x;
+}
+
+static uint32_t us(double us) { return (uint32_t)(us*mhz+0.999); }
+static int before(uint32_t a, uint32_t b) { return (int32_t)(a-b)<0; }
+
+static void i2c_line(uint32_t pin, int level);
+static void ow_master(int released);
+static void ow_sample(void);
+
+/* Lines from the outputs, each change to the I2C slave */
+static void update(void)
+{
+ uint32_t changed;
+ do
+ {
+  uint32_t next=port.out & ~slave_low & PINS;
+  changed=next^lines;
+  lines=next;
+  if (changed & (1u<<SDA)) i2c_line(SDA,(lines>>SDA)&1);
+  if (changed & (1u<<SCL)) i2c_line(SCL,(lines>>SCL)&1);
+ } while (changed!=0);
+}
+
+static void schedule(uint32_t t, uint32_t pin, int low)
+{
+ int i=nevents++;
+ if (nevents>EVENTS) { printf("%s: too many events\n",PROGNAME); exit(EXIT_FAILURE); }
+ for (; i>0 && before(t,events[i-1].t); i--) events[i]=events[i-1];
+ events[i].t=t;
+ events[i].pin=pin;
+ events[i].low=low;
+}
+
+/* Time goes on by n cycles, the slaves act on the way */
+static void advance(uint32_t n)
+{
+ uint32_t end=now+n;
+ while (nevents>0 && !before(end,events[0].t))
+ {
+  Event e=events[0];
+  memmove(events,events+1,--nevents*sizeof(Event));
+  now=e.t;
+  if (e.low) slave_low|=1u<<e.pin; else slave_low&=~(1u<<e.pin);
+  update();
+ }
+ now=end;
+}
+
+static void interrupt(void)
+{
+ irqs++;
+ advance(1+next_random()%us(irq_max_us));
+ irq_in=next_random()%(2*us(irq_gap_us)+1);
+}
+
+static void tick(uint32_t cost)
+{
+ advance(cost);
+ if (irq_gap_us==0 || (irq_in-=cost)>0) return;
+ if (masked) pending=1;
+ else interrupt();
+}
+
+uint32_t sim_cycles(void)
+{
+ tick(op);
+ return now;
+}
+
+void sim_write(bb_port_t* p, uint32_t bsrr)
+{
+ uint32_t old=p->out;
+ tick(op);
+ p->out=(p->out|(bsrr&0xFFFF))&~(bsrr>>16);
+ if ((old^p->out) & (1u<<OW)) ow_master((p->out>>OW)&1);
+ update();
+}
+
+int sim_read(bb_port_t* p, uint32_t mask)
+{
+ tick(op);
+ if (mask & (1u<<OW)) ow_sample();
+ return (lines & mask)!=0;
+}
+
+uint32_t sim_irq_save(void)
+{
+ uint32_t s=masked;
+ if (irq_mask) masked=1;
+ return s;
+}
+
+void sim_irq_restore(uint32_t s)
+{
+ masked=s;
+ if (!masked && pending) { pending=0; interrupt(); }
+}
+
+static void slave_drive(uint32_t pin, int low)
+{
+ if (low) slave_low|=1u<<pin; else slave_low&=~(1u<<pin);
+}
+
+/* == I2C slave: a 256 byte memory at I2C_ADDR, the first byte written sets
+   the pointer. Checks the timing of the master, the minimums in cycles == */
+typedef struct { uint32_t low, high, su_sta, hd_sta, su_sto, buf, su_dat; } I2cSpec;
+
+static struct
+{
+ I2cSpec spec;
+ uint32_t rise, fall, sda_at, start_at, stop_at;
+ int stopped, after_start, bit, rx, first, addressed, reading, acked, pointed;
+ uint8_t shift, ptr, mem[256];
+ uint64_t violations, clocks;
+} i2c;
+
+static void i2c_violation(const char* what, uint32_t have, uint32_t need)
+{
+ if (i2c.violations++<5 && report)
+  printf("  i2c %s: %.2f us, needs %.2f us\n",what,(double)have/mhz,(double)need/mhz);
+}
+
+static void i2c_spec(uint32_t hz)
+{
+ I2cSpec standard={ us(4.7), us(4.0), us(4.7), us(4.0), us(4.0), us(4.7), us(0.25) };
+ I2cSpec fast={ us(1.3), us(0.6), us(0.6), us(0.6), us(0.6), us(1.3), us(0.1) };
+ i2c.spec=(hz<=100000) ? standard : fast;
+ i2c.stopped=1;
+ i2c.stop_at=now-i2c.spec.buf;
+ i2c.addressed=0;
+}
+
+static void i2c_send_bit(void)
+{
+ slave_drive(SDA,!((i2c.mem[i2c.ptr]>>(7-i2c.bit))&1));
+}
+
+static void i2c_line(uint32_t pin, int level)
+{
+ uint32_t t=now;
+ const I2cSpec* s=&i2c.spec;
+ if (pin==SDA)
+ {
+  if (!((lines>>SCL)&1)) { i2c.sda_at=t; return; }
+  if (!level)					/* start */
+  {
+   if (i2c.stopped && t-i2c.stop_at<s->buf) i2c_violation("tBUF",t-i2c.stop_at,s->buf);
+   if (!i2c.stopped && t-i2c.rise<s->su_sta) i2c_violation("tSU;STA",t-i2c.rise,s->su_sta);
+   i2c.start_at=t;
+   i2c.after_start=1;
+   i2c.stopped=0;
+   i2c.bit=0;
+   i2c.rx=1;
+   i2c.first=1;
+   i2c.addressed=0;
+  }
+  else						/* stop */
+  {
+   if (t-i2c.rise<s->su_sto) i2c_violation("tSU;STO",t-i2c.rise,s->su_sto);
+   i2c.stopped=1;
+   i2c.stop_at=t;
+   i2c.addressed=0;
+  }
+  return;
+ }
+ if (level)					/* SCL rise */
+ {
+  i2c.clocks++;
+  if (!i2c.stopped && !i2c.after_start)
+  {
+   if (t-i2c.fall<s->low) i2c_violation("tLOW",t-i2c.fall,s->low);
+   if (before(i2c.fall,i2c.sda_at) && t-i2c.sda_at<s->su_dat)
+    i2c_violation("tSU;DAT",t-i2c.sda_at,s->su_dat);
+  }
+  i2c.rise=t;
+  if (i2c.bit<8 && i2c.rx) i2c.shift=(uint8_t)(i2c.shift<<1)|((lines>>SDA)&1);
+  if (i2c.bit==8 && !i2c.rx) i2c.acked=!((lines>>SDA)&1);
+  return;
+ }
+ i2c.fall=t;					/* SCL fall */
+ if (i2c.after_start)				/* the end of a start */
+ {
+  if (t-i2c.start_at<s->hd_sta) i2c_violation("tHD;STA",t-i2c.start_at,s->hd_sta);
+  i2c.after_start=0;
+  return;
+ }
+ if (t-i2c.rise<s->high) i2c_violation("tHIGH",t-i2c.rise,s->high);
+ if (i2c.stopped || (!i2c.first && !i2c.addressed)) return;
+ i2c.bit++;
+ if (i2c.bit==8)
+ {
+  if (!i2c.rx) { slave_drive(SDA,0); return; }	/* the master acks */
+  if (i2c.first)
+  {
+   i2c.addressed=(i2c.shift>>1)==I2C_ADDR;
+   i2c.reading=i2c.shift&1;
+   i2c.pointed=0;
+   i2c.first=0;
+  }
+  else if (!i2c.pointed) { i2c.ptr=i2c.shift; i2c.pointed=1; }
+  else i2c.mem[i2c.ptr++]=i2c.shift;
+  if (i2c.addressed) slave_drive(SDA,1);
+ }
+ else if (i2c.bit==9)
+ {
+  i2c.bit=0;
+  slave_drive(SDA,0);
+  if (i2c.rx)
+  {
+   if (next_random()%8==0)			/* hold SCL a while */
+   {
+    slave_drive(SCL,1);
+    schedule(t+1+next_random()%us(stretch_us),SCL,0);
+   }
+   if (i2c.addressed && i2c.reading) { i2c.rx=0; i2c_send_bit(); }
+  }
+  else
+  {
+   i2c.ptr++;
+   if (i2c.acked) i2c_send_bit();
+   else i2c.addressed=0;
+  }
+ }
+ else if (!i2c.rx) i2c_send_bit();
+}
+
+/* == 1-Wire slave: a DS18B20 that knows read rom, skip rom, read
+   scratchpad and convert. Checks the slots of the master == */
+enum { OW_IDLE, OW_COMMAND, OW_SEND };
+
+static uint8_t ow_rom[8]={ 0x28, 0x61, 0x64, 0x12, 0x3C, 0x7C, 0x2F, 0 };
+static uint8_t ow_pad[9]={ 0x91, 0x01, 0x4B, 0x46, 0x7F, 0xFF, 0x0F, 0x10, 0 };
+
+static struct
+{
+ uint32_t fell, rose, reset_at;
+ int state, bits, slot_send, sampled, reset_window, slots;
+ uint8_t shift;
+ const uint8_t* data;
+ int count, index;
+ uint64_t violations, late;
+} ow;
+
+static void ow_violation(const char* what, uint32_t have)
+{
+ if (ow.violations++<5 && report) printf("  1-wire %s: %.2f us\n",what,(double)have/mhz);
+}
+
+static void ow_send(const uint8_t* data, int count)
+{
+ ow.state=OW_SEND;
+ ow.data=data;
+ ow.count=count;
+ ow.index=0;
+}
+
+static void ow_command(uint8_t cmd)
+{
+ ow.bits=0;
+ switch (cmd)
+ {
+  case 0x33: ow_send(ow_rom,8); break;		/* read rom */
+  case 0xCC: ow.state=OW_COMMAND; break;	/* skip rom, a function follows */
+  case 0xBE: ow_send(ow_pad,9); break;		/* read scratchpad */
+  default: ow.state=OW_IDLE; break;		/* convert and the rest */
+ }
+}
+
+static void ow_master(int released)
+{
+ uint32_t t=now, low;
+ if (!released)
+ {
+  if (ow.reset_window && t-ow.rose<us(480)) ow_violation("reset high",t-ow.rose);
+  else if (ow.slots && t-ow.fell<us(61)) ow_violation("slot",t-ow.fell);
+  else if (ow.slots && t-ow.rose<us(1)) ow_violation("recovery",t-ow.rose);
+  ow.fell=t;
+  ow.sampled=0;
+  ow.slot_send=(ow.state==OW_SEND);
+  if (ow.slot_send)
+  {
+   int bit=(ow.data[ow.index]>>ow.bits)&1;
+   if (!bit)					/* hold the line for a 0 */
+   {
+    schedule(t,OW,1);
+    schedule(t+us(25),OW,0);
+   }
+   if (++ow.bits==8)
+   {
+    ow.bits=0;
+    if (++ow.index==ow.count) ow.state=OW_IDLE;
+   }
+  }
+  return;
+ }
+ low=t-ow.fell;
+ ow.rose=t;
+ ow.reset_window=0;
+ ow.slots=1;
+ if (low>=us(480))				/* reset, then the presence pulse */
+ {
+  ow.reset_window=1;
+  ow.slots=0;
+  ow.state=OW_COMMAND;
+  ow.bits=0;
+  schedule(t+us(30),OW,1);
+  schedule(t+us(150),OW,0);
+  return;
+ }
+ if (low<us(1)) { ow_violation("low",low); return; }
+ if (ow.slot_send)
+ {
+  if (low>=us(15)) ow_violation("read low",low);
+  return;
+ }
+ if (low>=us(15) && low<us(60)) ow_violation("write low",low);
+ if (low>us(120)) ow_violation("write 0 low",low);
+ if (ow.state!=OW_COMMAND) return;
+ ow.shift=(uint8_t)(ow.shift>>1)|((low<us(15)) ? 0x80 : 0);
+ if (++ow.bits==8) ow_command(ow.shift);
+}
+
+static void ow_sample(void)
+{
+ if (!ow.slot_send || ow.sampled || !((port.out>>OW)&1)) return;
+ ow.sampled=1;
+ if (now-ow.fell>=us(15)) { ow.late++; ow_violation("late sample",now-ow.fell); }
+}
+
+static uint8_t crc8(const uint8_t* p, int n)
+{
+ uint8_t crc=0;
+ while (n--)
+ {
+  uint8_t in=*p++;
+  int i;
+  for (i=0; i<8; i++)
+  {
+   int mix=(crc^in)&1;
+   crc>>=1;
+   if (mix) crc^=0x8C;
+   in>>=1;
+  }
+ }
+ return crc;
+}
+
+/* == runs == */
+
+typedef struct { uint64_t runs, bad, bytes, cycles; } Run;
+
+/* Writes a few bytes at a random pointer, reads them back after a repeated
+   start, and now and then addresses nobody */
+static void i2c_run(uint32_t hz, int n, Run* r)
+{
+ bb_pin_t sda, scl;
+ bb_i2c_t b;
+ uint8_t data[16];
+ int k;
+ memset(r,0,sizeof(*r));
+ memset(&i2c,0,sizeof(i2c));
+ i2c_spec(hz);
+ bb_pin(&sda,&port,SDA);
+ bb_pin(&scl,&port,SCL);
+ bb_i2c_init(&b,&sda,&scl,hz,mhz);
+ for (k=0; k<n; k++)
+ {
+  uint32_t t0=now;
+  int i, count=1+next_random()%16, bad=0;
+  uint8_t reg=(uint8_t)next_random();
+  for (i=0; i<count; i++) data[i]=(uint8_t)next_random();
+
+  bb_i2c_start(&b);
+  bad|=bb_i2c_write(&b,I2C_ADDR<<1)!=0;
+  bad|=bb_i2c_write(&b,reg)!=0;
+  for (i=0; i<count; i++) bad|=bb_i2c_write(&b,data[i])!=0;
+  bb_i2c_stop(&b);
+  for (i=0; i<count; i++) bad|=i2c.mem[(uint8_t)(reg+i)]!=data[i];
+
+  bb_i2c_start(&b);
+  bad|=bb_i2c_write(&b,I2C_ADDR<<1)!=0;
+  bad|=bb_i2c_write(&b,reg)!=0;
+  bb_i2c_start(&b);
+  bad|=bb_i2c_write(&b,(I2C_ADDR<<1)|1)!=0;
+  for (i=0; i<count; i++) bad|=bb_i2c_read(&b,i<count-1)!=data[i];
+  bb_i2c_stop(&b);
+
+  if (k%8==0)
+  {
+   bb_i2c_start(&b);
+   bad|=bb_i2c_write(&b,(I2C_ADDR+1)<<1)!=-1;
+   bb_i2c_stop(&b);
+  }
+  r->runs++;
+  r->bad+=bad;
+  r->bytes+=2*count+5;
+  r->cycles+=now-t0;
+ }
+ clock_cycles=i2c.clocks;
+}
+
+/* Reads the rom and the scratchpad, as sensor.ds18b20 does */
+static void ow_run(int n, Run* r)
+{
+ bb_pin_t pin;
+ bb_ow_t w;
+ int k;
+ memset(r,0,sizeof(*r));
+ memset(&ow,0,sizeof(ow));
+ ow_rom[7]=crc8(ow_rom,7);
+ ow_pad[8]=crc8(ow_pad,8);
+ bb_pin(&pin,&port,OW);
+ bb_ow_init(&w,&pin,mhz);
+ for (k=0; k<n; k++)
+ {
+  uint32_t t0=now;
+  uint8_t got[9];
+  int i, bad=0;
+  bad|=bb_ow_reset(&w)!=0;
+  bb_ow_write_byte(&w,0x33);
+  for (i=0; i<8; i++) got[i]=bb_ow_read_byte(&w);
+  bad|=memcmp(got,ow_rom,8)!=0;
+  bad|=bb_ow_reset(&w)!=0;
+  bb_ow_write_byte(&w,0xCC);
+  bb_ow_write_byte(&w,0xBE);
+  for (i=0; i<9; i++) got[i]=bb_ow_read_byte(&w);
+  bad|=crc8(got,8)!=got[8] || memcmp(got,ow_pad,9)!=0;
+  /* a conversion is done when a read slot gets a 1 */
+  bad|=bb_ow_reset(&w)!=0;
+  bb_ow_write_byte(&w,0xCC);
+  bb_ow_write_byte(&w,0x44);
+  bad|=bb_ow_read_bit(&w)!=1;
+  r->runs++;
+  r->bad+=bad;
+  r->bytes+=21;
+  r->cycles+=now-t0;
+ }
+}
+
+/* A pulse the slave puts on the 1-Wire pin, measured by bb_pulse() */
+static void check_pulse(void)
+{
+ bb_pin_t pin;
+ int k;
+ bb_pin(&pin,&port,OW);
+ bb_high(&pin);
+ for (k=0; k<200 && failures<10; k++)
+ {
+  uint32_t len=us(1+next_random()%100), at=now+us(next_random()%50), got;
+  schedule(at,OW,1);
+  schedule(at+len,OW,0);
+  advance(1);
+  got=bb_pulse(&pin,0,us(200));
+  check(got+3*op>=len && got<=len+3*op);
+  advance(us(200));
+ }
+ check(bb_pulse(&pin,0,us(20))==0);
+}
+
+static void self_check(void)
+{
+ static const uint32_t speeds[]={ 100000, 400000 };
+ Run r;
+ unsigned i;
+ for (i=0; i<sizeof(speeds)/sizeof(speeds[0]); i++)
+ {
+  i2c_run(speeds[i],300,&r);
+  printf("  i2c %3u kHz: %llu transfers, %llu bad, %llu timing violations\n",
+   speeds[i]/1000,(unsigned long long)r.runs,(unsigned long long)r.bad,
+   (unsigned long long)i2c.violations);
+  check(r.bad==0 && i2c.violations==0);
+ }
+ ow_run(100,&r);
+ printf("  1-wire: %llu transactions, %llu bad, %llu timing violations, %llu interrupts\n",
+  (unsigned long long)r.runs,(unsigned long long)r.bad,
+  (unsigned long long)ow.violations,(unsigned long long)irqs);
+ check(r.bad==0 && ow.violations==0);
+ check_pulse();
+}
+
+static void bench(void)
+{
+ static const uint32_t speeds[]={ 100000, 400000 };
+ uint32_t gap=irq_gap_us;
+ Run r;
+ unsigned i;
+
+ report=0;
+ printf("i2c, write and read back with a repeated start, no interrupts\n");
+ printf("  %8s  %8s  %8s  %10s\n","asked","SCL kHz","us/byte","violations");
+ irq_gap_us=0;
+ for (i=0; i<sizeof(speeds)/sizeof(speeds[0]); i++)
+ {
+  i2c_run(speeds[i],100,&r);
+  printf("  %4u kHz  %8.0f  %8.2f  %10llu\n",speeds[i]/1000,
+   clock_cycles*1e3*mhz/r.cycles,(double)r.cycles/r.bytes/mhz,
+   (unsigned long long)i2c.violations);
+ }
+ irq_gap_us=gap;
+ /* the old IIC_Send_Byte(): per bit 2 x I2C_speed and 4 MicoGpio calls */
+ printf("  old i2c.c: about %.0f kHz\n",mhz*1e3/(2*360+4*40));
+
+ printf("1-wire rom and scratchpad reads, interrupts every %u us on average, up to %u us long\n",
+  irq_gap_us,irq_max_us);
+ printf("  %-26s  %8s  %10s  %s\n","","failed","violations","late samples");
+ for (i=0; i<2; i++)
+ {
+  irq_mask=(i==0);
+  ow_run(200,&r);
+  printf("  %-26s  %4llu/%-3llu  %10llu  %llu\n",
+   irq_mask ? "with the critical sections" : "without",
+   (unsigned long long)r.bad,(unsigned long long)r.runs,
+   (unsigned long long)ow.violations,(unsigned long long)ow.late);
+ }
+ irq_mask=1;
+}
+
+static void usage(const char* message)
+{
+ if (message!=NULL) fprintf(stderr,"%s: %s\n",PROGNAME,message);
+ fprintf(stderr,
+ "usage: %s [options]\n"
+ "  -k       self check only\n"
+ "  -f MHz   core clock (default 96)\n"
+ "  -o n     cycles of a register access (default 4)\n"
+ "  -i us    mean time between interrupts, 0 for none (default 200)\n"
+ "  -l us    longest interrupt (default 40)\n"
+ "  -s us    longest I2C clock stretch (default 20)\n",
+ PROGNAME);
+ exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+ int i, check_only=0;
+ for (i=1; i<argc; i++)
+ {
+  if (strcmp(argv[i],"-k")==0) check_only=1;
+  else if (i+1==argc) usage("bad option");
+  else if (strcmp(argv[i],"-f")==0) mhz=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-o")==0) op=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-i")==0) irq_gap_us=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-l")==0) irq_max_us=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-s")==0) stretch_us=atoi(argv[++i]);
+  else usage("bad option");
+ }
+ if (mhz<8 || op==0 || irq_max_us==0 || stretch_us==0) usage("bad model");
+
+ printf("self check\n");
+ self_check();
+ printf("%s\n",failures==0 ? "  ok" : "  FAILED");
+ if (check_only || failures!=0) return failures!=0;
+ bench();
+ return 0;
+}
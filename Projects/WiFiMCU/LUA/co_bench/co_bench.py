@@ -0,0 +1,434 @@
+#!/usr/bin/env python
+#
+# co_bench.py
+#
+# Runs net.co sessions of the host firmware (../host/wifimcu.host) against
+# local sockets: a self check of a line protocol served by sessions (lines,
+# reads, backpressure, the end of the data, errors, client sessions) and
+# hundreds of sessions in waves, then the latency of a request and the
+# memory a session takes, compared with the same server made of callbacks.
+#
+# usage: co_bench.py [-f firmware] [-k] [-n sessions] [-r requests] [-b strings]
+#                    [-P port]
+#
+# The MIT License
+# Copyright (c) 2014 MXCHIP Inc.
+#
+
+import argparse
+import os
+import shutil
+import socket
+import sys
+import tempfile
+import threading
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, '..', 'net_bench'))
+
+from net_bench import Firmware
+
+# The line protocol, a session for each client: "hi" first, then for each
+# line "echo text" -> "> text", "read n" -> "got n <n bytes>", "long" (a
+# line over 512 bytes follows) -> "long <length>", "big n" -> n lines of
+# 1 KB and "end", "err" fails, "quit" -> "bye" and the close. FILL is 1018
+# bytes, a "big" line is its number in five digits, FILL and "\n". mem()
+# is the Lua heap in use, where the sessions are: a coroutine and its
+# socket object each (mcu.mem() on the host is the C library's heap,
+# threads and caches of its own in it)
+LINE = '''
+FILL=string.sub(string.rep("abcdefghijklmnopqrstuvwxyz012345",32),1,1018)
+function line(s,ip,port)
+ s:write("hi\\n")
+ while true do
+  local l=s:readline()
+  if l==nil then return end
+  local c,a=l,""
+  local i=string.find(l," ",1,true)
+  if i then c=string.sub(l,1,i-1) a=string.sub(l,i+1) end
+  if c=="echo" then s:write("> "..a.."\\n")
+  elseif c=="read" then local d=s:read(tonumber(a)) s:write("got "..#d.." "..d.."\\n")
+  elseif c=="long" then local n=0 repeat local p=s:readline() n=n+#p until #p<512 s:write("long "..n.."\\n")
+  elseif c=="big" then for k=1,tonumber(a) do s:write(string.format("%%05d",k)..FILL.."\\n") end s:write("end\\n")
+  elseif c=="err" then error("boom")
+  elseif c=="quit" then s:write("bye\\n") return
+  end
+ end
+end
+function mem() collectgarbage() return collectgarbage("count")*1024 end
+'''
+
+# Live data of a script in the Lua heap: every callback collects it all
+BALLAST = '''
+ballast={} for i=1,%(ballast)d do ballast[i]=string.format("%%0100d",i) end
+'''
+
+# 4 server sockets, each serves the sessions of 5 clients at most
+CO_SERVERS = '''
+sv={}
+for i=0,3 do sv[i]=net.new(net.TCP,net.SERVER) net.co.serve(sv[i],line) net.start(sv[i],%(fwport)d+i) end
+@ listen 1
+'''
+
+# The same servers made of callbacks (echo and quit), the lines of a
+# socket are cut out of what it receives. A callback comes with a socket
+# number: a late one ("sent" after the peer closed, the disconnect
+# net.close() posts) may be for a new client with the same number already
+CB_SERVERS = '''
+buf={} bye={}
+function rcv(c,d)
+ local b=(buf[c] or "")..d
+ while true do
+  local i=string.find(b,"\\n",1,true)
+  if i==nil then break end
+  local l=string.sub(b,1,i-1) b=string.sub(b,i+1)
+  if string.sub(l,-1)=="\\r" then l=string.sub(l,1,-2) end
+  if l=="quit" then bye[c]=true net.send(c,"bye\\n")
+  elseif string.sub(l,1,5)=="echo " then net.send(c,"> "..string.sub(l,6).."\\n") end
+ end
+ buf[c]=b
+end
+function snt(c) if bye[c] and net.queued(c)==0 then bye[c]=nil buf[c]=nil net.close(c) end end
+sv={}
+for i=0,3 do local s=net.new(net.TCP,net.SERVER) sv[i]=s
+ net.on(s,"accept",function(c) buf[c]="" bye[c]=nil net.send(c,"hi\\n") end)
+ net.on(s,"receive",rcv) net.on(s,"sent",snt)
+ net.on(s,"disconnect",function(c) buf[c]=nil bye[c]=nil end)
+ net.start(s,%(fwport)d+i)
+end
+@ listen 1
+'''
+
+# Client sessions: one talks to a local server, one connects to a port
+# nobody listens on, and the calls that are refused
+CLIENTS = '''
+function pr(n,...) local r={} for i=1,select("#",...) do r[i]=tostring(select(i,...)) end print("@ "..n.." "..table.concat(r," ")) end
+c=net.new(net.TCP,net.CLIENT)
+@ cstart net.co.start(c,function(s,a) pr("cconn",s:connect(%(cport)d,"127.0.0.1")) pr("cwrite",s:write("GET "..a.."\\n")) pr("cline",s:readline()) pr("cread",s:read(10)) pr("cend",s:read(10)) G=s end,"x")
+@ again net.co.start(c,function() end)
+@ server net.co.start(sv[0],function() end)
+@ bad net.co.start(99,function() end)
+u=net.new(net.UDP,net.CLIENT)
+@ udp net.co.start(u,function() end)
+d=net.new(net.TCP,net.CLIENT)
+@ dstart net.co.start(d,function(s) pr("refused",s:connect(1,"127.0.0.1",500)) end)
+'''
+
+CLIENTS_END = '''
+@ outside pcall(function() return G:read(1) end)
+@ readlen pcall(function() return G:read(0) end)
+'''
+
+
+class Peer(object):
+    """A client of the firmware, reads lines"""
+
+    def __init__(self, port, timeout=5):
+        self.sock = socket.create_connection(('127.0.0.1', port))
+        self.sock.settimeout(timeout)
+        self.data = b''
+
+    def readline(self):
+        while b'\n' not in self.data:
+            try:
+                d = self.sock.recv(4096)
+            except (socket.timeout, OSError):
+                return None
+            if not d:
+                return None
+            self.data += d
+        line, _, self.data = self.data.partition(b'\n')
+        return line.decode('latin-1')
+
+    def closed(self):
+        """True when the firmware closes the socket, nothing more comes"""
+        try:
+            return self.data == b'' and self.sock.recv(1) == b''
+        except (socket.timeout, OSError):
+            return False
+
+    def send(self, data):
+        self.sock.sendall(data.encode('latin-1') if isinstance(data, str) else data)
+
+    def close(self):
+        self.sock.close()
+
+
+def session(port, n):
+    """A short session: hi, one echo and quit; True if it went as expected"""
+    try:
+        p = Peer(port)
+    except OSError:
+        return False
+    try:
+        if p.readline() != 'hi':
+            return False
+        p.send('echo %d\nquit\n' % n)
+        return p.readline() == '> %d' % n and p.readline() == 'bye' and p.closed()
+    finally:
+        p.close()
+
+
+def waves(args, count):
+    """count sessions, 5 at a time on each of the 4 servers; the good ones"""
+    good = [0]
+    lock = threading.Lock()
+
+    def run(port, n):
+        if session(port, n):
+            with lock:
+                good[0] += 1
+
+    for first in range(0, count, 20):
+        threads = []
+        for n in range(first, min(first + 20, count)):
+            t = threading.Thread(target=run, args=(args.fwport + (n % 20) // 5, n))
+            t.start()
+            threads.append(t)
+        for t in threads:
+            t.join()
+    return good[0]
+
+
+def answer_server():
+    """Answers one "GET" line with "ok <line>\\r\\nrest", then closes"""
+    ls = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    ls.bind(('127.0.0.1', 0))
+    ls.listen(1)
+
+    def run():
+        try:
+            c, _ = ls.accept()
+        except OSError:
+            return
+        data = b''
+        while b'\n' not in data:
+            d = c.recv(100)
+            if not d:
+                break
+            data += d
+        c.sendall(b'ok ' + data.strip() + b'\r\nrest')
+        time.sleep(0.2)
+        c.close()
+        ls.close()
+
+    threading.Thread(target=run, daemon=True).start()
+    return ls.getsockname()[1]
+
+
+def big(n):
+    fill = (b'abcdefghijklmnopqrstuvwxyz012345' * 32)[:1018]
+    return ['%05d' % k + fill.decode() for k in range(1, n + 1)] + ['end']
+
+
+def check(args):
+    fails = []
+
+    def expect(name, got, value):
+        if got != value:
+            fails.append(name)
+            print('FAIL %s: %r, expected %r' % (name, got, value))
+
+    work = tempfile.mkdtemp(prefix='co_bench_')
+    fw = Firmware(args.firmware, work)
+    port = args.fwport
+    try:
+        fw.send((LINE + CO_SERVERS) % {'fwport': port})
+        fw.wait('listen', 10)
+        time.sleep(0.2)
+
+        # lines, "\r\n", a read in two pieces, a line over the buffer
+        p = Peer(port)
+        expect('greeting', p.readline(), 'hi')
+        p.send('echo one\r\necho two\nread 10\nabcd')
+        expect('echo', p.readline(), '> one')
+        expect('echo crlf', p.readline(), '> two')
+        time.sleep(0.1)
+        p.send('efghij')
+        expect('read', p.readline(), 'got 10 abcdefghij')
+        p.send('long\n' + 'x' * 1300 + '\n')
+        expect('long line', p.readline(), 'long 1300')
+
+        # 64 KB to a peer that does not read yet: the session waits
+        p.send('big 64\n')
+        time.sleep(0.3)
+        got = [p.readline() for _ in range(65)]
+        expect('backpressure', got == big(64), True)
+        p.send('quit\n')
+        expect('quit', p.readline(), 'bye')
+        expect('closed after quit', p.closed(), True)
+        p.close()
+
+        # the end of the data: the last line without "\n" is read, the
+        # answer sent before the close
+        p = Peer(port)
+        p.readline()
+        p.send('echo tail')
+        p.sock.shutdown(socket.SHUT_WR)
+        expect('end of data', p.readline(), '> tail')
+        expect('closed at end of data', p.closed(), True)
+        p.close()
+
+        # an error in a session: printed, the socket closed
+        p = Peer(port)
+        p.readline()
+        p.send('err\n')
+        expect('closed on error', p.closed(), True)
+        p.close()
+        time.sleep(0.1)
+        expect('error printed', any('boom' in line for line in fw.output), True)
+
+        # 5 sessions at once on a server, answered out of order
+        ps = [Peer(port) for _ in range(5)]
+        expect('5 greetings', [q.readline() for q in ps], ['hi'] * 5)
+        for i in reversed(range(5)):
+            ps[i].send('echo s%d\n' % i)
+        expect('5 at once', [q.readline() for q in ps], ['> s%d' % i for i in range(5)])
+        for q in ps:
+            q.send('quit\n')
+        expect('5 quit', [q.readline() for q in ps], ['bye'] * 5)
+        for q in ps:
+            q.close()
+        time.sleep(0.2)
+
+        # hundreds of sessions, and what they leave in the Lua heap
+        fw.send('@ m0 mem()')
+        fw.wait('m0', 5)
+        expect('%d sessions' % args.sessions, waves(args, args.sessions), args.sessions)
+        time.sleep(0.2)
+        fw.send('@ m1 mem()')
+        fw.wait('m1', 5)
+
+        # client sessions
+        fw.send(CLIENTS % {'cport': answer_server()})
+        fw.wait('refused', 5)
+        fw.wait('cend', 5)
+        fw.send(CLIENTS_END)
+        fw.wait('readlen', 5)
+    finally:
+        fw.stop()
+        shutil.rmtree(work)
+    res = fw.results
+    try:
+        left = int(res.get('m1')) - int(res.get('m0'))
+    except (TypeError, ValueError):
+        left = None
+    expect('Lua heap after the sessions', left is not None and left < 1024, True)
+    expect('client start', res.get('cstart'), '0')
+    expect('client connect', res.get('cconn'), 'true')
+    expect('client write', res.get('cwrite'), '6')
+    expect('client line', res.get('cline'), 'ok GET x')
+    expect('client read at close', res.get('cread'), 'rest')
+    expect('client read closed', res.get('cend'), 'nil closed')
+    expect('second session', res.get('again'), '-4')
+    expect('server socket', res.get('server'), '-2')
+    expect('no socket', res.get('bad'), '-1')
+    expect('udp socket', res.get('udp'), '-5')
+    expect('refused', res.get('refused'), 'nil timeout')
+    expect('outside the session', (res.get('outside') or '').split(' ')[0], 'false')
+    expect('read 0 bytes', (res.get('readlen') or '').split(' ')[0], 'false')
+
+    print('check: %d fail(s), Lua heap left after %d sessions: %s bytes' %
+          (len(fails), args.sessions, left))
+    return not fails
+
+
+def bench_one(args, name, servers):
+    """Lua heap per waiting session, latency of a request, time of a session"""
+    work = tempfile.mkdtemp(prefix='co_bench_')
+    fw = Firmware(args.firmware, work)
+    port = args.fwport
+    try:
+        fw.send((LINE + BALLAST + servers) % {'fwport': port, 'ballast': args.ballast})
+        fw.wait('listen', 10)
+        time.sleep(0.2)
+        if not session(port, 0):
+            print('%s: no session' % name)
+            return None
+        time.sleep(0.2)
+
+        # 20 clients, each with an answered request, waiting for the next
+        fw.send('@ p0 mem()')
+        fw.wait('p0', 5)
+        ps = [Peer(port + i // 5) for i in range(20)]
+        for q in ps:
+            q.readline()
+            q.send('echo p\n')
+            q.readline()
+        fw.send('@ p1 mem()')
+        fw.wait('p1', 5)
+        per = (int(fw.results['p1']) - int(fw.results['p0'])) / 20.0
+        for q in ps:
+            q.send('quit\n')
+            q.readline()
+            q.close()
+        time.sleep(0.3)
+
+        # requests one after the other on one socket
+        p = Peer(port)
+        p.readline()
+        times = []
+        for i in range(args.requests):
+            t = time.time()
+            p.send('echo %d\n' % i)
+            if p.readline() != '> %d' % i:
+                print('%s: request %d failed' % (name, i))
+                return None
+            times.append(time.time() - t)
+        p.send('quit\n')
+        p.readline()
+        p.close()
+        time.sleep(0.3)
+
+        t = time.time()
+        good = waves(args, args.sessions)
+        elapsed = time.time() - t
+    finally:
+        fw.stop()
+        shutil.rmtree(work)
+    times.sort()
+    return {'per': per, 'mean': sum(times) / len(times) * 1000.0,
+            'p50': times[len(times) // 2] * 1000.0,
+            'p99': times[int(len(times) * 0.99)] * 1000.0,
+            'session': elapsed / max(good, 1) * 1000.0, 'good': good}
+
+
+def bench(args):
+    print('%-10s %10s %10s %10s %12s %14s' %
+          ('', 'mean ms', 'p50 ms', 'p99 ms', 'session ms', 'heap/session'))
+    for name, servers in (('net.co', CO_SERVERS), ('callbacks', CB_SERVERS)):
+        r = bench_one(args, name, servers)
+        if r is None:
+            print('%-10s failed' % name)
+            continue
+        print('%-10s %10.2f %10.2f %10.2f %12.2f %14d   (%d of %d sessions)' %
+              (name, r['mean'], r['p50'], r['p99'], r['session'], r['per'],
+               r['good'], args.sessions))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='net.co check and benchmark')
+    ap.add_argument('-f', dest='firmware',
+                    default=os.path.join(HERE, '..', 'host', 'wifimcu.host'))
+    ap.add_argument('-k', dest='check_only', action='store_true',
+                    help='self check only')
+    ap.add_argument('-n', dest='sessions', type=int, default=300,
+                    help='sessions, in waves of 20 over the 4 servers')
+    ap.add_argument('-r', dest='requests', type=int, default=500,
+                    help='requests for the latency')
+    ap.add_argument('-b', dest='ballast', type=int, default=200,
+                    help='strings of 100 bytes the benchmark script keeps')
+    ap.add_argument('-P', dest='fwport', type=int, default=9731,
+                    help='first port of the 4 firmware servers')
+    args = ap.parse_args()
+    args.firmware = os.path.abspath(args.firmware)
+
+    ok = check(args)
+    if not args.check_only:
+        bench(args)
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,238 @@
+#!/usr/bin/env python
+#
+# ftp_bench.py
+#
+# Runs the ftp module of the host firmware (../host/wifimcu.host) against
+# ftpd.py: a self check of its transfers and the speed of receiving and
+# sending a 100 KB file, in KB/s as the Lua script sees it, from the call
+# of ftp.recv()/ftp.send() to its return.
+#
+# usage: ftp_bench.py [-f firmware] [-k] [-b buflen] [-n runs] [-s size]
+#
+# The MIT License
+# Copyright (c) 2014 MXCHIP Inc.
+#
+
+import argparse
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+import threading
+
+import ftpd
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# Lua lines go to the console one at a time, results come back as
+# "@ name values..." lines
+LOGIN = '''
+file.format()
+@ new ftp.new("127.0.0.1", %(port)d, "user", "pass"%(buflen)s)
+@ start ftp.start()
+'''
+
+CHECK = '''
+@ recv ftp.recv("odd.bin")
+@ send ftp.send("odd.bin")
+@ recvstr ftp.recv("small.txt", 1)
+@ sendstr ftp.sendstring("str.txt", %(str)s)
+@ append ftp.sendstring("str.txt", %(str)s, 1)
+@ missing ftp.recv("missing.bin")
+@ nostr ftp.recv("missing.bin", 1)
+@ again ftp.recv("small.txt")
+@ cwd ftp.chdir("sub")
+@ pwd ftp.chdir()
+@ nlst ftp.list(1, 1)
+@ cwdup ftp.chdir("/")
+@ list ftp.list(0, 1)
+'''
+
+BENCH = '''
+t=tmr.tick() r=ftp.recv("f.bin") t=tmr.tick()-t print("@ recv "..r.." "..t)
+t=tmr.tick() r=ftp.send("f.bin") t=tmr.tick()-t print("@ send "..r.." "..t)
+'''
+
+
+class Firmware(object):
+    """The host firmware running a script on its console"""
+
+    def __init__(self, exe, cwd):
+        self.proc = subprocess.Popen([exe], cwd=cwd, stdin=subprocess.PIPE,
+                                     stdout=subprocess.PIPE,
+                                     stderr=subprocess.STDOUT)
+        self.results = []
+        self.output = []
+        self.ended = threading.Event()
+        threading.Thread(target=self.read, daemon=True).start()
+
+    def read(self):
+        for line in self.proc.stdout:
+            line = line.decode('latin-1').rstrip('\r\n')
+            self.output.append(line)
+            if line.startswith('@ '):
+                self.results.append(line[2:].split(' ', 1))
+            if line == '@@':
+                self.ended.set()
+                break
+
+    def run(self, script, timeout):
+        lines = []
+        for line in script.strip().splitlines():
+            if line.startswith('@ '):
+                name, _, call = line[2:].partition(' ')
+                # all the values of the call, a table as its entries
+                line = ('local r = {%s} for i = 1, #r do if type(r[i]) == "table" '
+                        'then r[i] = table.concat(r[i], "|") end '
+                        'r[i] = string.gsub(tostring(r[i]), "[\\r\\n]+", "/") end '
+                        'print("@ %s "..table.concat(r, " "))'
+                        % (call, name))
+            lines.append(line)
+        lines.append('ftp.stop()')
+        lines.append('print("@".."@")')
+        self.proc.stdin.write(('\n'.join(lines) + '\n').encode('latin-1'))
+        self.proc.stdin.flush()
+        ok = self.ended.wait(timeout)
+        self.proc.kill()
+        self.proc.wait()
+        return ok
+
+
+def session(args, root, script, values):
+    """Run script logged in to a server on root, the results by name"""
+    server = ftpd.Server(root)
+    values = dict(values, port=server.start(),
+                  buflen=', %d' % args.buflen if args.buflen else '')
+    work = tempfile.mkdtemp(prefix='ftp_bench_')
+    try:
+        fw = Firmware(args.firmware, work)
+        ok = fw.run((LOGIN + script) % values, args.timeout)
+    finally:
+        server.shutdown()
+        server.server_close()
+        shutil.rmtree(work)
+    if not ok:
+        sys.stdout.write('\n'.join(fw.output[-20:]) + '\n')
+        raise SystemExit('ftp_bench: the firmware did not finish the script')
+    return fw.results
+
+
+def check(args):
+    root = tempfile.mkdtemp(prefix='ftp_root_')
+    rnd = random.Random(1)
+    odd = bytes(rnd.getrandbits(8) for _ in range(args.size + 1))
+    small = b'line one\r\nline two\r\n'
+    text = 'x' * 1500 + '-end'
+    os.mkdir(os.path.join(root, 'sub'))
+    with open(os.path.join(root, 'sub', 'a.txt'), 'wb') as f:
+        f.write(b'a')
+    with open(os.path.join(root, 'odd.bin'), 'wb') as f:
+        f.write(odd)
+    with open(os.path.join(root, 'small.txt'), 'wb') as f:
+        f.write(small)
+    try:
+        got = session(args, root, CHECK, {'str': 'string.rep("x", 1500).."-end"'})
+        with open(os.path.join(root, 'odd.bin'), 'rb') as f:
+            back = f.read()
+        with open(os.path.join(root, 'str.txt'), 'rb') as f:
+            stored = f.read()
+    finally:
+        shutil.rmtree(root)
+
+    want = [
+        ('new', '0'),
+        ('start', '0'),
+        ('recv', str(len(odd))),
+        ('send', str(len(odd))),
+        ('recvstr', '%d line one/line two/' % len(small)),
+        ('sendstr', str(len(text))),
+        ('append', str(len(text))),
+        ('missing', '-4'),
+        ('nostr', '-4 '),
+        ('again', str(len(small))),
+        ('cwd', '0 Directory changed to /sub'),
+        ('pwd', '0 /sub'),
+        ('nlst', 'a.txt 1'),
+        ('cwdup', '0 Directory changed to /'),
+    ]
+    fails = 0
+    for i, (name, value) in enumerate(want):
+        res = got[i] if i < len(got) else [name, '(none)']
+        res = [res[0], res[1] if len(res) > 1 else '']
+        if res != [name, value]:
+            print('FAIL %s: %r, expected %r' % (name, res[1], value))
+            fails += 1
+    lst = got[len(want)] if len(got) > len(want) else ['list', '']
+    names = [l.split()[-1] for l in lst[1].rsplit(' ', 1)[0].split('|') if l]
+    if lst[0] != 'list' or names != ['odd.bin', 'small.txt', 'str.txt', 'sub']:
+        print('FAIL list: %r' % lst[1:])
+        fails += 1
+    if back != odd:
+        print('FAIL the file sent back differs from the one received')
+        fails += 1
+    if stored != (text + text).encode():
+        print('FAIL sendstring stored %d bytes' % len(stored))
+        fails += 1
+    print('check: %d fail(s)' % fails)
+    return fails == 0
+
+
+def bench(args):
+    root = tempfile.mkdtemp(prefix='ftp_root_')
+    rnd = random.Random(2)
+    data = bytes(rnd.getrandbits(8) for _ in range(args.size))
+    best = {}
+    try:
+        for _ in range(args.runs):
+            with open(os.path.join(root, 'f.bin'), 'wb') as f:
+                f.write(data)
+            got = session(args, root, BENCH, {})
+            with open(os.path.join(root, 'f.bin'), 'rb') as f:
+                if f.read() != data:
+                    print('FAIL the file sent back differs')
+            for res in got:
+                if res[0] not in ('recv', 'send'):
+                    continue
+                n, ms = [int(v) for v in res[1].split()]
+                if n != len(data):
+                    print('%s: %d of %d bytes' % (res[0], n, len(data)))
+                    continue
+                if res[0] not in best or ms < best[res[0]]:
+                    best[res[0]] = ms
+    finally:
+        shutil.rmtree(root)
+    for name in ('recv', 'send'):
+        if name in best:
+            ms = max(best[name], 1)
+            print('%-5s %d bytes  %6d ms  %8.1f KB/s' %
+                  (name, args.size, ms, args.size / 1024.0 * 1000.0 / ms))
+        else:
+            print('%-5s failed' % name)
+
+
+def main():
+    ap = argparse.ArgumentParser(description='ftp module check and benchmark')
+    ap.add_argument('-f', dest='firmware',
+                    default=os.path.join(HERE, '..', 'host', 'wifimcu.host'))
+    ap.add_argument('-k', dest='check_only', action='store_true',
+                    help='self check only')
+    ap.add_argument('-b', dest='buflen', type=int, default=0,
+                    help='buflen argument of ftp.new()')
+    ap.add_argument('-n', dest='runs', type=int, default=3,
+                    help='benchmark runs, the best is shown')
+    ap.add_argument('-s', dest='size', type=int, default=100 * 1024,
+                    help='file size of the benchmark')
+    ap.add_argument('-t', dest='timeout', type=int, default=120)
+    args = ap.parse_args()
+    args.firmware = os.path.abspath(args.firmware)
+
+    ok = check(args)
+    if not args.check_only:
+        bench(args)
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
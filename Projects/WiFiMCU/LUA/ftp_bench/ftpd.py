@@ -0,0 +1,291 @@
+#!/usr/bin/env python
+#
+# ftpd.py
+#
+# A small FTP server for testing the ftp module against: passive mode
+# only, binary only, one directory tree, one user. Each data transfer is
+# timed from its first byte to the close of its connection, so that the
+# benchmark sees the transfer and not the command round trips around it.
+#
+# usage: ftpd.py [-d dir] [-p port] [-u user] [-w pass]
+#
+# The MIT License
+# Copyright (c) 2014 MXCHIP Inc.
+#
+
+import argparse
+import os
+import socket
+import socketserver
+import sys
+import threading
+import time
+
+
+class Transfer(object):
+    """One data transfer: the command, its bytes and seconds"""
+
+    def __init__(self, cmd, name):
+        self.cmd = cmd
+        self.name = name
+        self.bytes = 0
+        self.seconds = 0.0
+
+
+class Session(socketserver.StreamRequestHandler):
+    # Nagle would hold the final reply of a transfer until the client
+    # acknowledges the 150, a delayed ACK of 40 ms on Linux
+    disable_nagle_algorithm = True
+
+    def reply(self, code, text):
+        self.wfile.write(('%d %s\r\n' % (code, text)).encode('latin-1'))
+        self.wfile.flush()
+
+    def path(self, name):
+        """The local path of a name relative to the current directory,
+        None if it leaves the tree"""
+        if name.startswith('/'):
+            rel = os.path.normpath(name.lstrip('/'))
+        else:
+            rel = os.path.normpath(os.path.join(self.cwd.lstrip('/'), name))
+        if rel == '.':
+            rel = ''
+        if rel.startswith('..'):
+            return None
+        return os.path.join(self.server.root, rel)
+
+    def handle(self):
+        self.cwd = '/'
+        self.user = None
+        self.logged = False
+        self.pasv = None
+        self.reply(220, 'ftpd.py ready')
+        while True:
+            line = self.rfile.readline()
+            if not line:
+                break
+            line = line.decode('latin-1').rstrip('\r\n')
+            cmd, _, arg = line.partition(' ')
+            cmd = cmd.upper()
+            handler = getattr(self, 'ftp_' + cmd, None)
+            if handler is None:
+                self.reply(502, 'Command not implemented')
+            elif not self.logged and cmd not in ('USER', 'PASS', 'QUIT'):
+                self.reply(530, 'Not logged in')
+            elif handler(arg):
+                break
+        if self.pasv is not None:
+            self.pasv.close()
+
+    def ftp_USER(self, arg):
+        self.user = arg
+        self.reply(331, 'Password required')
+
+    def ftp_PASS(self, arg):
+        if self.user == self.server.user and arg == self.server.password:
+            self.logged = True
+            self.reply(230, 'Logged in')
+        else:
+            self.reply(530, 'Login incorrect')
+
+    def ftp_QUIT(self, arg):
+        self.reply(221, 'Bye')
+        return True
+
+    def ftp_SYST(self, arg):
+        self.reply(215, 'UNIX Type: L8')
+
+    def ftp_NOOP(self, arg):
+        self.reply(200, 'OK')
+
+    def ftp_TYPE(self, arg):
+        self.reply(200, 'Type set to ' + arg)
+
+    def ftp_PWD(self, arg):
+        self.reply(257, '"%s" is the current directory' % self.cwd)
+
+    def ftp_CWD(self, arg):
+        p = self.path(arg)
+        if p is None or not os.path.isdir(p):
+            self.reply(550, 'No such directory')
+            return
+        rel = os.path.relpath(p, self.server.root)
+        self.cwd = '/' if rel == '.' else '/' + rel
+        self.reply(250, 'Directory changed to ' + self.cwd)
+
+    def ftp_SIZE(self, arg):
+        p = self.path(arg)
+        if p is None or not os.path.isfile(p):
+            self.reply(550, 'No such file')
+        else:
+            self.reply(213, str(os.path.getsize(p)))
+
+    def ftp_DELE(self, arg):
+        p = self.path(arg)
+        if p is None or not os.path.isfile(p):
+            self.reply(550, 'No such file')
+        else:
+            os.remove(p)
+            self.reply(250, 'Deleted')
+
+    def ftp_PASV(self, arg):
+        if self.pasv is not None:
+            self.pasv.close()
+        self.pasv = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.pasv.bind((self.request.getsockname()[0], 0))
+        self.pasv.listen(1)
+        ip, port = self.pasv.getsockname()
+        self.reply(227, 'Entering Passive Mode (%s,%d,%d)' %
+                   (ip.replace('.', ','), port >> 8, port & 255))
+
+    def data(self):
+        """Accept the data connection of the last PASV"""
+        if self.pasv is None:
+            self.reply(425, 'Use PASV first')
+            return None
+        self.pasv.settimeout(10)
+        try:
+            conn, _ = self.pasv.accept()
+        except socket.timeout:
+            conn = None
+        self.pasv.close()
+        self.pasv = None
+        if conn is None:
+            self.reply(425, 'No data connection')
+        return conn
+
+    def listing(self, arg, names_only):
+        p = self.path(arg if arg and not arg.startswith('-') else '.')
+        if p is None or not os.path.exists(p):
+            self.reply(550, 'No such file or directory')
+            return
+        names = sorted(os.listdir(p)) if os.path.isdir(p) else [os.path.basename(p)]
+        lines = []
+        for n in names:
+            if names_only:
+                lines.append(n)
+            else:
+                st = os.stat(os.path.join(p, n) if os.path.isdir(p) else p)
+                kind = 'd' if os.path.isdir(os.path.join(p, n)) else '-'
+                lines.append('%srw-r--r-- 1 ftp ftp %10d Jan 01 00:00 %s' % (kind, st.st_size, n))
+        conn = self.data()
+        if conn is None:
+            return
+        self.reply(150, 'Here comes the directory listing')
+        conn.sendall(''.join(l + '\r\n' for l in lines).encode('latin-1'))
+        conn.close()
+        self.reply(226, 'Directory send OK')
+
+    def ftp_LIST(self, arg):
+        self.listing(arg, False)
+
+    def ftp_NLST(self, arg):
+        self.listing(arg, True)
+
+    def ftp_RETR(self, arg):
+        p = self.path(arg)
+        if p is None or not os.path.isfile(p):
+            self.reply(550, 'No such file')
+            return
+        conn = self.data()
+        if conn is None:
+            return
+        self.reply(150, 'Opening BINARY mode data connection for %s' % arg)
+        t = Transfer('RETR', arg)
+        with open(p, 'rb') as f:
+            start = time.time()
+            while True:
+                block = f.read(65536)
+                if not block:
+                    break
+                conn.sendall(block)
+                t.bytes += len(block)
+        # the close waits until the client has read it all
+        conn.shutdown(socket.SHUT_WR)
+        while conn.recv(4096):
+            pass
+        t.seconds = time.time() - start
+        conn.close()
+        self.server.done(t)
+        self.reply(226, 'Transfer complete')
+
+    def store(self, arg, mode):
+        p = self.path(arg)
+        if p is None or os.path.isdir(p):
+            self.reply(553, 'Bad file name')
+            return
+        conn = self.data()
+        if conn is None:
+            return
+        self.reply(150, 'Ok to send data')
+        t = Transfer('STOR' if mode == 'wb' else 'APPE', arg)
+        start = None
+        with open(p, mode) as f:
+            while True:
+                block = conn.recv(65536)
+                if not block:
+                    break
+                if start is None:
+                    start = time.time()
+                f.write(block)
+                t.bytes += len(block)
+        t.seconds = time.time() - start if start is not None else 0.0
+        conn.close()
+        self.server.done(t)
+        self.reply(226, 'Transfer complete')
+
+    def ftp_STOR(self, arg):
+        self.store(arg, 'wb')
+
+    def ftp_APPE(self, arg):
+        self.store(arg, 'ab')
+
+
+class Server(socketserver.ThreadingTCPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+    def __init__(self, root, port=0, user='user', password='pass'):
+        socketserver.ThreadingTCPServer.__init__(self, ('127.0.0.1', port), Session)
+        self.root = os.path.abspath(root)
+        self.user = user
+        self.password = password
+        self.transfers = []
+        self.cond = threading.Condition()
+
+    def done(self, t):
+        with self.cond:
+            self.transfers.append(t)
+            self.cond.notify_all()
+
+    def wait(self, count, timeout):
+        """Wait until count transfers are done, the list of them"""
+        end = time.time() + timeout
+        with self.cond:
+            while len(self.transfers) < count and time.time() < end:
+                self.cond.wait(end - time.time())
+            return list(self.transfers)
+
+    def start(self):
+        threading.Thread(target=self.serve_forever, daemon=True).start()
+        return self.server_address[1]
+
+
+def main():
+    ap = argparse.ArgumentParser(description='FTP server for testing the ftp module')
+    ap.add_argument('-d', dest='root', default='.', help='directory to serve')
+    ap.add_argument('-p', dest='port', type=int, default=2121)
+    ap.add_argument('-u', dest='user', default='user')
+    ap.add_argument('-w', dest='password', default='pass')
+    args = ap.parse_args()
+    server = Server(args.root, args.port, args.user, args.password)
+    print('ftpd.py: serving %s on 127.0.0.1:%d' % (server.root, server.server_address[1]))
+    sys.stdout.flush()
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
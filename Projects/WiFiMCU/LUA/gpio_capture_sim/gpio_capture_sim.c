@@ -0,0 +1,327 @@
+/*
+** gpio_capture_sim.c
+** Edge trains through the GPIO interrupt path of gpio.c, on a cycle count
+** model of the MCU: the old handler that queues one message per edge and
+** the capture of ../lua/exlibs/gpio_capture.c, immediate and with a
+** coalescing window. Reports the edges lost in the EXTI line, in the queue
+** or ring, and the latency until lua runs for them. See readme.txt.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gpio_capture.h"
+
+#define PROGNAME	"gpio_capture_sim"
+#define QUEUE_LEN	10		/* os_queue in wifimcu_lua.c */
+#define NEVER		UINT64_MAX
+#define CAPTURE_MAX	1024
+
+enum { OLD, CAPTURE, WINDOW };
+static const char* modes[]={ "per edge", "capture", "window" };
+
+/* Model parameters, cycles unless noted */
+static uint32_t mhz=96;			/* core clock */
+static uint32_t entry=12;		/* exception entry, and the same to leave */
+static uint32_t dispatch=40;		/* platform EXTI handler to the pin callback */
+static uint32_t post=250;		/* mico_rtos_push_to_queue from an ISR */
+static uint32_t record=60;		/* gpio_capture_edge */
+static uint32_t wake_us=30;		/* lua thread wakes on a queue message */
+static uint32_t call_us=500;		/* do_queue_task: lua_call and the full gc */
+static uint32_t edge_us=4;		/* per edge of a batch into the tables */
+static uint32_t depth=64;		/* capture records */
+static uint32_t window_ms=10;		/* coalescing window */
+
+typedef struct
+{
+  uint64_t at;				/* time posted */
+  uint64_t edge;			/* OLD: time of the edge */
+} Msg;
+
+typedef struct
+{
+  uint64_t injected, missed, dropped, delivered, callbacks;
+  uint64_t latency_sum, latency_max;	/* cycles */
+  uint64_t stamp_max;			/* stamp after the edge, cycles */
+  uint64_t last_stamp;			/* ordering check */
+  int errors;
+} Result;
+
+typedef struct
+{
+  uint64_t period;			/* between edges of a burst */
+  uint32_t burst;			/* edges per burst, 0 for endless */
+  uint64_t gap;				/* between bursts */
+  uint64_t duration;
+} Train;
+
+static uint64_t us(uint64_t us) { return us*mhz; }
+
+/* Edge k of the train */
+static uint64_t edge_time(const Train* t, uint64_t k)
+{
+ if (t->burst==0) return k*t->period;
+ return (k/t->burst)*t->gap + (k%t->burst)*t->period;
+}
+
+static void deliver(Result* r, uint64_t now, uint64_t edge)
+{
+ uint64_t l=now-edge;
+ r->delivered++;
+ r->latency_sum+=l;
+ if (l>r->latency_max) r->latency_max=l;
+}
+
+typedef struct
+{
+ int mode;
+ const Train* train;
+ Result* r;
+ gpio_capture_t cap;
+ uint32_t records[CAPTURE_MAX];
+ uint64_t stamps[CAPTURE_MAX];		/* edge time behind each record */
+ uint32_t written;			/* records, index into stamps */
+ Msg queue[QUEUE_LEN];
+ int qhead, qlen;
+} Sim;
+
+static int push(Sim* s, uint64_t at, uint64_t edge)
+{
+ if (s->qlen==QUEUE_LEN) return 0;
+ s->queue[(s->qhead+s->qlen)%QUEUE_LEN].at=at;
+ s->queue[(s->qhead+s->qlen)%QUEUE_LEN].edge=edge;
+ s->qlen++;
+ return 1;
+}
+
+/* The handler of an edge, entered at start; returns when it is done */
+static uint64_t isr(Sim* s, uint64_t edge, uint64_t start, uint32_t in)
+{
+ uint64_t stamp=start+in+dispatch;	/* DWT->CYCCNT read */
+ uint64_t end;
+ if (s->mode==OLD)
+ {
+  end=stamp+post+entry;
+  if (!push(s,end,edge)) s->r->dropped++;
+  return end;
+ }
+ end=stamp+record+entry;
+ if (stamp-edge>s->r->stamp_max) s->r->stamp_max=stamp-edge;
+ {
+  uint32_t dropped=s->cap.dropped;
+  int notify=gpio_capture_edge(&s->cap,(uint32_t)stamp,1);
+  if (s->cap.dropped==dropped) s->stamps[s->written++ & (depth-1)]=edge;
+  if (notify)
+  {
+   end+=post;
+   if (!push(s,end,0)) gpio_capture_cancel(&s->cap);
+  }
+ }
+ return end;
+}
+
+/* do_queue_task on a capture message, returns the edges handed to lua */
+static uint32_t reader(Sim* s, uint64_t now)
+{
+ uint32_t rec[16], n, i, total=0;
+ Result* r=s->r;
+ do
+ {
+  while (total<depth && (n=gpio_capture_read(&s->cap,rec,16))>0)
+   for (i=0; i<n; i++, total++)
+   {
+    if (GPIO_CAPTURE_CYCLES(rec[i])<r->last_stamp) r->errors++;
+    r->last_stamp=GPIO_CAPTURE_CYCLES(rec[i]);
+    deliver(r,now,s->stamps[r->delivered & (depth-1)]);
+   }
+  if (total>=depth)
+  {
+   /* the rest goes with a message of its own */
+   if (gpio_capture_done(&s->cap) && !push(s,now,0))
+    gpio_capture_cancel(&s->cap);
+   break;
+  }
+ }
+ while (gpio_capture_done(&s->cap));
+ return total;
+}
+
+static void simulate(int mode, const Train* train, Result* r)
+{
+ static Sim sim;
+ Sim* s=&sim;
+ uint64_t now=0, k=0;
+ uint64_t isr_end=NEVER;		/* the handler runs until then */
+ int line_pending=0;			/* EXTI pending bit */
+ uint64_t line_edge=0;
+ uint64_t lua_wake=NEVER, lua_left=0;	/* lua thread: start of a call, work left */
+ int lua_busy=0;
+ uint64_t next_tick=(mode==WINDOW) ? us(window_ms*1000) : NEVER;
+
+ memset(s,0,sizeof(*s));
+ memset(r,0,sizeof(*r));
+ s->mode=mode;
+ s->train=train;
+ s->r=r;
+ if (mode!=OLD)
+  gpio_capture_init(&s->cap,s->records,depth,0,mode==WINDOW);
+
+ for (;;)
+ {
+  uint64_t next_edge=edge_time(train,k), lua_end, t=NEVER;
+  if (next_edge>=train->duration) next_edge=NEVER;
+  lua_end=(lua_busy && isr_end==NEVER) ? now+lua_left : NEVER;
+  if (next_edge<t) t=next_edge;
+  if (isr_end<t) t=isr_end;
+  if (lua_end<t) t=lua_end;
+  if (lua_wake<t) t=lua_wake;
+  if (next_tick<t && (next_tick<train->duration || ring_fifo_used_space(&s->cap.ring)>0))
+   t=next_tick;
+  if (t==NEVER) break;
+
+  /* lua runs whenever no interrupt does */
+  if (lua_busy && isr_end==NEVER) lua_left-=t-now;
+  now=t;
+
+  if (now==next_edge)			/* the pin changes */
+  {
+   r->injected++;
+   k++;
+   if (isr_end==NEVER)
+    isr_end=isr(s,now,now,entry);
+   else if (!line_pending)
+   {
+    line_pending=1;
+    line_edge=now;
+   }
+   else
+    r->missed++;			/* merged into the pending bit */
+  }
+  else if (now==isr_end)		/* the handler returns */
+  {
+   isr_end=NEVER;
+   if (line_pending)			/* and tail chains into the next one */
+   {
+    line_pending=0;
+    isr_end=isr(s,line_edge,now,entry/2);
+   }
+  }
+  else if (now==next_tick)		/* coalescing window timer */
+  {
+   next_tick+=us(window_ms*1000);
+   if (gpio_capture_poll(&s->cap) && !push(s,now,0))
+    gpio_capture_cancel(&s->cap);
+  }
+  else if (lua_busy && now==lua_end)	/* the callback returns */
+   lua_busy=0;
+  else if (now==lua_wake)		/* do_queue_task on the next message */
+  {
+   Msg m=s->queue[s->qhead];
+   s->qhead=(s->qhead+1)%QUEUE_LEN;
+   s->qlen--;
+   lua_wake=NEVER;
+   if (mode==OLD)
+   {
+    deliver(r,now,m.edge);
+    lua_left=us(call_us);
+   }
+   else
+   {
+    uint32_t n=reader(s,now);
+    lua_left=n>0 ? us(call_us+edge_us*n) : 0;
+   }
+   r->callbacks+=lua_left>0;
+   lua_busy=lua_left>0;
+  }
+  /* the lua thread takes the next message once idle */
+  if (!lua_busy && lua_wake==NEVER && s->qlen>0)
+   lua_wake=(s->queue[s->qhead].at+us(wake_us)>now) ? s->queue[s->qhead].at+us(wake_us) : now;
+ }
+ if (mode!=OLD) r->dropped=s->cap.dropped;
+}
+
+static void report(const char* name, const Train* t)
+{
+ int mode;
+ printf("%s\n",name);
+ printf("  %-9s %9s %8s %8s %9s %9s %10s %10s\n",
+  "", "edges", "missed", "dropped", "delivered", "callbacks", "mean us", "max us");
+ for (mode=OLD; mode<=WINDOW; mode++)
+ {
+  Result r;
+  simulate(mode,t,&r);
+  printf("  %-9s %9llu %8llu %8llu %9llu %9llu %10.1f %10.1f\n",modes[mode],
+   (unsigned long long)r.injected,(unsigned long long)r.missed,
+   (unsigned long long)r.dropped,(unsigned long long)r.delivered,
+   (unsigned long long)r.callbacks,
+   r.delivered ? (double)r.latency_sum/r.delivered/mhz : 0.0,
+   (double)r.latency_max/mhz);
+  if (r.injected!=r.missed+r.dropped+r.delivered)
+   printf("  FAIL: %llu edges unaccounted\n",
+    (unsigned long long)(r.injected-r.missed-r.dropped-r.delivered));
+  if (r.errors)
+   printf("  FAIL: %d records out of order\n",r.errors);
+  if (mode!=OLD && r.stamp_max>entry+dispatch)
+   printf("  stamps up to %.2f us after the edge\n",(double)r.stamp_max/mhz);
+ }
+}
+
+static void usage(void)
+{
+ fprintf(stderr,
+ "usage: %s [options]\n"
+ "  -f MHz   core clock (default %u)\n"
+ "  -d n     capture records, a power of 2 (default %u)\n"
+ "  -w ms    coalescing window (default %u)\n"
+ "  -c us    lua callback with its gc (default %u)\n"
+ "  -e us    lua work per edge of a batch (default %u)\n"
+ "  -p n     cycles of a queue post from the ISR (default %u)\n",
+ PROGNAME,mhz,depth,window_ms,call_us,edge_us,post);
+ exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+ static const uint32_t rates[]={ 1000, 10000, 100000, 500000, 1000000, 2000000 };
+ char name[80];
+ Train t;
+ int i;
+
+ for (i=1; i<argc; i++)
+ {
+  if (i+1>=argc) usage();
+  else if (strcmp(argv[i],"-f")==0) mhz=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-d")==0) depth=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-w")==0) window_ms=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-c")==0) call_us=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-e")==0) edge_us=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-p")==0) post=atoi(argv[++i]);
+  else usage();
+ }
+ if (mhz==0 || window_ms==0 || depth<2 || depth>CAPTURE_MAX || (depth&(depth-1))!=0) usage();
+
+ printf("%u MHz, ISR %u cycles per edge (+%u to post), lua %u us per call + %u us per edge,"
+  " %u records, window %u ms\n\n",
+  mhz,2*entry+dispatch+record,post,call_us,edge_us,depth,window_ms);
+ for (i=0; i<(int)(sizeof(rates)/sizeof(rates[0])); i++)
+ {
+  t.period=(uint64_t)mhz*1000000/rates[i];
+  t.burst=0;
+  t.gap=0;
+  t.duration=us(100000);
+  sprintf(name,"%u edges/s for 100 ms",rates[i]);
+  report(name,&t);
+ }
+ t.period=us(1);
+ t.burst=32;
+ t.gap=us(20000);
+ t.duration=us(1000000);
+ report("bursts of 32 edges at 1 MHz every 20 ms for 1 s",&t);
+ t.period=us(10);
+ t.burst=200;
+ t.gap=us(50000);
+ report("bursts of 200 edges at 100 kHz every 50 ms for 1 s",&t);
+ return EXIT_SUCCESS;
+}
@@ -0,0 +1,458 @@
+/**
+******************************************************************************
+* @file    log_bench.c
+* @version V1.0.0
+* @brief   Caller side cost of custom_log() on the host port: printf under
+*          stdio_tx_mutex against the deferred backend of
+*          MICO/system/mico_system_log.c, with the console UART modelled as
+*          a transmitter that blocks for the characters at the baud rate.
+*          The self check compares the text of both and checks the level
+*          filter, the drop accounting and the binary framing.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mico_rtos.h"
+#include "Debug.h"
+#include "MicoDrivers/MicoDriverUart.h"
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define BURST           64      /* Lines back to back, four rings of the backend */
+#define MAX_CALLS       100000
+#define CAPTURE_SIZE    16384
+
+/******************************************************
+*                 Type Definitions
+******************************************************/
+
+typedef void (*line_fn_t)( const char* module, int i );
+
+typedef struct
+{
+    double   mean_us;
+    double   p50_us;
+    double   p99_us;
+    double   max_us;
+    uint32_t dropped;
+} latency_t;
+
+/******************************************************
+*               Function Declarations
+******************************************************/
+
+void log_direct_line( const char* module, int i );
+void log_direct_level( mico_log_level_t level );
+void log_direct_check( void );
+void log_deferred_line( const char* module, int i );
+void log_deferred_level( mico_log_level_t level );
+void log_deferred_check( void );
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+/* Platform_init of the firmware owns these */
+int          mico_debug_enabled = 1;
+mico_mutex_t stdio_tx_mutex;
+
+static FILE*            out;            /* The terminal, stdout is the UART */
+static unsigned         baud = 115200;
+static uint64_t         line_ns;        /* UART time of a benchmark line */
+
+static pthread_mutex_t  uart_mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile uint64_t uart_bytes;
+static char             capture[CAPTURE_SIZE];
+static size_t           captured;
+static int              capturing;
+
+static uint32_t         samples[MAX_CALLS];
+
+static volatile int     noise_run;
+static line_fn_t        noise_fn;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static uint64_t now_ns( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void sleep_ns( uint64_t ns )
+{
+    struct timespec t;
+    uint64_t until = now_ns( ) + ns;
+
+    t.tv_sec = until / 1000000000ull;
+    t.tv_nsec = until % 1000000000ull;
+    while ( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL ) != 0 );
+}
+
+/* The console UART: one transmitter, the caller waits for the last stop bit
+   as MicoUartSend does for its DMA */
+static void uart_transmit( const void* data, size_t size )
+{
+    size_t n;
+
+    pthread_mutex_lock( &uart_mutex );
+    if ( capturing )
+    {
+        n = size < CAPTURE_SIZE - captured ? size : CAPTURE_SIZE - captured;
+        memcpy( &capture[captured], data, n );
+        captured += n;
+    }
+    uart_bytes += size;
+    sleep_ns( (uint64_t)size * 10 * 1000000000ull / baud );
+    pthread_mutex_unlock( &uart_mutex );
+}
+
+OSStatus MicoUartSend( mico_uart_t uart, const void* data, uint32_t size )
+{
+    (void)uart;
+    uart_transmit( data, size );
+    return kNoErr;
+}
+
+/* Common.h has its own ssize_t, glibc's is the one of cookie_write_function_t */
+static __ssize_t uart_write( void* cookie, const char* data, size_t size )
+{
+    (void)cookie;
+    uart_transmit( data, size );
+    return size;
+}
+
+/* Waits until the backend has printed what it holds */
+static void uart_idle( void )
+{
+    uint64_t bytes;
+
+    do
+    {
+        bytes = uart_bytes;
+        sleep_ns( 3 * line_ns + 20000000ull );
+    } while ( bytes != uart_bytes );
+}
+
+static void capture_start( void )
+{
+    uart_idle( );
+    pthread_mutex_lock( &uart_mutex );
+    captured = 0;
+    capturing = 1;
+    pthread_mutex_unlock( &uart_mutex );
+}
+
+static void capture_stop( void )
+{
+    uart_idle( );
+    pthread_mutex_lock( &uart_mutex );
+    capturing = 0;
+    capture[captured < CAPTURE_SIZE ? captured : CAPTURE_SIZE - 1] = 0;
+    pthread_mutex_unlock( &uart_mutex );
+}
+
+static int cmp_u32( const void* a, const void* b )
+{
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void summarize( uint32_t n, latency_t* lat )
+{
+    uint64_t sum = 0;
+    uint32_t i;
+
+    for ( i = 0; i < n; i++ ) sum += samples[i];
+    qsort( samples, n, sizeof samples[0], cmp_u32 );
+    lat->mean_us = sum / 1000.0 / n;
+    lat->p50_us = samples[n / 2] / 1000.0;
+    lat->p99_us = samples[( n * 99 ) / 100] / 1000.0;
+    lat->max_us = samples[n - 1] / 1000.0;
+}
+
+static uint32_t dropped( void )
+{
+    mico_log_stats_t stats;
+    mico_log_get_stats( &stats );
+    return stats.dropped;
+}
+
+/* n calls, one every interval_ns, timed on the calling thread */
+static void paced( line_fn_t fn, uint32_t n, uint64_t interval_ns, latency_t* lat )
+{
+    uint64_t next = now_ns( ), t;
+    uint32_t i, drops = dropped( );
+
+    for ( i = 0; i < n; i++ )
+    {
+        t = now_ns( );
+        fn( "BENCH", i );
+        samples[i] = (uint32_t)( now_ns( ) - t );
+        next += interval_ns;
+        t = now_ns( );
+        if ( next > t ) sleep_ns( next - t );
+    }
+    summarize( n, lat );
+    lat->dropped = dropped( ) - drops;
+}
+
+static void run_paced( line_fn_t fn, uint32_t n, uint64_t interval_ns, latency_t* lat )
+{
+    paced( fn, n, interval_ns, lat );
+    uart_idle( );
+}
+
+static void run_burst( line_fn_t fn, latency_t* lat )
+{
+    uint64_t t;
+    uint32_t i, drops = dropped( );
+
+    for ( i = 0; i < BURST; i++ )
+    {
+        t = now_ns( );
+        fn( "BENCH", i );
+        samples[i] = (uint32_t)( now_ns( ) - t );
+    }
+    summarize( BURST, lat );
+    lat->dropped = dropped( ) - drops;
+    uart_idle( );
+}
+
+/* Another thread offering twice the lines the UART carries */
+static void* noise_thread( void* arg )
+{
+    int i = 0;
+
+    (void)arg;
+    while ( noise_run )
+    {
+        noise_fn( "NOISE", i++ );
+        sleep_ns( line_ns / 2 );
+    }
+    return NULL;
+}
+
+static void run_busy( line_fn_t fn, uint32_t n, uint64_t interval_ns, latency_t* lat )
+{
+    pthread_t noise;
+
+    noise_fn = fn;
+    noise_run = 1;
+    pthread_create( &noise, NULL, noise_thread, NULL );
+    paced( fn, n, interval_ns, lat );
+    noise_run = 0;
+    pthread_join( noise, NULL );
+    uart_idle( );
+}
+
+static void print_row( const char* name, const latency_t* lat, int drops )
+{
+    fprintf( out, "    %-18s %9.1f %9.1f %9.1f %9.1f", name, lat->mean_us, lat->p50_us, lat->p99_us, lat->max_us );
+    if ( drops ) fprintf( out, " %8u", (unsigned)lat->dropped );
+    fprintf( out, "\n" );
+}
+
+static int report( const char* name, int ok )
+{
+    fprintf( out, "  %-44s %s\n", name, ok ? "ok" : "FAILED" );
+    return ok ? 0 : 1;
+}
+
+/* The text after the "[time][module: file:line] " prefix of each line */
+static int same_messages( const char* a, const char* b )
+{
+    const char *ea, *eb, *ma, *mb;
+    int lines = 0;
+
+    while ( *a && *b )
+    {
+        ea = strchr( a, '\n' );
+        eb = strchr( b, '\n' );
+        ma = strstr( a, "] " );
+        mb = strstr( b, "] " );
+        if ( !ea || !eb || !ma || !mb || ma > ea || mb > eb ) return 0;
+        if ( ea - ma != eb - mb || memcmp( ma, mb, ea - ma ) != 0 )
+        {
+            fprintf( out, "    %.*s\n    %.*s\n", (int)( ea - a ), a, (int)( eb - b ), b );
+            return 0;
+        }
+        a = ea + 1;
+        b = eb + 1;
+        lines++;
+    }
+    return *a == 0 && *b == 0 && lines > 0;
+}
+
+static int self_check( void )
+{
+    static char direct[CAPTURE_SIZE];
+    mico_log_stats_t s0, s1;
+    int fails = 0;
+
+    capture_start( );
+    log_direct_check( );
+    capture_stop( );
+    strcpy( direct, capture );
+    capture_start( );
+    log_deferred_check( );
+    capture_stop( );
+    fails += report( "deferred text matches printf", same_messages( direct, capture ) );
+
+    mico_log_set_level( "LEVEL", MICO_LOG_WARN );
+    mico_log_get_stats( &s0 );
+    capture_start( );
+    log_deferred_level( MICO_LOG_INFO );
+    log_deferred_level( MICO_LOG_ERR );
+    capture_stop( );
+    mico_log_get_stats( &s1 );
+    fails += report( "module level filters", strstr( capture, "level 1" ) != NULL &&
+                    strstr( capture, "level 3" ) == NULL && s1.filtered - s0.filtered == 1 );
+    mico_log_set_level( "LEVEL", MICO_LOG_INFO );
+
+    capture_start( );
+    log_direct_level( MICO_LOG_DEBUG );
+    capture_stop( );
+    fails += report( "printf backend prints every level", strstr( capture, "level 4" ) != NULL );
+
+    mico_log_get_stats( &s0 );
+    capture_start( );
+    {
+        int i;
+        for ( i = 0; i < BURST; i++ ) log_deferred_line( "BENCH", i );
+    }
+    capture_stop( );
+    mico_log_get_stats( &s1 );
+    fails += report( "a full ring drops and says so", s1.dropped > s0.dropped &&
+                    ( s1.logged - s0.logged ) + ( s1.dropped - s0.dropped ) == BURST &&
+                    strstr( capture, "records dropped" ) != NULL );
+
+    mico_log_set_binary( true );
+    capture_start( );
+    log_deferred_line( "BENCH", 1 );
+    capture_stop( );
+    mico_log_set_binary( false );
+    fails += report( "binary record framing", captured > 3 && (uint8_t)capture[0] == 0xA5 &&
+                    (uint8_t)capture[1] == 0x5A && (uint8_t)capture[2] == captured );
+    return fails;
+}
+
+static void usage( void )
+{
+    fprintf( out, "log_bench [-n calls] [-b baud] [-k]\n"
+                  "  -n calls  calls per measurement, default 200\n"
+                  "  -b baud   console UART, default 115200\n"
+                  "  -k        self check only\n" );
+}
+
+int main( int argc, char** argv )
+{
+    static cookie_io_functions_t uart_io = { NULL, uart_write, NULL, NULL };
+    uint32_t n = 200;
+    uint64_t interval;
+    latency_t lat;
+    int opt, check_only = 0;
+
+    out = fdopen( dup( STDOUT_FILENO ), "w" );
+    setvbuf( out, NULL, _IOLBF, 0 );
+
+    while ( ( opt = getopt( argc, argv, "n:b:kh" ) ) != -1 )
+    {
+        switch ( opt )
+        {
+            case 'n': n = (uint32_t)atoi( optarg ); break;
+            case 'b': baud = (unsigned)atoi( optarg ); break;
+            case 'k': check_only = 1; break;
+            default: usage( ); return 2;
+        }
+    }
+    if ( n == 0 || n > MAX_CALLS || baud == 0 )
+    {
+        usage( );
+        return 2;
+    }
+
+    /* printf of the firmware goes to the console UART */
+    stdout = fopencookie( NULL, "w", uart_io );
+    setvbuf( stdout, NULL, _IOLBF, 256 );
+    mico_rtos_init_mutex( &stdio_tx_mutex );
+    if ( mico_log_init( ) != kNoErr )
+    {
+        fprintf( out, "mico_log_init failed\n" );
+        return 1;
+    }
+
+    line_ns = 1000000;
+    capture_start( );
+    log_direct_line( "BENCH", 17 );
+    capture_stop( );
+    line_ns = (uint64_t)captured * 10 * 1000000000ull / baud;
+    interval = line_ns * 3 / 2;
+
+    fprintf( out, "custom_log, console at %u baud: a line of %u characters takes %.2f ms\n",
+             baud, (unsigned)captured, line_ns / 1e6 );
+    if ( self_check( ) != 0 ) return 1;
+    if ( check_only ) return 0;
+
+    fprintf( out, "\n  caller time per call, us      mean       p50       p99       max  dropped\n" );
+    fprintf( out, "  one line every %.2f ms\n", interval / 1e6 );
+    run_paced( log_direct_line, n, interval, &lat );
+    print_row( "direct", &lat, 0 );
+    run_paced( log_deferred_line, n, interval, &lat );
+    print_row( "deferred", &lat, 1 );
+    mico_log_set_binary( true );
+    run_paced( log_deferred_line, n, interval, &lat );
+    mico_log_set_binary( false );
+    print_row( "deferred binary", &lat, 1 );
+
+    fprintf( out, "  %d lines back to back\n", BURST );
+    run_burst( log_direct_line, &lat );
+    print_row( "direct", &lat, 0 );
+    run_burst( log_deferred_line, &lat );
+    print_row( "deferred", &lat, 1 );
+
+    fprintf( out, "  one line every %.2f ms, another thread logging twice what the UART carries\n", interval / 1e6 );
+    run_busy( log_direct_line, n, interval, &lat );
+    print_row( "direct", &lat, 0 );
+    run_busy( log_deferred_line, n, interval, &lat );
+    print_row( "deferred", &lat, 1 );
+
+    fprintf( out, "  below the level of the module\n" );
+    mico_log_set_level( "BENCH", MICO_LOG_ERR );
+    run_paced( log_deferred_line, n, 10000, &lat );
+    mico_log_set_level( "BENCH", MICO_LOG_INFO );
+    print_row( "deferred", &lat, 1 );
+    return 0;
+}
@@ -0,0 +1,66 @@
+/**
+******************************************************************************
+* @file    log_call.c
+* @version V1.0.0
+* @brief   The custom_log() call sites of log_bench, built twice: with
+*          MICO_DEFERRED_LOG=0 (printf under stdio_tx_mutex) and with
+*          MICO_DEFERRED_LOG=1 (mico_log_deferred), the functions named
+*          after LOG_CALL.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include "MICO.h"
+
+#ifndef LOG_CALL
+#error "LOG_CALL names the functions of this build"
+#endif
+
+#define LOG_FN2(prefix, name)   prefix##_##name
+#define LOG_FN1(prefix, name)   LOG_FN2(prefix, name)
+#define LOG_FN(name)            LOG_FN1(LOG_CALL, name)
+
+/* The line of the benchmark, 70 characters or so on the UART */
+void LOG_FN(line)( const char* module, int i )
+{
+    custom_log( module, "sample %d of %s, %u bytes free", i, "log_bench", 31072u );
+}
+
+/* A level other than the default, only the deferred backend filters it */
+void LOG_FN(level)( mico_log_level_t level )
+{
+    custom_log_level( "LEVEL", level, "level %d", (int)level );
+}
+
+/* Every kind of conversion, both builds must print the same text */
+void LOG_FN(check)( void )
+{
+    custom_log( "CHECK", "no arguments" );
+    custom_log( "CHECK", "int %d %i neg %d", 42, -7, -123456 );
+    custom_log( "CHECK", "unsigned %u hex %x %08X oct %o", 4000000000u, 0xbeef, 0x1234abcd, 8 );
+    custom_log( "CHECK", "char %c%c width %5d|%-5d|", 'o', 'k', 17, 17 );
+    custom_log( "CHECK", "star %*d|%-*s|%.*s", 6, 99, 4, "ab", 3, "abcdef" );
+    custom_log( "CHECK", "long %ld %lu long long %lld %llx", -5L, 7UL, -1234567890123LL, 0x123456789abcULL );
+    custom_log( "CHECK", "double %f %.3e %g %5.1f", 3.25, 12345.678, 0.5, -2.25 );
+    custom_log( "CHECK", "strings %s and %s, percent 100%%", "first", "second" );
+}
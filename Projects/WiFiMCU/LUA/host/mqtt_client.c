@@ -0,0 +1,589 @@
+/**
+******************************************************************************
+* @file    mqtt_client.c
+* @version V1.0.0
+* @brief   The client API of MQTT/MQTTClient.h for the host firmware, in
+*          place of mico_mqtt_client_cm4_release.a: MQTT 3.1 and 3.1.1 over
+*          the MICO sockets, QoS 0 to 2, no SSL. Calls block like those of
+*          the library, a command waits for its acknowledgement for the
+*          command timeout and handles what arrives meanwhile.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include "MICO.h"
+#include "MQTTClient.h"
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define MQTT_CONNECT        (1)
+#define MQTT_CONNACK        (2)
+#define MQTT_PUBLISH        (3)
+#define MQTT_PUBACK         (4)
+#define MQTT_PUBREC         (5)
+#define MQTT_PUBREL         (6)
+#define MQTT_PUBCOMP        (7)
+#define MQTT_SUBSCRIBE      (8)
+#define MQTT_SUBACK         (9)
+#define MQTT_UNSUBSCRIBE    (10)
+#define MQTT_UNSUBACK       (11)
+#define MQTT_PINGREQ        (12)
+#define MQTT_PINGRESP       (13)
+#define MQTT_DISCONNECT     (14)
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static void timer_start( Timer* t, uint32_t ms )
+{
+  t->systick_period = ms;
+  t->end_time = mico_get_time( ) + ms;
+  t->over_flow = false;
+}
+
+static uint32_t timer_left( Timer* t )
+{
+  int32_t left = (int32_t)( t->end_time - mico_get_time( ) );
+  return ( left > 0 ) ? (uint32_t)left : 0;
+}
+
+/* len bytes within timeout_ms, what arrived by then, -1 once the
+ * connection is closed or failed */
+static int host_mqtt_read( Network* n, unsigned char* buf, int len, int timeout_ms )
+{
+  uint32_t end = mico_get_time( ) + timeout_ms;
+  int got = 0, rc;
+  fd_set readfds;
+  struct timeval_t t;
+
+  while ( got < len )
+  {
+    int32_t left = (int32_t)( end - mico_get_time( ) );
+    if ( left < 0 )
+      left = 0;
+    FD_ZERO( &readfds );
+    FD_SET( n->my_socket, &readfds );
+    t.tv_sec = left / 1000;
+    t.tv_usec = ( left % 1000 ) * 1000;
+    rc = select( n->my_socket + 1, &readfds, NULL, NULL, &t );
+    if ( rc < 0 )
+      return -1;
+    if ( rc == 0 )
+      break;
+    rc = recv( n->my_socket, buf + got, len - got, 0 );
+    if ( rc <= 0 )
+      return -1;
+    got += rc;
+  }
+  return got;
+}
+
+static int host_mqtt_write( Network* n, unsigned char* buf, int len, int timeout_ms )
+{
+  int sent = 0, rc;
+  UNUSED_PARAMETER( timeout_ms );
+
+  while ( sent < len )
+  {
+    rc = send( n->my_socket, buf + sent, len - sent, 0 );
+    if ( rc <= 0 )
+      return -1;
+    sent += rc;
+  }
+  return sent;
+}
+
+static void host_mqtt_disconnect( Network* n )
+{
+  if ( n->my_socket >= 0 )
+    close( n->my_socket );
+  n->my_socket = -1;
+}
+
+int NewNetwork( Network* n, char* addr, int port, ssl_opts ssl_settings )
+{
+  char ip[16];
+  struct sockaddr_t sa;
+  int fd;
+
+  n->my_socket = -1;
+  n->mqttread = host_mqtt_read;
+  n->mqttwrite = host_mqtt_write;
+  n->disconnect = host_mqtt_disconnect;
+  n->ssl = NULL;
+  n->ssl_flag = 0;
+  if ( ssl_settings.ssl_enable )
+    return MQTT_FAILURE;
+
+  if ( gethostbyname( addr, (uint8_t *)ip, sizeof(ip) ) != kNoErr )
+    return MQTT_SOCKET_ERR;
+  fd = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+  if ( fd < 0 )
+    return MQTT_SOCKET_ERR;
+  memset( &sa, 0, sizeof(sa) );
+  sa.s_ip = inet_addr( ip );
+  sa.s_port = port;
+  if ( connect( fd, &sa, sizeof(sa) ) < 0 )
+  {
+    close( fd );
+    return MQTT_SOCKET_ERR;
+  }
+  n->my_socket = fd;
+  return MQTT_SUCCESS;
+}
+
+int MQTTClientInit( Client* c, Network* network, unsigned int command_timeout_ms )
+{
+  memset( c, 0, sizeof(Client) );
+  c->buf = malloc( DEFAULT_SENDBUF_SIZE );
+  c->readbuf = malloc( DEFAULT_READBUF_SIZE );
+  if ( c->buf == NULL || c->readbuf == NULL )
+  {
+    MQTTClientDeinit( c );
+    return MQTT_FAILURE;
+  }
+  c->buf_size = DEFAULT_SENDBUF_SIZE;
+  c->readbuf_size = DEFAULT_READBUF_SIZE;
+  c->ipstack = network;
+  c->command_timeout_ms = command_timeout_ms;
+  c->next_packetid = 1;
+  return MQTT_SUCCESS;
+}
+
+int MQTTClientDeinit( Client* c )
+{
+  if ( c->buf != NULL )
+    free( c->buf );
+  if ( c->readbuf != NULL )
+    free( c->readbuf );
+  c->buf = NULL;
+  c->readbuf = NULL;
+  c->isconnected = 0;
+  return MQTT_SUCCESS;
+}
+
+uint32_t MQTTClientLibVersion( void )
+{
+  return MQTT_LIB_VERSION;
+}
+
+/*** Packets ***/
+
+static unsigned char* put_len( unsigned char* p, int len )
+{
+  do
+  {
+    unsigned char d = len % 128;
+    len /= 128;
+    *p++ = ( len > 0 ) ? ( d | 0x80 ) : d;
+  } while ( len > 0 );
+  return p;
+}
+
+static unsigned char* put_int( unsigned char* p, int v )
+{
+  *p++ = (unsigned char)( v >> 8 );
+  *p++ = (unsigned char)v;
+  return p;
+}
+
+static unsigned char* put_str( unsigned char* p, const char* s, int len )
+{
+  p = put_int( p, len );
+  memcpy( p, s, len );
+  return p + len;
+}
+
+static int str_len( const MQTTString* s )
+{
+  return ( s->cstring != NULL ) ? (int)strlen( s->cstring ) : s->lenstring.len;
+}
+
+static const char* str_data( const MQTTString* s )
+{
+  return ( s->cstring != NULL ) ? s->cstring : s->lenstring.data;
+}
+
+/* The fixed header in front of rem bytes, NULL when they do not fit */
+static unsigned char* put_header( Client* c, unsigned char type, int rem )
+{
+  unsigned char* p = c->buf;
+  if ( rem + 5 > (int)c->buf_size )
+    return NULL;
+  *p++ = type;
+  return put_len( p, rem );
+}
+
+static int send_packet( Client* c, unsigned char* end )
+{
+  int len = end - c->buf;
+  if ( c->ipstack->mqttwrite( c->ipstack, c->buf, len, c->command_timeout_ms ) != len )
+    return MQTT_SOCKET_ERR;
+  return MQTT_SUCCESS;
+}
+
+static int send_ack( Client* c, unsigned char type, unsigned short id )
+{
+  unsigned char* p = put_header( c, type, 2 );
+  return send_packet( c, put_int( p, id ) );
+}
+
+/* The next packet into readbuf, its type; 0 when none arrived in time */
+static int read_packet( Client* c, Timer* t, int* rem )
+{
+  int len = 0, mult = 1, i, rc;
+  unsigned char b;
+
+  rc = c->ipstack->mqttread( c->ipstack, c->readbuf, 1, timer_left( t ) );
+  if ( rc <= 0 )
+    return rc;
+  for ( i = 0; i < 4; i++ )
+  {
+    if ( c->ipstack->mqttread( c->ipstack, &b, 1, c->command_timeout_ms ) != 1 )
+      return MQTT_SOCKET_ERR;
+    len += ( b & 0x7F ) * mult;
+    mult *= 128;
+    if ( ( b & 0x80 ) == 0 )
+      break;
+  }
+  if ( i == 4 || len + 1 > (int)c->readbuf_size )
+    return MQTT_BUFFER_OVERFLOW;
+  if ( len > 0 && c->ipstack->mqttread( c->ipstack, c->readbuf + 1, len, c->command_timeout_ms ) != len )
+    return MQTT_SOCKET_ERR;
+  *rem = len;
+  return c->readbuf[0] >> 4;
+}
+
+/* Level by level, '+' takes one level and '#' the rest */
+static bool topic_matched( const char* filter, const char* topic, int len )
+{
+  const char* end = topic + len;
+
+  while ( *filter != 0 )
+  {
+    if ( *filter == '#' )
+      return true;
+    if ( *filter == '+' )
+    {
+      while ( topic < end && *topic != '/' )
+        topic++;
+      filter++;
+    }
+    else
+    {
+      if ( topic == end || *topic != *filter )
+        return false;
+      topic++;
+      filter++;
+    }
+  }
+  return topic == end;
+}
+
+static void deliver( Client* c, MQTTString* topic, MQTTMessage* m )
+{
+  MessageData md = { m, topic };
+  int i;
+
+  for ( i = 0; i < MAX_MESSAGE_HANDLERS; i++ )
+  {
+    if ( c->messageHandlers[i].topicFilter != NULL && c->messageHandlers[i].fp != NULL &&
+         topic_matched( c->messageHandlers[i].topicFilter, topic->lenstring.data, topic->lenstring.len ) )
+    {
+      c->messageHandlers[i].fp( &md );
+      return;
+    }
+  }
+  if ( c->defaultMessageHandler != NULL )
+    c->defaultMessageHandler( &md );
+}
+
+/* One packet: answers what needs an answer, the type of the packet */
+static int cycle( Client* c, Timer* t )
+{
+  int rem = 0, type, rc = MQTT_SUCCESS;
+  unsigned char* p;
+  MQTTString topic = { NULL, { 0, NULL } };
+  MQTTMessage m;
+
+  type = read_packet( c, t, &rem );
+  if ( type <= 0 )
+    return type;
+
+  switch ( type )
+  {
+    case MQTT_PUBLISH:
+      p = c->readbuf + 1;
+      memset( &m, 0, sizeof(m) );
+      m.qos = (enum QoS)( ( c->readbuf[0] >> 1 ) & 3 );
+      m.retained = c->readbuf[0] & 1;
+      m.dup = ( c->readbuf[0] >> 3 ) & 1;
+      topic.lenstring.len = ( p[0] << 8 ) | p[1];
+      topic.lenstring.data = (char*)p + 2;
+      p += 2 + topic.lenstring.len;
+      if ( m.qos != QOS0 )
+      {
+        m.id = ( p[0] << 8 ) | p[1];
+        p += 2;
+      }
+      if ( p > c->readbuf + 1 + rem )
+        return MQTT_FAILURE;
+      m.payload = p;
+      m.payloadlen = c->readbuf + 1 + rem - p;
+      deliver( c, &topic, &m );
+      if ( m.qos == QOS1 )
+        rc = send_ack( c, MQTT_PUBACK << 4, m.id );
+      else if ( m.qos == QOS2 )
+        rc = send_ack( c, MQTT_PUBREC << 4, m.id );
+      break;
+    case MQTT_PUBREC:
+      rc = send_ack( c, ( MQTT_PUBREL << 4 ) | 0x02, ( c->readbuf[2] << 8 ) | c->readbuf[3] );
+      break;
+    case MQTT_PUBREL:
+      rc = send_ack( c, MQTT_PUBCOMP << 4, ( c->readbuf[2] << 8 ) | c->readbuf[3] );
+      break;
+    case MQTT_PINGRESP:
+      c->ping_outstanding = 0;
+      break;
+  }
+  return ( rc == MQTT_SUCCESS ) ? type : rc;
+}
+
+static int wait_for( Client* c, int type, Timer* t )
+{
+  int rc;
+  do
+  {
+    rc = cycle( c, t );
+    if ( rc == type )
+      return type;
+    if ( rc < 0 )
+      return rc;
+  } while ( timer_left( t ) > 0 );
+  return MQTT_FAILURE;
+}
+
+static unsigned short next_id( Client* c )
+{
+  c->next_packetid = ( c->next_packetid == MAX_PACKET_ID ) ? 1 : c->next_packetid + 1;
+  return (unsigned short)c->next_packetid;
+}
+
+/*** API ***/
+
+int MQTTConnect( Client* c, MQTTPacket_connectData* options )
+{
+  Timer t;
+  unsigned char* p;
+  unsigned char flags = 0;
+  bool v31 = ( options->MQTTVersion == 3 );
+  int rem = ( v31 ? 12 : 10 ) + 2 + str_len( &options->clientID );
+
+  if ( c->isconnected )
+    return MQTT_FAILURE;
+  if ( options->cleansession )
+    flags |= 0x02;
+  if ( options->willFlag )
+  {
+    flags |= 0x04 | ( ( options->will.qos & 3 ) << 3 ) | ( options->will.retained ? 0x20 : 0 );
+    rem += 4 + str_len( &options->will.topicName ) + str_len( &options->will.message );
+  }
+  if ( str_len( &options->username ) > 0 )
+  {
+    flags |= 0x80;
+    rem += 2 + str_len( &options->username );
+  }
+  if ( str_len( &options->password ) > 0 )
+  {
+    flags |= 0x40;
+    rem += 2 + str_len( &options->password );
+  }
+
+  p = put_header( c, MQTT_CONNECT << 4, rem );
+  if ( p == NULL )
+    return MQTT_BUFFER_OVERFLOW;
+  p = v31 ? put_str( p, "MQIsdp", 6 ) : put_str( p, "MQTT", 4 );
+  *p++ = v31 ? 3 : 4;
+  *p++ = flags;
+  p = put_int( p, options->keepAliveInterval );
+  p = put_str( p, str_data( &options->clientID ), str_len( &options->clientID ) );
+  if ( options->willFlag )
+  {
+    p = put_str( p, str_data( &options->will.topicName ), str_len( &options->will.topicName ) );
+    p = put_str( p, str_data( &options->will.message ), str_len( &options->will.message ) );
+  }
+  if ( flags & 0x80 )
+    p = put_str( p, str_data( &options->username ), str_len( &options->username ) );
+  if ( flags & 0x40 )
+    p = put_str( p, str_data( &options->password ), str_len( &options->password ) );
+
+  timer_start( &t, c->command_timeout_ms );
+  if ( send_packet( c, p ) != MQTT_SUCCESS )
+    return MQTT_SOCKET_ERR;
+  if ( wait_for( c, MQTT_CONNACK, &t ) != MQTT_CONNACK || c->readbuf[3] != 0 )
+    return MQTT_FAILURE;
+
+  c->keepAliveInterval = options->keepAliveInterval;
+  c->ping_outstanding = 0;
+  c->isconnected = 1;
+  return MQTT_SUCCESS;
+}
+
+int MQTTPublish( Client* c, const char* topicName, MQTTMessage* message )
+{
+  Timer t;
+  unsigned char* p;
+  int tlen = strlen( topicName );
+  int rem = 2 + tlen + message->payloadlen + ( ( message->qos != QOS0 ) ? 2 : 0 );
+
+  if ( !c->isconnected )
+    return MQTT_FAILURE;
+  p = put_header( c, ( MQTT_PUBLISH << 4 ) | ( message->dup ? 0x08 : 0 ) | ( message->qos << 1 ) |
+                     ( message->retained ? 1 : 0 ), rem );
+  if ( p == NULL )
+    return MQTT_BUFFER_OVERFLOW;
+  p = put_str( p, topicName, tlen );
+  if ( message->qos != QOS0 )
+  {
+    message->id = next_id( c );
+    p = put_int( p, message->id );
+  }
+  memcpy( p, message->payload, message->payloadlen );
+  p += message->payloadlen;
+
+  timer_start( &t, c->command_timeout_ms );
+  if ( send_packet( c, p ) != MQTT_SUCCESS )
+    return MQTT_SOCKET_ERR;
+  if ( message->qos == QOS1 && wait_for( c, MQTT_PUBACK, &t ) != MQTT_PUBACK )
+    return MQTT_FAILURE;
+  if ( message->qos == QOS2 && wait_for( c, MQTT_PUBCOMP, &t ) != MQTT_PUBCOMP )
+    return MQTT_FAILURE;
+  return MQTT_SUCCESS;
+}
+
+int MQTTSubscribe( Client* c, const char* topicFilter, enum QoS qos, messageHandler handler )
+{
+  Timer t;
+  unsigned char* p;
+  int flen = strlen( topicFilter ), i;
+
+  if ( !c->isconnected )
+    return MQTT_FAILURE;
+  p = put_header( c, ( MQTT_SUBSCRIBE << 4 ) | 0x02, 2 + 2 + flen + 1 );
+  if ( p == NULL )
+    return MQTT_BUFFER_OVERFLOW;
+  p = put_int( p, next_id( c ) );
+  p = put_str( p, topicFilter, flen );
+  *p++ = qos;
+
+  timer_start( &t, c->command_timeout_ms );
+  if ( send_packet( c, p ) != MQTT_SUCCESS )
+    return MQTT_SOCKET_ERR;
+  if ( wait_for( c, MQTT_SUBACK, &t ) != MQTT_SUBACK || c->readbuf[4] == 0x80 )
+    return MQTT_FAILURE;
+
+  for ( i = 0; i < MAX_MESSAGE_HANDLERS; i++ )
+  {
+    if ( c->messageHandlers[i].topicFilter == NULL )
+    {
+      c->messageHandlers[i].topicFilter = topicFilter;
+      c->messageHandlers[i].fp = handler;
+      return MQTT_SUCCESS;
+    }
+  }
+  return MQTT_FAILURE;
+}
+
+int MQTTUnsubscribe( Client* c, const char* topicFilter )
+{
+  Timer t;
+  unsigned char* p;
+  int flen = strlen( topicFilter ), i;
+
+  if ( !c->isconnected )
+    return MQTT_FAILURE;
+  p = put_header( c, ( MQTT_UNSUBSCRIBE << 4 ) | 0x02, 2 + 2 + flen );
+  if ( p == NULL )
+    return MQTT_BUFFER_OVERFLOW;
+  p = put_int( p, next_id( c ) );
+  p = put_str( p, topicFilter, flen );
+
+  timer_start( &t, c->command_timeout_ms );
+  if ( send_packet( c, p ) != MQTT_SUCCESS )
+    return MQTT_SOCKET_ERR;
+  if ( wait_for( c, MQTT_UNSUBACK, &t ) != MQTT_UNSUBACK )
+    return MQTT_FAILURE;
+
+  for ( i = 0; i < MAX_MESSAGE_HANDLERS; i++ )
+  {
+    if ( c->messageHandlers[i].topicFilter != NULL && strcmp( c->messageHandlers[i].topicFilter, topicFilter ) == 0 )
+    {
+      c->messageHandlers[i].topicFilter = NULL;
+      c->messageHandlers[i].fp = NULL;
+    }
+  }
+  return MQTT_SUCCESS;
+}
+
+int MQTTDisconnect( Client* c )
+{
+  unsigned char* p = put_header( c, MQTT_DISCONNECT << 4, 0 );
+  int rc = send_packet( c, p );
+  c->isconnected = 0;
+  return rc;
+}
+
+/* Handles what arrives for timeout_ms, fails once the connection does */
+int MQTTYield( Client* c, int timeout_ms )
+{
+  Timer t;
+  int rc;
+
+  timer_start( &t, timeout_ms );
+  do
+  {
+    rc = cycle( c, &t );
+    if ( rc < 0 )
+      return rc;
+  } while ( timer_left( &t ) > 0 );
+  return MQTT_SUCCESS;
+}
+
+/* A ping, fails while the one before is not answered */
+int keepalive( Client* c )
+{
+  unsigned char* p;
+
+  if ( c->keepAliveInterval == 0 )
+    return MQTT_SUCCESS;
+  if ( c->ping_outstanding )
+    return MQTT_FAILURE;
+  p = put_header( c, MQTT_PINGREQ << 4, 0 );
+  if ( send_packet( c, p ) != MQTT_SUCCESS )
+    return MQTT_SOCKET_ERR;
+  c->ping_outstanding = 1;
+  return MQTT_SUCCESS;
+}
@@ -0,0 +1,575 @@
+/*
+** lcd_sim.c
+** ../lua/exlibs/lcd.c on the host: the Lua core and the lcd module drive a
+** model of an ILI9341 panel through the same block transfer and
+** ../lua/exlibs/spi_bus.c as the hardware SPI. The panel decodes what is
+** on the wire into its frame memory, which is written out as PPM frames.
+** The self check draws the same scene directly, into the framebuffer and
+** into a tile of it; the benchmark counts the bytes, transfers and address
+** windows of each primitive and times them on the cycle model of
+** spi_bus_sim. See readme.txt.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+#include "lrotable.h"
+
+#include "MICO.h"
+#include "spiffs.h"
+#include "spi_bus.h"
+
+#define PROGNAME	"lcd_sim"
+#define PANEL_SIZE	320		/* GRAM of the ILI9341, 240x320 either way */
+
+#define TFT_CASET	0x2A
+#define TFT_RASET	0x2B
+#define TFT_RAMWR	0x2C
+
+/* Model parameters, cycles of the core unless noted, as spi_bus_sim */
+static uint32_t mhz=96;			/* core clock */
+static uint32_t spi_mhz=24;		/* SPI clock, 96/4 */
+static uint32_t gpio=40;		/* MicoGpioOutputHigh/Low, a chip select */
+static uint32_t call=300;		/* per transfer: mutex, powersave */
+static uint32_t poll_gap=30;		/* polled TXE, send, drain */
+static uint32_t dma_setup=350;		/* DMA_DeInit, DMA_Init, enable, drain */
+
+/* The panel: what the controller makes of the bytes on the wire */
+typedef struct
+{
+ uint16_t gram[PANEL_SIZE*PANEL_SIZE];
+ uint8_t dc;				/* the DC pin, 0: command */
+ uint8_t cmd, arg[4], hi;
+ uint32_t nargs, half;
+ uint16_t xs, xe, ys, ye, x, y;
+ uint64_t bytes, xfers, windows, pixels, errors;
+ double cycles;				/* by the model */
+} Panel;
+
+static Panel panel;
+
+static double wire_cycles(uint64_t bytes)
+{
+ return bytes*8.0*mhz/spi_mhz;
+}
+
+static void panel_pixel(Panel* p, uint16_t color)
+{
+ /* an empty window (x1<x0) is sent by lcd.c with no pixels, not an error */
+ if (p->x>p->xe || p->y>p->ye || p->xe>=PANEL_SIZE || p->ye>=PANEL_SIZE) { p->errors++; return; }
+ p->gram[p->y*PANEL_SIZE+p->x]=color;
+ p->pixels++;
+ if (++p->x>p->xe) { p->x=p->xs; p->y++; }
+}
+
+static void panel_byte(Panel* p, uint8_t b)
+{
+ p->bytes++;
+ if (p->dc==0)
+ {
+  p->cmd=b;
+  p->nargs=0;
+  p->half=0;
+  if (b==TFT_RAMWR)
+  {
+   p->x=p->xs;
+   p->y=p->ys;
+  }
+  return;
+ }
+ switch (p->cmd)
+ {
+  case TFT_CASET:
+  case TFT_RASET:
+   if (p->nargs<4) p->arg[p->nargs]=b;
+   if (++p->nargs!=4) break;
+   if (p->cmd==TFT_CASET)
+   {
+    p->xs=(p->arg[0]<<8)|p->arg[1];
+    p->xe=(p->arg[2]<<8)|p->arg[3];
+   }
+   else
+   {
+    p->ys=(p->arg[0]<<8)|p->arg[1];
+    p->ye=(p->arg[2]<<8)|p->arg[3];
+    p->windows++;
+   }
+   break;
+  case TFT_RAMWR:
+   if (p->half) panel_pixel(p,(uint16_t)((p->hi<<8)|b));
+   else p->hi=b;
+   p->half^=1;
+   break;
+ }
+}
+
+static void bus_poll(void* ctx, const uint8_t* tx, uint8_t* rx, uint32_t count)
+{
+ Panel* p=ctx;
+ uint32_t i;
+ for (i=0; i<count; i++) panel_byte(p,tx[i]);
+ p->cycles+=wire_cycles(count)+poll_gap;
+}
+
+static int bus_dma(void* ctx, const uint8_t* tx, uint32_t count, bool fixed)
+{
+ Panel* p=ctx;
+ uint32_t i;
+ for (i=0; i<count; i++) panel_byte(p,fixed ? tx[0] : tx[i]);
+ p->cycles+=wire_cycles(count)+dma_setup;
+ return 0;
+}
+
+static const spi_bus_ops_t bus_ops={ bus_poll, bus_dma };
+static uint8_t spi_fill[128];		/* as spi.c */
+static spi_bus_t bus={ &bus_ops, &panel, SPI_BUS_DMA_MIN, spi_fill, sizeof(spi_fill) };
+
+/* What lcd.c links against from spi.c and gpio.c: every id is set up, a
+   pin is its own number, DC goes to the panel */
+uint8_t spiInit[3]={ 1, 1, 1 };
+const char wifimcu_gpio_map[18]={ 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17 };
+extern uint8_t TFT_pinDC;
+
+OSStatus MicoGpioInitialize(mico_gpio_t gpio, mico_gpio_config_t configuration)
+{
+ return kNoErr;
+}
+
+OSStatus MicoGpioFinalize(mico_gpio_t gpio)
+{
+ return kNoErr;
+}
+
+OSStatus MicoGpioOutputHigh(mico_gpio_t pin)
+{
+ if (pin==TFT_pinDC) panel.dc=1;
+ panel.cycles+=gpio;
+ return kNoErr;
+}
+
+OSStatus MicoGpioOutputLow(mico_gpio_t pin)
+{
+ if (pin==TFT_pinDC) panel.dc=0;
+ panel.cycles+=gpio;
+ return kNoErr;
+}
+
+/* _platform_lcd_transfer() of spi.c: cmd, ndata, rep, data ... 0 */
+int _MicoLcdTransfer(uint8_t* buf, int len)
+{
+ int count=len, err=0;
+ uint16_t ndata;
+ uint32_t rep;
+ uint8_t cmd;
+ panel.xfers++;
+ panel.cycles+=call;
+ while (count>0)
+ {
+  cmd=*buf++;
+  if (cmd==0) break;
+  MicoGpioOutputLow((mico_gpio_t)TFT_pinDC);
+  panel.cycles+=gpio;			/* chip select */
+  count--;
+  err=spi_bus_write(&bus,&cmd,1,1,NULL);
+  panel.cycles+=gpio;
+  if (err!=0) break;
+  ndata=(uint16_t)(buf[0]<<8|buf[1]);
+  rep=(uint32_t)buf[2]<<24|(uint32_t)buf[3]<<16|(uint32_t)buf[4]<<8|buf[5];
+  buf+=6;
+  count-=6;
+  if (count>0 && ndata>0)
+  {
+   MicoGpioOutputHigh((mico_gpio_t)TFT_pinDC);
+   panel.cycles+=gpio;
+   err=spi_bus_write(&bus,buf,ndata,rep,NULL);
+   buf+=ndata;
+   count-=ndata;
+   panel.cycles+=gpio;
+   if (err!=0) break;
+  }
+ }
+ return err;
+}
+
+/* The software SPI ids are timed as the hardware one */
+int _swLcdTransfer(uint8_t* buf, int len)
+{
+ return _MicoLcdTransfer(buf,len);
+}
+
+void msleep(uint32_t milliseconds)
+{
+}
+
+/* spiffs of lcd.fbsave() and lcd.image(): files of the current directory */
+spiffs fs;
+static FILE* files[8];
+
+uint8_t checkFileName(int len, const char* name, char* newname, uint8_t addcurrdir, uint8_t exists)
+{
+ FILE* f;
+ if (len<=0 || len>=SPIFFS_OBJ_NAME_LEN) return 0;
+ memcpy(newname,name,len);
+ newname[len]='\0';
+ if (!exists) return 1;
+ if ((f=fopen(newname,"rb"))==NULL) return 0;
+ fclose(f);
+ return 1;
+}
+
+spiffs_file SPIFFS_open(spiffs* fs, const char* path, spiffs_flags flags, spiffs_mode mode)
+{
+ int i;
+ for (i=1; i<8 && files[i]!=NULL; i++);
+ if (i==8) return -1;
+ files[i]=fopen(path,(flags & SPIFFS_WRONLY) ? "wb" : "rb");
+ return files[i]!=NULL ? i : -1;
+}
+
+s32_t SPIFFS_read(spiffs* fs, spiffs_file fh, void* buf, s32_t len)
+{
+ return (s32_t)fread(buf,1,len,files[fh]);
+}
+
+s32_t SPIFFS_write(spiffs* fs, spiffs_file fh, void* buf, s32_t len)
+{
+ return fwrite(buf,1,len,files[fh])==(size_t)len ? len : -1;
+}
+
+s32_t SPIFFS_lseek(spiffs* fs, spiffs_file fh, s32_t offs, int whence)
+{
+ return fseek(files[fh],offs,whence)==0 ? (s32_t)ftell(files[fh]) : -1;
+}
+
+s32_t SPIFFS_eof(spiffs* fs, spiffs_file fh)
+{
+ int c=fgetc(files[fh]);
+ if (c==EOF) return 1;
+ ungetc(c,files[fh]);
+ return 0;
+}
+
+s32_t SPIFFS_close(spiffs* fs, spiffs_file fh)
+{
+ fclose(files[fh]);
+ files[fh]=NULL;
+ return 0;
+}
+
+/* The parts of lua.c and wifimcu_lua.c the core calls */
+uint8_t _lua_redir=0;
+char* _lua_redir_buf=NULL;
+uint16_t _lua_redir_ptr=0;
+
+static int quiet=0;			/* the refused calls of the self check */
+
+void l_message(const char* pname, const char* msg)
+{
+ if (quiet) return;
+ if (pname) fprintf(stderr,"%s: ",pname);
+ fprintf(stderr,"%s\n",msg);
+}
+
+int dostring(lua_State* L, const char* s, const char* name)
+{
+ int status=luaL_loadbuffer(L,s,strlen(s),name) || lua_pcall(L,0,0,0);
+ if (status)
+ {
+  l_message(PROGNAME,lua_tostring(L,-1));
+  lua_pop(L,1);
+ }
+ return status;
+}
+
+int readline4lua(const char* prompt, char* buffer, int buffer_size)
+{
+ return 0;
+}
+
+extern const luaR_entry strlib[], math_map[], tab_funcs[], lcd_map[];
+
+const luaR_table lua_rotable[]=
+{
+ { LUA_STRLIBNAME, strlib },
+ { LUA_MATHLIBNAME, math_map },
+ { LUA_TABLIBNAME, tab_funcs },
+ { "lcd", lcd_map },
+ { NULL, NULL }
+};
+
+/* The panel as a binary PPM, 5-6-5 widened as lcd.fbsave() does */
+static int write_ppm(const char* name, int w, int h)
+{
+ FILE* f=fopen(name,"wb");
+ int x, y;
+ if (f==NULL) return -1;
+ fprintf(f,"P6\n%d %d\n255\n",w,h);
+ for (y=0; y<h; y++)
+  for (x=0; x<w; x++)
+  {
+   uint16_t c=panel.gram[y*PANEL_SIZE+x];
+   fputc((c>>8)&0xF8,f);
+   fputc((c>>3)&0xFC,f);
+   fputc((c<<3)&0xF8,f);
+  }
+ return fclose(f)==0 ? 0 : -1;
+}
+
+/* frame([file]): the panel, at the size of the screen, to a PPM file */
+static int frame_count=0;
+
+static int l_frame(lua_State* L)
+{
+ char name[64];
+ int w, h;
+ lua_settop(L,1);
+ if (lua_isnil(L,1))
+ {
+  snprintf(name,sizeof(name),"frame%03d.ppm",frame_count++);
+  lua_pushstring(L,name);
+  lua_replace(L,1);
+ }
+ if (dostring(L,"_w,_h=lcd.getscreensize()","frame")!=0) return 0;
+ lua_getglobal(L,"_w");
+ lua_getglobal(L,"_h");
+ w=lua_tointeger(L,-2);
+ h=lua_tointeger(L,-1);
+ lua_pushboolean(L,write_ppm(luaL_checkstring(L,1),w,h)==0);
+ return 1;
+}
+
+static lua_State* open_lua(void)
+{
+ static const lua_CFunction libs[]={ luaopen_base };	/* the rest are in lua_rotable */
+ lua_State* L=lua_open();
+ unsigned i;
+ for (i=0; i<sizeof(libs)/sizeof(libs[0]); i++)
+ {
+  lua_pushcfunction(L,libs[i]);
+  lua_call(L,0,0);
+ }
+ lua_register(L,"frame",l_frame);
+ return L;
+}
+
+static int failures=0;
+
+/* not expect(), Debug.h has one */
+#define expect(cond) do { if (!(cond)) { \
+    printf("FAIL %s:%d: %s\n",__FILE__,__LINE__,#cond); failures++; } } while (0)
+
+static int run(lua_State* L, const char* s)
+{
+ int status=dostring(L,s,PROGNAME);
+ expect(status==0);
+ return status;
+}
+
+/* ILI9341 on the hardware SPI, DC on pin 1, portrait */
+#define INIT	"lcd.init(2,1,3,lcd.PORTRAIT) "
+
+/* A bit of everything lcd.c draws, the fonts included */
+static const char scene[]=
+ "function scene()"
+ " lcd.clear(lcd.NAVY)"
+ " lcd.setcolor(lcd.WHITE,lcd.NAVY)"
+ " for i=0,59 do lcd.putpixel(10+i*3,4+i%3,lcd.YELLOW) end"
+ " lcd.line(0,0,239,319,lcd.RED)"
+ " lcd.line(239,10,0,200,lcd.GREEN)"
+ " lcd.rect(20,30,100,60,lcd.WHITE,lcd.DARKGREEN)"
+ " lcd.rect(150,20,60,40,lcd.ORANGE)"
+ " lcd.circle(160,110,40,lcd.YELLOW,lcd.MAROON)"
+ " lcd.circle(60,140,25,lcd.CYAN)"
+ " lcd.triangle(20,300,120,170,220,290,lcd.CYAN,lcd.PURPLE)"
+ " lcd.setfont(lcd.FONT_SMALL) lcd.write(4,12,'Small font 0123456789')"
+ " lcd.setfont(lcd.FONT_BIG) lcd.write(4,200,'Big',42)"
+ " lcd.setfont(lcd.FONT_DEJAVU18) lcd.write(lcd.CENTER,230,'DejaVu 18')"
+ " lcd.setfont(lcd.FONT_DEJAVU12) lcd.settransp(1) lcd.write(8,260,{3.14159,3}) lcd.settransp(0)"
+ " lcd.setfont(lcd.FONT_7SEG) lcd.write(110,170,'12:34')"
+ " end";
+
+static void check_scene(const char* out)
+{
+ static uint16_t direct[PANEL_SIZE*PANEL_SIZE];
+ lua_State* L=open_lua();
+ FILE* f;
+ long size=0;
+ uint8_t *saved, *shown;
+
+ run(L,scene);
+ memset(&panel,0,sizeof(panel));
+ run(L,INIT "scene()");
+ expect(panel.errors==0);
+ expect(panel.pixels>=240*320*2);	/* the clear of init and of the scene */
+ memcpy(direct,panel.gram,sizeof(direct));
+ if (out!=NULL) expect(write_ppm(out,240,320)==0);
+
+ /* the whole screen in the framebuffer: nothing until the flush */
+ memset(&panel,0,sizeof(panel));
+ run(L,INIT);
+ panel.xfers=0;
+ run(L,"lcd.fb(1) scene()");
+ expect(panel.xfers==0);
+ run(L,"n=lcd.flush()");
+ expect(panel.errors==0);
+ expect(memcmp(direct,panel.gram,sizeof(direct))==0);
+ run(L,"assert(n==240*320, n) assert(lcd.flush()==0)");
+
+ /* lcd.fbsave() against the panel */
+ expect(write_ppm("lcd_sim_panel.ppm",240,320)==0);
+ run(L,"assert(lcd.fbsave('lcd_sim_fb.ppm')==0)");
+ saved=malloc(240*320*3+32);
+ shown=malloc(240*320*3+32);
+ f=fopen("lcd_sim_fb.ppm","rb");
+ expect(f!=NULL && (size=(long)fread(saved,1,240*320*3+32,f))>240*320*3);
+ if (f!=NULL) fclose(f);
+ f=fopen("lcd_sim_panel.ppm","rb");
+ expect(f!=NULL && (long)fread(shown,1,240*320*3+32,f)==size);
+ if (f!=NULL) fclose(f);
+ expect(memcmp(saved,shown,size)==0);
+ free(saved);
+ free(shown);
+ remove("lcd_sim_fb.ppm");
+ remove("lcd_sim_panel.ppm");
+
+ /* a tile: drawing outside of it goes to the panel at once */
+ memset(&panel,0,sizeof(panel));
+ run(L,INIT "lcd.fb(1,40,80,120,160) scene() lcd.flush()");
+ expect(panel.errors==0);
+ expect(memcmp(direct,panel.gram,sizeof(direct))==0);
+
+ /* a tile in landscape, the frame is 320x240 */
+ run(L,"lcd.setorient(lcd.LANDSCAPE) assert(lcd.fb(1,0,0,320,240)==0)"
+       " lcd.clear(lcd.BLACK) lcd.rect(280,180,20,40,lcd.RED,lcd.RED) lcd.flush()");
+ expect(panel.gram[219*PANEL_SIZE+299]==0xF800 && panel.gram[179*PANEL_SIZE+279]==0);
+ expect(panel.errors==0);
+
+ /* refused */
+ quiet=1;
+ run(L,"assert(lcd.fb(1,200,0,200,100)==-1) assert(lcd.flush()==0)"
+       " assert(lcd.fbsave('x.ppm')==-1)");
+ quiet=0;
+ lua_close(L);
+}
+
+static double now_us(void)
+{
+ struct timespec ts;
+ clock_gettime(CLOCK_MONOTONIC,&ts);
+ return ts.tv_sec*1e6+ts.tv_nsec/1e3;
+}
+
+static void bench(int n)
+{
+ static const struct { const char* name; const char* draw; } ops[]=
+ {
+  { "clear", "lcd.clear(i%2==0 and lcd.NAVY or lcd.BLACK)" },
+  { "60 putpixel", "for j=0,59 do lcd.putpixel(j*4,i%320,lcd.YELLOW) end" },
+  { "line, 240x320", "lcd.line(0,0,239,319,i)" },
+  { "line, horizontal", "lcd.line(0,i%320,239,i%320,i)" },
+  { "rect 100x60", "lcd.rect(20,30,100,60,lcd.WHITE)" },
+  { "rect 100x60 filled", "lcd.rect(20,30,100,60,lcd.WHITE,i)" },
+  { "circle r40", "lcd.circle(120,160,40,lcd.YELLOW)" },
+  { "circle r40 filled", "lcd.circle(120,160,40,lcd.YELLOW,i)" },
+  { "triangle filled", "lcd.triangle(20,300,120,170,220,290,lcd.CYAN,i)" },
+  { "text, 8x8, 20 chars", "lcd.setfont(lcd.FONT_SMALL) lcd.write(0,100,'twenty characters ok')" },
+  { "text, DejaVu 18, 10", "lcd.setfont(lcd.FONT_DEJAVU18) lcd.write(0,100,'Ten chars!')" },
+  { "7 segment, 5 digits", "lcd.setfont(lcd.FONT_7SEG) lcd.write(0,100,'12345')" },
+  { "the scene", "scene()" },
+ };
+ static const char* paths[]={ "direct", "fb + flush" };
+ char code[512];
+ lua_State* L=open_lua();
+ unsigned i, k;
+
+ printf("per call, %d calls each; module time on the cycle model: %u MHz core, SPI at %u MHz\n",
+  n,mhz,spi_mhz);
+ printf("  %-22s %-10s %8s %7s %8s %9s %9s\n","","","host us","xfers","windows","wire kB","module ms");
+ run(L,scene);
+ for (i=0; i<sizeof(ops)/sizeof(ops[0]); i++)
+  for (k=0; k<2; k++)
+  {
+   double t;
+   run(L,k ? INIT "lcd.fb(1)" : INIT);
+   memset(&panel,0,sizeof(panel));
+   snprintf(code,sizeof(code),"for i=1,%d do %s %s end",n,ops[i].draw,k ? "lcd.flush()" : "");
+   t=now_us();
+   run(L,code);
+   t=now_us()-t;
+   expect(panel.errors==0);
+   printf("  %-22s %-10s %8.1f %7.1f %8.1f %9.2f %9.3f\n",k ? "" : ops[i].name,paths[k],
+    t/n,(double)panel.xfers/n,(double)panel.windows/n,panel.bytes/1024.0/n,
+    panel.cycles/mhz/1e3/n);
+  }
+ lua_close(L);
+}
+
+/* A script of the user, frame() writes the panel */
+static int run_script(const char* name)
+{
+ lua_State* L=open_lua();
+ int status;
+ memset(&panel,0,sizeof(panel));
+ status=luaL_loadfile(L,name) || lua_pcall(L,0,0,0);
+ if (status) l_message(PROGNAME,lua_tostring(L,-1));
+ printf("%llu bytes, %llu transfers, %llu address windows, %.2f ms on the module, %d frames\n",
+  (unsigned long long)panel.bytes,(unsigned long long)panel.xfers,
+  (unsigned long long)panel.windows,panel.cycles/mhz/1e3,frame_count);
+ if (panel.errors) printf("%llu bytes the panel could not place\n",(unsigned long long)panel.errors);
+ lua_close(L);
+ return status!=0 || panel.errors!=0;
+}
+
+static void usage(const char* message)
+{
+ if (message!=NULL) fprintf(stderr,"%s: %s\n",PROGNAME,message);
+ fprintf(stderr,
+ "usage: %s [options]\n"
+ "  -k         self check only\n"
+ "  -o file    the scene of the self check as a PPM frame\n"
+ "  -r script  run a Lua script on the panel, frame([file]) writes it\n"
+ "  -n calls   calls of each primitive (default 50)\n"
+ "  -f MHz     core clock (default 96)\n"
+ "  -s MHz     SPI clock (default 24)\n"
+ "  -g n       cycles of a MicoGpio call (default 40)\n"
+ "  -m n       cycles to set up and finish a DMA (default 350)\n",
+ PROGNAME);
+ exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+ int i, n=50, check_only=0;
+ const char *out=NULL, *script=NULL;
+ for (i=1; i<argc; i++)
+ {
+  if (strcmp(argv[i],"-k")==0) check_only=1;
+  else if (i+1==argc) usage("bad option");
+  else if (strcmp(argv[i],"-o")==0) out=argv[++i];
+  else if (strcmp(argv[i],"-r")==0) script=argv[++i];
+  else if (strcmp(argv[i],"-n")==0) n=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-f")==0) mhz=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-s")==0) spi_mhz=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-g")==0) gpio=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-m")==0) dma_setup=atoi(argv[++i]);
+  else usage("bad option");
+ }
+ if (mhz==0 || spi_mhz==0) usage("bad clock");
+ if (n<=0) usage("bad count");
+ if (script!=NULL) return run_script(script);
+
+ printf("self check\n");
+ check_scene(out);
+ printf("%s\n",failures==0 ? "  ok" : "  FAILED");
+ if (check_only || failures!=0) return failures!=0;
+ bench(n);
+ return failures!=0;
+}
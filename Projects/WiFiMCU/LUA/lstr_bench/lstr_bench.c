@@ -0,0 +1,472 @@
+/*
+** lstr_bench.c
+** Host build of the WiFiMCU Lua core with its string library: a self
+** check of the pattern matching and of the buffers of a call made from
+** a gsub callback, then the time of typical parsing scripts, CSV lines,
+** HTTP request headers and NMEA sentences, and of short calls. See
+** readme.txt.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define lstr_bench_c
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+
+#include "lrotable.h"
+
+#define PROGNAME	"lstr_bench"
+
+/* The read only libraries of the firmware, plus coroutine */
+extern const luaR_entry strlib[];
+extern const luaR_entry math_map[];
+extern const luaR_entry tab_funcs[];
+extern const luaR_entry co_funcs[];
+
+const luaR_table lua_rotable[] =
+{
+    {LUA_STRLIBNAME, strlib},
+    {LUA_MATHLIBNAME, math_map},
+    {LUA_TABLIBNAME, tab_funcs},
+    {LUA_COLIBNAME, co_funcs},
+    {NULL, NULL}
+};
+
+/* dostring() and its output redirection, from lua.c and wifimcu_lua.c */
+uint8_t _lua_redir=0;
+char* _lua_redir_buf=NULL;
+uint16_t _lua_redir_ptr=0;
+
+int dostring(lua_State* L, const char* s, const char* name)
+{
+ int status=luaL_loadbuffer(L,s,strlen(s),name) || lua_pcall(L,0,0,0);
+ if (status!=0)
+ {
+  fprintf(stderr,"%s\n",lua_tostring(L,-1));
+  lua_pop(L,1);
+ }
+ return status;
+}
+
+/* The self check, returns the number of failures */
+static const char check_lua[]=
+ "local fails = 0\n"
+ "local function eq (name, got, want)\n"
+ "  if got ~= want then\n"
+ "    fails = fails + 1\n"
+ "    print(string.format(\"FAIL %s: got %s, want %s\", name, tostring(got), tostring(want)))\n"
+ "  end\n"
+ "end\n"
+ "local function cat (...)\n"
+ "  local t = {}\n"
+ "  for i = 1, select(\"#\", ...) do t[i] = tostring(select(i, ...)) end\n"
+ "  return table.concat(t, \"|\")\n"
+ "end\n"
+ "local function gm (s, p)\n"
+ "  local t = {}\n"
+ "  for a, b in string.gmatch(s, p) do t[#t+1] = b and a .. \",\" .. b or a end\n"
+ "  return table.concat(t, \"|\")\n"
+ "end\n"
+ "\n"
+ "-- the patterns, whatever they compile to\n"
+ "eq(\"find\", cat(string.find(\"key=value\", \"(%w+)=(%w+)\")), \"1|9|key|value\")\n"
+ "eq(\"find init\", cat(string.find(\"a1b2c3\", \"%d\", 3)), \"4|4\")\n"
+ "eq(\"find anchor\", cat(string.find(\"abc\", \"^b\")), \"nil\")\n"
+ "eq(\"find prefix\", cat(string.find(\"xx$GPGGA,1,2\", \"%$GPGGA,(%d)\")), \"3|10|1\")\n"
+ "eq(\"find prefix miss\", cat(string.find(\"$GPGG\", \"%$GPGGA\")), \"nil\")\n"
+ "eq(\"find end\", cat(string.find(\"abc\", \"c$\")), \"3|3\")\n"
+ "eq(\"find plain\", cat(string.find(\"a.b\", \".\", 1, true)), \"2|2\")\n"
+ "eq(\"match set\", string.match(\"a,b;c\", \"[^,;]+$\"), \"c\")\n"
+ "eq(\"match set first\", string.match(\"  x12\", \"[%d]+\"), \"12\")\n"
+ "eq(\"match class first\", cat(string.match(\"ab 12 cd\", \"(%d+)()\")), \"12|6\")\n"
+ "eq(\"match frontier\", string.match(\"THE (quick) fox\", \"%f[%a]%a+%f[%A]\", 5), \"quick\")\n"
+ "eq(\"match balance\", string.match(\"x(a(b)c)y\", \"%b()\"), \"(a(b)c)\")\n"
+ "eq(\"match backref\", cat(string.match(\"say 'hi' now\", \"(['\\\"])(.-)%1\")), \"'|hi\")\n"
+ "eq(\"match position\", cat(string.match(\"hello\", \"()ll()\")), \"3|5\")\n"
+ "eq(\"match optional\", string.match(\"color colour\", \"colou?r\", 3), \"colour\")\n"
+ "eq(\"match plus prefix\", string.match(\"xaaab\", \"a+b\"), \"aaab\")\n"
+ "eq(\"match star prefix\", string.match(\"xb\", \"ya*b\"), nil)\n"
+ "eq(\"match lazy\", string.match(\"<a><b>\", \"<(.-)>\"), \"a\")\n"
+ "eq(\"match dollar\", string.match(\"a$b\", \"a$b\"), \"a$b\")\n"
+ "eq(\"match caret\", string.match(\"a^b\", \"a^b\"), \"a^b\")\n"
+ "eq(\"match escape\", string.match(\"1+2=3\", \"%+(%d)%=\"), \"2\")\n"
+ "eq(\"match bracket\", string.match(\"a]b\", \"[]]\"), \"]\")\n"
+ "eq(\"match range\", string.match(\"x-y\", \"[%a-]+\"), \"x-y\")\n"
+ "eq(\"gmatch\", gm(\"one two  three\", \"%a+\"), \"one|two|three\")\n"
+ "eq(\"gmatch empty\", gm(\",a,,b\", \"([^,]*)\"), \"|a|||b|\")\n"
+ "eq(\"gmatch pairs\", gm(\"a=1, b=2\", \"(%w+)=(%w+)\"), \"a,1|b,2\")\n"
+ "eq(\"gmatch caret\", gm(\"^a^b\", \"^%a\"), \"^a|^b\")\n"
+ "eq(\"gsub\", cat(string.gsub(\"hello world\", \"o\", \"0\")), \"hell0 w0rld|2\")\n"
+ "eq(\"gsub max\", cat(string.gsub(\"aaa\", \"a\", \"b\", 2)), \"bba|2\")\n"
+ "eq(\"gsub anchor\", cat(string.gsub(\"aaa\", \"^a\", \"b\")), \"baa|1\")\n"
+ "eq(\"gsub table\", cat(string.gsub(\"$x $y\", \"%$(%w+)\", {x = \"1\"})), \"1 $y|2\")\n"
+ "eq(\"gsub captures\", cat(string.gsub(\"k=v\", \"(%w)=(%w)\", \"%2=%1\")), \"v=k|1\")\n"
+ "eq(\"gsub empty\", cat(string.gsub(\"abc\", \"\", \"-\")), \"-a-b-c-|4\")\n"
+ "eq(\"gsub prefix\", cat(string.gsub(\"a.b.c\", \"%.b\", \"\")), \"a.c|1\")\n"
+ "eq(\"gsub set\", cat(string.gsub(\"a1b22c\", \"[%d]+\", \"#\")), \"a#b#c|2\")\n"
+ "eq(\"gsub long\", cat(string.gsub(string.rep(\"ab,\", 400), \",\", \";\")), string.rep(\"ab;\", 400) .. \"|400\")\n"
+ "eq(\"gsub short\", cat(string.gsub(string.rep(\"a,\", 32), \",\", \";\")), string.rep(\"a;\", 32) .. \"|32\")\n"
+ "eq(\"gsub short grows\", cat(string.gsub(string.rep(\"a\", 64), \"a\", \"bb\")), string.rep(\"bb\", 64) .. \"|64\")\n"
+ "eq(\"gsub short number\", cat(string.gsub(\"a.b\", \"%.\", 7)), \"a7b|1\")\n"
+ "local function cats (s, n) local r = \"\" for i = 1, n do r = r .. s end return r end\n"
+ "eq(\"rep short\", string.rep(\"abc\", 21) .. string.rep(\"x\", 0) .. string.rep(\"\", 5), cats(\"abc\", 21))\n"
+ "eq(\"rep edge\", string.rep(\"ab\", 32) .. string.rep(\"ab\", 33) .. string.rep(\"ab\", -1), cats(\"ab\", 65))\n"
+ "eq(\"upper edge\", string.upper(cats(\"a\", 64)) .. string.upper(cats(\"b\", 65)), cats(\"A\", 64) .. cats(\"B\", 65))\n"
+ "eq(\"reverse edge\", string.reverse(cats(\"ab\", 32)) .. string.reverse(\"x\" .. cats(\"ab\", 32)), cats(\"ba\", 64) .. \"x\")\n"
+ "local codes, want = {}, \"\"\n"
+ "for i = 1, 70 do codes[i] = 64 + i % 26; want = want .. string.char(codes[i]) end\n"
+ "eq(\"char edge\", string.char(unpack(codes, 1, 64)) .. string.char(unpack(codes)), string.sub(want, 1, 64) .. want)\n"
+ "eq(\"format\", string.format(\"x=%d y=%5.1f %s %%\", 3, 2.25, \"ok\"), \"x=3 y=  2.2 ok %\")\n"
+ "eq(\"format edge\", string.format(\"%s%s\", cats(\"a\", 60), \"bcde\") .. string.format(cats(\"a\", 60) .. \"%d\", 12345),\n"
+ "  cats(\"a\", 60) .. \"bcde\" .. cats(\"a\", 60) .. \"12345\")\n"
+ "eq(\"format quoted\", string.format(\"%d %q\", 1, \"a\\\"b\\n\"), \"1 \\\"a\\\\\\\"b\\\\\\n\\\"\")\n"
+ "eq(\"format long\", string.format(\"<%s>\", cats(\"z\", 150)), \"<\" .. cats(\"z\", 150) .. \">\")\n"
+ "eq(\"unreached\", cat(string.find(\"abc\", \"x[\")), \"nil\")\n"
+ "eq(\"malformed\", pcall(string.find, \"x\", \"x[\"), false)\n"
+ "eq(\"malformed escape\", pcall(string.find, \"a\", \"a%\"), false)\n"
+ "eq(\"frontier\", pcall(string.find, \"a\", \"%fa\"), false)\n"
+ "\n"
+ "-- buffers of a call made while another one is building its result\n"
+ "eq(\"reenter rep\", (string.gsub(\"a b\", \"%a\", function (c) return string.rep(c, 3) end)), \"aaa bbb\")\n"
+ "eq(\"reenter format\", (string.gsub(\"1 2\", \"%d\", function (d)\n"
+ "  return string.format(\"<%02d>\", d) end)), \"<01> <02>\")\n"
+ "eq(\"reenter gsub\", (string.gsub(\"x-y\", \"%a\", function (c)\n"
+ "  return string.upper((string.gsub(c, \".\", \"%0%0\"))) end)), \"XX-YY\")\n"
+ "eq(\"reenter long\", (string.gsub(string.rep(\"abc \", 300), \"%a+\", function (w)\n"
+ "  return string.reverse(string.upper(w)) .. string.rep(\"!\", 200) end)),\n"
+ "  string.rep(\"CBA\" .. string.rep(\"!\", 200) .. \" \", 300))\n"
+ "local function expand (s, d)\n"
+ "  if d == 0 then return s end\n"
+ "  return (string.gsub(s, \"%a\", function (c) return expand(c, d - 1) .. string.format(\"%d\", d) end))\n"
+ "end\n"
+ "eq(\"reenter deep\", expand(\"ab\", 3), \"a123b123\")\n"
+ "eq(\"reenter depth\", expand(\"a\", 12), \"a123456789101112\")\n"
+ "local co = coroutine.wrap(function ()\n"
+ "  while true do coroutine.yield(string.format(\"%s\", string.rep(\"z\", 2))) end\n"
+ "end)\n"
+ "eq(\"reenter coroutine\", (string.gsub(\"ab\", \"%a\", function (c) return c .. co() end)), \"azzbzz\")\n"
+ "for i = 1, 50 do\n"
+ "  eq(\"error\", pcall(string.gsub, \"abc\", \"%a\", function () error(\"stop\") end), false)\n"
+ "  eq(\"error format\", pcall(string.format, \"%d %d\", 1, {}), false)\n"
+ "end\n"
+ "eq(\"after error\", (string.gsub(\"abc\", \"%a\", string.upper)), \"ABC\")\n"
+ "eq(\"after error rep\", #string.rep(\"x\", 2000), 2000)\n"
+ "\n"
+ "-- patterns compiled and dropped while another call is matching\n"
+ "local n = 0\n"
+ "local r = string.gsub(\"a1 b2 c3\", \"(%a)(%d)\", function (a, d)\n"
+ "  for i = 1, 40 do\n"
+ "    if string.find(\"x\" .. i, \"^x\" .. i .. \"$\") then n = n + 1 end\n"
+ "  end\n"
+ "  return d .. a\n"
+ "end)\n"
+ "eq(\"churn gsub\", r, \"1a 2b 3c\")\n"
+ "eq(\"churn count\", n, 120)\n"
+ "local out = {}\n"
+ "for w in string.gmatch(\"aa,bb,cc\", \"[^,]+\") do\n"
+ "  for i = 1, 20 do string.find(\"q\", \"[q\" .. i .. \"]\") end\n"
+ "  out[#out+1] = w\n"
+ "end\n"
+ "eq(\"churn gmatch\", table.concat(out, \" \"), \"aa bb cc\")\n"
+ "\n"
+ "-- random patterns against random subjects, the digest is that of the\n"
+ "-- interpreter without compiled patterns\n"
+ "local seed = 1\n"
+ "local function rnd (n)\n"
+ "  seed = (seed * 109 + 89) % 32768\n"
+ "  return math.floor(seed / 128) % n\n"
+ "end\n"
+ "local items = { \"a\", \"b\", \"c\", \".\", \"%a\", \"%d\", \"%s\", \"%p\", \"%w\", \"%u\", \"[ab]\",\n"
+ "  \"[^a]\", \"[a-c]\", \"[%d,]\", \"[^%s,]\", \"%.\", \"%%\", \"%$\", \",\", \"1\", \"$\", \"^\", \"%f[%a]\" }\n"
+ "local quants = { \"\", \"\", \"\", \"*\", \"+\", \"-\", \"?\" }\n"
+ "local chars = \"abc1,. $%^AB\"\n"
+ "local h1, h2 = 1, 0\n"
+ "local function digest (...)\n"
+ "  local s = cat(...)\n"
+ "  for i = 1, #s do\n"
+ "    h1 = (h1 + string.byte(s, i)) % 65521\n"
+ "    h2 = (h2 + h1) % 65521\n"
+ "  end\n"
+ "end\n"
+ "local function run (f, ...)\n"
+ "  local r = { pcall(f, ...) }\n"
+ "  if not r[1] then digest(\"E\", r[2]) else digest(unpack(r, 2)) end\n"
+ "end\n"
+ "for k = 1, 4000 do\n"
+ "  local t = {}\n"
+ "  local ni = 1 + rnd(4)\n"
+ "  for i = 1, ni do\n"
+ "    local it = items[1 + rnd(#items)]\n"
+ "    if string.sub(it, 1, 2) ~= \"%f\" then it = it .. quants[1 + rnd(#quants)] end\n"
+ "    t[i] = it\n"
+ "  end\n"
+ "  if rnd(3) == 0 then\n"
+ "    local a = 1 + rnd(ni)\n"
+ "    local b = a + rnd(ni - a + 1)\n"
+ "    t[a] = \"(\" .. t[a]\n"
+ "    t[b] = t[b] .. \")\"\n"
+ "  end\n"
+ "  if rnd(8) == 0 then\n"
+ "    local j = 1 + rnd(ni)\n"
+ "    t[j] = \"()\" .. t[j]\n"
+ "  end\n"
+ "  local p = table.concat(t)\n"
+ "  if rnd(5) == 0 then p = \"^\" .. p end\n"
+ "  if rnd(7) == 0 then p = p .. \"$\" end\n"
+ "  local s = {}\n"
+ "  for i = 1, rnd(13) do\n"
+ "    local c = 1 + rnd(#chars)\n"
+ "    s[i] = string.sub(chars, c, c)\n"
+ "  end\n"
+ "  s = table.concat(s)\n"
+ "  run(string.find, s, p, rnd(#s + 5) - 3)\n"
+ "  run(string.match, s, p)\n"
+ "  run(function ()\n"
+ "    local g = {}\n"
+ "    for a in string.gmatch(s, p) do g[#g+1] = a; if #g > 20 then break end end\n"
+ "    return unpack(g)\n"
+ "  end)\n"
+ "  run(string.gsub, s, p, \"<%0>\")\n"
+ "  run(string.gsub, s, p, function () return nil end, 2)\n"
+ "end\n"
+ "eq(\"random\", string.format(\"%d:%d\", h1, h2), \"5058:1207\")\n"
+ "return fails\n";
+
+/* The benchmarks, each returns the function to time and the bytes it
+   parses per call */
+/* 200 lines of a sensor log: lines, fields, ; for , */
+static const char csv_lua[]=
+ "local rows = {}\n"
+ "for i = 1, 200 do\n"
+ "  rows[i] = string.format(\"%d,sensor%d,%.1f,%d,%s\", i, i % 7, 20 + i % 13 / 2,\n"
+ "    40 + i % 31, (i % 3 == 0) and \"ok\" or \"\")\n"
+ "end\n"
+ "local csv = table.concat(rows, \"\\n\") .. \"\\n\"\n"
+ "return function ()\n"
+ "  local n, sum = 0, 0\n"
+ "  for line in string.gmatch(csv, \"([^\\n]*)\\n\") do\n"
+ "    local id, name, t, h, flag =\n"
+ "      string.match(line, \"^([^,]*),([^,]*),([^,]*),([^,]*),([^,]*)$\")\n"
+ "    sum = sum + tonumber(t) + tonumber(h) + #flag\n"
+ "    for f in string.gmatch(line, \"[^,]+\") do n = n + 1 end\n"
+ "    local q = string.gsub(line, \",\", \";\")\n"
+ "    n = n + #q\n"
+ "  end\n"
+ "  return n + sum\n"
+ "end, #csv\n";
+
+/* A browser request: request line, headers, query string */
+static const char http_lua[]=
+ "local req = \"GET /api/v1/status?id=42&fmt=json&name=a%20b HTTP/1.1\\r\\n\" ..\n"
+ "  \"Host: 192.168.1.10\\r\\n\" ..\n"
+ "  \"User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:60.0) Gecko/20100101\\r\\n\" ..\n"
+ "  \"Accept: text/html,application/json;q=0.9,*/*;q=0.8\\r\\n\" ..\n"
+ "  \"Accept-Language: en-US,en;q=0.5\\r\\n\" ..\n"
+ "  \"Accept-Encoding: gzip, deflate\\r\\n\" ..\n"
+ "  \"Connection: keep-alive\\r\\n\" ..\n"
+ "  \"Content-Length: 0\\r\\n\" ..\n"
+ "  \"Cache-Control: max-age=0\\r\\n\\r\\n\"\n"
+ "local hex = {}\n"
+ "for i = 0, 255 do\n"
+ "  hex[string.format(\"%02x\", i)] = string.char(i)\n"
+ "  hex[string.format(\"%02X\", i)] = string.char(i)\n"
+ "end\n"
+ "return function ()\n"
+ "  local n = 0\n"
+ "  for i = 1, 20 do\n"
+ "    local method, path, ver = string.match(req, \"^(%u+) (%S+) HTTP/(%d%.%d)\\r\\n\")\n"
+ "    local body = string.find(req, \"\\r\\n\\r\\n\", 1, true)\n"
+ "    local hdr = {}\n"
+ "    for k, v in string.gmatch(req, \"\\n([%w%-]+):%s*([^\\r\\n]*)\") do hdr[string.lower(k)] = v end\n"
+ "    local q = string.match(path, \"%?(.*)$\")\n"
+ "    for k, v in string.gmatch(q, \"([^&=]+)=([^&=]*)\") do\n"
+ "      v = string.gsub(v, \"%%(%x%x)\", hex)\n"
+ "      n = n + #k + #v\n"
+ "    end\n"
+ "    n = n + #method + #ver + tonumber(hdr[\"content-length\"]) + body\n"
+ "    if hdr.connection == \"keep-alive\" then n = n + 1 end\n"
+ "    if string.find(hdr[\"accept-encoding\"], \"gzip\", 1, true) then n = n + 1 end\n"
+ "  end\n"
+ "  return n\n"
+ "end, 20 * #req\n";
+
+/* 180 GPS sentences: framing and checksum, GGA and RMC fields */
+static const char nmea_lua[]=
+ "local function xor (a, b)\n"
+ "  local r, m = 0, 1\n"
+ "  while a > 0 or b > 0 do\n"
+ "    if a % 2 ~= b % 2 then r = r + m end\n"
+ "    a, b, m = math.floor(a / 2), math.floor(b / 2), m * 2\n"
+ "  end\n"
+ "  return r\n"
+ "end\n"
+ "local function sentence (body)\n"
+ "  local c = 0\n"
+ "  for i = 1, #body do c = xor(c, string.byte(body, i)) end\n"
+ "  return string.format(\"$%s*%02X\\r\\n\", body, c)\n"
+ "end\n"
+ "local t = {}\n"
+ "for i = 1, 60 do\n"
+ "  t[#t+1] = sentence(string.format(\n"
+ "    \"GPGGA,12%02d%02d,4807.%03d,N,01131.%03d,E,1,%02d,0.9,%d.4,M,46.9,M,,\",\n"
+ "    i % 60, i * 7 % 60, i, 1000 - i, 4 + i % 8, 540 + i))\n"
+ "  t[#t+1] = sentence(string.format(\n"
+ "    \"GPRMC,12%02d%02d,A,4807.%03d,N,01131.%03d,E,022.4,084.4,230394,003.1,W\",\n"
+ "    i % 60, i * 7 % 60, i, 1000 - i))\n"
+ "  t[#t+1] = sentence(\"GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45\")\n"
+ "end\n"
+ "local log = table.concat(t)\n"
+ "return function ()\n"
+ "  local n = 0\n"
+ "  for line in string.gmatch(log, \"[^\\r\\n]+\") do\n"
+ "    local body, cs = string.match(line, \"^%$([^*]+)%*(%x%x)$\")\n"
+ "    if body and tonumber(cs, 16) then\n"
+ "      local kind = string.sub(body, 1, 5)\n"
+ "      if kind == \"GPGGA\" then\n"
+ "        local tm, lat, ns, lon, ew, q, sats, hdop, alt = string.match(body,\n"
+ "          \"^GPGGA,([^,]*),([^,]*),([NS]),([^,]*),([EW]),(%d),(%d+),([^,]*),([^,]*)\")\n"
+ "        n = n + tonumber(lat) + tonumber(alt) + tonumber(sats)\n"
+ "      elseif kind == \"GPRMC\" then\n"
+ "        local f = {}\n"
+ "        for v in string.gmatch(body .. \",\", \"([^,]*),\") do f[#f+1] = v end\n"
+ "        n = n + #f + tonumber(f[8])\n"
+ "      end\n"
+ "    end\n"
+ "  end\n"
+ "  for tm in string.gmatch(log, \"%$GPRMC,(%d+)\") do n = n + tonumber(tm) % 100 end\n"
+ "  local _, c = string.gsub(log, \"%*%x%x\\r\\n\", \"\\n\")\n"
+ "  return n + c\n"
+ "end, #log\n";
+
+/* Short strings: the cost of a call */
+static const char short_lua[]=
+ "local lower, find, gsub = string.lower, string.find, string.gsub\n"
+ "return function ()\n"
+ "  local n = 0\n"
+ "  for i = 1, 2000 do\n"
+ "    n = n + #lower(\"Content-Length\")\n"
+ "    n = n + (find(\"Content-Length: 12\", \":%s*(%d+)\") or 0)\n"
+ "    n = n + select(2, gsub(\"a,b,c\", \",\", \";\"))\n"
+ "  end\n"
+ "  return n\n"
+ "end, 2000*14\n";
+
+static const struct { const char* name; const char* src; } benches[]=
+{
+ { "csv", csv_lua },
+ { "http", http_lua },
+ { "nmea", nmea_lua },
+ { "short", short_lua },
+};
+
+#define ROUNDS	5			/* of runs calls, the best counts */
+
+static int runs=200;			/* calls of each benchmark per round */
+static const char* only=NULL;		/* the one benchmark to run */
+
+static void fatal(const char* message)
+{
+ fprintf(stderr,"%s: %s\n",PROGNAME,message);
+ exit(EXIT_FAILURE);
+}
+
+static void usage(const char* message)
+{
+ if (message!=NULL) fprintf(stderr,"%s: %s\n",PROGNAME,message);
+ fprintf(stderr,
+ "usage: %s [options]\n"
+ "  -k       self check only\n"
+ "  -n runs  calls of each benchmark per round (default 200)\n"
+ "  -b name  only the benchmark name (csv, http, nmea, short)\n",
+ PROGNAME);
+ exit(EXIT_FAILURE);
+}
+
+static double now(void)
+{
+ struct timespec ts;
+ clock_gettime(CLOCK_PROCESS_CPUTIME_ID,&ts);	/* CPU time, the host is shared */
+ return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+static lua_State* newstate(void)
+{
+ lua_State* L=luaL_newstate();
+ if (L==NULL) fatal("not enough memory for state");
+ luaopen_base(L);
+ lua_settop(L,0);
+ return L;
+}
+
+static int load(lua_State* L, const char* src, const char* name, int results)
+{
+ int status=luaL_loadbuffer(L,src,strlen(src),name) || lua_pcall(L,0,results,0);
+ if (status!=0) printf("FAIL %s\n",lua_tostring(L,-1));
+ return status;
+}
+
+static int selfcheck(void)
+{
+ lua_State* L=newstate();
+ int failures=load(L,check_lua,"=check",1)!=0 ? 1 : (int)lua_tointeger(L,-1);
+ lua_close(L);
+ return failures;
+}
+
+static void bench(int i)
+{
+ lua_State* L=newstate();
+ double start, seconds, best=0, result=0;
+ size_t bytes;
+ int k, r;
+ if (load(L,benches[i].src,benches[i].name,2)!=0) exit(EXIT_FAILURE);
+ bytes=(size_t)lua_tointeger(L,-1);
+ lua_pop(L,1);
+ for (k=0; k<ROUNDS; k++)			/* the best round */
+ {
+  start=now();
+  for (r=0; r<runs; r++)
+  {
+   lua_pushvalue(L,-1);
+   if (lua_pcall(L,0,1,0)!=0) fatal(lua_tostring(L,-1));
+   result=lua_tonumber(L,-1);
+   lua_pop(L,1);
+  }
+  seconds=now()-start;
+  if (k==0 || seconds<best) best=seconds;
+ }
+ printf("  %-6s %8u %10.1f %8.2f %8d  %.8g\n",benches[i].name,(unsigned)bytes,
+  best*1e6/runs,bytes*runs/best/1e6,lua_gc(L,LUA_GCCOUNT,0),result);
+ lua_close(L);
+}
+
+int main(int argc, char* argv[])
+{
+ int i, failures, check_only=0;
+ for (i=1; i<argc; i++)
+ {
+  if (strcmp(argv[i],"-k")==0) check_only=1;
+  else if (i+1==argc) usage("bad option");
+  else if (strcmp(argv[i],"-n")==0) runs=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-b")==0) only=argv[++i];
+  else usage("bad option");
+ }
+ if (runs<=0) usage("bad run count");
+
+ printf("self check\n");
+ failures=selfcheck();
+ printf("%s\n",failures==0 ? "  ok" : "  FAILED");
+ if (check_only || failures!=0) return failures!=0;
+
+ printf("best of %d x %d calls: bytes parsed per call, us per call, MB/s, KB in use, result\n",
+  ROUNDS,runs);
+ for (i=0; i<(int)(sizeof(benches)/sizeof(benches[0])); i++)
+  if (only==NULL || strcmp(only,benches[i].name)==0) bench(i);
+ return 0;
+}
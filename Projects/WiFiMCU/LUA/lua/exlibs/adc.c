@@ -8,10 +8,16 @@
 #include "lrotable.h"
 #include "mico_platform.h"
 #include "math.h"
+#include "stdlib.h"
+#include "adc_stream.h"
 
 #define MAX_SAMPLES 128
 
+// continuous sampling, see adc_stream.h
+#define STREAM_MAX_RATE    100000   // samples per second
+
 extern const char wifimcu_gpio_map[];
+extern mico_queue_t os_queue;
 
 const char wifimcu_adc_map[] =
 {
@@ -25,6 +31,19 @@ const char wifimcu_adc_map[] =
 static float adc_ref = 3.3;
 static uint8_t adc_autocal = 0;
 
+// Blocks of adc_stream.c handed to lua through os_queue
+typedef struct {
+  volatile uint8_t active;
+  uint8_t      adc;
+  int          gen;
+  int          cb_ref;
+  lua_State*   L;
+  uint16_t*    dma;
+  adc_stream_t s;
+} adcStream_t;
+
+static adcStream_t adc_stream = {0, 0, 0, LUA_NOREF, NULL, NULL};
+
 static int platform_adcpin_exists( unsigned pin )
 {
   if(pin ==1 || pin ==13 ||  pin ==15 || pin ==16 ||  pin ==17) 
@@ -68,6 +87,7 @@ static float _adcRead(int adcpin, uint16_t len, uint8_t type, float* std)
   *std = 0.0;
 
   if (adcpin == 999) return -99999;
+  if (adc_stream.active) return -99999.0;
   // init ADC
   if (kNoErr != MicoAdcInitialize((mico_adc_t)adcpin, 3)) return -99999.0;
   // get ADC data
@@ -198,6 +218,132 @@ static int adc_setautocal( lua_State* L )
 }
 
 
+// == interrupt context, adc_stream.c posts a completed block ==
+//-------------------------------------------------
+static bool _adc_stream_post( adc_block_t* b, void* arg )
+{
+  adcStream_t* st = (adcStream_t*)arg;
+  queue_msg_t msg;
+
+  msg.L = st->L;
+  msg.source = onADC;
+  msg.para1 = st->gen;
+  msg.para2 = st->cb_ref;
+  msg.para3 = (unsigned char*)b;
+  msg.para4 = NULL;
+  return (mico_rtos_push_to_queue( &os_queue, &msg, 0) == kNoErr);
+}
+
+// == DMA half/full transfer handler, interrupt context ==
+//--------------------------------------------------------------------------
+static void _adc_stream_handler( uint16_t* samples, uint16_t count, void* arg )
+{
+  adcStream_t* st = (adcStream_t*)arg;
+
+  if (!st->active) return;
+  adc_stream_feed( &st->s, samples, count );
+}
+
+// Called from the lua thread for each queued block (see do_queue_task).
+// Pushes the callback arguments, returns their number or -1 for a stale block
+//---------------------------------------------------------
+int _adc_stream_push(lua_State* L, int gen, void* block)
+{
+  adc_block_t* b = (adc_block_t*)block;
+
+  if ((!adc_stream.active) || (gen != adc_stream.gen) || (b == NULL)) return -1;
+
+  lua_createtable(L, b->n, 0);
+  for (uint16_t i=0; i<b->n; i++) {
+    lua_pushinteger(L, b->data[i]);
+    lua_rawseti(L, -2, i+1);
+  }
+  float mean = (float)b->sum / (float)b->count;
+  lua_pushnumber(L, mean);
+  lua_pushinteger(L, b->min);
+  lua_pushinteger(L, b->max);
+  lua_pushnumber(L, sqrt((double)b->sum2 / (double)b->count));
+  lua_pushinteger(L, b->drops);
+  adc_stream_release(b);
+  return 6;
+}
+
+//-------------------------------------
+static void _adc_stream_stop(lua_State* L)
+{
+  if (!adc_stream.active) return;
+
+  MicoAdcStreamStop((mico_adc_t)adc_stream.adc);
+  adc_stream.active = 0;
+  adc_stream.gen++;   // blocks still in os_queue are discarded
+
+  free(adc_stream.dma);
+  free(adc_stream.s.blk[0]);
+  free(adc_stream.s.blk[1]);
+  adc_stream.dma = NULL;
+  adc_stream.s.blk[0] = NULL;
+  adc_stream.s.blk[1] = NULL;
+
+  if (adc_stream.cb_ref != LUA_NOREF) {
+    luaL_unref(L, LUA_REGISTRYINDEX, adc_stream.cb_ref);
+  }
+  adc_stream.cb_ref = LUA_NOREF;
+}
+
+// adc.stream(pin, rate, blocksize, decimation, function(data, mean, min, max, rms, drops) end)
+//-----------------------------------
+static int adc_stream_start( lua_State* L )
+{
+  int adcpin = _getPin(L);
+  int rate = luaL_checkinteger( L, 2);
+  int blocksize = luaL_checkinteger( L, 3);
+  int decim = luaL_checkinteger( L, 4);
+
+  if (adcpin == 999) return luaL_error( L, "wrong pin" );
+  if ((rate < 1) || (rate > STREAM_MAX_RATE)) return luaL_error( L, "wrong rate" );
+  if ((blocksize < 1) || (blocksize > ADC_STREAM_MAX_BLOCK)) return luaL_error( L, "wrong blocksize" );
+  if ((decim < 1) || (decim > ADC_STREAM_MAX_DECIM)) return luaL_error( L, "wrong decimation" );
+  if (lua_type(L, 5) != LUA_TFUNCTION && lua_type(L, 5) != LUA_TLIGHTFUNCTION)
+    return luaL_error( L, "callback function needed" );
+
+  _adc_stream_stop(L);
+
+  adc_block_t* b0 = malloc(ADC_BLOCK_SIZE(blocksize));
+  adc_block_t* b1 = malloc(ADC_BLOCK_SIZE(blocksize));
+  adc_stream.dma = malloc(ADC_STREAM_DMA_LEN * sizeof(uint16_t));
+  if ((adc_stream.dma == NULL) || (b0 == NULL) || (b1 == NULL)) {
+    free(adc_stream.dma);
+    free(b0);
+    free(b1);
+    adc_stream.dma = NULL;
+    return luaL_error( L, "memory allocation error" );
+  }
+
+  lua_pushvalue(L, 5);
+  adc_stream.cb_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+  adc_stream.L = L;
+  adc_stream.adc = (uint8_t)adcpin;
+  adc_stream_init(&adc_stream.s, b0, b1, (uint16_t)blocksize, (uint16_t)decim, _adc_stream_post, &adc_stream);
+  adc_stream.active = 1;
+
+  if (kNoErr != MicoAdcStreamStart((mico_adc_t)adcpin, rate, adc_stream.dma, ADC_STREAM_DMA_LEN,
+                                   _adc_stream_handler, &adc_stream)) {
+    _adc_stream_stop(L);
+    return luaL_error( L, "adc stream start failed" );
+  }
+  return 0;
+}
+
+// adc.stop(), returns number of dropped blocks
+//-----------------------------------
+static int adc_stream_stop( lua_State* L )
+{
+  uint32_t drops = adc_stream.s.drops;
+  _adc_stream_stop(L);
+  lua_pushinteger(L, drops);
+  return 1;
+}
+
 #define MIN_OPT_LEVEL  2
 #include "lrodefs.h"
 const LUA_REG_TYPE adc_map[] =
@@ -206,6 +352,8 @@ const LUA_REG_TYPE adc_map[] =
   { LSTRKEY( "readV" ), LFUNCVAL( adc_read_v )},
   { LSTRKEY( "setref" ), LFUNCVAL( adc_setref )},
   { LSTRKEY( "setautocal" ), LFUNCVAL( adc_setautocal )},
+  { LSTRKEY( "stream" ), LFUNCVAL( adc_stream_start )},
+  { LSTRKEY( "stop" ), LFUNCVAL( adc_stream_stop )},
 #if LUA_OPTIMIZE_MEMORY > 0
 #endif    
   {LNILKEY, LNILVAL}
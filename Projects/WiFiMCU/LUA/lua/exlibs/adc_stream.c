@@ -0,0 +1,115 @@
+/**
+ * adc_stream.c
+ */
+
+#include "adc_stream.h"
+
+//-----------------------------------------------
+static void _adc_block_reset( adc_block_t* b )
+{
+  b->n = 0;
+  b->count = 0;
+  b->sum = 0;
+  b->sum2 = 0;
+  b->min = 0xFFFF;
+  b->max = 0;
+}
+
+//------------------------------------------------------------------------------------
+void adc_stream_init( adc_stream_t* s, adc_block_t* b0, adc_block_t* b1,
+                      uint16_t blocksize, uint16_t decim, adc_stream_post_t post, void* arg )
+{
+  s->blocksize = blocksize;
+  s->decim = decim;
+  s->dec_n = 0;
+  s->dec_acc = 0;
+  s->cur = 0;
+  s->drops = 0;
+  s->blk[0] = b0;
+  s->blk[1] = b1;
+  s->post = post;
+  s->arg = arg;
+  b0->busy = 0;
+  b1->busy = 0;
+  _adc_block_reset(b0);
+  _adc_block_reset(b1);
+}
+
+// == interrupt context ==
+// The block statistics and the decimation state live in registers for the
+// whole call and are stored back once; through b they would be stored for
+// every sample, the samples are uint16_t as min and max are.
+//---------------------------------------------------------------------------
+void adc_stream_feed( adc_stream_t* s, const uint16_t* samples, uint16_t count )
+{
+  adc_block_t* b = s->blk[s->cur];
+  const uint16_t* end = samples + count;
+  uint32_t decim = s->decim, dec_n = s->dec_n, dec_acc = s->dec_acc;
+  uint32_t sum = b->sum, n = b->n;
+  uint64_t sum2 = b->sum2;
+  uint16_t min = b->min, max = b->max;
+  uint32_t first = b->count;
+  const uint16_t* start = samples;
+
+  while (samples < end) {
+    uint32_t v = *samples++;
+    if (v < min) min = v;
+    if (v > max) max = v;
+    sum += v;
+    sum2 += v * v;
+    dec_acc += v;
+    if (++dec_n < decim) continue;
+
+    b->data[n++] = (uint16_t)((dec_acc + (decim >> 1)) / decim);
+    dec_acc = 0;
+    dec_n = 0;
+    if (n < s->blocksize) continue;
+
+    // block complete, hand it over if lua has released the other one
+    b->n = n;
+    b->min = min;
+    b->max = max;
+    b->sum = sum;
+    b->sum2 = sum2;
+    b->count = first + (samples - start);
+    adc_block_t* other = s->blk[s->cur ^ 1];
+    if (other->busy) {
+      s->drops++;
+      _adc_block_reset(b);
+    }
+    else {
+      b->drops = s->drops;
+      b->busy = 1;
+      if (s->post(b, s->arg)) {
+        s->cur ^= 1;
+        b = other;
+      }
+      else {
+        b->busy = 0;
+        s->drops++;
+      }
+      _adc_block_reset(b);
+    }
+    first = 0;
+    start = samples;
+    n = 0;
+    min = b->min;
+    max = b->max;
+    sum = 0;
+    sum2 = 0;
+  }
+  b->n = n;
+  b->min = min;
+  b->max = max;
+  b->sum = sum;
+  b->sum2 = sum2;
+  b->count = first + (samples - start);
+  s->dec_n = dec_n;
+  s->dec_acc = dec_acc;
+}
+
+//------------------------------------------
+void adc_stream_release( adc_block_t* b )
+{
+  b->busy = 0;
+}
@@ -0,0 +1,59 @@
+/**
+ * adc_stream.h
+ */
+
+#ifndef __ADC_STREAM_H_
+#define __ADC_STREAM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Continuous sampling of adc.stream(): the DMA interrupt folds each half of
+// the circular buffer into a block of decimated samples (the rounded mean of
+// decim raw samples) and keeps min, max, sum and sum of squares of the raw
+// samples behind the block. Two blocks alternate; a completed block is handed
+// to the lua thread and stays busy until it is released.
+#define ADC_STREAM_DMA_LEN     256      // samples in the circular DMA buffer
+#define ADC_STREAM_MAX_BLOCK   512      // decimated samples per block
+#define ADC_STREAM_MAX_DECIM   1024     // sum of a block fits 32 bits at 12 bits a sample
+
+typedef struct {
+  volatile uint8_t busy;        // with the lua thread
+  uint16_t n;                   // decimated samples in data
+  uint16_t min;
+  uint16_t max;
+  uint32_t count;               // raw samples
+  uint32_t sum;
+  uint64_t sum2;
+  uint32_t drops;               // blocks lost before this one
+  uint16_t data[];
+} adc_block_t;
+
+// Hands a completed block over, false if it could not be (a full queue)
+typedef bool (*adc_stream_post_t)( adc_block_t* b, void* arg );
+
+typedef struct {
+  uint16_t          blocksize;
+  uint16_t          decim;
+  uint16_t          dec_n;      // raw samples in dec_acc
+  uint32_t          dec_acc;
+  uint8_t           cur;        // block being filled
+  uint32_t          drops;      // blocks lost so far
+  adc_block_t*      blk[2];
+  adc_stream_post_t post;
+  void*             arg;
+} adc_stream_t;
+
+// bytes of a block of blocksize samples
+#define ADC_BLOCK_SIZE(blocksize)  (sizeof(adc_block_t) + (blocksize) * sizeof(uint16_t))
+
+void adc_stream_init( adc_stream_t* s, adc_block_t* b0, adc_block_t* b1,
+                      uint16_t blocksize, uint16_t decim, adc_stream_post_t post, void* arg );
+
+// Interrupt side: count raw samples, posts each block they complete
+void adc_stream_feed( adc_stream_t* s, const uint16_t* samples, uint16_t count );
+
+// Reader side, once the block is read
+void adc_stream_release( adc_block_t* b );
+
+#endif
@@ -0,0 +1,294 @@
+/**
+ * bitbang.c
+ */
+
+#include "bitbang.h"
+
+//-------------------------------------------------------------
+void bb_pin( bb_pin_t* p, bb_port_t* port, uint8_t pin_number )
+{
+  BB_CYCLES_ENABLE();
+  p->port = port;
+  p->mask = (uint32_t)1 << pin_number;
+  p->set = p->mask;
+  p->reset = p->mask << 16;
+}
+
+//-----------------------------------------
+uint32_t bb_wait( uint32_t t0, uint32_t n )
+{
+  uint32_t now;
+
+  do {
+    now = BB_CYCLES();
+  } while ((uint32_t)(now - t0) < n);
+  return now;
+}
+
+//---------------------------------------------------------------
+uint32_t bb_pulse( bb_pin_t* p, uint8_t level, uint32_t timeout )
+{
+  uint32_t irq, t0, t1, now;
+
+  level = (level != 0);
+  BB_IRQ_SAVE( irq );
+  t0 = BB_CYCLES();
+  while (bb_get( p ) != level) {
+    if ((uint32_t)(BB_CYCLES() - t0) > timeout) goto fail;
+  }
+  t1 = BB_CYCLES();
+  while (bb_get( p ) == level) {
+    now = BB_CYCLES();
+    if ((uint32_t)(now - t1) > timeout) goto fail;
+  }
+  now = BB_CYCLES();
+  BB_IRQ_RESTORE( irq );
+  return (now == t1) ? 1 : now - t1;
+
+fail:
+  BB_IRQ_RESTORE( irq );
+  return 0;
+}
+
+//=========
+// I2C
+//=========
+
+// Releases SCL and waits for it to go high, a slave may stretch the clock.
+// The high time counts from when it is seen high.
+//----------------------------------------
+static uint32_t _i2c_scl_up( bb_i2c_t* b )
+{
+  uint32_t t0;
+
+  bb_high( &b->scl );
+  t0 = BB_CYCLES();
+  while (!bb_get( &b->scl )) {
+    if ((uint32_t)(BB_CYCLES() - t0) > b->stretch) {
+      b->stuck = 1;
+      break;
+    }
+  }
+  return BB_CYCLES();
+}
+
+// SDA may change while SCL is low, its setup time counts from the change
+//---------------------------------------------------
+static void _i2c_sda( bb_i2c_t* b, uint8_t level )
+{
+  if (level) bb_high( &b->sda );
+  else bb_low( &b->sda );
+  b->changed = BB_CYCLES();
+}
+
+//---------------------------------------------------
+static void _i2c_scl_down( bb_i2c_t* b, uint32_t t )
+{
+  bb_wait( t, b->high );
+  bb_low( &b->scl );
+  b->fell = BB_CYCLES();
+}
+
+// One clock with SDA already set, the level of SDA at the end of the high
+//--------------------------------------
+static uint8_t _i2c_clock( bb_i2c_t* b )
+{
+  uint32_t t;
+  uint8_t bit;
+
+  bb_wait( b->fell, b->low );
+  bb_wait( b->changed, b->setup );
+  t = _i2c_scl_up( b );
+  bb_wait( t, b->high );
+  bit = bb_get( &b->sda );
+  bb_low( &b->scl );
+  b->fell = BB_CYCLES();
+  return bit;
+}
+
+//------------------------------------------------------------------------
+void bb_i2c_init( bb_i2c_t* b, const bb_pin_t* sda, const bb_pin_t* scl,
+                  uint32_t hz, uint32_t cycles_per_us )
+{
+  // the period split 56/44: tLOW 4.7 us and tHIGH 4.0 us at 100 kHz,
+  // 1.3 us and 0.6 us at 400 kHz, with room for the rise time
+  uint32_t period = cycles_per_us * 1000000 / hz;
+
+  b->sda = *sda;
+  b->scl = *scl;
+  b->low = period * 56 / 100;
+  b->high = period - b->low;
+  b->setup = b->low / 4;
+  b->stretch = BB_I2C_STRETCH_US * cycles_per_us;
+  b->started = 0;
+  b->stuck = 0;
+  bb_high( &b->sda );
+  bb_high( &b->scl );
+  b->fell = BB_CYCLES();
+  b->changed = b->fell;
+}
+
+//---------------------------------
+void bb_i2c_start( bb_i2c_t* b )
+{
+  uint32_t t;
+
+  if (b->started) {
+    // repeated start: SDA up while SCL is low, then SCL up
+    _i2c_sda( b, 1 );
+    bb_wait( b->fell, b->low );
+    bb_wait( b->changed, b->setup );
+    t = _i2c_scl_up( b );
+    bb_wait( t, b->low );
+  }
+  b->stuck = 0;
+  bb_low( &b->sda );
+  _i2c_scl_down( b, BB_CYCLES() );
+  b->started = 1;
+}
+
+//--------------------------------
+void bb_i2c_stop( bb_i2c_t* b )
+{
+  uint32_t t;
+
+  _i2c_sda( b, 0 );
+  bb_wait( b->fell, b->low );
+  bb_wait( b->changed, b->setup );
+  t = _i2c_scl_up( b );
+  bb_wait( t, b->high );
+  bb_high( &b->sda );
+  // bus free time before the next start
+  bb_wait( BB_CYCLES(), b->low );
+  b->started = 0;
+}
+
+//---------------------------------------------
+int bb_i2c_write( bb_i2c_t* b, uint8_t byte )
+{
+  uint8_t i, ack;
+
+  // 8 bits, MSB first
+  for (i = 0; i < 8; i++) {
+    _i2c_sda( b, byte & 0x80 );
+    byte <<= 1;
+    _i2c_clock( b );
+  }
+  // the slave pulls SDA low to ack
+  _i2c_sda( b, 1 );
+  ack = _i2c_clock( b );
+  if (b->stuck) return -2;
+  return (ack == 0) ? 0 : -1;
+}
+
+//--------------------------------------------
+uint8_t bb_i2c_read( bb_i2c_t* b, bool ack )
+{
+  uint8_t i, byte = 0;
+
+  // the slave drives SDA
+  _i2c_sda( b, 1 );
+  for (i = 0; i < 8; i++) {
+    byte <<= 1;
+    byte |= _i2c_clock( b );
+  }
+  // ack for more, nack for the last one
+  _i2c_sda( b, !ack );
+  _i2c_clock( b );
+  _i2c_sda( b, 1 );
+  return byte;
+}
+
+//=========
+// 1-Wire
+//=========
+// Slot times of Maxim AN126, standard speed, in us
+#define OW_SLOT         70    // a time slot with its recovery
+#define OW_LOW_1        3     // low of a 1 and of a read
+#define OW_LOW_0        62    // low of a 0
+#define OW_SAMPLE       12    // a read samples before 15 us
+#define OW_RESET        480   // reset low, then the presence window
+#define OW_PRESENCE     70    // presence sample after the reset
+
+//-----------------------------------------------------------------------------
+void bb_ow_init( bb_ow_t* w, const bb_pin_t* pin, uint32_t cycles_per_us )
+{
+  w->pin = *pin;
+  w->us = cycles_per_us;
+  bb_high( &w->pin );
+}
+
+//----------------------------------
+uint8_t bb_ow_reset( bb_ow_t* w )
+{
+  uint32_t irq, t;
+  uint8_t bit;
+
+  // the low only has a minimum, an interrupt may stretch it
+  bb_low( &w->pin );
+  bb_wait( BB_CYCLES(), OW_RESET * w->us );
+  BB_IRQ_SAVE( irq );
+  bb_high( &w->pin );
+  t = BB_CYCLES();
+  bb_wait( t, OW_PRESENCE * w->us );
+  bit = bb_get( &w->pin );
+  BB_IRQ_RESTORE( irq );
+  bb_wait( t, OW_RESET * w->us );
+  return bit;
+}
+
+//------------------------------------------------
+void bb_ow_write_bit( bb_ow_t* w, uint8_t bit )
+{
+  uint32_t irq, t;
+
+  BB_IRQ_SAVE( irq );
+  bb_low( &w->pin );
+  t = BB_CYCLES();
+  bb_wait( t, (bit ? OW_LOW_1 : OW_LOW_0) * w->us );
+  bb_high( &w->pin );
+  BB_IRQ_RESTORE( irq );
+  bb_wait( t, OW_SLOT * w->us );
+}
+
+//------------------------------------
+uint8_t bb_ow_read_bit( bb_ow_t* w )
+{
+  uint32_t irq, t;
+  uint8_t bit;
+
+  BB_IRQ_SAVE( irq );
+  bb_low( &w->pin );
+  t = BB_CYCLES();
+  bb_wait( t, OW_LOW_1 * w->us );
+  bb_high( &w->pin );
+  bb_wait( t, OW_SAMPLE * w->us );
+  bit = bb_get( &w->pin );
+  BB_IRQ_RESTORE( irq );
+  bb_wait( t, OW_SLOT * w->us );
+  return bit;
+}
+
+//---------------------------------------------------
+void bb_ow_write_byte( bb_ow_t* w, uint8_t byte )
+{
+  uint8_t i;
+
+  // LSB first
+  for (i = 0; i < 8; i++) {
+    bb_ow_write_bit( w, byte & 0x01 );
+    byte >>= 1;
+  }
+}
+
+//-------------------------------------
+uint8_t bb_ow_read_byte( bb_ow_t* w )
+{
+  uint8_t i, byte = 0;
+
+  for (i = 0; i < 8; i++) {
+    byte >>= 1;
+    if (bb_ow_read_bit( w )) byte |= 0x80;
+  }
+  return byte;
+}
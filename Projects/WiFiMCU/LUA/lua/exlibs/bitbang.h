@@ -0,0 +1,97 @@
+/**
+ * bitbang.h
+ */
+
+#ifndef __BITBANG_H_
+#define __BITBANG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bit banged buses on GPIO registers. A pin is resolved once to its port
+// and BSRR masks, an edge is then a single store and a sample a single load.
+// Times are cycles of the never reset DWT->CYCCNT, measured from the edge
+// they belong to, so the cost of the code between does not add up.
+// The pins are open drain: set releases the line, reset pulls it low.
+#ifdef BITBANG_HOST
+#include "bitbang_host.h"     // the mock of the host simulator
+#else
+#include "mico_platform.h"
+
+typedef GPIO_TypeDef bb_port_t;
+
+#define BB_CYCLES_ENABLE() \
+  do { \
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; \
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk; \
+  } while (0)
+#define BB_CYCLES()             (DWT->CYCCNT)
+#define BB_WRITE(port, bsrr)    (*(volatile uint32_t*)&(port)->BSRRL = (bsrr))
+#define BB_READ(port, mask)     (((port)->IDR & (mask)) != 0)
+#define BB_IRQ_SAVE(s)          do { (s) = __get_PRIMASK(); __disable_irq(); } while (0)
+#define BB_IRQ_RESTORE(s)       __set_PRIMASK(s)
+#endif
+
+typedef struct {
+  bb_port_t* port;
+  uint32_t   set;               // BSRR value to release the line
+  uint32_t   reset;             // BSRR value to pull it low
+  uint32_t   mask;              // IDR bit
+} bb_pin_t;
+
+#define bb_high(p)          BB_WRITE( (p)->port, (p)->set )
+#define bb_low(p)           BB_WRITE( (p)->port, (p)->reset )
+#define bb_get(p)           BB_READ( (p)->port, (p)->mask )
+
+// Also starts the cycle counter
+void bb_pin( bb_pin_t* p, bb_port_t* port, uint8_t pin_number );
+
+// Busy waits until n cycles after t0, returns the time it ended at
+uint32_t bb_wait( uint32_t t0, uint32_t n );
+
+// The next pulse at level: waits up to timeout cycles for it to start and
+// up to timeout for it to end, with interrupts off. Its cycles, 0 on timeout.
+uint32_t bb_pulse( bb_pin_t* p, uint8_t level, uint32_t timeout );
+
+// == I2C master ==
+#define BB_I2C_STRETCH_US   1000      // a slave may hold SCL low that long
+
+typedef struct {
+  bb_pin_t sda, scl;
+  uint32_t low;                 // SCL low tLOW, also tSU;STA and tBUF
+  uint32_t high;                // SCL high tHIGH, also tHD;STA and tSU;STO
+  uint32_t setup;               // SDA change to SCL rise, tSU;DAT
+  uint32_t stretch;             // clock stretching limit
+  uint32_t fell;                // when SCL was last pulled low
+  uint32_t changed;             // when SDA was last set
+  uint8_t  started;             // the next start is a repeated start
+  uint8_t  stuck;               // a slave held SCL too long
+} bb_i2c_t;
+
+// hz 100000 standard mode, 400000 fast mode, cycles_per_us the core clock
+void    bb_i2c_init( bb_i2c_t* b, const bb_pin_t* sda, const bb_pin_t* scl,
+                     uint32_t hz, uint32_t cycles_per_us );
+void    bb_i2c_start( bb_i2c_t* b );
+void    bb_i2c_stop( bb_i2c_t* b );
+// 0 acked, -1 not acked, -2 SCL held low by a slave
+int     bb_i2c_write( bb_i2c_t* b, uint8_t byte );
+uint8_t bb_i2c_read( bb_i2c_t* b, bool ack );
+
+// == 1-Wire master, standard speed ==
+// Each slot runs with interrupts off up to the point that decides it (the
+// end of a short low, the sample of a read, a 60 us low), an interrupt
+// that comes meanwhile is taken in the recovery time.
+typedef struct {
+  bb_pin_t pin;
+  uint32_t us;                  // cycles per microsecond
+} bb_ow_t;
+
+void    bb_ow_init( bb_ow_t* w, const bb_pin_t* pin, uint32_t cycles_per_us );
+// 0 a device answered with a presence pulse, 1 none
+uint8_t bb_ow_reset( bb_ow_t* w );
+void    bb_ow_write_bit( bb_ow_t* w, uint8_t bit );
+uint8_t bb_ow_read_bit( bb_ow_t* w );
+void    bb_ow_write_byte( bb_ow_t* w, uint8_t byte );
+uint8_t bb_ow_read_byte( bb_ow_t* w );
+
+#endif
@@ -44,6 +44,7 @@ static u8_t spiffs_fds[32*4];
 static u8_t spiffs_cache_buf[(LOG_PAGE_SIZE+32)*4];
 
 spiffs fs;
+mico_mutex_t spiffs_mut = NULL;  // SPIFFS_LOCK, see spiffs_config.h
 static volatile spiffs_file file_fd[MAX_FILE_FD] = { FILE_NOT_OPENED };
 
 char curr_dir[SPIFFS_OBJ_NAME_LEN] = { 0 };
@@ -334,6 +335,7 @@ void _mount(void)
   mico_logic_partition_t* part;
   spiffs_config cfg;    
 
+  if (spiffs_mut == NULL) mico_rtos_init_mutex(&spiffs_mut);
   part = MicoFlashGetInfo( MICO_PARTITION_LUA );
      
   cfg.phys_size = part->partition_length;
@@ -14,10 +14,11 @@
 #include "mico_system.h"
 #include "SocketUtils.h"
 #include "mico_rtos.h"
+#include <ctype.h>
 #include <spiffs.h>
+#include <spiffs_nucleus.h>
 
 #define INVALID_HANDLE -1
-#define MAX_CLT_SOCKET 2
 #define FILE_NOT_OPENED 0
 
 extern mico_queue_t os_queue;
@@ -27,9 +28,9 @@ extern uint8_t checkFileName(int len, const char* name, char* newname, uint8_t a
 extern uint8_t fileExists(char* name);
 
 static mico_mutex_t  ftp_mut = NULL; // Used to synchronize the ftp thread
-
-#define FILE_NOT_OPENED 0
-static volatile spiffs_file file_fd = FILE_NOT_OPENED;
+static mico_semaphore_t ftp_data_sem = NULL; // Given when a transfer ends
+static mico_semaphore_t ftp_wakeup_sem = NULL; // Given with each request to the ftp thread
+static int ftp_wakeup_fd = -1;
 
 static bool log = false;
 #define ftp_log(M, ...) if (log == true) printf(M, ##__VA_ARGS__)
@@ -61,6 +62,8 @@ enum _req_actions{
 #define FTP_RECEIVING     16
 #define FTP_SENDING       32
 
+#define FTP_TRANSFER      (FTP_LISTING | FTP_RECEIVING | FTP_SENDING)
+
 // send type
 #define SEND_OVERWRITTE  0
 #define SEND_APPEND      1
@@ -70,422 +73,464 @@ enum _req_actions{
 #define RECV_TOFILE      0
 #define RECV_TOSTRING    1
 
-#define MIN_RECVDATABUF_LEN 1024
+// Data buffer, ftp.new() buflen: file transfers stream through it,
+// strings and lists are received into it
+#define MIN_DATABUF_LEN  1024
+#define MAX_DATABUF_LEN  16384
+#define DEF_DATABUF_LEN  4096
+
+#define MAX_FTP_TIMEOUT 60000 * 5
+#define MAX_DATA_TIMEOUT 10000    // no data moved that long ends a transfer
+#define MAX_RECV_LEN 256
+#define MAX_CMD_LEN  140          // command with a 128 char argument
 
-//ftp Cmd socket
+// One ftp session: the command and data connections, the transfer in
+// progress and its data buffer. The ftp thread owns it from ftp.start()
+// and frees it when it ends.
 typedef struct {
-  int socket;             // TCP socket
-  struct sockaddr_t addr; //ip and port for tcp or udp use
+  int cmd_socket;               // TCP socket
+  struct sockaddr_t cmd_addr;   // ip and port of the server
+  int data_socket;              // INVALID_HANDLE when closed
+  struct sockaddr_t data_addr;  // from the PASV reply
   int logon_cb;
   int disconnect_cb;
   int sent_cb;
   int received_cb;
   int list_cb;
-  uint8_t clientFlag;     // action
-  uint8_t clientLastFlag; // last action
-} ftpCmdSocket_t;
-
-//ftp Data socket
-typedef struct {
-  int socket;             // TCP socket
-  struct sockaddr_t addr; //ip and port for tcp or udp use
-} ftpDataSocket_t;
-
-#define MAX_FTP_TIMEOUT 60000 * 5
-#define MAX_RECV_LEN 256
-
-// for FTP we need 2 sockets
-static ftpCmdSocket_t *ftpCmdSocket;
-static ftpDataSocket_t *ftpDataSocket;
+  uint8_t clientFlag;           // action
+  uint8_t clientLastFlag;       // last action
+  uint8_t status;
+  uint8_t cmd_done;
+  uint8_t data_done;
+  uint8_t list_type;
+  uint8_t send_type;
+  uint8_t recv_type;
+  uint8_t file_eof;             // sending: the whole file is read
+  uint8_t reply_due;            // the final reply of a transfer is to come
+  char *host;
+  char *user;
+  char *pass;
+  char *file;
+  char *response;
+  char cmd_buf[MAX_RECV_LEN+4]; // command replies, a line at a time
+  uint16_t cmd_len;
+  char *dbuf;                   // allocated on the first transfer
+  uint32_t dbuf_size;
+  uint32_t dlen;                // bytes in dbuf
+  uint32_t doff;                // sending: bytes of dbuf already sent
+  uint32_t chunk;               // receiving to file: whole spiffs data pages
+  const char *send_str;         // ftp.sendstring(), kept on the Lua stack
+  spiffs_file fd;
+  int file_status;              // bytes transferred, < 0 error
+  int file_size;
+  int max_fsize;
+  uint32_t data_time;           // when data last moved
+} ftp_session_t;
+
+static ftp_session_t *ftp = NULL;
 
 static lua_State *gL = NULL;
-static char *pDomain4Dns = NULL;
-static char *ftpuser = NULL;
-static char *ftppass = NULL;
-static char *ftpfile = NULL;
-static char *ftpresponse = NULL;
-static char *recvBuf = NULL;
-static char *recvDataBuf = NULL;
-static char *sendDataBuf = NULL;
-
 static bool ftp_thread_is_started = false;
-static uint8_t data_done = 1;
-static uint8_t cmd_done = 1;
-static uint8_t status = FTP_NOT_CONNECTED;
-static uint16_t recvLen = 0;
-static uint16_t recvDataLen = 0;
-static int sendDataLen = 0;
-static uint16_t max_recv_datalen = MIN_RECVDATABUF_LEN*2;
-static uint16_t recvDataBufLen = MIN_RECVDATABUF_LEN;
-static int file_status = 0;
-static int file_size = 0;
-static uint8_t list_type = 0;
-static uint8_t send_type = 0;
-static uint8_t recv_type = 0;
-static uint8_t data_ready = 0;
-static uint8_t data_get = 0;
 
 
 //-------------------------------------------------------
 static void _micoNotify_FTPClientConnectedHandler(int fd)
 {
-  if (ftpCmdSocket != NULL) {
-    if (ftpCmdSocket->socket == fd) {
-      // ** command socket connected
-      status |= FTP_CONNECTED;
-      ftp_log("[FTP cmd] Socket connected\r\n");
-      return;
-    }
+  if (ftp == NULL) return;
+
+  if (ftp->cmd_socket == fd) {
+    // ** command socket connected
+    ftp->status |= FTP_CONNECTED;
+    ftp_log("[FTP cmd] Socket connected\r\n");
   }
-  if (ftpDataSocket != NULL) {
-    if (ftpDataSocket->socket == fd) {
-      // ** data socket connected
-      status |= FTP_DATACONNECTED;
-      ftp_log("[FTP dta] Socket connected\r\n");
-      return;
-    }
+  else if (ftp->data_socket == fd) {
+    // ** data socket connected
+    ftp->status |= FTP_DATACONNECTED;
+    ftp_log("[FTP dta] Socket connected\r\n");
   }
 }
 
-//---------------------------------------
-static void closeCmdSocket( void )
+//------------------------------------------
+static void closeFile( ftp_session_t *s )
 {
-  if (ftpCmdSocket == NULL) return;
-
-  //unref cb functions
-  if (gL != NULL) {
-    /*if (ftpCmdSocket->disconnect_cb != LUA_NOREF)
-      luaL_unref(gL, LUA_REGISTRYINDEX, ftpCmdSocket->disconnect_cb);
-    ftpCmdSocket->disconnect_cb = LUA_NOREF;*/
-    
-    if (ftpCmdSocket->logon_cb != LUA_NOREF)
-      luaL_unref(gL, LUA_REGISTRYINDEX, ftpCmdSocket->logon_cb);
-    ftpCmdSocket->logon_cb = LUA_NOREF;
-    
-    if (ftpCmdSocket->list_cb != LUA_NOREF)
-      luaL_unref(gL, LUA_REGISTRYINDEX, ftpCmdSocket->list_cb);
-    ftpCmdSocket->list_cb = LUA_NOREF;
-    
-    if (ftpCmdSocket->received_cb != LUA_NOREF)
-      luaL_unref(gL, LUA_REGISTRYINDEX, ftpCmdSocket->received_cb);
-    ftpCmdSocket->received_cb = LUA_NOREF;
-    
-    if (ftpCmdSocket->sent_cb != LUA_NOREF)
-      luaL_unref(gL, LUA_REGISTRYINDEX, ftpCmdSocket->sent_cb);
-    ftpCmdSocket->sent_cb = LUA_NOREF;
-  }
-  
-  ftpCmdSocket->clientFlag = NO_ACTION;
+  if (s->fd != FILE_NOT_OPENED) {
+    SPIFFS_close(&fs, s->fd);
+    s->fd = FILE_NOT_OPENED;
+    ftp_log("\r\n[FTP dta] Data file closed\r\n");
+  }
+}
+
+//----------------------------------
+static void _unref( int *ref )
+{
+  if ((gL != NULL) && (*ref != LUA_NOREF))
+    luaL_unref(gL, LUA_REGISTRYINDEX, *ref);
+  *ref = LUA_NOREF;
+}
+
+//-----------------------------------------------
+static void closeCmdSocket( ftp_session_t *s )
+{
+  if (s->cmd_socket == INVALID_HANDLE) return;
+
+  // unref cb functions, disconnect_cb goes with its message
+  _unref(&s->logon_cb);
+  _unref(&s->list_cb);
+  _unref(&s->received_cb);
+  _unref(&s->sent_cb);
+
+  s->clientFlag = NO_ACTION;
 
   //close client socket
-  close(ftpCmdSocket->socket);
-  
-  //free memory
-  free(ftpCmdSocket);
-  ftpCmdSocket = NULL;
-  
-  status = FTP_NOT_CONNECTED;
-  
+  close(s->cmd_socket);
+  s->cmd_socket = INVALID_HANDLE;
+
+  s->status = FTP_NOT_CONNECTED;
+
   ftp_log("[FTP cmd] Socket closed\r\n");
 }
 
-//-------------------------------
-static void closeDataSocket(void)
+//------------------------------------------------
+static void closeDataSocket( ftp_session_t *s )
 {
-  if (ftpDataSocket == NULL) return;
+  if (s->data_socket == INVALID_HANDLE) return;
 
   //close client socket
-  close(ftpDataSocket->socket);
-  
-  //free memory
-  free(ftpDataSocket);
-  ftpDataSocket = NULL;
-  
-  status &= ~(FTP_DATACONNECTED | FTP_RECEIVING | FTP_LISTING | FTP_SENDING);
-  
+  close(s->data_socket);
+  s->data_socket = INVALID_HANDLE;
+
+  s->status &= ~(FTP_DATACONNECTED | FTP_TRANSFER);
+
   ftp_log("[FTP dta] Socket closed\r\n");
 }
 
-//--------------------------------
-static int _openDataSocket( void )
+// The data buffer is kept for the whole session
+//----------------------------------------------
+static int _allocDataBuf( ftp_session_t *s )
 {
-  closeDataSocket();
-  
-  ftpDataSocket = (ftpDataSocket_t*)malloc(sizeof(ftpDataSocket_t));
-  if (ftpDataSocket == NULL) {
-    ftp_log("[FTP dta] Memory allocation failed\r\n" );
-    return -1;
+  if (s->dbuf == NULL) {
+    s->dbuf = malloc(s->dbuf_size+4);
+    if (s->dbuf == NULL) {
+      ftp_log("[FTP dta] Memory allocation failed\r\n" );
+      return -1;
+    }
+    // writes to spiffs go in whole data pages
+    s->chunk = (s->dbuf_size / SPIFFS_DATA_PAGE_SIZE(&fs)) * SPIFFS_DATA_PAGE_SIZE(&fs);
   }
+  s->dlen = 0;
+  s->doff = 0;
+  s->dbuf[0] = '\0';
+  return 0;
+}
+
+//----------------------------------------------
+static int _openDataSocket( ftp_session_t *s )
+{
+  closeDataSocket(s);
+
+  if (_allocDataBuf(s) < 0) return -3;
 
   int skt = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
   if (skt < 0) {
     ftp_log("[FTP dta] Open data socket failed\r\n" );
-    free(ftpDataSocket);
-    ftpDataSocket = NULL;
     return -2;
   }
-  ftpDataSocket->socket = skt;
-  ftpDataSocket->addr.s_port = 0;
-  ftpDataSocket->addr.s_ip = 0;
-
-  if (recvDataBuf == NULL) {
-    // create recv data buffer
-    recvDataBuf = malloc(MIN_RECVDATABUF_LEN+4);
-    recvDataBufLen = MIN_RECVDATABUF_LEN;
-    if (recvDataBuf == NULL) {
-      free(ftpDataSocket);
-      ftpDataSocket = NULL;
-      return -3;
-    }
-    memset(recvDataBuf, 0, MIN_RECVDATABUF_LEN+4);
-  }
-  recvDataLen = 0;
-  status &= ~FTP_DATACONNECTED;
+  s->data_socket = skt;
+  s->data_addr.s_port = 0;
+  s->data_addr.s_ip = 0;
+
+  s->status &= ~FTP_DATACONNECTED;
   return 0;
 }
 
-//-----------------------------
-static void _ftp_deinit( void )
+//--------------------------------------
+static void _ftp_free( ftp_session_t *s )
 {
   ftp_log("[FTP ini] Deinit start\r\n" );
-  closeDataSocket();
-  free(ftpDataSocket);
-  ftpDataSocket = NULL;
-  
-  closeCmdSocket();
-  free(ftpCmdSocket);
-  ftpCmdSocket = NULL;
-  
-  free(pDomain4Dns);
-  pDomain4Dns=NULL;
-  free(ftpuser);
-  ftpuser=NULL;
-  free(ftppass);
-  ftppass=NULL;
-  free(ftpfile);
-  ftpfile=NULL;
-  free(recvBuf);
-  recvBuf=NULL;
-  free(recvDataBuf);
-  recvDataBuf=NULL;
-  free(sendDataBuf);
-  sendDataBuf=NULL;
-  free(ftpresponse);
-  ftpresponse = NULL;
-
-  data_done = 1;
-  cmd_done = 1;
-  recvLen = 0;
-  recvDataLen = 0;
-  max_recv_datalen = MIN_RECVDATABUF_LEN*2;
-  file_status = 0;
-  file_size = 0;
-  list_type = 0;
-  send_type = 0;
-  recv_type = 0;
-
-  gL = NULL;
-  status = FTP_NOT_CONNECTED;
+  closeFile(s);
+  closeDataSocket(s);
+  closeCmdSocket(s);
+  _unref(&s->disconnect_cb);
+
+  free(s->host);
+  free(s->user);
+  free(s->pass);
+  free(s->file);
+  free(s->response);
+  free(s->dbuf);
+  if (ftp == s) ftp = NULL;
+  free(s);
   ftp_log("[FTP ini] Deinit end\r\n" );
 }
 
-//-----------------------------------------
-static int _send(const char *data, int len)
+// Ends the transfer for _waitData
+//--------------------------------------
+static void _dataDone( ftp_session_t *s )
 {
-  if (ftpCmdSocket == NULL) return 0;
-  
-  int s = 0;
-  s = send(ftpCmdSocket->socket ,data, len, 0);
-  if (s == len ) return 1;
-  else return 0;
+  s->data_done = 1;
+  mico_rtos_set_semaphore(&ftp_data_sem);
+}
+
+// Wakes the ftp thread's select for a new request
+//--------------------------------------
+static void _ftp_wakeup( void )
+{
+  if (ftp_wakeup_sem != NULL) mico_rtos_set_semaphore(&ftp_wakeup_sem);
 }
 
-//---------------------------------------------
-static int _sendData(const char *data, int len)
+//------------------------------------------------------------
+static int _send( ftp_session_t *s, const char *data, int len )
 {
-  if (ftpDataSocket == NULL) return 0;
-  
-  int s = 0;
-  s = send(ftpDataSocket->socket ,data, len, 0);
-  if (s == len ) return 1;
+  if (s->cmd_socket == INVALID_HANDLE) return 0;
+
+  int n = send(s->cmd_socket, data, len, 0);
+  if (n == len) return 1;
   else return 0;
 }
 
-//-----------------------
-uint8_t _sendString(void)
+// Sends a command with an optional argument
+//--------------------------------------------------------------------
+static int _sendCmd( ftp_session_t *s, const char *cmd, const char *arg )
 {
-  if (sendDataBuf == NULL) {
-    ftp_log("\r[FTP dta] Buffer error\r\n");
-    file_status = -2;
-    return 1;
-  }
-  if (file_status >= file_size) return 1;
+  char tmps[MAX_CMD_LEN];
+  int len;
 
-  int len = 1020;
-  if ((file_size - file_status) < len) len = file_size - file_status;
-  
-  if (!_sendData(sendDataBuf+file_status, len)) {
-    ftp_log("\r[FTP dta] Error sending data\r\n");
-    file_status = -3;
-    return 1;
+  if (arg != NULL) len = snprintf(tmps, sizeof(tmps), "%s %s\r\n", cmd, arg);
+  else len = snprintf(tmps, sizeof(tmps), "%s\r\n", cmd);
+  if ((len <= 0) || (len >= (int)sizeof(tmps))) return 0;
+  return _send(s, tmps, len);
+}
+
+// Ends the data transfer in progress: the rest of the buffer goes to the
+// file, the Lua side is told. err < 0 marks it failed.
+//-----------------------------------------------
+static void _endData( ftp_session_t *s, int err )
+{
+  if ((s->status & FTP_RECEIVING) && (s->recv_type == RECV_TOFILE)) {
+    if ((err == 0) && (s->dlen > 0) && (s->fd != FILE_NOT_OPENED)) {
+      int writen = SPIFFS_write(&fs, s->fd, s->dbuf, s->dlen);
+      if (writen != (int)s->dlen) {
+        ftp_log("\r\n[FTP dta] Write to file failed (%d)\r\n", writen);
+        err = -3;
+      }
+      else s->file_status += s->dlen;
+    }
+    s->dlen = 0;
+    closeFile(s);
   }
-  else {
-    file_status += len;
-    ftp_log("\r[FTP dta] %.*f %%\r\n", 1, (float)(((float)file_status/(float)file_size)*100.0));
-    if (file_status >= file_size) return 1;
-    else return 0;
+  else if (s->status & (FTP_RECEIVING | FTP_LISTING)) {
+    if (s->recv_type == RECV_TOSTRING) s->file_status = s->dlen;
+    s->dbuf[s->dlen] = '\0';
+    ftp_log("[FTP dta] Data received (%d)\r\n", s->dlen);
+  }
+  else if (s->status & FTP_SENDING) {
+    closeFile(s);
   }
+  if (err < 0) s->file_status = err;
+
+  if (s->status & FTP_LISTING) s->clientFlag = REQ_ACTION_LIST_RECEIVED;
+  else if (s->status & FTP_RECEIVING) s->clientFlag = REQ_ACTION_RECEIVED;
+  else if (s->status & FTP_SENDING) s->clientFlag = REQ_ACTION_SENT;
+
+  closeDataSocket(s);
+  _dataDone(s);
 }
 
-// Leave only the last line in buffer
-//---------------------------------
-static void _checkCmdResponse(void)
+// Sends from the data buffer, the file is read ahead into it once half
+// of it is sent. A string is sent from where it is.
+// 0: more to send, 1: done, < 0 error
+//---------------------------------------
+static int _sendData( ftp_session_t *s )
 {
-  uint8_t n;
-  char* firstLin;
-  uint16_t i;
-  
-  do {
-    n = 0;
-    firstLin = NULL;
-    for (i=0; i<recvLen; i++) {
-      if (*(recvBuf+i) == '\n') {
-        n++;
-        if (n == 1) firstLin = recvBuf+i+1;
-        if (n > 1) break;
-      }
+  int n;
+
+  if ((s->send_type & SEND_STRING)) {
+    if (s->send_str == NULL) {
+      ftp_log("\r[FTP dta] Buffer error\r\n");
+      return -2;
     }
-    if (n > 1) {
-      recvLen = (recvBuf+recvLen)-firstLin;
-      memmove(recvBuf, firstLin, recvLen);
-      *(recvBuf+recvLen) = '\0';
+    if (s->file_status >= s->file_size) return 1;
+    n = s->file_size - s->file_status;
+    if (n > (int)s->dbuf_size) n = s->dbuf_size;
+    n = send(s->data_socket, s->send_str + s->file_status, n, 0);
+    if (n <= 0) {
+      ftp_log("\r[FTP dta] Error sending data\r\n");
+      return -3;
     }
-  } while (n > 1);
+    s->file_status += n;
+    ftp_log("\r[FTP dta] %.*f %%", 1, (float)(((float)s->file_status/(float)s->file_size)*100.0));
+    return (s->file_status >= s->file_size) ? 1 : 0;
+  }
+
+  if ((!s->file_eof) && ((s->dlen - s->doff) <= (s->dbuf_size / 2))) {
+    // read ahead
+    if (s->doff > 0) {
+      memmove(s->dbuf, s->dbuf + s->doff, s->dlen - s->doff);
+      s->dlen -= s->doff;
+      s->doff = 0;
+    }
+    n = SPIFFS_read(&fs, s->fd, s->dbuf + s->dlen, s->dbuf_size - s->dlen);
+    if (n == SPIFFS_ERR_END_OF_OBJECT) n = 0;
+    if (n < 0) {
+      ftp_log("\r[FTP dta] Error reading from file (%d)\r\n", n);
+      return -4;
+    }
+    s->dlen += n;
+    if ((n == 0) || ((s->file_status + (int)s->dlen) >= s->file_size)) s->file_eof = 1;
+  }
+
+  if (s->doff < s->dlen) {
+    n = send(s->data_socket, s->dbuf + s->doff, s->dlen - s->doff, 0);
+    if (n <= 0) {
+      ftp_log("\r[FTP dta] Error sending data\r\n");
+      return -3;
+    }
+    s->doff += n;
+    s->file_status += n;
+    ftp_log("\r[FTP dta] %.*f %%", 1, (float)(((float)s->file_status/(float)s->file_size)*100.0));
+  }
+  return ((s->file_eof) && (s->doff >= s->dlen)) ? 1 : 0;
 }
 
-//------------------------------------
-static void _setResponse(uint16_t cmd)
+// Receives into the data buffer. To a file it is written out each time it
+// holds a chunk, whole spiffs data pages; what does not fit in a string
+// or list is dropped.
+// 0: more to come, 1: end of data, < 0 error
+//---------------------------------------
+static int _recvData( ftp_session_t *s )
 {
-  for (uint16_t i = (recvLen-1); i>0; i--) {
-    if ((*(recvBuf+i) == '\n') || (*(recvBuf+i) == '\r')) {
-      *(recvBuf+i) = '\0';
+  uint8_t tofile = ((s->status & FTP_RECEIVING) && (s->recv_type == RECV_TOFILE));
+  uint32_t room = (tofile ? s->chunk : s->dbuf_size) - s->dlen;
+  int n;
+
+  if (room > 0) n = recv(s->data_socket, s->dbuf + s->dlen, room, 0);
+  else {
+    char tmpb[64];
+    n = recv(s->data_socket, &tmpb[0], sizeof(tmpb), 0);
+    if (n > 0) return 0;
+  }
+  if (n <= 0) return 1;
+
+  s->dlen += n;
+  if (!tofile) return 0;
+  if (s->dlen < s->chunk) return 0;
+
+  // === write received data to file ===
+  if (s->fd == FILE_NOT_OPENED) return -2;
+  if ((s->file_status + (int)s->dlen) < s->max_fsize) {
+    int writen = SPIFFS_write(&fs, s->fd, s->dbuf, s->dlen);
+    if (writen != (int)s->dlen) {
+      ftp_log("\r\n[FTP dta] Write to file failed (%d)\r\n", writen);
+      return -3;
     }
-    else break;
+    ftp_log("\r[FTP dta] Received %d byte(s)", s->file_status + s->dlen);
   }
-  ftp_log("[FTP cmd] [%d][%s]\r\n", cmd, recvBuf);
-  free(ftpresponse);
-  ftpresponse = NULL;
-  ftpresponse = (char*)malloc(strlen(recvBuf)+1);
-  if (ftpresponse != NULL) {
-    strcpy(ftpresponse, recvBuf);
+  else {
+    // file too large, no space left to write
+    ftp_log("\r[FTP dta] Max size exceded: %d byte(s)", s->file_status + s->dlen);
   }
-  cmd_done = 1;
+  s->file_status += s->dlen;
+  s->dlen = 0;
+  return 0;
+}
+
+//-----------------------------------------------------------------
+static void _setResponse( ftp_session_t *s, uint16_t cmd, char *text )
+{
+  ftp_log("[FTP cmd] [%d][%s]\r\n", cmd, text);
+  free(s->response);
+  s->response = (char*)malloc(strlen(text)+1);
+  if (s->response != NULL) {
+    strcpy(s->response, text);
+  }
+  s->cmd_done = 1;
 }
 
 // Analyze FTP server response and take some action
-// Server response is in recvBuf
-//--------------------------
-static void response( void )
+// line is the final line of a reply, without the line end
+//--------------------------------------------------
+static void response( ftp_session_t *s, char *line )
 {
-  if (!(status & FTP_CONNECTED)) return;
-  if (recvBuf == NULL) return;
+  if (!(s->status & FTP_CONNECTED)) return;
 
   uint16_t cmd = 0;
-  
-  if (*(recvBuf+3) != ' ') {
-    _setResponse(cmd);
+
+  if ((strlen(line) < 4) || (line[3] != ' ')) {
+    _setResponse(s, cmd, line);
     return;
   }
-  *(recvBuf+3) = '\0';
-  cmd = atoi(recvBuf);
+  line[3] = '\0';
+  cmd = atoi(line);
+  line += 4;
   if (cmd == 0) {
-    _setResponse(cmd);
+    _setResponse(s, cmd, line);
     return;
   }
-  recvLen -= 4;
-  memmove(recvBuf, (recvBuf+4), recvLen);
-  *(recvBuf+recvLen) = '\0';
-  
-  
+  if ((cmd >= 200) && (s->reply_due) && (s->data_socket == INVALID_HANDLE)) {
+    // the final reply of a transfer that has ended, not the reply to a
+    // command sent since: ftp.chdir() may be waiting for that one
+    ftp_log("[FTP cmd] [%d][%s]\r\n", cmd, line);
+    s->reply_due = 0;
+    return;
+  }
+  if (cmd >= 200) s->reply_due = 0;
+
   if (cmd == 220) {
-    ftp_log("[FTP cmd] Send user: %s\r\n",ftpuser);
-    char tmps[100];
-    sprintf(tmps,"USER %s\r\n",ftpuser);
-    _send(&tmps[0], strlen(ftpuser)+7);
+    ftp_log("[FTP cmd] Send user: %s\r\n", s->user);
+    _sendCmd(s, "USER", s->user);
   }
   else if (cmd == 331) {
-    ftp_log("[FTP cmd] Send pass: %s\r\n",ftppass);
-    char tmps[100];
-    sprintf(tmps,"PASS %s\r\n", ftppass);
-    _send(&tmps[0], strlen(ftppass)+7);
+    ftp_log("[FTP cmd] Send pass: %s\r\n", s->pass);
+    _sendCmd(s, "PASS", s->pass);
   }
   else if (cmd == 230) {
-    if (ftppass != NULL) {
-      free(ftppass);
-      ftppass = NULL;
-    }
-    if (ftpuser != NULL) {
-      free(ftpuser);
-      ftpuser = NULL;
-    }
-    _send("TYPE I\r\n", 8);
+    free(s->pass);
+    s->pass = NULL;
+    free(s->user);
+    s->user = NULL;
+    _sendCmd(s, "TYPE I", NULL);
 
     ftp_log("[FTP cmd] Login OK.\r\n");
-    status |= FTP_LOGGED;
-    ftpCmdSocket->clientFlag = REQ_ACTION_LOGGED;
+    s->status |= FTP_LOGGED;
+    s->clientFlag = REQ_ACTION_LOGGED;
   }
   else if (cmd == 530) {
     ftp_log("[FTP cmd] Login authentication failed\r\n");
-    ftpCmdSocket->clientFlag = REQ_ACTION_QUIT;
+    s->clientFlag = REQ_ACTION_QUIT;
   }
   else if (cmd == 221) {
     ftp_log("[FTP cmd] Request Logout\r\n");
-    ftpCmdSocket->clientFlag = REQ_ACTION_DISCONNECT;
-  }
-  else if (cmd == 226) {
-    // Closing data connection
-    _setResponse(cmd);
-  }
-  else if (cmd == 250) {
-    // Requested file action okay, completed
-    _setResponse(cmd);
+    s->clientFlag = REQ_ACTION_DISCONNECT;
   }
   else if (cmd == 257) {
     // Pathname
-    _setResponse(cmd);
-    if (ftpresponse != NULL) {
-      uint16_t i;
-      for (i = 0; i<strlen(ftpresponse); i++) {
-        if (*(recvBuf+i) == '"') break;
-      }
-      if (i<strlen(ftpresponse)) {
-        memmove(ftpresponse, ftpresponse+i+1, strlen(ftpresponse)-i);
-        for (i=strlen(ftpresponse)-1; i>0; i--) {
-          if (*(ftpresponse+i) == '"') *(ftpresponse+i) = '\0';
-        }
+    _setResponse(s, cmd, line);
+    if (s->response != NULL) {
+      char *q = strchr(s->response, '"');
+      if (q != NULL) {
+        memmove(s->response, q+1, strlen(q));
+        q = strrchr(s->response, '"');
+        if (q != NULL) *q = '\0';
       }
     }
   }
   else if ((cmd == 150) || (cmd == 125)) {
     // mark: Accepted data connection
-    if ((ftpfile != NULL) && (ftpDataSocket != NULL) &&
-        (ftpCmdSocket->clientLastFlag == REQ_ACTION_DOSEND)) {
-      status |= FTP_SENDING;
-      if ((send_type & SEND_STRING)) {
-        ftp_log("[FTP dta] Sending string to %s (%d)\r\n", ftpfile, file_size);
+    if ((s->data_socket != INVALID_HANDLE) && (s->clientLastFlag == REQ_ACTION_DOSEND)) {
+      s->status |= FTP_SENDING;
+      s->data_time = mico_get_time();
+      if ((s->send_type & SEND_STRING)) {
+        ftp_log("[FTP dta] Sending string to %s (%d)\r\n", s->file, s->file_size);
       }
       else {
-        ftp_log("[FTP dta] Sending file %s (%d)\r\n", ftpfile, file_size);
+        ftp_log("[FTP dta] Sending file %s (%d)\r\n", s->file, s->file_size);
       }
     }
-    else {
-      //if ((status & FTP_RECEIVING) == 0) _setResponse(cmd);
-      _setResponse(cmd);
-    }
+    else _setResponse(s, cmd, line);
   }
   else if (cmd == 227) {
     // entering passive mod
-    char *tStr = strtok(recvBuf, "(,");
+    char *tStr = strtok(line, "(,");
     uint8_t array_pasv[6];
     for ( int i = 0; i < 6; i++) {
       tStr = strtok(NULL, "(,");
@@ -502,518 +547,374 @@ static void response( void )
 
     if ((dataServ != 0) && (dataPort != 0)) {
       // connect data socket
-      if (_openDataSocket() >= 0) {
-        ftpDataSocket->addr.s_ip = dataServ;
-        ftpDataSocket->addr.s_port = dataPort;
+      if (_openDataSocket(s) >= 0) {
+        s->data_addr.s_ip = dataServ;
+        s->data_addr.s_port = dataPort;
 
         char ip[17]; memset(ip, 0x00, 17);
-        inet_ntoa(ip, ftpDataSocket->addr.s_ip);
-        ftp_log("[FTP dta] Opening data connection to: %s:%d\r\n", ip, ftpDataSocket->addr.s_port);
+        inet_ntoa(ip, s->data_addr.s_ip);
+        ftp_log("[FTP dta] Opening data connection to: %s:%d\r\n", ip, s->data_addr.s_port);
 
-        struct sockaddr_t *paddr = &(ftpDataSocket->addr);
-        int slen = sizeof(ftpDataSocket->addr);
-      
         //_micoNotify will be called if connected
-        int stat = connect(ftpDataSocket->socket, paddr, slen);
+        int stat = connect(s->data_socket, &s->data_addr, sizeof(s->data_addr));
         if (stat < 0) {
           ftp_log("[FTP dta] Data connection error: %d\r\n", stat);
-          ftpCmdSocket->clientFlag = NO_ACTION;
-          ftpCmdSocket->clientLastFlag = NO_ACTION;
-          data_done = 1;
-          file_status = -9;
-          closeDataSocket();
+          s->clientFlag = NO_ACTION;
+          s->clientLastFlag = NO_ACTION;
+          closeDataSocket(s);
+          closeFile(s);
+          s->file_status = -9;
+          _dataDone(s);
         }
         else {
           // Data socket connected, initialize action
-          if (ftpCmdSocket->clientLastFlag == REQ_ACTION_LIST) {
-            ftpCmdSocket->clientFlag = REQ_ACTION_DOLIST;
-            ftpCmdSocket->clientLastFlag = ftpCmdSocket->clientFlag;
-          }
-          else if (ftpCmdSocket->clientLastFlag == REQ_ACTION_RECV) {
-            ftpCmdSocket->clientFlag = REQ_ACTION_DORECV;
-            ftpCmdSocket->clientLastFlag = ftpCmdSocket->clientFlag;
-          }
-          else if (ftpCmdSocket->clientLastFlag == REQ_ACTION_SEND) {
-            ftpCmdSocket->clientFlag = REQ_ACTION_DOSEND;
-            ftpCmdSocket->clientLastFlag = ftpCmdSocket->clientFlag;
-          }
+          if (s->clientLastFlag == REQ_ACTION_LIST) s->clientFlag = REQ_ACTION_DOLIST;
+          else if (s->clientLastFlag == REQ_ACTION_RECV) s->clientFlag = REQ_ACTION_DORECV;
+          else if (s->clientLastFlag == REQ_ACTION_SEND) s->clientFlag = REQ_ACTION_DOSEND;
+          s->clientLastFlag = s->clientFlag;
         }
       }
+      else {
+        s->file_status = -9;
+        _dataDone(s);
+      }
     }
     else {
       ftp_log("[FTP dta] Wrong pasv address:port received!\r\n");
-      ftpCmdSocket->clientFlag = REQ_ACTION_DISCONNECT;
+      s->clientFlag = REQ_ACTION_DISCONNECT;
+    }
+  }
+  else if ((cmd >= 400) && (s->data_socket != INVALID_HANDLE) &&
+           ((s->clientLastFlag == REQ_ACTION_DOLIST) ||
+            (s->clientLastFlag == REQ_ACTION_DORECV) ||
+            (s->clientLastFlag == REQ_ACTION_DOSEND))) {
+    // the transfer was refused
+    _setResponse(s, cmd, line);
+    s->status |= (s->clientLastFlag == REQ_ACTION_DOLIST) ? FTP_LISTING :
+                 (s->clientLastFlag == REQ_ACTION_DORECV) ? FTP_RECEIVING : FTP_SENDING;
+    s->clientLastFlag = NO_ACTION;
+    _endData(s, -4);
+  }
+  else _setResponse(s, cmd, line);
+}
+
+// Takes the complete lines out of the command buffer, the final line of
+// each reply goes to response()
+//-------------------------------------------------
+static void _cmdLines( ftp_session_t *s )
+{
+  char *eol;
+
+  s->cmd_buf[s->cmd_len] = '\0';
+  while ((s->cmd_socket != INVALID_HANDLE) &&
+         ((eol = memchr(s->cmd_buf, '\n', s->cmd_len)) != NULL)) {
+    uint16_t n = eol - s->cmd_buf + 1;
+    char *p = eol;
+    while ((p > s->cmd_buf) && ((*p == '\n') || (*p == '\r'))) *p-- = '\0';
+    // "123-" starts a multi line reply, lines without a code continue it
+    if ((n > 4) && isdigit((int)s->cmd_buf[0]) && isdigit((int)s->cmd_buf[1]) &&
+        isdigit((int)s->cmd_buf[2]) && (s->cmd_buf[3] == ' ')) {
+      response(s, s->cmd_buf);
     }
+    s->cmd_len -= n;
+    memmove(s->cmd_buf, s->cmd_buf + n, s->cmd_len);
+    s->cmd_buf[s->cmd_len] = '\0';
   }
-  else _setResponse(cmd);
+}
+
+//-------------------------------------------------------------
+static void _pushMsg( ftp_session_t *s, int cb, int para1, char source )
+{
+  queue_msg_t msg;
+
+  msg.L = gL;
+  msg.source = source;
+  msg.para1 = para1;
+  msg.para2 = cb;
+  msg.para3 = NULL;
+  msg.para4 = NULL;
+  if ((source == onFTP) && (s->dbuf != NULL) &&
+      ((s->clientFlag == REQ_ACTION_LIST_RECEIVED) ||
+       ((s->clientFlag == REQ_ACTION_RECEIVED) && (s->recv_type == RECV_TOSTRING) && (para1 > 0)))) {
+    msg.para3 = (uint8_t*)malloc(s->dlen+4);
+    if (msg.para3 != NULL) memcpy((char*)msg.para3, s->dbuf, s->dlen+1);
+  }
+  mico_rtos_push_to_queue( &os_queue, &msg, 0);
 }
 
 // ======= FTP thread handler =========
 static void _thread_ftp(void*inContext)
 {
-  (void)inContext;
-
+  ftp_session_t *s = (ftp_session_t*)inContext;
   fd_set readset, wrset;
   struct timeval_t t_val;
-  int k;
+  int k, maxfd;
   uint32_t timeout = 0;
-  uint8_t recv_tmo = 0;
-  queue_msg_t msg;
-
-  t_val.tv_sec = 0;
-  t_val.tv_usec = 5000;
 
   mico_rtos_lock_mutex(&ftp_mut);
   timeout = mico_get_time();
   ftp_log("\r\n[FTP trd] FTP THREAD STARTED\r\n");
-  
+
   // *** First we have to get IP address and connect the cmd socket
   char pIPstr[16]={0};
   int err;
   k = 3;
   do {
-    err = gethostbyname((char *)pDomain4Dns, (uint8_t *)pIPstr, 16);
+    err = gethostbyname((char *)s->host, (uint8_t *)pIPstr, 16);
     if (err != kNoErr) {
       k--;
       mico_thread_msleep(10);
     }
   }while ((err != kNoErr) && (k > 0));
-  
-  if ((err == kNoErr) && (ftpCmdSocket != NULL)) {
-    ftpCmdSocket->addr.s_ip = inet_addr(pIPstr);
-    ftpCmdSocket->clientFlag = NO_ACTION;
 
-    free(pDomain4Dns);
-    pDomain4Dns=NULL;
+  if (err == kNoErr) {
+    s->cmd_addr.s_ip = inet_addr(pIPstr);
+    s->clientFlag = NO_ACTION;
+
+    free(s->host);
+    s->host = NULL;
 
     // Connect socket!
     char ip[17];
     memset(ip, 0x00, 17);
-    inet_ntoa(ip, ftpCmdSocket->addr.s_ip);
+    inet_ntoa(ip, s->cmd_addr.s_ip);
     ftp_log("[FTP cmd] Got IP: %s, connecting...\r\n", ip);
 
-    struct sockaddr_t *paddr = &(ftpCmdSocket->addr);
-    int slen = sizeof(ftpCmdSocket->addr);
     // _micoNotify will be called if connected
-    connect(ftpCmdSocket->socket, paddr, slen);
+    connect(s->cmd_socket, &s->cmd_addr, sizeof(s->cmd_addr));
   }
   else {
     ftp_log("[FTP dns] Get IP error\r\n");
     goto terminate;
   }
 
-  if (recvBuf == NULL) {
-    recvBuf = malloc(MAX_RECV_LEN+4);
-    memset(recvBuf, 0, MAX_RECV_LEN+4);
-  }
-  recvLen = 0;
+  s->cmd_len = 0;
 
   // ===========================================================================
   // Main Thread loop
   while (1) {
+    if (s->cmd_socket == INVALID_HANDLE) goto terminate;
+
+    // ========== wait for the sockets, the mutex is free meanwhile ===========
+    FD_ZERO(&readset);
+    FD_ZERO(&wrset);
+    maxfd = s->cmd_socket;
+    FD_SET(s->cmd_socket, &readset);
+    if (ftp_wakeup_fd >= 0) {
+      if (ftp_wakeup_fd > maxfd) maxfd = ftp_wakeup_fd;
+      FD_SET(ftp_wakeup_fd, &readset);
+    }
+    if (s->data_socket != INVALID_HANDLE) {
+      if (s->data_socket > maxfd) maxfd = s->data_socket;
+      if ((s->status & FTP_SENDING)) FD_SET(s->data_socket, &wrset);
+      else if ((s->status & FTP_DATACONNECTED)) FD_SET(s->data_socket, &readset);
+    }
+    t_val.tv_sec = 0;
+    t_val.tv_usec = ((s->clientFlag != NO_ACTION) && (!s->reply_due)) ? 0 : 20000;
     mico_rtos_unlock_mutex(&ftp_mut);
-    mico_thread_msleep(5);
+    k = select(maxfd+1, &readset, &wrset, NULL, &t_val);
     mico_rtos_lock_mutex(&ftp_mut);
-        
-    if (ftpCmdSocket == NULL) goto terminate;
+    if (k < 0) {
+      FD_ZERO(&readset);
+      FD_ZERO(&wrset);
+    }
+    if ((ftp_wakeup_fd >= 0) && (FD_ISSET(ftp_wakeup_fd, &readset))) {
+      mico_rtos_get_semaphore(&ftp_wakeup_sem, 0);
+    }
+
+    // ========== stage #1, data transfer ======================================
+    if ((s->data_socket != INVALID_HANDLE) && (s->status & FTP_TRANSFER)) {
+      if (((s->status & FTP_SENDING)) && (FD_ISSET(s->data_socket, &wrset))) {
+        err = _sendData(s);
+        if (err != 0) _endData(s, (err > 0) ? 0 : err);
+        s->data_time = mico_get_time();
+        timeout = s->data_time;
+      }
+      else if (FD_ISSET(s->data_socket, &readset)) {
+        err = _recvData(s);
+        if (err != 0) _endData(s, (err > 0) ? 0 : err);
+        s->data_time = mico_get_time();
+        timeout = s->data_time;
+      }
+      else if ((mico_get_time() - s->data_time) > MAX_DATA_TIMEOUT) {
+        ftp_log("[FTP dta] Data timeout\r\n");
+        _endData(s, -9);
+      }
+    }
+    else if ((s->data_socket != INVALID_HANDLE) && (FD_ISSET(s->data_socket, &readset))) {
+      // data socket closed before the transfer command
+      char tmpb[16];
+      if (recv(s->data_socket, &tmpb[0], sizeof(tmpb), 0) <= 0) {
+        closeDataSocket(s);
+        s->file_status = -9;
+        _dataDone(s);
+      }
+    }
+
+    // ========== stage #2, command socket =====================================
+    if (FD_ISSET(s->cmd_socket, &readset)) {
+      // read received data to buffer
+      int rcv_len;
+      if ((MAX_RECV_LEN-s->cmd_len) > 1) {
+        rcv_len = recv(s->cmd_socket, (s->cmd_buf+s->cmd_len), MAX_RECV_LEN-s->cmd_len-1, 0);
+      }
+      else { // line too long, drop it
+        s->cmd_len = 0;
+        rcv_len = recv(s->cmd_socket, s->cmd_buf, MAX_RECV_LEN-1, 0);
+      }
+
+      if (rcv_len <= 0) { // failed
+        ftp_log("\r\n[FTP cmd] Disconnect!\r\n");
+        s->clientFlag = REQ_ACTION_DISCONNECT;
+      }
+      else {
+        s->cmd_len += rcv_len;
+        _cmdLines(s);
+        timeout = mico_get_time();
+      }
+    }
 
     if ( ((mico_get_time() - timeout) > MAX_FTP_TIMEOUT) ||
-         (((mico_get_time() - timeout) > 8000) && (!(status & FTP_LOGGED))) ) {
+         (((mico_get_time() - timeout) > 8000) && (!(s->status & FTP_LOGGED))) ) {
       // ** TIMEOUT **
       ftp_log("[FTP trd] Timeout\r\n");
       timeout = mico_get_time();
-      
-      if ((status & FTP_LOGGED))
-        ftpCmdSocket->clientFlag = REQ_ACTION_QUIT;
+
+      if ((s->status & FTP_LOGGED))
+        s->clientFlag = REQ_ACTION_QUIT;
       else
-        ftpCmdSocket->clientFlag = REQ_ACTION_DISCONNECT;
+        s->clientFlag = REQ_ACTION_DISCONNECT;
     }
 
-    // ========== stage #1, Check cmd socket action requests ===================
-    
+    // ========== stage #3, Check cmd socket action requests ===================
     //REQ_ACTION_DISCONNECT
-    if (ftpCmdSocket->clientFlag == REQ_ACTION_DISCONNECT) {
-      ftpCmdSocket->clientFlag = NO_ACTION;
-      
-      closeDataSocket();
-      
+    if (s->clientFlag == REQ_ACTION_DISCONNECT) {
+      s->clientFlag = NO_ACTION;
+
+      closeDataSocket(s);
+      closeFile(s);
+
       ftp_log("[FTP cmd] Socket disconnected\r\n");
-      if (ftpCmdSocket->disconnect_cb != LUA_NOREF) {
-        msg.L = gL;
-        msg.source = onFTP | needUNREF;
-        msg.para1 = 0;
-        msg.para3 = NULL;
-        msg.para4 = NULL;
-        msg.para2 = ftpCmdSocket->disconnect_cb;
-        mico_rtos_push_to_queue( &os_queue, &msg, 0);
+      if (s->disconnect_cb != LUA_NOREF) {
+        _pushMsg(s, s->disconnect_cb, 0, onFTP | needUNREF);
+        s->disconnect_cb = LUA_NOREF;
       }
-      closeCmdSocket();
+      closeCmdSocket(s);
       continue;
     }
     //REQ_ACTION_QUIT
-    if (ftpCmdSocket->clientFlag == REQ_ACTION_QUIT) {
-      if ((status & FTP_LOGGED)) {
-        ftpCmdSocket->clientFlag = NO_ACTION;
+    if (s->clientFlag == REQ_ACTION_QUIT) {
+      if ((s->status & FTP_LOGGED)) {
+        s->clientFlag = NO_ACTION;
         ftp_log("[FTP cmd] Quit command\r\n");
-        if (_send("QUIT\r\n", 6) <= 0) {
-          ftpCmdSocket->clientFlag = REQ_ACTION_DISCONNECT;
+        if (_sendCmd(s, "QUIT", NULL) <= 0) {
+          s->clientFlag = REQ_ACTION_DISCONNECT;
         }
       }
-      else ftpCmdSocket->clientFlag = REQ_ACTION_DISCONNECT;
+      else s->clientFlag = REQ_ACTION_DISCONNECT;
       continue;
     }
 
-    if (!(status & FTP_CONNECTED)) continue;
+    if (!(s->status & FTP_CONNECTED)) continue;
     //--------------------------------------
 
+    // the reply to the last transfer comes before the reply to the next command
+    else if ((s->reply_due) &&
+             ((s->clientFlag == REQ_ACTION_LIST) || (s->clientFlag == REQ_ACTION_RECV) ||
+              (s->clientFlag == REQ_ACTION_SEND) || (s->clientFlag == REQ_ACTION_CHDIR))) {
+      if ((s->data_done) && ((mico_get_time() - s->data_time) > MAX_DATA_TIMEOUT)) s->reply_due = 0;
+    }
     //REQ_ACTION_LIST, REQ_ACTION_RECV, REQ_ACTION_SEND
-    else if ((ftpCmdSocket->clientFlag == REQ_ACTION_LIST) ||
-             (ftpCmdSocket->clientFlag == REQ_ACTION_RECV) ||
-             (ftpCmdSocket->clientFlag == REQ_ACTION_SEND)) {
-      ftpCmdSocket->clientLastFlag = ftpCmdSocket->clientFlag;
-      ftpCmdSocket->clientFlag = NO_ACTION;
+    else if ((s->clientFlag == REQ_ACTION_LIST) ||
+             (s->clientFlag == REQ_ACTION_RECV) ||
+             (s->clientFlag == REQ_ACTION_SEND)) {
+      s->clientLastFlag = s->clientFlag;
+      s->clientFlag = NO_ACTION;
 
-      _send("PASV\r\n", 6);
+      _sendCmd(s, "PASV", NULL);
     }
     //REQ_ACTION_DOLIST
-    else if (ftpCmdSocket->clientFlag == REQ_ACTION_DOLIST) {
-      ftpCmdSocket->clientFlag = NO_ACTION;
-
-      int res;
-      if (ftpfile != NULL) {
-        char tmps[100];
-        if (list_type == 1) sprintf(tmps,"NLST %s\r\n", ftpfile);
-        else sprintf(tmps,"LIST %s\r\n", ftpfile);
-        res = _send(&tmps[0], strlen(ftpfile)+7);
-        free(ftpfile);
-        ftpfile = NULL;
-      }
-      else {
-        if (list_type == 1) res = _send("NLST\r\n", 6);
-        else res = _send("LIST\r\n", 6);
+    else if (s->clientFlag == REQ_ACTION_DOLIST) {
+      s->clientFlag = NO_ACTION;
+
+      int res = _sendCmd(s, (s->list_type == 1) ? "NLST" : "LIST", s->file);
+      free(s->file);
+      s->file = NULL;
+      if (res > 0) {
+        s->status |= FTP_LISTING;
+        s->reply_due = 1;
+        s->data_time = mico_get_time();
       }
-      if (res > 0) status |= FTP_LISTING;
       else {
         ftp_log("[FTP cmd] LIST command failed.\r\n");
+        s->status |= FTP_LISTING;
+        _endData(s, -4);
       }
     }
     //REQ_ACTION_DORECV
-    else if (ftpCmdSocket->clientFlag == REQ_ACTION_DORECV) {
-      ftpCmdSocket->clientFlag = NO_ACTION;
+    else if (s->clientFlag == REQ_ACTION_DORECV) {
+      s->clientFlag = NO_ACTION;
 
-      char tmps[100];
-      sprintf(tmps,"RETR %s\r\n", ftpfile);
-      int res = _send(&tmps[0], strlen(ftpfile)+7);
-      if (res > 0) {
-        status |= FTP_RECEIVING;
-        file_status = 0;
-      }
-      else {
+      s->status |= FTP_RECEIVING;
+      s->file_status = 0;
+      s->data_time = mico_get_time();
+      if (_sendCmd(s, "RETR", s->file) <= 0) {
         ftp_log("[FTP cmd] RETR command failed.\r\n");
-        file_status = -4;
+        _endData(s, -4);
       }
+      else s->reply_due = 1;
     }
     //REQ_ACTION_DOSEND
-    else if (ftpCmdSocket->clientFlag == REQ_ACTION_DOSEND) {
-      ftpCmdSocket->clientFlag = NO_ACTION;
+    else if (s->clientFlag == REQ_ACTION_DOSEND) {
+      s->clientFlag = NO_ACTION;
 
-      char tmps[100];
-      if ((send_type & SEND_APPEND)) sprintf(tmps,"APPE %s\r\n", ftpfile);
-      else sprintf(tmps,"STOR %s\r\n", ftpfile);
-      int res = _send(&tmps[0], strlen(ftpfile)+7);
-      if (res > 0) {
-        file_status = 0;
-      }
-      else {
+      s->file_status = 0;
+      s->file_eof = 0;
+      if (_sendCmd(s, (s->send_type & SEND_APPEND) ? "APPE" : "STOR", s->file) <= 0) {
         ftp_log("[FTP cmd] STOR/APPE command failed.\r\n");
-        file_status = -4;
+        s->status |= FTP_SENDING;
+        _endData(s, -4);
       }
+      else s->reply_due = 1;
     }
     //REQ_ACTION_CHDIR
-    else if (ftpCmdSocket->clientFlag == REQ_ACTION_CHDIR) {
-      ftpCmdSocket->clientFlag = NO_ACTION;
-
-      if (ftpfile != NULL) {
-        char tmps[100];
-        sprintf(tmps,"CWD %s\r\n", ftpfile);
-        _send(&tmps[0], strlen(ftpfile)+6);
-        free(ftpfile);
-        ftpfile = NULL;
+    else if (s->clientFlag == REQ_ACTION_CHDIR) {
+      s->clientFlag = NO_ACTION;
+
+      if (s->file != NULL) {
+        _sendCmd(s, "CWD", s->file);
+        free(s->file);
+        s->file = NULL;
       }
       else {
-        _send("PWD\r\n", 5);
+        _sendCmd(s, "PWD", NULL);
       }
     }
     //REQ_ACTION_LOGGED
-    else if (ftpCmdSocket->clientFlag == REQ_ACTION_LOGGED) {
-      ftpCmdSocket->clientFlag=NO_ACTION;
-      if (ftpCmdSocket->logon_cb != LUA_NOREF) {
-        msg.L = gL;
-        msg.source = onFTP;
-        msg.para1 = 1;
-        msg.para3 = NULL;
-        msg.para4 = NULL;
-        msg.para2 = ftpCmdSocket->logon_cb;
-        mico_rtos_push_to_queue( &os_queue, &msg, 0);
-      }
+    else if (s->clientFlag == REQ_ACTION_LOGGED) {
+      if (s->logon_cb != LUA_NOREF) _pushMsg(s, s->logon_cb, 1, onFTP);
+      s->clientFlag = NO_ACTION;
     }
     //REQ_ACTION_LIST_RECEIVED
-    else if (ftpCmdSocket->clientFlag == REQ_ACTION_LIST_RECEIVED) {
-      ftpCmdSocket->clientFlag=NO_ACTION;
-      if (ftpCmdSocket->list_cb != LUA_NOREF) {
-        msg.L = gL;
-        msg.source = onFTP;
-        msg.para1 = recvDataLen;
-        msg.para2 = ftpCmdSocket->list_cb;
-        msg.para3 = (uint8_t*)malloc(recvDataLen+4);
-        msg.para4 = NULL;
-        if (msg.para3 != NULL) memcpy((char*)msg.para3, recvDataBuf, recvDataLen+1);
-
-        mico_rtos_push_to_queue( &os_queue, &msg, 0);
-      }
+    else if (s->clientFlag == REQ_ACTION_LIST_RECEIVED) {
+      if (s->list_cb != LUA_NOREF) _pushMsg(s, s->list_cb, s->dlen, onFTP);
+      s->clientFlag = NO_ACTION;
     }
     //REQ_ACTION_RECEIVED
-    else if (ftpCmdSocket->clientFlag == REQ_ACTION_RECEIVED) {
-      ftpCmdSocket->clientFlag=NO_ACTION;
-      if (ftpCmdSocket->received_cb != LUA_NOREF) {
-        msg.L = gL;
-        msg.source = onFTP;
-        msg.para1 = file_status;
-        msg.para3 = NULL;
-        msg.para4 = NULL;
-        if ((recv_type == RECV_TOSTRING) && (file_status > 0)) {
-          msg.para3 = (uint8_t*)malloc(recvDataLen+4);
-          if (msg.para3 != NULL) memcpy((char*)msg.para3, recvDataBuf, recvDataLen+1);
-        }
-        msg.para2 = ftpCmdSocket->received_cb;
-
-        mico_rtos_push_to_queue( &os_queue, &msg, 0);
-      }
+    else if (s->clientFlag == REQ_ACTION_RECEIVED) {
+      if (s->received_cb != LUA_NOREF) _pushMsg(s, s->received_cb, s->file_status, onFTP);
+      s->clientFlag = NO_ACTION;
     }
     //REQ_ACTION_SENT
-    else if (ftpCmdSocket->clientFlag == REQ_ACTION_SENT) {
-      ftpCmdSocket->clientFlag=NO_ACTION;
-      if (ftpCmdSocket->sent_cb != LUA_NOREF) {
-        msg.L = gL;
-        msg.source = onFTP;
-        msg.para1 = file_status;
-        msg.para3 = NULL;
-        msg.para4 = NULL;
-        msg.para2 = ftpCmdSocket->sent_cb;
-
-        mico_rtos_push_to_queue( &os_queue, &msg, 0);
-      }
-    }
-
-    // ========== stage 2, check data send =====================================
-    if ((ftpDataSocket != NULL) && ((status & FTP_SENDING))) {
-      FD_ZERO(&wrset);
-      FD_SET(ftpDataSocket->socket, &wrset);
-      // check socket state
-      t_val.tv_sec = 0;
-      t_val.tv_usec = 5000;
-      mico_rtos_unlock_mutex(&ftp_mut);
-      select(ftpDataSocket->socket+1, NULL, &wrset, NULL, &t_val);
-      mico_rtos_lock_mutex(&ftp_mut);
-      
-      if (FD_ISSET(ftpDataSocket->socket, &wrset)) {
-        int err;
-        if ((send_type & SEND_STRING)) { // sending from string
-          err = _sendString();
-        }
-        else { // sending from file
-          if (data_get == 1) {
-            data_get = 2; // get data from file from main thread
-            mico_rtos_unlock_mutex(&ftp_mut);
-            mico_thread_msleep(5);
-            mico_rtos_lock_mutex(&ftp_mut);
-            
-            if (data_get == 1) {
-              err = 0;
-              // got data to send
-              if (!_sendData(recvDataBuf, sendDataLen)) {
-                ftp_log("[FTP dta] Error sending data\r\n");
-                file_status = -3;
-                data_get = 3; // abort
-              }
-            }
-            else err = -1;
-          }
-          else err = -1;
-        }
-        
-        if (err != 0) {
-          closeDataSocket();
-          data_done = 1;
-          status &= ~FTP_SENDING;
-          ftpCmdSocket->clientFlag = REQ_ACTION_SENT;
-        }
-        continue;
-      }
-    }
-
-    // ========== stage 3, check receive&disconnect ============================
-    FD_ZERO(&readset);
-    // ** select sockets to monitor for receive or disconnect
-    int maxfd = ftpCmdSocket->socket;
-    FD_SET(ftpCmdSocket->socket, &readset);
-    if ( (ftpDataSocket != NULL) && ((status & FTP_DATACONNECTED)) ) {
-      // check also the data socket
-      if (ftpDataSocket->socket > maxfd) maxfd = ftpDataSocket->socket;
-      FD_SET(ftpDataSocket->socket, &readset);
-    }
-    // ** check sockets state
-    t_val.tv_sec = 0;
-    t_val.tv_usec = 5000;
-    mico_rtos_unlock_mutex(&ftp_mut);
-    select(maxfd+1, &readset, NULL, NULL, &t_val);
-    mico_rtos_lock_mutex(&ftp_mut);
-
-    // ** Check COMMAND socket
-    if (FD_ISSET(ftpCmdSocket->socket, &readset)) {
-      // read received data to buffer
-      int rcv_len;
-      if ((MAX_RECV_LEN-recvLen) > 1) {
-        rcv_len = recv(ftpCmdSocket->socket, (recvBuf+recvLen), MAX_RECV_LEN-recvLen-1, 0);
-      }
-      else { // buffer full, ignore received bytes
-        char tmpb[16];
-        rcv_len = recv(ftpCmdSocket->socket, &tmpb[0], 16, 0);
-      }
-      
-      if (rcv_len <= 0) { // failed
-        ftp_log("\r\n[FTP cmd] Disconnect!\r\n");
-        ftpCmdSocket->clientFlag = REQ_ACTION_DISCONNECT;
-        continue;
-      }
-      
-      recvLen += rcv_len;
-      _checkCmdResponse(); // leave only the last line in buffer
-      timeout = mico_get_time();
-      recv_tmo = 0;
-    }
-
-    // ** Check DATA socket
-    if ( (ftpDataSocket != NULL) && ((status & FTP_DATACONNECTED)) ) {
-      if (FD_ISSET(ftpDataSocket->socket, &readset)) {
-        // read received data to buffer
-        // recvDataLen contains the total length of received data
-        int rcv_len = -1;
-        if (recvDataBuf != NULL) {
-          rcv_len = recv(ftpDataSocket->socket, (recvDataBuf+recvDataLen), recvDataBufLen-recvDataLen-1, 0);
-        }
-
-        if (rcv_len <= 0) { // failed
-          // == Check if Data socket was receiving ==
-          if (!(status & (FTP_RECEIVING | FTP_LISTING))) {
-            // Finish all operattions on data socket
-            data_done = 1;
-            file_status = -9;
-            // Close data socket
-            closeDataSocket();
-          }
-          continue;
-        }
-        else {
-          if ((status & FTP_RECEIVING) && (recv_type == RECV_TOFILE)) {
-            // === write received data to file ===
-            recvDataLen = rcv_len;
-            data_ready = 1;
-            uint32_t tmo = mico_get_time();
-            while (data_ready > 0) { // wait until block is written to fs in main thread
-              if ((mico_get_time() - tmo) > 1000) break;
-              mico_rtos_unlock_mutex(&ftp_mut);
-              mico_thread_msleep(5);
-              mico_rtos_lock_mutex(&ftp_mut);
-            }
-            recvDataLen = 0;
-          }
-          else if ((status & FTP_LISTING) || ((status & FTP_RECEIVING) && (recv_type == RECV_TOSTRING))) {
-            // receiving to string (buffer)
-            if ((recvDataLen + rcv_len) < (recvDataBufLen-128)) recvDataLen += rcv_len;
-            else {
-              // make room for more data
-              if ((recvDataBufLen+256) <= max_recv_datalen) {
-                recvDataBuf = realloc(recvDataBuf, (recvDataBufLen+256+4));
-                if (recvDataBuf == NULL) {
-                  // create recv data buffer
-                  recvDataBuf = malloc(MIN_RECVDATABUF_LEN+4);
-                  recvDataBufLen = MIN_RECVDATABUF_LEN;
-                  memset(recvDataBuf, 0, MIN_RECVDATABUF_LEN+4);
-                  ftp_log("\r\n[FTP cmd] Data buffer reallocation error!\r\n");
-                  data_done = 1;
-                  file_status = -9;
-                  recvDataLen = 0;
-                  // Close data socket
-                  closeDataSocket();
-                }
-                else {
-                  recvDataBufLen += 256;
-                  recvDataLen += rcv_len;
-                }
-              }
-              else recvDataLen = recvDataBufLen-16;
-            }
-            if (recvDataBuf != NULL) *(recvDataBuf + recvDataLen) = '\0';
-          }
-          recv_tmo = 0;
-        }
-        timeout = mico_get_time();
-      }
-    }
-
-    // ===== nothing received ==================================================
-    recv_tmo++;
-    if (recv_tmo < 10) continue;
-    
-    recv_tmo = 0;
-
-    // == Check if Data socket was receiving ==
-    if ((status & (FTP_RECEIVING | FTP_LISTING))) {
-      // Finish all operattions on data socket
-      if ((status & FTP_RECEIVING) && (recv_type == RECV_TOFILE)) {
-        data_ready = 2;
-        uint32_t tmo = mico_get_time();
-        while (data_ready > 0) { // inform the main thread of transfer end
-          if ((mico_get_time() - tmo) > 1000) break;
-          mico_rtos_unlock_mutex(&ftp_mut);
-          mico_thread_msleep(5);
-          mico_rtos_lock_mutex(&ftp_mut);
-        }
-        recvDataLen = 0;
-      }
-      else {
-        if ((status & FTP_RECEIVING) && (recv_type == RECV_TOSTRING)) {
-          file_status = recvDataLen;
-        }
-        ftp_log("[FTP dta] Data received (%d)\r\n", recvDataLen);
-      }
-      
-      if ((status & FTP_LISTING)) {
-        status &= ~FTP_LISTING;
-        ftpCmdSocket->clientFlag = REQ_ACTION_LIST_RECEIVED;
-      }
-      if ((status & FTP_RECEIVING)) {
-        status &= ~FTP_RECEIVING;
-        ftpCmdSocket->clientFlag = REQ_ACTION_RECEIVED;
-      }
-
-      // Close data socket
-      closeDataSocket();
-      data_done = 1;
-    }
-
-    // == Check if something was received from Command socket ==
-    if (recvLen > 0) {
-      // == Analize response ===
-      response();
-      recvLen = 0;
-      memset(recvBuf, 0, MAX_RECV_LEN);
+    else if (s->clientFlag == REQ_ACTION_SENT) {
+      if (s->sent_cb != LUA_NOREF) _pushMsg(s, s->sent_cb, s->file_status, onFTP);
+      s->clientFlag = NO_ACTION;
     }
   } // while
 
 terminate:
-  _ftp_deinit();
+  _ftp_free(s);
+  mico_rtos_set_semaphore(&ftp_data_sem); // a waiting _waitData sees ftp gone
 
   ftp_thread_is_started = false;
   mico_rtos_unlock_mutex(&ftp_mut);
@@ -1027,12 +928,13 @@ terminate:
 int _stopThread( uint8_t wait )
 {
   int res = 0;
-  
+
   mico_rtos_lock_mutex(&ftp_mut);
 
-  if ( (ftp_thread_is_started) && (ftpCmdSocket != NULL) ) {
-    ftpCmdSocket->clientFlag = REQ_ACTION_QUIT;
-    
+  if ( (ftp_thread_is_started) && (ftp != NULL) ) {
+    ftp->clientFlag = REQ_ACTION_QUIT;
+    _ftp_wakeup();
+
     if (wait == 1) {
       // wait max 10 sec for disconnect
       uint32_t tmo = mico_get_time();
@@ -1061,10 +963,18 @@ static int lftp_new( lua_State* L )
   uint32_t opt;
   const char *user;
   const char *pass;
-  
+  ftp_session_t *s;
+
   if (ftp_mut == NULL) {
     mico_rtos_init_mutex(&ftp_mut);
   }
+  if (ftp_data_sem == NULL) {
+    mico_rtos_init_semaphore(&ftp_data_sem, 1);
+  }
+  if (ftp_wakeup_sem == NULL) {
+    mico_rtos_init_semaphore(&ftp_wakeup_sem, 1);
+    ftp_wakeup_fd = mico_create_event_fd(ftp_wakeup_sem);
+  }
 
   err = _stopThread(1);
   if (err == -1) {
@@ -1072,11 +982,12 @@ static int lftp_new( lua_State* L )
     lua_pushinteger(L, -9);
     return 1;
   }
-  
+
   mico_rtos_lock_mutex(&ftp_mut);
 
-  _ftp_deinit();
-  
+  // a session that was never started
+  if (ftp != NULL) _ftp_free(ftp);
+
   const char *domain = luaL_checklstring( L, 1, &dlen );
   if (dlen>128 || domain == NULL) {
     ftp_log("[FTP usr] Domain needed\r\n" );
@@ -1097,66 +1008,67 @@ static int lftp_new( lua_State* L )
     goto exit;
   }
 
-  max_recv_datalen = MIN_RECVDATABUF_LEN*2;
+  s = (ftp_session_t*)malloc(sizeof(ftp_session_t));
+  if (s == NULL) {
+    ftp_log("[FTP usr] Memory allocation failed\r\n" );
+    lua_pushinteger(L, -6);
+    goto exit;
+  }
+  memset(s, 0, sizeof(ftp_session_t));
+  s->cmd_socket = INVALID_HANDLE;
+  s->data_socket = INVALID_HANDLE;
+  s->disconnect_cb = LUA_NOREF;
+  s->logon_cb = LUA_NOREF;
+  s->list_cb = LUA_NOREF;
+  s->received_cb = LUA_NOREF;
+  s->sent_cb = LUA_NOREF;
+  s->clientFlag = NO_ACTION;
+  s->clientLastFlag = NO_ACTION;
+  s->status = FTP_NOT_CONNECTED;
+  s->cmd_done = 1;
+  s->data_done = 1;
+  s->fd = FILE_NOT_OPENED;
+  s->dbuf_size = DEF_DATABUF_LEN;
   if (lua_gettop(L) >= 5) {
     int maxdl = luaL_checkinteger(L, 5);
-    if ((maxdl >= MIN_RECVDATABUF_LEN) && (maxdl <= (MIN_RECVDATABUF_LEN*10))) max_recv_datalen = (uint16_t)maxdl;
+    if ((maxdl >= MIN_DATABUF_LEN) && (maxdl <= MAX_DATABUF_LEN)) s->dbuf_size = maxdl;
   }
+  ftp = s;
+  gL = L;
 
   // allocate buffers
-  pDomain4Dns=(char*)malloc(dlen+1);
-  ftpuser=(char*)malloc(ulen+1);
-  ftppass=(char*)malloc(plen+1);
-  if ((pDomain4Dns==NULL) || (ftpuser==NULL) || (ftppass==NULL)) {
-    _ftp_deinit();    
+  s->host=(char*)malloc(dlen+1);
+  s->user=(char*)malloc(ulen+1);
+  s->pass=(char*)malloc(plen+1);
+  if ((s->host==NULL) || (s->user==NULL) || (s->pass==NULL)) {
+    _ftp_free(s);
     ftp_log("[FTP usr] Memory allocation failed\r\n" );
     lua_pushinteger(L, -4);
     goto exit;
   }
-  strcpy(pDomain4Dns,domain);
-  strcpy(ftpuser,user);
-  strcpy(ftppass,pass);
+  strcpy(s->host,domain);
+  strcpy(s->user,user);
+  strcpy(s->pass,pass);
 
   socketHandle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
   if (socketHandle < 0) {
-    _ftp_deinit();    
+    _ftp_free(s);
     ftp_log("[FTP usr] Open CMD socket failed\r\n" );
     lua_pushinteger(L, -5);
     goto exit;
   }
-  
-  ftpCmdSocket = NULL;
-  ftpDataSocket = NULL;
-  
-  ftpCmdSocket = (ftpCmdSocket_t*)malloc(sizeof(ftpCmdSocket_t));
-  if (ftpCmdSocket == NULL) {
-    _ftp_deinit();    
-    ftp_log("[FTP usr] Memory allocation failed\r\n" );
-    lua_pushinteger(L, -6);
-    goto exit;
-  }
+  s->cmd_socket = socketHandle;
+  s->cmd_addr.s_port = port;
 
-  ftpCmdSocket->socket = socketHandle;
-  ftpCmdSocket->disconnect_cb = LUA_NOREF;
-  ftpCmdSocket->logon_cb = LUA_NOREF;
-  ftpCmdSocket->list_cb = LUA_NOREF;
-  ftpCmdSocket->received_cb = LUA_NOREF;
-  ftpCmdSocket->sent_cb = LUA_NOREF;
-  ftpCmdSocket->clientFlag = NO_ACTION;
-  ftpCmdSocket->clientLastFlag = NO_ACTION;
-  ftpCmdSocket->addr.s_port = port;
-  
-  status = FTP_NOT_CONNECTED;
   opt=0;
   err = setsockopt(socketHandle,IPPROTO_IP,SO_BLOCKMODE,&opt,4); // non block mode
   if (err < 0) {
-    _ftp_deinit();    
+    _ftp_free(s);
     ftp_log("[FTP usr] Set socket options failed\r\n" );
     lua_pushinteger(L, -7);
     goto exit;
   }
 
-  gL = L;
   ftp_log("[FTP usr] FTP client configured.\r\n" );
   lua_pushinteger(L, 0);
 
@@ -1171,57 +1083,55 @@ static int lftp_start( lua_State* L )
 {
   uint32_t tmo;
   LinkStatusTypeDef wifi_link;
-  
-  int err = micoWlanGetLinkStatus( &wifi_link );
+
+  micoWlanGetLinkStatus( &wifi_link );
 
   if ( wifi_link.is_connected == false ) {
     ftp_log("[FTP usr] WiFi NOT CONNECTED!\r\n" );
     lua_pushinteger(L, -1);
     return 1;
   }
-  
+
   mico_rtos_lock_mutex(&ftp_mut);
 
-  if ( (gL == NULL) || (ftpCmdSocket == NULL) ) {
+  if ( (gL == NULL) || (ftp == NULL) ) {
     ftp_log("[FTP usr] Execute ftp.new first!\r\n" );
     lua_pushinteger(L, -2);
     goto exit;
   }
-  
+
   if (ftp_thread_is_started) {
     ftp_log("[FTP usr] Thread already started, execute net.stop() first!\r\n" );
     lua_pushinteger(L, -3);
     goto exit;
   }
-  
+
   mico_system_notify_register( mico_notify_TCP_CLIENT_CONNECTED, (void *)_micoNotify_FTPClientConnectedHandler, NULL );
 
-  // all setup, start the ftp thread
-  if (!ftp_thread_is_started) {
-    if (mico_rtos_create_thread(NULL, MICO_APPLICATION_PRIORITY-1, "Ftp_Thread", _thread_ftp, 1024, NULL) != kNoErr) {
-      _ftp_deinit();    
-      ftp_log("[FTP usr] Create thread failed\r\n" );
-      lua_pushinteger(L, -4);
-      goto exit;
-    }
-    else ftp_thread_is_started = true;
-  } 
+  // all setup, start the ftp thread, it does the spiffs i/o of the transfers
+  if (mico_rtos_create_thread(NULL, MICO_APPLICATION_PRIORITY-1, "Ftp_Thread", _thread_ftp, 2048, ftp) != kNoErr) {
+    _ftp_free(ftp);
+    ftp_log("[FTP usr] Create thread failed\r\n" );
+    lua_pushinteger(L, -4);
+    goto exit;
+  }
+  ftp_thread_is_started = true;
 
-  if (ftpCmdSocket->logon_cb != LUA_NOREF) {
+  if (ftp->logon_cb != LUA_NOREF) {
     lua_pushinteger(L, 0);
     goto exit;
   }
-  
+
   // wait max 10 sec for login
   tmo = mico_get_time();
-  while ( (ftp_thread_is_started) && !(status & FTP_LOGGED) ) {
+  while ( (ftp_thread_is_started) && (ftp != NULL) && !(ftp->status & FTP_LOGGED) ) {
     if ((mico_get_time() - tmo) > 10000) break;
     mico_rtos_unlock_mutex(&ftp_mut);
     mico_thread_msleep(100);
     mico_rtos_lock_mutex(&ftp_mut);
     luaWdgReload();
   }
-  if (!(status & FTP_LOGGED)) lua_pushinteger(L, -4);
+  if ((ftp == NULL) || !(ftp->status & FTP_LOGGED)) lua_pushinteger(L, -4);
   else lua_pushinteger(L, 0);
 
 exit:
@@ -1234,8 +1144,8 @@ exit:
 static int lftp_stop( lua_State* L )
 {
   int res = 1;
-  
-  if (ftpCmdSocket->disconnect_cb != LUA_NOREF) res = _stopThread(0);
+
+  if ((ftp != NULL) && (ftp->disconnect_cb != LUA_NOREF)) res = _stopThread(0);
   else res = _stopThread(1);
   lua_pushinteger(L, res);
   return 1;
@@ -1246,10 +1156,10 @@ static int lftp_stop( lua_State* L )
 static int lftp_debug( lua_State* L )
 {
   int dbg = luaL_checkinteger(L, 1);
-  
+
   if (dbg == 1) log = true;
   else log = false;
-  
+
   return 0;
 }
 
@@ -1258,11 +1168,11 @@ static int lftp_debug( lua_State* L )
 static int lftp_on( lua_State* L )
 {
   const char *method;
-  uint8_t reg_func = 0;
-  
+  int *ref = NULL;
+
   mico_rtos_lock_mutex(&ftp_mut);
-  
-  if ( (gL == NULL) || (ftpCmdSocket == NULL) ) {
+
+  if ( (gL == NULL) || (ftp == NULL) ) {
     ftp_log("[FTP usr] Execute ftp.new first!" );
     lua_pushinteger(L, -1);
     goto exit;
@@ -1275,40 +1185,22 @@ static int lftp_on( lua_State* L )
     lua_pushinteger(L, -3);
     goto exit;
   }
-  
-  if ((lua_type(L, 2) == LUA_TFUNCTION) || (lua_type(L, 2) == LUA_TLIGHTFUNCTION)) {
-    lua_pushvalue(L, 2);
-    reg_func = 1;
-  }
-  
-  if ((strcmp(method,"login") == 0) && (sl == strlen("login"))) {
-    if (ftpCmdSocket->logon_cb != LUA_NOREF)
-      luaL_unref(gL,LUA_REGISTRYINDEX, ftpCmdSocket->logon_cb);
-    if (reg_func == 1) ftpCmdSocket->logon_cb = luaL_ref(L, LUA_REGISTRYINDEX);
-  }
-  else if ((strcmp(method,"disconnect") == 0) && (sl == strlen("disconnect"))) {
-    if (ftpCmdSocket->disconnect_cb != LUA_NOREF)
-      luaL_unref(gL,LUA_REGISTRYINDEX, ftpCmdSocket->disconnect_cb);
-    if (reg_func == 1) ftpCmdSocket->disconnect_cb = luaL_ref(L, LUA_REGISTRYINDEX);
-  }
-  else if ((strcmp(method,"receive") == 0) && (sl == strlen("receive"))) {
-    if (ftpCmdSocket->received_cb != LUA_NOREF)
-      luaL_unref(gL,LUA_REGISTRYINDEX, ftpCmdSocket->received_cb);
-    if (reg_func == 1) ftpCmdSocket->received_cb = luaL_ref(L, LUA_REGISTRYINDEX);
-  }
-  else if ((strcmp(method,"send") == 0) && (sl == strlen("send"))) {
-    if (ftpCmdSocket->sent_cb != LUA_NOREF)
-      luaL_unref(gL,LUA_REGISTRYINDEX, ftpCmdSocket->sent_cb);
-    if (reg_func == 1) ftpCmdSocket->sent_cb = luaL_ref(L, LUA_REGISTRYINDEX);
-  }
-  else if ((strcmp(method,"list") == 0) && (sl == strlen("list"))) {
-    if (ftpCmdSocket->list_cb != LUA_NOREF)
-      luaL_unref(gL,LUA_REGISTRYINDEX, ftpCmdSocket->list_cb);
-    if (reg_func == 1) ftpCmdSocket->list_cb = luaL_ref(L, LUA_REGISTRYINDEX);
-  }
+
+  if ((strcmp(method,"login") == 0) && (sl == strlen("login"))) ref = &ftp->logon_cb;
+  else if ((strcmp(method,"disconnect") == 0) && (sl == strlen("disconnect"))) ref = &ftp->disconnect_cb;
+  else if ((strcmp(method,"receive") == 0) && (sl == strlen("receive"))) ref = &ftp->received_cb;
+  else if ((strcmp(method,"send") == 0) && (sl == strlen("send"))) ref = &ftp->sent_cb;
+  else if ((strcmp(method,"list") == 0) && (sl == strlen("list"))) ref = &ftp->list_cb;
   else {
     ftp_log("[FTP usr] Unknown CB function: %s", method);
     lua_pushinteger(L, -5);
+    goto exit;
+  }
+
+  _unref(ref);
+  if ((lua_type(L, 2) == LUA_TFUNCTION) || (lua_type(L, 2) == LUA_TLIGHTFUNCTION)) {
+    lua_pushvalue(L, 2);
+    *ref = luaL_ref(L, LUA_REGISTRYINDEX);
   }
 
   lua_pushinteger(L, 0);
@@ -1321,10 +1213,10 @@ exit:
 //-----------------------------------------------
 static int _getFName(lua_State* L, uint8_t index)
 {
-  free(ftpfile);
-  ftpfile = NULL;
+  free(ftp->file);
+  ftp->file = NULL;
   if (lua_gettop(L) < index) return -3; // no file arg exists
-  
+
   size_t len = 0;
   const char *fname = luaL_checklstring( L, index, &len );
   if ((len < 1) || (len >= SPIFFS_OBJ_NAME_LEN) || (fname == NULL)) {
@@ -1332,12 +1224,12 @@ static int _getFName(lua_State* L, uint8_t index)
     return -1;
   }
 
-  ftpfile = (char*)malloc(SPIFFS_OBJ_NAME_LEN);
-  if (ftpfile == NULL) {
+  ftp->file = (char*)malloc(SPIFFS_OBJ_NAME_LEN);
+  if (ftp->file == NULL) {
     ftp_log("[FTP fil] Memory allocation failed\r\n" );
     return -2;
   }
-  strcpy(ftpfile, fname);
+  strcpy(ftp->file, fname);
   return 0;
 }
 
@@ -1345,28 +1237,25 @@ static int _getFName(lua_State* L, uint8_t index)
 //-------------------------
 int _openFile(uint8_t mode)
 {
-  
+
   // open the file
-  if (ftpfile == NULL) {
+  if (ftp->file == NULL) {
     ftp_log("[FTP fil] File name not allocated\r\n");
     return -1;
   }
 
-  if (FILE_NOT_OPENED != file_fd) {
-    SPIFFS_close(&fs, file_fd);
-    file_fd = FILE_NOT_OPENED;
-  }
+  closeFile(ftp);
 
   uint8_t check = 1;
   int mde = SPIFFS_RDONLY;
   char fullname[SPIFFS_OBJ_NAME_LEN] = {0};
   uint8_t res = 0;
-  
+
   if (mode == 1) {
     check = 0;
     mde = SPIFFS_WRONLY|SPIFFS_CREAT|SPIFFS_TRUNC;
   }
-  res = checkFileName(strlen(ftpfile), ftpfile, fullname, 1, check);
+  res = checkFileName(strlen(ftp->file), ftp->file, fullname, 1, check);
   if ((mode == 0) && (res != 2)) {
       ftp_log("[FTP fil] File '%s' not found\r\n", fullname);
       return -2;
@@ -1375,33 +1264,34 @@ int _openFile(uint8_t mode)
     ftp_log("[FTP fil] Bad file name: '%s'\r\n", fullname);
     return -2;
   }
-  
+
   if ((mode == 1) && (fileExists(fullname))) {
     ftp_log("[FTP fil] Deleting existing file '%s'\r\n", fullname);
     SPIFFS_remove(&fs, fullname);
   }
 
-  file_fd = SPIFFS_open(&fs, fullname, mde, 0);
-  if (file_fd <= FILE_NOT_OPENED) {
+  ftp->fd = SPIFFS_open(&fs, fullname, mde, 0);
+  if (ftp->fd <= FILE_NOT_OPENED) {
+    ftp->fd = FILE_NOT_OPENED;
     ftp_log("[FTP fil] Error opening file '%s'\r\n", fullname);
     return -3;
   }
 
   ftp_log("[FTP fil] Opened local file '%s' for ", fullname);
   if (mode == 0) {
-    ftp_log("reading\r\n"); 
+    ftp_log("reading\r\n");
     // reading, get file size
     spiffs_stat s;
-    SPIFFS_fstat(&fs, file_fd, &s);
+    SPIFFS_fstat(&fs, ftp->fd, &s);
     ftp_log("[FTP fil] File size: %d\r\n", s.size);
     if (s.size == 0) {
-      if (FILE_NOT_OPENED != file_fd) SPIFFS_close(&fs, file_fd);
+      closeFile(ftp);
       return -4;
     }
     else return s.size;
   }
   else {
-    ftp_log("writing\r\n"); 
+    ftp_log("writing\r\n");
   }
   return 0;
 }
@@ -1410,85 +1300,116 @@ int _openFile(uint8_t mode)
 uint8_t _waitDataSocketFree(void)
 {
   uint32_t tmo = mico_get_time();
-  while (ftpDataSocket != NULL) {
+  while ((ftp != NULL) && (ftp->data_socket != INVALID_HANDLE)) {
     if ((mico_get_time() - tmo) > 5000) break;
     mico_rtos_unlock_mutex(&ftp_mut);
     mico_thread_msleep(50);
     mico_rtos_lock_mutex(&ftp_mut);
     luaWdgReload();
   }
-  if (ftpDataSocket != NULL) {
-    closeDataSocket();
+  if (ftp == NULL) return 0;
+  if (ftp->data_socket != INVALID_HANDLE) {
+    closeDataSocket(ftp);
     ftp_log("[FTP usr] Data socket not free!\r\n" );
     return 0;
   }
   return 1;
 }
 
+// Waits while the transfer moves. If it stops, or a started one never
+// begins, it is ended here: the ftp thread must not use the file after
+// the Lua function returns. 0 on timeout or the session gone.
+//------------------------------
+static uint8_t _waitData( void )
+{
+  uint32_t tmo = mico_get_time();
+  int last = ftp->file_status;
+
+  while ((ftp != NULL) && (ftp->data_done == 0)) {
+    if (ftp->file_status != last) {
+      last = ftp->file_status;
+      tmo = mico_get_time();
+    }
+    if ((mico_get_time() - tmo) > (MAX_DATA_TIMEOUT+5000)) break;
+    mico_rtos_unlock_mutex(&ftp_mut);
+    // _dataDone wakes it, the timeout keeps the watchdog and the stall check going
+    mico_rtos_get_semaphore(&ftp_data_sem, 1000);
+    mico_rtos_lock_mutex(&ftp_mut);
+    luaWdgReload();
+  }
+  if (ftp == NULL) return 0;
+  if (ftp->data_done == 0) {
+    ftp->clientFlag = NO_ACTION;
+    ftp->clientLastFlag = NO_ACTION;
+    closeDataSocket(ftp);
+    closeFile(ftp);
+    ftp->data_done = 1;
+    return 0;
+  }
+  return 1;
+}
+
+// Is a session logged in
+//-----------------------
+static int _logged( void )
+{
+  return ((gL != NULL) && (ftp != NULL) && (ftp->status & FTP_LOGGED));
+}
+
 //ftp.list(ltype, otype [,remotedir])
 //===================================
 static int lftp_list( lua_State* L )
 {
   int err = 0;
-  uint16_t dptr = 0;
+  uint32_t dptr = 0;
   uint8_t n = 0;
   int nlin = 0;
   char buf[255] = {0};
-  uint32_t tmo;
 
   uint8_t ltype = luaL_checkinteger(L, 1);
   uint8_t otype = luaL_checkinteger(L, 2);
   if (otype == 1) ltype = 1;
-  _getFName(L, 3); // get remote dir/file spec
-  
+
   mico_rtos_lock_mutex(&ftp_mut);
 
-  if ((gL == NULL) || (ftpCmdSocket == NULL) || (!(status & FTP_LOGGED))) {
+  if (!_logged()) {
     ftp_log("[FTP usr] Login first\r\n" );
     err = -1;
     goto exit;
   }
+  _getFName(L, 3); // get remote dir/file spec
 
   if (!_waitDataSocketFree()) {
     err = -2;
     goto exit;
   }
-  
-  list_type = ltype;
-  data_done = 0;
-  ftpCmdSocket->clientFlag = REQ_ACTION_LIST;
-  
-  if (ftpCmdSocket->list_cb != LUA_NOREF) {
+
+  ftp->list_type = ltype;
+  ftp->data_done = 0;
+  ftp->clientFlag = REQ_ACTION_LIST;
+  _ftp_wakeup();
+
+  if (ftp->list_cb != LUA_NOREF) {
     goto exit;
   }
-  
-  // no cb function, wait until List received (max 10 sec)
-  tmo = mico_get_time();
-  while (data_done == 0) {
-    if ((mico_get_time() - tmo) > 10000) break;
-    mico_rtos_unlock_mutex(&ftp_mut);
-    mico_thread_msleep(60);
-    mico_rtos_lock_mutex(&ftp_mut);
-    luaWdgReload();
-  }
-  _waitDataSocketFree();
 
-  if (data_done == 0) {
+  // no cb function, wait until List received
+  if (!_waitData()) {
     ftp_log("[FTP usr] Timeout: list not received\r\n" );
     err = -3;
     goto exit;
   }
 
-  if ((recvDataBuf == NULL) || (recvDataLen == 0)) {
+  if ((ftp->dbuf == NULL) || (ftp->dlen == 0)) {
     ftp_log("[FTP usr] List not received\r\n" );
     err = -4;
     goto exit;
   }
-  
+
   if (otype != 1) {
     printf("===================\r\n");
     printf("FTP directory list:");
-    if (recvDataLen >= (recvDataBufLen-16)) {
+    if (ftp->dlen >= ftp->dbuf_size) {
       printf(" (buffer full)");
     }
     printf("\r\n");
@@ -1498,9 +1419,10 @@ static int lftp_list( lua_State* L )
   }
 
   nlin = 0;
-  while (dptr < recvDataLen) {
-    if (*(recvDataBuf+dptr) == '\0') break;
-    if ((*(recvDataBuf+dptr) == '\n') || (*(recvDataBuf+dptr) == '\r') || (n >= 254)) {
+  while (dptr < ftp->dlen) {
+    char c = *(ftp->dbuf+dptr);
+    if (c == '\0') break;
+    if ((c == '\n') || (c == '\r') || (n >= 254)) {
       // EOL, print line
       if (n > 0) {
         nlin++;
@@ -1512,7 +1434,7 @@ static int lftp_list( lua_State* L )
         n = 0;
       }
     }
-    if (*(recvDataBuf+dptr) >= ' ') buf[n++] = *(recvDataBuf+dptr);
+    if (c >= ' ') buf[n++] = c;
     buf[n] = '\0';
     dptr++;
   }
@@ -1536,7 +1458,7 @@ static int lftp_list( lua_State* L )
     mico_rtos_unlock_mutex(&ftp_mut);
     return 2;
   }
-  
+
 exit:
   if (otype == 1) {
     lua_newtable( L );
@@ -1554,40 +1476,41 @@ exit:
 static int lftp_chdir( lua_State* L )
 {
   uint32_t tmo;
-  
+
   mico_rtos_lock_mutex(&ftp_mut);
-  
-  if ( (gL == NULL) || (ftpCmdSocket == NULL) || (!(status & FTP_LOGGED)) ) {
+
+  if (!_logged()) {
     ftp_log("[FTP usr] Login first\r\n" );
     lua_pushinteger(L, -1);
     goto exit;
   }
   _getFName(L, 1); // get remote dir
 
-  free(ftpresponse);
-  ftpresponse = NULL;
-  cmd_done = 0;
-  ftpCmdSocket->clientFlag = REQ_ACTION_CHDIR;
+  free(ftp->response);
+  ftp->response = NULL;
+  ftp->cmd_done = 0;
+  ftp->clientFlag = REQ_ACTION_CHDIR;
+  _ftp_wakeup();
 
   tmo = mico_get_time();
-  while (cmd_done == 0) {
+  while ((ftp != NULL) && (ftp->cmd_done == 0)) {
     if ((mico_get_time() - tmo) > 5000) break;
     mico_rtos_unlock_mutex(&ftp_mut);
-    mico_thread_msleep(60);
+    mico_thread_msleep(20);
     mico_rtos_lock_mutex(&ftp_mut);
     luaWdgReload();
   }
-  if (cmd_done == 0) {
+  if ((ftp == NULL) || (ftp->cmd_done == 0)) {
     ftp_log("[FTP usr] Timeout\r\n" );
     lua_pushinteger(L, -2);
     goto exit;
   }
 
   lua_pushinteger(L, 0);
-  if (ftpresponse != NULL) {
-    lua_pushstring(L, ftpresponse);
-    free(ftpresponse);
-    ftpresponse = NULL;
+  if (ftp->response != NULL) {
+    lua_pushstring(L, ftp->response);
+    free(ftp->response);
+    ftp->response = NULL;
   }
   else lua_pushstring(L, "?");
   mico_rtos_unlock_mutex(&ftp_mut);
@@ -1596,7 +1519,7 @@ static int lftp_chdir( lua_State* L )
 exit:
   mico_rtos_unlock_mutex(&ftp_mut);
   return 1;
-  
+
 }
 
 //ftp.recv(file [,tostr])
@@ -1607,7 +1530,7 @@ static int lftp_recv( lua_State* L )
 
   mico_rtos_lock_mutex(&ftp_mut);
 
-  if ( (gL == NULL) || (ftpCmdSocket == NULL) || (!(status & FTP_LOGGED)) ) {
+  if (!_logged()) {
     ftp_log("[FTP usr] Login first\r\n" );
     lua_pushinteger(L, -11);
     goto exit;
@@ -1621,14 +1544,14 @@ static int lftp_recv( lua_State* L )
     lua_pushinteger(L, -12);
     goto exit;
   }
-  
-  recv_type = RECV_TOFILE;
+
+  ftp->recv_type = RECV_TOFILE;
   if (lua_gettop(L) >= 2) {
     int tos = luaL_checkinteger(L, 2);
-    if (tos == 1) recv_type = RECV_TOSTRING;
+    if (tos == 1) ftp->recv_type = RECV_TOSTRING;
   }
 
-  if (recv_type == RECV_TOFILE) {
+  if (ftp->recv_type == RECV_TOFILE) {
     // get max file size
     uint32_t total, used;
     SPIFFS_info(&fs, &total, &used);
@@ -1651,94 +1574,39 @@ static int lftp_recv( lua_State* L )
       goto exit;
     }
   }
-  
-  data_ready = 0;
-  data_done = 0;
-  ftpCmdSocket->clientFlag = REQ_ACTION_RECV;
-  
-  if (recv_type == RECV_TOFILE) {
-    // ** receiving to file,
-    //    we have to handle saving to file from THIS thread
-    uint32_t tmo = mico_get_time();
-    while ((mico_get_time() - tmo) < 4000) {
-      mico_rtos_unlock_mutex(&ftp_mut);
-      mico_thread_msleep(5);
-      mico_rtos_lock_mutex(&ftp_mut);
-
-      if (data_ready == 1) {
-        // some data received, write to file
-        if (!(status & FTP_RECEIVING)) file_status = -4;
-        else if (file_fd == FILE_NOT_OPENED) file_status =  -2;
-        else if ((recvDataBuf != NULL) && (recvDataLen > 0)) {
-          if ((file_status + recvDataLen) < max_fsize) {
-            // OK to write
-            int writen = SPIFFS_write(&fs, file_fd, (char*)recvDataBuf, recvDataLen);
-            mico_thread_msleep(5);
-            
-            if (writen != recvDataLen) { //failed
-              SPIFFS_fflush(&fs, file_fd);
-              SPIFFS_close(&fs, (spiffs_file)file_fd);
-              file_fd = FILE_NOT_OPENED;
-              ftp_log("\r\n[FTP dta] Write to file failed (%d)\r\n", writen);
-              file_status = -3;
-            }
-            else {
-              SPIFFS_fflush(&fs, file_fd);
-              file_status += recvDataLen;
-              ftp_log("\r[FTP dta] Received %d byte(s)", file_status);
-            }
-          }
-          else {
-            // file too large, no space left to write
-            file_status += recvDataLen;
-            ftp_log("\r[FTP dta] Max size exceded: %d byte(s)", file_status);
-          }
-        }
-        data_ready = 0;
-        tmo = mico_get_time();
-      }
-      else if (data_ready == 2) {
-        data_ready = 0;
-        break;
-      }
-      luaWdgReload();
-    }
-    if (file_fd != FILE_NOT_OPENED) {
-      SPIFFS_fflush(&fs, file_fd);
-      SPIFFS_close(&fs, file_fd);
-      file_fd = FILE_NOT_OPENED;
+
+  ftp->max_fsize = max_fsize;
+  ftp->file_status = 0;
+  ftp->data_done = 0;
+  ftp->clientFlag = REQ_ACTION_RECV;
+  _ftp_wakeup();
+
+  if (ftp->recv_type == RECV_TOFILE) {
+    // ** receiving to file, the ftp thread writes it
+    _waitData();
+    if (ftp == NULL) {
+      lua_pushinteger(L, -4);
+      goto exit;
     }
-    free(ftpfile);
-    ftpfile = NULL;
-    if (file_status >= max_fsize) {
+    free(ftp->file);
+    ftp->file = NULL;
+    if (ftp->file_status >= max_fsize) {
       ftp_log("\r\n[FTP dta] File too big, truncated\r\n");
     }
-    else {
-      ftp_log("\r\n[FTP dta] Data file closed\r\n");
-    }
-    lua_pushinteger(L, file_status);
+    lua_pushinteger(L, ftp->file_status);
     _waitDataSocketFree();
   }
-  else if ((recv_type == RECV_TOSTRING) && (ftpCmdSocket->received_cb == LUA_NOREF)) {
+  else if (ftp->received_cb == LUA_NOREF) {
     // no cb function & receive to string,
-    // wait until file received (max 10 sec)
-    uint32_t tmo = mico_get_time();
-    while (!data_done) {
-      if ((mico_get_time() - tmo) > 10000) break;
-      mico_rtos_unlock_mutex(&ftp_mut);
-      mico_thread_msleep(60);
-      mico_rtos_lock_mutex(&ftp_mut);
-      luaWdgReload();
-    }
-    _waitDataSocketFree();
-    if (!data_done) {
+    // wait until file received
+    if (!_waitData()) {
       ftp_log("[FTP usr] Timeout: file not received\r\n" );
       lua_pushinteger(L, -14);
     }
     else {
       ftp_log("[FTP usr] File received\r\n" );
-      lua_pushinteger(L, file_status);
-      lua_pushstring(L, recvDataBuf);
+      lua_pushinteger(L, ftp->file_status);
+      lua_pushlstring(L, ftp->dbuf, ftp->dlen);
       mico_rtos_unlock_mutex(&ftp_mut);
       return 2;
     }
@@ -1755,19 +1623,18 @@ exit:
 static int lftp_send( lua_State* L )
 {
   mico_rtos_lock_mutex(&ftp_mut);
-  uint32_t tmo;
-  
-  if ( (gL == NULL) || (ftpCmdSocket == NULL) || (!(status & FTP_LOGGED)) ) {
+
+  if (!_logged()) {
     ftp_log("[FTP usr] Login first\r\n" );
     lua_pushinteger(L, -11);
     goto exit;
   }
   if (lua_gettop(L) >= 2) {
-    send_type = (uint8_t)luaL_checkinteger(L, 2);
-    if (send_type != SEND_APPEND) send_type = SEND_OVERWRITTE;
+    ftp->send_type = (uint8_t)luaL_checkinteger(L, 2);
+    if (ftp->send_type != SEND_APPEND) ftp->send_type = SEND_OVERWRITTE;
   }
-  else send_type = SEND_OVERWRITTE;
-  
+  else ftp->send_type = SEND_OVERWRITTE;
+
   if (!_waitDataSocketFree()) {
     lua_pushinteger(L, -15);
     goto exit;
@@ -1776,77 +1643,29 @@ static int lftp_send( lua_State* L )
     lua_pushinteger(L, -12);
     goto exit;
   }
-  file_size = _openFile(0);
-  if ( file_size < 0) {
-    file_size = 0;
+  ftp->file_size = _openFile(0);
+  if (ftp->file_size < 0) {
+    ftp->file_size = 0;
     lua_pushinteger(L, -13);
     goto exit;
   }
 
-  data_done = 0;
-  data_get = 1;
-  ftpCmdSocket->clientFlag = REQ_ACTION_SEND;
-  
-  // ** sending from file,
-  //    we have to handle saving to file from THIS thread
-  tmo = mico_get_time();
-  while ((mico_get_time() - tmo) < 4000) {
-    mico_rtos_unlock_mutex(&ftp_mut);
-    mico_thread_msleep(5);
-    mico_rtos_lock_mutex(&ftp_mut);
-    if (data_get == 2) {
-      data_get = 0;
-      if (ftpfile == NULL) {
-        ftp_log("\r[FTP dta] Send file not valid\r\n");
-        file_status = -1;
-        break;
-      }
-      else if (recvDataBuf == NULL) {
-        ftp_log("\r[FTP dta] Buffer error\r\n");
-        file_status = -2;
-        break;
-      }
-      else if (file_status >= file_size) {
-        break;
-      }
-      else {
-        uint16_t len = MIN_RECVDATABUF_LEN-4;
-        if (recvDataBufLen < len) len = recvDataBufLen-4;
-        sendDataLen = SPIFFS_read(&fs, file_fd, (char*)recvDataBuf, len);
-        if (sendDataLen > 0) {
-          file_status += sendDataLen;
-          ftp_log("\r[FTP dta] %.*f %%", 1, (float)(((float)file_status/(float)file_size)*100.0));
-          data_get = 1; // send data
-          tmo = mico_get_time();
-        }
-        else if (sendDataLen < 0) {
-          ftp_log("\r[FTP dta] Error reading from file (%d)\r\n", sendDataLen);
-          file_status = -4;
-          break;
-        }
-        else break;
-      }
-    }
-    else if (data_get == 3) {
-      // abort, error sending
-      break;
-    }
-    luaWdgReload();
-  }
-  data_get = 0;
-  if ((mico_get_time() - tmo) > 4000) {
+  ftp->file_status = 0;
+  ftp->data_done = 0;
+  ftp->clientFlag = REQ_ACTION_SEND;
+  _ftp_wakeup();
+
+  // ** sending from file, the ftp thread reads it
+  if (!_waitData()) {
     ftp_log("\r[FTP dta] Timeout while sending data\r\n");
   }
-  // Close file
-  if (file_fd != FILE_NOT_OPENED) {
-    SPIFFS_fflush(&fs, file_fd);
-    SPIFFS_close(&fs, file_fd);
-    file_fd = FILE_NOT_OPENED;
+  if (ftp == NULL) {
+    lua_pushinteger(L, -4);
+    goto exit;
   }
-  free(ftpfile);
-  ftpfile = NULL;
-  ftp_log("\r\n[FTP dta] Data file closed\r\n");
-  lua_pushinteger(L, file_status);
+  free(ftp->file);
+  ftp->file = NULL;
+  lua_pushinteger(L, ftp->file_status);
   _waitDataSocketFree();
 
 exit:
@@ -1859,28 +1678,28 @@ exit:
 static int lftp_sendstring( lua_State* L )
 {
   mico_rtos_lock_mutex(&ftp_mut);
-  
-  if ((gL == NULL) || (ftpCmdSocket == NULL) || ((status & FTP_LOGGED) == 0)) {
+
+  if (!_logged()) {
     ftp_log("[FTP usr] Login first\r\n" );
     lua_pushinteger(L, -11);
     goto exit;
   }
 
   if (lua_gettop(L) >= 3) {
-    send_type = (uint8_t)luaL_checkinteger(L, 3);
-    if (send_type != SEND_APPEND) send_type = SEND_OVERWRITTE;
+    ftp->send_type = (uint8_t)luaL_checkinteger(L, 3);
+    if (ftp->send_type != SEND_APPEND) ftp->send_type = SEND_OVERWRITTE;
   }
-  else send_type = SEND_OVERWRITTE;
-  send_type |= SEND_STRING;
+  else ftp->send_type = SEND_OVERWRITTE;
+  ftp->send_type |= SEND_STRING;
 
   if (_getFName(L, 1) < 0) {
     lua_pushinteger(L, -12);
     goto exit;
   }
-  
+
   size_t len;
-  sendDataBuf = (char*)luaL_checklstring( L, 2, &len );
-  if ((sendDataBuf == NULL) || (len <= 0)) {
+  const char *str = luaL_checklstring( L, 2, &len );
+  if ((str == NULL) || (len <= 0)) {
     ftp_log("[FTP fil] Bad string\r\n");
     lua_pushinteger(L, -14);
   }
@@ -1889,28 +1708,23 @@ static int lftp_sendstring( lua_State* L )
       lua_pushinteger(L, -15);
       goto exit;
     }
-    file_size = len;
-    data_done = 0;
-    ftpCmdSocket->clientFlag = REQ_ACTION_SEND;
-  
-    uint32_t tmo = mico_get_time();
-    while (!data_done) {
-      if ((mico_get_time() - tmo) > 10000) break;
-      mico_rtos_unlock_mutex(&ftp_mut);
-      mico_thread_msleep(60);
-      mico_rtos_lock_mutex(&ftp_mut);
-      luaWdgReload();
-    }
-    _waitDataSocketFree();
-    if (!data_done) {
+    ftp->send_str = str;
+    ftp->file_size = len;
+    ftp->file_status = 0;
+    ftp->data_done = 0;
+    ftp->clientFlag = REQ_ACTION_SEND;
+    _ftp_wakeup();
+
+    if (!_waitData()) {
       ftp_log("[FTP usr] Timeout: string not sent\r\n" );
       lua_pushinteger(L, -15);
     }
     else {
       ftp_log("[FTP usr] String sent\r\n" );
-      lua_pushinteger(L, file_status);
+      lua_pushinteger(L, ftp->file_status);
     }
-    sendDataBuf = NULL;
+    _waitDataSocketFree();
+    if (ftp != NULL) ftp->send_str = NULL;
   }
 
 exit:
@@ -1934,7 +1748,7 @@ const LUA_REG_TYPE ftp_map[] =
   {LSTRKEY("list"), LFUNCVAL(lftp_list)},
   {LSTRKEY("debug"), LFUNCVAL(lftp_debug)},
 #if LUA_OPTIMIZE_MEMORY > 0
-#endif        
+#endif
   {LNILKEY, LNILVAL}
 };
 
@@ -1942,12 +1756,13 @@ LUALIB_API int luaopen_ftp(lua_State *L)
 {
 
   mico_rtos_init_mutex(&ftp_mut);
+  mico_rtos_init_semaphore(&ftp_data_sem, 1);
 
 #if LUA_OPTIMIZE_MEMORY > 0
     return 0;
-#else  
+#else
   luaL_register( L, EXLIB_NET, ftp_map );
- 
+
   return 1;
 #endif
 }
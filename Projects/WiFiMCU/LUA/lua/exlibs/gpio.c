@@ -7,10 +7,12 @@
 #include "lualib.h"
 #include "lrotable.h"
 #include "user_config.h"
+#include "stdlib.h"
    
 #include "platform.h"
 #include "mico_platform.h"
 #include "platform_peripheral.h"
+#include "gpio_capture.h"
 
 #define NUM_GPIO 18
 #define INPUT         OUTPUT_OPEN_DRAIN_PULL_UP+1
@@ -19,6 +21,11 @@
 #define HIGH          OUTPUT_OPEN_DRAIN_PULL_UP+4
 #define LOW           OUTPUT_OPEN_DRAIN_PULL_UP+5
 
+// edge capture
+#define CAPTURE_DEPTH       64      // records per pin, default
+#define CAPTURE_MAX_DEPTH   1024
+#define CAPTURE_READ        16      // records read from the ring at once
+
 extern mico_queue_t os_queue;
 const char wifimcu_gpio_map[] =
 {
@@ -64,6 +71,211 @@ static void _gpio_irq_handler( void* arg )
   }
 }
 
+// == Edge capture ==
+// Per pin state, records behind it. Lua gets all edges recorded so far on one
+// os_queue message; gen tells stale messages of a stopped capture apart.
+typedef struct {
+  gpio_capture_t cap;
+  lua_State*    L;
+  int           cb_ref;
+  uint8_t       trigger;
+  uint8_t       timer_on;
+  uint32_t      depth;
+  uint32_t      prev;       // cycles of the last edge handed to lua
+  mico_timer_t  timer;      // coalescing window
+  uint32_t      records[];
+} gpioCapture_t;
+
+static gpioCapture_t* gpio_cap[NUM_GPIO];
+static uint16_t gpio_cap_gen[NUM_GPIO];
+static mico_mutex_t gpio_cap_mut = NULL; // gpio_cap[] between the lua and the timer thread
+
+//-------------------------------------------
+static void _gpio_capture_notify( unsigned id )
+{
+  gpioCapture_t* g = gpio_cap[id];
+  queue_msg_t msg;
+  msg.L = g->L;
+  msg.source = onCAPTURE;
+  msg.para1 = id | (gpio_cap_gen[id] << 8);
+  msg.para2 = g->cb_ref;
+  msg.para3 = NULL;
+  msg.para4 = NULL;
+  if (mico_rtos_push_to_queue( &os_queue, &msg, 0) != kNoErr)
+    gpio_capture_cancel(&g->cap);
+}
+
+// == interrupt context ==
+//-------------------------------------------
+static void _gpio_capture_irq( void* arg )
+{
+  uint32_t cycles = DWT->CYCCNT;
+  unsigned id = (unsigned)arg;
+  gpioCapture_t* g;
+  uint8_t level;
+
+  if (id >= NUM_GPIO || (g = gpio_cap[id]) == NULL) return;
+  if (g->trigger == IRQ_TRIGGER_RISING_EDGE) level = 1;
+  else if (g->trigger == IRQ_TRIGGER_FALLING_EDGE) level = 0;
+  else level = MicoGpioInputGet( (mico_gpio_t)wifimcu_gpio_map[id] );
+  if (gpio_capture_edge(&g->cap, cycles, level))
+    _gpio_capture_notify(id);
+}
+
+// end of a coalescing window, timer thread
+//-------------------------------------------
+static void _gpio_capture_timer( void* arg )
+{
+  unsigned id = (unsigned)arg;
+  gpioCapture_t* g;
+
+  mico_rtos_lock_mutex(&gpio_cap_mut);
+  g = gpio_cap[id];
+  if (g != NULL && g->timer_on && gpio_capture_poll(&g->cap))
+    _gpio_capture_notify(id);
+  mico_rtos_unlock_mutex(&gpio_cap_mut);
+}
+
+//-------------------------------------------
+static void _gpio_capture_stop( lua_State* L, unsigned id )
+{
+  gpioCapture_t* g = gpio_cap[id];
+  if (g == NULL) return;
+
+  MicoGpioDisableIRQ( (mico_gpio_t)wifimcu_gpio_map[id] );
+  // a timer callback in progress ends before g goes, a later one finds no g
+  mico_rtos_lock_mutex(&gpio_cap_mut);
+  gpio_cap[id] = NULL;
+  gpio_cap_gen[id]++;   // messages still in os_queue are discarded
+  mico_rtos_unlock_mutex(&gpio_cap_mut);
+  if (g->timer_on) {
+    mico_stop_timer(&g->timer);
+    mico_deinit_timer(&g->timer);
+  }
+  if (g->cb_ref != LUA_NOREF)
+    luaL_unref(L, LUA_REGISTRYINDEX, g->cb_ref);
+  free(g);
+}
+
+// Called from the lua thread for each queued notification (see do_queue_task).
+// Pushes times, levels and dropped, returns their number, -1 when there is nothing
+//--------------------------------------------
+int _gpio_capture_push( lua_State* L, int para )
+{
+  unsigned id = para & 0xFF;
+  gpioCapture_t* g;
+  uint32_t rec[CAPTURE_READ];
+  uint32_t mhz = SystemCoreClock / 1000000;
+  uint32_t n, i, total = 0, us;
+
+  if (id >= NUM_GPIO || (g = gpio_cap[id]) == NULL) return -1;
+  if ((uint16_t)(para >> 8) != gpio_cap_gen[id]) return -1;
+
+  do {
+    while (total < g->depth && (n = gpio_capture_read(&g->cap, rec, CAPTURE_READ)) > 0) {
+      if (total == 0) {
+        lua_createtable(L, n, 0);
+        lua_createtable(L, n, 0);
+      }
+      for (i = 0; i < n; i++) {
+        // microseconds since the previous edge, the remainder carries over
+        us = (GPIO_CAPTURE_CYCLES(rec[i]) - g->prev) / mhz;
+        g->prev += us * mhz;
+        total++;
+        lua_pushinteger(L, us);
+        lua_rawseti(L, -3, total);
+        lua_pushinteger(L, GPIO_CAPTURE_LEVEL(rec[i]));
+        lua_rawseti(L, -2, total);
+      }
+    }
+    if (total >= g->depth) {
+      // more than a ring full, the rest goes with the next message
+      if (gpio_capture_done(&g->cap)) _gpio_capture_notify(id);
+      break;
+    }
+  } while (gpio_capture_done(&g->cap));
+
+  if (total == 0) return -1;
+  lua_pushinteger(L, g->cap.dropped);
+  return 3;
+}
+
+// gpio.capture(pin, 'rising'|'falling'|'both', function(times, levels, dropped) end
+//              [, debounce_us [, window_ms [, depth]]])
+// gpio.capture(pin)  returns edges dropped, edges bounced
+//-----------------------------------
+static int lgpio_capture( lua_State* L )
+{
+  unsigned pin = luaL_checkinteger( L, 1 );
+  unsigned platformPin;
+  unsigned type;
+  size_t sl = 0;
+  int debounce, window, depth;
+  gpioCapture_t* g;
+
+  MOD_CHECK_ID( gpio, pin );
+  platformPin = wifimcu_gpio_map[pin];
+  if (lua_gettop(L) == 1) {
+    g = gpio_cap[pin];
+    lua_pushinteger(L, g ? g->cap.dropped : 0);
+    lua_pushinteger(L, g ? g->cap.bounced : 0);
+    return 2;
+  }
+
+  const char *str = luaL_checklstring( L, 2, &sl );
+  if (sl == 4 && strcmp(str, "both") == 0) type = IRQ_TRIGGER_BOTH_EDGES;
+  else if (sl == 6 && strcmp(str, "rising") == 0) type = IRQ_TRIGGER_RISING_EDGE;
+  else if (sl == 7 && strcmp(str, "falling") == 0) type = IRQ_TRIGGER_FALLING_EDGE;
+  else return luaL_error( L, "arg should be 'rising' or 'falling' or 'both' " );
+  if (lua_type(L, 3) != LUA_TFUNCTION && lua_type(L, 3) != LUA_TLIGHTFUNCTION)
+    return luaL_error( L, "callback function needed" );
+  debounce = luaL_optinteger( L, 4, 0 );
+  window = luaL_optinteger( L, 5, 0 );
+  depth = luaL_optinteger( L, 6, CAPTURE_DEPTH );
+  if (debounce < 0 || debounce > 1000000) return luaL_error( L, "wrong debounce" );
+  if (window < 0) return luaL_error( L, "wrong window" );
+  if (depth < 2 || depth > CAPTURE_MAX_DEPTH || (depth & (depth - 1)) != 0)
+    return luaL_error( L, "depth should be a power of 2 up to %d", CAPTURE_MAX_DEPTH );
+
+  // the pin leaves interrupt mode or an earlier capture
+  if (gpio_cb_ref[pin] != LUA_NOREF) {
+    MicoGpioDisableIRQ((mico_gpio_t)platformPin);
+    luaL_unref(L, LUA_REGISTRYINDEX, gpio_cb_ref[pin]);
+    gpio_cb_ref[pin] = LUA_NOREF;
+  }
+  _gpio_capture_stop(L, pin);
+
+  if (gpio_cap_mut == NULL) mico_rtos_init_mutex(&gpio_cap_mut);
+  g = malloc(sizeof(gpioCapture_t) + depth * sizeof(uint32_t));
+  if (g == NULL) return luaL_error( L, "memory allocation error" );
+
+  // free running cycle counter, stamps the edges
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  gpio_capture_init(&g->cap, g->records, depth, debounce * (SystemCoreClock / 1000000), window > 0);
+  lua_pushvalue(L, 3);
+  g->cb_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+  g->L = L;
+  g->trigger = type;
+  g->depth = depth;
+  g->prev = DWT->CYCCNT;
+  g->timer_on = 0;
+  if (window > 0) {
+    mico_init_timer(&g->timer, window, _gpio_capture_timer, (void*)pin);
+    g->timer_on = 1;
+  }
+  mico_rtos_lock_mutex(&gpio_cap_mut);
+  gpio_cap[pin] = g;
+  mico_rtos_unlock_mutex(&gpio_cap_mut);
+  if (g->timer_on) mico_start_timer(&g->timer);
+
+  MicoGpioFinalize((mico_gpio_t)platformPin);
+  MicoGpioInitialize((mico_gpio_t)platformPin, (mico_gpio_config_t)INPUT_PULL_UP);
+  MicoGpioEnableIRQ( (mico_gpio_t)platformPin, (mico_gpio_irq_trigger_t)type, _gpio_capture_irq, (void*)pin);
+  return 0;
+}
+
 // gpio.mode(pin,mode)
 //gpio.mode(pin,gpio.INT,'rising',function)
 static int lgpio_mode( lua_State* L )
@@ -89,6 +301,8 @@ static int lgpio_mode( lua_State* L )
   if( mode == INPUT)    mode = INPUT_PULL_UP;//for default
   if( mode == OUTPUT)   mode = OUTPUT_PUSH_PULL;//for default
 
+  _gpio_capture_stop(L, pin);
+
   if (mode!=INTERRUPT)
   {// disable interrupt
     if(gpio_cb_ref[pin] != LUA_NOREF)
@@ -189,6 +403,7 @@ const LUA_REG_TYPE gpio_map[] =
   { LSTRKEY( "read" ), LFUNCVAL( lgpio_read ) },
   { LSTRKEY( "write" ), LFUNCVAL( lgpio_write ) },
   { LSTRKEY( "toggle" ), LFUNCVAL( lgpio_toggle ) },
+  { LSTRKEY( "capture" ), LFUNCVAL( lgpio_capture ) },
 #if LUA_OPTIMIZE_MEMORY > 0
   { LSTRKEY( "INPUT" ), LNUMVAL( INPUT ) },
   { LSTRKEY( "INPUT_PULL_UP" ), LNUMVAL( INPUT_PULL_UP ) },
@@ -0,0 +1,93 @@
+/**
+ * gpio_capture.c
+ */
+
+#include "gpio_capture.h"
+
+// The interrupt publishes an edge and then tests pending, the reader clears
+// pending and then tests the ring: both need a store to load barrier
+#if defined(__ICCARM__)
+#include <intrinsics.h>
+#define _capture_barrier()  __DMB()
+#else
+#define _capture_barrier()  __sync_synchronize()
+#endif
+
+//----------------------------------------------------------------------------------------
+OSStatus gpio_capture_init( gpio_capture_t* c, uint32_t* records, uint32_t depth,
+                            uint32_t debounce_cycles, uint8_t deferred )
+{
+  OSStatus err = ring_fifo_init( &c->ring, (uint8_t*)records, depth * sizeof(uint32_t) );
+  if (err != kNoErr) return err;
+
+  c->debounce = debounce_cycles;
+  c->last = 0;
+  c->started = 0;
+  c->deferred = deferred;
+  c->pending = 0;
+  c->dropped = 0;
+  c->bounced = 0;
+  return kNoErr;
+}
+
+// == interrupt context ==
+//---------------------------------------------------------------------
+bool gpio_capture_edge( gpio_capture_t* c, uint32_t cycles, uint8_t level )
+{
+  ring_fifo_span_t span;
+  uint32_t record = GPIO_CAPTURE_CYCLES(cycles) | (level & 1);
+
+  if (c->started && (uint32_t)(cycles - GPIO_CAPTURE_CYCLES(c->last)) < c->debounce) {
+    c->bounced++;
+    return false;
+  }
+  c->last = record;
+  c->started = 1;
+
+  // records are 4 bytes in a ring of 4 byte multiples, never split
+  if (ring_fifo_write_peek( &c->ring, &span ) < sizeof(uint32_t)) {
+    c->dropped++;
+    return false;
+  }
+  *(uint32_t*)span.data[0] = record;
+  ring_fifo_write_commit( &c->ring, sizeof(uint32_t) );
+
+  if (c->deferred) return false;
+  _capture_barrier();
+  if (c->pending) return false;
+  c->pending = 1;
+  return true;
+}
+
+// == timer context ==
+//-------------------------------------------
+bool gpio_capture_poll( gpio_capture_t* c )
+{
+  if (c->pending || ring_fifo_used_space( &c->ring ) == 0) return false;
+  c->pending = 1;
+  return true;
+}
+
+//-------------------------------------------
+void gpio_capture_cancel( gpio_capture_t* c )
+{
+  c->pending = 0;
+}
+
+// == reader (lua thread) ==
+//------------------------------------------------------------------------------
+uint32_t gpio_capture_read( gpio_capture_t* c, uint32_t* records, uint32_t max )
+{
+  return ring_fifo_read( &c->ring, (uint8_t*)records, max * sizeof(uint32_t) ) / sizeof(uint32_t);
+}
+
+//-------------------------------------------
+bool gpio_capture_done( gpio_capture_t* c )
+{
+  c->pending = 0;
+  _capture_barrier();
+  if (ring_fifo_used_space( &c->ring ) == 0) return false;
+  // an edge got in before pending was clear and did not notify
+  c->pending = 1;
+  return true;
+}
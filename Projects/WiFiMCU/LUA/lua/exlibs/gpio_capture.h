@@ -0,0 +1,48 @@
+/**
+ * gpio_capture.h
+ */
+
+#ifndef __GPIO_CAPTURE_H_
+#define __GPIO_CAPTURE_H_
+
+#include "RingBufferUtils.h"
+
+// Edge capture of one pin. The interrupt handler stamps each edge with the
+// cycle counter into a ring of records, the lua thread takes every edge
+// recorded so far on a single notification.
+// A record is the cycle count with the pin level in bit 0.
+#define GPIO_CAPTURE_LEVEL(r)   ((r) & 1u)
+#define GPIO_CAPTURE_CYCLES(r)  ((r) & ~1u)
+
+typedef struct {
+  ring_fifo_t       ring;       // of records, written by the interrupt
+  uint32_t          debounce;   // cycles after an edge in which others are ignored
+  uint32_t          last;       // record of the last edge taken
+  uint8_t           started;    // last is valid
+  uint8_t           deferred;   // a timer notifies, not the interrupt
+  volatile uint8_t  pending;    // a notification is on its way
+  volatile uint32_t dropped;    // edges lost to a full ring
+  volatile uint32_t bounced;    // edges inside the debounce time
+} gpio_capture_t;
+
+// depth records of storage, a power of 2
+OSStatus gpio_capture_init( gpio_capture_t* c, uint32_t* records, uint32_t depth,
+                            uint32_t debounce_cycles, uint8_t deferred );
+
+// Interrupt side: records the edge, true when the reader has to be notified
+bool gpio_capture_edge( gpio_capture_t* c, uint32_t cycles, uint8_t level );
+
+// Timer side of a deferred capture: true when the reader has to be notified
+bool gpio_capture_poll( gpio_capture_t* c );
+
+// The notification could not be sent, the next edge or poll retries
+void gpio_capture_cancel( gpio_capture_t* c );
+
+// Reader side: up to max records, oldest first
+uint32_t gpio_capture_read( gpio_capture_t* c, uint32_t* records, uint32_t max );
+
+// Reader side, after a batch: true when edges came in meanwhile, which the
+// reader still has to read, no notification comes for them
+bool gpio_capture_done( gpio_capture_t* c );
+
+#endif
@@ -9,8 +9,10 @@
 
 #include "mico_platform.h"
 #include "user_config.h"
+#include "bitbang.h"
 
 extern const char wifimcu_gpio_map[];
+extern const platform_gpio_t platform_gpio_pins[];
 #define NUM_GPIO 18
 static int platform_gpio_exists( unsigned pin )
 {
@@ -18,138 +20,12 @@ static int platform_gpio_exists( unsigned pin )
 }
 
 static mico_i2c_device_t hw_i2c;
+static bb_i2c_t sw_i2c;
 static uint8_t pinSDA = 0;
 static uint8_t pinSCL = 0;
 bool IIC_Init = false;
 bool hw_IIC_Init = false;
-static bool IIC_started = false;
-#define I2C_speed 360  // Standard mode, 100 kHz
-
-//-------------------------------------------------------------------------
-// we use cycle counter for precise timing with software I2C
-#define CYCLE_COUNTING_INIT() \
-    do \
-    { \
-        /* enable DWT hardware and cycle counting */ \
-        CoreDebug->DEMCR = CoreDebug->DEMCR | CoreDebug_DEMCR_TRCENA_Msk; \
-        /* reset a counter */ \
-        DWT->CYCCNT = 0;  \
-        /* enable the counter */ \
-        DWT->CTRL = (DWT->CTRL | DWT_CTRL_CYCCNTENA_Msk) ; \
-    } \
-    while(0)
-//-------------------------------------------------------------------------
-
-//-------------------------
-static void IIC_Start(void)
-{
-  if ( IIC_started ) {
-    // if started, do a restart cond
-    // set SDA to 1
-    MicoGpioOutputHigh( (mico_gpio_t)pinSDA);
-    CYCLE_COUNTING_INIT();
-    while (DWT->CYCCNT < (I2C_speed * 2)) ;
-
-    // set SCL to 1
-    MicoGpioOutputHigh( (mico_gpio_t)pinSCL);
-    if (MicoGpioInputGet((mico_gpio_t)pinSCL) == 0) { // Allow for clock stretching
-      while ((MicoGpioInputGet((mico_gpio_t)pinSCL) == 0) && (DWT->CYCCNT < 10000)) ;
-      DWT->CYCCNT = 0;
-    }
-    while (DWT->CYCCNT < (I2C_speed * 2)) ;
-  }
-
-  //if( read_SDA() == 0 ) arbitration_lost();
-
-  // set SDA to 0
-  MicoGpioOutputLow( (mico_gpio_t)pinSDA);
-  CYCLE_COUNTING_INIT();
-  while (DWT->CYCCNT < (I2C_speed * 2)) ;
-
-  // set SCL to 0
-  MicoGpioOutputLow( (mico_gpio_t)pinSCL);
-  CYCLE_COUNTING_INIT();
-  while (DWT->CYCCNT < (I2C_speed * 2)) ;
-
-  IIC_started = true;
-}
-
-//------------------------
-static void IIC_Stop(void)
-{
-  // set SDA to 0
-  MicoGpioOutputLow( (mico_gpio_t)pinSDA);
-  CYCLE_COUNTING_INIT();
-  while (DWT->CYCCNT < (I2C_speed * 2)) ;
-
-  // set SCL to 1
-  MicoGpioOutputHigh( (mico_gpio_t)pinSCL);
-  CYCLE_COUNTING_INIT();
-  if (MicoGpioInputGet((mico_gpio_t)pinSCL) == 0) { // Allow for clock stretching
-    while ((MicoGpioInputGet((mico_gpio_t)pinSCL) == 0) && (DWT->CYCCNT < 10000)) ;
-    DWT->CYCCNT = 0;
-  }
-  while (DWT->CYCCNT < (I2C_speed * 2)) ;
-
-  // set SDA to 1
-  MicoGpioOutputHigh( (mico_gpio_t)pinSDA);
-  CYCLE_COUNTING_INIT();
-  while (DWT->CYCCNT < (I2C_speed * 2)) ;
-}
-
-//-----------------------------------
-static int IIC_Send_Byte(uint8_t txd)
-{
-  uint8_t t, data;   
-  
-  data = txd;
-  // Send 8 bits, MSB first
-  for(t=0;t<8;t++)
-    {
-      CYCLE_COUNTING_INIT();
-      if ((data & 0x80) == 0x80) MicoGpioOutputHigh( (mico_gpio_t)pinSDA);
-      else MicoGpioOutputLow( (mico_gpio_t)pinSDA);
-      data <<= 1;
-      // SDA change propagation delay, SCL=Low
-      while (DWT->CYCCNT < I2C_speed) ;
-
-      // Set SCL high to indicate a new valid SDA value is available
-      MicoGpioOutputHigh( (mico_gpio_t)pinSCL);
-      CYCLE_COUNTING_INIT();
-      if (MicoGpioInputGet((mico_gpio_t)pinSCL) == 0) { // Allow for clock stretching
-        while ((MicoGpioInputGet((mico_gpio_t)pinSCL) == 0) && (DWT->CYCCNT < 10000)) ;
-        DWT->CYCCNT = 0;
-      }
-      // Wait for SDA value to be read by slave
-      while (DWT->CYCCNT < I2C_speed) ;
-
-      // Clear the SCL to low in preparation for next change
-      MicoGpioOutputLow( (mico_gpio_t)pinSCL);
-    }
-
-  // Check ACK/NACK
-  CYCLE_COUNTING_INIT();
-  t = 1;
-  MicoGpioOutputHigh( (mico_gpio_t)pinSDA);
-  while (DWT->CYCCNT < I2C_speed) ;
-
-  MicoGpioOutputHigh( (mico_gpio_t)pinSCL);
-  CYCLE_COUNTING_INIT();
-  if (MicoGpioInputGet((mico_gpio_t)pinSCL) == 0) { // Allow for clock stretching
-    while ((MicoGpioInputGet((mico_gpio_t)pinSCL) == 0) && (DWT->CYCCNT < 10000)) ;
-    DWT->CYCCNT = 0;
-  }
-  // Wait for ACK to be set by slave
-  while (DWT->CYCCNT < I2C_speed) {
-    if (MicoGpioInputGet((mico_gpio_t)pinSDA) == 0) t = 0;
-  }
-
-  // Clear the SCL to low in preparation for next change
-  MicoGpioOutputLow( (mico_gpio_t)pinSCL);
-  
-  if (t == 0) return 0;
-  else return -1;
-}
+#define I2C_SPEED_KHZ 100  // Standard mode, software i2c also does 400 kHz fast mode
 
 //---------------------------------------------------------------------------------------
 int _i2c_write(uint8_t id, uint16_t dev_adr, uint8_t* data, uint16_t count, uint16_t rep)
@@ -158,27 +34,30 @@ int _i2c_write(uint8_t id, uint16_t dev_adr, uint8_t* data, uint16_t count, uint
   
   if (id == 0) { // === software i2c ===
     // Send start condition
-    IIC_Start();
+    bb_i2c_start(&sw_i2c);
     // Send address
-    int res = IIC_Send_Byte((uint8_t)(dev_adr << 1));
-    if (res != 0) return -9;
+    int res = bb_i2c_write(&sw_i2c, (uint8_t)(dev_adr << 1));
+    if (res != 0) {
+      bb_i2c_stop(&sw_i2c);
+      return -9;
+    }
     
     for ( i = 0; i < count; i++ ) {
       if (i == (count-1)) {
         // repeat last byte rep times
         for ( j = 0; j < rep; j++ ) {
-          res = IIC_Send_Byte(*(data + i));
+          res = bb_i2c_write(&sw_i2c, *(data + i));
           if (res != 0) break; 
         }
         if (res != 0) break; 
       }
       else {
-        res = IIC_Send_Byte(*(data + i));
+        res = bb_i2c_write(&sw_i2c, *(data + i));
         if (res != 0) break; 
       }
     }
     // Send stop condition
-    IIC_Stop();
+    bb_i2c_stop(&sw_i2c);
 
     return res;
   }
@@ -197,57 +76,7 @@ int _i2c_write(uint8_t id, uint16_t dev_adr, uint8_t* data, uint16_t count, uint
   }
 }
 
-//ack=1 send ACK; ack=0 send nACK
-//---------------------------------------------
-static uint8_t IIC_Read_Byte(unsigned char ack)
-{
-  unsigned char i,receive=0;
-  
-  // Let the slave drive data
-  MicoGpioOutputHigh( (mico_gpio_t)pinSDA);
-  for(i=0;i<8;i++ )
-  {
-    // Wait for SDA value to be written by slave
-    CYCLE_COUNTING_INIT();
-    while (DWT->CYCCNT < I2C_speed) ;
-
-    // Set SCL high
-    MicoGpioOutputHigh( (mico_gpio_t)pinSCL);
-    CYCLE_COUNTING_INIT();
-    while (DWT->CYCCNT < I2C_speed) ;
-    // SCL is high, read out bit
-    if (MicoGpioInputGet((mico_gpio_t)pinSDA)) receive |= 1;
-    receive <<= 1;
-    // Set SCL low in preparation for next operation
-    MicoGpioOutputLow( (mico_gpio_t)pinSCL);
-  }					 
-
-  // Set ACK/NACK
-  CYCLE_COUNTING_INIT();
-  if (!ack) MicoGpioOutputHigh( (mico_gpio_t)pinSDA);
-  else MicoGpioOutputLow( (mico_gpio_t)pinSDA);
-
-  // SDA change propagation delay, SCL=Low
-  while (DWT->CYCCNT < I2C_speed) ;
-
-  // Set SCL high to indicate a new valid SDA value is available
-  MicoGpioOutputHigh( (mico_gpio_t)pinSCL);
-  CYCLE_COUNTING_INIT();
-  if (MicoGpioInputGet((mico_gpio_t)pinSCL) == 0) { // Allow for clock stretching
-    while ((MicoGpioInputGet((mico_gpio_t)pinSCL) == 0) && (DWT->CYCCNT < 10000)) ;
-    DWT->CYCCNT = 0;
-  }
-  // Wait for SDA value to be read by slave
-  while (DWT->CYCCNT < I2C_speed) ;
-
-  // Clear the SCL to low in preparation for next change
-  MicoGpioOutputLow( (mico_gpio_t)pinSCL);
-
-  return receive;
-}
-
-
-//i2c.setup(0, pinSDA, pinSCL)
+//i2c.setup(0, pinSDA, pinSCL [, kHz])
 //i2c.setup(1, adr_len, mode)
 //==================================
 static int i2c_setup( lua_State* L )
@@ -261,6 +90,8 @@ static int i2c_setup( lua_State* L )
   if (id == 0) {
     MOD_CHECK_ID( gpio, sda );
     MOD_CHECK_ID( gpio, scl );
+    unsigned khz = luaL_optinteger( L, 4, I2C_SPEED_KHZ );
+    if ((khz < 10) || (khz > 400)) return luaL_error( L, "speed should be 10~400 kHz" );
     pinSDA = wifimcu_gpio_map[sda];
     pinSCL = wifimcu_gpio_map[scl];
     
@@ -272,11 +103,16 @@ static int i2c_setup( lua_State* L )
     MicoGpioInitialize((mico_gpio_t)pinSCL,(mico_gpio_config_t)OUTPUT_OPEN_DRAIN_NO_PULL);  
     MicoGpioOutputHigh( (mico_gpio_t)pinSCL);
 
+    // resolve the pins once, the bus then runs on their registers
+    bb_pin_t bsda, bscl;
+    bb_pin( &bsda, platform_gpio_pins[pinSDA].port, platform_gpio_pins[pinSDA].pin_number );
+    bb_pin( &bscl, platform_gpio_pins[pinSCL].port, platform_gpio_pins[pinSCL].pin_number );
+    bb_i2c_init( &sw_i2c, &bsda, &bscl, khz * 1000, SystemCoreClock / 1000000 );
+
     IIC_Init = true;
-    IIC_started = false;
-    IIC_Start();
-    IIC_Send_Byte(0xFE);
-    IIC_Stop();
+    bb_i2c_start(&sw_i2c);
+    bb_i2c_write(&sw_i2c, 0xFE);
+    bb_i2c_stop(&sw_i2c);
   }
   else {
     hw_i2c.port = MICO_I2C_1;
@@ -308,7 +144,6 @@ static int i2c_deinit( lua_State* L )
       MicoGpioFinalize((mico_gpio_t)pinSDA);
       MicoGpioFinalize((mico_gpio_t)pinSCL);
       IIC_Init = false;
-      IIC_started = false;
     }
   }
   else {
@@ -428,11 +263,11 @@ static int i2c_read( lua_State* L )
     }
 
     // Send start condition
-    IIC_Start();
+    bb_i2c_start(&sw_i2c);
     // Send address
-    int res = IIC_Send_Byte((dev_id << 1) | 1);
+    int res = bb_i2c_write(&sw_i2c, (dev_id << 1) | 1);
     if (res != 0) {
-      IIC_Stop();
+      bb_i2c_stop(&sw_i2c);
       lua_pushinteger(L, -1);
       lua_pushinteger(L, res);
       goto exit;
@@ -440,13 +275,13 @@ static int i2c_read( lua_State* L )
     
     for( i = 0; i < size; i ++ )
     {
-      if (i == (size-1)) data = IIC_Read_Byte(0);
-      else  data = IIC_Read_Byte(1);
+      // ack all but the last byte
+      data = bb_i2c_read(&sw_i2c, i != (size-1));
       b[i] = data;
     }
 
     // Send stop condition
-    IIC_Stop();
+    bb_i2c_stop(&sw_i2c);
   }
   else { // === hardware i2c ===
     if (!hw_IIC_Init) return luaL_error( L, "hardware i2c not initialized" );
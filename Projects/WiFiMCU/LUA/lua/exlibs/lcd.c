@@ -186,8 +186,8 @@
    
 extern const char wifimcu_gpio_map[];
 extern uint8_t spiInit[];
-extern void _MicoLcdTransfer( uint8_t* buf, int len );
-extern void _swLcdTransfer( uint8_t* buf, int len );
+extern int _MicoLcdTransfer( uint8_t* buf, int len );
+extern int _swLcdTransfer( uint8_t* buf, int len );
 
 extern uint8_t SmallFont[];         
 extern uint8_t Font8x8[];
@@ -202,6 +202,7 @@ extern uint8_t checkFileName(int len, const char* name, char* newname, uint8_t a
 static uint8_t TFT_SPI_ID = 255;
 uint8_t TFT_pinDC  = 255;
 static uint8_t TFT_type   = 0;
+static int lcd_spi_err     = 0;  // SPI DMA failed since the lua call began
 
 static int platform_gpio_exists( unsigned pin )
 {
@@ -342,8 +343,20 @@ static void dbgBuf(uint16_t size) {
 
 //----------------------------------------------------
 static void _LcdSpiTransfer( uint8_t* buf, int len ) {
-  if (TFT_SPI_ID == 2) _MicoLcdTransfer( buf, len );
-  else _swLcdTransfer( buf, len );
+  int err;
+  if (TFT_SPI_ID == 2) err = _MicoLcdTransfer( buf, len );
+  else err = _swLcdTransfer( buf, len );
+  if (err != 0) lcd_spi_err = err;
+}
+
+// A failed SPI DMA of the drawing call is a lua error
+//---------------------------------------------------
+static int _lcd_spi_result( lua_State* L, int nres ) {
+  if (lcd_spi_err != 0) {
+    lcd_spi_err = 0;
+    return luaL_error( L, "spi DMA failed" );
+  }
+  return nres;
 }
 
 //---------------------------
@@ -408,8 +421,8 @@ static void _TFT_pushAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t
   ccbufPushUint16(y1+rowstart); // YEND
 }
 
-//----------------------------------------------------
-static void _TFT_pushColorRep(uint16_t x0, uint16_t y0,
+//--------------------------------------------------------
+static void _TFT_pushColorRepLcd(uint16_t x0, uint16_t y0,
                        uint16_t x1, uint16_t y1,
                        uint16_t color, uint32_t rep) {
 
@@ -425,6 +438,194 @@ static void _TFT_pushColorRep(uint16_t x0, uint16_t y0,
   ccbufFlash(32);
 }
 
+// === Off-screen framebuffer =================================================
+// When enabled with lcd.fb() all drawing inside the framebuffer tile only
+// touches RAM and records a dirty rectangle; lcd.flush() then sends the dirty
+// rectangles as a few large RAMWR blocks instead of one address window per pixel.
+// Drawing outside the tile still goes directly to the display.
+
+#define FB_DIRTY_MAX   8     // dirty rectangles kept before forced merging
+#define FB_MERGE_SLACK 32    // pixels, about the cost of one extra address window
+#define FB_XFER_SIZE   2048  // bytes per SPI transfer, must hold one 320 pixel row
+
+typedef struct {
+  uint16_t *buf;             // pixels, stored in display (big endian) byte order
+  uint8_t  *xfer;            // transfer buffer used by flush
+  int16_t  x, y;             // tile position on screen
+  uint16_t w, h;             // tile size
+  uint8_t  ndirty;
+  dispWin_t dirty[FB_DIRTY_MAX];
+} lcdFb_t;
+
+static lcdFb_t lcdFb = { .buf = NULL, .xfer = NULL, .ndirty = 0 };
+
+//-----------------------------------------------------------------------
+static uint32_t _fb_area(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+  return (uint32_t)(x2-x1+1) * (uint32_t)(y2-y1+1);
+}
+
+// Add the rectangle (tile coordinates) to the dirty list, merging it with
+// an existing one when the bounding box wastes less than one address window
+//---------------------------------------------------------------------
+static void _fb_markDirty(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+  dispWin_t *d;
+  uint16_t bx1, by1, bx2, by2;
+  uint32_t waste, best_waste = 0xFFFFFFFF;
+  int i, best = -1;
+
+  for (i=0; i<lcdFb.ndirty; i++) {
+    d = &lcdFb.dirty[i];
+    bx1 = (x1 < d->x1) ? x1 : d->x1;
+    by1 = (y1 < d->y1) ? y1 : d->y1;
+    bx2 = (x2 > d->x2) ? x2 : d->x2;
+    by2 = (y2 > d->y2) ? y2 : d->y2;
+    waste = _fb_area(bx1, by1, bx2, by2) - _fb_area(d->x1, d->y1, d->x2, d->y2);
+    if (waste < best_waste) {
+      best_waste = waste;
+      best = i;
+    }
+  }
+
+  if ((best < 0) || ((best_waste > _fb_area(x1, y1, x2, y2) + FB_MERGE_SLACK) && (lcdFb.ndirty < FB_DIRTY_MAX))) {
+    d = &lcdFb.dirty[lcdFb.ndirty++];
+    d->x1 = x1; d->y1 = y1; d->x2 = x2; d->y2 = y2;
+    return;
+  }
+
+  d = &lcdFb.dirty[best];
+  if (x1 < d->x1) d->x1 = x1;
+  if (y1 < d->y1) d->y1 = y1;
+  if (x2 > d->x2) d->x2 = x2;
+  if (y2 > d->y2) d->y2 = y2;
+}
+
+// Fill the part of the rectangle inside the tile, the parts outside
+// are sent to the display. Returns 0 if the rectangle misses the tile.
+//------------------------------------------------------------------------------------
+static uint8_t _fb_fillRect(int x0, int y0, int x1, int y1, uint16_t color) {
+  int fx0 = lcdFb.x, fy0 = lcdFb.y;
+  int fx1 = lcdFb.x + lcdFb.w - 1, fy1 = lcdFb.y + lcdFb.h - 1;
+  int cx0, cy0, cx1, cy1, x, y;
+  uint16_t pix = (color >> 8) | (color << 8);
+  uint16_t *row;
+
+  if ((x1 < x0) || (y1 < y0)) return 1; // empty, a span of width 0
+  if ((x1 < fx0) || (x0 > fx1) || (y1 < fy0) || (y0 > fy1)) return 0;
+
+  cx0 = (x0 < fx0) ? fx0 : x0;
+  cy0 = (y0 < fy0) ? fy0 : y0;
+  cx1 = (x1 > fx1) ? fx1 : x1;
+  cy1 = (y1 > fy1) ? fy1 : y1;
+
+  // pieces outside the tile: full width above/below, clipped left/right
+  if (y0 < cy0) _TFT_pushColorRepLcd(x0, y0, x1, cy0-1, color, (uint32_t)(x1-x0+1)*(cy0-y0));
+  if (y1 > cy1) _TFT_pushColorRepLcd(x0, cy1+1, x1, y1, color, (uint32_t)(x1-x0+1)*(y1-cy1));
+  if (x0 < cx0) _TFT_pushColorRepLcd(x0, cy0, cx0-1, cy1, color, (uint32_t)(cx0-x0)*(cy1-cy0+1));
+  if (x1 > cx1) _TFT_pushColorRepLcd(cx1+1, cy0, x1, cy1, color, (uint32_t)(x1-cx1)*(cy1-cy0+1));
+
+  cx0 -= fx0; cx1 -= fx0;
+  cy0 -= fy0; cy1 -= fy0;
+  for (y=cy0; y<=cy1; y++) {
+    row = &lcdFb.buf[y*lcdFb.w];
+    for (x=cx0; x<=cx1; x++) row[x] = pix;
+  }
+  _fb_markDirty(cx0, cy0, cx1, cy1);
+  return 1;
+}
+
+// Copy one line of display ordered pixels into the tile.
+// Returns 0 if the line is not completely inside the tile.
+//----------------------------------------------------------------
+static uint8_t _fb_writeLine(int x, int y, int n, uint8_t *data) {
+  if ((lcdFb.buf == NULL) || (x < lcdFb.x) || (y < lcdFb.y) ||
+      ((x+n) > (lcdFb.x+lcdFb.w)) || (y >= (lcdFb.y+lcdFb.h))) return 0;
+
+  memcpy(&lcdFb.buf[(y-lcdFb.y)*lcdFb.w + (x-lcdFb.x)], data, n*2);
+  _fb_markDirty(x-lcdFb.x, y-lcdFb.y, x-lcdFb.x+n-1, y-lcdFb.y);
+  return 1;
+}
+
+//-------------------------------------------------------------------------
+static uint8_t *_fb_pushCmd(uint8_t *p, uint8_t cmd, uint16_t ndata, uint32_t rep) {
+  *p++ = cmd;
+  *p++ = (uint8_t)(ndata >> 8);
+  *p++ = (uint8_t)(ndata & 0x00FF);
+  *p++ = (uint8_t)(rep >> 24);
+  *p++ = (uint8_t)(rep >> 16);
+  *p++ = (uint8_t)(rep >> 8);
+  *p++ = (uint8_t)(rep & 0x000000FF);
+  return p;
+}
+
+// Send all dirty rectangles, each as bands of whole rows with one
+// address window and one RAMWR block per band. Returns pixels sent.
+//------------------------------
+static uint32_t _fb_flush(void) {
+  dispWin_t *d;
+  uint8_t *p;
+  uint16_t w, rows, nrows, r;
+  uint16_t sx, sy;
+  uint32_t sent = 0;
+  int i;
+
+  if ((lcdFb.buf == NULL) || (TFT_SPI_ID > 2)) return 0;
+
+  ccbufSend();
+  for (i=0; i<lcdFb.ndirty; i++) {
+    d = &lcdFb.dirty[i];
+    w = d->x2 - d->x1 + 1;
+    rows = (FB_XFER_SIZE - 30) / (w*2);  // 3 command headers, 8 address bytes, terminator
+    for (r=d->y1; r<=d->y2; r+=nrows) {
+      nrows = d->y2 - r + 1;
+      if (nrows > rows) nrows = rows;
+      sx = lcdFb.x + d->x1;
+      sy = lcdFb.y + r;
+
+      p = lcdFb.xfer;
+      p = _fb_pushCmd(p, TFT_CASET, 4, 1);
+      *p++ = (uint8_t)((sx+colstart) >> 8);     *p++ = (uint8_t)(sx+colstart);
+      *p++ = (uint8_t)((sx+w-1+colstart) >> 8); *p++ = (uint8_t)(sx+w-1+colstart);
+      p = _fb_pushCmd(p, TFT_RASET, 4, 1);
+      *p++ = (uint8_t)((sy+rowstart) >> 8);         *p++ = (uint8_t)(sy+rowstart);
+      *p++ = (uint8_t)((sy+nrows-1+rowstart) >> 8); *p++ = (uint8_t)(sy+nrows-1+rowstart);
+      p = _fb_pushCmd(p, TFT_RAMWR, w*2*nrows, 1);
+      if (w == lcdFb.w) {
+        // full tile width: the rows are contiguous
+        memcpy(p, &lcdFb.buf[r*lcdFb.w], w*2*nrows);
+        p += w*2*nrows;
+      }
+      else {
+        for (uint16_t n=0; n<nrows; n++) {
+          memcpy(p, &lcdFb.buf[(r+n)*lcdFb.w + d->x1], w*2);
+          p += w*2;
+        }
+      }
+      *p = 0;
+      _LcdSpiTransfer(lcdFb.xfer, p - lcdFb.xfer);
+      sent += (uint32_t)w * nrows;
+    }
+  }
+  lcdFb.ndirty = 0;
+  return sent;
+}
+
+//---------------------------
+static void _fb_free(void) {
+  if (lcdFb.buf != NULL) free(lcdFb.buf);
+  if (lcdFb.xfer != NULL) free(lcdFb.xfer);
+  lcdFb.buf = NULL;
+  lcdFb.xfer = NULL;
+  lcdFb.ndirty = 0;
+}
+
+//----------------------------------------------------
+static void _TFT_pushColorRep(uint16_t x0, uint16_t y0,
+                       uint16_t x1, uint16_t y1,
+                       uint16_t color, uint32_t rep) {
+  if ((lcdFb.buf != NULL) && (_fb_fillRect(x0, y0, x1, y1, color))) return;
+  _TFT_pushColorRepLcd(x0, y0, x1, y1, color, rep);
+}
+
 // Push control command to buffer
 //----------------------------------------------------
 static void TFT_sendCmd(uint8_t cmd, uint16_t ndata) {
@@ -1658,6 +1859,8 @@ static int lcd_init( lua_State* L )
   TFT_type = 0;
   
   TFT_SPI_ID = id;
+  lcd_spi_err = 0;
+  _fb_free();
   TFT_setFont(SMALL_FONT);
   _fg = TFT_GREEN;
   _bg = TFT_BLACK;
@@ -1679,7 +1882,7 @@ static int lcd_init( lua_State* L )
   _initvar();
   
   lua_pushinteger( L, 0 );
-  return 1;
+  return _lcd_spi_result( L, 1 );
 }
 
 //======================================
@@ -1688,10 +1891,11 @@ static int lcd_setorient( lua_State* L )
   if (TFT_SPI_ID > 2) return 0;
   
   orientation = luaL_checkinteger( L, 1 );
+  _fb_free(); // tile coordinates are no longer valid
   TFT_setRotation(orientation);
   TFT_fillScreen(_bg);
   
-  return 0;
+  return _lcd_spi_result( L, 0 );
 }
 
 //==================================
@@ -1706,7 +1910,7 @@ static int lcd_clear( lua_State* L )
   _bg = color;
   _initvar();
 
-  return 0;
+  return _lcd_spi_result( L, 0 );
 }
 
 //===================================
@@ -1716,7 +1920,7 @@ static int lcd_invert( lua_State* L )
   
   uint16_t inv = luaL_checkinteger( L, 1 );
   TFT_invertDisplay(inv);
-  return 0;
+  return _lcd_spi_result( L, 0 );
 }
 
 //====================================
@@ -1839,7 +2043,7 @@ static int lcd_on( lua_State* L )
   initccbuf();
   TFT_sendCmd(TFT_DISPON,0);
   ccbufSend();
-  return 0;
+  return _lcd_spi_result( L, 0 );
 }
 
 //================================
@@ -1849,7 +2053,7 @@ static int lcd_off( lua_State* L )
   initccbuf();
   TFT_sendCmd(TFT_DISPOFF,0);
   ccbufSend();
-  return 0;
+  return _lcd_spi_result( L, 0 );
 }
 
 //=====================================
@@ -1918,7 +2122,7 @@ static int lcd_putpixel( lua_State* L )
   TFT_drawPixel(x,y,color);
   ccbufSend(); // Flush buffer
   
-  return 0;
+  return _lcd_spi_result( L, 0 );
 }
 
 //=================================
@@ -1933,7 +2137,7 @@ static int lcd_line( lua_State* L )
   uint16_t x1 = luaL_checkinteger( L, 3 );
   uint16_t y1 = luaL_checkinteger( L, 4 );
   TFT_drawLine(x0,y0,x1,y1,color);
-  return 0;
+  return _lcd_spi_result( L, 0 );
 }
 
 //=================================
@@ -1950,7 +2154,7 @@ static int lcd_rect( lua_State* L )
   uint16_t color = getColor( L, 5 );
   if (lua_gettop(L) > 5) TFT_fillRect(x,y,w,h,fillcolor);
   if (fillcolor != color) TFT_drawRect(x,y,w,h,color);
-  return 0;
+  return _lcd_spi_result( L, 0 );
 }
 
 //=================================
@@ -1966,7 +2170,7 @@ static int lcd_circle( lua_State* L )
   uint16_t color = getColor( L, 4 );
   if (lua_gettop(L) > 4) TFT_fillCircle(x,y,r,fillcolor);
   if (fillcolor != color) TFT_drawCircle(x,y,r,color);
-  return 0;
+  return _lcd_spi_result( L, 0 );
 }
 
 //=====================================
@@ -1985,7 +2189,7 @@ static int lcd_triangle( lua_State* L )
   uint16_t color = getColor( L, 7 );
   if (lua_gettop(L) > 7) TFT_fillTriangle(x0,y0,x1,y1,x2,y2,fillcolor);
   if (fillcolor != color) TFT_drawTriangle(x0,y0,x1,y1,x2,y2,color);
-  return 0;
+  return _lcd_spi_result( L, 0 );
 }
 
 //lcd.write(x,y,string|intnum|{floatnum,dec},...)
@@ -2040,7 +2244,7 @@ static int lcd_write( lua_State* L )
       y = TFT_Y;
     }
   }  
-  return 0;
+  return _lcd_spi_result( L, 0 );
 }
 
 /*
@@ -2112,7 +2316,13 @@ static int lcd_image( lua_State* L )
     _TFT_pushAddrWindow(x, y, xendsize, y);
     
     xrd = SPIFFS_read(&fs, (spiffs_file)file_fd, &buf[ccbufPtr+7], 2*xsize);
-    if (xrd == 2*xsize) {
+    if ((xrd == 2*xsize) && (_fb_writeLine(x, y, xendsize-x+1, &buf[ccbufPtr+7]))) {
+      initccbuf();
+      y++;
+      if (y < _height) ysize--;
+      else ysize = 0;
+    }
+    else if (xrd == 2*xsize) {
       ccbufPushByte(TFT_RAMWR);
       ccbufPushUint16(xrd);
       ccbufPushLong(1);
@@ -2126,17 +2336,127 @@ static int lcd_image( lua_State* L )
       else ysize = 0;
     }
     else xrd = 0;
-  }while ((xrd > 0) && (ysize > 0));
+  }while ((xrd > 0) && (ysize > 0) && (lcd_spi_err == 0));
   
   if (FILE_NOT_OPENED != file_fd) {
     SPIFFS_close(&fs, file_fd);
     file_fd = FILE_NOT_OPENED;
   }
   
-  return 0;
+  return _lcd_spi_result( L, 0 );
 }
 
 
+// lcd.fb(1 [,x,y,w,h]) enables the off-screen framebuffer for the whole screen
+// or for the given tile; lcd.fb(0) frees it
+//===============================
+static int lcd_fb( lua_State* L )
+{
+  if (TFT_SPI_ID > 2) return 0;
+
+  uint8_t on = luaL_checkinteger( L, 1 );
+  int x = 0, y = 0, w = _width, h = _height;
+
+  if (lua_gettop(L) > 4) {
+    x = luaL_checkinteger( L, 2 );
+    y = luaL_checkinteger( L, 3 );
+    w = luaL_checkinteger( L, 4 );
+    h = luaL_checkinteger( L, 5 );
+  }
+
+  _fb_free();
+  if (on == 0) {
+    lua_pushinteger( L, 0 );
+    return 1;
+  }
+
+  if ((x < 0) || (y < 0) || (w <= 0) || (h <= 0) || ((x+w) > _width) || ((y+h) > _height)) {
+    l_message( NULL, "framebuffer outside the screen" );
+    lua_pushinteger( L, -1 );
+    return 1;
+  }
+
+  lcdFb.buf = (uint16_t*)malloc(w*h*2);
+  lcdFb.xfer = (uint8_t*)malloc(FB_XFER_SIZE);
+  if ((lcdFb.buf == NULL) || (lcdFb.xfer == NULL)) {
+    _fb_free();
+    l_message( NULL, "not enough memory for framebuffer" );
+    lua_pushinteger( L, -2 );
+    return 1;
+  }
+  lcdFb.x = x;
+  lcdFb.y = y;
+  lcdFb.w = w;
+  lcdFb.h = h;
+  // start with the background color, the screen content is not read back
+  _fb_fillRect(x, y, x+w-1, y+h-1, _bg);
+  lcdFb.ndirty = 0;
+
+  lua_pushinteger( L, 0 );
+  return 1;
+}
+
+// Send the dirty parts of the framebuffer, returns the number of pixels sent
+//==================================
+static int lcd_flush( lua_State* L )
+{
+  lua_pushinteger( L, _fb_flush() );
+  return _lcd_spi_result( L, 1 );
+}
+
+// Save the framebuffer tile as binary PPM image
+//===================================
+static int lcd_fbsave( lua_State* L )
+{
+  const char *fname;
+  size_t len;
+  char hdr[24];
+  uint8_t rgb[3*32];
+  uint16_t pix;
+  int i, n, err = 0;
+
+  if (lcdFb.buf == NULL) {
+    l_message( NULL, "framebuffer not enabled" );
+    lua_pushinteger( L, -1 );
+    return 1;
+  }
+
+  fname = luaL_checklstring( L, 1, &len );
+  char fullname[SPIFFS_OBJ_NAME_LEN] = {0};
+  if (checkFileName(len, fname, fullname, 1, 0) != 1) {
+    l_message( NULL, "Bad file name" );
+    lua_pushinteger( L, -1 );
+    return 1;
+  }
+
+  spiffs_file file_fd = SPIFFS_open(&fs, fullname, SPIFFS_CREAT|SPIFFS_TRUNC|SPIFFS_WRONLY, 0);
+  if (file_fd <= FILE_NOT_OPENED) {
+    l_message( NULL, "Error opening file" );
+    lua_pushinteger( L, -2 );
+    return 1;
+  }
+
+  len = sprintf(hdr, "P6\n%d %d\n255\n", lcdFb.w, lcdFb.h);
+  if (SPIFFS_write(&fs, file_fd, hdr, len) < 0) err = 1;
+
+  for (i=0; (i < lcdFb.w*lcdFb.h) && (err == 0); i += n) {
+    n = lcdFb.w*lcdFb.h - i;
+    if (n > 32) n = 32;
+    for (int j=0; j<n; j++) {
+      pix = lcdFb.buf[i+j];
+      pix = (pix >> 8) | (pix << 8);
+      rgb[j*3]   = (pix >> 8) & 0xF8;
+      rgb[j*3+1] = (pix >> 3) & 0xFC;
+      rgb[j*3+2] = (pix << 3) & 0xF8;
+    }
+    if (SPIFFS_write(&fs, file_fd, rgb, n*3) < 0) err = 1;
+  }
+  SPIFFS_close(&fs, file_fd);
+
+  lua_pushinteger( L, (err) ? -3 : 0 );
+  return 1;
+}
+
 
 #define MIN_OPT_LEVEL       2
 #include "lrodefs.h"
@@ -2166,6 +2486,9 @@ const LUA_REG_TYPE lcd_map[] =
   { LSTRKEY( "triangle" ), LFUNCVAL( lcd_triangle )},
   { LSTRKEY( "write" ), LFUNCVAL( lcd_write )},
   { LSTRKEY( "image" ), LFUNCVAL( lcd_image )},
+  { LSTRKEY( "fb" ), LFUNCVAL( lcd_fb )},
+  { LSTRKEY( "flush" ), LFUNCVAL( lcd_flush )},
+  { LSTRKEY( "fbsave" ), LFUNCVAL( lcd_fbsave )},
   { LSTRKEY( "hsb2rgb" ), LFUNCVAL( lcd_HSBtoRGB )},
   
 #if LUA_OPTIMIZE_MEMORY > 0
@@ -6,6 +6,8 @@
 #include "lauxlib.h"
 #include "lualib.h"
 #include "lrotable.h"
+#include "lopcodes.h"
+#include "lprofile.h"
    
 #include "mico_platform.h"
 #include "platform.h"
@@ -366,9 +368,13 @@ static int mcu_memory( lua_State* L )
 static int mcu_chipid( lua_State* L )
 {
     uint32_t mcuID[3];
+#ifdef MICO_HOST_PLATFORM
+    platform_host_chip_id(mcuID);
+#else
     mcuID[0] = *(__IO uint32_t*)(0x1FFF7A20);
     mcuID[1] = *(__IO uint32_t*)(0x1FFF7A24);
     mcuID[2] = *(__IO uint32_t*)(0x1FFF7A28);
+#endif
     char str[25];
     sprintf(str,"%08X%08X%08X",mcuID[0],mcuID[1],mcuID[2]);
     lua_pushstring(L,str);
@@ -426,6 +432,92 @@ static int mcu_bootreason( lua_State* L )
     return 1;
 }
 
+//===================================
+static mico_timer_t _prof_timer;
+static bool _prof_timer_running = false;
+
+static void _prof_timer_handler( void* arg )
+{
+  lua_proftick();
+}
+
+static void _prof_timer_stop( void )
+{
+  if (_prof_timer_running) {
+    mico_stop_timer(&_prof_timer);
+    mico_deinit_timer(&_prof_timer);
+    _prof_timer_running = false;
+  }
+}
+
+// mcu.profile("start" [,ms])  sample the stack every ms milliseconds, default 10
+// mcu.profile("stop")         returns samples, dropped
+// mcu.profile()               print the stacks in collapsed form, "a;b;c 12"
+// mcu.profile("stacks")       table of collapsed stack -> samples
+// mcu.profile("opcodes")      table of opcode name -> count, total count
+// mcu.profile("reset")        stop and free the stack table
+static int mcu_profile( lua_State* L )
+{
+  const char *cmd = luaL_optstring( L, 1, "dump" );
+  const char *stack;
+  unsigned long count, dropped, total;
+  int i, ms;
+
+  if (strcmp(cmd, "start") == 0) {
+    ms = luaL_optinteger( L, 2, 10 );
+    if (ms < 1) return luaL_error( L, "interval wrong" );
+    _prof_timer_stop();
+    lua_profstart(L);
+    mico_init_timer(&_prof_timer, ms, _prof_timer_handler, NULL);
+    mico_start_timer(&_prof_timer);
+    _prof_timer_running = true;
+    return 0;
+  }
+  else if (strcmp(cmd, "stop") == 0) {
+    _prof_timer_stop();
+    lua_profstop(L);
+    lua_pushinteger(L, lua_profsamples(&dropped));
+    lua_pushinteger(L, dropped);
+    return 2;
+  }
+  else if (strcmp(cmd, "dump") == 0) {
+    for (i = 0; (stack = lua_profstack(i, &count)) != NULL; i++)
+      printf("%s %lu\r\n", stack, count);
+    lua_profsamples(&dropped);
+    if (dropped > 0)
+      printf("[dropped] %lu\r\n", dropped);
+    return 0;
+  }
+  else if (strcmp(cmd, "stacks") == 0) {
+    lua_newtable( L );
+    for (i = 0; (stack = lua_profstack(i, &count)) != NULL; i++) {
+      lua_getfield( L, -1, stack );   // a cut stack can match a whole one
+      lua_pushinteger(L, count + (unsigned long)lua_tointeger(L, -1));
+      lua_setfield( L, -3, stack );
+      lua_pop(L, 1);
+    }
+    return 1;
+  }
+  else if (strcmp(cmd, "opcodes") == 0) {
+    lua_newtable( L );
+    for (i = 0, total = 0; i < NUM_OPCODES; i++) {
+      count = lua_profopcount(i);
+      total += count;
+      if (count == 0) continue;
+      lua_pushinteger(L, count);
+      lua_setfield( L, -2, luaP_opnames[i] );
+    }
+    lua_pushinteger(L, total);
+    return 2;
+  }
+  else if (strcmp(cmd, "reset") == 0) {
+    _prof_timer_stop();
+    lua_profreset(L);
+    return 0;
+  }
+  return luaL_error( L, "start, stop, dump, stacks, opcodes or reset" );
+}
+
 #define MIN_OPT_LEVEL       2
 #include "lrodefs.h"
 const LUA_REG_TYPE mcu_map[] =
@@ -441,6 +533,7 @@ const LUA_REG_TYPE mcu_map[] =
   { LSTRKEY( "setparams" ), LFUNCVAL(set_sparams)},
   //{ LSTRKEY( "queuepush" ), LFUNCVAL(queue_push)},
   { LSTRKEY( "random" ), LFUNCVAL(mcu_random)},
+  { LSTRKEY( "profile" ), LFUNCVAL(mcu_profile)},
 #if LUA_OPTIMIZE_MEMORY > 0
 #endif      
   {LNILKEY, LNILVAL}
@@ -16,9 +16,19 @@
 #include "MQTTClient.h"
 
 #define MQTT_CMD_TIMEOUT 5000  // 5s
-#define MQTT_YIELD_TMIE  1000  // 1s
+#define MQTT_YIELD_TMIE  20    // drain time once a socket is readable
+#define MQTT_RETRY_TIME  1000  // 1s between reconnect attempts
+#define MQTT_WAIT_FOREVER 0xFFFFFFFF
 #define MAX_MQTT_NUM     3
 
+// Subscription filters, one node per topic level; "+" and "#" are stored as levels
+typedef struct topicNode {
+  struct topicNode *child;
+  struct topicNode *next;
+  uint8_t  subs;        // filters ending at this level
+  char     level[];
+} topicNode_t;
+
 typedef struct {
   Client  c;
   Network n;
@@ -34,6 +44,8 @@ typedef struct {
   bool     reqPublish;
   bool     req_goto_disconect;
   uint32_t keepaliveTick;
+  uint32_t retryTick;
+  topicNode_t *topics;
   int      qos;
   char     *pTopic[MAX_MESSAGE_HANDLERS];
   char     *pPubTopic;
@@ -51,65 +63,219 @@ static bool mqtt_debug             = false;
 static bool mqtt_thread_is_started = false;
 static lua_State *gL               = NULL;
 static uint8_t max_conn_retry      = 10;
+static mico_semaphore_t mqtt_wakeup_sem = NULL;
+static int mqtt_wakeup_fd          = -1;
 
 #define mqtt_log(M, ...) if (mqtt_debug == true) printf(M, ##__VA_ARGS__)
 //#define mqtt_log(M, ...) printf(M, ##__VA_ARGS__)
 //#define mqtt_log(M, ...)
 
-//-----------------------------------------
-static void messageArrived(MessageData* md)
+//-----------------------------------------------------------
+static size_t _topic_level_len(const char *topic, const char **next)
+{
+  const char *end = strchr(topic, '/');
+  if (end == NULL) {
+    *next = NULL;
+    return strlen(topic);
+  }
+  *next = end+1;
+  return end - topic;
+}
+
+// check wildcard placement: '+' and '#' must fill a level, '#' must be last
+//------------------------------------------
+static bool _topic_filter_valid(const char *filter)
+{
+  const char *level = filter;
+  const char *next;
+  size_t len;
+
+  if (*filter == '\0') return false;
+  do {
+    len = _topic_level_len(level, &next);
+    for (size_t k=0; k<len; k++) {
+      if ((level[k] == '+') || (level[k] == '#')) {
+        if (len != 1) return false;
+        if ((level[k] == '#') && (next != NULL)) return false;
+      }
+    }
+    level = next;
+  } while (level != NULL);
+  return true;
+}
+
+//------------------------------------------------------------
+static void _topic_insert(topicNode_t **list, const char *filter)
+{
+  const char *next;
+  topicNode_t *n;
+
+  while (1) {
+    size_t len = _topic_level_len(filter, &next);
+    for (n = *list; n != NULL; n = n->next) {
+      if ((strlen(n->level) == len) && (memcmp(n->level, filter, len) == 0)) break;
+    }
+    if (n == NULL) {
+      n = (topicNode_t*)malloc(sizeof(topicNode_t)+len+1);
+      if (n == NULL) return;
+      memcpy(n->level, filter, len);
+      n->level[len] = '\0';
+      n->subs = 0;
+      n->child = NULL;
+      n->next = *list;
+      *list = n;
+    }
+    if (next == NULL) {
+      n->subs++;
+      return;
+    }
+    list = &(n->child);
+    filter = next;
+  }
+}
+
+// remove one filter, prune the levels left without subscriptions
+//------------------------------------------------------------
+static void _topic_remove(topicNode_t **list, const char *filter)
+{
+  const char *next;
+  size_t len = _topic_level_len(filter, &next);
+  topicNode_t *n;
+
+  for (; *list != NULL; list = &((*list)->next)) {
+    n = *list;
+    if ((strlen(n->level) != len) || (memcmp(n->level, filter, len) != 0)) continue;
+
+    if (next == NULL) {
+      if (n->subs > 0) n->subs--;
+    }
+    else _topic_remove(&(n->child), next);
+
+    if ((n->subs == 0) && (n->child == NULL)) {
+      *list = n->next;
+      free(n);
+    }
+    return;
+  }
+}
+
+//---------------------------------------
+static void _topic_free(topicNode_t *list)
+{
+  topicNode_t *n;
+  while (list != NULL) {
+    n = list;
+    list = list->next;
+    _topic_free(n->child);
+    free(n);
+  }
+}
+
+// true if any subscribed filter matches the topic
+// wildcards at the first level do not match topics starting with '$'
+//----------------------------------------------------------------------
+static bool _topic_match(topicNode_t *list, const char *topic, bool first)
+{
+  const char *next;
+  size_t len = _topic_level_len(topic, &next);
+  bool wild = !(first && (*topic == '$'));
+  topicNode_t *n, *c;
+
+  for (n = list; n != NULL; n = n->next) {
+    if ((n->level[0] == '#') && (n->level[1] == '\0')) {
+      if (wild) return true;
+      continue;
+    }
+    if ((wild && (n->level[0] == '+') && (n->level[1] == '\0')) ||
+        ((strlen(n->level) == len) && (memcmp(n->level, topic, len) == 0))) {
+      if (next == NULL) {
+        if (n->subs > 0) return true;
+        // "a/#" also matches "a"
+        for (c = n->child; c != NULL; c = c->next) {
+          if ((c->level[0] == '#') && (c->level[1] == '\0')) return true;
+        }
+      }
+      else if (_topic_match(n->child, next, false)) return true;
+    }
+  }
+  return false;
+}
+
+//-------------------------------------------------
+static void messageArrived(int id, MessageData* md)
 {
   char* topic; 
   int   tlen;
   
+  if (pmqtt[id] == NULL) return;
+  if (pmqtt[id]->cb_ref_message == LUA_NOREF) return;
+
   //mqtt_log("[mqtt>>] FreeMem=%d\r\n",MicoGetMemoryInfo()->free_memory);
   tlen = md->topicName->lenstring.len;
   topic = (char*)malloc(tlen+1);
+  if (topic == NULL) return;
   memcpy(topic,md->topicName->lenstring.data,tlen);
   *(topic+tlen) = '\0';
   
   MQTTMessage* message = md->message;
-  mqtt_log("[mqtt: ] messageArrived: [topic: %s] [len=%d] [%.*s]\r\n", topic,
+  mqtt_log("[mqtt:%d] messageArrived: [topic: %s] [len=%d] [%.*s]\r\n", id, topic,
            (int)message->payloadlen,
            (int)message->payloadlen, (char*)message->payload);
   
-  for (int i=0;i<MAX_MQTT_NUM;i++)
-  {
-    if (pmqtt[i] == NULL) continue;
-    if (pmqtt[i]->cb_ref_message == LUA_NOREF) continue;
+  if (!_topic_match(pmqtt[id]->topics, topic, true)) {
+    mqtt_log("[mqtt:%d] no subscription matches\r\n", id);
+  }
+  else if (mico_rtos_is_queue_full(&os_queue)) {
+    mqtt_log("[mqtt:%d] LUA Queue full!\r\n", id);
+  }
+  else {
+    // Queue messageArrived callback function
+    //----------------------------------------------------------------------
+    queue_msg_t msg;
+    msg.L = gL;
+    msg.source = onMQTTmsg;
+
+    msg.para3 = (uint8_t*)topic;
+    msg.para4 = (uint8_t*)malloc((int)message->payloadlen);
+    memcpy(msg.para4, (uint8_t*)message->payload, (int)message->payloadlen);
     
-    for (int idx=0; idx<MAX_MESSAGE_HANDLERS;idx++) {
-      if (pmqtt[i]->pTopic[idx] != NULL) {
-        if (strcmp(pmqtt[i]->pTopic[idx], topic) == 0) {
-          if (mico_rtos_is_queue_full(&os_queue)) {
-            mqtt_log("[mqtt:%d] %d LUA Queue full!\r\n", i, idx);
-          }
-          else {
-            // Queue messageArrived callback function
-            //----------------------------------------------------------------------
-            queue_msg_t msg;
-            msg.L = gL;
-            msg.source = onMQTTmsg;
-
-            msg.para3 = (uint8_t*)malloc(tlen+1);
-            msg.para4 = (uint8_t*)malloc((int)message->payloadlen);
-            memcpy(msg.para3, (uint8_t*)topic, tlen);
-            *(msg.para3+tlen) = '\0';
-            memcpy(msg.para4, (uint8_t*)message->payload, (int)message->payloadlen);
-            
-            msg.para1 = (tlen << 16) + (int)message->payloadlen;
-            msg.para2 = pmqtt[i]->cb_ref_message;
-            mico_rtos_push_to_queue( &os_queue, &msg,0);
-            //----------------------------------------------------------------------
-          }
-        }
-      }
-    }
+    msg.para1 = (tlen << 16) + (int)message->payloadlen;
+    msg.para2 = pmqtt[id]->cb_ref_message;
+    mico_rtos_push_to_queue( &os_queue, &msg,0);
+    //----------------------------------------------------------------------
+    topic = NULL;
   }
-  free(topic);
+  if (topic != NULL) free(topic);
   //mqtt_log("[mqtt>>] FreeMem=%d\r\n",MicoGetMemoryInfo()->free_memory);
 }
 
+// The client library does not tell which client a message belongs to,
+// so every client gets its own default handler (one per MAX_MQTT_NUM).
+// Topics are subscribed without a handler, all messages end up here.
+//-------------------------------------------------------------
+static void messageArrived0(MessageData* md) { messageArrived(0, md); }
+static void messageArrived1(MessageData* md) { messageArrived(1, md); }
+static void messageArrived2(MessageData* md) { messageArrived(2, md); }
+
+static const messageHandler mqtt_msg_handler[MAX_MQTT_NUM] =
+{
+  messageArrived0, messageArrived1, messageArrived2
+};
+
+// wake the mqtt thread from select() after a request was set
+//--------------------------
+static void _mqtt_wakeup(void)
+{
+  if (mqtt_wakeup_sem != NULL) mico_rtos_set_semaphore(&mqtt_wakeup_sem);
+}
+
+//---------------------------------------------------------------------
+static uint32_t _mqtt_time_left(uint32_t start, uint32_t period, uint32_t now)
+{
+  uint32_t elapsed = now - start;
+  return (elapsed >= period) ? 0 : (period - elapsed);
+}
+
 //---------------------------
 static void closeMqtt(int id)
 {
@@ -153,6 +319,7 @@ static void closeMqtt(int id)
   }
   if (pmqtt[id]->pPubTopic != NULL) free(pmqtt[id]->pPubTopic);
   if (pmqtt[id]->pData != NULL) free(pmqtt[id]->pData);
+  _topic_free(pmqtt[id]->topics);
   if (pmqtt[id]->connectData.clientID.cstring != NULL) free(pmqtt[id]->connectData.clientID.cstring);
   if (pmqtt[id]->connectData.username.cstring != NULL) free(pmqtt[id]->connectData.username.cstring);
   if (pmqtt[id]->connectData.password.cstring != NULL) free(pmqtt[id]->connectData.password.cstring);
@@ -170,16 +337,15 @@ static void _thread_mqtt(void*inContext)
  
   int rc = -1;
   fd_set readfds;
-  struct timeval_t t = {0, MQTT_YIELD_TMIE*1000};
+  struct timeval_t t;
   int i=0;
   int maxSck=0;
   uint8_t idx;
+  uint32_t now, wait, left;
   
   mqtt_log("[mqtt: ] MQTT Thread started.\r\n");
   
   while (1) {
-    mico_thread_msleep(5);
-      
     // --- Check if any active client left ---
     for (i=0; i<MAX_MQTT_NUM; i++) {
       if (pmqtt[i] !=NULL) break;
@@ -202,6 +368,10 @@ static void _thread_mqtt(void*inContext)
         //mqtt_log("[mqtt>>] FreeMem=%d\r\n",MicoGetMemoryInfo()->free_memory);
         
         if (!pmqtt[i]->c.isconnected) {
+          // space out reconnect attempts
+          if ((pmqtt[i]->conn_retry > 0) &&
+              (_mqtt_time_left(pmqtt[i]->retryTick, MQTT_RETRY_TIME, mico_get_time()) > 0)) continue;
+          pmqtt[i]->retryTick = mico_get_time();
           mqtt_log("[mqtt:%d] Creating connection [%s:%d]\r\n",i,pmqtt[i]->pServer,pmqtt[i]->port);
           rc = NewNetwork(&(pmqtt[i]->n), pmqtt[i]->pServer, pmqtt[i]->port, pmqtt[i]->ssl_settings);
           if (rc < 0) {
@@ -245,6 +415,7 @@ static void _thread_mqtt(void*inContext)
             }
             else {
               mqtt_log("[mqtt:%d] Client init OK!\r\n",i);
+              pmqtt[i]->c.defaultMessageHandler = mqtt_msg_handler[i];
               if ((pmqtt[i]->connectData.username.cstring != NULL) && (pmqtt[i]->connectData.password.cstring != NULL)) {
                 mqtt_log("         Client connecting [user: %s, pass: %s]\r\n", pmqtt[i]->connectData.username.cstring,pmqtt[i]->connectData.password.cstring);
               }
@@ -255,15 +426,17 @@ static void _thread_mqtt(void*inContext)
               if (MQTT_SUCCESS == rc) {
                 pmqtt[i]->reqStart = false;
                 pmqtt[i]->conn_retry = 0;
+                pmqtt[i]->keepaliveTick = mico_get_time();
                 
                 // resubscribe if the client was subscribet to some topics
                 for (idx=0;idx<MAX_MESSAGE_HANDLERS;idx++) {
                   if (pmqtt[i]->pTopic[idx] != NULL) {
-                    rc = MQTTSubscribe(&(pmqtt[i]->c), pmqtt[i]->pTopic[idx], (enum QoS)(pmqtt[i]->qos), messageArrived);
+                    rc = MQTTSubscribe(&(pmqtt[i]->c), pmqtt[i]->pTopic[idx], (enum QoS)(pmqtt[i]->qos), NULL);
                     if (MQTT_SUCCESS == rc) {
                       mqtt_log("         Client subscribed to topic [%s]\r\n", pmqtt[i]->pTopic[idx]);
                     }
                     else {
+                      _topic_remove(&(pmqtt[i]->topics), pmqtt[i]->pTopic[idx]);
                       free(pmqtt[i]->pTopic[idx]);
                       pmqtt[i]->pTopic[idx] = NULL;
                       mqtt_log("         Client subscribe ERROR=%d\r\n", rc);
@@ -320,8 +493,9 @@ static void _thread_mqtt(void*inContext)
         if (pmqtt[i]->reqSubscribe[idx] && (pmqtt[i]->pTopic[idx] !=NULL)) {
           if (pmqtt[i]->c.isconnected) {
             //mqtt_log("[mqtt>>] FreeMem=%d\r\n",MicoGetMemoryInfo()->free_memory);
-            rc = MQTTSubscribe(&(pmqtt[i]->c), pmqtt[i]->pTopic[idx], (enum QoS)(pmqtt[i]->qos), messageArrived);
+            rc = MQTTSubscribe(&(pmqtt[i]->c), pmqtt[i]->pTopic[idx], (enum QoS)(pmqtt[i]->qos), NULL);
             if (MQTT_SUCCESS == rc) {
+              _topic_insert(&(pmqtt[i]->topics), pmqtt[i]->pTopic[idx]);
               mqtt_log("[mqtt:%d] Client subscribed to topic [%s]\r\n", i, pmqtt[i]->pTopic[idx]);
             }
             else {
@@ -353,6 +527,7 @@ static void _thread_mqtt(void*inContext)
               pmqtt[i]->req_goto_disconect=true;
               mqtt_log("[mqtt:%d] Client unsubscribe ERROR=%d\r\n", i, rc);
             }
+            _topic_remove(&(pmqtt[i]->topics), pmqtt[i]->pTopic[idx]);
             free(pmqtt[i]->pTopic[idx]);
             pmqtt[i]->pTopic[idx] = NULL;
             //mqtt_log("[mqtt>>] FreeMem=%d\r\n",MicoGetMemoryInfo()->free_memory);
@@ -404,26 +579,48 @@ static void _thread_mqtt(void*inContext)
       }
     }
     
-    // --- Check connected clients ---
-    for (i=0;i<MAX_MQTT_NUM;i++) {
-      if ((pmqtt[i] != NULL) && (pmqtt[i]->c.isconnected)) break;
-    }
-    //if (i == MAX_MQTT_NUM) return; // no connected clients
-    if (i == MAX_MQTT_NUM) continue; // no connected clients
-    
-    // --- there is at least 1 active&connected client ---
+    // --- Wait for socket data, a request from lua or the next deadline ---
     FD_ZERO(&readfds);
+    FD_SET(mqtt_wakeup_fd, &readfds);
+    maxSck = mqtt_wakeup_fd;
+    wait = MQTT_WAIT_FOREVER;
+    now = mico_get_time();
     for (i=0;i<MAX_MQTT_NUM;i++)
     {
       if (pmqtt[i] == NULL) continue;
-      if (!pmqtt[i]->c.isconnected) continue;
-      
-      FD_SET(pmqtt[i]->c.ipstack->my_socket, &readfds);
-      if (pmqtt[i]->c.ipstack->my_socket > maxSck) 
-           maxSck = pmqtt[i]->c.ipstack->my_socket;
+      if (pmqtt[i]->req_goto_disconect) {
+        // a request failed above, reconnect without waiting
+        left = 0;
+      }
+      else if (pmqtt[i]->c.isconnected) {
+        FD_SET(pmqtt[i]->c.ipstack->my_socket, &readfds);
+        if (pmqtt[i]->c.ipstack->my_socket > maxSck) 
+             maxSck = pmqtt[i]->c.ipstack->my_socket;
+        left = _mqtt_time_left(pmqtt[i]->keepaliveTick, pmqtt[i]->connectData.keepAliveInterval*1000, now);
+      }
+      else if (pmqtt[i]->reqStart) {
+        left = _mqtt_time_left(pmqtt[i]->retryTick, MQTT_RETRY_TIME, now);
+      }
+      else continue;
+      if (left < wait) wait = left;
     }
     
-    select(maxSck+1, &readfds, NULL, NULL, &t);
+    if (wait == MQTT_WAIT_FOREVER) {
+      rc = select(maxSck+1, &readfds, NULL, NULL, NULL);
+    }
+    else {
+      t.tv_sec = wait / 1000;
+      t.tv_usec = (wait % 1000) * 1000;
+      rc = select(maxSck+1, &readfds, NULL, NULL, &t);
+    }
+    if (rc < 0) {
+      mqtt_log("[mqtt: ] select ERROR=%d\r\n", rc);
+      FD_ZERO(&readfds);
+      mico_thread_msleep(100);
+    }
+    if (FD_ISSET(mqtt_wakeup_fd, &readfds)) {
+      mico_rtos_get_semaphore(&mqtt_wakeup_sem, 0);
+    }
     
     for (i=0;i<MAX_MQTT_NUM;i++)
     {
@@ -435,19 +632,19 @@ static void _thread_mqtt(void*inContext)
         if (MQTT_SUCCESS != rc) {
           mqtt_log("[mqtt:%d] Yield ERROR\r\n", i);
           pmqtt[i]->req_goto_disconect = true;
+          continue;
         }
       }
-      else{ // if MQTTYield was not called periodical, we need to check ping msg to keep alive.
-        if ((mico_get_time() - pmqtt[i]->keepaliveTick) > (pmqtt[i]->connectData.keepAliveInterval*1000))
-          {
-            pmqtt[i]->keepaliveTick = mico_get_time();
-            rc = keepalive(&(pmqtt[i]->c));
-            if (MQTT_SUCCESS != rc) {
-              mqtt_log("[mqtt:%d] KeepaliveTick ERROR\r\n", i);
-              pmqtt[i]->req_goto_disconect=true;
-            }
-          }
+      // keepalive deadline
+      if (_mqtt_time_left(pmqtt[i]->keepaliveTick, pmqtt[i]->connectData.keepAliveInterval*1000, mico_get_time()) == 0)
+      {
+        pmqtt[i]->keepaliveTick = mico_get_time();
+        rc = keepalive(&(pmqtt[i]->c));
+        if (MQTT_SUCCESS != rc) {
+          mqtt_log("[mqtt:%d] KeepaliveTick ERROR\r\n", i);
+          pmqtt[i]->req_goto_disconect=true;
         }
+      }
     }
     
     //check disconnect;
@@ -550,15 +747,6 @@ static int lmqtt_new( lua_State* L )
     return 1;
   }
 
-  if (!mqtt_thread_is_started) {
-    if (mico_rtos_create_thread(NULL, MICO_APPLICATION_PRIORITY-1, "Mqtt_Thread", _thread_mqtt, 1024, NULL) != kNoErr) {
-      l_message(NULL, "Create thread failed" );
-      lua_pushinteger(L, -4);
-      return 1;
-    }
-    else mqtt_thread_is_started = true;
-  } 
-  
   //mqtt_log("[mqtt>>] FreeMem=%d\r\n",MicoGetMemoryInfo()->free_memory);
   MQTTPacket_connectData cd = MQTTPacket_connectData_initializer;
   memcpy(&(pmqtt[k]->connectData), &cd, sizeof(MQTTPacket_connectData));
@@ -612,13 +800,30 @@ static int lmqtt_new( lua_State* L )
   pmqtt[k]->reqPublish = false;
   pmqtt[k]->req_goto_disconect = false;
   pmqtt[k]->keepaliveTick = 0;
+  pmqtt[k]->retryTick = 0;
+  pmqtt[k]->topics = NULL;
   pmqtt[k]->conn_retry = 0;
     
   memset(&(pmqtt[k]->c), 0, sizeof(pmqtt[k]->c));
   memset(&(pmqtt[k]->n), 0, sizeof(pmqtt[k]->n));
+  gL = L;
+
+  if (mqtt_wakeup_sem == NULL) {
+    mico_rtos_init_semaphore(&mqtt_wakeup_sem, 1);
+    mqtt_wakeup_fd = mico_create_event_fd(mqtt_wakeup_sem);
+  }
+
+  if (!mqtt_thread_is_started) {
+    if (mico_rtos_create_thread(NULL, MICO_APPLICATION_PRIORITY-1, "Mqtt_Thread", _thread_mqtt, 1024, NULL) != kNoErr) {
+      l_message(NULL, "Create thread failed" );
+      lua_pushinteger(L, -4);
+      return 1;
+    }
+    else mqtt_thread_is_started = true;
+  }
+
   mqtt_log("[mqtt:%d] Init: OK.\r\n", k);
   //mqtt_log("[mqtt>>] FreeMem=%d\r\n",MicoGetMemoryInfo()->free_memory);
-  gL = L;
 
   lua_pushinteger(L, k);
   return 1;
@@ -672,6 +877,7 @@ static int lmqtt_start( lua_State* L )
   pmqtt[mqttClt]->port = port;
   
   pmqtt[mqttClt]->reqStart = true;
+  _mqtt_wakeup();
 
   lua_pushinteger(L, 0);
   return 1;
@@ -811,6 +1017,7 @@ static int lmqtt_close( lua_State* L )
   }
   
   pmqtt[mqttClt]->reqClose = true;
+  _mqtt_wakeup();
 
   lua_pushinteger(L, 0);
   return 1;
@@ -827,6 +1034,7 @@ static int lmqtt_closeall( lua_State* L )
       pmqtt[i]->reqClose = true;
     }
   }
+  _mqtt_wakeup();
   return 0;
 }
 
@@ -852,7 +1060,7 @@ static int lmqtt_subscribe( lua_State* L )
 
   size_t sl = 0;
   char const *topic = luaL_checklstring( L, 2, &sl );
-  if (topic == NULL) {
+  if ((topic == NULL) || (!_topic_filter_valid(topic))) {
     l_message(NULL, "topic: wrong arg type");
     lua_pushinteger(L, -3);
     return 1;
@@ -899,6 +1107,7 @@ static int lmqtt_subscribe( lua_State* L )
 
   pmqtt[mqttClt]->qos = qos;
   pmqtt[mqttClt]->reqSubscribe[idx] = true;
+  _mqtt_wakeup();
 
   lua_pushinteger(L, 0);
   return 1;
@@ -980,6 +1189,7 @@ static int lmqtt_unsubscribe( lua_State* L )
   }
   
   pmqtt[mqttClt]->requnSubscribe[idx] = true;
+  _mqtt_wakeup();
 
   lua_pushinteger(L, 0);
   return 1;
@@ -1042,6 +1252,7 @@ static int lmqtt_publish( lua_State* L )
 
   pmqtt[mqttClt]->pDataLen = sld;
   pmqtt[mqttClt]->reqPublish = true;
+  _mqtt_wakeup();
 
   lua_pushinteger(L, 0);
   return 1;
@@ -16,6 +16,10 @@
 #include "SocketUtils.h"
 #include "mico_rtos.h"
 //#include "HTTPUtils.h"
+#include <spiffs.h>
+#include <spiffs_nucleus.h>
+#include <ctype.h>
+#include <stdlib.h>
 
 #define TCP IPPROTO_TCP
 #define UDP IPPROTO_UDP
@@ -27,11 +31,25 @@
 #define MAX_SVRCLT_SOCKET 5
 #define MAX_CLT_SOCKET 4
 
+#define MAX_UDP_SEND 975          // one datagram
+#define NET_SEND_CHUNK 1460       // one send() per writable socket and round
+#define DEF_SEND_HIGH 4096        // send queue high water mark
+#define MIN_SEND_HIGH 512
+#define MAX_SEND_HIGH (64*1024)
+#define MAX_RECV_LEN 1024         // receive pool block
+#define NET_RECV_BLOCKS 8         // blocks in the receive pool
+#define NET_RECV_QUIET 10         // ms without data that end the answer of a tcp client
+#define NET_CO_BUF 512            // receive buffer of a net.co session
+#define NET_CO_META "net.co"      // metatable of the net.co socket objects
+
 extern mico_queue_t os_queue;
 extern void luaWdgReload( void );
 
 static mico_mutex_t  net_mut = NULL; // Used to synchronize the net thread
 
+extern spiffs fs;
+extern uint8_t checkFileName(int len, const char* name, char* newname, uint8_t addcurrdir, uint8_t exists);
+
 static bool log = false;
 #define net_log(M, ...) if (log == true) printf(M, ##__VA_ARGS__)
 
@@ -39,7 +57,6 @@ enum _req_actions{
   NO_ACTION = 0,
   REQ_ACTION_GOTIP,
   REQ_ACTION_GETIP,
-  REQ_ACTION_SEND,
   REQ_ACTION_RECEIVED,
   REQ_ACTION_CONNECTED,
   REQ_ACTION_DISCONNECT,
@@ -62,12 +79,118 @@ enum _socket_state{
   SOCKET_STATE_CLOSED,
 };
 
+// A spiffs file queued by net.sendfile. The net thread opens it when it gets
+// to the head of the queue and sends it a piece (whole data pages) at a time
+typedef struct {
+  spiffs_file fd;          // 0 until opened
+  int foff;                // file offset of the next read
+  int socket;
+  int done_cb;             // done(socket, bytes)
+  int result;              // bytes for done
+  uint32_t nofd;           // time the last open found no free spiffs fd
+  char *buf;               // piece read, allocated while the file is sent
+  int blen;                // bytes in buf
+  int bpos;                // bytes of buf already sent
+  char path[SPIFFS_OBJ_NAME_LEN];
+} net_sendfile_t;
+
+// One queued send: a Lua string held by a registry reference, a buffer
+// the module built itself (ref LUA_NOREF), freed when it is released, or a
+// file (data NULL)
+typedef struct _net_sendbuf {
+  struct _net_sendbuf *next;
+  const char *data;
+  int len;
+  int ref;
+  net_sendfile_t *file;
+} net_sendbuf_t;
+
+// Send queue of a socket, the net thread sends from its head whenever the
+// socket is writable. Sent buffers go to sendq_done, the lua thread
+// releases them (the registry is only touched from there).
+typedef struct {
+  net_sendbuf_t *head;
+  net_sendbuf_t *tail;
+  int off;                 // bytes of head already sent
+  int queued;              // bytes not sent yet
+  int high;                // high water mark
+  int sent;                // bytes sent since the queue was last empty
+  uint8_t over;            // went over the high water mark, drain is due
+} net_sendq_t;
+
+// A block of the receive pool. Data is received into a block and handed to
+// the lua thread in the message (para3, the http header in para4), which
+// gives the block back (_net_recv_call). The pool is allocated once, with
+// the net thread, nothing on the receive path is malloc'ed.
+typedef struct _net_block {
+  struct _net_block *next;
+  int len;
+  char data[MAX_RECV_LEN];
+} net_block_t;
+
+enum _recv_states{
+  RECV_RAW = 0,            // data as it comes
+  RECV_HEAD,               // http: header
+  RECV_BODY,               // http: body
+};
+
+// Receive state of a tcp socket
+typedef struct {
+  net_block_t *in;         // received, processed up to pos
+  int pos;
+  net_block_t *pdata;      // message the message queue had no room for
+  net_block_t *phdr;
+  net_block_t *hdr;        // http: header received so far
+  int left;                // http: body bytes still to come, -1 up to the close
+  uint8_t state;           // RECV_...
+  uint8_t http;            // http framing: 1 requests, 2 answers
+  uint8_t done;            // http: the answer is complete
+  uint32_t last;           // client: time data last came, 0 answer complete
+} net_recv_t;
+
+enum _co_waits{
+  CO_NONE = 0,             // running
+  CO_READ,                 // sock:read(n)
+  CO_LINE,                 // sock:readline()
+  CO_WRITE,                // sock:write(s), the send queue is over its high mark
+  CO_CONNECT,              // sock:connect()
+  CO_YIELD,                // coroutine.yield(), resumed on the next round
+  CO_END,                  // the session is over, its socket being closed
+};
+
+// A net.co session: a coroutine talking on a tcp socket. Its socket calls
+// yield when they have to wait; the net thread reads into buf while the
+// session waits for data and posts a message (onNetCo) when it can go on,
+// the lua thread resumes it (_net_co_resume). The userdata is referenced
+// while the session runs, the net thread uses it by pointer.
+typedef struct _net_co {
+  struct _net_co *next;    // all sessions, co_list
+  int socket;              // INVALID_HANDLE once the socket is closed
+  net_sendq_t *sq;         // send queue of the socket, NULL once closed
+  lua_State *L;            // the coroutine, NULL when the session is over
+  int thread;              // registry reference of the coroutine
+  int self;                // and of the userdata
+  uint8_t want;            // what the coroutine waits for: CO_...
+  uint8_t posted;          // resume message in the queue
+  uint8_t closing;         // close the socket when its queue is sent
+  uint8_t connected;
+  uint8_t eof;             // no more data coming
+  int need;                // read: bytes, write: bytes written, connect: timeout
+  uint32_t since;          // connect: start time
+  int len;                 // bytes in buf
+  char buf[NET_CO_BUF];
+} net_co_t;
+
 // for server-client
 typedef struct {
   int client;              //socket type
   uint8_t clientFlag;      //sent or disconnect
   uint8_t state;           //socket connection state
-  struct sockaddr_t addr;  //ip and port 
+  struct sockaddr_t addr;  //ip and port
+  net_sendq_t sq;
+  net_recv_t rx;
+  net_co_t *co;            //net.co session, NULL if none
+  uint8_t accept_due;      //accept callback not posted yet, the message queue was full
 }_lsvrCltsocket_t;
 
 //for server
@@ -78,9 +201,12 @@ typedef struct {
   int accept_cb;
   int receive_cb;
   int sent_cb;
+  int drain_cb;
   int disconnect_cb;
   uint8_t clientFlag;      //disconnect
   uint8_t state;           //socket connection state
+  uint8_t http;            //http framing of the requests
+  uint8_t co;              //clients go to net.co sessions (net.co.serve)
   _lsvrCltsocket_t *psvrCltsocket[MAX_SVRCLT_SOCKET];
 }svrsockt_t;
 svrsockt_t *psvrsockt[MAX_SVR_SOCKET];
@@ -99,26 +225,36 @@ typedef struct _lcltsocket{
   int dnsfound_cb;
   int receive_cb;
   int sent_cb;
+  int drain_cb;
   int disconnect_cb;
   uint8_t clientFlag;      //sent or disconnect or got ip
   uint8_t state;           //socket connection state
   char *pDomain4Dns;
+  net_sendq_t sq;
+  net_recv_t rx;
+  net_co_t *co;            // net.co session, NULL if none
 } cltsockt_t;
 cltsockt_t *pcltsockt[MAX_CLT_SOCKET];
 
 
-#define MAX_RECV_LEN 1024
 static lua_State *gL = NULL;
-static char* recvBuf = NULL;
-static char* sendBuf = NULL;
+static net_block_t *recv_pool = NULL;
+static net_block_t *recv_free = NULL;
+static net_block_t *recv_wait = NULL;    // wait mode answer
+static int recv_waiting = INVALID_HANDLE; // socket of the wait mode answer
+static net_co_t *co_list = NULL;
+static char* sendBuf = NULL;   // http request being built
 static int send_len = 0;
+static net_sendbuf_t *sendq_done = NULL;
+static net_sendbuf_t *sendq_undone = NULL; // sent files, done not posted yet
 static bool net_thread_is_started = false;
 static int socket_connected = -1;
-static int max_recvlen = 10*1024;
 static int data_sent = 0;
 static int data_received = 0;
 static bool wifiConnected = false;
 
+static OSStatus _queueSent(int socket, int cbref, int len, uint8_t source);
+
 //==============================================================================
 
 
@@ -163,6 +299,581 @@ static bool getsocketIndex(int socketHandle, int *type,int *out1,int *out2)
   return false;
 }
 
+//------------------------------------------
+static void _sendq_init( net_sendq_t *q )
+{
+  q->head = NULL;
+  q->tail = NULL;
+  q->off = 0;
+  q->queued = 0;
+  q->high = DEF_SEND_HIGH;
+  q->sent = 0;
+  q->over = 0;
+}
+
+// Posts done of a sent file, false if the message queue is full
+//---------------------------------------------
+static bool _sendfile_done( net_sendbuf_t *b )
+{
+  net_sendfile_t *f = b->file;
+
+  if (f->done_cb == LUA_NOREF) return true;
+  if (_queueSent(f->socket, f->done_cb, f->result, (onNetSent | needUNREF)) != kNoErr) return false;
+  f->done_cb = LUA_NOREF;
+  return true;
+}
+
+// Posts the done messages that did not fit the message queue before
+//------------------------------
+static void _sendfile_retry()
+{
+  net_sendbuf_t *b;
+
+  while ((sendq_undone != NULL) && (_sendfile_done(sendq_undone))) {
+    b = sendq_undone;
+    sendq_undone = b->next;
+    b->next = sendq_done;
+    sendq_done = b;
+  }
+}
+
+// Moves the head buffer to the sent ones. A file is closed, its done gets
+// the bytes sent or -1 if it was dropped
+//-----------------------------------------
+static void _sendq_pop( net_sendq_t *q )
+{
+  net_sendbuf_t *b = q->head;
+  net_sendfile_t *f = b->file;
+
+  q->head = b->next;
+  if (q->head == NULL) q->tail = NULL;
+  q->queued -= (b->len - q->off);
+  if (f != NULL) {
+    if (f->fd > 0) SPIFFS_close(&fs, f->fd);
+    f->fd = 0;
+    free(f->buf);
+    f->buf = NULL;
+    f->result = (q->off >= b->len) ? b->len : -1;
+    if ((sendq_undone != NULL) || (!_sendfile_done(b))) {
+      // after the ones waiting, in order
+      net_sendbuf_t **p = &sendq_undone;
+      while (*p != NULL) p = &(*p)->next;
+      b->next = NULL;
+      *p = b;
+      q->off = 0;
+      return;
+    }
+  }
+  q->off = 0;
+  b->next = sendq_done;
+  sendq_done = b;
+}
+
+// Drops what is still queued
+//-------------------------------------------
+static void _sendq_flush( net_sendq_t *q )
+{
+  while (q->head != NULL) _sendq_pop(q);
+  q->sent = 0;
+  q->over = 0;
+}
+
+// 0 queued, 1 queued and over the high water mark, -1 no memory
+//--------------------------------------------------------------------------------------------
+static int _sendq_put( net_sendq_t *q, const char *data, int len, int ref, net_sendfile_t *file )
+{
+  net_sendbuf_t *b = (net_sendbuf_t*)malloc(sizeof(net_sendbuf_t));
+  if (b == NULL) return -1;
+
+  b->next = NULL;
+  b->data = data;
+  b->len = len;
+  b->ref = ref;
+  b->file = file;
+  if (q->tail == NULL) q->head = b;
+  else q->tail->next = b;
+  q->tail = b;
+  q->queued += len;
+  if (q->queued >= q->high) {
+    q->over = 1;
+    return 1;
+  }
+  return 0;
+}
+
+// Releases the sent buffers, lua thread only
+//----------------------------------------
+static void _sendq_release( lua_State* L )
+{
+  net_sendbuf_t *b;
+
+  while (sendq_done != NULL) {
+    b = sendq_done;
+    sendq_done = b->next;
+    if (b->file != NULL) {
+      if (b->file->done_cb != LUA_NOREF) luaL_unref(L, LUA_REGISTRYINDEX, b->file->done_cb);
+      free(b->file);
+    }
+    else if (b->ref != LUA_NOREF) luaL_unref(L, LUA_REGISTRYINDEX, b->ref);
+    else free((void*)b->data);
+    free(b);
+  }
+}
+
+// Called from the lua thread for each onNetSent message (see do_queue_task)
+//--------------------------------------
+void _net_sent_release( lua_State* L )
+{
+  mico_rtos_lock_mutex(&net_mut);
+  _sendq_release(L);
+  mico_rtos_unlock_mutex(&net_mut);
+}
+
+// The receive pool functions are called with net_mut locked
+//------------------------------
+static OSStatus _recv_pool_init()
+{
+  int i;
+
+  if (recv_pool != NULL) return kNoErr;
+  recv_pool = (net_block_t*)malloc(NET_RECV_BLOCKS * sizeof(net_block_t));
+  if (recv_pool == NULL) return kNoMemoryErr;
+  recv_free = NULL;
+  for (i=0; i<NET_RECV_BLOCKS; i++) {
+    recv_pool[i].next = recv_free;
+    recv_free = &recv_pool[i];
+  }
+  return kNoErr;
+}
+
+//------------------------------
+static net_block_t *_recv_get()
+{
+  net_block_t *b = recv_free;
+
+  if (b != NULL) {
+    recv_free = b->next;
+    b->next = NULL;
+    b->len = 0;
+  }
+  return b;
+}
+
+//-------------------------------------
+static void _recv_put( net_block_t *b )
+{
+  net_block_t *nx;
+
+  while (b != NULL) {
+    nx = b->next;
+    b->next = recv_free;
+    recv_free = b;
+    b = nx;
+  }
+}
+
+//-------------------------------------------------
+static void _recv_init( net_recv_t *rx, uint8_t http )
+{
+  rx->in = NULL;
+  rx->pos = 0;
+  rx->pdata = NULL;
+  rx->phdr = NULL;
+  rx->hdr = NULL;
+  rx->left = 0;
+  rx->http = http;
+  rx->state = (http) ? RECV_HEAD : RECV_RAW;
+  rx->done = 0;
+  rx->last = 0;
+}
+
+//-------------------------------------
+static void _recv_free( net_recv_t *rx )
+{
+  _recv_put(rx->in);
+  _recv_put(rx->pdata);
+  _recv_put(rx->phdr);
+  _recv_put(rx->hdr);
+  _recv_init(rx, rx->http);
+}
+
+// data or a message not posted yet
+//--------------------------------------
+static bool _recv_busy( net_recv_t *rx )
+{
+  return ((rx->in != NULL) || (rx->pdata != NULL) || (rx->phdr != NULL));
+}
+
+// Posts received data, with the http header of the message if there is one.
+// Without a callback the data goes to the wait mode answer of its socket,
+// or back to the pool.
+//------------------------------------------------------------------------------------
+static OSStatus _queueRecv(int socket, int cbref, net_block_t *data, net_block_t *hdr)
+{
+  net_block_t **pb;
+
+  if (cbref == LUA_NOREF) {
+    if ((socket == recv_waiting) && (data != NULL)) {
+      for (pb = &recv_wait; *pb != NULL; pb = &(*pb)->next) ;
+      *pb = data;
+      data = NULL;
+    }
+    _recv_put(data);
+    _recv_put(hdr);
+    return kNoErr;
+  }
+
+  queue_msg_t msg;
+
+  msg.L = gL;
+  msg.source = onNetRecv;
+  msg.para1 = socket;
+  msg.para2 = cbref;
+  msg.para3 = (uint8_t*)data;
+  msg.para4 = (uint8_t*)hdr;
+  return mico_rtos_push_to_queue( &os_queue, &msg, 0);
+}
+
+// Called from the lua thread for each onNetRecv message (see do_queue_task):
+// receive(socket, data [, header]), the blocks go back to the pool
+//-----------------------------------------------------------------------------
+void _net_recv_call( lua_State* L, int cbref, int socket, void* data, void* hdr )
+{
+  net_block_t *d = (net_block_t*)data;
+  net_block_t *h = (net_block_t*)hdr;
+  int n = 0;
+
+  if (cbref != LUA_NOREF) {
+    lua_rawgeti(L, LUA_REGISTRYINDEX, cbref);
+    if ((lua_type(L, -1) != LUA_TFUNCTION) && (lua_type(L, -1) != LUA_TLIGHTFUNCTION)) lua_remove(L, -1);
+    else {
+      lua_pushinteger(L, socket);
+      if (d != NULL) lua_pushlstring(L, d->data, d->len);
+      else lua_pushstring(L, "");
+      n = 2;
+      if (h != NULL) {
+        lua_pushlstring(L, h->data, h->len);
+        n++;
+      }
+    }
+  }
+  mico_rtos_lock_mutex(&net_mut);
+  _recv_put(d);
+  _recv_put(h);
+  mico_rtos_unlock_mutex(&net_mut);
+  if (n > 0) {
+    lua_call(L, n, 0);
+    lua_gc(L, LUA_GCCOLLECT, 0);
+  }
+}
+
+// The value of a header field, NULL if it is not there
+//---------------------------------------------------------------
+static const char *_recv_field( net_block_t *h, const char *name )
+{
+  int i, nl = strlen(name);
+  const char *p = h->data;
+
+  while ((p = strstr(p, "\r\n")) != NULL) {
+    p += 2;
+    for (i=0; i<nl; i++) {
+      if (tolower((unsigned char)p[i]) != name[i]) break;
+    }
+    if (i == nl) {
+      p += nl;
+      while (*p == ' ') p++;
+      return p;
+    }
+  }
+  return NULL;
+}
+
+// Body length from the header: Content-Length; answers without it (or
+// chunked) go up to the close, requests have no body. 1xx, 204 and 304
+// answers have no body.
+//--------------------------------------------------------
+static int _recv_bodylen( net_recv_t *rx, net_block_t *h )
+{
+  const char *p;
+
+  if (rx->http == 2) {
+    p = strchr(h->data, ' ');
+    if (p != NULL) {
+      int status = atoi(p+1);
+      if (((status >= 100) && (status < 200)) || (status == 204) || (status == 304)) return 0;
+    }
+  }
+  p = _recv_field(h, "transfer-encoding:");
+  if ((p != NULL) && (strncmp(p, "chunked", 7) == 0)) return -1;
+  p = _recv_field(h, "content-length:");
+  if (p != NULL) return atoi(p);
+  return (rx->http == 2) ? -1 : 0;
+}
+
+// Processes the received block of a socket, posting data as it can. With http
+// framing each message starts with a header and its body follows, cut at
+// Content-Length; the first piece of the body comes with the header. Stops when
+// the pool has no block for a piece or the message queue is full, what is
+// left goes on in the next round.
+//------------------------------------------------------------
+static void _recv_frame( net_recv_t *rx, int socket, int cbref )
+{
+  net_block_t *b, *d;
+  int n, m;
+
+  if ((rx->pdata != NULL) || (rx->phdr != NULL)) {
+    if (_queueRecv(socket, cbref, rx->pdata, rx->phdr) != kNoErr) return;
+    rx->pdata = NULL;
+    rx->phdr = NULL;
+  }
+  while (rx->in != NULL) {
+    b = rx->in;
+    n = b->len - rx->pos;
+    if (n <= 0) {
+      rx->in = NULL;
+      _recv_put(b);
+      break;
+    }
+    if (rx->state == RECV_HEAD) {
+      d = rx->hdr;
+      if (d == NULL) {
+        // answers start with the status line, anything else is not framed
+        if ((rx->http == 2) && (strncmp(b->data + rx->pos, "HTTP", (n < 4) ? n : 4) != 0)) {
+          rx->state = RECV_RAW;
+          continue;
+        }
+        d = _recv_get();
+        if (d == NULL) return;
+        rx->hdr = d;
+      }
+      // up to the empty line
+      for (m=0; (m < n) && (d->len < (MAX_RECV_LEN-1)); ) {
+        d->data[d->len++] = b->data[rx->pos + m++];
+        if ((d->len >= 4) && (memcmp(d->data + d->len - 4, "\r\n\r\n", 4) == 0)) break;
+      }
+      rx->pos += m;
+      if ((d->len >= 4) && (memcmp(d->data + d->len - 4, "\r\n\r\n", 4) == 0)) {
+        d->len -= 4;
+        d->data[d->len] = 0x00;
+        rx->hdr = NULL;
+        rx->phdr = d;
+        rx->left = _recv_bodylen(rx, d);
+        rx->state = (rx->left == 0) ? RECV_HEAD : RECV_BODY;
+        if (rx->left == 0) rx->done = 1;
+        // the header goes now if there is no body in this block
+        if ((rx->left == 0) || (rx->pos >= b->len)) {
+          if (_queueRecv(socket, cbref, NULL, d) != kNoErr) return;
+          rx->phdr = NULL;
+        }
+      }
+      else if (d->len >= (MAX_RECV_LEN-1)) {
+        // header too long, the rest of the connection is not framed
+        rx->hdr = NULL;
+        rx->state = RECV_RAW;
+        if (_queueRecv(socket, cbref, d, NULL) != kNoErr) {
+          rx->pdata = d;
+          return;
+        }
+      }
+      continue;
+    }
+    // body or raw data
+    m = n;
+    if ((rx->state == RECV_BODY) && (rx->left >= 0) && (rx->left < m)) m = rx->left;
+    if (rx->pos + m >= b->len) {
+      // the rest of the block: the block itself
+      d = b;
+      if (rx->pos > 0) memmove(d->data, d->data + rx->pos, m);
+      d->len = m;
+      rx->in = NULL;
+    }
+    else {
+      // more follows in the block, the piece goes in a block of its own
+      d = _recv_get();
+      if (d == NULL) return;
+      memcpy(d->data, b->data + rx->pos, m);
+      d->len = m;
+      rx->pos += m;
+    }
+    if ((rx->state == RECV_BODY) && (rx->left > 0)) {
+      rx->left -= m;
+      if (rx->left == 0) {
+        rx->state = RECV_HEAD;
+        rx->done = 1;
+      }
+    }
+    if (_queueRecv(socket, cbref, d, rx->phdr) != kNoErr) {
+      rx->pdata = d;
+      return;
+    }
+    rx->phdr = NULL;
+  }
+}
+
+// One recv() into a pool block, -1: closed or error
+//------------------------------------------------
+static int _recv_tcp( net_recv_t *rx, int socket )
+{
+  if (rx->in != NULL) return 0;
+  net_block_t *b = _recv_get();
+  if (b == NULL) return 0;
+
+  int n = recv(socket, b->data, MAX_RECV_LEN-1, 0);
+  if (n <= 0) {
+    _recv_put(b);
+    return -1;
+  }
+  b->len = n;
+  rx->in = b;
+  rx->pos = 0;
+  rx->last = mico_get_time() | 1;
+  return n;
+}
+
+// One datagram into a pool block, NULL if there was none
+//-------------------------------------------------------------------------------
+static net_block_t *_recv_udp( int socket, struct sockaddr_t *addr, int *res )
+{
+  int slen = sizeof(struct sockaddr_t);
+  net_block_t *b = _recv_get();
+
+  *res = 0;
+  if (b == NULL) return NULL;
+  int n = recvfrom(socket, b->data, MAX_RECV_LEN-1, 0, addr, &slen);
+  if (n <= 0) {
+    _recv_put(b);
+    *res = -1;
+    return NULL;
+  }
+  b->len = n;
+  return b;
+}
+
+// The answer of a tcp client is complete: its http message is, or, unframed
+// or without a length, no data came for NET_RECV_QUIET ms; or the pool ran
+// out while a wait mode answer holds it. The wait is over then, and the
+// client is disconnected.
+//--------------------------------------------------------
+static bool _recv_answered( net_recv_t *rx, int socket )
+{
+  if ((rx->last == 0) || _recv_busy(rx)) return false;
+  if ((rx->done == 0) && ((socket != recv_waiting) || (recv_free != NULL))) {
+    if ((rx->state == RECV_HEAD) || ((rx->state == RECV_BODY) && (rx->left >= 0))) return false;
+    if ((int32_t)(mico_get_time() - rx->last) < NET_RECV_QUIET) return false;
+  }
+  if (rx->hdr != NULL) {
+    // a header that never ended goes as data first
+    rx->pdata = rx->hdr;
+    rx->hdr = NULL;
+    rx->state = RECV_RAW;
+    return false;
+  }
+
+  rx->last = 0;
+  rx->done = 0;
+  if (socket == recv_waiting) {
+    net_block_t *b;
+    int len = 0;
+    for (b = recv_wait; b != NULL; b = b->next) len += b->len;
+    data_received = len;
+  }
+  return true;
+}
+
+// The wait of a session is over. The net.co functions of the net thread
+// are called with net_mut locked
+//----------------------------------------
+static bool _co_ready( net_co_t *co )
+{
+  switch (co->want) {
+    case CO_READ:
+      return ((co->len >= co->need) || (co->eof));
+    case CO_LINE:
+      return ((co->len >= NET_CO_BUF) || (co->eof) || (memchr(co->buf, '\n', co->len) != NULL));
+    case CO_WRITE:
+      return ((co->sq == NULL) || (co->sq->queued <= (co->sq->high / 2)));
+    case CO_CONNECT:
+      return ((co->connected) || (co->socket == INVALID_HANDLE) ||
+              ((mico_get_time() - co->since) >= (uint32_t)co->need));
+    case CO_YIELD:
+      return true;
+    case CO_END:
+      return (co->socket == INVALID_HANDLE);
+  }
+  return false;
+}
+
+// Posts the resume of a session that can go on. Kept due if the message
+// queue is full, the net thread tries again every round
+//----------------------------------
+static void _co_wake( net_co_t *co )
+{
+  if ((co->want == CO_NONE) || (co->posted) || (!_co_ready(co))) return;
+
+  queue_msg_t msg;
+
+  msg.L = gL;
+  msg.source = onNetCo;
+  msg.para1 = co->socket;
+  msg.para2 = LUA_NOREF;
+  msg.para3 = (uint8_t*)co;
+  msg.para4 = NULL;
+  if (mico_rtos_push_to_queue( &os_queue, &msg, 0) == kNoErr) co->posted = 1;
+}
+
+// The socket of a session is read only while it waits for data
+//-------------------------------------
+static bool _co_reading( net_co_t *co )
+{
+  return (((co->want == CO_READ) || (co->want == CO_LINE)) && (!_co_ready(co)));
+}
+
+// One recv() into the buffer of a session, -1: error. At the end of the
+// data (the peer may still read) the socket stays, the session closes it
+//------------------------------------------------
+static int _co_recv( net_co_t *co, int socket )
+{
+  int n = recv(socket, co->buf + co->len, NET_CO_BUF - co->len, 0);
+
+  if (n <= 0) co->eof = 1;
+  else co->len += n;
+  _co_wake(co);
+  return (n < 0) ? -1 : n;
+}
+
+// The socket of a session is closed, what is in buf can still be read
+//-------------------------------------
+static void _co_detach( net_co_t **pco )
+{
+  net_co_t *co = *pco;
+
+  if (co == NULL) return;
+  co->socket = INVALID_HANDLE;
+  co->sq = NULL;
+  co->eof = 1;
+  *pco = NULL;
+}
+
+// Every round: the sockets of closing sessions are closed once what they
+// wrote is sent, the sessions that can go on are resumed
+//------------------------
+static void _co_round()
+{
+  net_co_t *co;
+  int type = 0, k = 0, m = 0;
+
+  for (co = co_list; co != NULL; co = co->next) {
+    if ((co->closing) && (co->socket != INVALID_HANDLE) && (co->sq->head == NULL) &&
+        (getsocketIndex(co->socket, &type, &k, &m))) {
+      if ((type == SOCKET_TYPE_SVRCLT) && (psvrsockt[k]->psvrCltsocket[m]->co == co))
+        psvrsockt[k]->psvrCltsocket[m]->clientFlag = REQ_ACTION_DISCONNECT;
+      else if ((type == SOCKET_TYPE_CLIENT) && (pcltsockt[k]->co == co))
+        pcltsockt[k]->clientFlag = REQ_ACTION_DISCONNECTFREE;
+    }
+    _co_wake(co);
+  }
+}
+
 //-------------------------------------------------------
 static void closeSocket(int socketHandle, uint8_t dofree)
 {
@@ -181,6 +892,9 @@ static void closeSocket(int socketHandle, uint8_t dofree)
         
         if ((psvrsockt[k]->type == TCP) && (psvrsockt[k]->psvrCltsocket[m]->client != INVALID_HANDLE))
           close(psvrsockt[k]->psvrCltsocket[m]->client);
+        _sendq_flush(&psvrsockt[k]->psvrCltsocket[m]->sq);
+        _recv_free(&psvrsockt[k]->psvrCltsocket[m]->rx);
+        _co_detach(&psvrsockt[k]->psvrCltsocket[m]->co);
         free(psvrsockt[k]->psvrCltsocket[m]);
         psvrsockt[k]->psvrCltsocket[m] = NULL;
       }
@@ -194,6 +908,9 @@ static void closeSocket(int socketHandle, uint8_t dofree)
         if (psvrsockt[k]->sent_cb != LUA_NOREF)
           luaL_unref(gL, LUA_REGISTRYINDEX, psvrsockt[k]->sent_cb);
         psvrsockt[k]->sent_cb = LUA_NOREF;
+        if (psvrsockt[k]->drain_cb != LUA_NOREF)
+          luaL_unref(gL, LUA_REGISTRYINDEX, psvrsockt[k]->drain_cb);
+        psvrsockt[k]->drain_cb = LUA_NOREF;
         /*
         if (psvrsockt[k]->disconnect_cb != LUA_NOREF)
           luaL_unref(gL, LUA_REGISTRYINDEX, psvrsockt[k]->disconnect_cb);
@@ -217,6 +934,9 @@ static void closeSocket(int socketHandle, uint8_t dofree)
         //close serverClient
         //free memery
         if (psvrsockt[k]->type == TCP) close(socketHandle);
+        _sendq_flush(&psvrsockt[k]->psvrCltsocket[m]->sq);
+        _recv_free(&psvrsockt[k]->psvrCltsocket[m]->rx);
+        _co_detach(&psvrsockt[k]->psvrCltsocket[m]->co);
         free(psvrsockt[k]->psvrCltsocket[m]);
         psvrsockt[k]->psvrCltsocket[m] = NULL;
         return ;
@@ -244,6 +964,9 @@ static void closeSocket(int socketHandle, uint8_t dofree)
         if (pcltsockt[k]->sent_cb != LUA_NOREF)
           luaL_unref(gL, LUA_REGISTRYINDEX, pcltsockt[k]->sent_cb);
         pcltsockt[k]->sent_cb = LUA_NOREF;
+        if (pcltsockt[k]->drain_cb != LUA_NOREF)
+          luaL_unref(gL, LUA_REGISTRYINDEX, pcltsockt[k]->drain_cb);
+        pcltsockt[k]->drain_cb = LUA_NOREF;
         /*
         if (pcltsockt[k]->disconnect_cb != LUA_NOREF)
           luaL_unref(gL, LUA_REGISTRYINDEX, pcltsockt[k]->disconnect_cb);
@@ -252,6 +975,9 @@ static void closeSocket(int socketHandle, uint8_t dofree)
       }
       
       pcltsockt[k]->clientFlag = NO_ACTION;
+      _sendq_flush(&pcltsockt[k]->sq);
+      _recv_free(&pcltsockt[k]->rx);
+      _co_detach(&pcltsockt[k]->co);
       if (dofree == 97) {
         if (pcltsockt[k]->socket != INVALID_HANDLE) close(psvrsockt[k]->socket);
       }
@@ -313,12 +1039,42 @@ static void _queueAction(int socket, int cbref, int len)
   mico_rtos_push_to_queue( &os_queue, &msg, 0);
 }
 
+// sent(socket, bytes) when the send queue of a socket is empty, drain(socket)
+// when it is down to half its high water mark again, done(socket, bytes)
+// when a file is sent (source needUNREF). Posted also without a callback:
+// the lua thread releases the sent buffers on it.
+//----------------------------------------------------------------------
+static OSStatus _queueSent(int socket, int cbref, int len, uint8_t source)
+{
+  queue_msg_t msg;
+  char ss[12];
+  OSStatus err;
+
+  msg.L = gL;
+  msg.source = source;
+  msg.para1 = socket;
+  msg.para2 = cbref;
+  msg.para3 = NULL;
+  msg.para4 = NULL;
+  if ((cbref != LUA_NOREF) && (len > -10)) {
+    sprintf(ss, "%d", len);
+    msg.para3 = (uint8_t*)malloc(strlen(ss)+1);
+    if (msg.para3 != NULL) strcpy((char*)msg.para3, ss);
+  }
+  err = mico_rtos_push_to_queue( &os_queue, &msg, 0);
+  if (err != kNoErr) free(msg.para3);
+  return err;
+}
+
+// Not posted when the message queue is full, an accept is posted again on
+// the next rounds then (accept_due)
 //------------------------------------------------------------------
-static void _queueIPport(int socket, int cbref, int ip, int port)
+static OSStatus _queueIPport(int socket, int cbref, int ip, int port)
 {
-  if (cbref == LUA_NOREF) return;
+  if (cbref == LUA_NOREF) return kNoErr;
   
   queue_msg_t msg;
+  OSStatus err;
   char ss[8];
   memset(ss,0x00,8);
 
@@ -342,188 +1098,167 @@ static void _queueIPport(int socket, int cbref, int ip, int port)
     if (msg.para4 != NULL) strcpy((char*)msg.para4, sip);
   }
   msg.para2 = cbref;
-  mico_rtos_push_to_queue( &os_queue, &msg, 0);
+  err = mico_rtos_push_to_queue( &os_queue, &msg, 0);
+  if (err != kNoErr) {
+    free(msg.para3);
+    free(msg.para4);
+  }
+  return err;
 }
 
-//----------------------------------------------------------------------------------------
-static void _queueReceive(int socket, int cbref, int len, uint8_t http, uint16_t wait_tmo)
+// One send from a file at the head of a send queue, the next piece is
+// read from spiffs when the last one is out. Bytes sent, 0 when no spiffs
+// file descriptor is free yet, < 0 error
+//----------------------------------------------------------
+static int _sendq_file(net_sendq_t *q, int socket)
 {
-  uint8_t* hdrbuf = NULL;
-  
-  if (http > 0) {
-    if (strstr(recvBuf, "HTTP") == recvBuf) {
-      int recv_len = len;
-      char* hdrend = strstr(recvBuf, "\r\n\r\n");
-      if (hdrend != NULL) {
-        int hdrlen = (hdrend - recvBuf);
-        //net_log("[NET clt] HTTP Header len: %d\r\n", hdrlen );
-        hdrbuf = (uint8_t*)malloc(hdrlen+1);
-        if (hdrbuf != NULL) {
-          memcpy(hdrbuf, recvBuf, hdrlen);
-          hdrbuf[hdrlen] = 0x00;
-        }
-        recv_len -= (hdrlen + 4);
-        memmove(recvBuf, (recvBuf + hdrlen + 4), recv_len);
-        recvBuf[recv_len] = 0x00;
-        //net_log("[NET clt] HTTP Data len: %d\r\n", recv_len );
-      }
-    }
-  }
-
-  if (cbref == LUA_NOREF) {
-    if (wait_tmo > 0) {
-      free(hdrbuf);
-      // leave recvBuf
-    }
-    else {
-      free(recvBuf);
-      recvBuf = NULL;
-      free(hdrbuf);
-    }
-    return;
-  }
-  
-  queue_msg_t msg;
-  int recv_len = len;
-  
-  msg.L = gL;
-  msg.source = onNet;
-  msg.para1 = socket;
-  msg.para3 = NULL;
-  msg.para4 = NULL;
-  msg.para2 = cbref;
+  net_sendbuf_t *b = q->head;
+  net_sendfile_t *f = b->file;
+  int n;
+
+  if (f->fd <= 0) {
+    n = (NET_SEND_CHUNK / SPIFFS_DATA_PAGE_SIZE(&fs)) * SPIFFS_DATA_PAGE_SIZE(&fs);
+    if (f->buf == NULL) f->buf = (char*)malloc(n);
+    if (f->buf == NULL) return -7;
+    f->fd = SPIFFS_open(&fs, f->path, SPIFFS_RDONLY, 0);
+    if (f->fd == SPIFFS_ERR_OUT_OF_FILE_DESCS) {
+      // try again later, see _sendq_ready
+      f->fd = 0;
+      f->nofd = mico_get_time() | 1;
+      return 0;
+    }
+    if ((f->fd <= 0) || (SPIFFS_lseek(&fs, f->fd, f->foff, SPIFFS_SEEK_SET) != f->foff)) {
+      net_log("[NET snd] Error opening %s\r\n", f->path);
+      return -8;
+    }
+  }
+  if (f->bpos >= f->blen) {
+    n = (NET_SEND_CHUNK / SPIFFS_DATA_PAGE_SIZE(&fs)) * SPIFFS_DATA_PAGE_SIZE(&fs);
+    if (n > (b->len - q->off)) n = b->len - q->off;
+    n = SPIFFS_read(&fs, f->fd, f->buf, n);
+    if (n <= 0) {
+      net_log("[NET snd] Error reading %s: %d\r\n", f->path, n);
+      return -8;
+    }
+    f->foff += n;
+    f->blen = n;
+    f->bpos = 0;
+  }
+  n = send(socket, f->buf + f->bpos, f->blen - f->bpos, 0);
+  if (n <= 0) {
+    net_log("[NET snd] Error: %d\r\n", n);
+    return (n < 0) ? n : -2;
+  }
+  f->bpos += n;
+  q->off += n;
+  q->queued -= n;
+  q->sent += n;
+  if (q->off >= b->len) _sendq_pop(q);
+  return n;
+}
 
-  if (http > 0) msg.para4 = hdrbuf;
-  else msg.para4 = NULL;
-  msg.para3 = (uint8_t*)malloc(recv_len+1);
-  if (msg.para3 != NULL) {
-    memcpy((char*)msg.para3, recvBuf, recv_len);
-    msg.para3[recv_len] = 0x00;
-  }
-  mico_rtos_push_to_queue( &os_queue, &msg, 0);
+// Something to send now: not a file waiting 10 ms for a free spiffs fd
+//--------------------------------------------
+static bool _sendq_ready( net_sendq_t *q )
+{
+  net_sendfile_t *f;
 
-  if (wait_tmo == 0) {
-    free(recvBuf);
-    recvBuf = NULL;
-  }
+  if (q->head == NULL) return false;
+  f = q->head->file;
+  if ((f == NULL) || (f->fd > 0) || (f->nofd == 0)) return true;
+  return ((mico_get_time() - f->nofd) >= 10);
 }
 
-//----------------------------------------------------------------------------------------
-static int _receive(int socket, uint8_t type, struct sockaddr_t * clientaddr, uint8_t* res)
+// One send from the head of a send queue, at most NET_SEND_CHUNK bytes on
+// TCP, a whole datagram on UDP. Bytes sent, < 0 error
+//----------------------------------------------------------------------------
+static int _sendq_send(net_sendq_t *q, int socket, uint8_t type, struct sockaddr_t *paddr)
 {
-  fd_set readset;
-  struct timeval_t t_val;
-  int recv_len = 0;
-  int total_len = 0;
-  int slen = sizeof(struct sockaddr_t);
+  net_sendbuf_t *b = q->head;
+  int n;
 
-  *res = 1;
-  free(recvBuf);
-  recvBuf = NULL;
-  recvBuf = calloc(MAX_RECV_LEN, sizeof(char));
-  if (recvBuf == NULL) {
-    net_log("\r\n[NET trd] Error allocating receive buffer.\r\n" );
-    return total_len;
+  if (b == NULL) return 0;
+  if (b->file != NULL) return _sendq_file(q, socket);
+  if (type == TCP) {
+    n = b->len - q->off;
+    if (n > NET_SEND_CHUNK) n = NET_SEND_CHUNK;
+    n = send(socket, b->data + q->off, n, 0);
   }
-  
-  int buf_size = MAX_RECV_LEN;  
-  int n = 1;  
-  while (n > 0) {
-    if (type == TCP) {
-      recv_len = recv(socket, recvBuf+total_len, (buf_size-total_len-1), 0);
-    }
-    else {
-      recv_len = recvfrom(socket, recvBuf+total_len, (buf_size-total_len-1),
-                          0, clientaddr, &slen);
-    }
-    if (recv_len <= 0) break;
+  else {
+    char sip[17];
+    memset(sip, 0x00, 17);
+    inet_ntoa(sip, paddr->s_ip);
+    net_log("[NET udp] UDP skt %d, Send to %s:%d\r\n", socket, sip, paddr->s_port);
+    n = sendto(socket, b->data, b->len, 0, paddr, sizeof(struct sockaddr_t));
+    if (n != b->len) n = -2;
+  }
+  if (n <= 0) {
+    net_log("[NET snd] Error: %d\r\n", n);
+    return (n < 0) ? n : -2;
+  }
+  q->off += n;
+  q->queued -= n;
+  q->sent += n;
+  if (q->off >= b->len) _sendq_pop(q);
+  return n;
+}
 
-    // success, wait next
-    total_len += recv_len;
-    
-    FD_ZERO(&readset);
-    FD_SET(socket, &readset);
-    t_val.tv_sec = 0;
-    t_val.tv_usec = 10*1000;
-    n = select(socket+1, &readset, NULL, NULL, &t_val);
-    if (n > 0) {
-      if (total_len > (buf_size / 2)) {
-        // we have more data than the size of the recvBuf, increase the size
-        if ((buf_size+512) > max_recvlen) {
-          n = 0;
-          *res = 0;
-        }
-        else {
-          buf_size += 512;
-          recvBuf = realloc(recvBuf, buf_size);
-          if (recvBuf == NULL) {
-            net_log("\r\n[NET trd] Error reallocating receive buffer.\r\n" );
-            total_len = 0;
-            n = 0;
-          }
-        }
-      }
-    }
+// Tells lua when the queue of a socket is drained or empty. Kept due if
+// the message queue is full, the net thread tries again every round
+//-----------------------------------------------------------------------
+static void _sendq_notify(net_sendq_t *q, int id, int sent_cb, int drain_cb)
+{
+  if ((q->over) && (q->queued <= (q->high / 2))) {
+    if ((drain_cb == LUA_NOREF) || (_queueSent(id, drain_cb, -99, onNetSent) == kNoErr)) q->over = 0;
+  }
+  if ((q->head == NULL) && (q->sent > 0)) {
+    data_sent = q->sent;
+    if (_queueSent(id, sent_cb, q->sent, onNetSent) == kNoErr) q->sent = 0;
   }
-  return total_len;
 }
 
-//------------------------------------------------------------------
-static int _send(int socket, uint8_t type, struct sockaddr_t *paddr)
+// Sends from the queue of a writable socket and tells lua when it is
+// drained or empty. < 0 send error, the queue is dropped
+//---------------------------------------------------------------------------------
+static int _sendq_run(net_sendq_t *q, int id, int socket, uint8_t type, struct sockaddr_t *paddr,
+                      int sent_cb, int drain_cb)
 {
-  fd_set wrset;
-  struct timeval_t t_val;
-  size_t sendlen = 0;
-  
-  if ((sendBuf == NULL) || (send_len < 1)) {
-    free(sendBuf);
-    sendBuf = NULL;
-    send_len = 0;
-    return -1;
+  int n = _sendq_send(q, socket, type, paddr);
+
+  if (n < 0) {
+    _sendq_flush(q);
+    data_sent = n;
+    _queueSent(id, sent_cb, n, onNetSent);
+    return n;
   }
+  _sendq_notify(q, id, sent_cb, drain_cb);
+  return n;
+}
 
-  int sent = 0;
-  int total_sent = 0;
-  while (send_len > 0) {
-    if (send_len > 1024) sendlen = 1024;
-    else sendlen = send_len;
-    
-    if (type == TCP) { // TCP socket
-      sent = send(socket, (sendBuf+sent), sendlen, 0);
-    }
-    else { // UDP socket
-      char sip[17];
-      memset(sip, 0x00, 17);
-      inet_ntoa(sip, paddr->s_ip);
-      net_log("[NET udp] UDP skt %d, Send to %s:%d\r\n", socket, sip, paddr->s_port);
-      sent = sendto(socket, (sendBuf+sent), sendlen, 0, paddr, sizeof(struct sockaddr_t));
-    }
-    if (sent != sendlen) {
-      net_log("[NET snd] Error: %d<>%d\r\n", sent, sendlen);
-      sent = -2;
-      break;
-    }
-    total_sent += sent;
-    // success, wait next
-    send_len -= sendlen;
-    if (send_len > 0) {
-      FD_ZERO(&wrset);
-      FD_SET(socket, &wrset);
-      // check socket state
-      t_val.tv_sec = 0;
-      t_val.tv_usec = 10*1000;
-      if (select(socket+1, NULL, &wrset, NULL, &t_val) <= 0) {
-        sent = -3;
-        break;
+// Takes the connection notified by _micoNotify_TCPClientConnectedHandler,
+// also right after each connect(): one notification is kept at a time
+//----------------------------
+static void _checkConnected()
+{
+  int type = -1, k = -1, m = -1;
+
+  if (socket_connected < 0) return;
+  //net_log("[NET nfy] Connection on socket #%d\r\n", socket_connected);
+  if (getsocketIndex(socket_connected, &type, &k, &m) == false) {
+    net_log("[NET nfy] Socket index not found.\r\n");
+  }
+  else {
+    //net_log("[NET nfy] Type #%d, index %d\r\n", type, k);
+    if (type == SOCKET_TYPE_CLIENT) {
+      if (pcltsockt[k] != NULL) {
+        if (pcltsockt[k]->type == TCP) {
+          pcltsockt[k]->clientFlag = REQ_ACTION_CONNECTED;
+        }
       }
     }
   }
-  if (sent > 0) sent = total_sent;
-  free(sendBuf);
-  sendBuf = NULL;
-  send_len = 0;
-  return sent;
-}  
+  socket_connected = -1;
+}
 
 //void _timer_net_handle( lua_State* gL )
 //{
@@ -533,10 +1268,15 @@ static void _thread_net(void*inContext)
   (void)inContext;
   //step 0
   fd_set readset;
+  fd_set wrset;
   struct timeval_t t_val;
   t_val.tv_sec = 0;
   t_val.tv_usec = 10*1000;
   int k = 0, m = 0;
+  uint8_t idle = 1;
+  uint8_t sending = 0;
+  uint8_t receiving = 0;
+  uint32_t sent_time = 0;
   uint32_t timeout = mico_get_time();
   LinkStatusTypeDef wifi_link;
   
@@ -548,12 +1288,18 @@ static void _thread_net(void*inContext)
   // ===========================================================================
   // Main Thread loop
   while (1) {
+    // sleep only if the last round had nothing to do, poll faster while
+    // data is being sent: lua refills the send queues on the drain callbacks
+    sending = ((mico_get_time() - sent_time) < 100);
     mico_rtos_unlock_mutex(&net_mut);
-    mico_thread_msleep(5);
+    if ((idle) && (!sending)) mico_thread_msleep(5);
     mico_rtos_lock_mutex(&net_mut);
+    idle = 1;
+    _sendfile_retry();
+    _co_round();
     
-    // Check if any socket is active
-    int n = 0;
+    // Check if any socket is active, or a net.co session still to release
+    int n = (co_list != NULL);
     for (k=0; k<MAX_SVR_SOCKET; k++) {
       if (psvrsockt[k] != NULL) {
         n++;
@@ -588,25 +1334,7 @@ static void _thread_net(void*inContext)
     wifiConnected = true;
     
     // ===== Check if some socket is connected =================================
-    if (socket_connected >= 0) {
-      //net_log("[NET nfy] Connection on socket #%d\r\n", socket_connected);
-      int type = -1;
-      k = -1; m = -1;
-      if (getsocketIndex(socket_connected, &type, &k, &m) == false) {
-        net_log("[NET nfy] Socket index not found.\r\n");
-      }
-      else {
-        //net_log("[NET nfy] Type #%d, index %d\r\n", type, k);
-        if (type == SOCKET_TYPE_CLIENT) {
-          if (pcltsockt[k] != NULL) {
-            if (pcltsockt[k]->type == TCP) {
-              pcltsockt[k]->clientFlag = REQ_ACTION_CONNECTED;
-            }
-          }
-        }
-      }
-      socket_connected = -1;
-    }
+    _checkConnected();
     
     uint32_t timeout = mico_get_time();
     // ===== step 1, check socket actions required =============================
@@ -620,28 +1348,11 @@ static void _thread_net(void*inContext)
           if (psvrsockt[k]->psvrCltsocket[m] == NULL) continue;
           
           if (psvrsockt[k]->psvrCltsocket[m]->client != INVALID_HANDLE) {
-            // REQ_ACTION_SEND
-            if (psvrsockt[k]->psvrCltsocket[m]->clientFlag == REQ_ACTION_SEND) {
-              psvrsockt[k]->psvrCltsocket[m]->clientFlag = NO_ACTION;
-              
-              if (psvrsockt[k]->type == TCP) {
-                data_sent = _send(psvrsockt[k]->psvrCltsocket[m]->client, psvrsockt[k]->type,
-                                  &(psvrsockt[k]->psvrCltsocket[m]->addr));
-              }
-              else {
-                data_sent = _send(psvrsockt[k]->socket, psvrsockt[k]->type,
-                                  &(psvrsockt[k]->psvrCltsocket[m]->addr));
-              }
-              if (data_sent < 0) {
-                //psvrsockt[k]->psvrCltsocket[m]->clientFlag = REQ_ACTION_DISCONNECT; 
-                net_log("[NET scl] Error sending data: %d\r\n", data_sent);
-              }
-              _queueAction(psvrsockt[k]->psvrCltsocket[m]->client, psvrsockt[k]->sent_cb, data_sent);
-            }
             //REQ_ACTION_DISCONNECT
-            else if (psvrsockt[k]->psvrCltsocket[m]->clientFlag == REQ_ACTION_DISCONNECT) {
+            if ((psvrsockt[k]->psvrCltsocket[m]->clientFlag == REQ_ACTION_DISCONNECT) &&
+                (!_recv_busy(&psvrsockt[k]->psvrCltsocket[m]->rx))) {
               psvrsockt[k]->psvrCltsocket[m]->clientFlag = NO_ACTION;
-    
+
               _queueDisconnect(psvrsockt[k]->psvrCltsocket[m]->client, psvrsockt[k]->disconnect_cb, (onNet | needUNREF));
               closeSocket(psvrsockt[k]->psvrCltsocket[m]->client, 1);
             }
@@ -684,27 +1395,16 @@ static void _thread_net(void*inContext)
       if (pcltsockt[k] == NULL) continue;
       if (pcltsockt[k]->socket == INVALID_HANDLE) continue;
 
-      // REQ_ACTION_SEND
-      if (pcltsockt[k]->clientFlag == REQ_ACTION_SEND) {
-        pcltsockt[k]->clientFlag = NO_ACTION;
-        if ((sendBuf == NULL) || (send_len < 1)) continue;
-        
-        data_sent = _send(pcltsockt[k]->socket, pcltsockt[k]->type, &(pcltsockt[k]->addr));
-        if (data_sent < 0) {
-          pcltsockt[k]->clientFlag = REQ_ACTION_DISCONNECT; 
-          net_log("[NET clt] Error sending data: %d\r\n", data_sent);
-        }
-        _queueAction(pcltsockt[k]->socket, pcltsockt[k]->sent_cb, data_sent);
-      }
-      // REQ_ACTION_DISCONNECT
-      else if ((pcltsockt[k]->clientFlag == REQ_ACTION_DISCONNECT) ||
+      // REQ_ACTION_DISCONNECT, after the data received is posted
+      if (((pcltsockt[k]->clientFlag == REQ_ACTION_DISCONNECT) && (!_recv_busy(&pcltsockt[k]->rx))) ||
                (pcltsockt[k]->clientFlag == REQ_ACTION_DISCONNECTFREE)) {
         pcltsockt[k]->state = SOCKET_STATE_NOTCONNECTED;
 
         /*if (pcltsockt[k]->ssl == 1) {
           ssl_close(pcltsockt[k]->client_ssl);
         }*/
-        if (pcltsockt[k]->clientFlag == REQ_ACTION_DISCONNECTFREE) {
+        // the socket of a net.co session is not used again
+        if ((pcltsockt[k]->clientFlag == REQ_ACTION_DISCONNECTFREE) || (pcltsockt[k]->co != NULL)) {
           pcltsockt[k]->clientFlag = NO_ACTION;
           _queueDisconnect(pcltsockt[k]->socket, pcltsockt[k]->disconnect_cb, (onNet | needUNREF));
           closeSocket(pcltsockt[k]->socket, 1);
@@ -716,9 +1416,11 @@ static void _thread_net(void*inContext)
         }
       }
       // REQ_ACTION_CONNECTED
+      // REQ_ACTION_CONNECTED
       else if (pcltsockt[k]->clientFlag == REQ_ACTION_CONNECTED) {
         pcltsockt[k]->clientFlag = NO_ACTION;
         pcltsockt[k]->state = SOCKET_STATE_CONNECTED;
+        if (pcltsockt[k]->co != NULL) pcltsockt[k]->co->connected = 1;
         _queueAction(pcltsockt[k]->socket, pcltsockt[k]->connect_cb, -99);
         /*if (pcltsockt[k]->ssl == 1) {
           ssl_version_set(TLS_V1_2_MODE);
@@ -767,6 +1469,7 @@ static void _thread_net(void*inContext)
           if (connect(pcltsockt[k]->socket, paddr, slen) < 0) {
             net_log("[NET clt] Connection error.\r\n");
           }
+          _checkConnected();
         }
       }
       // REQ_ACTION_BIND
@@ -785,37 +1488,84 @@ static void _thread_net(void*inContext)
       }
     }
     
-    // ===== step 2, Check receive/disconnect events =============================
-    // ** select all server&client socket to monitor **
+    // ===== step 2, Check receive/disconnect/send events =======================
+    // ** select all server&client socket to monitor, for writing if they have data queued **
     int maxfd = -1;
     FD_ZERO(&readset);
+    FD_ZERO(&wrset);
+    // sockets are read only while the receive pool has a free block
+    receiving = 0;
     // == Server sockets
     for (k=0; k<MAX_SVR_SOCKET; k++) {
       if (psvrsockt[k] == NULL) continue;
       if (psvrsockt[k]->socket == INVALID_HANDLE ) continue;
 
-      // = server socket (accept)
+      // = server socket (accept or recvfrom)
       if (psvrsockt[k]->socket > maxfd) maxfd = psvrsockt[k]->socket;
-      FD_SET(psvrsockt[k]->socket, &readset);
+      if ((psvrsockt[k]->type == TCP) || (recv_free != NULL)) FD_SET(psvrsockt[k]->socket, &readset);
 
       // = server client sockets (recieve or disconnect)
       for (m=0; m<MAX_SVRCLT_SOCKET; m++) {
         if (psvrsockt[k]->psvrCltsocket[m] == NULL) continue;
-        if ((psvrsockt[k]->type == UDP) || (psvrsockt[k]->psvrCltsocket[m]->client == INVALID_HANDLE)) continue;
+        _sendq_notify(&psvrsockt[k]->psvrCltsocket[m]->sq, psvrsockt[k]->psvrCltsocket[m]->client,
+                      psvrsockt[k]->sent_cb, psvrsockt[k]->drain_cb);
+        if (psvrsockt[k]->type == UDP) {
+          if (_sendq_ready(&psvrsockt[k]->psvrCltsocket[m]->sq)) FD_SET(psvrsockt[k]->socket, &wrset);
+          continue;
+        }
+        if (psvrsockt[k]->psvrCltsocket[m]->client == INVALID_HANDLE) continue;
+        // accept first, the socket is not read before
+        if (psvrsockt[k]->psvrCltsocket[m]->accept_due)
+          psvrsockt[k]->psvrCltsocket[m]->accept_due =
+            (_queueIPport(psvrsockt[k]->psvrCltsocket[m]->client, psvrsockt[k]->accept_cb,
+                          psvrsockt[k]->psvrCltsocket[m]->addr.s_ip, psvrsockt[k]->psvrCltsocket[m]->addr.s_port) != kNoErr);
+        // data received but not posted yet
+        if (_recv_busy(&psvrsockt[k]->psvrCltsocket[m]->rx)) {
+          _recv_frame(&psvrsockt[k]->psvrCltsocket[m]->rx, psvrsockt[k]->psvrCltsocket[m]->client,
+                      psvrsockt[k]->receive_cb);
+          if (_recv_busy(&psvrsockt[k]->psvrCltsocket[m]->rx)) receiving = 1;
+        }
 
         if (psvrsockt[k]->psvrCltsocket[m]->client > maxfd) 
           maxfd = psvrsockt[k]->psvrCltsocket[m]->client;
-        FD_SET(psvrsockt[k]->psvrCltsocket[m]->client, &readset);
+        // clients of a net.co server wait for their session
+        if (psvrsockt[k]->psvrCltsocket[m]->co != NULL) {
+          if (_co_reading(psvrsockt[k]->psvrCltsocket[m]->co))
+            FD_SET(psvrsockt[k]->psvrCltsocket[m]->client, &readset);
+        }
+        else if ((!psvrsockt[k]->co) && (!psvrsockt[k]->psvrCltsocket[m]->accept_due) &&
+                 (psvrsockt[k]->psvrCltsocket[m]->rx.in == NULL) && (recv_free != NULL))
+          FD_SET(psvrsockt[k]->psvrCltsocket[m]->client, &readset);
+        if (_sendq_ready(&psvrsockt[k]->psvrCltsocket[m]->sq))
+          FD_SET(psvrsockt[k]->psvrCltsocket[m]->client, &wrset);
       }
     }
     // == Client sockets
     for (k=0; k<MAX_CLT_SOCKET; k++) {
       if(pcltsockt[k] ==NULL) continue;
+      _sendq_notify(&pcltsockt[k]->sq, pcltsockt[k]->socket, pcltsockt[k]->sent_cb, pcltsockt[k]->drain_cb);
       
-      // = client socket (recieve or disconnect)
-      if (pcltsockt[k]->socket != INVALID_HANDLE) {
+      // = client socket (recieve or disconnect), not once closed: select fails on it
+      if ((pcltsockt[k]->socket != INVALID_HANDLE) && (pcltsockt[k]->state != SOCKET_STATE_CLOSED)) {
+        if (pcltsockt[k]->type == TCP) {
+          net_recv_t *rx = &pcltsockt[k]->rx;
+          if (_recv_busy(rx)) _recv_frame(rx, pcltsockt[k]->socket, pcltsockt[k]->receive_cb);
+          if (_recv_busy(rx)) receiving = 1;
+          // the answer is complete, disconnect
+          else if (_recv_answered(rx, pcltsockt[k]->socket)) pcltsockt[k]->clientFlag = REQ_ACTION_DISCONNECT;
+        }
         if (pcltsockt[k]->socket > maxfd) maxfd = pcltsockt[k]->socket;
-        FD_SET(pcltsockt[k]->socket, &readset);
+        if (pcltsockt[k]->co != NULL) {
+          if (_co_reading(pcltsockt[k]->co)) FD_SET(pcltsockt[k]->socket, &readset);
+        }
+        else if ((pcltsockt[k]->rx.in == NULL) && (recv_free != NULL)) FD_SET(pcltsockt[k]->socket, &readset);
+        // not read this round, the quiet time starts again
+        else if (pcltsockt[k]->rx.last != 0) pcltsockt[k]->rx.last = mico_get_time() | 1;
+        // tcp data waits for the connection, udp for the address
+        if (_sendq_ready(&pcltsockt[k]->sq) &&
+            (((pcltsockt[k]->type == TCP) && (pcltsockt[k]->state == SOCKET_STATE_CONNECTED)) ||
+             ((pcltsockt[k]->type == UDP) && (pcltsockt[k]->state == SOCKET_STATE_READY))))
+          FD_SET(pcltsockt[k]->socket, &wrset);
       }
     }
     if (maxfd < 0) continue; // nothing to check
@@ -823,10 +1573,42 @@ static void _thread_net(void*inContext)
     // === Check event ===
     mico_rtos_unlock_mutex(&net_mut);
     t_val.tv_sec = 0;
-    t_val.tv_usec = 10*1000;
-    if (select(maxfd+1, &readset, NULL, NULL, &t_val) <= 0) continue; // no event
+    t_val.tv_usec = ((sending) || (receiving)) ? 1000 : 10*1000;
+    n = select(maxfd+1, &readset, &wrset, NULL, &t_val);
     mico_rtos_lock_mutex(&net_mut);
-    
+    if (n <= 0) continue; // no event
+    idle = 0;
+
+    // **** Send queued data, one chunk per writable socket ***
+    for (k=0; k<MAX_SVR_SOCKET; k++) {
+      if (psvrsockt[k] == NULL) continue;
+      if (psvrsockt[k]->socket == INVALID_HANDLE ) continue;
+
+      for (m=0; m<MAX_SVRCLT_SOCKET; m++) {
+        _lsvrCltsocket_t *sc = psvrsockt[k]->psvrCltsocket[m];
+        if ((sc == NULL) || (sc->sq.head == NULL) || (sc->client == INVALID_HANDLE)) continue;
+        int fd = (psvrsockt[k]->type == TCP) ? sc->client : psvrsockt[k]->socket;
+        if (!FD_ISSET(fd, &wrset)) continue;
+
+        if (_sendq_run(&sc->sq, sc->client, fd, psvrsockt[k]->type, &sc->addr,
+                       psvrsockt[k]->sent_cb, psvrsockt[k]->drain_cb) < 0)
+          net_log("[NET scl] Error sending data\r\n");
+        sent_time = mico_get_time();
+      }
+    }
+    for (k=0; k<MAX_CLT_SOCKET; k++) {
+      if ((pcltsockt[k] == NULL) || (pcltsockt[k]->sq.head == NULL)) continue;
+      if (pcltsockt[k]->socket == INVALID_HANDLE) continue;
+      if (!FD_ISSET(pcltsockt[k]->socket, &wrset)) continue;
+
+      if (_sendq_run(&pcltsockt[k]->sq, pcltsockt[k]->socket, pcltsockt[k]->socket, pcltsockt[k]->type,
+                     &pcltsockt[k]->addr, pcltsockt[k]->sent_cb, pcltsockt[k]->drain_cb) < 0) {
+        pcltsockt[k]->clientFlag = REQ_ACTION_DISCONNECT;
+        net_log("[NET clt] Error sending data\r\n");
+      }
+      sent_time = mico_get_time();
+    }
+
     // **** Analyze server sockets events ***
     for (k=0; k<MAX_SVR_SOCKET; k++) {
       if (psvrsockt[k] == NULL) continue;
@@ -860,8 +1642,12 @@ static void _thread_net(void*inContext)
             psvrsockt[k]->psvrCltsocket[mi]->addr.s_port= clientaddr.s_port;
             psvrsockt[k]->psvrCltsocket[mi]->clientFlag = NO_ACTION;
             psvrsockt[k]->psvrCltsocket[mi]->state = SOCKET_STATE_CONNECTED;
+            _sendq_init(&psvrsockt[k]->psvrCltsocket[mi]->sq);
+            _recv_init(&psvrsockt[k]->psvrCltsocket[mi]->rx, psvrsockt[k]->http);
+            psvrsockt[k]->psvrCltsocket[mi]->co = NULL;
             // call accept cb function
-            _queueIPport(clientTmp, psvrsockt[k]->accept_cb, clientaddr.s_ip, clientaddr.s_port); 
+            psvrsockt[k]->psvrCltsocket[mi]->accept_due =
+              (_queueIPport(clientTmp, psvrsockt[k]->accept_cb, clientaddr.s_ip, clientaddr.s_port) != kNoErr);
           }
           else {
             net_log("[NET srv] Accept Error.\r\n" );
@@ -872,16 +1658,15 @@ static void _thread_net(void*inContext)
         if (FD_ISSET(psvrsockt[k]->socket, &readset)) {
           // == Server UDP socket (recvfrom) ==
           struct sockaddr_t clientaddr;
-          uint8_t stat = 1;
+          int res = 0;
           char sip[17];
           memset(sip, 0x00, 17);
 
-          int received = _receive(psvrsockt[k]->socket, UDP, &clientaddr, &stat);
-          if (received <= 0) {
-            psvrsockt[k]->clientFlag = REQ_ACTION_DISCONNECT;
+          net_block_t *b = _recv_udp(psvrsockt[k]->socket, &clientaddr, &res);
+          if (b == NULL) {
+            if (res < 0) psvrsockt[k]->clientFlag = REQ_ACTION_DISCONNECT;
             continue;
           }
-          recvBuf[received] = 0x00;
           int mi = 0;
           // == check if we already have the server client socket with the same client address
           for (mi=0; mi<MAX_SVRCLT_SOCKET; mi++) {
@@ -904,18 +1689,24 @@ static void _thread_net(void*inContext)
           psvrsockt[k]->psvrCltsocket[mi] = (_lsvrCltsocket_t*)malloc(sizeof(_lsvrCltsocket_t));
           if (psvrsockt[k]->psvrCltsocket[mi] == NULL) {
             net_log("[NET srv] Client memory allocation failed");
+            _recv_put(b);
             continue;
           }
           psvrsockt[k]->psvrCltsocket[mi]->client = 32767 - mi;
           psvrsockt[k]->psvrCltsocket[mi]->addr.s_ip = clientaddr.s_ip;
           psvrsockt[k]->psvrCltsocket[mi]->addr.s_port = clientaddr.s_port;
           psvrsockt[k]->psvrCltsocket[mi]->clientFlag = NO_ACTION;
+          _sendq_init(&psvrsockt[k]->psvrCltsocket[mi]->sq);
+          _recv_init(&psvrsockt[k]->psvrCltsocket[mi]->rx, 0);
+          psvrsockt[k]->psvrCltsocket[mi]->co = NULL;
+          psvrsockt[k]->psvrCltsocket[mi]->accept_due = 0;
             
           doUdpRecieve:
             inet_ntoa(sip, clientaddr.s_ip);
             net_log("[NET udp] UDP Received from %s:%d\r\n", sip, clientaddr.s_port);
-            data_received = received;
-            _queueReceive(psvrsockt[k]->psvrCltsocket[mi]->client, psvrsockt[k]->receive_cb, received, 0, 0);
+            // the message queue is full: the datagram is dropped
+            if (_queueRecv(psvrsockt[k]->psvrCltsocket[mi]->client, psvrsockt[k]->receive_cb, b, NULL) != kNoErr)
+              _recv_put(b);
          } //if(FD_ISSET...
        }
       
@@ -925,17 +1716,20 @@ static void _thread_net(void*inContext)
         if ((psvrsockt[k]->type == UDP) || (psvrsockt[k]->psvrCltsocket[m]->client == INVALID_HANDLE)) continue;
         
         if (FD_ISSET(psvrsockt[k]->psvrCltsocket[m]->client, &readset)) {
+          // into the buffer of the net.co session
+          if (psvrsockt[k]->psvrCltsocket[m]->co != NULL) {
+            if (_co_recv(psvrsockt[k]->psvrCltsocket[m]->co, psvrsockt[k]->psvrCltsocket[m]->client) < 0)
+              psvrsockt[k]->psvrCltsocket[m]->clientFlag = REQ_ACTION_DISCONNECT;
+            continue;
+          }
           //tcp read  recv
-          uint8_t stat = 1;
-          int received = _receive(psvrsockt[k]->psvrCltsocket[m]->client, TCP, NULL, &stat);
-          if (received <= 0) {
+          if (_recv_tcp(&psvrsockt[k]->psvrCltsocket[m]->rx, psvrsockt[k]->psvrCltsocket[m]->client) < 0) {
             psvrsockt[k]->psvrCltsocket[m]->clientFlag = REQ_ACTION_DISCONNECT;
             continue;
           }
           // success call recieve_cb
-          recvBuf[received] = 0x00;
-          data_received = received;
-          _queueReceive(psvrsockt[k]->psvrCltsocket[m]->client, psvrsockt[k]->receive_cb, received, 0, 0);
+          _recv_frame(&psvrsockt[k]->psvrCltsocket[m]->rx, psvrsockt[k]->psvrCltsocket[m]->client,
+                      psvrsockt[k]->receive_cb);
         }
       }
     }
@@ -948,50 +1742,46 @@ static void _thread_net(void*inContext)
       if (FD_ISSET(pcltsockt[k]->socket, &readset)) {
         if (pcltsockt[k]->type == TCP) {
           // == TCP client: recieve or disconnect ==
-          uint8_t stat = 1;
-          int received = 0;
-          /*if (pcltsockt[k]->ssl == 1) {
-            received = ssl_recv(pcltsockt[k]->client_ssl, recvBuf, MAX_RECV_LEN-1);
+          net_recv_t *rx = &pcltsockt[k]->rx;
+          if (pcltsockt[k]->co != NULL) {
+            if (_co_recv(pcltsockt[k]->co, pcltsockt[k]->socket) < 0)
+              pcltsockt[k]->clientFlag = REQ_ACTION_DISCONNECT;
+            continue;
+          }
+          if (rx->last == 0) {
+            // a new answer, framed if the socket uses http
+            rx->http = (pcltsockt[k]->http > 0) ? 2 : 0;
+            rx->state = (rx->http) ? RECV_HEAD : RECV_RAW;
           }
-          else {*/
-            received = _receive(pcltsockt[k]->socket, TCP, NULL, &stat);
-          //}
-          if ((recvBuf == NULL) || (received <= 0)) {
+          if (_recv_tcp(rx, pcltsockt[k]->socket) < 0) {
             //net_log("[NET clt] TCP Disconnect skt: %d\r\n", k);
             pcltsockt[k]->clientFlag = REQ_ACTION_DISCONNECT;
             continue;
           }
-          // success, call recieve_cb
-          recvBuf[received] = 0x00;
-          data_received = received;
-          _queueReceive(pcltsockt[k]->socket, pcltsockt[k]->receive_cb,
-                        received, pcltsockt[k]->http, pcltsockt[k]->wait_tmo); 
-
-          if (stat) pcltsockt[k]->clientFlag = REQ_ACTION_DISCONNECT;
+          // success, call recieve_cb; disconnected when the answer is complete
+          _recv_frame(rx, pcltsockt[k]->socket, pcltsockt[k]->receive_cb);
         }
         else if (pcltsockt[k]->type == UDP) {
           // == UDP client: recieve or disconnect ==
           struct sockaddr_t clientaddr;
-          uint8_t stat = 1;
-          int received = _receive(pcltsockt[k]->socket, UDP, &clientaddr, &stat);
-          if (received <= 0) {
+          int res = 0;
+          net_block_t *b = _recv_udp(pcltsockt[k]->socket, &clientaddr, &res);
+          if (b == NULL) {
             //net_log("[NET clt] UDP Disconnect skt: %d\r\n", k);
-            pcltsockt[k]->clientFlag = REQ_ACTION_DISCONNECT;
+            if (res < 0) pcltsockt[k]->clientFlag = REQ_ACTION_DISCONNECT;
             continue;
           }
-          // success, call recieve_cb
-          recvBuf[received]=0x00;
-          data_received = received;
-          _queueReceive(pcltsockt[k]->socket, pcltsockt[k]->receive_cb,
-                        received, 0, pcltsockt[k]->wait_tmo);
+          // success, call recieve_cb; a datagram is the answer in wait mode
+          int received = b->len;
+          if (_queueRecv(pcltsockt[k]->socket, pcltsockt[k]->receive_cb, b, NULL) != kNoErr) _recv_put(b);
+          else if (pcltsockt[k]->socket == recv_waiting) data_received = received;
         }
       }
     }
   } // while(1)
 
 terminate:
-  free(recvBuf);
-  recvBuf = NULL;
+  // the receive pool stays, messages may hold its blocks
   free(sendBuf);
   sendBuf = NULL;
   net_thread_is_started = false;
@@ -1186,6 +1976,12 @@ static int lnet_new( lua_State* L )
   if (gL == NULL) gL = L;
 
   mico_rtos_lock_mutex(&net_mut);
+  // the receive pool, allocated once
+  if (_recv_pool_init() != kNoErr) {
+    net_log("Memory allocation failed\r\n" );
+    err = (socketType == SOCKET_SERVER) ? -5 : -7;
+    goto errexit;
+  }
   if (socketType == SOCKET_SERVER) { // ** server socker
     int k = 0;
     for(k = 0; k<MAX_SVR_SOCKET; k++){
@@ -1209,9 +2005,12 @@ static int lnet_new( lua_State* L )
     psvrsockt[k]->accept_cb = LUA_NOREF;
     psvrsockt[k]->receive_cb = LUA_NOREF;
     psvrsockt[k]->sent_cb = LUA_NOREF;
+    psvrsockt[k]->drain_cb = LUA_NOREF;
     psvrsockt[k]->disconnect_cb = LUA_NOREF;
     psvrsockt[k]->clientFlag = NO_ACTION;
     psvrsockt[k]->state = SOCKET_STATE_NOTCONNECTED;
+    psvrsockt[k]->http = 0;
+    psvrsockt[k]->co = 0;
     for (int m=0; m<MAX_SVRCLT_SOCKET; m++) {
       psvrsockt[k]->psvrCltsocket[m] = NULL;
     }
@@ -1238,12 +2037,17 @@ static int lnet_new( lua_State* L )
     pcltsockt[k]->dnsfound_cb = LUA_NOREF;
     pcltsockt[k]->receive_cb = LUA_NOREF;
     pcltsockt[k]->sent_cb = LUA_NOREF;
+    pcltsockt[k]->drain_cb = LUA_NOREF;
     pcltsockt[k]->disconnect_cb = LUA_NOREF;
     pcltsockt[k]->clientFlag = NO_ACTION;
     pcltsockt[k]->state = SOCKET_STATE_NOTCONNECTED;
     pcltsockt[k]->pDomain4Dns = NULL;
     pcltsockt[k]->local_port = -1;
     pcltsockt[k]->http = 0;
+    pcltsockt[k]->wait_tmo = 0;
+    _sendq_init(&pcltsockt[k]->sq);
+    _recv_init(&pcltsockt[k]->rx, 0);
+    pcltsockt[k]->co = NULL;
     //pcltsockt[k]->ssl = 0;
     //pcltsockt[k]->client_ssl = NULL;
   }
@@ -1271,20 +2075,27 @@ errexit1:
 }
 
 //net.send(socket,"data",[post_data],[options])
+// The data is queued and sent by the net thread, the string is kept until
+// then. 0: queued, 1: queued and the socket's queue is over its high water
+// mark, send more on the "drain" callback. -4: queue full, nothing queued
 //==================================
 static int lnet_send( lua_State* L )
 {
   int socketHandle = luaL_checkinteger( L, 1 );
   int type=0, k=0, m=0;
   int err = 0;
+  int ref;
   size_t len=0;
   const char *data = NULL;
+  net_sendq_t *q;
+  uint8_t udp;
   uint8_t oldhttp = 0xFF;
   uint16_t oldwait = 0xFFFF;
   int cbsend = LUA_NOREF;
   int cbrecv = LUA_NOREF;
   
   mico_rtos_lock_mutex(&net_mut);
+  _sendq_release(L);
   if (false == getsocketIndex(socketHandle,&type,&k,&m)) {
     err = -1;
     net_log("Socket is not valid\r\n" );
@@ -1301,21 +2112,29 @@ static int lnet_send( lua_State* L )
     net_log("Can't send on server socket\r\n" );
     goto exit1;
   }
-  if (pcltsockt[k]->state == SOCKET_STATE_CLOSED) {
+  if ((type == SOCKET_TYPE_CLIENT) && (pcltsockt[k]->state == SOCKET_STATE_CLOSED)) {
     err = -3;
     net_log("Socket not connected\r\n" );
     goto exit1;
   }
-  if (sendBuf != NULL) {
+  if (type == SOCKET_TYPE_SVRCLT) {
+    q = &psvrsockt[k]->psvrCltsocket[m]->sq;
+    udp = (psvrsockt[k]->type == UDP);
+  }
+  else {
+    q = &pcltsockt[k]->sq;
+    udp = (pcltsockt[k]->type == UDP);
+  }
+  if (q->queued >= (2 * q->high)) {
     err = -4;
-    net_log("Previous data not sent\r\n" );
+    net_log("Send queue full\r\n" );
     goto exit1;
   }
   
   data = luaL_checklstring( L, 2, &len );
-  if ((len < 1) || (len > 975) || (data == NULL)) {
+  if ((len < 1) || (data == NULL) || (udp && (len > MAX_UDP_SEND))) {
     err = -5;
-    net_log("Data length must be < 976\r\n" );
+    net_log("Data length must be > 0, < 976 for UDP\r\n" );
     goto exit1;
   }
 
@@ -1325,9 +2144,6 @@ static int lnet_send( lua_State* L )
     goto exit1;
   }
 
-  free(sendBuf);
-  sendBuf = NULL;
-
   if (type == SOCKET_TYPE_CLIENT) {
     oldhttp = pcltsockt[k]->http;
     oldwait = pcltsockt[k]->wait_tmo;
@@ -1337,21 +2153,21 @@ static int lnet_send( lua_State* L )
   }
   
   if ((type != SOCKET_TYPE_CLIENT) || (pcltsockt[k]->type != TCP) || (pcltsockt[k]->http == 0)) {
-    sendBuf = (char*)malloc(len+1);
-    if (sendBuf == NULL) {
+    // queue the lua string itself, referenced until sent
+    lua_pushvalue(L, 2);
+    ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    err = _sendq_put(q, data, len, ref, NULL);
+    if (err < 0) {
+      luaL_unref(L, LUA_REGISTRYINDEX, ref);
       err = -7;
       net_log("Memory allocation error.\r\n" );
       goto exit;
     }
-    memcpy(sendBuf, data, len);
-    sendBuf[len] = 0x00;
-    send_len = len;
   }
   
   if (type == SOCKET_TYPE_SVRCLT) {
     // ** tcp or udp server client socket
     data_sent = -99;
-    psvrsockt[k]->psvrCltsocket[m]->clientFlag = REQ_ACTION_SEND;
   }
   else {
     // ** tcp or udp client socket
@@ -1359,6 +2175,7 @@ static int lnet_send( lua_State* L )
     // get additional options
     
     if ((pcltsockt[k]->type == TCP) && (pcltsockt[k]->http > 0)) {
+      free(sendBuf);
       sendBuf = (char*)malloc(len+128);
       if (sendBuf == NULL) {
         err = -7;
@@ -1389,11 +2206,22 @@ static int lnet_send( lua_State* L )
         net_log("HTTP request must start wiht 'GET ' or 'POST '\r\n" );
         goto exit;
       }
+      // the request goes to the queue, freed when sent
+      err = _sendq_put(q, sendBuf, send_len, LUA_NOREF, NULL);
+      if (err < 0) {
+        free(sendBuf);
+        err = -7;
+      }
+      sendBuf = NULL;
+      send_len = 0;
+      if (err < 0) {
+        net_log("Memory allocation error.\r\n" );
+        goto exit;
+      }
     }
     
     data_sent = -99;
     data_received = -99;
-    pcltsockt[k]->clientFlag = REQ_ACTION_SEND;
     
     if (pcltsockt[k]->wait_tmo > 0) {
       // save cb functions and disable then
@@ -1401,6 +2229,10 @@ static int lnet_send( lua_State* L )
       pcltsockt[k]->sent_cb = LUA_NOREF;
       cbrecv = pcltsockt[k]->receive_cb;
       pcltsockt[k]->receive_cb = LUA_NOREF;
+      // the answer is gathered in receive pool blocks
+      _recv_put(recv_wait);
+      recv_wait = NULL;
+      recv_waiting = pcltsockt[k]->socket;
 
       // *** wait until sent ***
       int tmo = mico_get_time();
@@ -1431,11 +2263,16 @@ static int lnet_send( lua_State* L )
         lua_pushnil(L);
       }
       else {
+        luaL_Buffer b;
+        net_block_t *p;
         lua_pushinteger(L, 0);
-        lua_pushstring(L, recvBuf);
-        free(recvBuf);
-        recvBuf = NULL;
+        luaL_buffinit(L, &b);
+        for (p = recv_wait; p != NULL; p = p->next) luaL_addlstring(&b, p->data, p->len);
+        luaL_pushresult(&b);
       }
+      recv_waiting = INVALID_HANDLE;
+      _recv_put(recv_wait);
+      recv_wait = NULL;
       if (oldhttp != 0xFF) pcltsockt[k]->http = oldhttp;
       if (oldwait != 0xFFFF) pcltsockt[k]->wait_tmo = oldwait;
       if (cbsend != LUA_NOREF) pcltsockt[k]->sent_cb = cbsend;
@@ -1445,10 +2282,10 @@ static int lnet_send( lua_State* L )
       return 2;
     }
   }
-  err = 0;
   
 exit:
   if (type == SOCKET_TYPE_CLIENT) {
+    recv_waiting = INVALID_HANDLE;
     if (oldhttp != 0xFF) pcltsockt[k]->http = oldhttp;
     if (oldwait != 0xFFFF) pcltsockt[k]->wait_tmo = oldwait;
     if (cbsend != LUA_NOREF) pcltsockt[k]->sent_cb = cbsend;
@@ -1461,7 +2298,115 @@ exit1:
 }
 
 
-//net.start(socket,port)
+//net.sendfile(socket,"file",[offset],[len],[done_cb])  //done_cb(socket,bytes)
+// Queues a spiffs file on a tcp socket, after what is queued already. The
+// net thread reads and sends it a piece at a time, it is never in memory
+// whole. len: to the end of the file by default. done gets the bytes sent,
+// -1 if the queue was dropped. Returns as net.send, -5: no such file,
+// offset past its end or not a tcp socket
+//======================================
+static int lnet_sendfile( lua_State* L )
+{
+  int socketHandle = luaL_checkinteger( L, 1 );
+  int type=0, k=0, m=0;
+  int err = 0;
+  int offset = 0;
+  int len = -1;
+  int top = lua_gettop(L);
+  size_t sl;
+  const char *path = luaL_checklstring( L, 2, &sl );
+  net_sendq_t *q;
+  net_sendfile_t *f = NULL;
+  spiffs_stat st;
+
+  // done_cb is the last argument
+  if ((top >= 3) && ((lua_type(L, top) == LUA_TFUNCTION) || (lua_type(L, top) == LUA_TLIGHTFUNCTION))) top--;
+  if (top >= 3) offset = luaL_checkinteger( L, 3 );
+  if (top >= 4) len = luaL_checkinteger( L, 4 );
+
+  mico_rtos_lock_mutex(&net_mut);
+  _sendq_release(L);
+  if (false == getsocketIndex(socketHandle,&type,&k,&m)) {
+    err = -1;
+    net_log("Socket is not valid\r\n" );
+    goto exit;
+  }
+  if (!wifiConnected) {
+    net_log("WiFi not active\r\n" );
+    err = -9;
+    goto exit;
+  }
+  if (type == SOCKET_TYPE_SERVER) {
+    err = -2;
+    net_log("Can't send on server socket\r\n" );
+    goto exit;
+  }
+  if ((type == SOCKET_TYPE_CLIENT) && (pcltsockt[k]->state == SOCKET_STATE_CLOSED)) {
+    err = -3;
+    net_log("Socket not connected\r\n" );
+    goto exit;
+  }
+  if (!net_thread_is_started) {
+    err = -6;
+    net_log("Net thread not started!\r\n" );
+    goto exit;
+  }
+  if (type == SOCKET_TYPE_SVRCLT) {
+    q = &psvrsockt[k]->psvrCltsocket[m]->sq;
+    if (psvrsockt[k]->type != TCP) err = -5;
+  }
+  else {
+    q = &pcltsockt[k]->sq;
+    if (pcltsockt[k]->type != TCP) err = -5;
+  }
+  if (err < 0) {
+    net_log("Files are sent on tcp sockets only\r\n" );
+    goto exit;
+  }
+
+  f = (net_sendfile_t*)malloc(sizeof(net_sendfile_t));
+  if (f == NULL) {
+    err = -7;
+    net_log("Memory allocation error.\r\n" );
+    goto exit;
+  }
+  if ((!SPIFFS_mounted(&fs)) || (checkFileName(sl, path, f->path, 1, 0) != 1) ||
+      (SPIFFS_stat(&fs, f->path, &st) != SPIFFS_OK) ||
+      (offset < 0) || (offset >= (int)st.size)) {
+    err = -5;
+    net_log("File not found or offset past its end\r\n" );
+    goto exit;
+  }
+  if ((len < 0) || (len > ((int)st.size - offset))) len = st.size - offset;
+
+  f->fd = 0;
+  f->foff = offset;
+  f->socket = socketHandle;
+  f->done_cb = LUA_NOREF;
+  f->nofd = 0;
+  f->buf = NULL;
+  f->blen = 0;
+  f->bpos = 0;
+  err = _sendq_put(q, NULL, len, LUA_NOREF, f);
+  if (err < 0) {
+    err = -7;
+    net_log("Memory allocation error.\r\n" );
+    goto exit;
+  }
+  f = NULL; // the queue's now
+  if (lua_gettop(L) > top) {
+    lua_pushvalue(L, top+1);
+    q->tail->file->done_cb = luaL_ref(L, LUA_REGISTRYINDEX);
+  }
+
+exit:
+  free(f);
+  mico_rtos_unlock_mutex(&net_mut);
+  lua_pushinteger(L, err);
+  return 1;
+}
+
+//net.start(socket,port,[options])   server, options: {http=1} frames the requests
 //net.start(socket,port,"domain",[options])
 //===================================
 static int lnet_start( lua_State* L )
@@ -1497,6 +2442,13 @@ static int lnet_start( lua_State* L )
     //setsockopt(socketHandle,0,TCP_MAX_CONN_NUM,&opt,1); //max client num
 
     psvrsockt[k]->port = port;
+    psvrsockt[k]->http = 0;
+    if (lua_istable(L, 3)) {
+      lua_getfield(L, 3, "http");
+      if ((psvrsockt[k]->type == TCP) && (lua_isnumber(L, -1)) && (lua_tointeger(L, -1) > 0))
+        psvrsockt[k]->http = 1;
+      lua_pop(L, 1);
+    }
     psvrsockt[k]->clientFlag = REQ_ACTION_BIND;
   }
   else {
@@ -1619,6 +2571,7 @@ static int lnet_close( lua_State* L )
   int type=0,k=0,m=0;
   
   mico_rtos_lock_mutex(&net_mut);
+  _sendq_release(L);
   if (getsocketIndex(socketHandle,&type,&k,&m) == false) {
     mico_rtos_unlock_mutex(&net_mut);
     net_log("Socket is not valid\r\n" );
@@ -1648,16 +2601,430 @@ static int lnet_close( lua_State* L )
   return 1;
 }
 
+//bytes, high = net.queued(socket,[high])
+// bytes waiting in the send queue of a socket and its high water mark,
+// optionally set to high (512..65536). -1 if not a socket that sends
+//====================================
+static int lnet_queued( lua_State* L )
+{
+  int socketHandle = luaL_checkinteger( L, 1 );
+  int type=0, k=0, m=0;
+  net_sendq_t *q;
+
+  mico_rtos_lock_mutex(&net_mut);
+  _sendq_release(L);
+  if ((false == getsocketIndex(socketHandle,&type,&k,&m)) || (type == SOCKET_TYPE_SERVER)) {
+    mico_rtos_unlock_mutex(&net_mut);
+    net_log("Socket is not valid\r\n" );
+    lua_pushinteger(L, -1);
+    return 1;
+  }
+  if (type == SOCKET_TYPE_SVRCLT) q = &psvrsockt[k]->psvrCltsocket[m]->sq;
+  else q = &pcltsockt[k]->sq;
+
+  if (lua_gettop(L) >= 2) {
+    int high = luaL_checkinteger( L, 2 );
+    if ((high >= MIN_SEND_HIGH) && (high <= MAX_SEND_HIGH)) q->high = high;
+    else net_log("High mark must be %d..%d\r\n", MIN_SEND_HIGH, MAX_SEND_HIGH);
+  }
+  lua_pushinteger(L, q->queued);
+  lua_pushinteger(L, q->high);
+  mico_rtos_unlock_mutex(&net_mut);
+  return 2;
+}
+
+// ==== net.co: sessions, coroutines talking on tcp sockets ====
+
+// Removes a session from co_list, net_mut locked
+//-------------------------------------
+static void _co_unlink( net_co_t *co )
+{
+  net_co_t **p;
+
+  for (p = &co_list; *p != NULL; p = &(*p)->next) {
+    if (*p == co) {
+      *p = co->next;
+      break;
+    }
+  }
+}
+
+// The results of the wait of a session on its stack, net_mut locked
+//---------------------------------------
+static int _co_results( net_co_t *co )
+{
+  lua_State *L = co->L;
+  uint8_t want = co->want;
+  char *p;
+  int n = 0;
+
+  co->want = CO_NONE;
+  switch (want) {
+    case CO_READ:
+      n = (co->len < co->need) ? co->len : co->need;
+      break;
+    case CO_LINE:
+      p = (char*)memchr(co->buf, '\n', co->len);
+      if (p == NULL) {
+        // a line longer than the buffer comes in pieces, the last one at the close
+        n = co->len;
+        break;
+      }
+      n = p - co->buf;
+      lua_pushlstring(L, co->buf, ((n > 0) && (co->buf[n-1] == '\r')) ? n-1 : n);
+      n++;
+      co->len -= n;
+      memmove(co->buf, co->buf + n, co->len);
+      return 1;
+    case CO_WRITE:
+      if (co->socket == INVALID_HANDLE) break;
+      lua_pushinteger(L, co->need);
+      return 1;
+    case CO_CONNECT:
+      if (co->connected) {
+        lua_pushboolean(L, 1);
+        return 1;
+      }
+      lua_pushnil(L);
+      lua_pushstring(L, (co->socket == INVALID_HANDLE) ? "closed" : "timeout");
+      return 2;
+    default:
+      return 0;
+  }
+  if (n == 0) {
+    lua_pushnil(L);
+    lua_pushstring(L, "closed");
+    return 2;
+  }
+  lua_pushlstring(L, co->buf, n);
+  co->len -= n;
+  memmove(co->buf, co->buf + n, co->len);
+  return 1;
+}
+
+// The session is over: its references go, the userdata is collected
+//----------------------------------------------------
+static void _co_release( lua_State* L, net_co_t *co )
+{
+  luaL_unref(L, LUA_REGISTRYINDEX, co->thread);
+  luaL_unref(L, LUA_REGISTRYINDEX, co->self);
+  co->thread = LUA_NOREF;
+  co->self = LUA_NOREF;
+  co->L = NULL;
+}
+
+// The session function returned or failed: the socket is closed when what
+// it wrote is sent, the session is released then
+//------------------------------------------------
+static void _co_end( lua_State* L, net_co_t *co )
+{
+  mico_rtos_lock_mutex(&net_mut);
+  if (co->socket != INVALID_HANDLE) {
+    co->closing = 1;
+    co->want = CO_END;
+    mico_rtos_unlock_mutex(&net_mut);
+    return;
+  }
+  _co_unlink(co);
+  mico_rtos_unlock_mutex(&net_mut);
+  _co_release(L, co);
+}
+
+// Resumes a session with nargs values on its stack, up to its next wait
+//-----------------------------------------------------------
+static void _co_run( lua_State* L, net_co_t *co, int nargs )
+{
+  int status;
+
+  lua_setlevel(L, co->L);
+  status = lua_resume(co->L, nargs);
+  if (status == LUA_YIELD) {
+    lua_settop(co->L, 0);
+    mico_rtos_lock_mutex(&net_mut);
+    // coroutine.yield(), not a socket call: goes on in the next round
+    if (co->want == CO_NONE) co->want = CO_YIELD;
+    mico_rtos_unlock_mutex(&net_mut);
+    return;
+  }
+  if (status != 0) l_message(NULL, lua_isstring(co->L, -1) ? lua_tostring(co->L, -1) : "net.co: error");
+  _co_end(L, co);
+}
+
+// Called from the lua thread for each onNetCo message (see do_queue_task):
+// the wait of the session is over, it goes on
+//----------------------------------------------
+void _net_co_resume( lua_State* L, void* pco )
+{
+  net_co_t *co = (net_co_t*)pco;
+  int n;
+
+  mico_rtos_lock_mutex(&net_mut);
+  co->posted = 0;
+  if (co->want == CO_END) {
+    _co_unlink(co);
+    mico_rtos_unlock_mutex(&net_mut);
+    _co_release(L, co);
+    return;
+  }
+  n = _co_results(co);
+  mico_rtos_unlock_mutex(&net_mut);
+  _co_run(L, co, n);
+}
+
+// Makes the session of a tcp client or server client socket and runs it up
+// to its first wait: the function at index f, its arguments above it
+//------------------------------------------------------------
+static int _co_start( lua_State* L, int socketHandle, int f )
+{
+  int type=0, k=0, m=0, err=0, i;
+  int top = lua_gettop(L);
+  net_co_t **pco = NULL;
+  net_sendq_t *q = NULL;
+  lua_State *NL;
+
+  luaL_checktype(L, f, LUA_TFUNCTION);
+  net_co_t *co = (net_co_t*)lua_newuserdata(L, sizeof(net_co_t));
+  memset(co, 0, sizeof(net_co_t));
+  co->socket = socketHandle;
+  co->thread = LUA_NOREF;
+  co->self = LUA_NOREF;
+  luaL_getmetatable(L, NET_CO_META);
+  lua_setmetatable(L, -2);
+  NL = lua_newthread(L);
+
+  mico_rtos_lock_mutex(&net_mut);
+  if (false == getsocketIndex(socketHandle,&type,&k,&m)) err = -1;
+  else if (type == SOCKET_TYPE_SVRCLT) {
+    if (psvrsockt[k]->type != TCP) err = -5;
+    pco = &psvrsockt[k]->psvrCltsocket[m]->co;
+    q = &psvrsockt[k]->psvrCltsocket[m]->sq;
+    co->connected = 1;
+  }
+  else if (type == SOCKET_TYPE_CLIENT) {
+    if (pcltsockt[k]->type != TCP) err = -5;
+    else if (pcltsockt[k]->state == SOCKET_STATE_CLOSED) err = -3;
+    pco = &pcltsockt[k]->co;
+    q = &pcltsockt[k]->sq;
+    co->connected = (pcltsockt[k]->state == SOCKET_STATE_CONNECTED);
+  }
+  else err = -2;
+  if ((err == 0) && (*pco != NULL)) err = -4;
+  if (err < 0) {
+    mico_rtos_unlock_mutex(&net_mut);
+    net_log("Not a tcp client or server client socket, or it has a session\r\n" );
+    lua_settop(L, top);
+    return err;
+  }
+  co->sq = q;
+  co->L = NL;
+  co->next = co_list;
+  co_list = co;
+  *pco = co;
+  mico_rtos_unlock_mutex(&net_mut);
+
+  co->thread = luaL_ref(L, LUA_REGISTRYINDEX);
+  lua_pushvalue(L, -1);
+  co->self = luaL_ref(L, LUA_REGISTRYINDEX);
+  // session(sock, ...)
+  lua_pushvalue(L, f);
+  lua_insert(L, -2);
+  lua_xmove(L, NL, 2);
+  for (i=f+1; i<=top; i++) {
+    lua_pushvalue(L, i);
+    lua_xmove(L, NL, 1);
+  }
+  lua_settop(L, top);
+  _co_run(L, co, top - f + 1);
+  return 0;
+}
+
+// The session of the socket object, called from its coroutine
+//-------------------------------------------
+static net_co_t *_co_check( lua_State* L )
+{
+  net_co_t *co = (net_co_t*)luaL_checkudata(L, 1, NET_CO_META);
+
+  if (co->L != L) luaL_error(L, "not in the session of this socket");
+  return co;
+}
+
+// Returns the results of want if it is there already, else the session
+// waits for it
+//-----------------------------------------------------------------
+static int _co_wait( lua_State* L, net_co_t *co, uint8_t want, int need )
+{
+  int n;
+
+  mico_rtos_lock_mutex(&net_mut);
+  co->want = want;
+  co->need = need;
+  co->since = mico_get_time();
+  if (_co_ready(co)) {
+    n = _co_results(co);
+    mico_rtos_unlock_mutex(&net_mut);
+    return n;
+  }
+  mico_rtos_unlock_mutex(&net_mut);
+  return lua_yield(L, 0);
+}
+
+//sock:read(n)   n bytes (1..512), fewer at the close; nil,"closed" after it
+//==================================
+static int lco_read( lua_State* L )
+{
+  net_co_t *co = _co_check(L);
+  int n = luaL_checkinteger( L, 2 );
+
+  luaL_argcheck(L, (n > 0) && (n <= NET_CO_BUF), 2, "1..512 bytes");
+  return _co_wait(L, co, CO_READ, n);
+}
+
+//sock:readline()   a line without its "\n" or "\r\n"; nil,"closed"
+// Lines longer than 512 bytes come in pieces, the last line without its
+// end at the close
+//======================================
+static int lco_readline( lua_State* L )
+{
+  return _co_wait(L, _co_check(L), CO_LINE, 0);
+}
+
+//sock:write("data")   queued as net.send does; waits while the send queue is
+// over its high water mark. #data, or nil,"closed"
+//===================================
+static int lco_write( lua_State* L )
+{
+  net_co_t *co = _co_check(L);
+  size_t len = 0;
+  const char *data = luaL_checklstring( L, 2, &len );
+  int ref, err;
+
+  lua_pushvalue(L, 2);
+  ref = luaL_ref(L, LUA_REGISTRYINDEX);
+  mico_rtos_lock_mutex(&net_mut);
+  _sendq_release(L);
+  if ((co->sq == NULL) || (co->closing)) err = -3;
+  else if (len == 0) err = 0;
+  else err = _sendq_put(co->sq, data, len, ref, NULL);
+  mico_rtos_unlock_mutex(&net_mut);
+  if ((err < 0) || (len == 0)) {
+    luaL_unref(L, LUA_REGISTRYINDEX, ref);
+    if (err < 0) {
+      lua_pushnil(L);
+      lua_pushstring(L, (err == -3) ? "closed" : "no memory");
+      return 2;
+    }
+  }
+  if (err == 0) {
+    lua_pushinteger(L, len);
+    return 1;
+  }
+  return _co_wait(L, co, CO_WRITE, len);
+}
+
+//sock:connect(port,"ip"|"domain",[timeout])   client sessions, as net.start;
+// true when connected, nil,"timeout" (10000 ms) or nil,"closed"
+//=====================================
+static int lco_connect( lua_State* L )
+{
+  net_co_t *co = _co_check(L);
+  int tmo = luaL_optinteger( L, 4, 10000 );
+  int err;
+
+  lua_pushcfunction(L, lnet_start);
+  lua_pushinteger(L, co->socket);
+  lua_pushvalue(L, 2);
+  lua_pushvalue(L, 3);
+  lua_call(L, 3, 1);
+  err = lua_tointeger(L, -1);
+  lua_pop(L, 1);
+  if (err < 0) {
+    lua_pushnil(L);
+    lua_pushinteger(L, err);
+    return 2;
+  }
+  return _co_wait(L, co, CO_CONNECT, tmo);
+}
+
+//sock:close()   the socket is closed when what was written is sent
+//===================================
+static int lco_close( lua_State* L )
+{
+  net_co_t *co = (net_co_t*)luaL_checkudata(L, 1, NET_CO_META);
+
+  mico_rtos_lock_mutex(&net_mut);
+  if (co->socket != INVALID_HANDLE) co->closing = 1;
+  mico_rtos_unlock_mutex(&net_mut);
+  return 0;
+}
+
+//net.co.start(socket,session,...)   runs session(sock,...) on a tcp client
+// or server client socket, up to its first wait. 0, or < 0: not such a
+// socket, -4: it has a session already. The socket is closed when the
+// session ends
+//=======================================
+static int lco_start( lua_State* L )
+{
+  int socketHandle = luaL_checkinteger( L, 1 );
+
+  lua_pushinteger(L, _co_start(L, socketHandle, 2));
+  return 1;
+}
+
+// accept callback of a net.co server: (socket, ip, port) to a new session
+//=======================================
+static int _co_accept( lua_State* L )
+{
+  int socketHandle = luaL_checkinteger( L, 1 );
+
+  lua_pushvalue(L, lua_upvalueindex(1));
+  lua_insert(L, 2);
+  _co_start(L, socketHandle, 2);
+  return 0;
+}
+
+//net.co.serve(socket,session)   session(sock,ip,port) runs for each client
+// of a tcp server socket, in place of its accept callback
+//=======================================
+static int lco_serve( lua_State* L )
+{
+  int socketHandle = luaL_checkinteger( L, 1 );
+  int type=0, k=0, m=0;
+  int err = 0;
+
+  luaL_checktype(L, 2, LUA_TFUNCTION);
+  lua_pushvalue(L, 2);
+  lua_pushcclosure(L, _co_accept, 1);
+  mico_rtos_lock_mutex(&net_mut);
+  if ((false == getsocketIndex(socketHandle,&type,&k,&m)) || (type != SOCKET_TYPE_SERVER) ||
+      (psvrsockt[k]->type != TCP)) {
+    err = -1;
+    net_log("Not a tcp server socket\r\n" );
+    lua_pop(L, 1);
+    goto exit;
+  }
+  if (psvrsockt[k]->accept_cb != LUA_NOREF)
+    luaL_unref(L, LUA_REGISTRYINDEX, psvrsockt[k]->accept_cb);
+  psvrsockt[k]->accept_cb = luaL_ref(L, LUA_REGISTRYINDEX);
+  psvrsockt[k]->co = 1;
+
+exit:
+  mico_rtos_unlock_mutex(&net_mut);
+  lua_pushinteger(L, err);
+  return 1;
+}
+
 //==server==
 //net.on(socket,"accept",accept_cb)         //(sktclt,ip,port)
-//net.on(socket,"receive",receive_cb)       //(sktclt,data)
-//net.on(socket,"sent",sent_cb)             //(sktclt)
+//net.on(socket,"receive",receive_cb)       //(sktclt,data,[header]) header: http framing
+//net.on(socket,"sent",sent_cb)             //(sktclt,bytes) send queue empty
+//net.on(socket,"drain",drain_cb)           //(sktclt) send queue under half its high mark
 //net.on(socket,"disconnect",disconnect_cb) //(sktclt)
 //==client==
 //net.on(socket,"dnsfound",dnsfound_cb)     //(socket,ip)
 //net.on(socket,"connect",connect_cb)       //(socket)
-//net.on(socket,"receive",receive_cb)       //(socket,data)
-//net.on(socket,"sent",sent_cb)             //(socket)
+//net.on(socket,"receive",receive_cb)       //(socket,data,[header]) header: http option
+//net.on(socket,"sent",sent_cb)             //(socket,bytes) send queue empty
+//net.on(socket,"drain",drain_cb)           //(socket) send queue under half its high mark
 //net.on(socket,"disconnect",disconnect_cb) //(socket)
 //================================
 static int lnet_on( lua_State* L )
@@ -1712,6 +3079,11 @@ static int lnet_on( lua_State* L )
         luaL_unref(gL,LUA_REGISTRYINDEX,psvrsockt[k]->sent_cb);
       psvrsockt[k]->sent_cb = luaL_ref(gL, LUA_REGISTRYINDEX);
     }
+    else if ((strcmp(method,"drain") == 0) && (sl == strlen("drain"))) {
+      if (psvrsockt[k]->drain_cb != LUA_NOREF)
+        luaL_unref(gL,LUA_REGISTRYINDEX,psvrsockt[k]->drain_cb);
+      psvrsockt[k]->drain_cb = luaL_ref(gL, LUA_REGISTRYINDEX);
+    }
     else if ((strcmp(method,"disconnect") == 0) && (sl == strlen("disconnect"))) {
       if (psvrsockt[k]->disconnect_cb != LUA_NOREF)
         luaL_unref(gL,LUA_REGISTRYINDEX,psvrsockt[k]->disconnect_cb);
@@ -1746,6 +3118,11 @@ static int lnet_on( lua_State* L )
         luaL_unref(gL,LUA_REGISTRYINDEX, pcltsockt[k]->sent_cb);
       pcltsockt[k]->sent_cb = luaL_ref(gL, LUA_REGISTRYINDEX);
     }
+    else if ((strcmp(method,"drain") == 0) && (sl == strlen("drain"))) {
+      if (pcltsockt[k]->drain_cb != LUA_NOREF)
+        luaL_unref(gL,LUA_REGISTRYINDEX, pcltsockt[k]->drain_cb);
+      pcltsockt[k]->drain_cb = luaL_ref(gL, LUA_REGISTRYINDEX);
+    }
     else if ((strcmp(method,"disconnect") == 0) && (sl == strlen("disconnect"))) {
       if (pcltsockt[k]->disconnect_cb != LUA_NOREF)
         luaL_unref(gL,LUA_REGISTRYINDEX, pcltsockt[k]->disconnect_cb);
@@ -1941,12 +3318,32 @@ static int lnet_debug( lua_State* L )
 
 #define MIN_OPT_LEVEL   2
 #include "lrodefs.h"
+static const LUA_REG_TYPE net_co_map[] =
+{
+  {LSTRKEY("start"), LFUNCVAL(lco_start)},
+  {LSTRKEY("serve"), LFUNCVAL(lco_serve)},
+  {LNILKEY, LNILVAL}
+};
+
+// methods of the net.co socket objects
+static const LUA_REG_TYPE net_co_sock_map[] =
+{
+  {LSTRKEY("read"), LFUNCVAL(lco_read)},
+  {LSTRKEY("readline"), LFUNCVAL(lco_readline)},
+  {LSTRKEY("write"), LFUNCVAL(lco_write)},
+  {LSTRKEY("connect"), LFUNCVAL(lco_connect)},
+  {LSTRKEY("close"), LFUNCVAL(lco_close)},
+  {LNILKEY, LNILVAL}
+};
+
 const LUA_REG_TYPE net_map[] =
 {
   {LSTRKEY("new"), LFUNCVAL(lnet_new)},
   {LSTRKEY("start"), LFUNCVAL(lnet_start)},
   {LSTRKEY("on"), LFUNCVAL(lnet_on)},
   {LSTRKEY("send"), LFUNCVAL(lnet_send)},
+  {LSTRKEY("sendfile"), LFUNCVAL(lnet_sendfile)},
+  {LSTRKEY("queued"), LFUNCVAL(lnet_queued)},
   {LSTRKEY("close"), LFUNCVAL(lnet_close)},
   {LSTRKEY("getip"), LFUNCVAL(lnet_getip)},
   {LSTRKEY("status"), LFUNCVAL(lnet_state)},
@@ -1956,6 +3353,7 @@ const LUA_REG_TYPE net_map[] =
    { LSTRKEY( "UDP" ), LNUMVAL( UDP ) },
    { LSTRKEY( "SERVER" ), LNUMVAL( SOCKET_SERVER ) },
    { LSTRKEY( "CLIENT" ), LNUMVAL( SOCKET_CLIENT ) },
+   { LSTRKEY( "co" ), LROVAL( net_co_map ) },
 #endif        
   {LNILKEY, LNILVAL}
 };
@@ -1966,8 +3364,6 @@ LUALIB_API int luaopen_net(lua_State *L)
   for(i=0;i<MAX_SVR_SOCKET;i++)
   {
     psvrsockt[i] = NULL;
-    for(int j=0;j<MAX_SVRCLT_SOCKET;j++)
-      psvrsockt[i]->psvrCltsocket[j]=NULL;
   }
   for(i=0;i<MAX_CLT_SOCKET;i++)
     pcltsockt[i] = NULL;
@@ -1975,15 +3371,30 @@ LUALIB_API int luaopen_net(lua_State *L)
   mico_rtos_init_mutex(&net_mut);
   set_tcp_keepalive(3, 60);
   
+  // metatable of the net.co socket objects, a table: the collector does not
+  // take a rotable for the metatable of a userdata (no LUA_META_ROTABLES)
+  luaL_newmetatable(L, NET_CO_META);
 #if LUA_OPTIMIZE_MEMORY > 0
+  lua_pushrotable(L, (void*)net_co_sock_map);
+  lua_setfield(L, -2, "__index");
+  lua_pop(L, 1);
     return 0;
 #else  
+  lua_pushvalue(L, -1);
+  lua_setfield(L, -2, "__index");
+  luaL_register(L, NULL, net_co_sock_map);
+  lua_pop(L, 1);
+
   luaL_register( L, EXLIB_NET, net_map );
  
   MOD_REG_NUMBER( L, "TCP", TCP );
   MOD_REG_NUMBER( L, "UDP", UDP );
   MOD_REG_NUMBER( L, "SERVER", SOCKET_SERVER);
   MOD_REG_NUMBER( L, "CLIENT", SOCKET_CLIENT);
+  // net.co
+  lua_newtable( L );
+  luaL_register( L, NULL, net_co_map );
+  lua_setfield( L, -2, "co" );
   return 1;
 #endif
 }
@@ -21,6 +21,7 @@
 extern const char wifimcu_gpio_map[];
 extern uint8_t spiInit[];
 extern uint16_t _spi_write(uint8_t id, uint8_t databits,uint8_t* data, uint32_t count, uint32_t rep);
+extern int _spi_dma_error( void );
 extern int _i2c_write(uint8_t id, uint16_t dev_adr, uint8_t* data, uint16_t count, uint16_t rep);
 extern bool IIC_Init;
 extern bool hw_IIC_Init;
@@ -389,6 +390,7 @@ static int oled_init( lua_State* L )
   oled_fontSize = 8;
   oled_fontWidth = 6;
   
+  if (_spi_dma_error( ) != 0) return luaL_error( L, "spi DMA failed" );
   lua_pushinteger( L, 0 );
   return 1;
 }
@@ -399,6 +401,7 @@ static int oled_clear( lua_State* L )
   if (oled_ID > 4) return 0;
 
   _oled_clear();  
+  if (_spi_dma_error( ) != 0) return luaL_error( L, "spi DMA failed" );
   return 0;
 }
 
@@ -454,6 +457,7 @@ static int oled_write( lua_State* L )
       y = oled_lastY;
     }
   }  
+  if (_spi_dma_error( ) != 0) return luaL_error( L, "spi DMA failed" );
   return 0;
 }
 
@@ -468,6 +472,7 @@ static int oled_writechar( lua_State* L )
   uint8_t chr = luaL_checkinteger( L, 3 );
   
   OLED_ShowChar(x, y, chr);
+  if (_spi_dma_error( ) != 0) return luaL_error( L, "spi DMA failed" );
   return 0;
 }
 
@@ -13,22 +13,10 @@
 #include "mico_platform.h"
 #include "mico_wlan.h"
 #include "mico_system.h"
+#include "bitbang.h"
 
 extern void luaWdgReload( void );
 
-// we use cycle counter for precise timing
-#define CYCLE_COUNTING_INIT() \
-    do \
-    { \
-        /* enable DWT hardware and cycle counting */ \
-        CoreDebug->DEMCR = CoreDebug->DEMCR | CoreDebug_DEMCR_TRCENA_Msk; \
-        /* reset a counter */ \
-        DWT->CYCCNT = 0;  \
-        /* enable the counter */ \
-        DWT->CTRL = (DWT->CTRL | DWT_CTRL_CYCCNTENA_Msk) ; \
-    } \
-    while(0)
-
       
 typedef struct {
 	uint8_t GPIO_Pin;              /*!< GPIO Pin to be used for I/O functions */
@@ -96,6 +84,7 @@ typedef enum {
 } owState_t;
 
 static TM_OneWire_t OW_DEVICE;
+static bb_ow_t OW_BUS;
 
 #define MAX_ONEWIRE_SENSORS 2
 
@@ -109,10 +98,13 @@ uint8_t ow_alarm_device [MAX_ONEWIRE_SENSORS][8];
 
 uint8_t PinID_DHT11=255;
 uint8_t DHT11_22 = 0;
+static bb_pin_t DHT_PIN;
+static uint32_t DHT_US = 100;   // cycles per usec
 
 #define Delay_ms(ms)           mico_thread_msleep(ms)
 
 extern const char wifimcu_gpio_map[];
+extern const platform_gpio_t platform_gpio_pins[];
 
 #define NUM_GPIO 18
 
@@ -126,96 +118,33 @@ static int platform_gpio_exists( unsigned pin )
 // ONEWIRE FUNCTIONS
 //******************
 
-//--------------------------------------------------------------------------
-static uint8_t OW_OUT_SetWait(uint8_t hilo, uint8_t testbit, uint32_t dly) {
-  uint32_t cycles = 0;
-  uint8_t bitval = 1;
-  
-  CYCLE_COUNTING_INIT();
-  /* set line low or high, and wait dly us */
-  MicoGpioOutputLow((mico_gpio_t)OW_DEVICE.GPIO_Pin);
-  if (hilo==0) {
-    MicoGpioInitialize((mico_gpio_t)OW_DEVICE.GPIO_Pin, (mico_gpio_config_t)OUTPUT_PUSH_PULL);
-  }
-  else {
-    MicoGpioInitialize((mico_gpio_t)OW_DEVICE.GPIO_Pin, (mico_gpio_config_t)INPUT_PULL_UP);
-    /* wait 5 usek after releasing the line */
-    while (cycles < 500) {
-      cycles = DWT->CYCCNT;
-    }
-  }
-  
-  while (cycles < dly) {
-    if (testbit && bitval) {
-      if ( MicoGpioInputGet((mico_gpio_t)OW_DEVICE.GPIO_Pin) == 0 ) {
-        bitval = 0;
-      }
-    }
-    cycles = DWT->CYCCNT;
-  }
-  return bitval;
-}
-
+// The slots run on the pin registers, see bitbang.c
 //---------------------------------
 static uint8_t TM_OneWire_Reset() {
-  uint8_t i;
-
-  // Line low, and wait 480us minimum
-  OW_OUT_SetWait(0, 0, 48000);
-  /* Release line and wait for 480us minimum*/
-  i = OW_OUT_SetWait(1, 1, 48000);
+  if (OW_BUS.pin.port == NULL) return 1;  // no ow.init yet
   // Return value of presence pulse, 0 = OK, 1 = ERROR
-  return i;
+  return bb_ow_reset(&OW_BUS);
 }
 
 //--------------------------------------------
 static void TM_OneWire_WriteBit(uint8_t bit) {
-  if (bit) {
-    /* Set line low */
-    OW_OUT_SetWait(0, 0, 800);
-    /* Bit high */
-    /* release the line and Wait for 60 us */
-    OW_OUT_SetWait(1, 0, 6000);
-  } else {
-    /* Set line low */
-    /* Bit low */
-    OW_OUT_SetWait(0, 0, 6500);
-    /* release the line and Wait for 5 us */
-    OW_OUT_SetWait(1, 0, 500);
-  }
+  bb_ow_write_bit(&OW_BUS, bit);
 }
 
 //-----------------------------------
 static uint8_t TM_OneWire_ReadBit() {
-  uint8_t bit = 0;
-
-  /* Line low */
-  OW_OUT_SetWait(0, 0, 300);
-  /* Release line and wait for line value */
-  bit = OW_OUT_SetWait(1, 1, 6000);
-  /* Return bit value */
-  return bit;
+  return bb_ow_read_bit(&OW_BUS);
 }
 
 //----------------------------------------------
 static void TM_OneWire_WriteByte(uint8_t byte) {
-  uint8_t i = 8;
-  // Write 8 bits
-  while (i--) {
-    // LSB bit is first
-    TM_OneWire_WriteBit(byte & 0x01);
-    byte >>= 1;
-  }
+  // LSB bit is first
+  bb_ow_write_byte(&OW_BUS, byte);
 }
 
 //------------------------------------
 static uint8_t TM_OneWire_ReadByte() {
-  uint8_t i = 8, byte = 0;
-  while (i--) {
-    byte >>= 1;
-    byte |= (TM_OneWire_ReadBit() << 7);
-  }
-  return byte;
+  return bb_ow_read_byte(&OW_BUS);
 }
 
 //------------------------------------
@@ -876,68 +805,20 @@ static uint8_t TM_DS18B20_AllDone() {
 // dht11 functions
 //****************
 
+// length of the next hilo pulse in usec, 0 if it does not start or end within tmo usec
 //--------------------------------------------------------
-static uint8_t DHT_IN_Length(uint8_t hilo, uint32_t dly) {
-  uint32_t bitlen = 0;
-  
-  CYCLE_COUNTING_INIT();
-  
-  bitlen = 0;
-  if (hilo) { // === measure high state length ===
-    while (DWT->CYCCNT <= dly) {
-      if (bitlen == 0) { // wait for high pulse start
-        if ( MicoGpioInputGet((mico_gpio_t)PinID_DHT11) != 0 ) {
-          bitlen = 1;
-          CYCLE_COUNTING_INIT();
-        }
-      }
-      else { // wait for low (high pulse end)
-        if ( MicoGpioInputGet((mico_gpio_t)PinID_DHT11) == 0 ) {
-          bitlen = DWT->CYCCNT;
-          break;
-        }
-      }
-    }
-  }
-  else { // === measure low state length ===
-    while (DWT->CYCCNT <= dly) {
-      if (bitlen == 0) { // wait for low pulse start
-        if ( MicoGpioInputGet((mico_gpio_t)PinID_DHT11) == 0 ) {
-          bitlen = 1;
-          CYCLE_COUNTING_INIT();
-        }
-      }
-      else {
-        // wait for high (low pulse end)
-        if ( MicoGpioInputGet((mico_gpio_t)PinID_DHT11) != 0 ) {
-          bitlen = DWT->CYCCNT;
-          break;
-        }
-      }
-    }
-  }
-  if (bitlen == 1) return 0;
-  
-  return (uint8_t)(bitlen / 100); // return pulse length in usec
+static uint8_t DHT_IN_Length(uint8_t hilo, uint32_t tmo) {
+  uint32_t bitlen = bb_pulse(&DHT_PIN, hilo, tmo * DHT_US) / DHT_US;
+
+  return (bitlen > 255) ? 255 : (uint8_t)bitlen;
 }
 
 //-------------------------------------------------------
 static void DHT_OUT_SetWait(uint8_t hilo, uint32_t dly) {
-  uint32_t cycles = 0;
-  
-  CYCLE_COUNTING_INIT();
-  // === set line low or high, and wait dly us ===
-  MicoGpioOutputLow((mico_gpio_t)PinID_DHT11);
-  if (hilo==0) {
-    MicoGpioInitialize((mico_gpio_t)PinID_DHT11, (mico_gpio_config_t)OUTPUT_PUSH_PULL);
-  }
-  else {
-    MicoGpioInitialize((mico_gpio_t)PinID_DHT11, (mico_gpio_config_t)INPUT_PULL_UP);
-  }
-  
-  while (cycles < dly) {
-    cycles = DWT->CYCCNT;
-  }
+  // === set line low or release it, and wait dly us ===
+  if (hilo==0) bb_low(&DHT_PIN);
+  else bb_high(&DHT_PIN);
+  bb_wait(BB_CYCLES(), dly * DHT_US);
 }
 
 //------------------------------
@@ -946,17 +827,17 @@ static uint8_t DHT11_Check(void)
   uint8_t len = 0;
 
   // send reset pulse  
-  DHT_OUT_SetWait(0,1000);  // data=0, wait 10 usec
+  DHT_OUT_SetWait(0,10);    // data=0, wait 10 usec
   Delay_ms(20);             // wait 20 msec
-  DHT_OUT_SetWait(1,100);   // data=1, wait 1 usec
+  DHT_OUT_SetWait(1,1);     // data=1, wait 1 usec
   // data line is now input
 
   // 20~40us HIGH -> ~80us LOW -> ~80 us HIGH)
   // measure DHT11 Pull down pulse
-  len = DHT_IN_Length(0, 10000);
+  len = DHT_IN_Length(0, 100);
   if ((len < 40) || (len >= 100)) return 1;
   // measure DHT11 Pull up pulse (~80us)
-  len = DHT_IN_Length(1, 10000);
+  len = DHT_IN_Length(1, 100);
   if ((len < 40) || (len >= 100)) return 1;
   return 0;  // OK
 }
@@ -970,12 +851,17 @@ static int lsensor_dht11_init( lua_State* L )
   PinID_DHT11 = wifimcu_gpio_map[pin];
   DHT11_22 = 0;
   
+  // open drain with pull up, released the line reads back
+  MicoGpioInitialize((mico_gpio_t)PinID_DHT11, (mico_gpio_config_t)OUTPUT_OPEN_DRAIN_PULL_UP);
+  bb_pin(&DHT_PIN, platform_gpio_pins[PinID_DHT11].port, platform_gpio_pins[PinID_DHT11].pin_number);
+  DHT_US = SystemCoreClock / 1000000;
+  
   if (lua_gettop(L) > 1) {
     DHT11_22 = luaL_checkinteger( L, 2 );
   }
   
   // set data high (pull up input)
-  DHT_OUT_SetWait(1,4000);  // data=1, wait 40 usec
+  DHT_OUT_SetWait(1,40);    // data=1, wait 40 usec
   Delay_ms(50);             // wait 50 msec
   
   if(DHT11_Check()==0)
@@ -1017,7 +903,7 @@ static int lsensor_dht11_get( lua_State* L )
         // bit=1:  50 us LOW ->    70 us HIGH
         
         // wait & measure data bit length 
-        len = DHT_IN_Length(1, 15000);
+        len = DHT_IN_Length(1, 150);
         if ((len < 10) || (len >= 90)) {
           stat = 1;
           break;
@@ -1266,8 +1152,11 @@ static int lsensor_ow_init( lua_State* L )
 
   MicoGpioDisableIRQ((mico_gpio_t)OW_DEVICE.GPIO_Pin);
   MicoGpioFinalize((mico_gpio_t)OW_DEVICE.GPIO_Pin);
-  MicoGpioInitialize((mico_gpio_t)OW_DEVICE.GPIO_Pin,(mico_gpio_config_t)INPUT_PULL_UP);
-  MicoGpioOutputLow((mico_gpio_t)OW_DEVICE.GPIO_Pin);
+  // open drain with pull up: the slots only write the BSRR, released the line reads back
+  MicoGpioInitialize((mico_gpio_t)OW_DEVICE.GPIO_Pin,(mico_gpio_config_t)OUTPUT_OPEN_DRAIN_PULL_UP);
+  bb_pin_t pin_ow;
+  bb_pin(&pin_ow, platform_gpio_pins[OW_DEVICE.GPIO_Pin].port, platform_gpio_pins[OW_DEVICE.GPIO_Pin].pin_number);
+  bb_ow_init(&OW_BUS, &pin_ow, SystemCoreClock / 1000000);
   Delay_ms(1);
   
   ow_numdev = 0;
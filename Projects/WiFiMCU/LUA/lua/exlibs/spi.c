@@ -10,10 +10,13 @@
 #include "mico_platform.h"
 //#include "platform_config.h"
 //#include "platform_peripheral.h"
+#include "spi_bus.h"
 
 #define BITS_8          8
 #define BITS_16         16
 
+#define SPI_DMA_TIMEOUT 20        // ms a DMA may take over the time of its bytes on the wire
+
 extern const char wifimcu_gpio_map[];
 
 #define NUM_GPIO 18
@@ -25,6 +28,9 @@ static int platform_gpio_exists( unsigned pin )
 uint8_t spiInit[3] = {0,0,0};
 uint8_t spiRW[3] = {0,0,0};
 
+// error of the last failed DMA write, see _spi_dma_error()
+static int spi_dma_err = 0;
+
 /**********************/
 /**** Hardware SPI ****/
 /**********************/
@@ -51,6 +57,19 @@ static mico_spi_device_t HW_SPI5 =
     .bits        = 8
 };
 
+/* SPI5 for the software SPI, when its pins are those of SPI5 */
+static mico_spi_device_t HW_SPI0 =
+{
+    .port        = MICO_SPI_5,
+    .chip_select = MICO_GPIO_38,
+    .speed       = 1000000,
+    .mode        = (SPI_CLOCK_RISING_EDGE | SPI_CLOCK_IDLE_LOW | SPI_MSB_FIRST),
+    .bits        = 8
+};
+
+// device SPI5 was last initialized for
+static const mico_spi_device_t* spi5_owner = NULL;
+
 
 /**********************/
 /**** Software SPI ****/
@@ -67,6 +86,7 @@ typedef struct {
 	uint8_t  pinMOSI;
 	uint8_t  pinMISO;
 	uint8_t  pinCS;
+	uint8_t  hw;       // on SPI5 pins: HW_SPI0 does the transfers
 	uint32_t speed;
 } swspi_t;
 
@@ -77,18 +97,18 @@ static swspi_t SW_SPI =
   .pinMOSI  = 255, // unassigned
   .pinMISO  = 255, // unassigned
   .pinCS    = 255, // unassigned
+  .hw       = 0,
   .speed    = 500  // 500kHz
 };
 
 //-------------------------------------------------------------------------
 // we use cycle counter for precise timing with software SPI
+// it is never reset, gpio.capture() stamps edges with it
 #define CYCLE_COUNTING_INIT() \
     do \
     { \
         /* enable DWT hardware and cycle counting */ \
         CoreDebug->DEMCR = CoreDebug->DEMCR | CoreDebug_DEMCR_TRCENA_Msk; \
-        /* reset a counter */ \
-        DWT->CYCCNT = 0;  \
         /* enable the counter */ \
         DWT->CTRL = (DWT->CTRL | DWT_CTRL_CYCCNTENA_Msk) ; \
     } \
@@ -97,13 +117,13 @@ static swspi_t SW_SPI =
 
 //---------------------------
 static void spi_delay(void) {
-  uint32_t cycles = 0;
+  uint32_t start;
 
   if (SW_SPI.speed < 10) return;
   
   CYCLE_COUNTING_INIT();
-  while (cycles < SW_SPI.speed) {
-    cycles = DWT->CYCCNT;
+  start = DWT->CYCCNT;
+  while ((uint32_t)(DWT->CYCCNT - start) < SW_SPI.speed) {
   }
 }
 
@@ -230,35 +250,170 @@ static void _MicoSpiTransfer( const mico_spi_device_t* spi, const mico_spi_messa
   mico_rtos_unlock_mutex( &platform_spi_drivers[spi->port].spi_mutex );
 }
 
-extern uint8_t TFT_pinDC;
+//==============================================================================
+// Hardware SPI writes, planned by spi_bus.c: polled or by DMA
+//==============================================================================
 
-//--------------------------------------------------------------------
-static void _spi_writeByte( const platform_spi_t* spi, uint16_t data )
+//-------------------------------------------------------
+static uint32_t _dma_status( DMA_Stream_TypeDef* stream )
+{
+  if ( stream <= DMA1_Stream3 ) return DMA1->LISR;
+  else if ( stream <= DMA1_Stream7 ) return DMA1->HISR;
+  else if ( stream <= DMA2_Stream3 ) return DMA2->LISR;
+  else return DMA2->HISR;
+}
+
+// Wait for the last frame to leave, drop what came in meanwhile
+//----------------------------------------------------
+static void _hwspi_drain( const platform_spi_t* spi )
 {
-  // Wait until the transmit buffer is empty
   while ( SPI_I2S_GetFlagStatus( spi->port, SPI_I2S_FLAG_TXE ) == RESET );
-  // Send the byte
-  SPI_I2S_SendData( spi->port, data );
-  //wait finish sending
-  while (SPI_I2S_GetFlagStatus(spi->port, SPI_I2S_FLAG_BSY) == SET);
+  while ( SPI_I2S_GetFlagStatus( spi->port, SPI_I2S_FLAG_BSY ) == SET );
+  // reading DR then SR clears RXNE and the overrun
+  SPI_I2S_ReceiveData( spi->port );
+  SPI_I2S_GetFlagStatus( spi->port, SPI_I2S_FLAG_OVR );
 }
 
+//---------------------------------------------------------------------------------
+static void _hwspi_poll( void* ctx, const uint8_t* tx, uint8_t* rx, uint32_t count )
+{
+  const platform_spi_t* spi = &platform_spi_peripherals[((mico_spi_device_t*)ctx)->port];
+
+  if ( rx == NULL ) {
+    // back to back, the next byte goes as soon as the last one is in the shifter
+    while ( count-- ) {
+      while ( SPI_I2S_GetFlagStatus( spi->port, SPI_I2S_FLAG_TXE ) == RESET );
+      SPI_I2S_SendData( spi->port, *tx++ );
+    }
+    _hwspi_drain( spi );
+  }
+  else {
+    _hwspi_drain( spi );
+    while ( count-- ) *rx++ = (uint8_t)_spi_transfer( spi, *tx++ );
+  }
+}
+
+// Only the TX stream: the RX stream of SPI5 is the TX stream of SPI1, the flash
+//-------------------------------------------------------------------------------
+static int _hwspi_dma( void* ctx, const uint8_t* tx, uint32_t count, bool fixed )
+{
+  const mico_spi_device_t* dev = (mico_spi_device_t*)ctx;
+  const platform_spi_t* spi = &platform_spi_peripherals[dev->port];
+  DMA_InitTypeDef dma_init;
+  // bytes left from which the wait sleeps: about 2 ms of them
+  uint32_t sleep = dev->speed / 4000;
+  uint32_t timeout = (uint32_t)((uint64_t)count * 8000 / dev->speed) + SPI_DMA_TIMEOUT;
+  uint32_t status, start;
+  int err = kNoErr;
+
+  if ( spi->tx_dma.controller == DMA1 ) RCC->AHB1ENR |= RCC_AHB1Periph_DMA1;
+  else RCC->AHB1ENR |= RCC_AHB1Periph_DMA2;
+
+  // DeInit also clears the flags of the stream
+  DMA_DeInit( spi->tx_dma.stream );
+  dma_init.DMA_Channel            = spi->tx_dma.channel;
+  dma_init.DMA_PeripheralBaseAddr = ( uint32_t )&spi->port->DR;
+  dma_init.DMA_Memory0BaseAddr    = ( uint32_t )tx;
+  dma_init.DMA_DIR                = DMA_DIR_MemoryToPeripheral;
+  dma_init.DMA_BufferSize         = count;
+  dma_init.DMA_PeripheralInc      = DMA_PeripheralInc_Disable;
+  dma_init.DMA_MemoryInc          = fixed ? DMA_MemoryInc_Disable : DMA_MemoryInc_Enable;
+  dma_init.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+  dma_init.DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte;
+  dma_init.DMA_Mode               = DMA_Mode_Normal;
+  dma_init.DMA_Priority           = DMA_Priority_VeryHigh;
+  dma_init.DMA_FIFOMode           = DMA_FIFOMode_Disable;
+  dma_init.DMA_FIFOThreshold      = DMA_FIFOThreshold_Full;
+  dma_init.DMA_MemoryBurst        = DMA_MemoryBurst_Single;
+  dma_init.DMA_PeripheralBurst    = DMA_PeripheralBurst_Single;
+  DMA_Init( spi->tx_dma.stream, &dma_init );
+
+  SPI_I2S_DMACmd( spi->port, SPI_I2S_DMAReq_Tx, ENABLE );
+  DMA_Cmd( spi->tx_dma.stream, ENABLE );
+  start = mico_get_time();
+  // long transfers leave the CPU to the other threads
+  while ( ( ( status = _dma_status( spi->tx_dma.stream ) ) & spi->tx_dma.complete_flags ) == 0 ) {
+    // TEIF (or FEIF) with the stream stopped: no complete flag will come
+    if ( ( status & spi->tx_dma.error_flags ) && ( DMA_GetCmdStatus( spi->tx_dma.stream ) == DISABLE ) ) {
+      err = kWriteErr;
+      break;
+    }
+    if ( mico_get_time() - start > timeout ) {
+      err = kTimeoutErr;
+      break;
+    }
+    if ( DMA_GetCurrDataCounter( spi->tx_dma.stream ) > sleep ) mico_thread_msleep( 1 );
+  }
+  if ( err != kNoErr ) DMA_Cmd( spi->tx_dma.stream, DISABLE );
+  SPI_I2S_DMACmd( spi->port, SPI_I2S_DMAReq_Tx, DISABLE );
+  _hwspi_drain( spi );
+  return err;
+}
+
+static const spi_bus_ops_t hwspi_ops = { _hwspi_poll, _hwspi_dma };
+
+// repeated patterns go out of here, used by the lua thread only
+static uint8_t spi_fill[128];
+
+// per id, 0 when on SPI5 pins
+static spi_bus_t spi_bus[3] =
+{
+  { &hwspi_ops, &HW_SPI0, SPI_BUS_DMA_MIN, spi_fill, sizeof(spi_fill) },
+  { &hwspi_ops, &HW_SPI1, SPI_BUS_DMA_MIN, spi_fill, sizeof(spi_fill) },
+  { &hwspi_ops, &HW_SPI5, SPI_BUS_DMA_MIN, spi_fill, sizeof(spi_fill) },
+};
+
+// The device of a hardware id, (re)initialized for databits or when
+// another device had its port
+//--------------------------------------------------------------------------
+static mico_spi_device_t* _hw_spi_device( uint8_t id, uint8_t databits )
+{
+  mico_spi_device_t* dev = (mico_spi_device_t*)spi_bus[id].ctx;
+
+  if ((dev->bits != databits) || ((dev->port == MICO_SPI_5) && (spi5_owner != dev))) {
+    dev->bits = databits;
+    MicoSpiInitialize(dev);
+    if (dev->port == MICO_SPI_5) spi5_owner = dev;
+  }
+  return dev;
+}
+
+// 8 bit frames under one chip select, last gets the byte read with the last one
+//---------------------------------------------------------------------------------------------------
+static int _MicoSpiWrite( uint8_t id, const uint8_t* data, uint32_t count, uint32_t rep, uint8_t* last )
+{
+  mico_spi_device_t* dev = _hw_spi_device( id, BITS_8 );
+  const platform_gpio_t* cs = &platform_gpio_pins[dev->chip_select];
+  int err;
+
+  mico_rtos_lock_mutex( &platform_spi_drivers[dev->port].spi_mutex );
+  platform_mcu_powersave_disable();
+  platform_gpio_output_low( cs );
+  err = spi_bus_write( &spi_bus[id], data, count, rep, last );
+  platform_gpio_output_high( cs );
+  platform_mcu_powersave_enable();
+  mico_rtos_unlock_mutex( &platform_spi_drivers[dev->port].spi_mutex );
+  return err;
+}
+
+extern uint8_t TFT_pinDC;
+
 // buf structure:
 // cmd ndata rep data1...datan cmd ......
-//----------------------------------------------------------------------------------------------------------------------------
-static void _platform_lcd_transfer( platform_spi_driver_t* driver, const platform_spi_config_t* config, uint8_t* buf, int len)
+//---------------------------------------------------------------------------------------------------------
+static int _platform_lcd_transfer( spi_bus_t* bus, const platform_spi_config_t* config, uint8_t* buf, int len)
 {
   int count = len;
-  uint16_t ndata, j;
-  uint32_t rep,i;
-  uint16_t data;
-  uint8_t* tmpbuf;
+  uint16_t ndata;
+  uint32_t rep;
+  uint8_t cmd;
+  int err = kNoErr;
   
   platform_mcu_powersave_disable();
   
   while (count > 0) {
-    data = *buf++; // get command
-    if (data == 0) break;
+    cmd = *buf++; // get command
+    if (cmd == 0) break;
 
     // send command, DC=0
     MicoGpioOutputLow( (mico_gpio_t)TFT_pinDC );
@@ -266,10 +421,11 @@ static void _platform_lcd_transfer( platform_spi_driver_t* driver, const platfor
     platform_gpio_output_low( config->chip_select );
     count--;
     // --- send command byte ---
-    _spi_writeByte( driver->peripheral, data );
+    err = spi_bus_write( bus, &cmd, 1, 1, NULL );
     
     // --- Deactivate chip select -------------------
     platform_gpio_output_high( config->chip_select );
+    if (err != kNoErr) break;
 
     // get ndata & rep    
     ndata = (uint16_t)(*buf++ << 8);
@@ -284,37 +440,43 @@ static void _platform_lcd_transfer( platform_spi_driver_t* driver, const platfor
       MicoGpioOutputHigh( (mico_gpio_t)TFT_pinDC );
       // --- Activate chip select --------------------
       platform_gpio_output_low( config->chip_select );
-      for (i=0; i<rep; i++) {
-        tmpbuf = buf;
-        for (j=0; j<ndata; j++) {
-          data = *tmpbuf++;
-          // --- send data byte ---
-          _spi_writeByte( driver->peripheral, data );
-        }
-      }
+      // --- send data, ndata bytes rep times, fills by DMA ---
+      err = spi_bus_write( bus, buf, ndata, rep, NULL );
       buf += ndata;
       count -= ndata;
       // --- Deactivate chip select -------------------
       platform_gpio_output_high( config->chip_select );
+      if (err != kNoErr) break;
     }
   }
 
   platform_mcu_powersave_enable( );
+  return err;
 }
 
-//--------------------------------------------
-void _MicoLcdTransfer( uint8_t* buf, int len )
+//------------------------------------------------------------
+static int _hwLcdTransfer( uint8_t id, uint8_t* buf, int len )
 {
   platform_spi_config_t config;
+  mico_spi_device_t* dev = _hw_spi_device( id, BITS_8 );
+  int err;
+
+  config.chip_select = &platform_gpio_pins[dev->chip_select];
+  config.speed       = dev->speed;
+  config.mode        = dev->mode;
+  config.bits        = dev->bits;
+
+  mico_rtos_lock_mutex( &platform_spi_drivers[dev->port].spi_mutex );
+  err = _platform_lcd_transfer( &spi_bus[id], &config, buf, len );
+  mico_rtos_unlock_mutex( &platform_spi_drivers[dev->port].spi_mutex );
+  return err;
+}
 
-  config.chip_select = &platform_gpio_pins[HW_SPI5.chip_select];
-  config.speed       = HW_SPI5.speed;
-  config.mode        = HW_SPI5.mode;
-  config.bits        = HW_SPI5.bits;
-
-  mico_rtos_lock_mutex( &platform_spi_drivers[HW_SPI5.port].spi_mutex );
-  _platform_lcd_transfer( &platform_spi_drivers[HW_SPI5.port], &config, buf, len );
-  mico_rtos_unlock_mutex( &platform_spi_drivers[HW_SPI5.port].spi_mutex );
+// kNoErr, or the error of a failed DMA
+//-------------------------------------------
+int _MicoLcdTransfer( uint8_t* buf, int len )
+{
+  return _hwLcdTransfer( 2, buf, len );
 }
 
 //==============================================================================
@@ -350,8 +512,8 @@ static void _swspi_writeByte( uint16_t wdata )
   else MicoGpioOutputLow( (mico_gpio_t)SW_SPI.pinSCK );
 }
 
-//------------------------------------------
-void _swLcdTransfer( uint8_t* buf, int len )
+//-----------------------------------------
+int _swLcdTransfer( uint8_t* buf, int len )
 {
   int count = len;
   uint16_t ndata, j;
@@ -359,6 +521,8 @@ void _swLcdTransfer( uint8_t* buf, int len )
   uint16_t data;
   uint8_t* tmpbuf;
   
+  if (SW_SPI.hw) return _hwLcdTransfer( 0, buf, len );
+
   // set clk inactive state
   if (SW_SPI.spiMode > 1) MicoGpioOutputHigh( (mico_gpio_t)SW_SPI.pinSCK );
   else MicoGpioOutputLow( (mico_gpio_t)SW_SPI.pinSCK );
@@ -412,22 +576,7 @@ void _swLcdTransfer( uint8_t* buf, int len )
       if (SW_SPI.speed >= 10) spi_delay();
     }
   }
-}
-
-//--------------------------------------------------------
-static void checkSPIbits( uint8_t id, uint8_t databits ) {
-  if (id == 2) {
-    if (HW_SPI5.bits != databits) {
-      HW_SPI5.bits = databits;
-      MicoSpiInitialize(&HW_SPI5);
-    }
-  }
-  else if (id == 1) {
-    if (HW_SPI1.bits != databits) {
-      HW_SPI1.bits = databits;
-      MicoSpiInitialize(&HW_SPI1);
-    }
-  }
+  return kNoErr;
 }
 
 // Writes a byte to the SPI
@@ -435,15 +584,18 @@ static void checkSPIbits( uint8_t id, uint8_t databits ) {
 static uint16_t hw_spi_write(uint8_t id, uint8_t databits, uint8_t* data, uint32_t count, uint32_t rep)
 {  
   uint16_t rxdata=0x0000;
+  uint8_t last = 0;
   mico_spi_message_segment_t hwspi_msg = { data, NULL, (unsigned long)count };
   
-  checkSPIbits(id, databits);
-  
+  if (databits==BITS_8) {
+    // polled or by DMA, the byte read in only when asked for
+    int err = _MicoSpiWrite( id, data, count, rep, spiRW[id] ? &last : NULL );
+    if (err != kNoErr) spi_dma_err = err;
+    return last;
+  }
+
   if (spiRW[id]) hwspi_msg.rx_buffer = &rxdata;
-  if (id==2) _MicoSpiTransfer( &HW_SPI5, &hwspi_msg, rep );
-  else if (id==1) _MicoSpiTransfer( &HW_SPI1, &hwspi_msg, 1 );
-  
-  if (databits==BITS_8) rxdata= rxdata & 0x00FF;
+  _MicoSpiTransfer( _hw_spi_device(id, databits), &hwspi_msg, rep );
   return rxdata;
 } 
 
@@ -533,10 +685,7 @@ static void hw_spi_read(uint8_t id, uint8_t databits, uint8_t* data, uint16_t co
   //mico_spi_message_segment_t hwspi_msg = { NULL, data, (unsigned long)count };
   mico_spi_message_segment_t hwspi_msg = { data, data, (unsigned long)count };
 
-  checkSPIbits(id, databits);
-
-  if (id==2) _MicoSpiTransfer( &HW_SPI5, &hwspi_msg, 1 );
-  else if (id==1) _MicoSpiTransfer( &HW_SPI1, &hwspi_msg, 1 );
+  _MicoSpiTransfer( _hw_spi_device(id, databits), &hwspi_msg, 1 );
 } 
 
 //-------------------------------------------------------------------------
@@ -589,27 +738,61 @@ static void sw_spi_read(uint8_t databits, uint8_t* databuf, uint16_t count)
   MicoGpioOutputHigh( (mico_gpio_t)SW_SPI.pinCS );
 }
 
+// kNoErr, or the error of a DMA write that failed since the last call
+//------------------------
+int _spi_dma_error( void )
+{
+  int err = spi_dma_err;
+  spi_dma_err = kNoErr;
+  return err;
+}
+
 //-------------------------------------------------------------------------------------------
 uint16_t _spi_write(uint8_t id, uint8_t databits,uint8_t* data, uint32_t count, uint32_t rep)
 {
-  if (id == 0) return sw_spi_write(databits, data, count, rep);
+  if ((id == 0) && !SW_SPI.hw) return sw_spi_write(databits, data, count, rep);
   else return hw_spi_write(id,databits,data,count, rep);
 }
 
 //------------------------------------------------------------------------
 void _spi_read(uint8_t id, uint8_t databits,uint8_t* data, uint16_t count)
 {
-  if (id == 0) sw_spi_read(databits,data,count);
+  if ((id == 0) && !SW_SPI.hw) sw_spi_read(databits,data,count);
   else hw_spi_read(id,databits,data,count);
 }
 
+// SPI5 mode bits of a software SPI mode
+//-----------------------------------------
+static uint8_t _hw_spi_mode( uint8_t md )
+{
+  if (md == 0) return (SPI_CLOCK_RISING_EDGE | SPI_CLOCK_IDLE_LOW | SPI_MSB_FIRST);
+  else if (md == 1) return (SPI_CLOCK_FALLING_EDGE | SPI_CLOCK_IDLE_LOW | SPI_MSB_FIRST);
+  else if (md == 2) return (SPI_CLOCK_FALLING_EDGE | SPI_CLOCK_IDLE_HIGH | SPI_MSB_FIRST);
+  else return (SPI_CLOCK_RISING_EDGE | SPI_CLOCK_IDLE_HIGH | SPI_MSB_FIRST);
+}
+
+// The software SPI pins are those of SPI5
+//--------------------------------------
+static uint8_t _swspi_on_spi5( void )
+{
+  const platform_spi_t* spi = &platform_spi_peripherals[MICO_SPI_5];
+
+  if ((SW_SPI.pinSCK == 255) || (SW_SPI.pinMOSI == 255) || (SW_SPI.pinMISO == 255)) return 0;
+  return (spi->pin_clock == &platform_gpio_pins[SW_SPI.pinSCK]) &&
+         (spi->pin_mosi == &platform_gpio_pins[SW_SPI.pinMOSI]) &&
+         (spi->pin_miso == &platform_gpio_pins[SW_SPI.pinMISO]);
+}
+
 //id:     0 for software spi; 1 for hw spi1; 2 for hw spi5
-//cpnfig: lua table: {mode,sck,mosi,[miso],[rw],[speed]}
+//        0 on the pins of spi5 (sck=16, mosi=8, miso=7) at 400kHz or more uses spi5
+//cpnfig: lua table: {mode,sck,mosi,[miso],[rw],[speed],[dma]}
+//        dma: hw spi transfers of at least dma bytes go by DMA, 0: never; default 32
 //spi.setup(id, config)
 //==================================
 static int spi_setup( lua_State* L )
 {
   uint8_t err = 0;
+  uint32_t khz = 1000;
   
   uint8_t id = luaL_checkinteger( L, 1 );
   if ((id !=0) && (id !=1) && (id !=2)) {
@@ -626,6 +809,8 @@ static int spi_setup( lua_State* L )
 
   spiInit[id] = 0;
   spiRW[id] = 0;
+  spi_bus[id].dma_min = SPI_BUS_DMA_MIN;
+  if (id == 0) SW_SPI.hw = 0;
   // --- spi Mode --------------------------------------------------------------
   lua_getfield(L, 2, "mode");
   if (!lua_isnil(L, -1)){  /* found? */
@@ -634,14 +819,10 @@ static int spi_setup( lua_State* L )
       if (id==0) {
         SW_SPI.spiMode = luaL_checkinteger( L, -1 );
         if (SW_SPI.spiMode > 3) SW_SPI.spiMode = 0;
+        HW_SPI0.mode = _hw_spi_mode(SW_SPI.spiMode);
       }
       else {
-        uint8_t md = luaL_checkinteger( L, -1 );
-        if (md > 3) SW_SPI.spiMode = 0;
-        if (md == 0) md = (SPI_CLOCK_RISING_EDGE | SPI_CLOCK_IDLE_LOW | SPI_MSB_FIRST);
-        else if (md == 1) md = (SPI_CLOCK_FALLING_EDGE | SPI_CLOCK_IDLE_LOW | SPI_MSB_FIRST);
-        else if (md == 2) md = (SPI_CLOCK_FALLING_EDGE | SPI_CLOCK_IDLE_HIGH | SPI_MSB_FIRST);
-        else md = (SPI_CLOCK_RISING_EDGE | SPI_CLOCK_IDLE_HIGH | SPI_MSB_FIRST);
+        uint8_t md = _hw_spi_mode(luaL_checkinteger( L, -1 ));
         if (id==2) HW_SPI5.mode = md;
         else HW_SPI1.mode = md;
       }
@@ -670,6 +851,7 @@ static int spi_setup( lua_State* L )
           lua_pushinteger( L, -5 );
           return 1;
         }
+        khz = SW_SPI.speed;
         if (SW_SPI.speed <= 5000) SW_SPI.speed = 50000 / SW_SPI.speed;
         else SW_SPI.speed = 1;
       }
@@ -745,6 +927,17 @@ static int spi_setup( lua_State* L )
     }
   }
 
+  // --- DMA threshold ---------------------------------------------------------
+  lua_getfield(L, 2, "dma");
+  if (!lua_isnil(L, -1)){  /* found? */
+    if( lua_isstring(L, -1) ) spi_bus[id].dma_min = luaL_checkinteger( L, -1 );
+    else {
+      l_message( NULL, "wrong arg type:dma" );
+      lua_pushinteger( L, -16 );
+      return 1;
+    }
+  }
+
   // --- Only for software SPI -------------------------------------------------
   if (id==0) {
     // --- SW_SPI.pinSCK --------------------------------------------------------------
@@ -814,10 +1007,27 @@ static int spi_setup( lua_State* L )
       }
     }
     else SW_SPI.pinMISO = 255;
+
+    // SPI5 can take it, down to 100MHz/256
+    if (_swspi_on_spi5() && (khz >= 400)) {
+      SW_SPI.hw = 1;
+      HW_SPI0.chip_select = (mico_gpio_t)SW_SPI.pinCS;
+      HW_SPI0.speed = khz * 1000;
+    }
   }
   
   // Initialize SPI
-  if (id == 0) {
+  if (SW_SPI.hw && (id == 0)) {
+    HW_SPI0.bits = 8;
+    err = MicoSpiInitialize(&HW_SPI0);
+    if (err != kNoErr) {
+      l_message( NULL, "error initializing hw SPI5" );
+      lua_pushinteger( L, -15 );
+      return 1;
+    }
+    spi5_owner = &HW_SPI0;
+  }
+  else if (id == 0) {
     if(SW_SPI.spiMode==2 || SW_SPI.spiMode==3) MicoGpioOutputHigh( (mico_gpio_t)SW_SPI.pinSCK );
     else MicoGpioOutputLow( (mico_gpio_t)SW_SPI.pinSCK );
     MicoGpioOutputHigh( (mico_gpio_t)SW_SPI.pinCS );  // CS=high
@@ -830,6 +1040,7 @@ static int spi_setup( lua_State* L )
       lua_pushinteger( L, -15 );
       return 1;
     }
+    spi5_owner = &HW_SPI5;
   }
   else {
     HW_SPI1.bits = 8;
@@ -883,6 +1094,7 @@ static int spi_write( lua_State* L )
   uint8_t txdata[2] = {0};
   
   wrote = 0;
+  _spi_dma_error( );
   for( argn = 3; argn <= lua_gettop( L ); argn++ )
   {
     if( lua_type( L, argn ) == LUA_TNUMBER )
@@ -927,6 +1139,7 @@ static int spi_write( lua_State* L )
       wrote += datalen;
     }
   }
+  if (_spi_dma_error( ) != kNoErr) return luaL_error( L, "spi DMA failed" );
   if (wrote > 0) wrote--;
   if (spiRW[id]) lua_pushinteger( L, rxdata );
   else lua_pushinteger( L, wrote );
@@ -973,9 +1186,11 @@ static int spi_repeatwrite( lua_State* L )
   uint8_t brw = spiRW[id];
   spiRW[id] = 0;
   
+  _spi_dma_error( );
   _spi_write(id, databits, (uint8_t*)&data, 1, count);
   wrote += count;
   spiRW[id] = brw;
+  if (_spi_dma_error( ) != kNoErr) return luaL_error( L, "spi DMA failed" );
 
   lua_pushinteger( L, wrote );
   
@@ -1124,11 +1339,13 @@ static int spi_deinit( lua_State* L )
     MicoGpioFinalize((mico_gpio_t)HW_SPI1.chip_select);
     MicoGpioInitialize((mico_gpio_t)HW_SPI1.chip_select,(mico_gpio_config_t)INPUT_PULL_UP);
   }
-  else if (id == 1) {
+  else if (id == 2) {
     MicoSpiFinalize(&HW_SPI5);
     MicoGpioFinalize((mico_gpio_t)HW_SPI5.chip_select);
     MicoGpioInitialize((mico_gpio_t)HW_SPI5.chip_select,(mico_gpio_config_t)INPUT_PULL_UP);
   }
+  if ((id != 1) && (spi5_owner == spi_bus[id].ctx)) spi5_owner = NULL;
+  if (id == 0) SW_SPI.hw = 0;
 
   spiInit[id] = 0;
 
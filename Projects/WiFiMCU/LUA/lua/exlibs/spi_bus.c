@@ -0,0 +1,66 @@
+/**
+ * spi_bus.c
+ */
+
+#include <string.h>
+
+#include "spi_bus.h"
+
+// n bytes from p, or p[0] n times when fixed, as DMA when long enough.
+// The last byte goes alone and polled when its read is wanted.
+//------------------------------------------------------------------------------------------
+static int _bus_out( spi_bus_t* bus, const uint8_t* p, uint32_t n, bool fixed, uint8_t* last )
+{
+  uint32_t k, i;
+  int err;
+
+  if (last != NULL) n--;
+  while (n > 0) {
+    k = (n > SPI_BUS_DMA_MAX) ? SPI_BUS_DMA_MAX : n;
+    if ((bus->dma_min == 0) || (k < bus->dma_min)) {
+      if (!fixed) bus->ops->poll( bus->ctx, p, NULL, k );
+      else for (i = 0; i < k; i++) bus->ops->poll( bus->ctx, p, NULL, 1 );
+    }
+    else if ((err = bus->ops->dma( bus->ctx, p, k, fixed )) != 0) return err;
+    if (!fixed) p += k;
+    n -= k;
+  }
+  if (last != NULL) bus->ops->poll( bus->ctx, p, last, 1 );
+  return 0;
+}
+
+//----------------------------------------------------------------------------------------------------
+int spi_bus_write( spi_bus_t* bus, const uint8_t* data, uint32_t count, uint32_t rep, uint8_t* last )
+{
+  uint32_t copies, i;
+  int err;
+
+  if ((count == 0) || (rep == 0)) return 0;
+
+  if ((bus->dma_min == 0) || ((uint64_t)count * rep < bus->dma_min)) {
+    for (; rep > 1; rep--) bus->ops->poll( bus->ctx, data, NULL, count );
+    if (last == NULL) bus->ops->poll( bus->ctx, data, NULL, count );
+    else {
+      if (count > 1) bus->ops->poll( bus->ctx, data, NULL, count - 1 );
+      bus->ops->poll( bus->ctx, data + count - 1, last, 1 );
+    }
+    return 0;
+  }
+
+  // one byte over and over: DMA without memory increment
+  if (count == 1) return _bus_out( bus, data, rep, true, last );
+
+  // long data, or said once: straight from the caller
+  if ((rep == 1) || (count > bus->fill_size / 2)) {
+    for (; rep > 1; rep--)
+      if ((err = _bus_out( bus, data, count, false, NULL )) != 0) return err;
+    return _bus_out( bus, data, count, false, last );
+  }
+
+  // a short pattern: as many copies per DMA as the fill buffer holds
+  copies = bus->fill_size / count;
+  for (i = 0; i < copies; i++) memcpy( bus->fill + i * count, data, count );
+  for (; rep > copies; rep -= copies)
+    if ((err = _bus_out( bus, bus->fill, copies * count, false, NULL )) != 0) return err;
+  return _bus_out( bus, bus->fill, rep * count, false, last );
+}
@@ -0,0 +1,39 @@
+/**
+ * spi_bus.h
+ */
+
+#ifndef __SPI_BUS_H_
+#define __SPI_BUS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Writes of 8 bit frames on a hardware SPI, broken into what the peripheral
+// does best: polled frames for short ones, DMA for long ones, and a short
+// pattern repeated many times as DMA of a fill buffer (or of one fixed byte)
+// instead of a frame at a time.
+#define SPI_BUS_DMA_MIN     32        // default bytes from which DMA pays for its setup
+#define SPI_BUS_DMA_MAX     65535     // bytes per DMA, NDTR is 16 bits
+
+typedef struct {
+  // count bytes out polled, rx NULL: what comes in is dropped
+  void (*poll)( void* ctx, const uint8_t* tx, uint8_t* rx, uint32_t count );
+  // count bytes out by DMA, tx[0] count times when fixed; 0 when done,
+  // else the transfer failed (DMA error or timeout)
+  int (*dma)( void* ctx, const uint8_t* tx, uint32_t count, bool fixed );
+} spi_bus_ops_t;
+
+typedef struct {
+  const spi_bus_ops_t* ops;
+  void*                ctx;
+  uint32_t             dma_min;     // 0: never DMA
+  uint8_t*             fill;        // repeats of a pattern, for DMA
+  uint32_t             fill_size;
+} spi_bus_t;
+
+// Writes count bytes rep times, chip select is up to the caller.
+// last, if not NULL, gets the byte read in with the last one.
+// Returns 0, or what the failed DMA returned; nothing goes out after it.
+int spi_bus_write( spi_bus_t* bus, const uint8_t* data, uint32_t count, uint32_t rep, uint8_t* last );
+
+#endif
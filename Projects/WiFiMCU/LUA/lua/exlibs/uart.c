@@ -113,6 +113,13 @@ static swuart_t swUART =
 // === Software emulated UART ==================================================
 // =============================================================================
 
+#ifdef MICO_HOST_PLATFORM
+// === no TIM4/TIM11 on the host, uart 2 can not be set up there ===
+#define TIM_Cmd(tim, state)
+#define TIM_ClearITPendingBit(tim, it)
+#define TIM_SetCounter(tim, cnt)
+#else
+
 // == Start bit detection ==============
 //--------------------------------------
 static void _rx_irq_handler( void* arg )
@@ -257,6 +264,8 @@ void TIM4_IRQHandler(void)
   }
 }
 
+#endif
+
 //-------------------------------------------------------
 static uint16_t swUART_get (uint8_t *buf, uint16_t len) {
   uint16_t i,n;
@@ -275,6 +284,7 @@ static uint16_t swUART_get (uint8_t *buf, uint16_t len) {
 }
 
 
+#ifndef MICO_HOST_PLATFORM
 //-------------------------------
 static void init_SW_UART (void) {
   NVIC_InitTypeDef NVIC_InitStructure;
@@ -322,6 +332,7 @@ static void init_SW_UART (void) {
 
   swUART.init = 1;
 }
+#endif
 
 // =============================================================================
 
@@ -469,6 +480,9 @@ static int uart_setup( lua_State* L )
     usrUART_init = 1;
   }
   else {
+#ifdef MICO_HOST_PLATFORM
+    return luaL_error( L, "swUART not available on this platform" );
+#else
     unsigned txpin = luaL_checkinteger( L, 6 );
     unsigned rxpin = luaL_checkinteger( L, 7 );
 
@@ -519,6 +533,7 @@ static int uart_setup( lua_State* L )
     MicoGpioEnableIRQ(swUART.rx_pin, IRQ_TRIGGER_FALLING_EDGE, _rx_irq_handler, (void*)swUART.rx_pin);
     if (plua_usr_usart_thread == NULL)
       mico_rtos_create_thread(plua_usr_usart_thread, MICO_DEFAULT_WORKER_PRIORITY, "lua_usr_usart_thread", lua_usr_usart_thread, 0x200, 0);
+#endif
   }
   
   return 0;
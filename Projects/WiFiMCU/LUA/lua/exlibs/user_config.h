@@ -6,6 +6,7 @@
 #define PRT_VERSION "Ver. 1.00.04"
 #define BUILD_DATE  "Build 20160401"
 
+#ifndef MICO_HOST_PLATFORM
 #define USE_GPIO_MODULE
 #define USE_ADC_MODULE
 #define USE_MCU_MODULE
@@ -25,6 +26,17 @@
 #define USE_OLED_MODULE
 #define USE_MQTT_MODULE
 #define USE_FTP_MODULE
+#else
+// Linux host build (host/Makefile): modules running on simulated peripherals
+#define USE_MCU_MODULE
+#define USE_FILE_MODULE
+#define USE_NET_MODULE
+#define USE_TMR_MODULE
+#define USE_UART_MODULE
+#define USE_BIT_MODULE
+#define USE_MQTT_MODULE
+#define USE_FTP_MODULE
+#endif
 
 #define MOD_REG_NUMBER( L, name, val )\
   lua_pushnumber( L, val );\
@@ -576,7 +576,7 @@ LUALIB_API void luaL_unref (lua_State *L, int t, int ref) {
 ** Load functions
 ** =======================================================
 */
-#if 0
+#ifdef LUAC_CROSS_FILE  /* host build: load from the local file system */
 typedef struct LoadF {
   int extraline;
   FILE *f;
@@ -673,7 +673,7 @@ LUALIB_API int luaL_loadfile (lua_State *L, const char *filename) {
   lua_remove(L, fnameindex);
   return status;
 }
-#endif
+#else
 
 //doit
 #include <spiffs.h>
@@ -763,6 +763,7 @@ LUALIB_API int luaL_loadfile (lua_State *L, const char *filename) {
   lua_remove(L, fnameindex);
   return status;
 }
+#endif
 
 typedef struct LoadS {
   const char *s;
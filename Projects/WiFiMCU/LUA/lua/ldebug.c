@@ -22,6 +22,7 @@
 #include "lfunc.h"
 #include "lobject.h"
 #include "lopcodes.h"
+#include "lprofile.h"
 #include "lstate.h"
 #include "lstring.h"
 #include "ltable.h"
@@ -61,7 +62,7 @@ LUA_API int lua_sethook (lua_State *L, lua_Hook func, int mask, int count) {
   L->hook = func;
   L->basehookcount = count;
   resethookcount(L);
-  L->hookmask = cast_byte(mask);
+  L->hookmask = cast_byte(mask | (L->hookmask & LUA_MASKPROFILE));
   return 1;
 }
 
@@ -72,7 +73,7 @@ LUA_API lua_Hook lua_gethook (lua_State *L) {
 
 
 LUA_API int lua_gethookmask (lua_State *L) {
-  return L->hookmask;
+  return L->hookmask & ~LUA_MASKPROFILE;
 }
 
 
@@ -11,7 +11,9 @@
 #include <limits.h>
 #include <stddef.h>
 
+#ifndef LUAC_CROSS_FILE
 #include "mico_system.h"
+#endif
 #include "lua.h"
 
 
@@ -106,7 +108,9 @@ typedef lu_int32 Instruction;
 #endif
 
 
+#ifndef LUAC_CROSS_FILE
 extern mico_mutex_t  lua_queue_mut;
+#endif
 #ifndef lua_lock
 #define lua_lock(L)     ((void) 0) 
 #define lua_unlock(L)   ((void) 0)
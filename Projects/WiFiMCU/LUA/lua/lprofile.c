@@ -0,0 +1,224 @@
+/*
+** $Id: lprofile.c $
+** Sampling and instruction count profiler of the VM
+** See Copyright Notice in lua.h
+*/
+
+
+#include <stdio.h>
+#include <string.h>
+
+#define lprofile_c
+#define LUA_CORE
+
+#include "lua.h"
+
+#include "ldebug.h"
+#include "lmem.h"
+#include "lobject.h"
+#include "lopcodes.h"
+#include "lprofile.h"
+#include "lstate.h"
+
+
+/* Length of a chunk name in a frame */
+#define NAMELEN		24
+/* Length of a frame, name plus two line numbers */
+#define FRAMELEN	(NAMELEN + 24)
+
+
+typedef struct ProfStack {
+  lu_int32 hash;  /* of the frames, 0 for a free slot */
+  lu_int32 count;
+  char label[LUA_PROFILE_LABEL];
+} ProfStack;
+
+
+volatile int luaV_proftick = 0;
+lu_int32 luaV_opcount[NUM_OPCODES];
+
+static ProfStack *profstack = NULL;
+static lu_int32 profsamples = 0;
+static lu_int32 profdropped = 0;
+static int profrunning = 0;
+
+
+/* What a frame runs: the prototype of a Lua function, else the C function */
+static const void *framefunc (CallInfo *ci) {
+  if (ttislightfunction(ci->func))
+    return fvalue(ci->func);
+  if (ci_func(ci)->c.isC)
+    return cast(const void *, ci_func(ci)->c.f);
+  return ci_func(ci)->l.p;
+}
+
+
+/* Source and first line of a Lua function, so a reloaded chunk is the same */
+static lu_int32 framekey (CallInfo *ci) {
+  if (!ttislightfunction(ci->func) && !ci_func(ci)->c.isC) {
+    Proto *p = ci_func(ci)->l.p;
+    return p->source->tsv.hash ^ cast(lu_int32, p->linedefined);
+  }
+  return cast(lu_int32, cast(size_t, framefunc(ci)));
+}
+
+
+static void chunkname (char *out, const char *source) {
+  int i;
+  if (*source != '@' && *source != '=') {
+    strcpy(out, "[string]");
+    return;
+  }
+  source++;
+  for (i = 0; i < NAMELEN - 1 && source[i] != '\0'; i++)
+    out[i] = (source[i] == ';' || source[i] == ' ') ? '_' : source[i];
+  out[i] = '\0';
+}
+
+
+/* "name:linedefined", with ":line" for the innermost frame */
+static void framelabel (char *out, CallInfo *ci, int line) {
+  char name[NAMELEN];
+  if (ttislightfunction(ci->func) || ci_func(ci)->c.isC) {
+    sprintf(out, "[C:%p]", framefunc(ci));
+    return;
+  }
+  chunkname(name, getstr(ci_func(ci)->l.p->source));
+  if (line >= 0)
+    sprintf(out, "%s:%d:%d", name, ci_func(ci)->l.p->linedefined, line);
+  else
+    sprintf(out, "%s:%d", name, ci_func(ci)->l.p->linedefined);
+}
+
+
+/* Outermost frame first, the outer ones dropped if it does not fit */
+static void stacklabel (char *out, lua_State *L, int n, int line, int truncated) {
+  char frame[LUA_PROFILE_DEPTH][FRAMELEN];
+  size_t len[LUA_PROFILE_DEPTH];
+  size_t total = 0;
+  int i, first;
+  CallInfo *ci = L->ci;
+  for (i = 0; i < n; i++, ci--) {
+    framelabel(frame[i], ci, i == 0 ? line : -1);
+    len[i] = strlen(frame[i]);
+  }
+  /* frames n-1 .. 0 joined by ';', "..;" in front of a cut stack */
+  for (first = 0; first < n; first++) {
+    size_t need = total + len[first] + (first > 0);
+    if (need + 3 >= LUA_PROFILE_LABEL) {
+      truncated = 1;
+      break;
+    }
+    total = need;
+  }
+  *out = '\0';
+  if (truncated)
+    strcpy(out, "..");
+  for (i = first - 1; i >= 0; i--) {
+    if (*out != '\0')
+      strcat(out, ";");
+    strcat(out, frame[i]);
+  }
+}
+
+
+void luaV_profsample (lua_State *L, const Instruction *pc) {
+  CallInfo *ci;
+  Proto *p;
+  lu_int32 h = 2166136261u;  /* FNV-1a over the frames */
+  int n, line, slot, i;
+  if (!profrunning) {  /* stopped: the thread leaves the slow path */
+    L->hookmask &= ~LUA_MASKPROFILE;
+    return;
+  }
+  luaV_proftick = 0;
+  profsamples++;
+  for (ci = L->ci, n = 0; ci > L->base_ci && n < LUA_PROFILE_DEPTH; ci--, n++)
+    h = (h ^ framekey(ci)) * 16777619u;
+  p = ci_func(L->ci)->l.p;
+  line = getline(p, pcRel(pc, p));
+  h = (h ^ cast(lu_int32, line)) * 16777619u;
+  h = (h ^ cast(lu_int32, n | ((ci > L->base_ci) << 8))) * 16777619u;
+  if (h == 0) h = 1;
+  slot = h & (LUA_PROFILE_STACKS - 1);
+  for (i = 0; i < LUA_PROFILE_STACKS; i++) {
+    ProfStack *s = &profstack[(slot + i) & (LUA_PROFILE_STACKS - 1)];
+    if (s->hash == h) {
+      s->count++;
+      return;
+    }
+    if (s->hash == 0) {
+      s->hash = h;
+      s->count = 1;
+      stacklabel(s->label, L, n, line, ci > L->base_ci);
+      return;
+    }
+  }
+  profdropped++;
+}
+
+
+LUA_API int lua_profstart (lua_State *L) {
+  lua_lock(L);
+  if (profstack == NULL)
+    profstack = luaM_newvector(L, LUA_PROFILE_STACKS, ProfStack);
+  memset(profstack, 0, LUA_PROFILE_STACKS * sizeof(ProfStack));
+  memset(luaV_opcount, 0, sizeof(luaV_opcount));
+  profsamples = profdropped = 0;
+  luaV_proftick = 0;
+  profrunning = 1;
+  L->hookmask |= LUA_MASKPROFILE;
+  G(L)->mainthread->hookmask |= LUA_MASKPROFILE;
+  lua_unlock(L);
+  return 0;
+}
+
+
+LUA_API void lua_profstop (lua_State *L) {
+  lua_lock(L);
+  profrunning = 0;
+  luaV_proftick = 1;  /* other watched threads drop out at their next step */
+  L->hookmask &= ~LUA_MASKPROFILE;
+  G(L)->mainthread->hookmask &= ~LUA_MASKPROFILE;
+  lua_unlock(L);
+}
+
+
+LUA_API void lua_profreset (lua_State *L) {
+  lua_profstop(L);
+  lua_lock(L);
+  if (profstack != NULL)
+    luaM_freearray(L, profstack, LUA_PROFILE_STACKS, ProfStack);
+  profstack = NULL;
+  profsamples = profdropped = 0;
+  lua_unlock(L);
+}
+
+
+LUA_API void lua_proftick (void) {
+  luaV_proftick = 1;
+}
+
+
+LUA_API const char *lua_profstack (int n, unsigned long *count) {
+  int i;
+  if (profstack == NULL) return NULL;
+  for (i = 0; i < LUA_PROFILE_STACKS; i++) {
+    if (profstack[i].hash != 0 && n-- == 0) {
+      if (count) *count = profstack[i].count;
+      return profstack[i].label;
+    }
+  }
+  return NULL;
+}
+
+
+LUA_API unsigned long lua_profopcount (int op) {
+  return (op >= 0 && op < NUM_OPCODES) ? luaV_opcount[op] : 0;
+}
+
+
+LUA_API unsigned long lua_profsamples (unsigned long *dropped) {
+  if (dropped) *dropped = profdropped;
+  return profsamples;
+}
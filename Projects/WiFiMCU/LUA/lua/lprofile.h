@@ -0,0 +1,65 @@
+/*
+** $Id: lprofile.h $
+** Sampling and instruction count profiler of the VM
+** See Copyright Notice in lua.h
+*/
+
+#ifndef lprofile_h
+#define lprofile_h
+
+#include "lobject.h"
+#include "lopcodes.h"
+
+
+/*
+** A watched thread has LUA_MASKPROFILE in its hookmask, which sends each
+** of its instructions through luaV_profstep. That counts the opcode and,
+** once a timer has called lua_proftick, records the call stack: the Lua
+** functions and C functions of the thread, innermost first, plus the line
+** of the innermost one. Equal stacks share one of LUA_PROFILE_STACKS slots.
+** Threads created by a watched thread are watched too.
+*/
+#define LUA_MASKPROFILE	(1 << (LUA_HOOKCOUNT + 1))
+
+/* Slots for distinct stacks, a power of 2 */
+#ifndef LUA_PROFILE_STACKS
+#define LUA_PROFILE_STACKS	32
+#endif
+
+/* Frames kept of a stack, counted from the innermost one */
+#ifndef LUA_PROFILE_DEPTH
+#define LUA_PROFILE_DEPTH	8
+#endif
+
+/* Length of the collapsed form of a stack, "init.lua:0;init.lua:12:14" */
+#ifndef LUA_PROFILE_LABEL
+#define LUA_PROFILE_LABEL	88
+#endif
+
+
+LUAI_DATA volatile int luaV_proftick;
+LUAI_DATA lu_int32 luaV_opcount[NUM_OPCODES];
+
+/* Instruction i of a watched thread, pc points past it */
+#define luaV_profstep(L,i,pc) { \
+  luaV_opcount[GET_OPCODE(i)]++; \
+  if (luaV_proftick) luaV_profsample(L, pc); }
+
+LUAI_FUNC void luaV_profsample (lua_State *L, const Instruction *pc);
+
+
+/* Clears the counts and watches L and the main thread */
+LUA_API int lua_profstart (lua_State *L);
+LUA_API void lua_profstop (lua_State *L);
+/* Frees the stack slots */
+LUA_API void lua_profreset (lua_State *L);
+/* Asks for a sample at the next instruction, safe from a timer or a signal */
+LUA_API void lua_proftick (void);
+
+/* The n-th stack in collapsed form and its samples, NULL past the last */
+LUA_API const char *lua_profstack (int n, unsigned long *count);
+LUA_API unsigned long lua_profopcount (int op);
+/* Samples taken, and the part of them without a free slot */
+LUA_API unsigned long lua_profsamples (unsigned long *dropped);
+
+#endif
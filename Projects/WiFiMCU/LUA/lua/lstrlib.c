@@ -53,13 +53,96 @@ static int str_sub (lua_State *L) {
   return 1;
 }
 
-static luaL_Buffer b;//doit
+/*
+** A luaL_Buffer holds LUAL_BUFFERSIZE bytes, too many for the C stack of
+** the module, and a static one is overwritten by any call made from a
+** gsub callback. The buffers come from a pool of BUFFER_POOL instead, a
+** userdata on the stack of each call using one of them. One pool is kept
+** in the registry; a call nested deeper than the pool takes a new one,
+** which is kept in its place when put back if the kept one has no free
+** buffer left: all busy, or left so by calls that raised an error.
+** Short results, up to STR_SHORT bytes, are built on the C stack and take
+** no buffer: those of lower, upper, reverse, rep and char, of gsub with a
+** plain replacement string, and of format until it outgrows them.
+*/
+#define BUFFER_POOL	3
+#define STR_SHORT	64
+
+typedef struct Pool {
+  luaL_Buffer b[BUFFER_POOL];
+  unsigned char busy[BUFFER_POOL];  /* taken by a call */
+  int kept;  /* the one in the registry */
+} Pool;
+
+static char buffer_key;  /* registry key of the kept pool */
+
+
+/* first free buffer of the pool, BUFFER_POOL if none */
+static int pool_free (const Pool *bp) {
+  int i;
+  for (i = 0; i < BUFFER_POOL && bp->busy[i]; i++) ;
+  return i;
+}
+
+
+/* push the pool of the buffer returned */
+static luaL_Buffer *buffer_get (lua_State *L) {
+  Pool *bp;
+  int i = BUFFER_POOL;
+  lua_pushlightuserdata(L, &buffer_key);
+  lua_rawget(L, LUA_REGISTRYINDEX);
+  bp = (Pool *)lua_touserdata(L, -1);
+  if (bp != NULL) i = pool_free(bp);
+  if (i == BUFFER_POOL) {  /* none kept, or all of it busy */
+    lua_pop(L, 1);
+    bp = (Pool *)lua_newuserdata(L, sizeof(Pool));
+    memset(bp->busy, 0, sizeof(bp->busy));
+    bp->kept = 0;
+    i = 0;
+  }
+  bp->busy[i] = 1;
+  return &bp->b[i];
+}
+
+
+/* put back `b' of the pool at `idx' (< 0) and remove the pool from the stack */
+static void buffer_put (lua_State *L, luaL_Buffer *b, int idx) {
+  Pool *bp = (Pool *)lua_touserdata(L, idx);
+  bp->busy[b - bp->b] = 0;
+  if (!bp->kept) {
+    Pool *kp;
+    lua_pushlightuserdata(L, &buffer_key);
+    lua_rawget(L, LUA_REGISTRYINDEX);
+    kp = (Pool *)lua_touserdata(L, -1);
+    lua_pop(L, 1);
+    if (kp == NULL || pool_free(kp) == BUFFER_POOL) {
+      if (kp != NULL) kp->kept = 0;  /* its users still hold it */
+      lua_pushlightuserdata(L, &buffer_key);
+      lua_pushvalue(L, idx - 1);
+      lua_rawset(L, LUA_REGISTRYINDEX);
+      bp->kept = 1;
+    }
+  }
+  lua_remove(L, idx);
+}
+
+
 static int str_reverse (lua_State *L) {
-  size_t l;  
+  size_t l;
   const char *s = luaL_checklstring(L, 1, &l);
-  luaL_buffinit(L, &b);
-  while (l--) luaL_addchar(&b, s[l]);
-  luaL_pushresult(&b);
+  luaL_Buffer *b;
+  if (l <= STR_SHORT) {
+    char r[STR_SHORT];
+    size_t i;
+    for (i = 0; i < l; i++) r[i] = s[l-1-i];
+    lua_pushlstring(L, r, l);
+    return 1;
+  }
+  b = buffer_get(L);
+  luaL_buffinit(L, b);
+  while (l--) luaL_addchar(b, s[l]);
+  luaL_pushresult(b);
+  buffer_put(L, b, -2);
   return 1;
 }
 
@@ -67,12 +150,21 @@ static int str_reverse (lua_State *L) {
 static int str_lower (lua_State *L) {
   size_t l;
   size_t i;
-  //luaL_Buffer b;doit
   const char *s = luaL_checklstring(L, 1, &l);
-  luaL_buffinit(L, &b);
+  luaL_Buffer *b;
+  if (l <= STR_SHORT) {
+    char r[STR_SHORT];
+    for (i=0; i<l; i++)
+      r[i] = tolower(uchar(s[i]));
+    lua_pushlstring(L, r, l);
+    return 1;
+  }
+  b = buffer_get(L);
+  luaL_buffinit(L, b);
   for (i=0; i<l; i++)
-    luaL_addchar(&b, tolower(uchar(s[i])));
-  luaL_pushresult(&b);
+    luaL_addchar(b, tolower(uchar(s[i])));
+  luaL_pushresult(b);
+  buffer_put(L, b, -2);
   return 1;
 }
 
@@ -80,24 +172,49 @@ static int str_lower (lua_State *L) {
 static int str_upper (lua_State *L) {
   size_t l;
   size_t i;
-  //luaL_Buffer b;//doit
   const char *s = luaL_checklstring(L, 1, &l);
-  luaL_buffinit(L, &b);
+  luaL_Buffer *b;
+  if (l <= STR_SHORT) {
+    char r[STR_SHORT];
+    for (i=0; i<l; i++)
+      r[i] = toupper(uchar(s[i]));
+    lua_pushlstring(L, r, l);
+    return 1;
+  }
+  b = buffer_get(L);
+  luaL_buffinit(L, b);
   for (i=0; i<l; i++)
-    luaL_addchar(&b, toupper(uchar(s[i])));
-  luaL_pushresult(&b);
+    luaL_addchar(b, toupper(uchar(s[i])));
+  luaL_pushresult(b);
+  buffer_put(L, b, -2);
   return 1;
 }
 
 static int str_rep (lua_State *L) {
   size_t l;
-  //luaL_Buffer b;//doit
   const char *s = luaL_checklstring(L, 1, &l);
   int n = luaL_checkint(L, 2);
-  luaL_buffinit(L, &b);
+  luaL_Buffer *b;
+  if (n <= 0 || l == 0) {
+    lua_pushliteral(L, "");
+    return 1;
+  }
+  if (l <= STR_SHORT / (size_t)n) {
+    char r[STR_SHORT];
+    char *q = r;
+    while (n-- > 0) {
+      memcpy(q, s, l);
+      q += l;
+    }
+    lua_pushlstring(L, r, q - r);
+    return 1;
+  }
+  b = buffer_get(L);
+  luaL_buffinit(L, b);
   while (n-- > 0)
-    luaL_addlstring(&b, s, l);
-  luaL_pushresult(&b);
+    luaL_addlstring(b, s, l);
+  luaL_pushresult(b);
+  buffer_put(L, b, -2);
   return 1;
 }
 
@@ -124,14 +241,26 @@ static int str_byte (lua_State *L) {
 static int str_char (lua_State *L) {
   int n = lua_gettop(L);  /* number of arguments */
   int i;
-  //luaL_Buffer b;//doit
-  luaL_buffinit(L, &b);
+  luaL_Buffer *b;
+  if (n <= STR_SHORT) {
+    char r[STR_SHORT];
+    for (i=1; i<=n; i++) {
+      int c = luaL_checkint(L, i);
+      luaL_argcheck(L, uchar(c) == c, i, "invalid value");
+      r[i-1] = uchar(c);
+    }
+    lua_pushlstring(L, r, n);
+    return 1;
+  }
+  b = buffer_get(L);
+  luaL_buffinit(L, b);
   for (i=1; i<=n; i++) {
     int c = luaL_checkint(L, i);
     luaL_argcheck(L, uchar(c) == c, i, "invalid value");
-    luaL_addchar(&b, uchar(c));
+    luaL_addchar(b, uchar(c));
   }
-  luaL_pushresult(&b);
+  luaL_pushresult(b);
+  buffer_put(L, b, -2);
   return 1;
 }
 
@@ -144,13 +273,15 @@ static int writer (lua_State *L, const void* b, size_t size, void* B) {
 
 
 static int str_dump (lua_State *L) {
-  //luaL_Buffer b;//doit
+  luaL_Buffer *b;
   luaL_checktype(L, 1, LUA_TFUNCTION);
   lua_settop(L, 1);
-  luaL_buffinit(L,&b);
-  if (lua_dump(L, writer, &b) != 0)
+  b = buffer_get(L);
+  luaL_buffinit(L, b);
+  if (lua_dump(L, writer, b) != 0)
     luaL_error(L, "unable to dump given function");
-  luaL_pushresult(&b);
+  luaL_pushresult(b);
+  buffer_put(L, b, -2);
   return 1;
 }
 
@@ -166,9 +297,39 @@ static int str_dump (lua_State *L) {
 #define CAP_UNFINISHED	(-1)
 #define CAP_POSITION	(-2)
 
+/*
+** A pattern is compiled once into what match() would otherwise work out
+** at every position it tries: the length of each single char class, a
+** 256 bit set for each of the first PATT_SETS bracket classes, and the
+** literal prefix every match starts with, searched for with memchr, or
+** else the set of the chars a match can start with. Compiled patterns
+** are userdata cached by pattern string in the registry, up to PATT_CACHE
+** of them, and stay on the stack of the call using one. A pattern with no
+** bracket class is not worth the lookup: it is matched as it is, after a
+** search for the plain chars it starts with.
+*/
+#define PATT_SETS	8
+#define PATT_CACHE	8
+
+typedef struct Pattern {
+  unsigned char *len;  /* per pattern char: length of a class there */
+  unsigned char *cls;  /* per pattern char: 1 + the set of a `[' there */
+  unsigned char *set;  /* the sets, 32 bytes each */
+  unsigned char *first;  /* chars a match starts with, or NULL */
+  char *lit;  /* literal prefix of every match */
+  size_t nlit;
+} Pattern;
+
+#define inset(set,c)	((set)[(c) >> 3] & (1 << ((c) & 7)))
+
 typedef struct MatchState {
   const char *src_init;  /* init of source string */
   const char *src_end;  /* end (`\0') of source string */
+  const char *p_init;  /* init of pattern */
+  const Pattern *cp;  /* compiled pattern, or NULL */
+  const char *lit;  /* literal prefix of every match */
+  size_t nlit;
+  const unsigned char *first;  /* chars a match starts with, or NULL */
   lua_State *L;
   int level;  /* total number of captures (finished or unfinished) */
   struct {
@@ -199,6 +360,10 @@ static int capture_to_close (MatchState *ms) {
 
 
 static const char *classend (MatchState *ms, const char *p) {
+  if (ms->cp != NULL) {
+    int n = ms->cp->len[p - ms->p_init];
+    if (n) return p+n;  /* known from the compiled pattern */
+  }
   switch (*p++) {
     case L_ESC: {
       if (*p == '\0')
@@ -264,7 +429,7 @@ static int matchbracketclass (int c, const char *p, const char *ec) {
 }
 
 
-static int singlematch (int c, const char *p, const char *ep) {
+static int classmatch (int c, const char *p, const char *ep) {
   switch (*p) {
     case '.': return 1;  /* matches any char */
     case L_ESC: return match_class(c, uchar(*(p+1)));
@@ -274,6 +439,202 @@ static int singlematch (int c, const char *p, const char *ep) {
 }
 
 
+static int singlematch (MatchState *ms, int c, const char *p,
+                                        const char *ep) {
+  if (*p == '[' && ms->cp != NULL) {
+    int k = ms->cp->cls[p - ms->p_init];
+    if (k) return inset(ms->cp->set + 32*(k-1), c);
+  }
+  return classmatch(c, p, ep);
+}
+
+
+/* end of the single char class at `p', NULL if malformed */
+static const char *itemend (const char *p) {
+  switch (*p++) {
+    case L_ESC: {
+      return (*p == '\0') ? NULL : p+1;
+    }
+    case '[': {
+      if (*p == '^') p++;
+      do {  /* look for a `]' */
+        if (*p == '\0') return NULL;
+        if (*(p++) == L_ESC && *p != '\0')
+          p++;  /* skip escapes (e.g. `%]') */
+      } while (*p != ']');
+      return p+1;
+    }
+    default: {
+      return p;
+    }
+  }
+}
+
+
+/* char of a single char class that is a literal, -1 if not one */
+static int literal (const char *p) {
+  if (*p == L_ESC) return isalnum(uchar(*(p+1))) ? -1 : uchar(*(p+1));
+  else if (*p == '.' || *p == '[') return -1;
+  else return uchar(*p);
+}
+
+
+static void classset (unsigned char *set, const char *p, const char *ep) {
+  int c;
+  memset(set, 0, 32);
+  for (c = 0; c < 256; c++)
+    if (classmatch(c, p, ep)) set[c >> 3] |= 1 << (c & 7);
+}
+
+
+/* the length of the class at `q', and its set if it is a bracket class */
+static void addclass (Pattern *cp, const char *p, const char *q,
+                      const char *e, int *nsets, size_t n) {
+  if (e - q <= 255)
+    cp->len[q - p] = (unsigned char)(e - q);
+  if (*q == '[' && *nsets < (int)n) {
+    classset(cp->set + 32*(*nsets), q, e);
+    cp->cls[q - p] = (unsigned char)++(*nsets);
+  }
+}
+
+
+/*
+** Walks the items of the pattern as match() does. A malformed part ends
+** the walk, match() reports it when it gets there.
+*/
+static Pattern *compile (lua_State *L, const char *p, size_t l) {
+  Pattern *cp;
+  unsigned char *set, *len, *cls;
+  char *lit;
+  const char *q = p, *e;
+  size_t i, n = 0;
+  int nsets = 0;
+  int prefix = 1;  /* still in the literal prefix */
+  for (i = 0; i < l; i++)  /* room for the sets */
+    if (p[i] == '[' && n < PATT_SETS) n++;
+  cp = (Pattern *)lua_newuserdata(L, sizeof(Pattern) + 32*(n+1) + 3*l + 2);
+  set = (unsigned char *)(cp + 1);  /* n sets and the one of `first' */
+  len = set + 32*(n+1);
+  cls = len + l + 1;
+  lit = (char *)cls + l + 1;
+  memset(len, 0, 2*l + 2);
+  cp->len = len;
+  cp->cls = cls;
+  cp->set = set;
+  cp->first = NULL;
+  cp->lit = lit;
+  cp->nlit = 0;
+  if (*q == '^') {  /* anchored: nothing to skip */
+    q++;
+    prefix = 0;
+  }
+  while (*q != '\0') {
+    int quant;
+    switch (*q) {
+      case '(': case ')': {  /* captures take no chars */
+        q++;
+        continue;
+      }
+      case L_ESC: {
+        if (*(q+1) == 'b')
+          e = (*(q+2) != '\0' && *(q+3) != '\0') ? q+4 : NULL;
+        else if (*(q+1) == 'f') {
+          e = (*(q+2) == '[') ? itemend(q+2) : NULL;
+          if (e != NULL) addclass(cp, p, q+2, e, &nsets, n);
+        }
+        else if (isdigit(uchar(*(q+1))))
+          e = q+2;
+        else break;  /* a single char class */
+        if (e == NULL) goto done;
+        prefix = 0;
+        q = e;
+        continue;
+      }
+      case '$': {
+        if (*(q+1) == '\0') goto done;  /* end anchor */
+        break;
+      }
+    }
+    e = itemend(q);
+    if (e == NULL) break;
+    quant = (*e == '?' || *e == '*' || *e == '+' || *e == '-');
+    addclass(cp, p, q, e, &nsets, n);
+    if (prefix) {
+      int c = literal(q);
+      if (quant && *e != '+')  /* may match no char */
+        prefix = 0;
+      else if (c >= 0) {
+        lit[cp->nlit++] = (char)c;
+        if (quant) prefix = 0;  /* `+': only one for sure */
+      }
+      else {
+        if (cp->nlit == 0 && *q != '.') {
+          if (cls[q - p])
+            cp->first = set + 32*(cls[q - p] - 1);
+          else {
+            classset(set + 32*n, q, e);
+            cp->first = set + 32*n;
+          }
+        }
+        prefix = 0;
+      }
+    }
+    q = quant ? e+1 : e;
+  }
+ done:
+  if (cp->nlit > 0) cp->first = NULL;
+  return cp;
+}
+
+
+static char pattern_key;  /* registry key of the cache */
+
+
+/* push the compiled form of the pattern at `arg', nil if not compiled */
+static const Pattern *getpattern (lua_State *L, int arg) {
+  size_t l;
+  const char *p = lua_tolstring(L, arg, &l);
+  Pattern *cp;
+  int n = PATT_CACHE;
+  if (memchr(p, '[', l) == NULL) {
+    lua_pushnil(L);
+    return NULL;
+  }
+  lua_pushlightuserdata(L, &pattern_key);
+  lua_rawget(L, LUA_REGISTRYINDEX);
+  if (lua_istable(L, -1)) {
+    lua_pushvalue(L, arg);
+    lua_rawget(L, -2);
+    cp = (Pattern *)lua_touserdata(L, -1);
+    if (cp != NULL) {  /* cached? */
+      lua_remove(L, -2);  /* remove cache */
+      return cp;
+    }
+    lua_pop(L, 1);
+    lua_rawgeti(L, -1, 0);  /* number of patterns in the cache */
+    n = lua_tointeger(L, -1);
+    lua_pop(L, 1);
+  }
+  if (n >= PATT_CACHE) {  /* no cache or a full one: start a new one */
+    lua_pop(L, 1);
+    lua_newtable(L);
+    lua_pushlightuserdata(L, &pattern_key);
+    lua_pushvalue(L, -2);
+    lua_rawset(L, LUA_REGISTRYINDEX);
+    n = 0;
+  }
+  cp = compile(L, p, l);
+  lua_pushvalue(L, arg);
+  lua_pushvalue(L, -2);
+  lua_rawset(L, -4);
+  lua_pushinteger(L, n + 1);
+  lua_rawseti(L, -3, 0);
+  lua_remove(L, -2);  /* remove cache */
+  return cp;
+}
+
+
 static const char *match (MatchState *ms, const char *s, const char *p);
 
 
@@ -300,7 +661,7 @@ static const char *matchbalance (MatchState *ms, const char *s,
 static const char *max_expand (MatchState *ms, const char *s,
                                  const char *p, const char *ep) {
   ptrdiff_t i = 0;  /* counts maximum expand for item */
-  while ((s+i)<ms->src_end && singlematch(uchar(*(s+i)), p, ep))
+  while ((s+i)<ms->src_end && singlematch(ms, uchar(*(s+i)), p, ep))
     i++;
   /* keeps trying to match with the maximum repetitions */
   while (i>=0) {
@@ -318,7 +679,7 @@ static const char *min_expand (MatchState *ms, const char *s,
     const char *res = match(ms, s, ep+1);
     if (res != NULL)
       return res;
-    else if (s<ms->src_end && singlematch(uchar(*s), p, ep))
+    else if (s<ms->src_end && singlematch(ms, uchar(*s), p, ep))
       s++;  /* try with one more repetition */
     else return NULL;
   }
@@ -388,8 +749,8 @@ static const char *match (MatchState *ms, const char *s, const char *p) {
                                LUA_QL("%%f") " in pattern");
           ep = classend(ms, p);  /* points to what is next */
           previous = (s == ms->src_init) ? '\0' : *(s-1);
-          if (matchbracketclass(uchar(previous), p, ep-1) ||
-             !matchbracketclass(uchar(*s), p, ep-1)) return NULL;
+          if (singlematch(ms, uchar(previous), p, ep) ||
+             !singlematch(ms, uchar(*s), p, ep)) return NULL;
           p=ep; goto init;  /* else return match(ms, s, ep); */
         }
         default: {
@@ -412,7 +773,7 @@ static const char *match (MatchState *ms, const char *s, const char *p) {
     }
     default: dflt: {  /* it is a pattern item */
       const char *ep = classend(ms, p);  /* points to what is next */
-      int m = s<ms->src_end && singlematch(uchar(*s), p, ep);
+      int m = s<ms->src_end && singlematch(ms, uchar(*s), p, ep);
       switch (*ep) {
         case '?': {  /* optional */
           const char *res;
@@ -462,6 +823,42 @@ static const char *lmemfind (const char *s1, size_t l1,
 }
 
 
+/* set the pattern of `ms', `cp' its compiled form or NULL */
+static void setpattern (MatchState *ms, const char *p, const Pattern *cp) {
+  ms->p_init = p;
+  ms->cp = cp;
+  if (cp != NULL) {
+    ms->lit = cp->lit;
+    ms->nlit = cp->nlit;
+    ms->first = cp->first;
+  }
+  else {  /* the plain chars it starts with, or an escaped one */
+    size_t n = strcspn(p, SPECIALS ")");
+    if (n == 0 && literal(p) >= 0 && *p == L_ESC) {
+      p++;
+      n = 1;
+    }
+    if (n > 0 && p[n] != '\0' && strchr("*?-", p[n]) != NULL)
+      n--;  /* the last one may match no char */
+    ms->lit = p;
+    ms->nlit = n;
+    ms->first = NULL;
+  }
+}
+
+
+/* first position from `s' where a match can start, NULL if none */
+static const char *skipto (MatchState *ms, const char *s) {
+  if (ms->nlit > 0)
+    return lmemfind(s, ms->src_end - s, ms->lit, ms->nlit);
+  else if (ms->first != NULL) {
+    while (s < ms->src_end && !inset(ms->first, uchar(*s))) s++;
+    return (s < ms->src_end) ? s : NULL;
+  }
+  else return s;
+}
+
+
 static void push_onecapture (MatchState *ms, int i, const char *s,
                                                     const char *e) {
   if (i >= ms->level) {
@@ -515,8 +912,11 @@ static int str_find_aux (lua_State *L, int find) {
     ms.L = L;
     ms.src_init = s;
     ms.src_end = s+l1;
+    setpattern(&ms, p - anchor, getpattern(L, 2));
     do {
       const char *res;
+      if (!anchor && (s1 = skipto(&ms, s1)) == NULL)
+        break;  /* no place left to start at */
       ms.level = 0;
       if ((res=match(&ms, s1, p)) != NULL) {
         if (find) {
@@ -553,10 +953,13 @@ static int gmatch_aux (lua_State *L) {
   ms.L = L;
   ms.src_init = s;
   ms.src_end = s+ls;
+  setpattern(&ms, p, (const Pattern *)lua_touserdata(L, lua_upvalueindex(4)));
   for (src = s + (size_t)lua_tointeger(L, lua_upvalueindex(3));
        src <= ms.src_end;
        src++) {
     const char *e;
+    if ((src = skipto(&ms, src)) == NULL)
+      break;  /* no place left to start at */
     ms.level = 0;
     if ((e = match(&ms, src, p)) != NULL) {
       lua_Integer newstart = e-s;
@@ -575,7 +978,8 @@ static int gmatch (lua_State *L) {
   luaL_checkstring(L, 2);
   lua_settop(L, 2);
   lua_pushinteger(L, 0);
-  lua_pushcclosure(L, gmatch_aux, 3);
+  getpattern(L, 2);
+  lua_pushcclosure(L, gmatch_aux, 4);
   return 1;
 }
 
@@ -641,6 +1045,49 @@ static void add_value (MatchState *ms, luaL_Buffer *b, const char *s,
 }
 
 
+/*
+** gsub of a short subject with a plain replacement string (no `%'): the
+** result is built on the C stack. -1 if it is longer than STR_SHORT.
+*/
+static int gsub_short (MatchState *ms, const char *src, const char *p,
+                       int anchor, int max_s, const char *r, size_t lr,
+                       char *out, size_t *lout) {
+  size_t k = 0;
+  int n = 0;
+  while (n < max_s) {
+    const char *e;
+    if (!anchor) {  /* copy up to where a match can start */
+      const char *next = skipto(ms, src);
+      if (next == NULL) break;
+      if (k + (next - src) > STR_SHORT) return -1;
+      memcpy(out + k, src, next - src);
+      k += next - src;
+      src = next;
+    }
+    ms->level = 0;
+    e = match(ms, src, p);
+    if (e) {
+      n++;
+      if (k + lr > STR_SHORT) return -1;
+      memcpy(out + k, r, lr);
+      k += lr;
+    }
+    if (e && e>src) /* non empty match? */
+      src = e;  /* skip it */
+    else if (src < ms->src_end) {
+      if (k + 1 > STR_SHORT) return -1;
+      out[k++] = *src++;
+    }
+    else break;
+    if (anchor) break;
+  }
+  if (k + (ms->src_end - src) > STR_SHORT) return -1;
+  memcpy(out + k, src, ms->src_end - src);
+  *lout = k + (ms->src_end - src);
+  return n;
+}
+
+
 static int str_gsub (lua_State *L) {
   size_t srcl;
   const char *src = luaL_checklstring(L, 1, &srcl);
@@ -650,32 +1097,53 @@ static int str_gsub (lua_State *L) {
   int anchor = (*p == '^') ? (p++, 1) : 0;
   int n = 0;
   MatchState ms;
-  //luaL_Buffer b;//doit
+  luaL_Buffer *b;
   luaL_argcheck(L, tr == LUA_TNUMBER || tr == LUA_TSTRING ||
                    tr == LUA_TFUNCTION || tr == LUA_TTABLE ||
                    tr == LUA_TLIGHTFUNCTION, 3,
                    "string/function/table/lightfunction expected");
-  luaL_buffinit(L, &b);
   ms.L = L;
   ms.src_init = src;
   ms.src_end = src+srcl;
+  setpattern(&ms, p - anchor, getpattern(L, 2));
+  if ((tr == LUA_TNUMBER || tr == LUA_TSTRING) && srcl <= STR_SHORT) {
+    size_t lr, lout;
+    const char *r = lua_tolstring(L, 3, &lr);
+    char out[STR_SHORT];
+    if (memchr(r, L_ESC, lr) == NULL &&
+        (n = gsub_short(&ms, src, p, anchor, max_s, r, lr, out, &lout)) >= 0) {
+      lua_pushlstring(L, out, lout);
+      lua_pushinteger(L, n);  /* number of substitutions */
+      return 2;
+    }
+    n = 0;  /* too long: again with a buffer */
+  }
+  b = buffer_get(L);
+  luaL_buffinit(L, b);
   while (n < max_s) {
     const char *e;
+    if (!anchor) {  /* copy up to where a match can start */
+      const char *next = skipto(&ms, src);
+      if (next == NULL) break;
+      luaL_addlstring(b, src, next - src);
+      src = next;
+    }
     ms.level = 0;
     e = match(&ms, src, p);
     if (e) {
       n++;
-      add_value(&ms, &b, src, e);
+      add_value(&ms, b, src, e);
     }
     if (e && e>src) /* non empty match? */
       src = e;  /* skip it */
     else if (src < ms.src_end)
-      luaL_addchar(&b, *src++);
+      luaL_addchar(b, *src++);
     else break;
     if (anchor) break;
   }
-  luaL_addlstring(&b, src, ms.src_end-src);
-  luaL_pushresult(&b);
+  luaL_addlstring(b, src, ms.src_end-src);
+  luaL_pushresult(b);
+  buffer_put(L, b, -2);
   lua_pushinteger(L, n);  /* number of substitutions */
   return 2;
 }
@@ -755,19 +1223,49 @@ static void addintlen (char *form) {
 }
 
 
+/*
+** The result of format goes to `out' on the C stack while it fits, and to
+** a buffer of the pool from the first part that does not.
+*/
+static luaL_Buffer *format_spill (lua_State *L, const char *out, size_t k) {
+  luaL_Buffer *b = buffer_get(L);
+  luaL_buffinit(L, b);
+  luaL_addlstring(b, out, k);
+  return b;
+}
+
+
+static luaL_Buffer *format_add (lua_State *L, luaL_Buffer *b, char *out,
+                                size_t *k, const char *s, size_t l) {
+  if (b == NULL && *k + l <= STR_SHORT) {
+    memcpy(out + *k, s, l);
+    *k += l;
+    return NULL;
+  }
+  if (b == NULL) b = format_spill(L, out, *k);
+  luaL_addlstring(b, s, l);
+  return b;
+}
+
+
 static int str_format (lua_State *L) {
   int top = lua_gettop(L);
   int arg = 1;
   size_t sfl;
   const char *strfrmt = luaL_checklstring(L, arg, &sfl);
   const char *strfrmt_end = strfrmt+sfl;
-  //luaL_Buffer b;//doit
-  luaL_buffinit(L, &b);
+  char out[STR_SHORT];
+  size_t k = 0;  /* bytes in out */
+  luaL_Buffer *b = NULL;  /* from the first part out has no room for */
   while (strfrmt < strfrmt_end) {
-    if (*strfrmt != L_ESC)
-      luaL_addchar(&b, *strfrmt++);
+    if (*strfrmt != L_ESC) {  /* the plain chars up to the next item */
+      const char *e = (const char *)memchr(strfrmt, L_ESC, strfrmt_end - strfrmt);
+      if (e == NULL) e = strfrmt_end;
+      b = format_add(L, b, out, &k, strfrmt, e - strfrmt);
+      strfrmt = e;
+    }
     else if (*++strfrmt == L_ESC)
-      luaL_addchar(&b, *strfrmt++);  /* %% */
+      b = format_add(L, b, out, &k, strfrmt++, 1);  /* %% */
     else { /* format item */
       char form[MAX_FORMAT];  /* to store the format (`%...') */
       char buff[MAX_ITEM];  /* to store the formatted item */
@@ -797,7 +1295,8 @@ static int str_format (lua_State *L) {
         }
 #endif
         case 'q': {
-          addquoted(L, &b, arg);
+          if (b == NULL) b = format_spill(L, out, k);
+          addquoted(L, b, arg);
           continue;  /* skip the 'addsize' at the end */
         }
         case 's': {
@@ -806,8 +1305,9 @@ static int str_format (lua_State *L) {
           if (!strchr(form, '.') && l >= 100) {
             /* no precision and string is too long to be formatted;
                keep original string */
+            if (b == NULL) b = format_spill(L, out, k);
             lua_pushvalue(L, arg);
-            luaL_addvalue(&b);
+            luaL_addvalue(b);
             continue;  /* skip the `addsize' at the end */
           }
           else {
@@ -820,10 +1320,15 @@ static int str_format (lua_State *L) {
                                LUA_QL("format"), *(strfrmt - 1));
         }
       }
-      luaL_addlstring(&b, buff, strlen(buff));
+      b = format_add(L, b, out, &k, buff, strlen(buff));
     }
   }
-  luaL_pushresult(&b);
+  if (b == NULL) {
+    lua_pushlstring(L, out, k);
+    return 1;
+  }
+  luaL_pushresult(b);
+  buffer_put(L, b, -2);
   return 1;
 }
 
@@ -380,6 +380,11 @@ enum{
   onMQTT,
   onMQTTmsg,
   onFTP,
+  onADC,
+  onCAPTURE,
+  onNetSent,
+  onNetRecv,
+  onNetCo,
   needUNREF = 0x10,
 };
 
@@ -20,6 +20,7 @@
 #include "lgc.h"
 #include "lobject.h"
 #include "lopcodes.h"
+#include "lprofile.h"
 #include "lstate.h"
 #include "lstring.h"
 #include "ltable.h"
@@ -439,14 +440,18 @@ void luaV_execute (lua_State *L, int nexeccalls) {
   for (;;) {
     const Instruction i = *pc++;
     StkId ra;
-    if ((L->hookmask & (LUA_MASKLINE | LUA_MASKCOUNT)) &&
-        (--L->hookcount == 0 || L->hookmask & LUA_MASKLINE)) {
-      traceexec(L, pc);
-      if (L->status == LUA_YIELD) {  /* did hook yield? */
-        L->savedpc = pc - 1;
-        return;
+    if (L->hookmask & (LUA_MASKLINE | LUA_MASKCOUNT | LUA_MASKPROFILE)) {
+      if (L->hookmask & LUA_MASKPROFILE)
+        luaV_profstep(L, i, pc);
+      if ((L->hookmask & (LUA_MASKLINE | LUA_MASKCOUNT)) &&
+          (--L->hookcount == 0 || L->hookmask & LUA_MASKLINE)) {
+        traceexec(L, pc);
+        if (L->status == LUA_YIELD) {  /* did hook yield? */
+          L->savedpc = pc - 1;
+          return;
+        }
+        base = L->base;
       }
-      base = L->base;
     }
     /* warning!! several calls may realloc the stack and invalidate `ra' */
     ra = RA(i);
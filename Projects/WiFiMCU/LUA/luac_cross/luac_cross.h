@@ -0,0 +1,30 @@
+/*
+** Host side Lua cross compiler for WiFiMCU, shared declarations.
+*/
+
+#ifndef luac_cross_h
+#define luac_cross_h
+
+#include "lua.h"
+#include "lobject.h"
+
+/* spiffs layout used by the module, keep in sync with exlibs/file.c */
+#define SPIFFSIMG_LOG_BLOCK_SIZE	(16*1024)
+#define SPIFFSIMG_LOG_PAGE_SIZE		128
+#define SPIFFSIMG_PHYS_ERASE_BLOCK	SPIFFSIMG_LOG_BLOCK_SIZE
+#define SPIFFSIMG_MAX_DIR_DEPTH		5
+
+/* MICO_PARTITION_LUA length in Board/WiFiMCU/platform.c */
+#define SPIFFSIMG_DEFAULT_SIZE		0x1C0000
+
+/* dump f for the selected target, leaves the bytecode string on the stack */
+int luac_cross_dump(lua_State* L, const Proto* f);
+
+/* reload the bytecode string on top of the stack and compare a fresh dump */
+int luac_cross_check(lua_State* L, const char* name);
+
+/* pack dir into a spiffs image of size bytes, 0 on success */
+int spiffsimg_build(lua_State* L, const char* dir, const char* image,
+                    unsigned long size, int compile, const char* progname);
+
+#endif
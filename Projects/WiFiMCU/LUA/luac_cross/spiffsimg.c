@@ -0,0 +1,261 @@
+/*
+** Build a spiffs image of a script directory on the host. The image is a
+** dump of the whole MICO_PARTITION_LUA partition and is programmed with
+** the Bootloader FLASHUPDATE command.
+*/
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define LUA_CORE
+
+#include "lua.h"
+#include "lauxlib.h"
+
+#include "lobject.h"
+#include "lstate.h"
+
+#include "spiffs.h"
+#include "spiffs_nucleus.h"
+
+#include "luac_cross.h"
+
+#define toproto(L,i) (clvalue(L->top+(i))->l.p)
+
+typedef struct {
+ lua_State* L;
+ spiffs fs;
+ int compile;
+ int files;
+ const char* progname;
+} ImageState;
+
+static u8_t* flash;
+static u32_t flash_size;
+
+static u8_t work_buf[SPIFFSIMG_LOG_PAGE_SIZE*2];
+static u8_t fds[32*4];
+static u8_t cache_buf[(SPIFFSIMG_LOG_PAGE_SIZE+32)*4];
+
+static s32_t img_read(u32_t addr, u32_t size, u8_t *dst)
+{
+ if (addr+size>flash_size) return SPIFFS_ERR_INTERNAL;
+ memcpy(dst,flash+addr,size);
+ return SPIFFS_OK;
+}
+
+/* NOR flash can only clear bits */
+static s32_t img_write(u32_t addr, u32_t size, u8_t *src)
+{
+ u32_t i;
+ if (addr+size>flash_size) return SPIFFS_ERR_INTERNAL;
+ for (i=0; i<size; i++) flash[addr+i]&=src[i];
+ return SPIFFS_OK;
+}
+
+static s32_t img_erase(u32_t addr, u32_t size)
+{
+ if (addr+size>flash_size) return SPIFFS_ERR_INTERNAL;
+ memset(flash+addr,0xff,size);
+ return SPIFFS_OK;
+}
+
+static int img_mount(ImageState* S)
+{
+ spiffs_config cfg;
+ memset(&cfg,0,sizeof(cfg));
+ cfg.phys_size=flash_size;
+ cfg.phys_addr=0;
+ cfg.log_block_size=SPIFFSIMG_LOG_BLOCK_SIZE;
+ cfg.phys_erase_block=SPIFFSIMG_PHYS_ERASE_BLOCK;
+ cfg.log_page_size=SPIFFSIMG_LOG_PAGE_SIZE;
+ cfg.hal_read_f=img_read;
+ cfg.hal_write_f=img_write;
+ cfg.hal_erase_f=img_erase;
+ return SPIFFS_mount(&S->fs,&cfg,work_buf,fds,sizeof(fds),
+                     cache_buf,sizeof(cache_buf),NULL);
+}
+
+static int img_error(ImageState* S, const char* what, const char* name, const char* why)
+{
+ fprintf(stderr,"%s: cannot %s %s: %s\n",S->progname,what,name,why);
+ return -1;
+}
+
+static int img_fserror(ImageState* S, const char* what, const char* name)
+{
+ char why[32];
+ snprintf(why,sizeof(why),"spiffs error %d",(int)SPIFFS_errno(&S->fs));
+ return img_error(S,what,name,why);
+}
+
+static int img_write_file(ImageState* S, const char* name, const char* data, size_t len)
+{
+ spiffs_file fd;
+ if (strlen(name)>=SPIFFS_OBJ_NAME_LEN)
+  return img_error(S,"store",name,"name too long");
+ fd=SPIFFS_open(&S->fs,(char*)name,SPIFFS_WRONLY|SPIFFS_CREAT|SPIFFS_TRUNC,0);
+ if (fd<0) return img_fserror(S,"create",name);
+ if (len>0 && SPIFFS_write(&S->fs,fd,(void*)data,len)!=(s32_t)len)
+ {
+  img_fserror(S,"write",name);
+  SPIFFS_close(&S->fs,fd);
+  return -1;
+ }
+ SPIFFS_close(&S->fs,fd);
+ S->files++;
+ return 0;
+}
+
+static char* read_file(const char* path, size_t* len)
+{
+ FILE* f=fopen(path,"rb");
+ char* data;
+ long n;
+ if (f==NULL) return NULL;
+ fseek(f,0,SEEK_END);
+ n=ftell(f);
+ fseek(f,0,SEEK_SET);
+ data=malloc(n>0 ? n : 1);
+ if (data!=NULL && n>0 && fread(data,n,1,f)!=1)
+ {
+  free(data);
+  data=NULL;
+ }
+ fclose(f);
+ *len=(size_t)n;
+ return data;
+}
+
+static int img_add_file(ImageState* S, const char* path, const char* name)
+{
+ size_t len=strlen(name);
+ if (S->compile && len>4 && strcmp(name+len-4,".lua")==0)
+ {
+  /* store foo.lua as foo.lc, like file.compile() on the module */
+  char lcname[SPIFFS_OBJ_NAME_LEN+1];
+  const char* code;
+  int res;
+  if (len>=sizeof(lcname)) return img_error(S,"store",name,"name too long");
+  memcpy(lcname,name,len-2);
+  strcpy(lcname+len-2,"c");
+  if (luaL_loadfile(S->L,path)!=0)
+  {
+   fprintf(stderr,"%s: %s\n",S->progname,lua_tostring(S->L,-1));
+   return -1;
+  }
+  luac_cross_dump(S->L,toproto(S->L,-1));
+  luac_cross_check(S->L,lcname);
+  code=lua_tolstring(S->L,-1,&len);
+  res=img_write_file(S,lcname,code,len);
+  lua_pop(S->L,2);
+  return res;
+ }
+ else
+ {
+  char* data=read_file(path,&len);
+  int res;
+  if (data==NULL) return img_error(S,"read",path,strerror(errno));
+  res=img_write_file(S,name,data,len);
+  free(data);
+  return res;
+ }
+}
+
+/* add the contents of dir, name is its path inside the image ("" for root) */
+static int img_add_dir(ImageState* S, const char* dir, const char* name, int depth)
+{
+ struct dirent** list;
+ int i,n,res=0;
+ if (depth>SPIFFSIMG_MAX_DIR_DEPTH)
+ {
+  fprintf(stderr,"%s: %s: directories nested too deep\n",S->progname,dir);
+  return -1;
+ }
+ n=scandir(dir,&list,NULL,alphasort);
+ if (n<0) return img_error(S,"open",dir,strerror(errno));
+ for (i=0; i<n; i++)
+ {
+  const char* entry=list[i]->d_name;
+  char path[1024],iname[SPIFFS_OBJ_NAME_LEN+1];
+  struct stat st;
+  if (res!=0 || entry[0]=='.') continue;	/* skip hidden files, "." and ".." */
+  snprintf(path,sizeof(path),"%s/%s",dir,entry);
+  if ((size_t)snprintf(iname,sizeof(iname),"%s%s",name,entry)>=sizeof(iname)-1)
+   res=img_error(S,"store",path,"name too long");
+  else if (stat(path,&st)!=0)
+   res=img_error(S,"stat",path,strerror(errno));
+  else if (S_ISDIR(st.st_mode))
+  {
+   /* file.mkdir() on the module stores directories as empty "name/" files */
+   strcat(iname,"/");
+   res=img_write_file(S,iname,NULL,0);
+   if (res==0) res=img_add_dir(S,path,iname,depth+1);
+  }
+  else if (S_ISREG(st.st_mode))
+   res=img_add_file(S,path,iname);
+ }
+ for (i=0; i<n; i++) free(list[i]);
+ free(list);
+ return res;
+}
+
+int spiffsimg_build(lua_State* L, const char* dir, const char* image,
+                    unsigned long size, int compile, const char* progname)
+{
+ ImageState S;
+ u32_t total=0,used=0;
+ FILE* f;
+ int res;
+ if (size%SPIFFSIMG_LOG_BLOCK_SIZE!=0)
+ {
+  fprintf(stderr,"%s: image size must be a multiple of %d\n",progname,SPIFFSIMG_LOG_BLOCK_SIZE);
+  return -1;
+ }
+ memset(&S,0,sizeof(S));
+ S.L=L;
+ S.compile=compile;
+ S.progname=progname;
+ flash_size=(u32_t)size;
+ flash=malloc(flash_size);
+ if (flash==NULL)
+ {
+  fprintf(stderr,"%s: not enough memory for image\n",progname);
+  return -1;
+ }
+ memset(flash,0xff,flash_size);
+ /* mount configures the fs, it fails on blank flash as expected */
+ img_mount(&S);
+ SPIFFS_unmount(&S.fs);
+ res=SPIFFS_format(&S.fs);
+ if (res==0) res=img_mount(&S);
+ if (res!=0)
+  res=img_fserror(&S,"format",image);
+ else
+  res=img_add_dir(&S,dir,"",1);
+ if (res==0)
+ {
+  SPIFFS_info(&S.fs,&total,&used);
+  SPIFFS_unmount(&S.fs);
+  /* make sure the module will mount what we wrote */
+  if (img_mount(&S)!=0) res=img_fserror(&S,"remount",image);
+  SPIFFS_unmount(&S.fs);
+ }
+ if (res==0)
+ {
+  f=fopen(image,"wb");
+  if (f==NULL)
+   res=img_error(&S,"create",image,strerror(errno));
+  else if ((fwrite(flash,flash_size,1,f)!=1) | (fclose(f)!=0))
+   res=img_error(&S,"write",image,strerror(errno));
+  else
+   printf("%s: %d files, %u of %u bytes used\n",image,S.files,(unsigned)used,(unsigned)total);
+ }
+ free(flash);
+ flash=NULL;
+ return res;
+}
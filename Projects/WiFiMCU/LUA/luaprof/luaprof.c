@@ -0,0 +1,245 @@
+/*
+** luaprof.c
+** Host build of the WiFiMCU Lua core with the profiler of lprofile.c.
+** Runs a script, samples it on SIGALRM and prints the instructions run,
+** the opcode histogram and the collapsed stacks, the input of
+** flamegraph.pl. See readme.txt.
+*/
+
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#define luaprof_c
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+
+#include "lopcodes.h"
+#include "lprofile.h"
+#include "lrotable.h"
+
+#define PROGNAME	"luaprof"
+
+/* The read only libraries of the firmware, plus coroutine */
+extern const luaR_entry strlib[];
+extern const luaR_entry math_map[];
+extern const luaR_entry tab_funcs[];
+extern const luaR_entry co_funcs[];
+
+const luaR_table lua_rotable[] =
+{
+    {LUA_STRLIBNAME, strlib},
+    {LUA_MATHLIBNAME, math_map},
+    {LUA_TABLIBNAME, tab_funcs},
+    {LUA_COLIBNAME, co_funcs},
+    {NULL, NULL}
+};
+
+/* dostring() and its output redirection, from lua.c and wifimcu_lua.c */
+uint8_t _lua_redir=0;
+char* _lua_redir_buf=NULL;
+uint16_t _lua_redir_ptr=0;
+
+int dostring(lua_State* L, const char* s, const char* name)
+{
+ int status=luaL_loadbuffer(L,s,strlen(s),name) || lua_pcall(L,0,0,0);
+ if (status!=0)
+ {
+  fprintf(stderr,"%s\n",lua_tostring(L,-1));
+  lua_pop(L,1);
+ }
+ return status;
+}
+
+static int interval=1000;		/* sampling interval, us */
+static int runs=1;			/* runs of the script */
+static int profiling=1;			/* 0: time the plain VM */
+static const char* output=NULL;		/* collapsed stacks, stdout if NULL */
+
+typedef struct Count {
+  const char* name;
+  unsigned long n;
+} Count;
+
+static void fatal(const char* message)
+{
+ fprintf(stderr,"%s: %s\n",PROGNAME,message);
+ exit(EXIT_FAILURE);
+}
+
+static void usage(const char* message)
+{
+ if (message!=NULL) fprintf(stderr,"%s: %s\n",PROGNAME,message);
+ fprintf(stderr,
+ "usage: %s [options] script.lua [args]\n"
+ "Available options are:\n"
+ "  -i us    sample every us microseconds (default 1000)\n"
+ "  -n runs  run the script runs times (default 1)\n"
+ "  -o file  write the collapsed stacks to file instead of stdout\n"
+ "  -x       do not profile, only time the script\n",
+ PROGNAME);
+ exit(EXIT_FAILURE);
+}
+
+static int doargs(int argc, char* argv[])
+{
+ int i;
+ for (i=1; i<argc; i++)
+ {
+  if (*argv[i]!='-')			/* end of options */
+   break;
+  else if (strcmp(argv[i],"-i")==0 && i+1<argc)
+  {
+   interval=atoi(argv[++i]);
+   if (interval<=0) usage("bad interval");
+  }
+  else if (strcmp(argv[i],"-n")==0 && i+1<argc)
+  {
+   runs=atoi(argv[++i]);
+   if (runs<=0) usage("bad run count");
+  }
+  else if (strcmp(argv[i],"-o")==0 && i+1<argc)
+   output=argv[++i];
+  else if (strcmp(argv[i],"-x")==0)
+   profiling=0;
+  else
+   usage("unrecognized option");
+ }
+ if (i==argc) usage("no script given");
+ return i;
+}
+
+/* Wall clock like the mico_timer of mcu.profile(), ITIMER_PROF only moves
+   at the kernel tick */
+static void onprof(int sig)
+{
+ (void)sig;
+ lua_proftick();
+}
+
+static void settimer(int us)
+{
+ struct itimerval t;
+ struct sigaction sa;
+ memset(&sa,0,sizeof(sa));
+ sa.sa_handler=onprof;
+ sa.sa_flags=SA_RESTART;		/* fread() of the script */
+ sigaction(SIGALRM,&sa,NULL);
+ t.it_interval.tv_sec=us/1000000;
+ t.it_interval.tv_usec=us%1000000;
+ t.it_value=t.it_interval;
+ if (setitimer(ITIMER_REAL,&t,NULL)!=0) fatal("cannot set the profiling timer");
+}
+
+static double now(void)
+{
+ struct timespec ts;
+ clock_gettime(CLOCK_MONOTONIC,&ts);
+ return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+static int bycount(const void* a, const void* b)
+{
+ unsigned long x=((const Count*)a)->n, y=((const Count*)b)->n;
+ return (x<y)-(x>y);
+}
+
+static int byname(const void* a, const void* b)
+{
+ return strcmp(((const Count*)a)->name,((const Count*)b)->name);
+}
+
+static void report(double seconds)
+{
+ Count c[NUM_OPCODES > LUA_PROFILE_STACKS ? NUM_OPCODES : LUA_PROFILE_STACKS];
+ unsigned long total=0, samples, dropped, n;
+ const char* label;
+ FILE* f=stdout;
+ int i, k, r;
+
+ fprintf(stderr,"%d run(s): %.3f s, %.3f ms per run\n",
+  runs,seconds,seconds*1000/runs);
+ if (!profiling) return;
+
+ for (i=0; i<NUM_OPCODES; i++)
+ {
+  c[i].name=luaP_opnames[i];
+  c[i].n=lua_profopcount(i);
+  total+=c[i].n;
+ }
+ fprintf(stderr,"instructions: %lu, %.1f M/s\n",total,total/seconds/1e6);
+ qsort(c,NUM_OPCODES,sizeof(Count),bycount);
+ for (i=0; i<NUM_OPCODES && c[i].n>0; i++)
+  fprintf(stderr,"  %-10s %10lu %5.1f%%\n",c[i].name,c[i].n,100.0*c[i].n/total);
+
+ samples=lua_profsamples(&dropped);
+ fprintf(stderr,"samples: %lu every %d us, %lu without a free slot\n",
+  samples,interval,dropped);
+ for (k=0; (label=lua_profstack(k,&n))!=NULL; k++)
+ {
+  c[k].name=label;
+  c[k].n=n;
+ }
+ qsort(c,k,sizeof(Count),byname);	/* a cut stack can match a whole one */
+ for (i=1, r=0; i<k; i++)
+ {
+  if (strcmp(c[i].name,c[r].name)==0) c[r].n+=c[i].n; else c[++r]=c[i];
+ }
+ if (k>0) k=r+1;
+ qsort(c,k,sizeof(Count),bycount);
+ if (output!=NULL && (f=fopen(output,"w"))==NULL) fatal("cannot open output");
+ for (i=0; i<k; i++) fprintf(f,"%s %lu\n",c[i].name,c[i].n);
+ if (dropped>0) fprintf(f,"[dropped] %lu\n",dropped);
+ if (f!=stdout) fclose(f);
+}
+
+int main(int argc, char* argv[])
+{
+ lua_State* L;
+ double start, seconds;
+ int i, r;
+ int script=doargs(argc,argv);
+
+ L=luaL_newstate();
+ if (L==NULL) fatal("not enough memory for state");
+ luaopen_base(L);
+ lua_settop(L,0);
+ lua_newtable(L);			/* arg, as in lua.c */
+ for (i=script; i<argc; i++)
+ {
+  lua_pushstring(L,argv[i]);
+  lua_rawseti(L,-2,i-script);
+ }
+ lua_setglobal(L,"arg");
+
+ if (profiling)
+ {
+  lua_profstart(L);
+  settimer(interval);
+ }
+ start=now();
+ for (r=0; r<runs; r++)
+ {
+  if (luaL_loadfile(L,argv[script])!=0 || lua_pcall(L,0,0,0)!=0)
+  {
+   fprintf(stderr,"%s: %s\n",PROGNAME,lua_tostring(L,-1));
+   return EXIT_FAILURE;
+  }
+ }
+ seconds=now()-start;
+ if (profiling)
+ {
+  settimer(0);
+  lua_profstop(L);
+ }
+ report(seconds);
+ lua_profreset(L);
+ lua_close(L);
+ return EXIT_SUCCESS;
+}
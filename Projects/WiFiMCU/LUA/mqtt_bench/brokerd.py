@@ -0,0 +1,259 @@
+#!/usr/bin/env python
+#
+# brokerd.py
+#
+# A small MQTT broker for testing the mqtt module against: MQTT 3.1 and
+# 3.1.1, QoS 0 to 2, '+' and '#' filters, no retained messages, no will,
+# no persistence. The benchmark publishes and listens in the same process
+# (Broker.publish, Broker.listen) and every PUBLISH that arrives is time
+# stamped, so that it measures the client and not a second one.
+#
+# usage: brokerd.py [-p port] [-v]
+#
+# The MIT License
+# Copyright (c) 2014 MXCHIP Inc.
+#
+
+import argparse
+import socket
+import socketserver
+import sys
+import threading
+import time
+
+CONNECT, CONNACK, PUBLISH, PUBACK, PUBREC, PUBREL, PUBCOMP = range(1, 8)
+SUBSCRIBE, SUBACK, UNSUBSCRIBE, UNSUBACK, PINGREQ, PINGRESP, DISCONNECT = range(8, 15)
+
+
+def matches(filt, topic):
+    """Whether topic matches the subscription filter filt"""
+    f = filt.split('/')
+    t = topic.split('/')
+    if topic.startswith('$') and f[0] in ('+', '#'):
+        return False
+    for i, level in enumerate(f):
+        if level == '#':
+            return True
+        if i >= len(t) or (level != '+' and level != t[i]):
+            return False
+    return len(f) == len(t)
+
+
+def packet(kind, flags, body):
+    rem = len(body)
+    head = bytearray([(kind << 4) | flags])
+    while True:
+        d = rem % 128
+        rem //= 128
+        head.append(d | 0x80 if rem else d)
+        if not rem:
+            break
+    return bytes(head) + body
+
+
+def string(s):
+    return len(s).to_bytes(2, 'big') + s
+
+
+class Session(socketserver.BaseRequestHandler):
+
+    def setup(self):
+        self.client_id = None
+        self.subs = {}
+        self.lock = threading.Lock()
+        self.next_id = 0
+        self.inflight = {}
+
+    def send(self, data):
+        with self.lock:
+            self.request.sendall(data)
+
+    def read(self, n):
+        data = b''
+        while len(data) < n:
+            d = self.request.recv(n - len(data))
+            if not d:
+                raise EOFError
+            data += d
+        return data
+
+    def handle(self):
+        try:
+            while True:
+                first = self.read(1)[0]
+                rem, mult = 0, 1
+                while True:
+                    b = self.read(1)[0]
+                    rem += (b & 0x7f) * mult
+                    mult *= 128
+                    if not b & 0x80:
+                        break
+                body = self.read(rem)
+                if not self.dispatch(first >> 4, first & 15, body):
+                    break
+        except (EOFError, OSError):
+            pass
+        self.server.gone(self)
+
+    def dispatch(self, kind, flags, body):
+        srv = self.server
+        if kind == CONNECT:
+            n = int.from_bytes(body[0:2], 'big')
+            proto, level = body[2:2 + n], body[2 + n]
+            p = 2 + n + 4
+            n = int.from_bytes(body[p:p + 2], 'big')
+            self.client_id = body[p + 2:p + 2 + n].decode('latin-1')
+            ok = (proto, level) in ((b'MQIsdp', 3), (b'MQTT', 4))
+            self.send(packet(CONNACK, 0, bytes([0, 0 if ok else 1])))
+            if ok:
+                srv.event(self, 'connect', self.client_id)
+            return ok
+        if kind == PUBLISH:
+            now = time.time()
+            qos = (flags >> 1) & 3
+            n = int.from_bytes(body[0:2], 'big')
+            topic = body[2:2 + n].decode('latin-1')
+            p = 2 + n
+            if qos:
+                pid = body[p:p + 2]
+                p += 2
+                self.send(packet(PUBACK if qos == 1 else PUBREC, 0, pid))
+            srv.arrived(self, topic, body[p:], qos, now)
+        elif kind == PUBREL:
+            self.send(packet(PUBCOMP, 0, body[0:2]))
+        elif kind in (PUBACK, PUBCOMP):
+            self.inflight.pop(body[0:2], None)
+        elif kind == PUBREC:
+            self.send(packet(PUBREL, 2, body[0:2]))
+        elif kind == SUBSCRIBE:
+            pid, p, granted = body[0:2], 2, b''
+            while p < len(body):
+                n = int.from_bytes(body[p:p + 2], 'big')
+                filt = body[p + 2:p + 2 + n].decode('latin-1')
+                qos = body[p + 2 + n]
+                p += 3 + n
+                self.subs[filt] = min(qos, 2)
+                granted += bytes([min(qos, 2)])
+                srv.event(self, 'subscribe', filt)
+            self.send(packet(SUBACK, 0, pid + granted))
+        elif kind == UNSUBSCRIBE:
+            pid, p = body[0:2], 2
+            while p < len(body):
+                n = int.from_bytes(body[p:p + 2], 'big')
+                filt = body[p + 2:p + 2 + n].decode('latin-1')
+                p += 2 + n
+                self.subs.pop(filt, None)
+                srv.event(self, 'unsubscribe', filt)
+            self.send(packet(UNSUBACK, 0, pid))
+        elif kind == PINGREQ:
+            self.send(packet(PINGRESP, 0, b''))
+            srv.event(self, 'ping', '')
+        elif kind == DISCONNECT:
+            return False
+        return True
+
+    def deliver(self, topic, payload, qos):
+        """A message to this client if a filter matches, at the lower QoS"""
+        granted = [q for f, q in self.subs.items() if matches(f, topic)]
+        if not granted:
+            return False
+        qos = min(qos, max(granted))
+        body = string(topic.encode('latin-1'))
+        if qos:
+            self.next_id = self.next_id % 65535 + 1
+            pid = self.next_id.to_bytes(2, 'big')
+            self.inflight[pid] = topic
+            body += pid
+        self.send(packet(PUBLISH, qos << 1, body + payload))
+        return True
+
+
+class Broker(socketserver.ThreadingTCPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+    def __init__(self, port=0, verbose=False):
+        socketserver.ThreadingTCPServer.__init__(self, ('127.0.0.1', port), Session)
+        self.verbose = verbose
+        self.sessions = []
+        self.events = []
+        self.listeners = []
+        self.cond = threading.Condition()
+
+    def event(self, session, what, arg):
+        if self.verbose:
+            print('brokerd.py: %s %s %s' % (session.client_id, what, arg))
+            sys.stdout.flush()
+        with self.cond:
+            if what == 'connect':
+                self.sessions.append(session)
+            self.events.append((session.client_id, what, arg))
+            self.cond.notify_all()
+
+    def gone(self, session):
+        with self.cond:
+            if session in self.sessions:
+                self.sessions.remove(session)
+                self.events.append((session.client_id, 'gone', ''))
+            self.cond.notify_all()
+
+    def arrived(self, session, topic, payload, qos, when):
+        self.event(session, 'publish', (topic, payload, qos))
+        for fn in list(self.listeners):
+            fn(topic, payload, when)
+        self.publish(topic, payload, qos, session)
+
+    def publish(self, topic, payload, qos=0, sender=None):
+        """Send to every session subscribed, the number of them"""
+        n = 0
+        with self.cond:
+            sessions = list(self.sessions)
+        for s in sessions:
+            if s is not sender:
+                try:
+                    n += s.deliver(topic, payload, qos)
+                except OSError:
+                    pass
+        return n
+
+    def listen(self, fn):
+        """fn(topic, payload, time) for each PUBLISH from a client"""
+        self.listeners.append(fn)
+
+    def wait(self, test, timeout):
+        """Wait until test(events) holds, its last value"""
+        end = time.time() + timeout
+        with self.cond:
+            while not test(self.events) and time.time() < end:
+                self.cond.wait(end - time.time())
+            return test(self.events)
+
+    def drop(self, client_id):
+        """Close the connection of a client as a failing network would"""
+        with self.cond:
+            sessions = [s for s in self.sessions if s.client_id == client_id]
+        for s in sessions:
+            s.request.shutdown(socket.SHUT_RDWR)
+
+    def start(self):
+        threading.Thread(target=self.serve_forever, daemon=True).start()
+        return self.server_address[1]
+
+
+def main():
+    ap = argparse.ArgumentParser(description='MQTT broker for testing the mqtt module')
+    ap.add_argument('-p', dest='port', type=int, default=1883)
+    ap.add_argument('-v', dest='verbose', action='store_true',
+                    help='print connects, subscriptions and messages')
+    args = ap.parse_args()
+    broker = Broker(args.port, args.verbose)
+    print('brokerd.py: listening on 127.0.0.1:%d' % broker.server_address[1])
+    sys.stdout.flush()
+    try:
+        broker.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
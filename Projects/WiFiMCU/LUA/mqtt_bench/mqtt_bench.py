@@ -0,0 +1,317 @@
+#!/usr/bin/env python
+#
+# mqtt_bench.py
+#
+# Runs the mqtt module of the host firmware (../host/wifimcu.host) against
+# brokerd.py: a self check of connecting, subscribing with wildcards,
+# publishing at each QoS, unsubscribing and reconnecting, then the round
+# trip of a message through the Lua script and the wakeups per second of
+# the mqtt thread, idle and under a stream of messages.
+#
+# usage: mqtt_bench.py [-f firmware] [-k] [-n messages] [-r rate] [-w secs]
+#
+# The MIT License
+# Copyright (c) 2014 MXCHIP Inc.
+#
+
+import argparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+import brokerd
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+SETUP = '''
+c=mqtt.new("wifimcu","user","pass",30)
+mqtt.on(c,"connect",function(x) print("@ connect "..x) end)
+mqtt.on(c,"offline",function(x,r) print("@ offline "..x.." "..r) end)
+mqtt.on(c,"message",function(t,n,m) print("@ msg "..t.." "..n.." "..m) end)
+@ start mqtt.start(c,"127.0.0.1",%(port)d)
+'''
+
+# "ping" is answered on "pong", "flood/..." only counted
+ECHO = '''
+n=0
+mqtt.on(c,"message",function(t,l,m) if t=="ping" then mqtt.publish(c,"pong",0,m) else n=n+1 end end)
+@ sub1 mqtt.subscribe(c,"ping",0)
+@ sub2 mqtt.subscribe(c,"flood/#",0)
+'''
+
+
+class Firmware(object):
+    """The host firmware running a script on its console"""
+
+    def __init__(self, exe, cwd):
+        self.proc = subprocess.Popen([exe], cwd=cwd, stdin=subprocess.PIPE,
+                                     stdout=subprocess.PIPE,
+                                     stderr=subprocess.STDOUT)
+        self.results = []
+        self.output = []
+        self.cond = threading.Condition()
+        threading.Thread(target=self.read, daemon=True).start()
+
+    def read(self):
+        for line in self.proc.stdout:
+            line = line.decode('latin-1').rstrip('\r\n')
+            self.output.append(line)
+            # output of a callback follows the prompt it interrupted
+            line = re.sub(r'^(/\S*> )+', '', line)
+            if line.startswith('@ '):
+                name, _, value = line[2:].partition(' ')
+                with self.cond:
+                    self.results.append((name, value))
+                    self.cond.notify_all()
+
+    def send(self, script):
+        lines = []
+        for line in script.strip().splitlines():
+            if line.startswith('@ '):
+                name, _, call = line[2:].partition(' ')
+                line = ('local r = {%s} for i = 1, #r do r[i] = tostring(r[i]) end '
+                        'print("@ %s "..table.concat(r, " "))' % (call, name))
+            lines.append(line)
+        self.proc.stdin.write(('\n'.join(lines) + '\n').encode('latin-1'))
+        self.proc.stdin.flush()
+
+    def wait(self, name, count=1, timeout=10):
+        """Wait for the count-th result name, its value or None"""
+        end = time.time() + timeout
+        with self.cond:
+            while True:
+                got = [v for n, v in self.results if n == name]
+                if len(got) >= count:
+                    return got[count - 1]
+                if time.time() >= end:
+                    return None
+                self.cond.wait(end - time.time())
+
+    def all(self, name):
+        with self.cond:
+            return [v for n, v in self.results if n == name]
+
+    def wakeups(self, thread='Mqtt_Thread'):
+        """Voluntary context switches of a thread so far: the times it
+        blocked, so the times it was woken"""
+        task = '/proc/%d/task' % self.proc.pid
+        for tid in os.listdir(task):
+            try:
+                with open(os.path.join(task, tid, 'comm')) as f:
+                    if f.read().strip() != thread:
+                        continue
+                with open(os.path.join(task, tid, 'status')) as f:
+                    for line in f:
+                        if line.startswith('voluntary_ctxt_switches:'):
+                            return int(line.split()[1])
+            except OSError:
+                continue
+        return None
+
+    def stop(self):
+        self.proc.kill()
+        self.proc.wait()
+
+
+def session(args):
+    """A broker and the firmware connected to it"""
+    broker = brokerd.Broker()
+    port = broker.start()
+    work = tempfile.mkdtemp(prefix='mqtt_bench_')
+    fw = Firmware(args.firmware, work)
+    fw.send(SETUP % {'port': port})
+    return broker, fw, work
+
+
+def close(broker, fw, work):
+    fw.stop()
+    broker.shutdown()
+    broker.server_close()
+    shutil.rmtree(work)
+
+
+def has(client, what, arg=None, count=1):
+    """A test of the broker events: count of them from client"""
+    return lambda ev: len([e for e in ev if e[0] == client and e[1] == what and
+                           (arg is None or e[2] == arg)]) >= count
+
+
+def check(args):
+    fails = []
+
+    def expect(name, got, value):
+        if got != value:
+            fails.append(name)
+            print('FAIL %s: %r, expected %r' % (name, got, value))
+
+    broker, fw, work = session(args)
+    try:
+        expect('start', fw.wait('start'), '0')
+        expect('connect', fw.wait('connect'), '0')
+
+        fw.send('@ sub1 mqtt.subscribe(c,"bench/#",0)\n'
+                '@ sub2 mqtt.subscribe(c,"a/+/c",1)\n'
+                '@ bad mqtt.subscribe(c,"a/#/c",0)\n'
+                '@ again mqtt.subscribe(c,"a/+/c",0)\n')
+        expect('subscribe', [fw.wait(n) for n in ('sub1', 'sub2', 'bad', 'again')],
+               ['0', '0', '-3', '-5'])
+        expect('broker subscribed', broker.wait(has('wifimcu', 'subscribe', 'a/+/c'), 5), True)
+
+        # in order, so that a message missing shows before the last one arrives
+        for topic, payload, qos in (('bench/x', 'one', 0), ('a/b/c', 'two', 1),
+                                    ('a/b/d', 'no', 0), ('bench', 'three', 0),
+                                    ('bench/x/y', 'four', 2), ('a/b/c/d', 'no', 0),
+                                    ('a/b/c', 'five', 0)):
+            broker.publish(topic, payload.encode(), qos)
+            time.sleep(0.05)
+        fw.wait('msg', 5, timeout=5)
+        expect('messages', fw.all('msg'),
+               ['bench/x 3 one', 'a/b/c 3 two', 'bench 5 three', 'bench/x/y 4 four',
+                'a/b/c 4 five'])
+
+        # publish, one request at a time
+        for i, qos in enumerate((0, 1, 2)):
+            fw.send('@ pub%d mqtt.publish(c,"up/%d",%d,"data %d")\n' % (qos, qos, qos, qos))
+            ok = broker.wait(has('wifimcu', 'publish', ('up/%d' % qos, b'data %d' % qos, qos)), 5)
+            expect('publish qos %d' % qos, (fw.wait('pub%d' % qos), ok), ('0', True))
+        expect('publish too long', (fw.send('@ long mqtt.publish(c,"up/l",0,string.rep("x",600))\n'),
+                                    fw.wait('long'))[1], '0')
+        expect('offline after a failed publish', fw.wait('offline'), '0 1')
+        expect('connect after a failed publish', fw.wait('connect', 2), '0')
+
+        fw.send('@ issub mqtt.issubscribed(c,"bench/#")\n'
+                '@ unsub mqtt.unsubscribe(c,"bench/#")\n')
+        expect('unsubscribe', (fw.wait('issub'), fw.wait('unsub')), ('1', '0'))
+        expect('broker unsubscribed', broker.wait(has('wifimcu', 'unsubscribe', 'bench/#'), 5), True)
+        broker.publish('bench/x', b'gone')
+        time.sleep(0.05)
+        broker.publish('a/z/c', b'six')
+        fw.wait('msg', 6, timeout=5)
+        expect('after unsubscribe', fw.all('msg')[5:], ['a/z/c 3 six'])
+
+        # the broker goes away: offline, reconnect, subscriptions again
+        subs = len([e for e in broker.events if e[1] == 'subscribe'])
+        broker.drop('wifimcu')
+        expect('offline', fw.wait('offline', 2), '0 1')
+        expect('reconnect', fw.wait('connect', 3), '0')
+        expect('resubscribed', broker.wait(lambda ev: len([e for e in ev if e[1] == 'subscribe']) > subs, 5), True)
+        broker.publish('a/q/c', b'seven')
+        fw.wait('msg', 7, timeout=5)
+        expect('after reconnect', fw.all('msg')[6:], ['a/q/c 5 seven'])
+
+        fw.send('@ close mqtt.close(c)\n')
+        expect('close', fw.wait('close'), '0')
+        expect('disconnect', broker.wait(has('wifimcu', 'gone', count=3), 5), True)
+    finally:
+        close(broker, fw, work)
+        if fails:
+            sys.stdout.write('\n'.join(fw.output[-20:]) + '\n')
+
+    print('check: %d fail(s)' % len(fails))
+    return not fails
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+
+def bench(args):
+    broker, fw, work = session(args)
+    try:
+        if fw.wait('connect') is None:
+            print('no connection')
+            return
+        fw.send(ECHO)
+        fw.wait('sub2')
+        broker.wait(has('wifimcu', 'subscribe', 'flood/#'), 5)
+        time.sleep(0.5)
+
+        print('%-34s %9s %9s %9s %9s' % ('', 'mean', 'p50', 'p99', 'max'))
+        # round trips: broker, mqtt thread, lua callback, mqtt.publish, broker
+        pong = threading.Event()
+        got = {}
+
+        def listener(topic, payload, when):
+            if topic == 'pong':
+                got[payload] = when
+                pong.set()
+        broker.listen(listener)
+        rtt = []
+        w0, t0 = fw.wakeups(), time.time()
+        for i in range(args.messages):
+            key = b'%d' % i
+            pong.clear()
+            start = time.time()
+            broker.publish('ping', key)
+            while key not in got and pong.wait(2):
+                pong.clear()
+            if key in got:
+                rtt.append((got[key] - start) * 1000.0)
+            time.sleep(args.gap / 1000.0)
+        w1, t1 = fw.wakeups(), time.time()
+        if rtt:
+            print('%-34s %9.2f %9.2f %9.2f %9.2f ms  %d of %d' %
+                  ('round trip, one every %d ms' % args.gap, sum(rtt) / len(rtt),
+                   percentile(rtt, 50), percentile(rtt, 99), max(rtt), len(rtt), args.messages))
+        wake_rtt = (w1 - w0) / (t1 - t0)
+
+        # wakeups of the mqtt thread
+        w0, t0 = fw.wakeups(), time.time()
+        time.sleep(args.seconds)
+        w1, t1 = fw.wakeups(), time.time()
+        wake_idle = (w1 - w0) / (t1 - t0)
+
+        fw.send('@ count0 n\n')
+        before = int(fw.wait('count0') or 0)
+        w0, t0 = fw.wakeups(), time.time()
+        sent = 0
+        while time.time() < t0 + args.seconds:
+            broker.publish('flood/x', b'%08d' % sent)
+            sent += 1
+            time.sleep(max(0.0, t0 + sent / float(args.rate) - time.time()))
+        w1, t1 = fw.wakeups(), time.time()
+        time.sleep(0.5)
+        fw.send('@ count1 n\n')
+        received = int(fw.wait('count1') or 0) - before
+        wake_flood = (w1 - w0) / (t1 - t0)
+
+        print('mqtt thread wakeups per second')
+        print('  connected, idle                %8.1f' % wake_idle)
+        print('  round trips                    %8.1f' % wake_rtt)
+        print('  %4d messages/s in               %8.1f  (%d of %d to lua)' %
+              (args.rate, wake_flood, received, sent))
+    finally:
+        close(broker, fw, work)
+
+
+def main():
+    ap = argparse.ArgumentParser(description='mqtt module check and benchmark')
+    ap.add_argument('-f', dest='firmware',
+                    default=os.path.join(HERE, '..', 'host', 'wifimcu.host'))
+    ap.add_argument('-k', dest='check_only', action='store_true',
+                    help='self check only')
+    ap.add_argument('-n', dest='messages', type=int, default=200,
+                    help='round trips timed')
+    ap.add_argument('-g', dest='gap', type=int, default=10,
+                    help='ms between round trips')
+    ap.add_argument('-r', dest='rate', type=int, default=100,
+                    help='messages per second of the stream')
+    ap.add_argument('-w', dest='seconds', type=float, default=3.0,
+                    help='seconds the wakeups are counted')
+    args = ap.parse_args()
+    args.firmware = os.path.abspath(args.firmware)
+
+    ok = check(args)
+    if not args.check_only:
+        bench(args)
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
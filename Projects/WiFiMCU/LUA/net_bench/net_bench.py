@@ -0,0 +1,367 @@
+#!/usr/bin/env python
+#
+# net_bench.py
+#
+# Runs the net module of the host firmware (../host/wifimcu.host) against
+# local sockets: a self check of net.send() and the speed of pushing data
+# from several client sockets and from a server socket, as the Lua script
+# sees it (from the first send to the last "sent" callback) and as the
+# receiving side sees it.
+#
+# usage: net_bench.py [-f firmware] [-k] [-c sockets] [-s size] [-p piece]
+#
+# The MIT License
+# Copyright (c) 2014 MXCHIP Inc.
+#
+
+import argparse
+import os
+import re
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# Each socket sends pieces of P bytes: its number and the piece number in
+# ten digits, then FILL. With net.queued (the send queue) the script sends
+# until net.send() returns 1 and goes on from the "drain" callback. Without
+# it (the old net.c) there is one send buffer for all the sockets: one piece
+# of at most 975 bytes at a time, the next one from the "sent" callback.
+COMMON = '''
+P=%(piece)d cnt=%(count)d nc=%(sockets)d done=0 t0=0
+if not net.queued and P>975 then P=975 end
+FILL=string.sub(string.rep("abcdefghijklmnopqrstuvwxyz012345",P/32+1),1,P-10)
+k={} id={} ready={} busy=false
+function piece(s) k[s]=k[s]+1 return string.format("%%02d%%08d",id[s],k[s])..FILL end
+function fin(s) done=done+1 net.close(s) if done==nc then print("@ %(name)s "..(tmr.tick()-t0).." "..P) end end
+function kick() if busy or #ready==0 then return end local r=table.remove(ready,1) if net.send(r,piece(r))==0 then busy=true else k[r]=k[r]-1 table.insert(ready,r) end end
+function push(s) while k[s]<cnt do if net.send(s,piece(s))~=0 then return end end end
+function go(s,i) id[s]=i k[s]=0 if t0==0 then t0=tmr.tick() end if net.queued then push(s) else table.insert(ready,s) kick() end end
+function sent(s) if net.queued then if k[s]>=cnt and net.queued(s)==0 then fin(s) end return end busy=false if k[s]<cnt then table.insert(ready,s) else fin(s) end kick() end
+'''
+
+CLIENTS = '''
+nk=0
+function mk() nk=nk+1 local s=net.new(net.TCP,net.CLIENT) local i=nk net.on(s,"connect",function(s) go(s,i) end) net.on(s,"sent",sent) if net.queued then net.on(s,"drain",push) end net.start(s,%(port)d,"127.0.0.1") end
+for i=1,nc do mk() end
+'''
+
+SERVER = '''
+nk=0
+sv=net.new(net.TCP,net.SERVER)
+net.on(sv,"accept",function(s) nk=nk+1 go(s,nk) end)
+net.on(sv,"sent",function(s) sent(s) end)
+if net.queued then net.on(sv,"drain",push) end
+@ listen net.start(sv,%(fwport)d)
+'''
+
+# Lines run one after the other, "@ name call" prints the values of the call
+CHECK = '''
+u=net.new(net.UDP,net.CLIENT)
+@ udpbig net.send(u,string.rep("u",976))
+net.start(u,%(udpport)d,"127.0.0.1")
+@ udp net.send(u,"hello udp")
+q=net.new(net.TCP,net.CLIENT)
+@ high net.queued(q,512)
+@ first net.send(q,string.rep("a",1100))
+@ full net.send(q,"b")
+@ queued net.queued(q)
+drained=0 qsent=""
+net.on(q,"drain",function(s) drained=drained+1 end)
+net.on(q,"sent",function(s,n) qsent=qsent..n.." " net.close(q) end)
+net.start(q,%(port)d,"127.0.0.1")
+e=net.new(net.TCP,net.CLIENT)
+net.start(e,%(echoport)d,"127.0.0.1")
+@ wait net.send(e,string.rep("L",3000).."-end",{wait=3})
+'''
+
+CHECK_END = '''
+@ qcb drained, qsent
+'''
+
+
+class Sink(object):
+    """A TCP server keeping what each connection sends, in accept order"""
+
+    def __init__(self):
+        self.sock = socket.socket()
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.sock.bind(('127.0.0.1', 0))
+        self.sock.listen(8)
+        self.port = self.sock.getsockname()[1]
+        self.conns = []
+        self.lock = threading.Lock()
+        threading.Thread(target=self.serve, daemon=True).start()
+
+    def serve(self):
+        while True:
+            try:
+                c, _ = self.sock.accept()
+            except OSError:
+                return
+            self.receive(c)
+
+    def receive(self, c):
+        rec = {'data': bytearray(), 'first': None, 'last': None, 'closed': False}
+        with self.lock:
+            self.conns.append(rec)
+
+        def run():
+            while True:
+                d = c.recv(65536)
+                if not d:
+                    break
+                now = time.time()
+                if rec['first'] is None:
+                    rec['first'] = now
+                rec['last'] = now
+                rec['data'] += d
+            rec['closed'] = True
+            c.close()
+        threading.Thread(target=run, daemon=True).start()
+
+    def close(self):
+        self.sock.close()
+
+
+class Echo(Sink):
+    """Answers what it receives with "echo:" and the data, once the data
+    stops coming for 100 ms"""
+
+    def receive(self, c):
+        def run():
+            c.settimeout(0.1)
+            req = b''
+            while True:
+                try:
+                    d = c.recv(65536)
+                except socket.timeout:
+                    if req:
+                        c.sendall(b'echo:' + req)
+                        req = b''
+                    continue
+                if not d:
+                    break
+                req += d
+            c.close()
+        threading.Thread(target=run, daemon=True).start()
+
+
+class Firmware(object):
+    """The host firmware running a script on its console"""
+
+    def __init__(self, exe, cwd):
+        self.proc = subprocess.Popen([exe], cwd=cwd, stdin=subprocess.PIPE,
+                                     stdout=subprocess.PIPE,
+                                     stderr=subprocess.STDOUT)
+        self.results = {}
+        self.output = []
+        self.event = threading.Event()
+        self.want = None
+        threading.Thread(target=self.read, daemon=True).start()
+
+    def read(self):
+        for line in self.proc.stdout:
+            line = line.decode('latin-1').rstrip('\r\n')
+            self.output.append(line)
+            # output of a callback follows the prompt it interrupted
+            line = re.sub(r'^(/\S*> )+', '', line)
+            if line.startswith('@ '):
+                name, _, value = line[2:].partition(' ')
+                self.results[name] = value
+                if name == self.want:
+                    self.event.set()
+
+    def send(self, script):
+        lines = []
+        for line in script.strip().splitlines():
+            if line.startswith('@ '):
+                name, _, call = line[2:].partition(' ')
+                line = ('local r = {%s} for i = 1, #r do r[i] = tostring(r[i]) end '
+                        'print("@ %s "..table.concat(r, " "))' % (call, name))
+            lines.append(line)
+        self.proc.stdin.write(('\n'.join(lines) + '\n').encode('latin-1'))
+        self.proc.stdin.flush()
+
+    def wait(self, name, timeout):
+        """Wait for the result name, printed by the script or a callback"""
+        self.want = name
+        if name not in self.results:
+            self.event.wait(timeout)
+        self.event.clear()
+        return name in self.results
+
+    def stop(self):
+        self.proc.kill()
+        self.proc.wait()
+
+
+def pieces(data, sockno, size, count):
+    """How data differs from count pieces of size from socket sockno"""
+    fill = (b'abcdefghijklmnopqrstuvwxyz012345' * (size // 32 + 1))[:size - 10]
+    if len(data) != size * count:
+        return '%d bytes, expected %d' % (len(data), size * count)
+    for i in range(count):
+        p = data[i * size:(i + 1) * size]
+        if p != b'%02d%08d' % (sockno, i + 1) + fill:
+            return 'piece %d differs: %r' % (i + 1, p[:10])
+    return None
+
+
+def push(args, name, server, sockets, count, piece, timeout):
+    """Run the push from sockets, the Lua ms, the piece size and the sink"""
+    sink = Sink()
+    work = tempfile.mkdtemp(prefix='net_bench_')
+    fw = Firmware(args.firmware, work)
+    try:
+        values = {'name': name, 'piece': piece, 'count': count,
+                  'sockets': sockets, 'port': sink.port, 'fwport': args.fwport}
+        fw.send((COMMON + (SERVER if server else CLIENTS)) % values)
+        if server:
+            fw.wait('listen', 5)
+            time.sleep(0.2)
+            for _ in range(sockets):
+                c = socket.create_connection(('127.0.0.1', args.fwport))
+                sink.receive(c)
+        ok = fw.wait(name, timeout)
+        end = time.time() + 5
+        while time.time() < end and not all(c['closed'] for c in sink.conns):
+            time.sleep(0.05)
+    finally:
+        fw.stop()
+        sink.close()
+        shutil.rmtree(work)
+    if not ok:
+        sys.stdout.write('\n'.join(fw.output[-10:]) + '\n')
+        return None, 0, sink
+    ms, piece = [int(v) for v in fw.results[name].split()]
+    return ms, piece, sink
+
+
+def check(args):
+    fails = []
+
+    def expect(name, got, value):
+        if got != value:
+            fails.append(name)
+            print('FAIL %s: %r, expected %r' % (name, got, value))
+
+    # pushes from 3 clients and a server, pieces over the queue's high mark
+    for server in (False, True):
+        name = 'server' if server else 'clients'
+        ms, piece, sink = push(args, name, server, 3, 40, 5000, args.timeout)
+        if ms is None:
+            expect(name, 'timeout', 'done')
+            continue
+        conns = sorted(sink.conns, key=lambda c: bytes(c['data'][:2]))
+        expect(name + ' sockets', len(conns), 3)
+        for i, c in enumerate(conns):
+            expect('%s %d' % (name, i + 1), pieces(bytes(c['data']), i + 1, piece, 40), None)
+
+    # udp, wait mode, the queue limits
+    sink = Sink()
+    echo = Echo()
+    udp = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    udp.bind(('127.0.0.1', 0))
+    udp.settimeout(3)
+    work = tempfile.mkdtemp(prefix='net_bench_')
+    fw = Firmware(args.firmware, work)
+    try:
+        fw.send(CHECK % {'udpport': udp.getsockname()[1], 'echoport': echo.port,
+                         'port': sink.port})
+        fw.wait('wait', args.timeout)
+        try:
+            datagram = udp.recv(2048)
+        except socket.timeout:
+            datagram = b''
+        time.sleep(0.5)
+        fw.send(CHECK_END)
+        fw.wait('qcb', 5)
+    finally:
+        fw.stop()
+        sink.close()
+        echo.close()
+        udp.close()
+        shutil.rmtree(work)
+    res = fw.results
+    expect('udp >975', res.get('udpbig'), '-5')
+    expect('udp', res.get('udp'), '0')
+    expect('udp datagram', datagram, b'hello udp')
+    got = res.get('wait') or ''
+    want = '0 echo:' + 'L' * 3000 + '-end'
+    expect('wait', got[:12] + '..%d' % len(got), want[:12] + '..%d' % len(want))
+    expect('high', res.get('high'), '0 512')
+    expect('over high', res.get('first'), '1')
+    expect('full', res.get('full'), '-4')
+    expect('queued', res.get('queued'), '1100 512')
+    expect('drain/sent', res.get('qcb'), '1 1100 ')
+    got = bytes(sink.conns[0]['data']) if sink.conns else b''
+    expect('queued data', got, b'a' * 1100)
+
+    print('check: %d fail(s)' % len(fails))
+    return not fails
+
+
+def bench(args):
+    count = args.size // args.piece
+    for server, name in ((False, 'clients'), (True, 'server')):
+        best = None
+        for _ in range(args.runs):
+            ms, piece, sink = push(args, name, server, args.sockets,
+                                   count, args.piece, args.timeout)
+            if ms is None:
+                continue
+            count = args.size // piece
+            total = sum(len(c['data']) for c in sink.conns)
+            if total != args.sockets * count * piece:
+                print('%s: %d of %d bytes' % (name, total, args.sockets * count * piece))
+                continue
+            first = min(c['first'] for c in sink.conns)
+            last = max(c['last'] for c in sink.conns)
+            run = (ms, (last - first) * 1000.0, piece, total)
+            if best is None or run[0] < best[0]:
+                best = run
+            count = args.size // args.piece
+        if best is None:
+            print('%-8s failed' % name)
+            continue
+        ms, rms, piece, total = best
+        print('%-8s %d x %d bytes in %5d byte sends  %6d ms  %8.1f KB/s'
+              '  (received in %d ms)' %
+              (name, args.sockets, total // args.sockets, piece, ms,
+               total / 1024.0 * 1000.0 / max(ms, 1), rms))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='net module check and benchmark')
+    ap.add_argument('-f', dest='firmware',
+                    default=os.path.join(HERE, '..', 'host', 'wifimcu.host'))
+    ap.add_argument('-k', dest='check_only', action='store_true',
+                    help='self check only')
+    ap.add_argument('-c', dest='sockets', type=int, default=4,
+                    help='sockets sending at the same time')
+    ap.add_argument('-s', dest='size', type=int, default=256 * 1024,
+                    help='bytes sent by each socket')
+    ap.add_argument('-p', dest='piece', type=int, default=16384,
+                    help='bytes per net.send(), 975 at most on the old net.c')
+    ap.add_argument('-n', dest='runs', type=int, default=3,
+                    help='benchmark runs, the best is shown')
+    ap.add_argument('-P', dest='fwport', type=int, default=9710,
+                    help='port of the firmware server')
+    ap.add_argument('-t', dest='timeout', type=int, default=120)
+    args = ap.parse_args()
+    args.firmware = os.path.abspath(args.firmware)
+
+    ok = check(args)
+    if not args.check_only:
+        bench(args)
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
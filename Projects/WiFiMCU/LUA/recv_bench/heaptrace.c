@@ -0,0 +1,120 @@
+/**
+ * heaptrace.c
+ *
+ * LD_PRELOAD library for the host firmware: writes the malloc, calloc,
+ * realloc and free calls of the process to the file named by HEAPTRACE,
+ * from the first SIGUSR1 to the next SIGUSR2, one line each:
+ *   m <ptr> <size>          malloc, calloc
+ *   r <old> <ptr> <size>    realloc
+ *   f <ptr>                 free
+ * recv_bench.py replays them on a model of the module heap.
+ *
+ * The MIT License
+ * Copyright (c) 2014 MXCHIP Inc.
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+extern void __libc_free(void *p);
+
+static pthread_mutex_t trace_mut = PTHREAD_MUTEX_INITIALIZER;
+static volatile sig_atomic_t tracing = 0;
+static int trace_fd = -1;
+
+//--------------------------------------
+static void _on_signal( int sig )
+{
+  tracing = (sig == SIGUSR1);
+}
+
+//------------------------------------------------------------
+__attribute__((constructor)) static void _trace_init( void )
+{
+  const char *path = getenv("HEAPTRACE");
+
+  if (path == NULL) return;
+  trace_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (trace_fd < 0) return;
+  signal(SIGUSR1, _on_signal);
+  signal(SIGUSR2, _on_signal);
+}
+
+// hex without the stdio buffers, they malloc
+//-------------------------------------------------------
+static char *_hex( char *p, unsigned long v )
+{
+  char t[20];
+  int n = 0;
+
+  do {
+    t[n++] = "0123456789abcdef"[v & 15];
+    v >>= 4;
+  } while (v != 0);
+  while (n > 0) *p++ = t[--n];
+  return p;
+}
+
+//-------------------------------------------------------------------------
+static void _trace( char op, void *old, void *p, size_t size )
+{
+  char line[64], *q = line;
+
+  if ((!tracing) || (trace_fd < 0)) return;
+  *q++ = op;
+  *q++ = ' ';
+  if (op == 'r') {
+    q = _hex(q, (unsigned long)old);
+    *q++ = ' ';
+  }
+  q = _hex(q, (unsigned long)p);
+  if (op != 'f') {
+    *q++ = ' ';
+    q = _hex(q, size);
+  }
+  *q++ = '\n';
+  pthread_mutex_lock(&trace_mut);
+  if (write(trace_fd, line, q - line) < 0) trace_fd = -1;
+  pthread_mutex_unlock(&trace_mut);
+}
+
+//============================
+void *malloc( size_t size )
+{
+  void *p = __libc_malloc(size);
+  if (p != NULL) _trace('m', NULL, p, size);
+  return p;
+}
+
+//=====================================
+void *calloc( size_t n, size_t size )
+{
+  void *p = __libc_calloc(n, size);
+  if (p != NULL) _trace('m', NULL, p, n * size);
+  return p;
+}
+
+//=====================================
+void *realloc( void *old, size_t size )
+{
+  void *p = __libc_realloc(old, size);
+  if ((p != NULL) || (size == 0)) _trace('r', old, p, size);
+  return p;
+}
+
+//=====================
+void free( void *p )
+{
+  if (p == NULL) return;
+  _trace('f', NULL, p, 0);
+  __libc_free(p);
+}
@@ -0,0 +1,513 @@
+#!/usr/bin/env python
+#
+# recv_bench.py
+#
+# Runs the receive path of the net module of the host firmware
+# (../host/wifimcu.host) against local sockets: a self check (binary data,
+# fragments, a slow script, http framing of requests and answers, wait
+# mode), and the heap it leaves behind: the malloc calls of the firmware
+# under fragmented traffic are traced (heaptrace.so) and replayed on a
+# model of the heap of the module, for its lowest largest free block.
+#
+# usage: recv_bench.py [-f firmware] [-o old firmware] [-k] [-H heap]
+#
+# The MIT License
+# Copyright (c) 2014 MXCHIP Inc.
+#
+
+import argparse
+import bisect
+import os
+import random
+import shutil
+import signal
+import socket
+import sys
+import tempfile
+import threading
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, '..', 'net_bench'))
+
+from net_bench import Firmware
+
+# Servers of the check, on fwport and the next ports: an echo, a slow echo
+# (the pool runs out), http framing of the requests (each callback answers
+# "H<request line>|<bytes>" or "D<bytes>") and an udp echo
+CHECK = '''
+function srv(p,t,opt,cb) local s=net.new(t,net.SERVER) net.on(s,"receive",cb) if t==net.TCP then net.on(s,"accept",function(c) net.queued(c,65536) end) end net.start(s,p,opt) return s end
+e1=srv(%(fwport)d,net.TCP,nil,function(s,d) net.send(s,d) end)
+e2=srv(%(fwport)d+1,net.TCP,nil,function(s,d) tmr.delayms(5) net.send(s,d) end)
+e3=srv(%(fwport)d+2,net.TCP,{http=1},function(s,d,h) if h then net.send(s,"H"..string.match(h,"^[^\\r]*").."|"..#d.."\\n") else net.send(s,"D"..#d.."\\n") end end)
+e4=srv(%(fwport)d+3,net.UDP,nil,function(s,d) net.send(s,d) end)
+@ listen 1
+'''
+
+# http answers to client sockets: "@ tag bytes status-line" on the first
+# disconnect. net.close() posts a disconnect of its own, and a closed client
+# keeps its socket number: they are closed, and gone, before the next socket
+CHECK_CLIENTS = '''
+cs={}
+function fetch(path,tag) local c=net.new(net.TCP,net.CLIENT) local n,hd,pr=0,"-",false cs[#cs+1]=c
+net.on(c,"receive",function(s,d,h) n=n+#d if h then hd=string.gsub(string.match(h,"^[^\\r]*")," ","_") end end)
+net.on(c,"connect",function(s) net.send(s,"GET "..path) end)
+net.on(c,"disconnect",function(s) if not pr then pr=true print("@ "..tag.." "..n.." "..hd) end end)
+net.start(c,%(aport)d,"127.0.0.1",{http=1}) end
+fetch("/len","len") fetch("/close","close") fetch("/raw","raw")
+'''
+
+CHECK_WAIT = '''
+for i=1,#cs do net.close(cs[i]) end tmr.delayms(100)
+w=net.new(net.TCP,net.CLIENT)
+net.start(w,%(aport)d,"127.0.0.1",{wait=3})
+r,d=net.send(w,"GET /len",{http=1,wait=5}) print("@ wait "..r.." "..(d and #d or -1))
+'''
+
+# The traffic of the benchmark: 4 peers send to a server socket, 2 client
+# sockets fetch answers of 2..8 KB, all in fragments
+BENCH = '''
+tot=0 cnt=0 ctot=0
+sv=net.new(net.TCP,net.SERVER)
+net.on(sv,"receive",function(s,d) tot=tot+#d if tot>=%(total)d then print("@ sdone "..tot) end end)
+net.start(sv,%(fwport)d)
+function fetch() local c=net.new(net.TCP,net.CLIENT)
+net.on(c,"receive",function(s,d) ctot=ctot+#d end)
+net.on(c,"connect",function(s) net.send(s,"GET /") end)
+net.on(c,"disconnect",function(s) cnt=cnt+1 if cnt<%(answers)d then net.start(s,%(aport)d,"127.0.0.1") elseif cnt==%(answers)d then print("@ cdone "..ctot) end end)
+net.start(c,%(aport)d,"127.0.0.1") end
+@ listen 1
+'''
+
+FRAG_FILL = bytes(range(256)) * 8
+# printable for the benchmark: the old receive path cut strings at a zero
+TEXT_FILL = bytes(b % 95 + 32 for b in range(256)) * 8
+
+
+class Answers(object):
+    """A TCP server answering "GET <path>" requests from the firmware,
+    the answers in fragments"""
+
+    def __init__(self, bench=None):
+        self.sock = socket.socket()
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.sock.bind(('127.0.0.1', 0))
+        self.sock.listen(8)
+        self.port = self.sock.getsockname()[1]
+        self.bench = bench
+        self.sent = 0
+        self.closed = {}
+        threading.Thread(target=self.serve, daemon=True).start()
+
+    def serve(self):
+        while True:
+            try:
+                c, _ = self.sock.accept()
+            except OSError:
+                return
+            threading.Thread(target=self.answer, args=(c,), daemon=True).start()
+
+    def answer(self, c):
+        req = b''
+        c.settimeout(2)
+        try:
+            # the benchmark requests are "GET /" without a header
+            while b'\r\n\r\n' not in req:
+                d = c.recv(4096)
+                if not d:
+                    break
+                req += d
+                if self.bench is not None:
+                    break
+            path = req.split(b' ')[1] if b' ' in req else b''
+            if self.bench is not None:
+                rnd = self.bench
+                size = rnd.randint(2048, 8192)
+                self.sent += size
+                frag(c, (TEXT_FILL * 5)[:size], rnd, 1, 1460, 0.004)
+            elif path == b'/len':
+                # the header in 3 pieces, the body in 5, slower than the quiet time
+                body = (FRAG_FILL * 3)[:5000]
+                hdr = b'HTTP/1.1 200 OK\r\nContent-Length: 5000\r\nX-A: b\r\n\r\n'
+                for p in (hdr[:10], hdr[10:30], hdr[30:]):
+                    c.sendall(p)
+                    time.sleep(0.03)
+                for i in range(0, 5000, 1000):
+                    c.sendall(body[i:i + 1000])
+                    time.sleep(0.03)
+            elif path == b'/close':
+                c.sendall(b'HTTP/1.0 200 OK\r\nServer: t\r\n\r\n' + b'c' * 2500)
+            elif path == b'/raw':
+                c.sendall(b'hello')
+            # the firmware closes
+            t0 = time.time()
+            c.settimeout(3)
+            while c.recv(4096):
+                pass
+            self.closed[path] = time.time() - t0
+        except OSError:
+            pass
+        c.close()
+
+    def close(self):
+        self.sock.close()
+
+
+def frag(c, data, rnd, lo, hi, gap):
+    """Send data in pieces of lo..hi bytes, up to gap seconds apart"""
+    i = 0
+    while i < len(data):
+        n = rnd.randint(lo, hi)
+        c.sendall(data[i:i + n])
+        i += n
+        if gap:
+            time.sleep(rnd.uniform(0, gap))
+
+
+def echo(port, data, rnd, lo, hi, gap, timeout):
+    """What a server of the firmware echoes of data sent in fragments"""
+    c = socket.create_connection(('127.0.0.1', port))
+    got = bytearray()
+
+    def read():
+        c.settimeout(timeout)
+        try:
+            while len(got) < len(data):
+                d = c.recv(65536)
+                if not d:
+                    break
+                got.extend(d)
+        except OSError:
+            pass
+    t = threading.Thread(target=read)
+    t.start()
+    frag(c, data, rnd, lo, hi, gap)
+    t.join()
+    c.close()
+    return bytes(got)
+
+
+def lines_until_quiet(c, quiet):
+    got = b''
+    c.settimeout(quiet)
+    try:
+        while True:
+            d = c.recv(4096)
+            if not d:
+                break
+            got += d
+    except socket.timeout:
+        pass
+    return got
+
+
+def check(args):
+    fails = []
+
+    def expect(name, got, value):
+        if got != value:
+            fails.append(name)
+            print('FAIL %s: %r, expected %r' % (name, got, value))
+
+    rnd = random.Random(1)
+    work = tempfile.mkdtemp(prefix='recv_bench_')
+    ans = Answers()
+    fw = Firmware(args.firmware, work)
+    try:
+        fw.send(CHECK % {'fwport': args.fwport})
+        fw.wait('listen', 10)
+        time.sleep(0.3)
+
+        # binary data from 3 peers at once, in fragments
+        datas = [bytes(rnd.getrandbits(8) for _ in range(32768)) for _ in range(3)]
+        res = [None] * 3
+
+        def run(i):
+            res[i] = echo(args.fwport, datas[i], random.Random(i), 1, 1500, 0.002, args.timeout)
+        ts = [threading.Thread(target=run, args=(i,)) for i in range(3)]
+        for t in ts:
+            t.start()
+        for t in ts:
+            t.join()
+        for i in range(3):
+            expect('echo %d' % (i + 1), res[i] == datas[i], True)
+
+        # a slow script: the receive pool runs out, nothing is lost
+        data = bytes(rnd.getrandbits(8) for _ in range(16384))
+        expect('slow echo', echo(args.fwport + 1, data, rnd, 16384, 16384, 0, args.timeout) == data, True)
+
+        # http framing of requests: a header in 3 byte pieces, two requests
+        # in one send, a body in pieces
+        c = socket.create_connection(('127.0.0.1', args.fwport + 2))
+        req = b'GET /a HTTP/1.1\r\nHost: x\r\n\r\n'
+        for i in range(0, len(req), 3):
+            c.sendall(req[i:i + 3])
+            time.sleep(0.015)
+        c.sendall(b'POST /b HTTP/1.1\r\nContent-Length: 10\r\n\r\n0123456789'
+                  b'GET /c HTTP/1.1\r\n\r\n')
+        time.sleep(0.05)
+        body = (FRAG_FILL * 2)[:3000]
+        c.sendall(b'POST /d HTTP/1.1\r\ncontent-length: 3000\r\n\r\n' + body[:100])
+        time.sleep(0.05)
+        frag(c, body[100:], rnd, 300, 700, 0.02)
+        c.sendall(b'GET /e HTTP/1.1\r\n\r\n')
+        reqs = []
+        for line in lines_until_quiet(c, 1.0).decode('latin-1').splitlines():
+            if line.startswith('H'):
+                name, _, n = line[1:].rpartition('|')
+                reqs.append([name, int(n)])
+            elif line.startswith('D') and reqs:
+                reqs[-1][1] += int(line[1:])
+        c.close()
+        expect('http requests', reqs, [['GET /a HTTP/1.1', 0], ['POST /b HTTP/1.1', 10],
+                                       ['GET /c HTTP/1.1', 0], ['POST /d HTTP/1.1', 3000],
+                                       ['GET /e HTTP/1.1', 0]])
+
+        # udp datagrams with zero bytes
+        u = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        u.settimeout(2)
+        dgram = bytes(range(256)) * 3
+        u.sendto(dgram, ('127.0.0.1', args.fwport + 3))
+        try:
+            got = u.recvfrom(2048)[0]
+        except socket.timeout:
+            got = None
+        u.close()
+        expect('udp echo', got == dgram, True)
+
+        # http answers to clients, and an answer in wait mode
+        fw.send(CHECK_CLIENTS % {'aport': ans.port})
+        for tag in ('len', 'close', 'raw'):
+            fw.wait(tag, args.timeout)
+        fw.send(CHECK_WAIT % {'aport': ans.port})
+        fw.wait('wait', args.timeout)
+        time.sleep(0.3)
+    finally:
+        fw.stop()
+        ans.close()
+        shutil.rmtree(work)
+    res = fw.results
+    expect('answer with a length', res.get('len'), '5000 HTTP/1.1_200_OK')
+    expect('closed after the length', ans.closed.get(b'/len', 9) < 0.5, True)
+    expect('answer up to the quiet', res.get('close'), '2500 HTTP/1.0_200_OK')
+    expect('unframed answer', res.get('raw'), '5 -')
+    expect('wait mode answer', res.get('wait'), '0 5000')
+
+    print('check: %d fail(s)' % len(fails))
+    return not fails
+
+
+class Heap(object):
+    """The module heap for a replay: first fit, 8 byte aligned blocks with
+    an 8 byte header, 16 bytes at least, freed blocks merged with their
+    neighbours, realloc grows into the next free block"""
+
+    def __init__(self, size):
+        self.free = [(0, size)]
+        self.live = {}
+        self.used = 0
+        self.peak = 0
+        self.low = size
+        self.fails = 0
+        self.calls = 0
+
+    def _take(self, n):
+        need = max(16, (n + 15) & ~7)
+        for i, (a, s) in enumerate(self.free):
+            if s >= need:
+                if s - need >= 16:
+                    self.free[i] = (a + need, s - need)
+                else:
+                    need = s
+                    del self.free[i]
+                return (a, need)
+        return None
+
+    def _give(self, a, s):
+        i = bisect.bisect(self.free, (a, 0))
+        if i < len(self.free) and a + s == self.free[i][0]:
+            s += self.free[i][1]
+            del self.free[i]
+        if i > 0 and self.free[i - 1][0] + self.free[i - 1][1] == a:
+            a, s = self.free[i - 1][0], s + self.free[i - 1][1]
+            del self.free[i - 1]
+            i -= 1
+        self.free.insert(i, (a, s))
+
+    def _used(self, b, n):
+        self.used += n
+        self.peak = max(self.peak, self.used)
+        largest = max(s for _, s in self.free) if self.free else 0
+        self.low = min(self.low, largest)
+
+    def malloc(self, p, n):
+        self.calls += 1
+        self.release(p)
+        b = self._take(n)
+        if b is None:
+            self.fails += 1
+            return
+        self.live[p] = b
+        self._used(b, b[1])
+
+    def release(self, p):
+        b = self.live.pop(p, None)
+        if b is not None:
+            self.used -= b[1]
+            self._give(*b)
+
+    def realloc(self, old, p, n):
+        if old == 0 or old not in self.live:
+            return self.malloc(p, n)
+        if n == 0:
+            return self.release(old)
+        self.calls += 1
+        a, s = self.live.pop(old)
+        need = max(16, (n + 15) & ~7)
+        if need <= s:
+            self.live[p] = (a, s)
+            return
+        i = bisect.bisect(self.free, (a + s, -1))
+        if i < len(self.free) and self.free[i][0] == a + s and s + self.free[i][1] >= need:
+            na, ns = self.free[i]
+            rest = s + ns - need
+            if rest >= 16:
+                self.free[i] = (a + need, rest)
+            else:
+                need = s + ns
+                del self.free[i]
+            self.live[p] = (a, need)
+            self._used(None, need - s)
+            return
+        b = self._take(n)
+        if b is None:
+            self.fails += 1
+            self.live[old] = (a, s)
+            return
+        self.live[p] = b
+        self.used -= s
+        self._give(a, s)
+        self._used(b, b[1])
+
+
+def replay(path, size):
+    heap = Heap(size)
+    with open(path) as f:
+        for line in f:
+            v = line.split()
+            if v[0] == 'm':
+                heap.malloc(int(v[1], 16), int(v[2], 16))
+            elif v[0] == 'r':
+                heap.realloc(int(v[1], 16), int(v[2], 16), int(v[3], 16))
+            elif v[0] == 'f':
+                heap.release(int(v[1], 16))
+    return heap
+
+
+def traced(args, firmware, trace):
+    """Run the benchmark traffic with the malloc calls traced, the bytes
+    received or None"""
+    rnd = random.Random(7)
+    work = tempfile.mkdtemp(prefix='recv_bench_')
+    ans = Answers(random.Random(8))
+    total = args.peers * args.size
+    env = dict(os.environ)
+    os.environ['LD_PRELOAD'] = os.path.join(HERE, 'heaptrace.so')
+    os.environ['HEAPTRACE'] = trace
+    try:
+        fw = Firmware(firmware, work)
+    finally:
+        os.environ.clear()
+        os.environ.update(env)
+    try:
+        # traced from before the sockets are made: the receive pool is in it
+        time.sleep(0.3)
+        fw.proc.send_signal(signal.SIGUSR1)
+        time.sleep(0.1)
+        fw.send(BENCH % {'fwport': args.fwport, 'aport': ans.port, 'total': total,
+                         'answers': args.answers})
+        fw.wait('listen', 10)
+        time.sleep(0.3)
+        fw.send('fetch() fetch()')
+        data = [bytes(rnd.getrandbits(8) for _ in range(args.size)) for _ in range(args.peers)]
+        data = [bytes(b % 95 + 32 for b in d) for d in data]
+        conns = []
+
+        def run(i):
+            c = socket.create_connection(('127.0.0.1', args.fwport))
+            conns.append(c)
+            frag(c, data[i], random.Random(i), 1, 1460, 0.003)
+        ts = [threading.Thread(target=run, args=(i,)) for i in range(args.peers)]
+        for t in ts:
+            t.start()
+        for t in ts:
+            t.join()
+        fw.wait('sdone', args.timeout)
+        fw.wait('cdone', args.timeout)
+        fw.proc.send_signal(signal.SIGUSR2)
+        time.sleep(0.2)
+        for c in conns:
+            c.close()
+    finally:
+        fw.stop()
+        ans.close()
+        shutil.rmtree(work)
+    if 'sdone' not in fw.results or 'cdone' not in fw.results:
+        sys.stdout.write('\n'.join(fw.output[-10:]) + '\n')
+        return None
+    return int(fw.results['sdone']) + int(fw.results['cdone'])
+
+
+def bench(args):
+    print('%d peers x %d bytes to a server socket, %d answers of 2..8 KB to 2 clients, '
+          'in fragments; heap model %d bytes' % (args.peers, args.size, args.answers, args.heap))
+    for name, firmware in (('new', args.firmware), ('old', args.old)):
+        if firmware is None:
+            continue
+        fd, trace = tempfile.mkstemp(prefix='recv_bench_', suffix='.trace')
+        os.close(fd)
+        try:
+            got = traced(args, firmware, trace)
+            heap = replay(trace, args.heap) if got else None
+        finally:
+            os.remove(trace)
+        if heap is None:
+            print('%-4s failed' % name)
+            continue
+        print('%-4s %7d bytes received  %6d allocations  peak %6d bytes  '
+              'lowest largest free block %6d bytes  %d failed' %
+              (name, got, heap.calls, heap.peak, heap.low, heap.fails))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='net receive path check and heap benchmark')
+    ap.add_argument('-f', dest='firmware',
+                    default=os.path.join(HERE, '..', 'host', 'wifimcu.host'))
+    ap.add_argument('-o', dest='old', default=None,
+                    help='another firmware to compare with, an older build')
+    ap.add_argument('-k', dest='check_only', action='store_true',
+                    help='self check only')
+    ap.add_argument('-H', dest='heap', type=int, default=32768,
+                    help='free heap of the model at the start, bytes')
+    ap.add_argument('-p', dest='peers', type=int, default=4,
+                    help='peers sending to the server socket')
+    ap.add_argument('-s', dest='size', type=int, default=64 * 1024,
+                    help='bytes each peer sends')
+    ap.add_argument('-a', dest='answers', type=int, default=40,
+                    help='answers fetched by the client sockets')
+    ap.add_argument('-P', dest='fwport', type=int, default=9721,
+                    help='first port of the firmware servers')
+    ap.add_argument('-t', dest='timeout', type=int, default=60)
+    args = ap.parse_args()
+    args.firmware = os.path.abspath(args.firmware)
+    if args.old:
+        args.old = os.path.abspath(args.old)
+
+    ok = check(args)
+    if not args.check_only:
+        bench(args)
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,236 @@
+#!/usr/bin/env python
+#
+# sendfile_bench.py
+#
+# Runs net.sendfile() of the host firmware (../host/wifimcu.host) on files
+# in its spiffs (RAM flash) against local sockets: a self check, and the
+# time and heap it takes to send a file compared with the Lua loop of
+# file.read() and net.send() it replaces.
+#
+# usage: sendfile_bench.py [-f firmware] [-k] [-s size] [-n runs] [-P port]
+#
+# The MIT License
+# Copyright (c) 2014 MXCHIP Inc.
+#
+
+import argparse
+import os
+import shutil
+import socket
+import sys
+import tempfile
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, '..', 'net_bench'))
+
+from net_bench import Firmware, Sink
+
+# The files: lines of 128 bytes, the line number in seven digits, ":",
+# then FILL and "\n". mk(name, bytes) writes one
+FILES = '''
+file.format()
+FILL=string.sub(string.rep("abcdefghijklmnopqrstuvwxyz012345",4),1,119)
+function mk(n,sz) local fd=file.open(n,"w") local t={} for i=1,sz/128 do t[#t+1]=string.format("%%07d:",i)..FILL.."\\n" if #t==8 then file.write(fd,table.concat(t)) t={} end end
+if #t>0 then file.write(fd,table.concat(t)) end file.close(fd) end
+'''
+
+# Heap in use: mcu.mem()'s allocated bytes (the Lua heap is malloc'ed too),
+# sampled by timer 1 every 2 ms and in the callbacks
+HEAP = '''
+peak=0 base=0
+function smp() local _,a=mcu.mem() if a>peak then peak=a end end
+function begin() collectgarbage() local _,a=mcu.mem() base=a peak=a t0=tmr.tick() tmr.start(1,2,smp) end
+function stop(name,n) smp() tmr.stop(1) print("@ "..name.." "..(tmr.tick()-t0).." "..n.." "..(peak-base)) end
+'''
+
+# net.sendfile(): the net thread reads and sends the file
+SENDFILE = '''
+s=net.new(net.TCP,net.CLIENT)
+net.on(s,"connect",function(s) begin() net.sendfile(s,"f.bin",function(s,n) stop("sendfile",n) net.close(s) end) end)
+net.start(s,%(port)d,"127.0.0.1")
+'''
+
+# The Lua loop: 512 bytes per file.read(), sent until the queue is over its
+# mark, more on "drain"
+LOOP = '''
+s=net.new(net.TCP,net.CLIENT) eof=false tot=0
+function push(s) while true do local d=file.read(fd,512) if d==nil then eof=true return end tot=tot+#d smp() if net.send(s,d)~=0 then return end end end
+net.on(s,"drain",push)
+net.on(s,"sent",function(s) smp() if eof and net.queued(s)==0 then file.close(fd) stop("loop",tot) net.close(s) end end)
+net.on(s,"connect",function(s) begin() fd=file.open("f.bin","r") push(s) end)
+net.start(s,%(port)d,"127.0.0.1")
+'''
+
+# Checks: c[1..3] are client sockets, c[4..8] clients of the server socket,
+# all connected to sinks in this order. The done callbacks print
+# "@ name bytes"
+CHECK = '''
+mk("f.bin",%(size)d) mk("g.bin",1024)
+function dn(name) return function(s,n) print("@ "..name.." "..n) end end
+c={} nc=0
+function cl(i) local s=net.new(net.TCP,net.CLIENT) c[i]=s net.on(s,"connect",function(s) nc=nc+1 end) net.start(s,%(port)d,"127.0.0.1") end
+for i=1,3 do cl(i) tmr.delayms(20) end
+u=net.new(net.UDP,net.CLIENT) net.start(u,%(udpport)d,"127.0.0.1")
+sv=net.new(net.TCP,net.SERVER)
+net.on(sv,"accept",function(s) c[#c+1]=s nc=nc+1 end)
+@ listen net.start(sv,%(fwport)d)
+'''
+
+CHECK_SEND = '''
+@ connected nc
+@ missing net.sendfile(c[1],"none.bin")
+@ pastend net.sendfile(c[1],"g.bin",1024)
+@ udpfile net.sendfile(u,"g.bin")
+@ server net.sendfile(sv,"g.bin")
+@ whole net.sendfile(c[1],"f.bin",dn("dwhole"))
+@ part net.sendfile(c[2],"f.bin",1000,5000,dn("dpart"))
+@ tail net.sendfile(c[3],"g.bin",900,500,dn("dtail"))
+net.send(c[4],"A") net.sendfile(c[4],"g.bin",dn("dmix")) net.send(c[4],"B")
+for i=5,7 do net.sendfile(c[i],"f.bin",dn("dmany"..i)) end
+@ nocb net.sendfile(c[3],"g.bin",0,10)
+r=net.sendfile(c[8],"f.bin",dn("ddrop")) net.close(c[8]) print("@ drop "..r)
+'''
+
+
+def lines(data, start, size):
+    """The file bytes start..start+size of a file written by mk()"""
+    fill = (b'abcdefghijklmnopqrstuvwxyz012345' * 4)[:119]
+    first = start // 128
+    last = (start + size + 127) // 128
+    whole = b''.join(b'%07d:' % (i + 1) + fill + b'\n' for i in range(first, last))
+    return whole[start - first * 128:start - first * 128 + size] == data
+
+
+def check(args):
+    fails = []
+
+    def expect(name, got, value):
+        if got != value:
+            fails.append(name)
+            print('FAIL %s: %r, expected %r' % (name, got, value))
+
+    sink = Sink()
+    udp = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    udp.bind(('127.0.0.1', 0))
+    work = tempfile.mkdtemp(prefix='sendfile_bench_')
+    fw = Firmware(args.firmware, work)
+    try:
+        fw.send((FILES + CHECK) % {'size': args.size, 'port': sink.port,
+                                   'udpport': udp.getsockname()[1],
+                                   'fwport': args.fwport})
+        fw.wait('listen', 10)
+        time.sleep(0.2)
+        for _ in range(5):
+            sink.receive(socket.create_connection(('127.0.0.1', args.fwport)))
+            time.sleep(0.05)
+        time.sleep(0.5)
+        fw.send(CHECK_SEND)
+        fw.wait('drop', args.timeout)
+        names = ['dwhole', 'dpart', 'dtail', 'dmix', 'ddrop'] + \
+                ['dmany%d' % i for i in range(5, 8)]
+        end = time.time() + args.timeout
+        while time.time() < end and not all(n in fw.results for n in names):
+            time.sleep(0.05)
+        time.sleep(0.5)
+    finally:
+        fw.stop()
+        sink.close()
+        udp.close()
+        shutil.rmtree(work)
+    res = fw.results
+    size = args.size
+    expect('connected', res.get('connected'), '8')
+    expect('missing file', res.get('missing'), '-5')
+    expect('offset past the end', res.get('pastend'), '-5')
+    expect('udp socket', res.get('udpfile'), '-5')
+    expect('server socket', res.get('server'), '-2')
+    expect('whole', res.get('whole'), '1')
+    expect('part', res.get('part'), '1')
+    expect('tail', res.get('tail'), '0')
+    expect('no callback', res.get('nocb'), '0')
+    expect('done whole', res.get('dwhole'), str(size))
+    expect('done part', res.get('dpart'), '5000')
+    expect('done tail', res.get('dtail'), '124')
+    expect('done between sends', res.get('dmix'), '1024')
+    expect('done dropped', res.get('ddrop'), '-1')
+    for i in range(5, 8):
+        expect('done %d at once' % (i - 4), res.get('dmany%d' % i), str(size))
+
+    data = [bytes(c['data']) for c in sink.conns]
+    data += [b''] * (8 - len(data))
+    expect('whole data', lines(data[0], 0, size), True)
+    expect('part data', lines(data[1], 1000, 5000), True)
+    expect('tail data', lines(data[2][:124], 900, 124) and lines(data[2][124:], 0, 10), True)
+    expect('between sends', data[3][:1] + data[3][-1:], b'AB')
+    expect('between sends data', lines(data[3][1:-1], 0, 1024), True)
+    for i in range(4, 7):
+        expect('at once data %d' % (i - 3), lines(data[i], 0, size), True)
+
+    print('check: %d fail(s)' % len(fails))
+    return not fails
+
+
+def bench(args):
+    best = {}
+    for name, script in (('sendfile', SENDFILE), ('loop', LOOP)):
+        for _ in range(args.runs):
+            sink = Sink()
+            work = tempfile.mkdtemp(prefix='sendfile_bench_')
+            fw = Firmware(args.firmware, work)
+            try:
+                fw.send((FILES + HEAP + 'mk("f.bin",%d)\n' % args.size + script) %
+                        {'port': sink.port})
+                ok = fw.wait(name, args.timeout)
+                end = time.time() + 5
+                while time.time() < end and not all(c['closed'] for c in sink.conns):
+                    time.sleep(0.05)
+            finally:
+                fw.stop()
+                sink.close()
+                shutil.rmtree(work)
+            if not ok:
+                sys.stdout.write('\n'.join(fw.output[-10:]) + '\n')
+                continue
+            ms, n, heap = [int(v) for v in fw.results[name].split()]
+            data = bytes(sink.conns[0]['data']) if sink.conns else b''
+            if n != args.size or not lines(data, 0, args.size):
+                print('%s: %d of %d bytes arrived' % (name, len(data), args.size))
+                continue
+            if name not in best or ms < best[name][0]:
+                best[name] = (ms, best.get(name, (0, heap))[1])
+            best[name] = (best[name][0], max(best[name][1], heap))
+    for name in ('sendfile', 'loop'):
+        if name not in best:
+            print('%-8s failed' % name)
+            continue
+        ms, heap = best[name]
+        print('%-8s %d bytes  %6d ms  %8.1f KB/s  heap peak +%d bytes' %
+              (name, args.size, ms, args.size / 1024.0 * 1000.0 / max(ms, 1), heap))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='net.sendfile check and benchmark')
+    ap.add_argument('-f', dest='firmware',
+                    default=os.path.join(HERE, '..', 'host', 'wifimcu.host'))
+    ap.add_argument('-k', dest='check_only', action='store_true',
+                    help='self check only')
+    ap.add_argument('-s', dest='size', type=int, default=256 * 1024,
+                    help='file size, a multiple of 128')
+    ap.add_argument('-n', dest='runs', type=int, default=3,
+                    help='benchmark runs, the best time and the highest heap are shown')
+    ap.add_argument('-P', dest='fwport', type=int, default=9711,
+                    help='port of the firmware server')
+    ap.add_argument('-t', dest='timeout', type=int, default=60)
+    args = ap.parse_args()
+    args.firmware = os.path.abspath(args.firmware)
+    args.size -= args.size % 128
+
+    ok = check(args)
+    if not args.check_only:
+        bench(args)
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
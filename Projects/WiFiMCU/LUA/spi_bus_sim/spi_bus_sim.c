@@ -0,0 +1,285 @@
+/*
+** spi_bus_sim.c
+** The writes of spi.c against a mock bus that records every transaction:
+** ../lua/exlibs/spi_bus.c as the hardware SPI uses it, checked byte for
+** byte on random writes, then bytes/s and the time per call of the bit
+** banged software SPI, the old polled hardware transfer and spi_bus.c,
+** on a cycle count model of the module. See readme.txt.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spi_bus.h"
+
+#define PROGNAME	"spi_bus_sim"
+#define WIRE_MAX	(1u<<18)	/* bytes a check may put on the wire */
+#define DMA_FAILED	(-6747)		/* kWriteErr, what spi.c returns for TEIF */
+
+/* Model parameters, cycles of the core unless noted */
+static uint32_t mhz=96;			/* core clock */
+static uint32_t spi_mhz=24;		/* SPI clock, 96/4 */
+static uint32_t sw_delay=50;		/* spi_delay(), the default speed */
+static uint32_t gpio=40;		/* MicoGpioOutputHigh/Low/InputGet */
+static uint32_t call=300;		/* per transfer: mutex, powersave, chip select */
+static uint32_t poll_gap=30;		/* polled TXE, send, RXNE, read */
+static uint32_t dma_setup=350;		/* DMA_DeInit, DMA_Init, enable, drain */
+static uint32_t dma_min=SPI_BUS_DMA_MIN;
+
+/* The mock: what each operation did, and the bytes on the wire */
+typedef struct
+{
+ uint64_t polls, polled, dmas, dma_bytes, reads;
+ uint64_t cycles;			/* by the model */
+ uint64_t cpu;				/* of those the CPU is not free */
+ uint8_t* wire;				/* NULL: only count */
+ uint32_t length;
+ int errors;
+ uint64_t fail_dma;			/* this DMA fails, counted from 1; 0: none */
+ int after;				/* operations after the failed one */
+} Mock;
+
+static double wire_cycles(uint64_t bytes)
+{
+ return bytes*8.0*mhz/spi_mhz;
+}
+
+static void put(Mock* m, const uint8_t* p, uint32_t n, int fixed)
+{
+ uint32_t i;
+ if (m->wire==NULL) return;
+ if (m->length+n>WIRE_MAX) { m->errors++; return; }
+ for (i=0; i<n; i++) m->wire[m->length++]=fixed ? p[0] : p[i];
+}
+
+static void mock_poll(void* ctx, const uint8_t* tx, uint8_t* rx, uint32_t count)
+{
+ Mock* m=ctx;
+ uint64_t c;
+ if (m->fail_dma!=0 && m->dmas>=m->fail_dma) m->after++;
+ m->polls++;
+ m->polled+=count;
+ put(m,tx,count,0);
+ if (rx!=NULL)
+ {
+  uint32_t i;
+  /* the slave answers each byte with its complement */
+  for (i=0; i<count; i++) rx[i]=(uint8_t)~tx[i];
+  m->reads+=count;
+  c=(uint64_t)(count*(wire_cycles(1)+poll_gap));
+ }
+ else					/* back to back, then the drain */
+  c=(uint64_t)(wire_cycles(count)+poll_gap);
+ m->cycles+=c;
+ m->cpu+=c;
+}
+
+static int mock_dma(void* ctx, const uint8_t* tx, uint32_t count, bool fixed)
+{
+ Mock* m=ctx;
+ double wait=wire_cycles(count), awake=2000.0*mhz;	/* the last 2 ms spin */
+ if (m->fail_dma!=0 && m->dmas>=m->fail_dma) m->after++;
+ m->dmas++;
+ if (m->dmas==m->fail_dma) return DMA_FAILED;
+ m->dma_bytes+=count;
+ if (count==0 || count>SPI_BUS_DMA_MAX || count<dma_min) m->errors++;
+ put(m,tx,count,fixed);
+ m->cycles+=(uint64_t)(wait+dma_setup);
+ m->cpu+=(uint64_t)((wait<awake ? wait : awake)+dma_setup);
+ return 0;
+}
+
+static const spi_bus_ops_t mock_ops={ mock_poll, mock_dma };
+
+static int failures=0;
+
+#define check(cond) do { if (!(cond)) { \
+    printf("FAIL %s:%d: %s\n",__FILE__,__LINE__,#cond); failures++; } } while (0)
+
+static uint32_t next_random(uint32_t* state)
+{
+ uint32_t x=*state;
+ x^=x<<13;
+ x^=x>>17;
+ x^=x<<5;
+ return *state=x;
+}
+
+/* Random writes: the wire holds data rep times, the read back byte is the
+   answer to the last one, no DMA is shorter than the threshold */
+static void check_writes(void)
+{
+ static uint8_t wire[WIRE_MAX], fill[256], data[600];
+ uint32_t seed=7, i, k, count, rep, dmin;
+ for (i=0; i<20000 && failures<10; i++)
+ {
+  Mock m;
+  spi_bus_t bus;
+  uint8_t last=0, *plast;
+  memset(&m,0,sizeof(m));
+  m.wire=wire;
+  count=1+next_random(&seed)%((i&1) ? 8 : 600);
+  rep=1+next_random(&seed)%((i%16==0) ? WIRE_MAX/count : (i&2) ? 4 : 200);
+  if (count*rep>WIRE_MAX) rep=WIRE_MAX/count;
+  dmin=(i%5==0) ? 0 : 1+next_random(&seed)%200;
+  plast=(i%3==0) ? &last : NULL;
+  for (k=0; k<count; k++) data[k]=(uint8_t)next_random(&seed);
+
+  dma_min=dmin ? dmin : 1;		/* mock_dma() checks against it */
+  bus.ops=&mock_ops;
+  bus.ctx=&m;
+  bus.dma_min=dmin;
+  bus.fill=fill;
+  bus.fill_size=(i%7==0) ? 0 : 1+next_random(&seed)%sizeof(fill);
+  check(spi_bus_write(&bus,data,count,rep,plast)==0);
+
+  check(m.errors==0);
+  check(m.length==count*rep);
+  for (k=0; k<m.length && k<WIRE_MAX; k++)
+   if (wire[k]!=data[k%count]) { check(wire[k]==data[k%count]); break; }
+  if (plast!=NULL) check(last==(uint8_t)~data[count-1] && m.reads==1);
+  else check(m.reads==0);
+  if (dmin==0) check(m.dmas==0);
+ }
+ dma_min=SPI_BUS_DMA_MIN;
+}
+
+/* A DMA that fails (transfer error, timeout) ends the write: its error is
+   returned, nothing goes out after it and what went before is intact */
+static void check_dma_errors(void)
+{
+ static uint8_t wire[WIRE_MAX], fill[128], data[600];
+ uint32_t seed=11, i, k, count, rep;
+ for (i=0; i<2000 && failures<10; i++)
+ {
+  Mock m;
+  spi_bus_t bus={ &mock_ops, NULL, SPI_BUS_DMA_MIN, fill, sizeof(fill) };
+  uint8_t last=0, *plast=(i%3==0) ? &last : NULL;
+  uint64_t dmas;
+  int err;
+  count=(i&1) ? 1 : 1+next_random(&seed)%600;
+  rep=1+next_random(&seed)%((i&2) ? 4 : 2000);
+  if (count*rep>WIRE_MAX) rep=WIRE_MAX/count;
+  for (k=0; k<count; k++) data[k]=(uint8_t)next_random(&seed);
+
+  /* the DMAs of the write as it goes through */
+  memset(&m,0,sizeof(m));
+  bus.ctx=&m;
+  spi_bus_write(&bus,data,count,rep,plast);
+  dmas=m.dmas;
+  if (dmas==0) continue;
+
+  memset(&m,0,sizeof(m));
+  m.wire=wire;
+  m.fail_dma=1+next_random(&seed)%dmas;
+  err=spi_bus_write(&bus,data,count,rep,plast);
+  check(err==DMA_FAILED);
+  check(m.dmas==m.fail_dma && m.after==0 && m.reads==0);
+  for (k=0; k<m.length; k++)
+   if (wire[k]!=data[k%count]) { check(wire[k]==data[k%count]); break; }
+ }
+}
+
+/* The bit banged sw_spi_write(): per bit the clock twice, the data once and
+   two delays, per call the chip select and the clock idle state */
+static double bitbang(uint64_t bytes, int calls)
+{
+ double bit=3*gpio+2*(sw_delay+15)+10;
+ return calls*(4*gpio+sw_delay)+bytes*(8*bit+20);
+}
+
+/* The old _platform_spi_transfer(): a byte at a time, waits for RXNE */
+static double polled(uint64_t bytes, int calls)
+{
+ return calls*call+bytes*(wire_cycles(1)+poll_gap);
+}
+
+/* spi_bus_write() against the mock */
+static double planned(const uint8_t* data, uint32_t count, uint32_t rep, Mock* m)
+{
+ static uint8_t fill[128];		/* spi_fill in spi.c */
+ spi_bus_t bus={ &mock_ops, NULL, SPI_BUS_DMA_MIN, fill, sizeof(fill) };
+ memset(m,0,sizeof(*m));
+ bus.ctx=m;
+ spi_bus_write(&bus,data,count,rep,NULL);
+ return call+m->cycles;
+}
+
+static void bench(void)
+{
+ static const uint32_t sizes[]={ 1, 8, 32, 128, 1024, 4096 };
+ static const struct { const char* name; uint32_t count, rep; } fills[]=
+ {
+  { "oled clear, 1 x 1024", 1, 1024 },
+  { "lcd fill, 2 x 76800", 2, 76800 },
+  { "lcd row, 480 x 1", 480, 1 },
+  { "bitmap, 16384 x 1", 16384, 1 },
+ };
+ static uint8_t data[16384];
+ unsigned i;
+ Mock m;
+
+ printf("one spi.write() of n bytes: kbyte/s, us per call; %u MHz core, SPI at %u MHz\n",
+  mhz,spi_mhz);
+ printf("  %6s  %16s  %16s  %16s  %s\n","n","bit bang","polled","spi_bus","polls dmas");
+ for (i=0; i<sizeof(sizes)/sizeof(sizes[0]); i++)
+ {
+  uint32_t n=sizes[i];
+  double b=bitbang(n,1), p=polled(n,1), s=planned(data,n,1,&m);
+  printf("  %6u  %7.0f %8.2f  %7.0f %8.2f  %7.0f %8.2f  %5llu %4llu\n",n,
+   n*1e3*mhz/b,b/mhz,n*1e3*mhz/p,p/mhz,n*1e3*mhz/s,s/mhz,
+   (unsigned long long)m.polls,(unsigned long long)m.dmas);
+ }
+ printf("bulk writes: ms, and of those the CPU is busy for with spi_bus\n");
+ printf("  %-22s  %8s  %8s  %8s  %8s  %s\n","","bit bang","polled","spi_bus","cpu","polls dmas");
+ for (i=0; i<sizeof(fills)/sizeof(fills[0]); i++)
+ {
+  uint64_t n=(uint64_t)fills[i].count*fills[i].rep;
+  double b=bitbang(n,1), p=polled(n,1), s=planned(data,fills[i].count,fills[i].rep,&m);
+  printf("  %-22s  %8.2f  %8.2f  %8.2f  %8.2f  %5llu %4llu\n",fills[i].name,
+   b/mhz/1e3,p/mhz/1e3,s/mhz/1e3,(call+m.cpu)/(double)mhz/1e3,
+   (unsigned long long)m.polls,(unsigned long long)m.dmas);
+ }
+}
+
+static void usage(const char* message)
+{
+ if (message!=NULL) fprintf(stderr,"%s: %s\n",PROGNAME,message);
+ fprintf(stderr,
+ "usage: %s [options]\n"
+ "  -k       self check only\n"
+ "  -f MHz   core clock (default 96)\n"
+ "  -s MHz   SPI clock (default 24)\n"
+ "  -d n     software SPI delay, cycles (default 50)\n"
+ "  -g n     cycles of a MicoGpio call (default 40)\n"
+ "  -m n     cycles to set up and finish a DMA (default 350)\n",
+ PROGNAME);
+ exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[])
+{
+ int i, check_only=0;
+ for (i=1; i<argc; i++)
+ {
+  if (strcmp(argv[i],"-k")==0) check_only=1;
+  else if (i+1==argc) usage("bad option");
+  else if (strcmp(argv[i],"-f")==0) mhz=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-s")==0) spi_mhz=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-d")==0) sw_delay=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-g")==0) gpio=atoi(argv[++i]);
+  else if (strcmp(argv[i],"-m")==0) dma_setup=atoi(argv[++i]);
+  else usage("bad option");
+ }
+ if (mhz==0 || spi_mhz==0) usage("bad clock");
+
+ printf("self check\n");
+ check_writes();
+ check_dma_errors();
+ printf("%s\n",failures==0 ? "  ok" : "  FAILED");
+ if (check_only || failures!=0) return failures!=0;
+ bench();
+ return 0;
+}
@@ -22,7 +22,11 @@
 //#define LOBO_SPIFFS_DBG
 #endif
 
+#ifndef LUAC_CROSS_FILE
 #include "mico_system.h"
+#else
+#include <stdint.h>
+#endif
 
 // compile time switches
 
@@ -158,13 +162,27 @@ extern uint8_t spiffs_debug;
 // SPIFFS_LOCK and SPIFFS_UNLOCK protects spiffs from reentrancy on api level
 // These should be defined on a multithreaded system
 
+// The lua, ftp and net threads all use the file system. spiffs_mut is
+// created by the first mount (file.c)
+#ifndef LUAC_CROSS_FILE
+extern mico_mutex_t spiffs_mut;
+#endif
+
 // define this to enter a mutex if you're running on a multithreaded system
 #ifndef SPIFFS_LOCK
-#define SPIFFS_LOCK(fs) //mico_rtos_lock_mutex(&spiffs_mut);
+#ifndef LUAC_CROSS_FILE
+#define SPIFFS_LOCK(fs) mico_rtos_lock_mutex(&spiffs_mut)
+#else
+#define SPIFFS_LOCK(fs)
+#endif
 #endif
 // define this to exit a mutex if you're running on a multithreaded system
 #ifndef SPIFFS_UNLOCK
-#define SPIFFS_UNLOCK(fs) //mico_rtos_unlock_mutex(&spiffs_mut);
+#ifndef LUAC_CROSS_FILE
+#define SPIFFS_UNLOCK(fs) mico_rtos_unlock_mutex(&spiffs_mut)
+#else
+#define SPIFFS_UNLOCK(fs)
+#endif
 #endif
 
 // Enable if only one spiffs instance with constant configuration will exist
@@ -1,7 +1,9 @@
 #include "spiffs.h"
 #include "spiffs_nucleus.h"
 
+#ifndef LUAC_CROSS_FILE
 #include "mico_platform.h"
+#endif
 
 extern void luaWdgReload( void );
 
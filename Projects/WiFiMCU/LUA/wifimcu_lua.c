@@ -6,6 +6,7 @@
 #include "CheckSumUtils.h"
 #include "lua.h"
 #include "lauxlib.h"
+#include "user_config.h"
 #include "MQTTClient.h"
 #include "sntp.h"
 
@@ -22,6 +23,11 @@ extern platform_uart_driver_t platform_uart_drivers[];
 extern const platform_uart_t  platform_uart_peripherals[];
 extern unsigned char boot_reason;
 extern void _WiFi_Scan_OK (lua_State *L, char ApNum, _ApList* ApList, uint8_t print);
+extern int _adc_stream_push (lua_State *L, int gen, void* block);
+extern int _gpio_capture_push (lua_State *L, int para);
+extern void _net_sent_release (lua_State *L);
+extern void _net_recv_call (lua_State *L, int cbref, int socket, void* data, void* hdr);
+extern void _net_co_resume (lua_State *L, void* co);
 
 
 #define DEFAULT_WATCHDOG_TIMEOUT        10*1000  // 10 seconds
@@ -167,6 +173,20 @@ int lua_getchar(char *inbuf)
 static void do_queue_task(queue_msg_t* msg)
 {
   if (msg->L == NULL) return;
+#ifdef USE_NET_MODULE
+  // buffers sent by the net thread are released here, callback or not
+  if ((msg->source & 0x0F) == onNetSent) _net_sent_release(msg->L);
+  // received data comes in blocks of the net receive pool, given back there
+  if ((msg->source & 0x0F) == onNetRecv) {
+    _net_recv_call(msg->L, msg->para2, msg->para1, msg->para3, msg->para4);
+    return;
+  }
+  // a net.co session goes on, no callback and no full collection
+  if ((msg->source & 0x0F) == onNetCo) {
+    _net_co_resume(msg->L, msg->para3);
+    return;
+  }
+#endif
   if (msg->para2 == LUA_NOREF) return;
 
   lua_rawgeti(msg->L, LUA_REGISTRYINDEX, msg->para2);
@@ -227,7 +247,7 @@ static void do_queue_task(queue_msg_t* msg)
     lua_call(msg->L, 2, 0);
     lua_gc(msg->L, LUA_GCCOLLECT, 0);
   }
-  else if ((msgsource == onNet) || (msgsource == onFTP))
+  else if ((msgsource == onNet) || (msgsource == onNetSent) || (msgsource == onFTP))
   { // === execute onNet & onFTP function ===
     uint8_t n = 0;
     lua_pushinteger(msg->L, msg->para1);
@@ -255,6 +275,31 @@ static void do_queue_task(queue_msg_t* msg)
       luaL_unref(msg->L, LUA_REGISTRYINDEX, msg->para2);
     }
   }
+#ifdef USE_ADC_MODULE
+  else if (msgsource == onADC)
+  { // === execute adc stream function ===
+    int n = _adc_stream_push(msg->L, msg->para1, msg->para3);
+    if (n < 0) {
+      lua_remove(msg->L, -1);
+      return;
+    }
+    lua_call(msg->L, n, 0);
+    lua_gc(msg->L, LUA_GCCOLLECT, 0);
+  }
+#endif
+#ifdef USE_GPIO_MODULE
+  else if (msgsource == onCAPTURE)
+  { // === execute gpio capture function ===
+    int n = _gpio_capture_push(msg->L, msg->para1);
+    if (n < 0) {
+      lua_remove(msg->L, -1);
+      return;
+    }
+    lua_call(msg->L, n, 0);
+    lua_gc(msg->L, LUA_GCCOLLECT, 0);
+  }
+#endif
+#ifdef USE_WIFI_MODULE
   else if (msgsource == onWIFI)
   { // === execute wifi function ===
     if ((msg->source & 0x10) != 0) {
@@ -293,6 +338,7 @@ static void do_queue_task(queue_msg_t* msg)
       lua_gc(msg->L, LUA_GCCOLLECT, 0);
     }
   }
+#endif
 }
 
 mico_queue_t os_queue;
@@ -413,6 +459,7 @@ static void lua_main_thread(void *data)
 //=====================================
 
 
+#ifndef MICO_HOST_PLATFORM
 //==================================================
 void TIM1_BRK_TIM9_IRQHandler(void)
 {
@@ -467,6 +514,15 @@ static void wwdg_Config(void)
   WWDG_Enable(0x7E);     // start WWDG reset timer
   TIM_Cmd(TIM9, ENABLE); // and enable TIM9 counter
 }
+#else
+// === no WWDG on the host, the independent watchdog takes its place ===
+//---------------------------
+static void wwdg_Config(void)
+{
+  use_wwdg = 0;
+  MicoWdgInitialize(wdg_tmo);
+}
+#endif
 
 //===========================
 int application_start( void )
@@ -480,6 +536,9 @@ int application_start( void )
     
   platform_check_bootreason();
   MicoInit();
+#if MICO_DEFERRED_LOG
+  mico_log_init();
+#endif
 
   // Read parameters from flash
   if (getLua_systemParams(&lua_system_param) == 0)  {
@@ -32,12 +32,68 @@
 
 #define YesOrNo(x) (x ? "YES" : "NO")
 
+// ==== DEFERRED LOGGING ====
+// Define MICO_DEFERRED_LOG=1 in the project preprocessor settings (next to DEBUG)
+// to move log formatting and UART output out of the caller: custom_log() only captures the format pointer,
+// timestamp and raw arguments into a lock-free ring, and a low priority thread
+// started by mico_log_init() formats and prints them.
+#ifndef MICO_DEFERRED_LOG
+#define MICO_DEFERRED_LOG 0
+#endif
+
+typedef enum
+{
+  MICO_LOG_OFF = 0,
+  MICO_LOG_ERR,
+  MICO_LOG_WARN,
+  MICO_LOG_INFO,
+  MICO_LOG_DEBUG,
+} mico_log_level_t;
+
+typedef struct
+{
+  uint32_t logged;      /**< Records queued since mico_log_init */
+  uint32_t dropped;     /**< Records lost because the ring was full */
+  uint32_t filtered;    /**< Records rejected by the module level */
+  uint32_t high_water;  /**< Maximum ring occupancy seen, in records */
+} mico_log_stats_t;
+
+#if MICO_DEFERRED_LOG
+/** @brief  Start the deferred log output thread, call once after MicoInit() */
+OSStatus mico_log_init( void );
+
+/** @brief  Set the level of one module (the N argument of custom_log), NULL sets the default */
+OSStatus mico_log_set_level( const char* module, mico_log_level_t level );
+
+/** @brief  Emit raw records instead of text, to be decoded offline with the firmware map file */
+void mico_log_set_binary( bool enable );
+
+void mico_log_get_stats( mico_log_stats_t* stats );
+
+void mico_log_deferred( const char* module, mico_log_level_t level, const char* file, int line, const char* format, ... );
+#endif
+
 #if DEBUG
 #ifndef MICO_DISABLE_STDIO
 #ifndef NO_MICO_RTOS
    extern int mico_debug_enabled;
    extern mico_mutex_t stdio_tx_mutex;
 
+#if MICO_DEFERRED_LOG
+    #define custom_log_level(N, L, M, ...) do {if (mico_debug_enabled==0)break;\
+                                               mico_log_deferred(N, L, __FILE__, __LINE__, M, ##__VA_ARGS__);}while(0==1)
+
+    #define custom_log(N, M, ...) custom_log_level(N, MICO_LOG_INFO, M, ##__VA_ARGS__)
+
+    #define debug_print_assert(A,B,C,D,E,F) do {if (mico_debug_enabled==0)break;\
+                                                     mico_log_deferred("MICO", MICO_LOG_ERR, D, E, "%s **ASSERT** %s", F, (C!=NULL) ? C : "" );}while(0==1)
+    #if TRACE
+        #define custom_log_trace(N) do {if (mico_debug_enabled==0)break;\
+                                        mico_log_deferred(N, MICO_LOG_DEBUG, __FILE__, __LINE__, "[TRACE] %s()", __PRETTY_FUNCTION__);}while(0==1)
+    #else  // !TRACE
+        #define custom_log_trace(N)
+    #endif // TRACE
+#else // !MICO_DEFERRED_LOG
     #define custom_log(N, M, ...) do {if (mico_debug_enabled==0)break;\
                                       mico_rtos_lock_mutex( &stdio_tx_mutex );\
                                       printf("[%d][%s: %s:%4d] " M "\r\n", mico_get_time(), N, SHORT_FILE, __LINE__, ##__VA_ARGS__);\
@@ -55,6 +111,7 @@
     #else  // !TRACE
         #define custom_log_trace(N)
     #endif // TRACE  
+#endif // MICO_DEFERRED_LOG
 #else // NO_MICO_RTOS  
     #define custom_log(N, M, ...) do {printf("[%s: %s:%4d] " M "\r\n",  N, SHORT_FILE, __LINE__, ##__VA_ARGS__);}while(0==1)
                                         
@@ -81,6 +138,12 @@
     #define debug_print_assert(A,B,C,D,E,F)
 #endif // DEBUG
 
+// custom_log() logs at MICO_LOG_INFO, custom_log_level() at the level given.
+// Only the deferred backend filters on it (mico_log_set_level), the others print every level.
+#ifndef custom_log_level
+    #define custom_log_level(N, L, M, ...) custom_log(N, M, ##__VA_ARGS__)
+#endif
+
 // ==== PLATFORM TIMEING FUNCTIONS ====
 #if TIME_PLATFORM
     #define function_timer_log(M, N, ...) fprintf(stderr, "[FUNCTION TIMER: " N "()] " M "\n", ##__VA_ARGS__)
@@ -0,0 +1,31 @@
+#ifndef randombytes_H
+#define randombytes_H
+
+/*
+ * On MICO the bytes come from MicoRandomNumberRead(), the random number
+ * generator of the platform.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SODIUM_EXPORT
+void randombytes_buf(void * const buf, const size_t size);
+
+SODIUM_EXPORT
+uint32_t randombytes_random(void);
+
+SODIUM_EXPORT
+void randombytes(unsigned char * const buf, const unsigned long long buf_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -53,6 +53,8 @@
  *                 Type Definitions
  ******************************************************/
 
+typedef platform_adc_stream_callback_t mico_adc_stream_handler_t;
+
  /******************************************************
  *                    Structures
  ******************************************************/
@@ -116,6 +118,35 @@ OSStatus MicoAdcTakeSample( mico_adc_t adc, uint16_t* output );
 OSStatus MicoAdcTakeSampleStream( mico_adc_t adc, void* buffer, uint16_t buffer_length );
 
 
+/** Starts continuous sampling on an ADC interface
+ *
+ * Conversions are triggered by a hardware timer and moved by DMA into a
+ * circular buffer. The handler is called from interrupt context each time
+ * half of the buffer has been filled, so it must return quickly.
+ *
+ * @param adc           : the interface which should be sampled
+ * @param sample_rate   : samples per second
+ * @param buffer        : circular buffer of uint16_t samples
+ * @param buffer_length : number of samples in the buffer, must be even
+ * @param handler       : called with each filled half of the buffer
+ * @param arg           : argument passed to the handler
+ *
+ * @return    kNoErr        : on success.
+ * @return    kGeneralErr   : if an error occurred with any step
+ */
+OSStatus MicoAdcStreamStart( mico_adc_t adc, uint32_t sample_rate, uint16_t* buffer, uint16_t buffer_length, mico_adc_stream_handler_t handler, void* arg );
+
+
+/** Stops continuous sampling on an ADC interface
+ *
+ * @param adc : the interface which is streaming
+ *
+ * @return    kNoErr        : on success.
+ * @return    kGeneralErr   : if an error occurred with any step
+ */
+OSStatus MicoAdcStreamStop( mico_adc_t adc );
+
+
 /** De-initialises an ADC interface
  *
  * Turns off an ADC hardware interface
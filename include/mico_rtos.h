@@ -34,7 +34,9 @@
 
 #include "Common.h"
 
+#ifndef MICO_HOST_PLATFORM
 #define mico_thread_sleep                 sleep
+#endif
 
 #ifdef NO_MICO_RTOS
 #define mico_thread_msleep                mico_thread_msleep_no_os
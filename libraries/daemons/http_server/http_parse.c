@@ -296,6 +296,51 @@ done:
 
 /* Parse the individual components of the HTTP header and reflect it in
 * httpd_request_t structure. */
+/* True if the Accept-Encoding value takes gzip: gzip, x-gzip or * listed
+* without q=0, an explicit gzip entry winning over * */
+static bool httpd_accepts_gzip(const char *value)
+{
+  int gzip_q = -1, any_q = -1, q;
+  const char *p = value;
+  size_t n;
+  
+  while (*p) {
+    while (*p == ',' || iswhite(*p))
+      p++;
+    n = strcspn(p, ";, \t\r\n");
+    if (n == 0)
+      break;
+    q = 1;
+    const char *param = p + n;
+    while (iswhite(*param))
+      param++;
+    if (*param == ';') {
+      param++;
+      while (iswhite(*param))
+        param++;
+      if ((param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+        /* q=0, q=0.0 ... refuse, any other weight takes it */
+        param += 2;
+        q = 0;
+        while (*param == '0' || *param == '.')
+          param++;
+        if (*param >= '1' && *param <= '9')
+          q = 1;
+      }
+    }
+    if ((n == 4 && strncasecmp(p, "gzip", 4) == 0) ||
+        (n == 6 && strncasecmp(p, "x-gzip", 6) == 0))
+      gzip_q = q;
+    else if (n == 1 && *p == '*')
+      any_q = q;
+    p += strcspn(p, ",");
+  }
+  
+  if (gzip_q >= 0)
+    return gzip_q > 0;
+  return any_q > 0;
+}
+
 static int __httpd_parse_hdr_tags(char *data_p, int len,
 				  httpd_request_t *req_p, uint8_t *done)
 {
@@ -334,8 +379,11 @@ static int __httpd_parse_hdr_tags(char *data_p, int len,
     }
     
     const char *etag_start = ++first_double_quote;
-    req_p->etag_val = strtol(etag_start, NULL, 16);
+    req_p->etag_val = strtoul(etag_start, NULL, 16);
     req_p->if_none_match = TRUE;
+  } else if (strncasecmp(data_p, "Accept-Encoding:", sizeof("Accept-Encoding:") - 1) == 0) {
+    req_p->accept_gzip =
+      httpd_accepts_gzip(data_p + sizeof("Accept-Encoding:") - 1);
   } else if (strncasecmp(data_p, http_encoding, sizeof(http_encoding) - 1) == 0) {
     if (!strncasecmp(&data_p[sizeof(http_encoding) - 1],
                      HTTP_CHUNKED, sizeof(HTTP_CHUNKED) - 1))
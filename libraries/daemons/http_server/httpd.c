@@ -378,6 +378,7 @@ static void httpd_main(void *arg)
     httpd_suspend_thread(true);
   
   FD_ZERO(&readfds);
+  FD_ZERO(&active_readfds);
   
   FD_SET(http_sockfd, &readfds);
   max_sockfd = http_sockfd;
@@ -347,7 +347,9 @@
 //#include <json.h>
 
 /** Port on which the httpd listens for non secure connections. */
+#ifndef HTTP_PORT
 #define HTTP_PORT 80
+#endif
 
 /** Port on which the httpd listens for secure connections. */
 #define HTTPS_PORT 443
@@ -517,6 +519,8 @@ enum wm_httpd_errno {
 #define HTTP_RES_400 "HTTP/1.1 400 Bad Request\r\n"
 /** HTTP Response: 404 Not Found */
 #define HTTP_RES_404 "HTTP/1.1 404 Not Found\r\n"
+/** HTTP Response: 406 Not Acceptable */
+#define HTTP_RES_406 "HTTP/1.1 406 Not Acceptable\r\n"
 /** HTTP Response: 505 HTTP Version Not Supported */
 #define HTTP_RES_505 "HTTP/1.1 505 HTTP Version Not Supported\r\n"
 
@@ -573,6 +577,8 @@ typedef struct {
 	bool if_none_match;
 	/** Used for storing the etag of an URI */
 	unsigned etag_val;
+	/** True if "Accept-Encoding" of the incoming HTTP Request takes gzip */
+	bool accept_gzip;
 } httpd_request_t;
 
 /** Initialize the httpd
@@ -1069,6 +1075,47 @@ int httpd_send_all_header(httpd_request_t *req, const char *first_line, int body
  */
 int httpd_send_body(int sock, const unsigned char *body_image, uint32_t body_size);
 
+/** Flash resident static asset, tables of these are generated from a web
+ *  directory by tools/web_asset_gen.py */
+typedef struct {
+	/** URI of the asset, e.g. "/index.html" */
+	const char *path;
+	/** Content-Type of the asset */
+	const char *content_type;
+	/** Body as sent on the wire, gzip compressed if gzipped is set */
+	const unsigned char *data;
+	/** Length of data */
+	uint32_t len;
+	/** Strong ETag, CRC32 of data */
+	uint32_t etag;
+	/** True if data is gzip compressed */
+	bool gzipped;
+} httpd_static_asset_t;
+
+/** Send a static asset
+ *  This function reads the request headers and answers with
+ *  "304 Not Modified" if the If-None-Match header carries the ETag of the
+ *  asset. Otherwise the asset is sent with its ETag and, if compressed,
+ *  "Content-Encoding: gzip". Only the compressed copy of such an asset is
+ *  in flash: a request whose Accept-Encoding does not take gzip gets
+ *  "406 Not Acceptable".
+ *  \param[in] req The incoming HTTP request \ref httpd_request_t
+ *  \param[in] asset The asset to be sent
+ *  \return kNoErr if successful
+ *  \return error code otherwise
+ */
+int httpd_send_static_asset(httpd_request_t *req,
+		const httpd_static_asset_t *asset);
+
+/** Find a static asset by URI
+ *  \param[in] assets The asset table
+ *  \param[in] num Number of assets in the table
+ *  \param[in] uri The URI to look up, query string is ignored
+ *  \return pointer to the asset, NULL if not found
+ */
+const httpd_static_asset_t *httpd_find_static_asset(
+		const httpd_static_asset_t *assets, int num, const char *uri);
+
 /** Send the default HTTP Headers
  *
  *  This function can be used by the WSGI handlers to send out some or all
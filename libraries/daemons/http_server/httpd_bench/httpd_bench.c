@@ -0,0 +1,127 @@
+/**
+******************************************************************************
+* @file    httpd_bench.c
+* @version V1.0.0
+* @brief   The httpd of ../ on the host port, serving the pages of the
+*          http_server demo twice: under / from the generated asset table
+*          of the demo (web_data.c) with httpd_send_static_asset(), and
+*          under /raw/ uncompressed with httpd_send_all_header() and
+*          httpd_send_body(), as the demo sent them before. httpd_bench.py
+*          is the client, see readme.txt.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <stdio.h>
+
+#include "MICO.h"
+#include "httpd.h"
+#include "http-strings.h"
+
+#define bench_log(M, ...) custom_log("httpd_bench", M, ##__VA_ARGS__)
+
+#define HTTPD_HDR_DEFORT (HTTPD_HDR_ADD_SERVER|HTTPD_HDR_ADD_CONN_CLOSE|HTTPD_HDR_ADD_PRAGMA_NO_CACHE)
+
+/* web_data.c of the demo, and the same pages uncompressed, build/web_raw.c */
+extern const httpd_static_asset_t web_assets[];
+extern const int web_assets_num;
+extern const httpd_static_asset_t web_raw_assets[];
+extern const int web_raw_assets_num;
+
+/* Platform_init of the firmware owns these */
+int          mico_debug_enabled = 1;
+mico_mutex_t stdio_tx_mutex;
+
+/* mico_system_notification.c, no notifications here */
+void socket_connected( int fd )
+{
+  (void)fd;
+}
+
+static const char *page_uri( httpd_request_t *req )
+{
+  /* The demo serves its setting page on / */
+  if ( strcspn( req->filename, "?" ) == 1 )
+    return "/wifisetting.html";
+  return req->filename;
+}
+
+static int web_send_asset( httpd_request_t *req )
+{
+  const httpd_static_asset_t *asset;
+
+  asset = httpd_find_static_asset( web_assets, web_assets_num, page_uri( req ) );
+  if ( asset == NULL )
+    return kNotFoundErr;
+
+  return httpd_send_static_asset( req, asset );
+}
+
+/* As app_httpd.c sent its pages before web_asset_gen.py */
+static int web_send_raw( httpd_request_t *req )
+{
+  OSStatus err = kNoErr;
+  const httpd_static_asset_t *asset;
+
+  asset = httpd_find_static_asset( web_raw_assets, web_raw_assets_num, page_uri( req ) );
+  if ( asset == NULL )
+    return kNotFoundErr;
+
+  err = httpd_send_all_header( req, HTTP_RES_200, asset->len, asset->content_type );
+  require_noerr_action( err, exit, bench_log("ERROR: Unable to send http headers.") );
+
+  err = httpd_send_body( req->sock, asset->data, asset->len );
+  require_noerr_action( err, exit, bench_log("ERROR: Unable to send http body.") );
+
+exit:
+  return err;
+}
+
+static struct httpd_wsgi_call bench_handlers[] = {
+  {"/", HTTPD_HDR_DEFORT, APP_HTTP_FLAGS_NO_EXACT_MATCH, web_send_asset, NULL, NULL, NULL},
+  {"/raw/", HTTPD_HDR_DEFORT, APP_HTTP_FLAGS_NO_EXACT_MATCH, web_send_raw, NULL, NULL, NULL},
+};
+
+int main( void )
+{
+  OSStatus err = kNoErr;
+
+  mico_rtos_init_mutex( &stdio_tx_mutex );
+
+  err = httpd_init( );
+  require_noerr_action( err, exit, bench_log("failed to initialize httpd") );
+
+  err = httpd_register_wsgi_handlers( bench_handlers, sizeof(bench_handlers)/sizeof(bench_handlers[0]) );
+  require_noerr_action( err, exit, bench_log("failed to register the handlers") );
+
+  err = httpd_start( );
+  require_noerr_action( err, exit, bench_log("failed to start httpd thread") );
+
+  printf( "httpd_bench: port %d, %d assets\n", HTTP_PORT, web_assets_num );
+  fflush( stdout );
+  while ( 1 )
+    mico_thread_sleep( 1000 );
+
+exit:
+  return 1;
+}
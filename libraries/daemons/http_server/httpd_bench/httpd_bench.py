@@ -0,0 +1,237 @@
+#!/usr/bin/env python
+#
+# httpd_bench.py
+#
+# Runs httpd_bench, the httpd on the host port serving the pages of the
+# http_server demo, and fetches them: a self check of the gzip answers,
+# the ETags, 304 on If-None-Match and HEAD, 406 when Accept-Encoding
+# does not take gzip, then the bytes each answer takes and its response time, uncompressed as the demo sent its pages
+# before (/raw/), gzip compressed and revalidated with If-None-Match.
+#
+# usage: httpd_bench.py [-f server] [-p port] [-k] [-n requests] [-r kbit/s]
+#
+# The MIT License
+# Copyright (c) 2014 MXCHIP Inc.
+#
+
+import argparse
+import gzip
+import os
+import re
+import socket
+import subprocess
+import sys
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+WEB_DIR = os.path.join(HERE, '..', '..', '..', '..', 'MICODemos', 'http', 'http_server', 'web_data')
+
+
+class Answer(object):
+    """An answer of the server, as it came over the socket"""
+
+    def __init__(self, status, headers, body, size, elapsed, extra):
+        self.status = status
+        self.headers = headers
+        self.body = body
+        self.size = size            # bytes received, headers and body
+        self.elapsed = elapsed      # seconds, connect to the last byte
+        self.extra = extra          # bytes after the answer, HEAD and 304
+
+
+def fetch(port, path, method='GET', headers=(), linger=0.05, timeout=5.0,
+          encoding='gzip, deflate'):
+    start = time.time()
+    s = socket.create_connection(('127.0.0.1', port), timeout)
+    try:
+        req = '%s %s HTTP/1.1\r\nHost: wifimcu\r\n' % (method, path)
+        if encoding is not None:
+            req += 'Accept-Encoding: %s\r\n' % encoding
+        req += ''.join('%s: %s\r\n' % h for h in headers) + '\r\n'
+        s.sendall(req.encode('latin-1'))
+        data = b''
+        while b'\r\n\r\n' not in data:
+            d = s.recv(4096)
+            if not d:
+                break
+            data += d
+        head, _, body = data.partition(b'\r\n\r\n')
+        lines = head.decode('latin-1').split('\r\n')
+        status = int(lines[0].split()[1])
+        fields = {}
+        for line in lines[1:]:
+            name, _, value = line.partition(':')
+            fields[name.strip().lower()] = value.strip()
+        if method == 'HEAD' or status == 304:
+            length = 0
+        elif 'content-length' in fields:
+            length = int(fields['content-length'])
+        else:
+            length = None
+        chunked = fields.get('transfer-encoding') == 'chunked'
+        while (len(body) < length if length is not None else
+               not (chunked and body.endswith(b'0\r\n\r\n'))):
+            d = s.recv(4096)
+            if not d:
+                break
+            body += d
+        elapsed = time.time() - start
+        extra = b''
+        if length is not None:
+            # the connection stays open, nothing more must come
+            extra, body = body[length:], body[:length]
+        if length is not None and linger:
+            s.settimeout(linger)
+            try:
+                extra += s.recv(4096)
+            except socket.timeout:
+                pass
+        return Answer(status, fields, body, len(head) + 4 + len(body) + len(extra), elapsed, extra)
+    finally:
+        s.close()
+
+
+def start(args):
+    proc = subprocess.Popen([args.server], cwd=HERE, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+    line = proc.stdout.readline().decode('latin-1')
+    if not line.startswith('httpd_bench: port'):
+        proc.kill()
+        sys.exit('httpd_bench did not start: %s' % line.strip())
+    end = time.time() + 5
+    while True:
+        try:
+            socket.create_connection(('127.0.0.1', args.port), 1).close()
+            return proc
+        except OSError:
+            if time.time() > end:
+                proc.kill()
+                sys.exit('httpd_bench is not listening on %d' % args.port)
+            time.sleep(0.05)
+
+
+def pages():
+    return [(fn, open(os.path.join(WEB_DIR, fn), 'rb').read())
+            for fn in sorted(os.listdir(WEB_DIR))]
+
+
+def check(args):
+    fails = []
+
+    def expect(name, got, value):
+        if got != value:
+            fails.append(name)
+            print('FAIL %s: %r, expected %r' % (name, got, value))
+
+    for fn, raw in pages():
+        path = '/' + fn
+        a = fetch(args.port, path)
+        expect('%s status' % fn, a.status, 200)
+        expect('%s encoding' % fn, a.headers.get('content-encoding'), 'gzip')
+        expect('%s type' % fn, a.headers.get('content-type'), 'text/html')
+        expect('%s length' % fn, a.headers.get('content-length'), str(len(a.body)))
+        expect('%s body' % fn, gzip.decompress(a.body) if a.body else b'', raw)
+        etag = a.headers.get('etag', '')
+        expect('%s etag' % fn, bool(re.match(r'^"[0-9a-f]{8}"$', etag)), True)
+
+        b = fetch(args.port, path, headers=[('If-None-Match', etag)])
+        expect('%s if-none-match' % fn, (b.status, b.headers.get('etag'), b.extra), (304, etag, b''))
+        other = '"%08x"' % (int(etag.strip('"') or '0', 16) ^ 1)
+        b = fetch(args.port, path, headers=[('If-None-Match', other)])
+        expect('%s other etag' % fn, (b.status, b.body), (200, a.body))
+
+        b = fetch(args.port, path, method='HEAD')
+        expect('%s head' % fn, (b.status, b.headers.get('content-length'), b.headers.get('etag'), b.extra),
+               (200, str(len(a.body)), etag, b''))
+        b = fetch(args.port, path + '?x=1')
+        expect('%s query' % fn, (b.status, b.headers.get('etag')), (200, etag))
+
+        b = fetch(args.port, '/raw' + path)
+        expect('%s raw' % fn, (b.status, b.headers.get('content-encoding'), b.body), (200, None, raw))
+        b = fetch(args.port, '/raw' + path, encoding=None)
+        expect('%s raw, no accept-encoding' % fn, (b.status, b.body), (200, raw))
+
+        # only the gzip copy is in flash, who does not take it gets a 406
+        for enc in (None, 'identity', 'deflate', 'gzip;q=0', 'gzip; q=0.000, *',
+                    '*;q=0', 'x-gzip;q=0, deflate'):
+            b = fetch(args.port, path, encoding=enc)
+            expect('%s accept-encoding %r' % (fn, enc),
+                   (b.status, b.headers.get('vary'), b.body, b.extra), (406, 'Accept-Encoding', b'', b''))
+        for enc in ('GZIP', 'deflate, gzip;q=0.5', 'x-gzip', '*', 'identity, *;q=1', 'gzip;q=0.001'):
+            b = fetch(args.port, path, encoding=enc)
+            expect('%s accept-encoding %r' % (fn, enc),
+                   (b.status, b.headers.get('content-encoding'), b.body), (200, 'gzip', a.body))
+
+    a = fetch(args.port, '/')
+    expect('/', (a.status, gzip.decompress(a.body) if a.status == 200 else b''),
+           (200, dict(pages())['wifisetting.html']))
+    a = fetch(args.port, '/missing.html')
+    expect('missing', a.status != 200, True)
+
+    print('check: %d fail(s)' % len(fails))
+    return not fails
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+
+def airtime(args, size):
+    """ms the bytes take at the link rate, the loopback takes none"""
+    return size * 8.0 / args.rate
+
+
+def bench(args):
+    print('%-18s %-6s %7s %9s %9s %9s %12s' %
+          ('', '', 'bytes', 'mean', 'p50', 'p99', '%d kbit/s' % args.rate))
+    totals = {}
+    for fn, raw in pages():
+        etag = fetch(args.port, '/' + fn).headers['etag']
+        for mode, path, headers in (('raw', '/raw/' + fn, ()),
+                                    ('gzip', '/' + fn, ()),
+                                    ('304', '/' + fn, [('If-None-Match', etag)])):
+            times, size = [], 0
+            for i in range(args.requests):
+                a = fetch(args.port, path, headers=headers, linger=0)
+                times.append(a.elapsed * 1000.0)
+                size = a.size
+            totals[mode] = totals.get(mode, 0) + size
+            print('%-18s %-6s %7d %9.3f %9.3f %9.3f %9.1f ms' %
+                  (fn, mode, size, sum(times) / len(times),
+                   percentile(times, 50), percentile(times, 99), airtime(args, size)))
+    print('all %d pages: %d bytes raw, %d gzip (%.1fx fewer), %d revalidated' %
+          (len(pages()), totals['raw'], totals['gzip'],
+           float(totals['raw']) / totals['gzip'], totals['304']))
+    print('at %d kbit/s: %.1f ms raw, %.1f ms gzip, %.1f ms revalidated' %
+          (args.rate, airtime(args, totals['raw']), airtime(args, totals['gzip']),
+           airtime(args, totals['304'])))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='httpd static asset check and benchmark')
+    ap.add_argument('-f', dest='server', default=os.path.join(HERE, 'httpd_bench'))
+    ap.add_argument('-p', dest='port', type=int, default=8080,
+                    help='HTTP_PORT httpd_bench was built with')
+    ap.add_argument('-k', dest='check_only', action='store_true',
+                    help='self check only')
+    ap.add_argument('-n', dest='requests', type=int, default=200,
+                    help='requests timed per page and answer')
+    ap.add_argument('-r', dest='rate', type=int, default=1000,
+                    help='kbit/s of the link the answer times are given for')
+    args = ap.parse_args()
+    args.server = os.path.abspath(args.server)
+
+    proc = start(args)
+    try:
+        ok = check(args)
+        if not args.check_only:
+            bench(args)
+    finally:
+        proc.kill()
+        proc.wait()
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
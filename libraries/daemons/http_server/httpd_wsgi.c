@@ -58,9 +58,11 @@ int httpd_register_wsgi_handler(struct httpd_wsgi_call *wsgi_call)
 
 	for (i = 0; i < MAX_WSGI_HANDLERS; i++) {
 		/*Find the first empty location in the calls array */
-		if (!calls[i] && store_index == -1) {
-			httpd_d("Found empty location %d", i);
-			store_index = i;
+		if (!calls[i]) {
+			if (store_index == -1) {
+				httpd_d("Found empty location %d", i);
+				store_index = i;
+			}
 			continue;
 		}
 		if (strcmp(calls[i]->uri, wsgi_call->uri) == 0) {
@@ -422,6 +424,161 @@ int httpd_send_all_header(httpd_request_t *req, const char *first_line, int body
   return ret;
 }
 
+/* 406 with an empty body, Vary tells caches why */
+static int httpd_send_not_acceptable(httpd_request_t *req)
+{
+  int ret;
+
+  ret = httpd_send(req->sock, HTTP_RES_406, strlen(HTTP_RES_406));
+  if (ret != kNoErr) {
+    httpd_d("Error in sending the first line");
+    return ret;
+  }
+
+  if (req->wsgi->hdr_fields) {
+    ret = httpd_send_default_headers(req->sock, req->wsgi->hdr_fields);
+    if (ret != kNoErr) {
+      httpd_d("Error in sending default headers");
+      return ret;
+    }
+  }
+  ret = httpd_send(req->sock, http_header_keep_alive_ctrl, strlen(http_header_keep_alive_ctrl));
+  if (ret != kNoErr) {
+    httpd_d("Error in sending Connection");
+    return ret;
+  }
+
+  ret = httpd_send_header(req->sock, "Vary", "Accept-Encoding");
+  if (ret != kNoErr) {
+    httpd_d("Error in sending Vary");
+    return ret;
+  }
+
+  ret = httpd_send_header(req->sock, "Content-Length", "0");
+  if (ret != kNoErr) {
+    httpd_d("Error in sending Content-Length");
+    return ret;
+  }
+
+  return httpd_send_crlf(req->sock);
+}
+
+const httpd_static_asset_t *httpd_find_static_asset(
+  const httpd_static_asset_t *assets, int num, const char *uri)
+{
+  int i;
+  size_t len = strcspn(uri, "?");
+
+  for (i = 0; i < num; i++) {
+    if (strlen(assets[i].path) == len &&
+        strncmp(assets[i].path, uri, len) == 0)
+      return &assets[i];
+  }
+  return NULL;
+}
+
+int httpd_send_static_asset(httpd_request_t *req,
+                            const httpd_static_asset_t *asset)
+{
+  int ret;
+  char *buf;
+  char etag[11];
+  char con_len[11];
+  bool not_modified;
+
+  /* Read the header tags, we need If-None-Match and Accept-Encoding */
+  if ((req->type == HTTPD_REQ_TYPE_GET ||
+       req->type == HTTPD_REQ_TYPE_HEAD) && !req->hdr_parsed) {
+    buf = malloc(HTTPD_MAX_MESSAGE);
+    if (!buf) {
+      httpd_d("Failed to allocate memory for buffer");
+      return -kInProgressErr;
+    }
+    ret = httpd_parse_hdr_tags(req, req->sock, buf, HTTPD_MAX_MESSAGE);
+    free(buf);
+    if (ret != kNoErr) {
+      httpd_d("Unable to parse header tags");
+      return ret;
+    }
+    req->hdr_parsed = 1;
+  }
+
+  if (asset->gzipped && !req->accept_gzip) {
+    /* Only the compressed copy is in flash */
+    httpd_d("Client does not accept gzip for %s", asset->path);
+    return httpd_send_not_acceptable(req);
+  }
+
+  not_modified = req->if_none_match && req->etag_val == asset->etag;
+  snprintf(etag, sizeof(etag), "\"%08x\"", (unsigned int)asset->etag);
+
+  if (not_modified)
+    ret = httpd_send(req->sock, http_header_304_prologue,
+                     strlen(http_header_304_prologue));
+  else
+    ret = httpd_send(req->sock, HTTP_RES_200, strlen(HTTP_RES_200));
+  if (ret != kNoErr) {
+    httpd_d("Error in sending the first line");
+    return ret;
+  }
+
+  httpd_d("HTTP Req for URI %s", req->wsgi->uri);
+  if (req->wsgi->hdr_fields) {
+    ret = httpd_send_default_headers(req->sock, req->wsgi->hdr_fields);
+    if (ret != kNoErr) {
+      httpd_d("Error in sending default headers");
+      return ret;
+    }
+  }
+  ret = httpd_send(req->sock, http_header_keep_alive_ctrl, strlen(http_header_keep_alive_ctrl));
+  if (ret != kNoErr) {
+    httpd_d("Error in sending Connection");
+    return ret;
+  }
+
+  ret = httpd_send_header(req->sock, "ETag", etag);
+  if (ret != kNoErr) {
+    httpd_d("Error in sending ETag");
+    return ret;
+  }
+
+  if (not_modified) {
+    /* 304 carries no body */
+    return httpd_send_crlf(req->sock);
+  }
+
+  ret = httpd_send_header(req->sock, "Content-Type", asset->content_type);
+  if (ret != kNoErr) {
+    httpd_d("Error in sending Content-Type");
+    return ret;
+  }
+
+  if (asset->gzipped) {
+    ret = httpd_send(req->sock, http_content_encoding_gz,
+                     strlen(http_content_encoding_gz));
+    if (ret != kNoErr) {
+      httpd_d("Error in sending Content-Encoding");
+      return ret;
+    }
+  }
+
+  snprintf(con_len, sizeof(con_len), "%u", (unsigned int)asset->len);
+  ret = httpd_send_header(req->sock, "Content-Length", con_len);
+  if (ret != kNoErr) {
+    httpd_d("Error in sending Content-Length");
+    return ret;
+  }
+
+  ret = httpd_send_crlf(req->sock);
+  if (ret != kNoErr)
+    return ret;
+
+  if (req->type == HTTPD_REQ_TYPE_HEAD)
+    return kNoErr;
+
+  return httpd_send_body(req->sock, asset->data, asset->len);
+}
+
 int httpd_send_response(httpd_request_t *req, const char *first_line,
 			char *content, int length, const char *content_type)
 {
@@ -548,7 +705,8 @@ static int get_matching_chars(const char *s1, const char *s2)
 	int match = 0;
 
 	if (s1 != NULL && s2 != NULL) {
-		while (*s1++ == *s2++)
+		/* Stop at the end, the strings may be the same */
+		while (*s2 && *s1++ == *s2++)
 			match++;
 	}
 	return match;
@@ -0,0 +1,155 @@
+#!/usr/bin/env python
+#
+# web_asset_gen.py
+#
+# Turns a web directory into a flash resident asset table for httpd.
+# Every file is gzip compressed (kept raw if that does not make it smaller)
+# and gets a strong ETag, the CRC32 of the bytes that are sent.
+# The generated table is served with httpd_send_static_asset().
+#
+# usage: web_asset_gen.py <web_dir> <output.c> [--prefix /] [--table name] [--raw]
+#
+# The MIT License
+# Copyright (c) 2014 MXCHIP Inc.
+#
+
+import argparse
+import gzip
+import io
+import os
+import re
+import sys
+import zlib
+
+MIME_TYPES = {
+    '.html': 'HTTP_CONTENT_HTML_STR',
+    '.htm':  'HTTP_CONTENT_HTML_STR',
+    '.css':  'HTTP_CONTENT_CSS_STR',
+    '.js':   'HTTP_CONTENT_JS_STR',
+    '.png':  'HTTP_CONTENT_PNG_STR',
+    '.json': 'HTTP_CONTENT_JSON_STR',
+    '.xml':  'HTTP_CONTENT_XML_STR',
+    '.txt':  'HTTP_CONTENT_PLAIN_TEXT_STR',
+    '.jpg':  '"image/jpeg"',
+    '.jpeg': '"image/jpeg"',
+    '.gif':  '"image/gif"',
+    '.ico':  '"image/x-icon"',
+    '.svg':  '"image/svg+xml"',
+}
+
+HEADER = '''/**
+******************************************************************************
+* @file    %(name)s
+* @version V1.0.0
+* @brief   Static web assets, generated by web_asset_gen.py from %(src)s.
+*          Do not edit, regenerate instead.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy 
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights 
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR 
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <httpd.h>
+
+'''
+
+
+def gzip_bytes(data):
+    # mtime=0 keeps the output, and so the ETag, reproducible
+    out = io.BytesIO()
+    with gzip.GzipFile(filename='', mode='wb', compresslevel=9, fileobj=out, mtime=0) as f:
+        f.write(data)
+    return out.getvalue()
+
+
+def c_name(path):
+    return 'web_asset_' + re.sub(r'[^0-9A-Za-z]', '_', path.strip('/'))
+
+
+def c_array(name, data):
+    lines = ['static const unsigned char %s[0x%X] = {' % (name, len(data))]
+    for i in range(0, len(data), 16):
+        chunk = ', '.join('0x%02X' % b for b in bytearray(data[i:i + 16]))
+        lines.append('  ' + chunk + (',' if i + 16 < len(data) else ''))
+    lines.append('};')
+    return '\n'.join(lines) + '\n\n'
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Generate a httpd static asset table')
+    ap.add_argument('web_dir')
+    ap.add_argument('output')
+    ap.add_argument('--prefix', default='/', help='URI prefix of the assets')
+    ap.add_argument('--table', default='web_assets', help='name of the table')
+    ap.add_argument('--raw', action='store_true', help='no compression')
+    args = ap.parse_args()
+
+    assets = []
+    for root, dirs, files in os.walk(args.web_dir):
+        dirs.sort()
+        for fn in sorted(files):
+            full = os.path.join(root, fn)
+            rel = os.path.relpath(full, args.web_dir).replace(os.sep, '/')
+            with open(full, 'rb') as f:
+                raw = f.read()
+            packed = gzip_bytes(raw)
+            gzipped = not args.raw and len(packed) < len(raw)
+            body = packed if gzipped else raw
+            ext = os.path.splitext(fn)[1].lower()
+            assets.append({
+                'uri': args.prefix.rstrip('/') + '/' + rel,
+                'name': c_name(rel),
+                'mime': MIME_TYPES.get(ext, '"application/octet-stream"'),
+                'body': body,
+                'etag': zlib.crc32(body) & 0xFFFFFFFF,
+                'gzipped': gzipped,
+                'raw_len': len(raw),
+            })
+
+    if not assets:
+        sys.stderr.write('no files in %s\n' % args.web_dir)
+        return 1
+
+    out = HEADER % {'name': os.path.basename(args.output),
+                    'src': os.path.basename(os.path.normpath(args.web_dir))}
+    for a in assets:
+        out += '/* %s: %d -> %d bytes */\n' % (a['uri'], a['raw_len'], len(a['body']))
+        out += c_array(a['name'], a['body'])
+
+    out += 'const httpd_static_asset_t %s[] = {\n' % args.table
+    for a in assets:
+        out += '  { "%s", %s, %s, sizeof(%s), 0x%08X, %s },\n' % (
+            a['uri'], a['mime'], a['name'], a['name'], a['etag'],
+            'true' if a['gzipped'] else 'false')
+    out += '};\n\n'
+    out += 'const int %s_num = sizeof(%s) / sizeof(%s[0]);\n' % ((args.table,) * 3)
+
+    with open(args.output, 'w') as f:
+        f.write(out)
+
+    raw_total = sum(a['raw_len'] for a in assets)
+    out_total = sum(len(a['body']) for a in assets)
+    print('%d assets, %d -> %d bytes' % (len(assets), raw_total, out_total))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
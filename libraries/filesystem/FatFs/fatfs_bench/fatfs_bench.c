@@ -0,0 +1,313 @@
+/**
+******************************************************************************
+* @file    fatfs_bench.c
+* @version V1.0.0
+* @brief   Host benchmark of the FatFs cluster allocator. Formats a FAT32
+*          image through the file_diskio driver, fragments it, then appends
+*          a log until the volume is full and reports the time and FAT
+*          sector reads per cluster allocation and of f_getfree after mount.
+*          The contents are read back and checked, and the image checksum
+*          must not depend on _FS_FATCACHE and _FS_FREEMAP.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ff_gen_drv.h"
+#include "file_diskio.h"
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define CLUSTER_SIZE        1024
+#define MAX_FILES           1024
+#define FILL_PERCENT        90      /* Of the volume filled before the deletes */
+#define DELETE_EVERY        3       /* Every third file is deleted */
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+static FATFS    fs;
+static char     drive[4];
+static DWORD    file_size[MAX_FILES];
+static uint8_t  buf[CLUSTER_SIZE];
+static uint32_t rng = 0x2545F491;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static uint64_t now_ns( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint32_t next_rand( void )
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/* Contents of file n at offset ofs, so that every byte can be checked */
+static void pattern( uint8_t* p, unsigned n, DWORD ofs, UINT len )
+{
+    UINT i;
+
+    for ( i = 0; i < len; i++, ofs++ )
+    {
+        p[i] = (uint8_t)( n * 131 + ofs * 7 + ( ofs >> 10 ) );
+    }
+}
+
+static void file_name( char* name, unsigned n )
+{
+    if ( n == MAX_FILES )
+        sprintf( name, "%sLOG.TXT", drive );
+    else
+        sprintf( name, "%sF%04u.BIN", drive, n );
+}
+
+static int fail( const char* what, FRESULT res )
+{
+    printf( "  %-44s FAILED (%d)\n", what, (int)res );
+    return 1;
+}
+
+static FRESULT remount( void )
+{
+    f_mount( NULL, drive, 0 );
+    return f_mount( &fs, drive, 1 );
+}
+
+static FRESULT write_file( unsigned n, DWORD size )
+{
+    static FIL fil; /* The slack after the last byte comes from fil.buf, keep it repeatable */
+    FRESULT res;
+    DWORD ofs;
+    UINT len, bw;
+    char name[16];
+
+    file_name( name, n );
+    res = f_open( &fil, name, FA_CREATE_ALWAYS | FA_WRITE );
+    if ( res != FR_OK ) return res;
+    for ( ofs = 0; ofs < size && res == FR_OK; ofs += len )
+    {
+        len = ( size - ofs < CLUSTER_SIZE ) ? (UINT)( size - ofs ) : CLUSTER_SIZE;
+        pattern( buf, n, ofs, len );
+        res = f_write( &fil, buf, len, &bw );
+        if ( res == FR_OK && bw != len ) res = FR_DENIED;
+    }
+    if ( res == FR_OK ) res = f_close( &fil );
+    return res;
+}
+
+static FRESULT check_file( unsigned n, DWORD size )
+{
+    uint8_t expected[CLUSTER_SIZE];
+    FIL fil;
+    FRESULT res;
+    DWORD ofs;
+    UINT len, br;
+    char name[16];
+
+    file_name( name, n );
+    res = f_open( &fil, name, FA_READ );
+    if ( res != FR_OK ) return res;
+    if ( f_size( &fil ) != size ) res = FR_INT_ERR;
+    for ( ofs = 0; ofs < size && res == FR_OK; ofs += len )
+    {
+        len = ( size - ofs < CLUSTER_SIZE ) ? (UINT)( size - ofs ) : CLUSTER_SIZE;
+        res = f_read( &fil, buf, len, &br );
+        pattern( expected, n, ofs, len );
+        if ( res == FR_OK && ( br != len || memcmp( buf, expected, len ) ) ) res = FR_INT_ERR;
+    }
+    f_close( &fil );
+    return res;
+}
+
+/* FNV-1a of the whole image */
+static uint64_t image_checksum( const char* path )
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    uint8_t block[4096];
+    size_t n, i;
+    FILE* f = fopen( path, "rb" );
+
+    if ( f == NULL ) return 0;
+    while ( ( n = fread( block, 1, sizeof block, f ) ) > 0 )
+    {
+        for ( i = 0; i < n; i++ )
+        {
+            h = ( h ^ block[i] ) * 0x100000001b3ull;
+        }
+    }
+    fclose( f );
+    return h;
+}
+
+static void usage( void )
+{
+    printf( "fatfs_bench [-s MB] [-f image] [-k]\n"
+            "  -s MB     size of the image, default 128 (FAT32), below 64 FAT16\n"
+            "  -f image  image file, default fatfs_bench.img\n"
+            "  -k        keep the image\n" );
+}
+
+int main( int argc, char** argv )
+{
+    const char* image = "fatfs_bench.img";
+    unsigned mb = 128, files, n, keep = 0;
+    DWORD nclst, total, size, clusters;
+    uint64_t t, dt, sum = 0, worst = 0;
+    uint32_t fat_reads;
+    FATFS* pfs;
+    FRESULT res;
+    static FIL log;
+    UINT bw;
+    char name[16];
+    int opt;
+
+    while ( ( opt = getopt( argc, argv, "s:f:kh" ) ) != -1 )
+    {
+        switch ( opt )
+        {
+            case 's': mb = (unsigned)atoi( optarg ); break;
+            case 'f': image = optarg; break;
+            case 'k': keep = 1; break;
+            default: usage( ); return 2;
+        }
+    }
+
+    printf( "FatFs R0.10, _FS_FATCACHE %d, _FS_FREEMAP %d, %u MB image, %u B clusters\n",
+            _FS_FATCACHE, _FS_FREEMAP, mb, CLUSTER_SIZE );
+
+    remove( image );
+    if ( FILEDISK_SetImage( image, (DWORD)mb * 2048 ) != 0 || FATFS_LinkDriver( &FILEDISK_Driver, drive ) != 0 )
+    {
+        printf( "cannot create %s\n", image );
+        return 1;
+    }
+
+    /* Format and fill with files of 16 to 1024 clusters */
+    f_mount( &fs, drive, 0 );
+    res = f_mkfs( drive, 0, CLUSTER_SIZE );
+    if ( res != FR_OK ) return fail( "f_mkfs", res );
+    res = remount( );
+    if ( res == FR_OK ) res = f_getfree( drive, &nclst, &pfs );
+    if ( res != FR_OK ) return fail( "f_mount", res );
+    printf( "  FAT%d, %lu FAT sectors\n", fs.fs_type == FS_FAT32 ? 32 : fs.fs_type == FS_FAT16 ? 16 : 12, (unsigned long)fs.fsize );
+    total = fs.n_fatent - 2;
+    FILEDISK_Watch( fs.fatbase, fs.fsize * fs.n_fats );
+
+    for ( files = 0, clusters = 0; files < MAX_FILES && clusters < total / 100 * FILL_PERCENT; files++ )
+    {
+        size = ( 16 + next_rand( ) % 1009 ) * CLUSTER_SIZE - next_rand( ) % CLUSTER_SIZE;
+        res = write_file( files, size );
+        if ( res != FR_OK ) return fail( "fill", res );
+        file_size[files] = size;
+        clusters += ( size + CLUSTER_SIZE - 1 ) / CLUSTER_SIZE;
+    }
+    for ( n = 0; n < files; n += DELETE_EVERY )
+    {
+        file_name( name, n );
+        res = f_unlink( name );
+        if ( res != FR_OK ) return fail( "f_unlink", res );
+        clusters -= ( file_size[n] + CLUSTER_SIZE - 1 ) / CLUSTER_SIZE;
+        file_size[n] = 0;
+    }
+    printf( "  %u files, %u deleted, %lu of %lu clusters in use\n",
+            files, ( files + DELETE_EVERY - 1 ) / DELETE_EVERY, (unsigned long)clusters, (unsigned long)total );
+
+    /* Free space after mount, FSINFO is not trusted (_FS_NOFSINFO). Every
+       mount is followed by f_getfree, so that all builds keep FSINFO up to
+       date (the free map counts on the first allocation otherwise) and
+       start allocating at the same cluster */
+    res = remount( );
+    if ( res != FR_OK ) return fail( "f_mount", res );
+    FILEDISK_ResetStats( );
+    t = now_ns( );
+    res = f_getfree( drive, &nclst, &pfs );
+    dt = now_ns( ) - t;
+    if ( res != FR_OK ) return fail( "f_getfree", res );
+    printf( "  f_getfree: %lu free, %.1f us, %u FAT sector reads\n",
+            (unsigned long)nclst, dt / 1000.0, (unsigned)FILEDISK_Stats.watch_reads );
+    if ( fs.fs_type == FS_FAT32 ) clusters += files * 32 / CLUSTER_SIZE + 1; /* The root directory */
+    if ( nclst != total - clusters )
+        return fail( "free clusters", FR_INT_ERR );
+
+    /* Append a log a cluster at a time until the volume is full */
+    file_name( name, MAX_FILES );
+    res = f_open( &log, name, FA_CREATE_ALWAYS | FA_WRITE );
+    if ( res != FR_OK ) return fail( "f_open", res );
+    FILEDISK_ResetStats( );
+    for ( size = 0;; size += bw )
+    {
+        pattern( buf, MAX_FILES, size, CLUSTER_SIZE );
+        t = now_ns( );
+        res = f_write( &log, buf, CLUSTER_SIZE, &bw );
+        dt = now_ns( ) - t;
+        if ( res != FR_OK ) return fail( "f_write", res );
+        if ( bw != CLUSTER_SIZE ) break;
+        sum += dt;
+        if ( dt > worst ) worst = dt;
+    }
+    fat_reads = FILEDISK_Stats.watch_reads;
+    res = f_close( &log );
+    if ( res != FR_OK ) return fail( "f_close", res );
+    n = size / CLUSTER_SIZE;
+    printf( "  log of %u clusters: %.2f us per allocation, %.1f us max, %u FAT sector reads\n",
+            n, n ? sum / 1000.0 / n : 0.0, worst / 1000.0, (unsigned)fat_reads );
+
+    res = remount( );
+    if ( res == FR_OK ) res = f_getfree( drive, &nclst, &pfs );
+    if ( res != FR_OK ) return fail( "f_getfree", res );
+
+    /* Every byte back, and nothing left on the volume */
+    for ( n = 0; n < files; n++ )
+    {
+        if ( file_size[n] != 0 && ( res = check_file( n, file_size[n] ) ) != FR_OK ) return fail( "read back", res );
+    }
+    res = check_file( MAX_FILES, size );
+    if ( res != FR_OK ) return fail( "read back log", res );
+    if ( nclst != 0 ) return fail( "volume full", FR_INT_ERR );
+    printf( "  %-44s ok\n", "read back" );
+
+    f_mount( NULL, drive, 0 );
+    FATFS_UnLinkDriver( drive );
+    FILEDISK_SetImage( NULL, 0 );
+    printf( "  image checksum %016llx\n", (unsigned long long)image_checksum( image ) );
+    if ( !keep ) remove( image );
+    return 0;
+}
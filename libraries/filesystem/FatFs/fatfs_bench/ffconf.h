@@ -0,0 +1,52 @@
+/*---------------------------------------------------------------------------/
+/  FatFs configuration of fatfs_bench, the host build of FatFs R0.10.
+/  See ../src/ffconf_template.h for the meaning of the options.
+/----------------------------------------------------------------------------*/
+#ifndef _FFCONF
+#define _FFCONF 80960 /* Revision ID */
+
+/* The HAL header of the target provides these to ff_gen_drv.h */
+#include <stdint.h>
+
+/* BSP_SD_* of the SD card simulator, in place of stm32xxx_eval_sd.h */
+#include "sd_sim.h"
+
+#define _FS_TINY             0
+#define _FS_READONLY         0
+#define _FS_MINIMIZE         0
+#define _USE_STRFUNC         0
+#define _USE_MKFS            1
+#define _USE_FASTSEEK        0
+#define _USE_LABEL           0
+#define _USE_FORWARD         0
+
+#define _CODE_PAGE           1252
+#define _USE_LFN             0  /* No ff_convert() on the host */
+#define _MAX_LFN             255
+#define _LFN_UNICODE         0
+#define _STRF_ENCODE         3
+#define _FS_RPATH            0
+
+#define _VOLUMES             1
+#define _MULTI_PARTITION     0
+#define _MAX_SS              512
+#define _USE_ERASE           0
+#define _FS_NOFSINFO         1  /* f_getfree after mount counts the FAT */
+
+/* Set from the Makefile, make FATCACHE=8 FREEMAP=1024 */
+#ifndef _FS_FATCACHE
+#define _FS_FATCACHE         0
+#endif
+#ifndef _FS_FREEMAP
+#define _FS_FREEMAP          0
+#endif
+
+#define _WORD_ACCESS         0
+
+#define _FS_REENTRANT        0  /* Single threaded */
+#define _FS_TIMEOUT          1000
+#define _SYNC_t              void*
+
+#define _FS_LOCK             0
+
+#endif /* _FFCONFIG */
@@ -0,0 +1,203 @@
+/**
+******************************************************************************
+* @file    sd_bench.c
+* @version V1.0.0
+* @brief   Host benchmark of src/drivers/sd_diskio.c on the SD card
+*          simulator of sd_sim.c: throughput and CPU time of disk_read and
+*          disk_write per request size, for word aligned buffers and for
+*          buffers that go through the bounce buffers. The data of both
+*          paths is checked against each other first.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ff_gen_drv.h"
+#include "sd_diskio.h"
+
+/******************************************************
+*                    Constants
+******************************************************/
+
+#define BLOCK_SIZE          512
+#define MAX_COUNT           128     /* Sectors per request, the BYTE count of diskio */
+#define CARD_SECTORS        16384   /* 8 MB */
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+/* One spare word in front, so that buf + 1 is not aligned */
+static uint32_t  buf_words[MAX_COUNT * BLOCK_SIZE / 4 + 1];
+static uint32_t  ref_words[MAX_COUNT * BLOCK_SIZE / 4 + 1];
+static unsigned  bench_ms = 200;
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static uint64_t clock_ns( clockid_t id )
+{
+    struct timespec ts;
+    clock_gettime( id, &ts );
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int check( const char* name, int ok )
+{
+    printf( "  %-44s %s\n", name, ok ? "ok" : "FAILED" );
+    return ok ? 0 : 1;
+}
+
+/* Writes through one path and reads back through both */
+static int self_check( void )
+{
+    uint8_t* aligned = (uint8_t*)buf_words;
+    uint8_t* unaligned = (uint8_t*)buf_words + 1;
+    uint8_t* ref = (uint8_t*)ref_words;
+    int fails = 0, i;
+    BYTE count = 37;        /* Not a multiple of the bounce buffers */
+
+    for ( i = 0; i < count * BLOCK_SIZE; i++ ) ref[i] = (uint8_t)( i * 7 + ( i >> 9 ) );
+
+    memcpy( unaligned, ref, count * BLOCK_SIZE );
+    fails += check( "unaligned write", disk_write( 0, unaligned, 100, count ) == RES_OK );
+    memset( aligned, 0, count * BLOCK_SIZE );
+    fails += check( "aligned read back", disk_read( 0, aligned, 100, count ) == RES_OK &&
+                    memcmp( aligned, ref, count * BLOCK_SIZE ) == 0 );
+    memset( buf_words, 0, sizeof buf_words );
+    fails += check( "unaligned read back", disk_read( 0, unaligned, 100, count ) == RES_OK &&
+                    memcmp( unaligned, ref, count * BLOCK_SIZE ) == 0 );
+
+    for ( i = 0; i < count * BLOCK_SIZE; i++ ) ref[i] ^= 0x5A;
+    memcpy( aligned, ref, count * BLOCK_SIZE );
+    fails += check( "aligned write", disk_write( 0, aligned, 300, count ) == RES_OK );
+    memset( buf_words, 0, sizeof buf_words );
+    fails += check( "unaligned read back", disk_read( 0, unaligned, 300, count ) == RES_OK &&
+                    memcmp( unaligned, ref, count * BLOCK_SIZE ) == 0 );
+    fails += check( "CTRL_SYNC", disk_ioctl( 0, CTRL_SYNC, NULL ) == RES_OK );
+    fails += check( "no unaligned DMA", sd_sim_stats.unaligned == 0 );
+    return fails;
+}
+
+/* MB/s and % of the elapsed time the calling thread was on the CPU */
+static void run( int write, int aligned, BYTE count, double* mbs, double* cpu, double* cmds )
+{
+    BYTE* p = aligned ? (BYTE*)buf_words : (BYTE*)buf_words + 1;
+    uint64_t t0, c0, t;
+    uint32_t n = 0, commands = sd_sim_stats.commands;
+    DWORD sector = 0;
+    DRESULT res;
+
+    t0 = clock_ns( CLOCK_MONOTONIC );
+    c0 = clock_ns( CLOCK_THREAD_CPUTIME_ID );
+    do
+    {
+        res = write ? disk_write( 0, p, sector, count ) : disk_read( 0, p, sector, count );
+        if ( res != RES_OK )
+        {
+            printf( "disk_%s failed\n", write ? "write" : "read" );
+            exit( 1 );
+        }
+        sector = ( sector + count ) % ( CARD_SECTORS - MAX_COUNT );
+        n++;
+        t = clock_ns( CLOCK_MONOTONIC ) - t0;
+    } while ( t < bench_ms * 1000000ull );
+    if ( write ) disk_ioctl( 0, CTRL_SYNC, NULL );
+    t = clock_ns( CLOCK_MONOTONIC ) - t0;
+
+    *mbs = (double)n * count * BLOCK_SIZE / ( t / 1e9 ) / 1e6;
+    *cpu = 100.0 * ( clock_ns( CLOCK_THREAD_CPUTIME_ID ) - c0 ) / t;
+    *cmds = (double)( sd_sim_stats.commands - commands ) / n;
+}
+
+static void usage( void )
+{
+    printf( "sd_bench [-c us] [-s us] [-p us] [-q us] [-t ms] [-k]\n"
+            "  -c us   command and access latency, default 100\n"
+            "  -s us   bus time per sector, default 40 (12.8 MB/s)\n"
+            "  -p us   busy time after a write command, default 250\n"
+            "  -q us   time of a status poll, default 8\n"
+            "  -t ms   time per measurement, default 200\n"
+            "  -k      self check only\n" );
+}
+
+int main( int argc, char** argv )
+{
+    static const BYTE counts[] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+    sd_sim_config_t config = { CARD_SECTORS, 100, 40, 250, 8, !SD_DMA_CALLBACKS };
+    double mbs, cpu, cmds;
+    char drive[4];
+    int opt, check_only = 0, write, aligned;
+    unsigned i;
+
+    while ( ( opt = getopt( argc, argv, "c:s:p:q:t:kh" ) ) != -1 )
+    {
+        switch ( opt )
+        {
+            case 'c': config.command_us = (uint32_t)atoi( optarg ); break;
+            case 's': config.sector_us = (uint32_t)atoi( optarg ); break;
+            case 'p': config.program_us = (uint32_t)atoi( optarg ); break;
+            case 'q': config.status_us = (uint32_t)atoi( optarg ); break;
+            case 't': bench_ms = (unsigned)atoi( optarg ); break;
+            case 'k': check_only = 1; break;
+            default: usage( ); return 2;
+        }
+    }
+
+    if ( sd_sim_init( &config ) != 0 || FATFS_LinkDriver( &SD_Driver, drive ) != 0 ||
+         ( disk_initialize( 0 ) & STA_NOINIT ) )
+    {
+        printf( "no SD card\n" );
+        return 1;
+    }
+
+    printf( "sd_diskio, SD_BOUNCE_SECTORS %d, card: %u us per command, %u us per sector, %u us programming%s\n",
+            SD_BOUNCE_SECTORS, (unsigned)config.command_us, (unsigned)config.sector_us, (unsigned)config.program_us,
+            config.blocking ? ", SD_DMA_CALLBACKS 0, status polls" : ", SD_DMA_CALLBACKS 1" );
+    if ( self_check( ) != 0 ) return 1;
+    if ( check_only ) return 0;
+
+    for ( write = 0; write < 2; write++ )
+    {
+        printf( "\n  disk_%-5s          aligned                  unaligned\n", write ? "write" : "read" );
+        printf( "  sectors     MB/s   cpu%%  cmds       MB/s   cpu%%  cmds\n" );
+        for ( i = 0; i < sizeof counts; i++ )
+        {
+            printf( "  %7u", counts[i] );
+            for ( aligned = 1; aligned >= 0; aligned-- )
+            {
+                run( write, aligned, counts[i], &mbs, &cpu, &cmds );
+                printf( "  %7.2f  %5.1f  %4.1f  ", mbs, cpu, cmds );
+            }
+            printf( "\n" );
+        }
+    }
+    return 0;
+}
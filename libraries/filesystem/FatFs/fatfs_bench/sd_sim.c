@@ -0,0 +1,202 @@
+/**
+******************************************************************************
+* @file    sd_sim.c
+* @version V1.0.0
+* @brief   SD card simulator for the host, see sd_sim.h. The card is a RAM
+*          image. A transfer starts when the card is idle, its data moves
+*          at command_us + n * sector_us, then the completion callback runs
+*          on the card thread and a write keeps the card busy for another
+*          program_us. A status poll spins for status_us, the time of a
+*          CMD13 on the bus. A blocking card makes the start of a transfer
+*          wait for its data instead of the callback, the callbacks are
+*          only built with SD_DMA_CALLBACKS=1 as those of sd_diskio.c.
+******************************************************************************
+*/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sd_sim.h"
+
+#define SD_SIM_BLOCK_SIZE 512
+
+#if SD_DMA_CALLBACKS == 1
+void BSP_SD_ReadCpltCallback( void );
+void BSP_SD_WriteCpltCallback( void );
+#endif
+
+/******************************************************
+*               Variables Definitions
+******************************************************/
+
+sd_sim_stats_t sd_sim_stats;
+
+static sd_sim_config_t card;
+static uint8_t*        image;
+
+static pthread_t       card_thread;
+static pthread_mutex_t card_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  card_cond;
+
+/* The command in progress */
+static int             pending;   /* 0: none, 1: read, 2: write */
+static uint8_t*        data;
+static uint64_t        address;
+static uint32_t        blocks;
+static struct timespec ready;     /* The card is busy until then */
+
+/******************************************************
+*               Function Definitions
+******************************************************/
+
+static void add_us( struct timespec* ts, uint64_t us )
+{
+    uint64_t ns = (uint64_t)ts->tv_nsec + us * 1000;
+    ts->tv_sec += ns / 1000000000;
+    ts->tv_nsec = ns % 1000000000;
+}
+
+static int after( const struct timespec* a, const struct timespec* b )
+{
+    return a->tv_sec > b->tv_sec || ( a->tv_sec == b->tv_sec && a->tv_nsec > b->tv_nsec );
+}
+
+static void* card_main( void* arg )
+{
+    struct timespec t;
+    int op;
+
+    (void)arg;
+    pthread_mutex_lock( &card_mutex );
+    for ( ;; )
+    {
+        while ( !pending )
+            pthread_cond_wait( &card_cond, &card_mutex );
+        op = pending;
+
+        /* Command, then the data on the bus */
+        clock_gettime( CLOCK_MONOTONIC, &t );
+        if ( after( &ready, &t ) ) t = ready;
+        add_us( &t, card.command_us + (uint64_t)blocks * card.sector_us );
+        pthread_mutex_unlock( &card_mutex );
+        while ( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL ) != 0 );
+        pthread_mutex_lock( &card_mutex );
+
+        if ( op == 1 )
+            memcpy( data, image + address, blocks * SD_SIM_BLOCK_SIZE );
+        else
+            memcpy( image + address, data, blocks * SD_SIM_BLOCK_SIZE );
+        ready = t;
+        if ( op == 2 ) add_us( &ready, card.program_us );
+        pending = 0;
+
+        if ( card.blocking )
+        {
+            pthread_cond_broadcast( &card_cond );
+            continue;
+        }
+
+#if SD_DMA_CALLBACKS == 1
+        /* The DMA interrupt */
+        pthread_mutex_unlock( &card_mutex );
+        if ( op == 1 )
+            BSP_SD_ReadCpltCallback( );
+        else
+            BSP_SD_WriteCpltCallback( );
+        pthread_mutex_lock( &card_mutex );
+#endif
+    }
+    return NULL;
+}
+
+int sd_sim_init( const sd_sim_config_t* config )
+{
+    pthread_condattr_t attr;
+
+    card = *config;
+    image = calloc( card.sectors, SD_SIM_BLOCK_SIZE );
+    if ( image == NULL ) return -1;
+
+    pthread_condattr_init( &attr );
+    pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+    pthread_cond_init( &card_cond, &attr );
+    pthread_condattr_destroy( &attr );
+    clock_gettime( CLOCK_MONOTONIC, &ready );
+    return pthread_create( &card_thread, NULL, card_main, NULL );
+}
+
+static uint8_t start( int op, uint32_t* pData, uint64_t addr, uint32_t BlockSize, uint32_t NumOfBlocks )
+{
+    uint8_t ret = MSD_OK;
+
+    if ( ( (uintptr_t)pData & 3 ) != 0 )
+    {
+        sd_sim_stats.unaligned++;
+        return MSD_ERROR;
+    }
+    if ( BlockSize != SD_SIM_BLOCK_SIZE || NumOfBlocks == 0 ||
+         addr / SD_SIM_BLOCK_SIZE + NumOfBlocks > card.sectors )
+        return MSD_ERROR;
+
+    pthread_mutex_lock( &card_mutex );
+    if ( pending )
+        ret = MSD_ERROR;
+    else
+    {
+        pending = op;
+        data = (uint8_t*)pData;
+        address = addr;
+        blocks = NumOfBlocks;
+        sd_sim_stats.commands++;
+        if ( op == 1 )
+            sd_sim_stats.read_sectors += NumOfBlocks;
+        else
+            sd_sim_stats.write_sectors += NumOfBlocks;
+        pthread_cond_broadcast( &card_cond );
+        while ( card.blocking && pending )
+            pthread_cond_wait( &card_cond, &card_mutex );
+    }
+    pthread_mutex_unlock( &card_mutex );
+    return ret;
+}
+
+uint8_t BSP_SD_Init( void )
+{
+    return image != NULL ? MSD_OK : MSD_ERROR;
+}
+
+uint8_t BSP_SD_ReadBlocks_DMA( uint32_t* pData, uint64_t ReadAddr, uint32_t BlockSize, uint32_t NumOfBlocks )
+{
+    return start( 1, pData, ReadAddr, BlockSize, NumOfBlocks );
+}
+
+uint8_t BSP_SD_WriteBlocks_DMA( uint32_t* pData, uint64_t WriteAddr, uint32_t BlockSize, uint32_t NumOfBlocks )
+{
+    return start( 2, pData, WriteAddr, BlockSize, NumOfBlocks );
+}
+
+HAL_SD_TransferStateTypedef BSP_SD_GetStatus( void )
+{
+    HAL_SD_TransferStateTypedef state = SD_TRANSFER_OK;
+    struct timespec now, done;
+
+    clock_gettime( CLOCK_MONOTONIC, &done );
+    add_us( &done, card.status_us );
+    do
+        clock_gettime( CLOCK_MONOTONIC, &now );
+    while ( after( &done, &now ) );
+
+    pthread_mutex_lock( &card_mutex );
+    sd_sim_stats.status_polls++;
+    if ( pending || after( &ready, &now ) ) state = SD_TRANSFER_BUSY;
+    pthread_mutex_unlock( &card_mutex );
+    return state;
+}
+
+void BSP_SD_GetCardInfo( HAL_SD_CardInfoTypedef* CardInfo )
+{
+    CardInfo->CardCapacity = (uint64_t)card.sectors * SD_SIM_BLOCK_SIZE;
+    CardInfo->CardBlockSize = SD_SIM_BLOCK_SIZE;
+}
@@ -0,0 +1,66 @@
+/**
+******************************************************************************
+* @file    sd_sim.h
+* @version V1.0.0
+* @brief   SD card simulator for the host: the BSP_SD_* calls that
+*          src/drivers/sd_diskio.c makes on the target, with a card thread
+*          that takes the configured time per command, per sector and for
+*          programming after a write, then calls the transfer complete
+*          callbacks like the SDIO/DMA interrupt would.
+******************************************************************************
+*/
+
+#ifndef __SD_SIM_H__
+#define __SD_SIM_H__
+
+#include <stdint.h>
+
+/* The BSP_SD_* interface of the STM32 eval board BSP */
+#define MSD_OK          0x00
+#define MSD_ERROR       0x01
+
+typedef enum
+{
+  SD_TRANSFER_OK    = 0,
+  SD_TRANSFER_BUSY  = 1,
+  SD_TRANSFER_ERROR = 2
+} HAL_SD_TransferStateTypedef;
+
+typedef struct
+{
+  uint64_t CardCapacity;  /* Card capacity in bytes */
+  uint32_t CardBlockSize; /* Card block size in bytes */
+} HAL_SD_CardInfoTypedef;
+
+uint8_t BSP_SD_Init( void );
+uint8_t BSP_SD_ReadBlocks_DMA( uint32_t* pData, uint64_t ReadAddr, uint32_t BlockSize, uint32_t NumOfBlocks );
+uint8_t BSP_SD_WriteBlocks_DMA( uint32_t* pData, uint64_t WriteAddr, uint32_t BlockSize, uint32_t NumOfBlocks );
+HAL_SD_TransferStateTypedef BSP_SD_GetStatus( void );
+void BSP_SD_GetCardInfo( HAL_SD_CardInfoTypedef* CardInfo );
+
+/* Simulator */
+typedef struct
+{
+  uint32_t sectors;       /* Card size */
+  uint32_t command_us;    /* Command and access latency of every transfer */
+  uint32_t sector_us;     /* Bus time of a 512 byte sector */
+  uint32_t program_us;    /* Busy time after the data of a write */
+  uint32_t status_us;     /* Time of a status poll (CMD13) */
+  uint32_t blocking;      /* BSP_SD_*_DMA return when the data is moved and
+                             call no completion callback, as the ST BSP */
+} sd_sim_config_t;
+
+typedef struct
+{
+  uint32_t commands;      /* Single and multi-block commands */
+  uint32_t read_sectors;
+  uint32_t write_sectors;
+  uint32_t unaligned;     /* DMA requests refused for an unaligned buffer */
+  uint32_t status_polls;
+} sd_sim_stats_t;
+
+extern sd_sim_stats_t sd_sim_stats;
+
+int sd_sim_init( const sd_sim_config_t* config );
+
+#endif /* __SD_SIM_H__ */
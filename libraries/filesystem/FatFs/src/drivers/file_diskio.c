@@ -0,0 +1,252 @@
+/**
+  ******************************************************************************
+  * @file    file_diskio.c
+  * @brief   Disk I/O driver on top of a disk image in a host file, for
+  *          running FatFs and its benchmarks off target. The image is
+  *          picked with FILEDISK_SetImage() before f_mount, and the sector
+  *          traffic is counted in FILEDISK_Stats.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "file_diskio.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/* Private define ------------------------------------------------------------*/
+/* Block Size in Bytes */
+#define BLOCK_SIZE                512
+
+/* Private variables ---------------------------------------------------------*/
+/* Disk status */
+static volatile DSTATUS Stat = STA_NOINIT;
+
+static char  ImagePath[256];
+static DWORD ImageSectors;
+static FILE *Image;
+static DWORD WatchSector, WatchCount;
+
+FILEDISK_StatsTypeDef  FILEDISK_Stats;
+
+/* Private function prototypes -----------------------------------------------*/
+DSTATUS FILEDISK_initialize (void);
+DSTATUS FILEDISK_status (void);
+DRESULT FILEDISK_read (BYTE*, DWORD, BYTE);
+#if _USE_WRITE == 1
+  DRESULT FILEDISK_write (const BYTE*, DWORD, BYTE);
+#endif /* _USE_WRITE == 1 */
+#if _USE_IOCTL == 1
+  DRESULT FILEDISK_ioctl (BYTE, void*);
+#endif /* _USE_IOCTL == 1 */
+
+Diskio_drvTypeDef  FILEDISK_Driver =
+{
+  FILEDISK_initialize,
+  FILEDISK_status,
+  FILEDISK_read,
+#if  _USE_WRITE == 1
+  FILEDISK_write,
+#endif /* _USE_WRITE == 1 */
+#if  _USE_IOCTL == 1
+  FILEDISK_ioctl,
+#endif /* _USE_IOCTL == 1 */
+};
+
+/* Private functions ---------------------------------------------------------*/
+
+/* Sectors of [sector, sector + count) that fall inside the watch range */
+static uint32_t FILEDISK_Watched(DWORD sector, BYTE count)
+{
+  DWORD first = sector > WatchSector ? sector : WatchSector;
+  DWORD last = sector + count;
+
+  if (last > WatchSector + WatchCount) last = WatchSector + WatchCount;
+  return last > first ? last - first : 0;
+}
+
+/**
+  * @brief  Selects the image file, created or extended to the given size
+  * @param  path: Image file name, NULL only closes the current one
+  * @param  sectors: Size of the disk in sectors, 0 keeps the size of the file
+  * @retval Returns 0 in case of success, otherwise 1.
+  */
+uint8_t FILEDISK_SetImage(const char *path, DWORD sectors)
+{
+  static const BYTE zero = 0;
+  long size;
+
+  if (Image != NULL)
+  {
+    fclose(Image);
+    Image = NULL;
+  }
+  Stat = STA_NOINIT;
+  ImageSectors = 0;
+
+  if (path == NULL) return 0;
+  if (strlen(path) >= sizeof(ImagePath)) return 1;
+  strcpy(ImagePath, path);
+
+  Image = fopen(ImagePath, "r+b");
+  if (Image == NULL) Image = fopen(ImagePath, "w+b");
+  if (Image == NULL) return 1;
+
+  if (fseek(Image, 0, SEEK_END) != 0 || (size = ftell(Image)) < 0) return 1;
+  if (sectors == 0)
+  {
+    sectors = (DWORD)(size / BLOCK_SIZE);
+  }
+  else if ((DWORD)(size / BLOCK_SIZE) < sectors)
+  {
+    /* Extend with a single byte at the end, the hole reads as zeros */
+    if (fseek(Image, (long)sectors * BLOCK_SIZE - 1, SEEK_SET) != 0 ||
+        fwrite(&zero, 1, 1, Image) != 1) return 1;
+  }
+  ImageSectors = sectors;
+  return 0;
+}
+
+/**
+  * @brief  Counts the sectors of a range separately, e.g. the FAT
+  * @param  sector: First sector of the range
+  * @param  count: Number of sectors, 0 stops watching
+  * @retval None
+  */
+void FILEDISK_Watch(DWORD sector, DWORD count)
+{
+  WatchSector = sector;
+  WatchCount = count;
+}
+
+/**
+  * @brief  Clears FILEDISK_Stats
+  * @param  None
+  * @retval None
+  */
+void FILEDISK_ResetStats(void)
+{
+  memset(&FILEDISK_Stats, 0, sizeof(FILEDISK_Stats));
+}
+
+/**
+  * @brief  Initializes a Drive
+  * @param  None
+  * @retval DSTATUS: Operation status
+  */
+DSTATUS FILEDISK_initialize(void)
+{
+  Stat = STA_NOINIT;
+
+  if (Image != NULL && ImageSectors != 0)
+  {
+    Stat &= ~STA_NOINIT;
+  }
+  return Stat;
+}
+
+/**
+  * @brief  Gets Disk Status
+  * @param  None
+  * @retval DSTATUS: Operation status
+  */
+DSTATUS FILEDISK_status(void)
+{
+  return Stat;
+}
+
+/**
+  * @brief  Reads Sector(s)
+  * @param  *buff: Data buffer to store read data
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to read (1..128)
+  * @retval DRESULT: Operation result
+  */
+DRESULT FILEDISK_read(BYTE *buff, DWORD sector, BYTE count)
+{
+  if (Stat & STA_NOINIT) return RES_NOTRDY;
+  if (sector + count > ImageSectors) return RES_PARERR;
+
+  if (fseek(Image, (long)sector * BLOCK_SIZE, SEEK_SET) != 0 ||
+      fread(buff, BLOCK_SIZE, count, Image) != count)
+  {
+    return RES_ERROR;
+  }
+
+  FILEDISK_Stats.reads++;
+  FILEDISK_Stats.read_sectors += count;
+  FILEDISK_Stats.watch_reads += FILEDISK_Watched(sector, count);
+  return RES_OK;
+}
+
+/**
+  * @brief  Writes Sector(s)
+  * @param  *buff: Data to be written
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to write (1..128)
+  * @retval DRESULT: Operation result
+  */
+#if _USE_WRITE == 1
+DRESULT FILEDISK_write(const BYTE *buff, DWORD sector, BYTE count)
+{
+  if (Stat & STA_NOINIT) return RES_NOTRDY;
+  if (sector + count > ImageSectors) return RES_PARERR;
+
+  if (fseek(Image, (long)sector * BLOCK_SIZE, SEEK_SET) != 0 ||
+      fwrite(buff, BLOCK_SIZE, count, Image) != count)
+  {
+    return RES_ERROR;
+  }
+
+  FILEDISK_Stats.writes++;
+  FILEDISK_Stats.write_sectors += count;
+  FILEDISK_Stats.watch_writes += FILEDISK_Watched(sector, count);
+  return RES_OK;
+}
+#endif /* _USE_WRITE == 1 */
+
+/**
+  * @brief  I/O control operation
+  * @param  cmd: Control code
+  * @param  *buff: Buffer to send/receive control data
+  * @retval DRESULT: Operation result
+  */
+#if _USE_IOCTL == 1
+DRESULT FILEDISK_ioctl(BYTE cmd, void *buff)
+{
+  DRESULT res = RES_ERROR;
+
+  if (Stat & STA_NOINIT) return RES_NOTRDY;
+
+  switch (cmd)
+  {
+  /* Make sure that no pending write process */
+  case CTRL_SYNC :
+    if (fflush(Image) == 0) res = RES_OK;
+    break;
+
+  /* Get number of sectors on the disk (DWORD) */
+  case GET_SECTOR_COUNT :
+    *(DWORD*)buff = ImageSectors;
+    res = RES_OK;
+    break;
+
+  /* Get R/W sector size (WORD) */
+  case GET_SECTOR_SIZE :
+    *(WORD*)buff = BLOCK_SIZE;
+    res = RES_OK;
+    break;
+
+  /* Get erase block size in unit of sector (DWORD) */
+  case GET_BLOCK_SIZE :
+    *(DWORD*)buff = 1;
+    res = RES_OK;
+    break;
+
+  default:
+    res = RES_PARERR;
+  }
+
+  return res;
+}
+#endif /* _USE_IOCTL == 1 */
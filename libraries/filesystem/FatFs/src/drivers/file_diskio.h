@@ -0,0 +1,38 @@
+/**
+  ******************************************************************************
+  * @file    file_diskio.h
+  * @brief   Header for file_diskio.c module
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FILE_DISKIO_H
+#define __FILE_DISKIO_H
+
+/* Includes ------------------------------------------------------------------*/
+#include "ff_gen_drv.h"
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Sector traffic seen by the driver since the last FILEDISK_ResetStats
+  */
+typedef struct
+{
+  uint32_t reads;          /*!< disk_read calls                                */
+  uint32_t writes;         /*!< disk_write calls                               */
+  uint32_t read_sectors;   /*!< Sectors read                                   */
+  uint32_t write_sectors;  /*!< Sectors written                                */
+  uint32_t watch_reads;    /*!< Sectors read inside the FILEDISK_Watch range   */
+  uint32_t watch_writes;   /*!< Sectors written inside the FILEDISK_Watch range*/
+}FILEDISK_StatsTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+extern Diskio_drvTypeDef  FILEDISK_Driver;
+extern FILEDISK_StatsTypeDef  FILEDISK_Stats;
+
+uint8_t FILEDISK_SetImage(const char *path, DWORD sectors);
+void FILEDISK_Watch(DWORD sector, DWORD count);
+void FILEDISK_ResetStats(void);
+
+#endif /* __FILE_DISKIO_H */
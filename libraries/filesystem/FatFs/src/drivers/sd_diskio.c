@@ -28,16 +28,44 @@
 /* Includes ------------------------------------------------------------------*/
 #include <string.h>
 #include "ff_gen_drv.h"
+#include "sd_diskio.h"
+#include "mico_rtos.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 /* Block Size in Bytes */
 #define BLOCK_SIZE                512
 
+/* Sectors in each of the two bounce buffers used for buffers that are not
+   word aligned, i.e. sectors per multi-block command on that path. Both
+   stay in .bss, 1 KB with one sector each */
+#ifndef SD_BOUNCE_SECTORS
+#define SD_BOUNCE_SECTORS         1
+#endif
+
+/* Status polls (CMD13) before the wait for a programming card falls back
+   to sleeping a tick at a time */
+#ifndef SD_READY_POLLS
+#define SD_READY_POLLS            64
+#endif
+
+/* Transfer time out in ms */
+#define SD_TIMEOUT                1000
+
+#define SD_MIN(a, b)              ((a) < (b) ? (a) : (b))
+
 /* Private variables ---------------------------------------------------------*/
 /* Disk status */
 static volatile DSTATUS Stat = STA_NOINIT;
 
+#if SD_DMA_CALLBACKS == 1
+/* Given by the transfer complete callbacks of the BSP */
+static mico_semaphore_t TransferDone = NULL;
+#endif /* SD_DMA_CALLBACKS == 1 */
+
+/* DMA Alignment ensured */
+static DWORD Bounce[2][SD_BOUNCE_SECTORS * BLOCK_SIZE / 4];
+
 /* Private function prototypes -----------------------------------------------*/
 DSTATUS SD_initialize (void);
 DSTATUS SD_status (void);
@@ -65,6 +93,113 @@ Diskio_drvTypeDef  SD_Driver =
 
 /* Private functions ---------------------------------------------------------*/
 
+/**
+  * @brief  Waits until the card has left the programming state of the last
+  *         write, which is left to overlap with whatever comes next
+  * @param  None
+  * @retval DRESULT: Operation result
+  */
+static DRESULT SD_WaitReady(void)
+{
+  uint32_t polls = SD_READY_POLLS;
+  uint32_t timeout = SD_TIMEOUT;
+
+  while (BSP_SD_GetStatus() != SD_TRANSFER_OK)
+  {
+    if (polls != 0)
+    {
+      polls--;
+      continue;
+    }
+    if (timeout-- == 0)
+    {
+      return RES_ERROR;
+    }
+    mico_thread_msleep(1);
+  }
+  return RES_OK;
+}
+
+/**
+  * @brief  Starts a DMA read, with callbacks a completion left over from a
+  *         transfer that timed out must not end the wait for this one
+  * @param  buff: Word aligned buffer
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors
+  * @retval DRESULT: Operation result
+  */
+static DRESULT SD_StartRead(BYTE *buff, DWORD sector, DWORD count)
+{
+#if SD_DMA_CALLBACKS == 1
+  mico_rtos_get_semaphore(&TransferDone, 0);
+#endif
+  if (BSP_SD_ReadBlocks_DMA((uint32_t*)buff, (uint64_t)sector * BLOCK_SIZE, BLOCK_SIZE, count) != MSD_OK)
+  {
+    return RES_ERROR;
+  }
+  return RES_OK;
+}
+
+/**
+  * @brief  Starts a DMA write, see SD_StartRead
+  * @param  buff: Word aligned buffer
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors
+  * @retval DRESULT: Operation result
+  */
+static DRESULT SD_StartWrite(const BYTE *buff, DWORD sector, DWORD count)
+{
+#if SD_DMA_CALLBACKS == 1
+  mico_rtos_get_semaphore(&TransferDone, 0);
+#endif
+  if (BSP_SD_WriteBlocks_DMA((uint32_t*)buff, (uint64_t)sector * BLOCK_SIZE, BLOCK_SIZE, count) != MSD_OK)
+  {
+    return RES_ERROR;
+  }
+  return RES_OK;
+}
+
+/**
+  * @brief  Waits for the DMA transfer started last: for its completion
+  *         callback, or without callbacks for the card back in transfer state
+  * @param  None
+  * @retval DRESULT: Operation result
+  */
+static DRESULT SD_WaitTransfer(void)
+{
+#if SD_DMA_CALLBACKS == 1
+  if (mico_rtos_get_semaphore(&TransferDone, SD_TIMEOUT) != kNoErr)
+  {
+    return RES_ERROR;
+  }
+  return RES_OK;
+#else
+  return SD_WaitReady();
+#endif
+}
+
+#if SD_DMA_CALLBACKS == 1
+/**
+  * @brief  DMA read complete, called by the BSP from the SDIO/DMA interrupt
+  * @param  None
+  * @retval None
+  */
+void BSP_SD_ReadCpltCallback(void)
+{
+  mico_rtos_set_semaphore(&TransferDone);
+}
+
+/**
+  * @brief  DMA write complete, called by the BSP from the SDIO/DMA interrupt
+  * @param  None
+  * @retval None
+  */
+void BSP_SD_WriteCpltCallback(void)
+{
+  mico_rtos_set_semaphore(&TransferDone);
+}
+#endif /* SD_DMA_CALLBACKS == 1 */
+
 /**
   * @brief  Initializes a Drive
   * @param  None
@@ -74,6 +209,13 @@ DSTATUS SD_initialize(void)
 {
   Stat = STA_NOINIT;
   
+#if SD_DMA_CALLBACKS == 1
+  if (TransferDone == NULL && mico_rtos_init_semaphore(&TransferDone, 1) != kNoErr)
+  {
+    return Stat;
+  }
+#endif /* SD_DMA_CALLBACKS == 1 */
+
   /* Configure the uSD device */
   if(BSP_SD_Init() == MSD_OK)
   {
@@ -92,7 +234,8 @@ DSTATUS SD_status(void)
 {
   Stat = STA_NOINIT;
 
-  if(BSP_SD_GetStatus() == 0)
+  /* A card still programming the last write is ready as well */
+  if(BSP_SD_GetStatus() != SD_TRANSFER_ERROR)
   {
     Stat &= ~STA_NOINIT;
   }
@@ -101,7 +244,7 @@ DSTATUS SD_status(void)
 }
 
 /**
-  * @brief  Reads Sector(s)
+  * @brief  Reads Sector(s) 
   * @param  *buff: Data buffer to store read data
   * @param  sector: Sector address (LBA)
   * @param  count: Number of sectors to read (1..128)
@@ -109,44 +252,52 @@ DSTATUS SD_status(void)
   */
 DRESULT SD_read(BYTE *buff, DWORD sector, BYTE count)
 {
-  uint32_t timeout = 100000;
-  DWORD scratch [BLOCK_SIZE / 4];  /* Alignment ensured, need enough stack */
-  uint8_t SD_state = MSD_OK;
-    
-  if ((DWORD)buff & 3) /* DMA Alignment issue, do single up to aligned buffer */
+  DWORD n, next = 0;
+  int i;
+
+  if (SD_WaitReady() != RES_OK)
+  {
+    return RES_ERROR;
+  }
+
+  if (((DWORD)buff & 3) == 0) /* One multi-block command straight into the buffer */
   {
-    while (count--)
+    if (SD_StartRead(buff, sector, count) != RES_OK)
     {
-      SD_state = BSP_SD_ReadBlocks_DMA((uint32_t*)scratch, (uint64_t) ((sector + count) * BLOCK_SIZE), BLOCK_SIZE, 1);
-      
-      while(BSP_SD_GetStatus() != SD_TRANSFER_OK)
-      {
-        if (timeout-- == 0)
-        {
-          return RES_ERROR;
-        }
-      }
-      memcpy (&buff[count * BLOCK_SIZE] ,scratch, BLOCK_SIZE);
+      return RES_ERROR;
     }
+    return SD_WaitTransfer();
   }
-  else
+
+  /* DMA Alignment issue, read through the bounce buffers: the next batch
+     is transferred while the previous one is copied out */
+  n = SD_MIN(count, SD_BOUNCE_SECTORS);
+  if (SD_StartRead((BYTE*)Bounce[0], sector, n) != RES_OK)
+  {
+    return RES_ERROR;
+  }
+  for (i = 0; count != 0; i ^= 1)
   {
-    SD_state = BSP_SD_ReadBlocks_DMA((uint32_t*)buff, (uint64_t) (sector * BLOCK_SIZE), BLOCK_SIZE, count);
-    
-    while(BSP_SD_GetStatus() != SD_TRANSFER_OK)
-    {  
-      if (timeout-- == 0)
+    if (SD_WaitTransfer() != RES_OK)
+    {
+      return RES_ERROR;
+    }
+    sector += n;
+    count -= n;
+    if (count != 0)
+    {
+      next = SD_MIN(count, SD_BOUNCE_SECTORS);
+      if (SD_StartRead((BYTE*)Bounce[i ^ 1], sector, next) != RES_OK)
       {
         return RES_ERROR;
       }
     }
+    memcpy(buff, Bounce[i], n * BLOCK_SIZE);
+    buff += n * BLOCK_SIZE;
+    n = next;
   }
-  if (SD_state == MSD_OK)
-  {
-    return RES_OK;
-  }
-  
-  return RES_ERROR;
+
+  return RES_OK;
 }
 
 /**
@@ -159,45 +310,49 @@ DRESULT SD_read(BYTE *buff, DWORD sector, BYTE count)
 #if _USE_WRITE == 1
 DRESULT SD_write(const BYTE *buff, DWORD sector, BYTE count)
 {
-  uint32_t timeout = 100000;
-  DWORD scratch [BLOCK_SIZE / 4];  /* Alignment ensured, need enough stack */
-  uint8_t SD_state = MSD_OK;
-  
-  if ((DWORD)buff & 3) /* DMA Alignment issue, do single up to aligned buffer */
+  DWORD n, next = 0;
+  int i;
+
+  if (SD_WaitReady() != RES_OK)
   {
-    while (count--)
-    {
-      memcpy (scratch, &buff[count * BLOCK_SIZE], BLOCK_SIZE);  
-      
-      SD_state = BSP_SD_WriteBlocks_DMA((uint32_t*)scratch, (uint64_t)((sector + count) * BLOCK_SIZE), BLOCK_SIZE, 1);
-      
-      while(BSP_SD_GetStatus() != SD_TRANSFER_OK)
-      {
-        if (timeout-- == 0)
-        {
-          return RES_ERROR;
-        }
-      }
-    }
+    return RES_ERROR;
   }
-  else
+
+  if (((DWORD)buff & 3) == 0) /* One multi-block command straight from the buffer */
   {
-    SD_state = BSP_SD_WriteBlocks_DMA((uint32_t*)buff, (uint64_t)(sector * BLOCK_SIZE), BLOCK_SIZE, count);
-    
-    while(BSP_SD_GetStatus() != SD_TRANSFER_OK)
+    if (SD_StartWrite(buff, sector, count) != RES_OK)
     {
-      if (timeout-- == 0)
-      {
-        return RES_ERROR;
-      }
+      return RES_ERROR;
     }
+    return SD_WaitTransfer();
   }
-  if (SD_state == MSD_OK)
+
+  /* DMA Alignment issue, write through the bounce buffers: the next batch
+     is copied in while the previous one is transferred */
+  n = SD_MIN(count, SD_BOUNCE_SECTORS);
+  memcpy(Bounce[0], buff, n * BLOCK_SIZE);
+  for (i = 0; count != 0; i ^= 1)
   {
-    return RES_OK;
+    if (SD_StartWrite((BYTE*)Bounce[i], sector, n) != RES_OK)
+    {
+      return RES_ERROR;
+    }
+    buff += n * BLOCK_SIZE;
+    sector += n;
+    count -= n;
+    if (count != 0)
+    {
+      next = SD_MIN(count, SD_BOUNCE_SECTORS);
+      memcpy(Bounce[i ^ 1], buff, next * BLOCK_SIZE);
+    }
+    if (SD_WaitTransfer() != RES_OK || (count != 0 && SD_WaitReady() != RES_OK))
+    {
+      return RES_ERROR;
+    }
+    n = next;
   }
-  
-  return RES_ERROR;
+
+  return RES_OK;
 }
 #endif /* _USE_WRITE == 1 */
 
@@ -219,7 +374,7 @@ DRESULT SD_ioctl(BYTE cmd, void *buff)
   {
   /* Make sure that no pending write process */
   case CTRL_SYNC :
-    res = RES_OK;
+    res = SD_WaitReady();
     break;
   
   /* Get number of sectors on the disk (DWORD) */
@@ -32,9 +32,22 @@
 /* Includes ------------------------------------------------------------------*/
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
+/* 1: BSP_SD_ReadBlocks_DMA and BSP_SD_WriteBlocks_DMA return once the
+   transfer is started and the BSP calls the completion callbacks below from
+   the interrupt that ends it. 0: they return when the data is moved, as in
+   the ST eval board BSP, and the driver polls BSP_SD_GetStatus */
+#ifndef SD_DMA_CALLBACKS
+#define SD_DMA_CALLBACKS          0
+#endif
+
 /* Exported functions ------------------------------------------------------- */
 extern Diskio_drvTypeDef  SD_Driver;
 
+#if SD_DMA_CALLBACKS == 1
+void BSP_SD_ReadCpltCallback(void);
+void BSP_SD_WriteCpltCallback(void);
+#endif /* SD_DMA_CALLBACKS == 1 */
+
 #endif /* __SD_DISKIO_H */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -795,6 +795,213 @@ FRESULT move_window (
 
 
 
+/*-----------------------------------------------------------------------*/
+/* FAT cache - Write back and invalidate the cached FAT sectors          */
+/*-----------------------------------------------------------------------*/
+#if _FS_FATCACHE
+#if !_FS_READONLY
+static
+FRESULT sync_fatcache_slot (
+	FATFS* fs,		/* File system object */
+	UINT i			/* Cache slot */
+)
+{
+	DWORD wsect;
+	UINT nf;
+
+
+	if (fs->fcflag[i] & 1) {	/* Write back the sector if it is dirty */
+		wsect = fs->fcsect[i];
+		if (disk_write(fs->drv, fs->fcbuf[i].d8, wsect, 1))
+			return FR_DISK_ERR;
+		fs->fcflag[i] = 0;
+		for (nf = fs->n_fats; nf >= 2; nf--) {	/* Reflect the change to all FAT copies */
+			wsect += fs->fsize;
+			disk_write(fs->drv, fs->fcbuf[i].d8, wsect, 1);
+		}
+	}
+	return FR_OK;
+}
+
+
+static
+FRESULT sync_fatcache (
+	FATFS* fs		/* File system object */
+)
+{
+	UINT i;
+
+
+	for (i = 0; i < _FS_FATCACHE; i++) {
+		if (sync_fatcache_slot(fs, i) != FR_OK)
+			return FR_DISK_ERR;
+	}
+	return FR_OK;
+}
+#endif
+
+
+static
+void clear_fatcache (
+	FATFS* fs		/* File system object */
+)
+{
+	UINT i;
+
+
+	for (i = 0; i < _FS_FATCACHE; i++) {
+		fs->fcsect[i] = 0xFFFFFFFF;
+		fs->fcage[i] = (BYTE)i;
+		fs->fcflag[i] = 0;
+	}
+}
+#endif
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* FAT access - Make a FAT sector appear in a buffer                     */
+/*-----------------------------------------------------------------------*/
+
+static
+BYTE* fat_window (	/* Pointer to the sector data, 0:Disk error */
+	FATFS* fs,		/* File system object */
+	DWORD sector,	/* FAT sector number */
+	BYTE wr			/* !=0: The sector is going to be changed */
+)
+{
+#if _FS_FATCACHE
+	UINT i, n;
+
+
+	for (i = 0; i < _FS_FATCACHE && fs->fcsect[i] != sector; i++) ;
+	if (i == _FS_FATCACHE) {	/* Not cached: replace the least recently used slot */
+		for (i = n = 0; n < _FS_FATCACHE; n++) {
+			if (fs->fcage[n] > fs->fcage[i]) i = n;
+		}
+#if !_FS_READONLY
+		if (sync_fatcache_slot(fs, i) != FR_OK)
+			return 0;
+#endif
+		fs->fcsect[i] = 0xFFFFFFFF;
+		if (disk_read(fs->drv, fs->fcbuf[i].d8, sector, 1))
+			return 0;
+		fs->fcsect[i] = sector;
+	}
+	for (n = 0; n < _FS_FATCACHE; n++) {	/* Make it the most recently used */
+		if (fs->fcage[n] < fs->fcage[i]) fs->fcage[n]++;
+	}
+	fs->fcage[i] = 0;
+	if (wr) fs->fcflag[i] = 1;
+	return fs->fcbuf[i].d8;
+#else
+	if (move_window(fs, sector) != FR_OK)
+		return 0;
+	if (wr) fs->wflag = 1;
+	return fs->win.d8;
+#endif
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Free map - Which FAT sectors have a free entry (FAT16/32)             */
+/*-----------------------------------------------------------------------*/
+#if _FS_FREEMAP && !_FS_READONLY
+#define	FM_EPS(fs)	(SS(fs) / ((fs)->fs_type == FS_FAT16 ? 2 : 4))	/* FAT entries per sector */
+#define	FM_ENT(fs, p, e)	((fs)->fs_type == FS_FAT16 ? LD_WORD((p) + (e) * 2) : LD_DWORD((p) + (e) * 4) & 0x0FFFFFFF)
+
+static
+void fm_mark (
+	FATFS* fs,		/* File system object */
+	DWORD clst		/* Cluster# that has been freed */
+)
+{
+	DWORD i;
+
+
+	if (fs->fmstat) {
+		i = clst / FM_EPS(fs);
+		if (i < _FS_FREEMAP) fs->freemap[i / 8] |= 1 << (i % 8);
+	}
+}
+
+
+static
+FRESULT fm_build (	/* Build the map and count the free clusters in one pass */
+	FATFS* fs		/* File system object */
+)
+{
+	DWORD clst, i, n;
+	UINT e, eps;
+	BYTE *p, hit;
+
+
+	eps = FM_EPS(fs);
+	mem_set(fs->freemap, 0, sizeof fs->freemap);
+	n = 0;
+	for (i = clst = 0; clst < fs->n_fatent; i++) {
+		p = fat_window(fs, fs->fatbase + i, 0);
+		if (!p) return FR_DISK_ERR;
+		hit = 0;
+		for (e = 0; e < eps && clst < fs->n_fatent; e++, clst++) {
+			if (clst >= 2 && FM_ENT(fs, p, e) == 0) {
+				n++; hit = 1;
+			}
+		}
+		if (hit && i < _FS_FREEMAP) fs->freemap[i / 8] |= 1 << (i % 8);
+	}
+	fs->free_clust = n;
+	fs->fsi_flag |= 1;
+	fs->fmstat = 1;
+
+	return FR_OK;
+}
+
+
+static
+DWORD fm_find (	/* 0:No free cluster, 0xFFFFFFFF:Disk error, >=2:Free cluster# */
+	FATFS* fs,		/* File system object */
+	DWORD scl		/* Search from the cluster next to this */
+)
+{
+	DWORD ncl, left, i, n, k;
+	UINT e, eps;
+	BYTE *p;
+
+
+	eps = FM_EPS(fs);
+	ncl = scl;
+	left = fs->n_fatent - 2;	/* Clusters to be examined */
+	while (left) {
+		if (++ncl >= fs->n_fatent) ncl = 2;	/* Wrap around */
+		i = ncl / eps;
+		e = (UINT)(ncl % eps);
+		n = eps - e;					/* Entries up to the end of the FAT sector */
+		if (n > fs->n_fatent - ncl) n = fs->n_fatent - ncl;
+		k = (n > left) ? left : n;
+		if (i >= _FS_FREEMAP || (fs->freemap[i / 8] & (1 << (i % 8)))) {	/* May have a free entry */
+			p = fat_window(fs, fs->fatbase + i, 0);
+			if (!p) return 0xFFFFFFFF;
+			for (k = 0; k < n && k < left; k++) {
+				if (FM_ENT(fs, p, e + k) == 0) return ncl + k;
+			}
+			if (i < _FS_FREEMAP && (e == 0 || ncl == 2) && k == n)	/* The whole sector is in use */
+				fs->freemap[i / 8] &= ~(1 << (i % 8));
+		}
+		ncl += k - 1;
+		left -= k;
+	}
+
+	return 0;
+}
+#endif
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Synchronize file system and strage device                             */
 /*-----------------------------------------------------------------------*/
@@ -808,6 +1015,10 @@ FRESULT sync_fs (	/* FR_OK: successful, FR_DISK_ERR: failed */
 
 
 	res = sync_window(fs);
+#if _FS_FATCACHE
+	if (res == FR_OK)
+		res = sync_fatcache(fs);
+#endif
 	if (res == FR_OK) {
 		/* Update FSINFO sector if needed */
 		if (fs->fs_type == FS_FAT32 && fs->fsi_flag == 1) {
@@ -873,20 +1084,20 @@ DWORD get_fat (	/* 0xFFFFFFFF:Disk error, 1:Internal error, Else:Cluster status
 	switch (fs->fs_type) {
 	case FS_FAT12 :
 		bc = (UINT)clst; bc += bc / 2;
-		if (move_window(fs, fs->fatbase + (bc / SS(fs)))) break;
-		wc = fs->win.d8[bc % SS(fs)]; bc++;
-		if (move_window(fs, fs->fatbase + (bc / SS(fs)))) break;
-		wc |= fs->win.d8[bc % SS(fs)] << 8;
+		if (!(p = fat_window(fs, fs->fatbase + (bc / SS(fs)), 0))) break;
+		wc = p[bc % SS(fs)]; bc++;
+		if (!(p = fat_window(fs, fs->fatbase + (bc / SS(fs)), 0))) break;
+		wc |= p[bc % SS(fs)] << 8;
 		return clst & 1 ? wc >> 4 : (wc & 0xFFF);
 
 	case FS_FAT16 :
-		if (move_window(fs, fs->fatbase + (clst / (SS(fs) / 2)))) break;
-		p = &fs->win.d8[clst * 2 % SS(fs)];
+		if (!(p = fat_window(fs, fs->fatbase + (clst / (SS(fs) / 2)), 0))) break;
+		p += clst * 2 % SS(fs);
 		return LD_WORD(p);
 
 	case FS_FAT32 :
-		if (move_window(fs, fs->fatbase + (clst / (SS(fs) / 4)))) break;
-		p = &fs->win.d8[clst * 4 % SS(fs)];
+		if (!(p = fat_window(fs, fs->fatbase + (clst / (SS(fs) / 4)), 0))) break;
+		p += clst * 4 % SS(fs);
 		return LD_DWORD(p) & 0x0FFFFFFF;
 	}
 
@@ -919,37 +1130,41 @@ FRESULT put_fat (
 		switch (fs->fs_type) {
 		case FS_FAT12 :
 			bc = (UINT)clst; bc += bc / 2;
-			res = move_window(fs, fs->fatbase + (bc / SS(fs)));
-			if (res != FR_OK) break;
-			p = &fs->win.d8[bc % SS(fs)];
+			res = FR_DISK_ERR;
+			if (!(p = fat_window(fs, fs->fatbase + (bc / SS(fs)), 1))) break;
+			p += bc % SS(fs);
 			*p = (clst & 1) ? ((*p & 0x0F) | ((BYTE)val << 4)) : (BYTE)val;
 			bc++;
-			fs->wflag = 1;
-			res = move_window(fs, fs->fatbase + (bc / SS(fs)));
-			if (res != FR_OK) break;
-			p = &fs->win.d8[bc % SS(fs)];
+			if (!(p = fat_window(fs, fs->fatbase + (bc / SS(fs)), 1))) break;
+			p += bc % SS(fs);
 			*p = (clst & 1) ? (BYTE)(val >> 4) : ((*p & 0xF0) | ((BYTE)(val >> 8) & 0x0F));
+			res = FR_OK;
 			break;
 
 		case FS_FAT16 :
-			res = move_window(fs, fs->fatbase + (clst / (SS(fs) / 2)));
-			if (res != FR_OK) break;
-			p = &fs->win.d8[clst * 2 % SS(fs)];
+			res = FR_DISK_ERR;
+			if (!(p = fat_window(fs, fs->fatbase + (clst / (SS(fs) / 2)), 1))) break;
+			p += clst * 2 % SS(fs);
 			ST_WORD(p, (WORD)val);
+			res = FR_OK;
 			break;
 
 		case FS_FAT32 :
-			res = move_window(fs, fs->fatbase + (clst / (SS(fs) / 4)));
-			if (res != FR_OK) break;
-			p = &fs->win.d8[clst * 4 % SS(fs)];
+			res = FR_DISK_ERR;
+			if (!(p = fat_window(fs, fs->fatbase + (clst / (SS(fs) / 4)), 1))) break;
+			p += clst * 4 % SS(fs);
 			val |= LD_DWORD(p) & 0xF0000000;
 			ST_DWORD(p, val);
+			res = FR_OK;
 			break;
 
 		default :
 			res = FR_INT_ERR;
 		}
-		fs->wflag = 1;
+#if _FS_FREEMAP
+		if (res == FR_OK && !(val & 0x0FFFFFFF))	/* A freed cluster shows up in the free map */
+			fm_mark(fs, clst);
+#endif
 	}
 
 	return res;
@@ -1037,18 +1252,27 @@ DWORD create_chain (	/* 0:No free cluster, 1:Internal error, 0xFFFFFFFF:Disk err
 		scl = clst;
 	}
 
-	ncl = scl;				/* Start cluster */
-	for (;;) {
-		ncl++;							/* Next cluster */
-		if (ncl >= fs->n_fatent) {		/* Wrap around */
-			ncl = 2;
-			if (ncl > scl) return 0;	/* No free cluster */
+#if _FS_FREEMAP
+	if (fs->fs_type != FS_FAT12) {	/* Find a free cluster with the free map */
+		if (!fs->fmstat && fm_build(fs) != FR_OK) return 0xFFFFFFFF;
+		ncl = fm_find(fs, scl);
+		if (ncl == 0 || ncl == 0xFFFFFFFF) return ncl;
+	} else
+#endif
+	{
+		ncl = scl;				/* Start cluster */
+		for (;;) {
+			ncl++;							/* Next cluster */
+			if (ncl >= fs->n_fatent) {		/* Wrap around */
+				ncl = 2;
+				if (ncl > scl) return 0;	/* No free cluster */
+			}
+			cs = get_fat(fs, ncl);			/* Get the cluster status */
+			if (cs == 0) break;				/* Found a free cluster */
+			if (cs == 0xFFFFFFFF || cs == 1)/* An error occurred */
+				return cs;
+			if (ncl == scl) return 0;		/* No free cluster */
 		}
-		cs = get_fat(fs, ncl);			/* Get the cluster status */
-		if (cs == 0) break;				/* Found a free cluster */
-		if (cs == 0xFFFFFFFF || cs == 1)/* An error occurred */
-			return cs;
-		if (ncl == scl) return 0;		/* No free cluster */
 	}
 
 	res = put_fat(fs, ncl, 0x0FFFFFFF);	/* Mark the new cluster "last link" */
@@ -2154,6 +2378,12 @@ FRESULT find_volume (	/* FR_OK(0): successful, !=0: any error occurred */
 	/* Following code attempts to mount the volume. (analyze BPB and initialize the fs object) */
 
 	fs->fs_type = 0;					/* Clear the file system object */
+#if _FS_FATCACHE
+	clear_fatcache(fs);					/* Discard the cached FAT sectors */
+#endif
+#if _FS_FREEMAP && !_FS_READONLY
+	fs->fmstat = 0;						/* The free map is built again on demand */
+#endif
 	fs->drv = LD2PD(vol);				/* Bind the logical drive and a physical drive */
 	stat = disk_initialize(fs->drv);	/* Initialize the physical drive */
 	if (stat & STA_NOINIT)				/* Check if the initialization succeeded */
@@ -3282,6 +3512,12 @@ FRESULT f_getfree (
 		/* If free_clust is valid, return it without full cluster scan */
 		if (fs->free_clust <= fs->n_fatent - 2) {
 			*nclst = fs->free_clust;
+#if _FS_FREEMAP
+		} else if (fs->fs_type != FS_FAT12) {
+			/* Count them while building the free map */
+			res = fm_build(fs);
+			if (res == FR_OK) *nclst = fs->free_clust;
+#endif
 		} else {
 			/* Get number of free clusters */
 			fat = fs->fs_type;
@@ -3300,9 +3536,8 @@ FRESULT f_getfree (
 				i = 0; p = 0;
 				do {
 					if (!i) {
-						res = move_window(fs, sect++);
-						if (res != FR_OK) break;
-						p = fs->win.d8;
+						p = fat_window(fs, sect++, 0);
+						if (!p) { res = FR_DISK_ERR; break; }
 						i = SS(fs);
 					}
 					if (fat == FS_FAT16) {
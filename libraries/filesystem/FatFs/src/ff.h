@@ -28,6 +28,19 @@ extern "C" {
 #error Wrong configuration file (ffconf.h).
 #endif
 
+#ifndef _FS_FATCACHE
+#define _FS_FATCACHE	0
+#endif
+#ifndef _FS_FREEMAP
+#define _FS_FREEMAP		0
+#endif
+#if _FS_FATCACHE > 16
+#error Wrong _FS_FATCACHE setting
+#endif
+#if _FS_FREEMAP % 8
+#error Wrong _FS_FREEMAP setting
+#endif
+
 
 
 /* Definitions of volume management */
@@ -107,6 +120,19 @@ typedef struct {
 	DWORD	dirbase;		/* Root directory start sector (FAT32:Cluster#) */
 	DWORD	database;		/* Data start sector */
 	DWORD	winsect;		/* Current sector appearing in the win[] */
+#if _FS_FATCACHE
+	DWORD	fcsect[_FS_FATCACHE];	/* FAT cache: sector in each slot (0xFFFFFFFF:empty) */
+	BYTE	fcage[_FS_FATCACHE];	/* FAT cache: slot age (0:most recently used) */
+	BYTE	fcflag[_FS_FATCACHE];	/* FAT cache: slot flag (b0:dirty) */
+	union{
+	UINT	d32[_MAX_SS/4];
+	BYTE	d8[_MAX_SS];
+	}fcbuf[_FS_FATCACHE];			/* FAT cache: sector buffers */
+#endif
+#if _FS_FREEMAP && !_FS_READONLY
+	BYTE	fmstat;					/* Free map status (0:not built, 1:built) */
+	BYTE	freemap[_FS_FREEMAP/8];	/* Free map: a bit per FAT sector (1:may have a free entry) */
+#endif
 
 } FATFS;
 
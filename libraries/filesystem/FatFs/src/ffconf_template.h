@@ -185,6 +185,24 @@
 */
 
 
+#define _FS_FATCACHE    0 /* 0:Disable or 1..16:Number of FAT sectors cached */
+/* When _FS_FATCACHE is set, FAT entries are accessed through a write-back cache
+/  of that many sectors in the file system object (_MAX_SS bytes each) instead of
+/  the shared sector window, so that directory and FAT accesses do not evict each
+/  other. Changed FAT sectors are written to all FAT copies when they are evicted
+/  and when the volume is synchronized (f_sync, f_close, ...). */
+
+
+#define _FS_FREEMAP     0 /* 0:Disable or number of FAT sectors mapped (multiple of 8) */
+/* When _FS_FREEMAP is set, the file system object keeps a bit for each of the
+/  first _FS_FREEMAP FAT sectors that tells if the sector has a free entry. The
+/  map is built by one pass over the FAT at the first cluster allocation or
+/  f_getfree() after mount, which counts the free clusters as well, and from
+/  then on the allocator skips full FAT sectors without reading them. It costs
+/  _FS_FREEMAP / 8 bytes; 128 FAT32 or 256 FAT16 clusters per bit at 512 byte
+/  sectors. FAT12 volumes are always scanned. */
+
+
 /*---------------------------------------------------------------------------/
 / System Configurations
 /----------------------------------------------------------------------------*/
@@ -91,6 +91,84 @@ static inline void AES_CTR_Increment( uint8_t *inCounter )
     }
 }
 
+//===========================================================================================================================
+//  AES_CTR_Keystream
+//
+//  Encrypts inBlocks consecutive counter values into outKeystream and advances the counter past them.
+//===========================================================================================================================
+
+static OSStatus AES_CTR_Keystream( AES_CTR_Context *inContext, uint8_t *outKeystream, size_t inBlocks )
+{
+    OSStatus        err;
+    size_t          i;
+    
+#if( AES_UTILS_USE_COMMON_CRYPTO || AES_UTILS_USE_GLADMAN_AES )
+    // Lay out all the counters first so the cipher runs over them in one call.
+    
+    for( i = 0; i < inBlocks; ++i )
+    {
+        memcpy( &outKeystream[ i * kAES_CTR_Size ], inContext->ctr, kAES_CTR_Size );
+        AES_CTR_Increment( inContext->ctr );
+    }
+    #if( AES_UTILS_USE_COMMON_CRYPTO )
+        err = CCCryptorUpdate( inContext->cryptor, outKeystream, inBlocks * kAES_CTR_Size, outKeystream, 
+            inBlocks * kAES_CTR_Size, &i );
+        require_noerr( err, exit );
+        require_action( i == ( inBlocks * kAES_CTR_Size ), exit, err = kSizeErr );
+    #else
+        aes_ecb_encrypt( outKeystream, outKeystream, (int)( inBlocks * kAES_CTR_Size ), &inContext->ctx );
+    #endif
+#else
+    for( i = 0; i < inBlocks; ++i )
+    {
+        #if( AES_UTILS_USE_MICO_AES )
+            AesEncryptDirect( &inContext->ctx, outKeystream, inContext->ctr );
+        #elif( AES_UTILS_USE_USSL )
+            aes_crypt_ecb( &inContext->ctx, AES_ENCRYPT, inContext->ctr, outKeystream );
+        #else
+            AES_encrypt( inContext->ctr, outKeystream, &inContext->key );
+        #endif
+        AES_CTR_Increment( inContext->ctr );
+        outKeystream += kAES_CTR_Size;
+    }
+#endif
+    err = kNoErr;
+    
+#if( AES_UTILS_USE_COMMON_CRYPTO )
+exit:
+#endif
+    return( err );
+}
+
+//===========================================================================================================================
+//  AES_CTR_XOR
+//
+//  XORs inLen bytes of keystream into the data a word at a time when both buffers allow it. The keystream is always
+//  word aligned.
+//===========================================================================================================================
+
+static inline void AES_CTR_XOR( uint8_t *inDst, const uint8_t *inSrc, const uint8_t *inKeystream, size_t inLen )
+{
+    if( ( ( (uintptr_t) inDst | (uintptr_t) inSrc ) & ( sizeof( uint32_t ) - 1 ) ) == 0 )
+    {
+        uint32_t *              dst = (uint32_t *) inDst;
+        const uint32_t *        src = (const uint32_t *) inSrc;
+        const uint32_t *        ks  = (const uint32_t *) inKeystream;
+        
+        for( ; inLen >= sizeof( uint32_t ); inLen -= sizeof( uint32_t ) )
+        {
+            *dst++ = *src++ ^ *ks++;
+        }
+        inDst       = (uint8_t *) dst;
+        inSrc       = (const uint8_t *) src;
+        inKeystream = (const uint8_t *) ks;
+    }
+    while( inLen-- > 0 )
+    {
+        *inDst++ = *inSrc++ ^ *inKeystream++;
+    }
+}
+
 //===========================================================================================================================
 //  AES_CTR_Update
 //===========================================================================================================================
@@ -102,7 +180,9 @@ OSStatus    AES_CTR_Update( AES_CTR_Context *inContext, const void *inSrc, size_
     uint8_t *           dst;
     uint8_t *           buf;
     size_t              used;
+    size_t              len;
     size_t              i;
+    uint32_t            keystream[ ( AES_UTILS_CTR_BULK_BLOCKS * kAES_CTR_Size ) / sizeof( uint32_t ) ];
     
     // inSrc and inDst may be the same, but otherwise, the buffers must not overlap.
     
@@ -125,52 +205,28 @@ OSStatus    AES_CTR_Update( AES_CTR_Context *inContext, const void *inSrc, size_
     }
     inContext->used = used;
     
-    // Process whole blocks.
+    // Process whole blocks, up to AES_UTILS_CTR_BULK_BLOCKS of them per pass.
     
     while( inLen >= kAES_CTR_Size )
     {
-        #if( AES_UTILS_USE_COMMON_CRYPTO )
-            err = CCCryptorUpdate( inContext->cryptor, inContext->ctr, kAES_CTR_Size, buf, kAES_CTR_Size, &i );
-            require_noerr( err, exit );
-            require_action( i == kAES_CTR_Size, exit, err = kSizeErr );
-        #elif( AES_UTILS_USE_GLADMAN_AES )
-            aes_ecb_encrypt( inContext->ctr, buf, kAES_CTR_Size, &inContext->ctx );
-        #elif( AES_UTILS_USE_MICO_AES )
-            AesEncryptDirect( &inContext->ctx, buf, inContext->ctr );
-        #elif( AES_UTILS_USE_USSL )
-            aes_crypt_ecb( &inContext->ctx, AES_ENCRYPT, inContext->ctr, buf );
-        #else
-            AES_encrypt( inContext->ctr, buf, &inContext->key );
-        #endif
-        AES_CTR_Increment( inContext->ctr );
+        i = inLen / kAES_CTR_Size;
+        if( i > AES_UTILS_CTR_BULK_BLOCKS ) i = AES_UTILS_CTR_BULK_BLOCKS;
+        err = AES_CTR_Keystream( inContext, (uint8_t *) keystream, i );
+        require_noerr( err, exit );
         
-        for( i = 0; i < kAES_CTR_Size; ++i )
-        {
-            dst[ i ] = src[ i ] ^ buf[ i ];
-        }
-        src   += kAES_CTR_Size;
-        dst   += kAES_CTR_Size;
-        inLen -= kAES_CTR_Size;
+        len = i * kAES_CTR_Size;
+        AES_CTR_XOR( dst, src, (const uint8_t *) keystream, len );
+        src   += len;
+        dst   += len;
+        inLen -= len;
     }
     
     // Process any trailing sub-block bytes. Extra key material is buffered for next time.
     
     if( inLen > 0 )
     {
-        #if( AES_UTILS_USE_COMMON_CRYPTO )
-            err = CCCryptorUpdate( inContext->cryptor, inContext->ctr, kAES_CTR_Size, buf, kAES_CTR_Size, &i );
-            require_noerr( err, exit );
-            require_action( i == kAES_CTR_Size, exit, err = kSizeErr );
-        #elif( AES_UTILS_USE_GLADMAN_AES )
-            aes_ecb_encrypt( inContext->ctr, buf, kAES_CTR_Size, &inContext->ctx );
-        #elif( AES_UTILS_USE_MICO_AES )
-            AesEncryptDirect( &inContext->ctx, buf, inContext->ctr );
-        #elif( AES_UTILS_USE_USSL )
-            aes_crypt_ecb( &inContext->ctx, AES_ENCRYPT, inContext->ctr, buf );
-        #else
-            AES_encrypt( inContext->ctr, buf, &inContext->key );
-        #endif
-        AES_CTR_Increment( inContext->ctr );
+        err = AES_CTR_Keystream( inContext, buf, 1 );
+        require_noerr( err, exit );
         
         for( i = 0; i < inLen; ++i )
         {
@@ -186,9 +242,8 @@ OSStatus    AES_CTR_Update( AES_CTR_Context *inContext, const void *inSrc, size_
     }
     err = kNoErr;
     
-#if( AES_UTILS_USE_COMMON_CRYPTO )
 exit:
-#endif
+    memset( keystream, 0, sizeof( keystream ) ); // Clear sensitive data.
     return( err );
 }
 
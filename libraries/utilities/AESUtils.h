@@ -27,7 +27,18 @@
 #include "Debug.h"
 
 #include "SecurityUtils.h"
-#define AES_UTILS_USE_MICO_AES 1
+
+// The firmware uses the AES of MicoCrypto.a. Host builds (see MICO/security/crypto_bench) select Gladman AES instead.
+
+#if( !defined( AES_UTILS_USE_GLADMAN_AES ) && !defined( AES_UTILS_USE_MICO_AES ) )
+    #define AES_UTILS_USE_MICO_AES      1
+#endif
+
+// Number of counter blocks AES_CTR_Update encrypts per pass. The keystream for a pass lives on the stack.
+
+#if( !defined( AES_UTILS_CTR_BULK_BLOCKS ) )
+    #define AES_UTILS_CTR_BULK_BLOCKS   4
+#endif
 
 #if( !defined( AES_UTILS_HAS_GLADMAN_GCM ) )
 //    #if( __has_include( "gcm.h" ) )
@@ -50,7 +61,7 @@
 #if( AES_UTILS_USE_COMMON_CRYPTO )
     #include <CommonCrypto/CommonCryptor.h>
 #elif( AES_UTILS_USE_GLADMAN_AES )
-    #include "External/GladmanAES/aes.h"
+    #include "GladmanAES/aes.h"
 #elif( AES_UTILS_USE_MICO_AES )
     #include "MICOAES.h"
 #elif( !TARGET_NO_OPENSSL )
@@ -339,7 +350,7 @@ OSStatus
 
 void    AES_GCM_Final( AES_GCM_Context *inContext );
 
-OSStatus    AES_GCM_InitMessage( AES_GCM_Context *inContext, const uint8_t *inNonce );
+OSStatus    AES_GCM_InitMessage( AES_GCM_Context *inContext, const uint8_t inNonce[ kAES_CGM_Size ] );
 OSStatus    AES_GCM_FinalizeMessage( AES_GCM_Context *inContext, uint8_t outAuthTag[ kAES_CGM_Size ] );
 OSStatus    AES_GCM_VerifyMessage( AES_GCM_Context *inContext, const uint8_t inAuthTag[ kAES_CGM_Size ] );
 
@@ -90,3 +90,108 @@ uint32_t ring_buffer_write( ring_buffer_t* ring_buffer, const uint8_t* data, uin
   
   return amount_to_copy;
 }
+
+/* Orders the data accesses of one side against the indices: DMB on
+ * Cortex-M, only a compiler barrier where stores are not reordered (x86) */
+#if defined(__ICCARM__)
+#include <intrinsics.h>
+#define ring_fifo_barrier()   __DMB()
+#else
+#define ring_fifo_barrier()   __atomic_thread_fence( __ATOMIC_ACQ_REL )
+#endif
+
+/* The part of the ring from position index, length bytes */
+static void ring_fifo_span( ring_fifo_t* fifo, uint32_t index, uint32_t length, ring_fifo_span_t* span )
+{
+  uint32_t offset = index & fifo->mask;
+  uint32_t to_end = fifo->mask + 1 - offset;
+
+  span->data[0]   = &fifo->buffer[offset];
+  span->length[0] = MIN(length, to_end);
+  span->data[1]   = fifo->buffer;
+  span->length[1] = length - span->length[0];
+}
+
+OSStatus ring_fifo_init( ring_fifo_t* fifo, uint8_t* buffer, uint32_t size )
+{
+  if ( size == 0 || ( size & ( size - 1 ) ) != 0 )
+    return kParamErr;
+
+  fifo->buffer = buffer;
+  fifo->mask   = size - 1;
+  fifo->head   = 0;
+  fifo->tail   = 0;
+  return kNoErr;
+}
+
+uint32_t ring_fifo_free_space( ring_fifo_t* fifo )
+{
+  return fifo->mask + 1 - ( fifo->tail - fifo->head );
+}
+
+uint32_t ring_fifo_used_space( ring_fifo_t* fifo )
+{
+  return fifo->tail - fifo->head;
+}
+
+uint32_t ring_fifo_write_peek( ring_fifo_t* fifo, ring_fifo_span_t* span )
+{
+  uint32_t tail = fifo->tail;
+  uint32_t free_space = fifo->mask + 1 - ( tail - fifo->head );
+
+  /* The reader is done with the bytes before head */
+  ring_fifo_barrier();
+  ring_fifo_span( fifo, tail, free_space, span );
+  return free_space;
+}
+
+void ring_fifo_write_commit( ring_fifo_t* fifo, uint32_t bytes_written )
+{
+  /* Publish the data before the index */
+  ring_fifo_barrier();
+  fifo->tail = fifo->tail + bytes_written;
+}
+
+uint32_t ring_fifo_read_peek( ring_fifo_t* fifo, ring_fifo_span_t* span )
+{
+  uint32_t head = fifo->head;
+  uint32_t used_space = fifo->tail - head;
+
+  /* The data up to tail is there */
+  ring_fifo_barrier();
+  ring_fifo_span( fifo, head, used_space, span );
+  return used_space;
+}
+
+void ring_fifo_read_commit( ring_fifo_t* fifo, uint32_t bytes_consumed )
+{
+  /* Finish reading before the writer may reuse the bytes */
+  ring_fifo_barrier();
+  fifo->head = fifo->head + bytes_consumed;
+}
+
+uint32_t ring_fifo_write( ring_fifo_t* fifo, const uint8_t* data, uint32_t data_length )
+{
+  ring_fifo_span_t span;
+  uint32_t amount_to_copy = MIN(data_length, ring_fifo_write_peek( fifo, &span ));
+
+  memcpy( span.data[0], data, MIN(amount_to_copy, span.length[0]) );
+  if ( amount_to_copy > span.length[0] )
+    memcpy( span.data[1], data + span.length[0], amount_to_copy - span.length[0] );
+
+  ring_fifo_write_commit( fifo, amount_to_copy );
+  return amount_to_copy;
+}
+
+uint32_t ring_fifo_read( ring_fifo_t* fifo, uint8_t* data, uint32_t data_length )
+{
+  ring_fifo_span_t span;
+  uint32_t amount_to_copy = MIN(data_length, ring_fifo_read_peek( fifo, &span ));
+
+  memcpy( data, span.data[0], MIN(amount_to_copy, span.length[0]) );
+  if ( amount_to_copy > span.length[0] )
+    memcpy( data + span.length[0], span.data[1], amount_to_copy - span.length[0] );
+
+  ring_fifo_read_commit( fifo, amount_to_copy );
+  return amount_to_copy;
+}
@@ -51,6 +51,48 @@ uint8_t ring_buffer_consume( ring_buffer_t* ring_buffer, uint32_t bytes_consumed
 
 uint32_t ring_buffer_write( ring_buffer_t* ring_buffer, const uint8_t* data, uint32_t data_length );
 
+/* Ring of a power of two size for one writer and one reader, e.g. an ISR and
+ * a thread. head and tail count the bytes read and written since init and
+ * wrap at 2^32, so positions are a mask away and all size bytes are usable.
+ * Each side writes only its own index, after a memory barrier. */
+typedef struct
+{
+  uint32_t            mask;     /* size - 1 */
+  volatile uint32_t   head;     /* written by the reader */
+  volatile uint32_t   tail;     /* written by the writer */
+  uint8_t*            buffer;
+} ring_fifo_t;
+
+/* Up to two contiguous parts of the ring, the second one from its start */
+typedef struct
+{
+  uint8_t*  data[2];
+  uint32_t  length[2];
+} ring_fifo_span_t;
+
+/* kParamErr unless size is a power of two */
+OSStatus ring_fifo_init( ring_fifo_t* fifo, uint8_t* buffer, uint32_t size );
+
+uint32_t ring_fifo_free_space( ring_fifo_t* fifo );
+
+uint32_t ring_fifo_used_space( ring_fifo_t* fifo );
+
+uint32_t ring_fifo_write( ring_fifo_t* fifo, const uint8_t* data, uint32_t data_length );
+
+uint32_t ring_fifo_read( ring_fifo_t* fifo, uint8_t* data, uint32_t data_length );
+
+/* The free part of the ring, returns its length. Fill it, then commit the
+ * bytes written; only the writer calls these. */
+uint32_t ring_fifo_write_peek( ring_fifo_t* fifo, ring_fifo_span_t* span );
+
+void ring_fifo_write_commit( ring_fifo_t* fifo, uint32_t bytes_written );
+
+/* The used part of the ring, returns its length. Commit the bytes used once
+ * done with them; only the reader calls these. */
+uint32_t ring_fifo_read_peek( ring_fifo_t* fifo, ring_fifo_span_t* span );
+
+void ring_fifo_read_commit( ring_fifo_t* fifo, uint32_t bytes_consumed );
+
 #endif // __RingBufferUtils_h__
 
 
@@ -0,0 +1,298 @@
+/**
+******************************************************************************
+* @file    ring_fifo_test.c
+* @version V1.0.0
+* @brief   Host test of ring_fifo_t in ../RingBufferUtils.c: random writes,
+*          reads and peek/commit checked against a model, a writer and a
+*          reader thread moving a known byte stream through rings of 16 to
+*          1024 bytes, then the throughput next to ring_buffer_t.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "RingBufferUtils.h"
+
+#define RING_SIZE         (1024)
+#define STRESS_BYTES      (64u * 1024 * 1024)
+#define BENCH_BYTES       (32u * 1024 * 1024)
+
+static int failures = 0;
+
+#define check( cond ) do { if ( !( cond ) ) { \
+    printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); failures++; } } while ( 0 )
+
+static double now( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Byte n of the stream both threads agree on */
+static uint8_t stream_byte( uint32_t n )
+{
+  return (uint8_t)( ( n * 2654435761u ) >> 24 );
+}
+
+/* Next of a per thread xorshift */
+static uint32_t next_random( uint32_t* state )
+{
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+/* Random writes, reads and peek/commit against a byte count model */
+static void check_model( void )
+{
+  static uint8_t buffer[64], in[200], out[200];
+  ring_fifo_t fifo;
+  ring_fifo_span_t span;
+  uint32_t written = 0, read = 0, seed = 1, i, n, k, len;
+
+  check( ring_fifo_init( &fifo, buffer, 48 ) == kParamErr );
+  check( ring_fifo_init( &fifo, buffer, 0 ) == kParamErr );
+  check( ring_fifo_init( &fifo, buffer, sizeof( buffer ) ) == kNoErr );
+  /* Start near the wrap of the indices */
+  fifo.head = fifo.tail = written = read = 0xFFFFFF00u;
+
+  for ( i = 0; i < 200000; i++ ) {
+    len = next_random( &seed ) % 100;
+    check( ring_fifo_used_space( &fifo ) == written - read );
+    check( ring_fifo_free_space( &fifo ) == sizeof( buffer ) - ( written - read ) );
+    switch ( next_random( &seed ) % 4 ) {
+      case 0:
+        for ( k = 0; k < len; k++ ) in[k] = stream_byte( written + k );
+        n = ring_fifo_write( &fifo, in, len );
+        check( n == MIN( len, sizeof( buffer ) - ( written - read ) ) );
+        written += n;
+        break;
+      case 1:
+        n = ring_fifo_write_peek( &fifo, &span );
+        check( n == span.length[0] + span.length[1] );
+        n = MIN( n, len );
+        for ( k = 0; k < n; k++ ) {
+          if ( k < span.length[0] ) span.data[0][k] = stream_byte( written + k );
+          else span.data[1][k - span.length[0]] = stream_byte( written + k );
+        }
+        ring_fifo_write_commit( &fifo, n );
+        written += n;
+        break;
+      case 2:
+        n = ring_fifo_read( &fifo, out, len );
+        check( n == MIN( len, written - read ) );
+        for ( k = 0; k < n; k++ ) check( out[k] == stream_byte( read + k ) );
+        read += n;
+        break;
+      default:
+        n = ring_fifo_read_peek( &fifo, &span );
+        check( n == written - read );
+        check( span.length[1] == 0 || span.data[0] + span.length[0] == buffer + sizeof( buffer ) );
+        n = MIN( n, len );
+        for ( k = 0; k < n; k++ ) {
+          uint8_t b = k < span.length[0] ? span.data[0][k] : span.data[1][k - span.length[0]];
+          check( b == stream_byte( read + k ) );
+        }
+        ring_fifo_read_commit( &fifo, n );
+        read += n;
+        break;
+    }
+    if ( failures > 10 ) return;
+  }
+  /* Full: every byte usable */
+  while ( ring_fifo_write( &fifo, in, sizeof( in ) ) > 0 ) ;
+  check( ring_fifo_used_space( &fifo ) == sizeof( buffer ) );
+  check( ring_fifo_write_peek( &fifo, &span ) == 0 );
+}
+
+typedef struct
+{
+  ring_fifo_t*  fifo;
+  uint32_t      bytes;
+  uint32_t      max_chunk;
+  uint32_t      errors;
+  uint32_t      seed;
+} stress_side_t;
+
+/* Alternates memcpy writes and peek/commit fills of random lengths */
+static void* stress_writer( void* arg )
+{
+  stress_side_t* side = arg;
+  uint8_t chunk[RING_SIZE];
+  ring_fifo_span_t span;
+  uint32_t n = 0, len, k, done;
+
+  while ( n < side->bytes ) {
+    len = 1 + next_random( &side->seed ) % side->max_chunk;
+    len = MIN( len, side->bytes - n );
+    if ( next_random( &side->seed ) & 1 ) {
+      for ( k = 0; k < len; k++ ) chunk[k] = stream_byte( n + k );
+      n += ring_fifo_write( side->fifo, chunk, len );
+    } else {
+      done = MIN( len, ring_fifo_write_peek( side->fifo, &span ) );
+      for ( k = 0; k < done; k++ ) {
+        if ( k < span.length[0] ) span.data[0][k] = stream_byte( n + k );
+        else span.data[1][k - span.length[0]] = stream_byte( n + k );
+      }
+      ring_fifo_write_commit( side->fifo, done );
+      n += done;
+    }
+    if ( ring_fifo_free_space( side->fifo ) == 0 )
+      sched_yield( );
+  }
+  return NULL;
+}
+
+static void* stress_reader( void* arg )
+{
+  stress_side_t* side = arg;
+  uint8_t chunk[RING_SIZE];
+  ring_fifo_span_t span;
+  uint32_t n = 0, len, k, done;
+
+  while ( n < side->bytes ) {
+    len = 1 + next_random( &side->seed ) % side->max_chunk;
+    if ( next_random( &side->seed ) & 1 ) {
+      done = ring_fifo_read( side->fifo, chunk, len );
+      for ( k = 0; k < done; k++ )
+        if ( chunk[k] != stream_byte( n + k ) ) side->errors++;
+    } else {
+      done = MIN( len, ring_fifo_read_peek( side->fifo, &span ) );
+      for ( k = 0; k < done; k++ ) {
+        uint8_t b = k < span.length[0] ? span.data[0][k] : span.data[1][k - span.length[0]];
+        if ( b != stream_byte( n + k ) ) side->errors++;
+      }
+      ring_fifo_read_commit( side->fifo, done );
+    }
+    n += done;
+    if ( done == 0 )
+      sched_yield( );
+  }
+  return NULL;
+}
+
+/* A writer and a reader thread move bytes through rings from 16 bytes up.
+ * Each side yields when it cannot go on, for hosts with one CPU. */
+static void check_threads( void )
+{
+  static uint8_t buffer[RING_SIZE];
+  uint32_t size;
+
+  for ( size = 16; size <= RING_SIZE; size *= 4 ) {
+    ring_fifo_t fifo;
+    stress_side_t writer = { &fifo, STRESS_BYTES / 4, size, 0, 0x12345678u };
+    stress_side_t reader = { &fifo, STRESS_BYTES / 4, size, 0, 0x9E3779B9u };
+    pthread_t w, r;
+    double t0 = now();
+
+    ring_fifo_init( &fifo, buffer, size );
+    pthread_create( &w, NULL, stress_writer, &writer );
+    pthread_create( &r, NULL, stress_reader, &reader );
+    pthread_join( w, NULL );
+    pthread_join( r, NULL );
+    printf( "  threads, ring %4u: %u MB, %u corrupt bytes, %.0f MB/s\n", (unsigned) size,
+            (unsigned)( writer.bytes >> 20 ), (unsigned) reader.errors,
+            writer.bytes / ( now() - t0 ) / 1e6 );
+    check( reader.errors == 0 );
+    check( ring_fifo_used_space( &fifo ) == 0 );
+  }
+}
+
+/* Writes chunk bytes at a time and reads them back, MB/s. ring_buffer_t
+ * loses everything once full, so each writer leaves one byte free. */
+static double bench_ring_buffer( uint32_t chunk )
+{
+  static uint8_t buffer[RING_SIZE], data[RING_SIZE], out[RING_SIZE];
+  ring_buffer_t ring;
+  uint8_t* p;
+  uint32_t n, moved = 0, len;
+  double t0;
+
+  ring_buffer_init( &ring, buffer, sizeof( buffer ) );
+  t0 = now();
+  while ( moved < BENCH_BYTES ) {
+    while ( ring_buffer_used_space( &ring ) + chunk < sizeof( buffer ) )
+      ring_buffer_write( &ring, data, chunk );
+    while ( ( n = ring_buffer_used_space( &ring ) ) > 0 ) {
+      n = MIN( n, chunk );
+      /* The UART drivers read out this way */
+      while ( n > 0 ) {
+        ring_buffer_get_data( &ring, &p, &len );
+        len = MIN( len, n );
+        memcpy( out, p, len );
+        ring_buffer_consume( &ring, len );
+        moved += len;
+        n -= len;
+      }
+    }
+  }
+  return moved / ( now() - t0 ) / 1e6;
+}
+
+static double bench_ring_fifo( uint32_t chunk )
+{
+  static uint8_t buffer[RING_SIZE], data[RING_SIZE], out[RING_SIZE];
+  ring_fifo_t fifo;
+  uint32_t moved = 0;
+  double t0;
+
+  ring_fifo_init( &fifo, buffer, sizeof( buffer ) );
+  t0 = now();
+  while ( moved < BENCH_BYTES ) {
+    while ( ring_fifo_free_space( &fifo ) >= chunk )
+      ring_fifo_write( &fifo, data, chunk );
+    while ( ring_fifo_used_space( &fifo ) > 0 )
+      moved += ring_fifo_read( &fifo, out, chunk );
+  }
+  return moved / ( now() - t0 ) / 1e6;
+}
+
+int main( int argc, char* argv[] )
+{
+  static const uint32_t chunks[] = { 1, 4, 16, 64, 256 };
+  int check_only = ( argc > 1 && strcmp( argv[1], "-k" ) == 0 );
+  unsigned i;
+
+  printf( "self check\n" );
+  check_model();
+  check_threads();
+  printf( "%s\n", failures == 0 ? "  ok" : "  FAILED" );
+  if ( check_only || failures != 0 )
+    return failures != 0;
+
+  printf( "throughput, ring of %u bytes, MB/s\n", RING_SIZE );
+  printf( "  chunk  ring_buffer_t  ring_fifo_t\n" );
+  for ( i = 0; i < sizeof( chunks ) / sizeof( chunks[0] ); i++ )
+    printf( "  %5u  %13.0f  %11.0f\n", (unsigned) chunks[i],
+            bench_ring_buffer( chunks[i] ), bench_ring_fifo( chunks[i] ) );
+  return 0;
+}